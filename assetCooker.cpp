@@ -0,0 +1,411 @@
+//  assetCooker.cpp
+//  D. Scott Nettleton
+/*
+ *  This is the offline asset cooker for the Whipstitch Game Engine. It turns a tree of
+ *  source assets into the files the engine loads at runtime, and writes a manifest
+ *  through which the engine finds them. Images are cooked into .wsTex files, meshes
+ *  (.wsMesh or .stl) into .wsMeshBin files, optimized and with their levels of detail
+ *  built, and animations into .wsAnimBin files; the engine maps the last two in place,
+ *  sharing one copy between processes. Fonts, shaders and sounds are already in their
+ *  runtime formats and are used as they are. With -pak, every runtime file and the
+ *  manifest are gathered into one .wsPak as well, where cooked meshes and animations
+ *  are never compressed.
+ *
+ *    assetCooker [-rgb | -rgba | -bc1 | -bc3 | -bc5] [-fast | -high] [-f]
+ *                [-manifest <file>] [-pak <pack>] [-lz4] <file or directory>...
+ *
+ *  Work is judged by content, not by timestamps. Each asset's key hashes its contents
+ *  and every option it is cooked with, and an asset is cooked again only when its key
+ *  or its cooked file differs from the manifest of the last run. Meshes are read for
+ *  the texture maps they use; a map used as a normal map is cooked as linear data, and
+ *  a map outside the given directories is cooked along with the mesh. Hashing and
+ *  cooking run on every core. -f cooks everything regardless.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "whipstitch/wsAssets/wsCookedAsset.h"
+#include "whipstitch/wsAssets/wsMesh.h"
+#include "whipstitch/wsGraphics/wsTextureFile.h"
+#include "whipstitch/wsGameFlow/wsThreadPool.h"
+#include "whipstitch/wsUtils/wsAssetManifest.h"
+#include "whipstitch/wsUtils/wsLog.h"
+#include "whipstitch/wsUtils/wsMappedFile.h"
+#include "whipstitch/wsUtils/wsMemoryStack.h"
+#include "whipstitch/wsUtils/wsOperations.h"
+#include "whipstitch/wsUtils/wsPakFile.h"
+#include "whipstitch/wsUtils/wsTime.h"
+#include "whipstitch/wsUtils/wsTokenizer.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//  Raised whenever the cooker's output changes, so every asset is cooked again
+#define WS_COOKER_VERSION 2
+
+enum {
+  WS_COOK_IMAGE,  //  Cooked into a .wsTex
+  WS_COOK_MESH,   //  Cooked into a .wsMeshBin, and read for the texture maps it uses
+  WS_COOK_ANIM,   //  Cooked into a .wsAnimBin
+  WS_COOK_COPY    //  Used as it is
+};
+
+struct wsCookJob {
+  std::string source;
+  std::string cooked;
+  std::vector<std::string> usePaths;
+  std::vector<bool> useLinear;
+  u64 contentHash;
+  u64 key;
+  u64 cookedHash;
+  u64 sourceSize;
+  i64 sourceTime;   //  Last write time of the source as it was hashed
+  u32 kind;
+  bool linear;    //  Used as a normal map by some mesh
+  bool readable;
+};
+
+//  Returns the kind of asset a file is, or false if it is not one the engine loads
+bool classify(const wsPath& path, u32* kind) {
+  const char* images[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".dds" };
+  const char* runtime[] = { ".wsModel", ".ttf", ".otf", ".vsh", ".fsh", ".glslv", ".glslf",
+                            ".vert", ".frag", ".glsl", ".wav", ".ogg" };
+  std::string extension = path.extension().string();
+  for (u32 i = 0; i < sizeof(images)/sizeof(images[0]); ++i) {
+    if (strcasecmp(extension.c_str(), images[i]) == 0) { *kind = WS_COOK_IMAGE; return true; }
+  }
+  if (extension == ".wsMesh" || strcasecmp(extension.c_str(), ".stl") == 0) { *kind = WS_COOK_MESH; return true; }
+  if (extension == ".wsAnim") { *kind = WS_COOK_ANIM; return true; }
+  for (u32 i = 0; i < sizeof(runtime)/sizeof(runtime[0]); ++i) {
+    if (strcasecmp(extension.c_str(), runtime[i]) == 0) { *kind = WS_COOK_COPY; return true; }
+  }
+  return false;
+}
+
+void addJob(const std::string& source, u32 kind, std::vector<wsCookJob>* jobs, std::map<std::string, u32>* index) {
+  if (index->count(source)) { return; }
+  wsCookJob job;
+  job.source = source;
+  job.kind = kind;
+  job.linear = false;
+  job.readable = false;
+  job.contentHash = job.key = job.cookedHash = job.sourceSize = 0;
+  job.sourceTime = 0;
+  (*index)[source] = jobs->size();
+  jobs->push_back(job);
+}
+
+//  Adds each texture map a mesh names, as wsMesh resolves it, once
+void findMaps(wsCookJob* job, const wsMappedFile& file, const char* word, bool linear) {
+  char name[WS_MAX_ASSET_PATH];
+  wsTokenizer tok(file.getData(), file.getEnd());
+  for (const char* line = tok.findLine(file.getData(), word); line < file.getEnd(); line = tok.findLine(line + 1, word)) {
+    tok.setPos(line);
+    if (!tok.expect(word) || !tok.readLine(name, WS_MAX_ASSET_PATH)) { return; }
+    std::string path = std::string("textures/") + name;
+    const u32 u = std::find(job->usePaths.begin(), job->usePaths.end(), path) - job->usePaths.begin();
+    if (u < job->usePaths.size()) {
+      //  A map used both ways is cooked as linear data
+      job->useLinear[u] = job->useLinear[u] || linear;
+    }
+    else {
+      job->usePaths.push_back(path);
+      job->useLinear.push_back(linear);
+    }
+  }
+}
+
+//  The key of a cooked mesh or animation, which changes with the layout of its blocks
+u64 cookedKey(u64 contentHash) {
+  const u64 inputs[6] = { contentHash, WS_COOKED_VERSION, WS_COOKER_VERSION, sizeof(wsVert), sizeof(wsJoint), WS_MAX_LODS };
+  return wsHashBuffer64(inputs, sizeof(inputs));
+}
+
+//  Hashes a source asset and, for a mesh, finds the maps it uses. An unchanged mesh takes
+//  its maps from the last manifest rather than being read again.
+void scan(wsCookJob* job, const wsAssetManifest& manifest) {
+  wsMappedFile file;
+  if (!file.openLoose(job->source.c_str())) { return; }
+  job->readable = true;
+  job->contentHash = wsHashBuffer64(file.getData(), file.getSize());
+  //  Recorded for the engine, which loads the source instead if either changes
+  boost::system::error_code error;
+  job->sourceSize = file.getSize();
+  job->sourceTime = (i64)wsFile::last_write_time(job->source, error);
+  //  An STL names no texture maps
+  if (job->kind != WS_COOK_MESH || wsMeshFormat(job->source.c_str()) == WS_MESH_FORMAT_STL) { return; }
+  const wsManifestAsset* last = manifest.find(job->source.c_str());
+  if (last != WS_NULL && last->key == cookedKey(job->contentHash)) {
+    for (u32 u = 0; u < last->numUses; ++u) {
+      job->usePaths.push_back(last->uses[u].path);
+      job->useLinear.push_back(last->uses[u].linear);
+    }
+    return;
+  }
+  findMaps(job, file, "colorMap ", false);
+  findMaps(job, file, "normalMap ", true);
+}
+
+//  Hashes a file, returning false if it cannot be read
+bool hashFile(const char* filepath, u64* hash) {
+  if (!wsFile::exists(filepath)) { return false; }
+  wsMappedFile file;
+  if (!file.openLoose(filepath)) { return false; }
+  *hash = wsHashBuffer64(file.getData(), file.getSize());
+  return true;
+}
+
+//  True if the job's key and cooked file are those of the last run, taking the cooked
+//  file's hash
+bool isCurrent(wsCookJob* job, const wsAssetManifest& manifest) {
+  const wsManifestAsset* last = manifest.find(job->source.c_str());
+  return (last != WS_NULL && last->key == job->key && job->cooked == last->cooked &&
+          hashFile(job->cooked.c_str(), &job->cookedHash) && job->cookedHash == last->cookedHash);
+}
+
+//  Runs work(j) for every j in [first, last) across the thread pool, each thread taking
+//  the next job as it finishes the last, as jobs differ widely in size
+template<typename WorkType>
+void runJobs(u32 first, u32 last, const WorkType& work) {
+  std::atomic<u32> next(first);
+  wsRunParallelChunks(wsThreads.getNumThreads() + 1, 1, [&](u32, u32) {
+    for (u32 j = next++; j < last; j = next++) {
+      work(j);
+    }
+  });
+}
+
+//  True if the pack holds exactly the given files, each with the given contents, and
+//  stores every mapped one
+bool packIsCurrent(const char* packPath, const std::vector<const char*>& paths, const std::vector<u64>& hashes,
+                    bool compress, const bool* mapped) {
+  if (!wsFile::exists(packPath)) { return false; }
+  wsPakFile pak;
+  if (!pak.open(packPath) || pak.getNumEntries() != paths.size()) { return false; }
+  bool anyCompressed = false;
+  for (u32 i = 0; i < paths.size(); ++i) {
+    const wsPakEntry* entry = pak.find(paths[i]);
+    if (entry == WS_NULL || entry->contentHash != hashes[i]) { return false; }
+    if (mapped[i] && (entry->flags & WS_PAK_ENTRY_LZ4)) { return false; }
+    anyCompressed |= ((entry->flags & WS_PAK_ENTRY_LZ4) != 0);
+  }
+  return (anyCompressed == compress);
+}
+
+int main(int argc, char** argv) {
+  u32 format = WS_TEXTURE_FORMAT_SOURCE;
+  u32 quality = WS_COMPRESS_NORMAL;
+  bool force = false;
+  bool compress = false;
+  const char* manifestPath = WS_DEFAULT_MANIFEST;
+  const char* packPath = WS_NULL;
+  std::vector<wsCookJob> jobs;
+  std::map<std::string, u32> index;
+  wsActiveLogs = WS_LOG_MAIN | WS_LOG_INFO | WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  for (i32 a = 1; a < argc; ++a) {
+    if (strcmp(argv[a], "-rgb") == 0) { format = WS_TEXTURE_FORMAT_RGB8; }
+    else if (strcmp(argv[a], "-rgba") == 0) { format = WS_TEXTURE_FORMAT_RGBA8; }
+    else if (strcmp(argv[a], "-bc1") == 0) { format = WS_TEXTURE_FORMAT_BC1; }
+    else if (strcmp(argv[a], "-bc3") == 0) { format = WS_TEXTURE_FORMAT_BC3; }
+    else if (strcmp(argv[a], "-bc5") == 0) { format = WS_TEXTURE_FORMAT_BC5; }
+    else if (strcmp(argv[a], "-fast") == 0) { quality = WS_COMPRESS_FAST; }
+    else if (strcmp(argv[a], "-high") == 0) { quality = WS_COMPRESS_HIGH; }
+    else if (strcmp(argv[a], "-f") == 0) { force = true; }
+    else if (strcmp(argv[a], "-lz4") == 0) { compress = true; }
+    else if (strcmp(argv[a], "-manifest") == 0 && a+1 < argc) { manifestPath = argv[++a]; }
+    else if (strcmp(argv[a], "-pak") == 0 && a+1 < argc) { packPath = argv[++a]; }
+    else {
+      wsPath path(argv[a]);
+      u32 kind;
+      if (wsFile::is_directory(path)) {
+        for (wsFile::recursive_directory_iterator it(path), end; it != end; ++it) {
+          if (wsFile::is_regular_file(it->path()) && classify(it->path(), &kind)) {
+            addJob(wsPakPath(it->path().generic_string().c_str()), kind, &jobs, &index);
+          }
+        }
+      }
+      else if (classify(path, &kind)) {
+        addJob(wsPakPath(path.generic_string().c_str()), kind, &jobs, &index);
+      }
+      else {
+        wsEcho(WS_LOG_ERROR, "\"%s\" is not an asset the engine loads", argv[a]);
+      }
+    }
+  }
+  if (jobs.empty()) {
+    printf("Usage: %s [-rgb | -rgba | -bc1 | -bc3 | -bc5] [-fast | -high] [-f] [-manifest <file>] [-pak <pack>] [-lz4] <file or directory>...\n", argv[0]);
+    return 1;
+  }
+  const f64 startTime = wsGetTime();
+  //  The thread pool runs the jobs, and compresses each level's rows of blocks within them.
+  //  Meshes and animations are parsed onto the memory stack, one at a time.
+  wsMem.startUp(512*wsMB, wsMB);
+  wsThreads.startUp();
+  wsAssetManifest manifest;
+  if (!force && wsFile::exists(manifestPath)) { manifest.open(manifestPath); }
+
+  //  Hash every source, then follow each mesh to its maps, which may add more sources
+  for (u32 scanned = 0; scanned < jobs.size();) {
+    const u32 numJobs = jobs.size();
+    runJobs(scanned, numJobs, [&](u32 j) { scan(&jobs[j], manifest); });
+    for (u32 j = scanned; j < numJobs; ++j) {
+      for (u32 u = 0; u < jobs[j].usePaths.size(); ++u) {
+        const std::string& map = jobs[j].usePaths[u];
+        u32 kind;
+        if (!index.count(map) && wsFile::exists(map) && classify(wsPath(map), &kind)) {
+          addJob(map, kind, &jobs, &index);
+        }
+      }
+    }
+    scanned = numJobs;
+  }
+  u32 numFailed = 0;
+  for (u32 j = 0; j < jobs.size(); ++j) {
+    for (u32 u = 0; u < jobs[j].usePaths.size(); ++u) {
+      std::map<std::string, u32>::iterator map = index.find(jobs[j].usePaths[u]);
+      if (map == index.end() || !jobs[map->second].readable) {
+        wsEcho(WS_LOG_ERROR, "\"%s\" uses \"%s\", which cannot be found", jobs[j].source.c_str(), jobs[j].usePaths[u].c_str());
+        ++numFailed;
+      }
+      else if (jobs[j].useLinear[u]) {
+        jobs[map->second].linear = true;
+      }
+    }
+  }
+
+  //  Keys, and the runtime file each source becomes
+  for (u32 j = 0; j < jobs.size(); ++j) {
+    wsCookJob& job = jobs[j];
+    numFailed += !job.readable;
+    if (job.kind == WS_COOK_IMAGE || job.kind == WS_COOK_MESH || job.kind == WS_COOK_ANIM) {
+      const char* extension = (job.kind == WS_COOK_IMAGE) ? WS_TEXTURE_EXTENSION :
+                              (job.kind == WS_COOK_MESH) ? WS_MESH_EXTENSION : WS_ANIM_EXTENSION;
+      char cookedPath[WS_MAX_ASSET_PATH];
+      if (!wsCookedPath(cookedPath, job.source.c_str(), extension, WS_MAX_ASSET_PATH)) {
+        wsEcho(WS_LOG_ERROR, "Asset path \"%s\" is too long to cook.", job.source.c_str());
+        job.readable = false;
+        ++numFailed;
+        continue;
+      }
+      job.cooked = cookedPath;
+      if (job.kind == WS_COOK_IMAGE) {
+        const u64 inputs[6] = { job.contentHash, format, quality, job.linear, WS_TEXTURE_VERSION, WS_COOKER_VERSION };
+        job.key = wsHashBuffer64(inputs, sizeof(inputs));
+      }
+      else {
+        job.key = cookedKey(job.contentHash);
+      }
+    }
+    else {
+      job.cooked = job.source;
+      job.key = job.contentHash;
+      job.cookedHash = job.contentHash;
+    }
+  }
+
+  //  Cook each image whose key or cooked file differs from the last run
+  std::atomic<u32> numCooked(0), numCookFailed(0);
+  runJobs(0, jobs.size(), [&](u32 j) {
+    wsCookJob& job = jobs[j];
+    if (job.kind != WS_COOK_IMAGE || !job.readable || isCurrent(&job, manifest)) { return; }
+    if (!wsCookTexture(job.source.c_str(), job.cooked.c_str(), format, quality, job.linear) ||
+        !hashFile(job.cooked.c_str(), &job.cookedHash)) {
+      job.readable = false;
+      ++numCookFailed;
+      return;
+    }
+    wsEcho(WS_LOG_MAIN, "Cooked \"%s\"", job.cooked.c_str());
+    ++numCooked;
+  });
+  numFailed += numCookFailed;
+  //  Each mesh or animation is parsed across the thread pool into the front tier of the
+  //  memory stack, which is cleared before the next
+  wsMem.setTier(wsMemoryStack::PRIMARY_FRONT);
+  for (u32 j = 0; j < jobs.size(); ++j) {
+    wsCookJob& job = jobs[j];
+    if ((job.kind != WS_COOK_MESH && job.kind != WS_COOK_ANIM) || !job.readable || isCurrent(&job, manifest)) {
+      continue;
+    }
+    const bool cooked = (job.kind == WS_COOK_MESH) ? wsCookMesh(job.source.c_str(), job.cooked.c_str()) :
+                                                      wsCookAnimation(job.source.c_str(), job.cooked.c_str());
+    wsMem.freePrimaryFront();
+    if (!cooked || !hashFile(job.cooked.c_str(), &job.cookedHash)) {
+      job.readable = false;
+      ++numFailed;
+      continue;
+    }
+    wsEcho(WS_LOG_MAIN, "Cooked \"%s\"", job.cooked.c_str());
+    ++numCooked;
+  }
+
+  //  The manifest lists assets in path order, so the same tree always writes the same file
+  std::sort(jobs.begin(), jobs.end(), [](const wsCookJob& a, const wsCookJob& b) { return a.source < b.source; });
+  std::vector<wsManifestAsset> assets;
+  std::vector<std::vector<wsManifestUse> > uses(jobs.size());
+  for (u32 j = 0; j < jobs.size(); ++j) {
+    if (!jobs[j].readable) { continue; }
+    for (u32 u = 0; u < jobs[j].usePaths.size(); ++u) {
+      wsManifestUse use = { jobs[j].usePaths[u].c_str(), jobs[j].useLinear[u] };
+      uses[j].push_back(use);
+    }
+    wsManifestAsset asset = { jobs[j].key, jobs[j].cookedHash, jobs[j].sourceSize, jobs[j].sourceTime,
+                              jobs[j].source.c_str(), jobs[j].cooked.c_str(), uses[j].empty() ? WS_NULL : &uses[j][0],
+                              (u32)uses[j].size(), 0 };
+    assets.push_back(asset);
+  }
+  manifest.close();
+  bool success = wsWriteManifest(manifestPath, assets.empty() ? WS_NULL : &assets[0], assets.size());
+
+  //  The pack holds every runtime file and the manifest, and is rebuilt only if any differ
+  if (success && packPath != WS_NULL) {
+    std::vector<const char*> paths;
+    std::vector<u64> hashes;
+    std::unique_ptr<bool[]> mapped(new bool[assets.size() + 1]);
+    for (u32 a = 0; a < assets.size(); ++a) {
+      paths.push_back(assets[a].cooked);
+      hashes.push_back(assets[a].cookedHash);
+      const char* extension = strrchr(assets[a].cooked, '.');
+      mapped[a] = (extension != WS_NULL && (strcmp(extension, WS_MESH_EXTENSION) == 0 || strcmp(extension, WS_ANIM_EXTENSION) == 0));
+    }
+    u64 manifestHash = 0;
+    hashFile(manifestPath, &manifestHash);
+    paths.push_back(manifestPath);
+    hashes.push_back(manifestHash);
+    mapped[assets.size()] = false;
+    if (!packIsCurrent(packPath, paths, hashes, compress, mapped.get())) {
+      success = wsWritePak(packPath, &paths[0], paths.size(), compress, mapped.get());
+    }
+  }
+  wsThreads.shutDown();
+  wsMem.shutDown();
+  wsEcho(WS_LOG_MAIN, "%u assets, %u cooked, %u failed, in %.3f seconds", (u32)jobs.size(), (u32)numCooked,
+          numFailed, wsGetTime() - startTime);
+  return (success && numFailed == 0) ? 0 : 1;
+}
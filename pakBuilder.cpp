@@ -0,0 +1,88 @@
+//  pakBuilder.cpp
+//  D. Scott Nettleton
+/*
+ *  This is the offline pack builder for the Whipstitch Game Engine. It writes the
+ *  files it is given into a single .wsPak, which the engine maps once at startup and
+ *  serves assets from in place of the loose files. Directories are packed whole,
+ *  with their subdirectories, in sorted order so the same tree always gives the same
+ *  pack. Paths are stored as given, so run it from the directory the game runs in.
+ *
+ *    pakBuilder [-lz4] <pack> <file or directory>...
+ *
+ *  -lz4 compresses each file which shrinks by enough to be worth expanding at load
+ *  time; already-compressed formats such as PNG and Ogg are stored as they are.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "whipstitch/wsUtils/wsPakFile.h"
+#include "whipstitch/wsUtils/wsLog.h"
+#include "whipstitch/wsUtils/wsOperations.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+//  Gathers regular files, leaving out packs so that one is never packed into another
+void gather(const wsPath& path, std::vector<std::string>* files) {
+  if (wsFile::is_directory(path)) {
+    for (wsFile::recursive_directory_iterator it(path), end; it != end; ++it) {
+      if (wsFile::is_regular_file(it->path()) && it->path().extension() != WS_PAK_EXTENSION) {
+        files->push_back(it->path().generic_string());
+      }
+    }
+  }
+  else if (wsFile::is_regular_file(path)) {
+    files->push_back(path.generic_string());
+  }
+  else {
+    wsEcho(WS_LOG_ERROR, "\"%s\" is not a file or directory", path.string().c_str());
+  }
+}
+
+int main(int argc, char** argv) {
+  bool compress = false;
+  const char* destPath = WS_NULL;
+  std::vector<std::string> files;
+  wsActiveLogs = WS_LOG_MAIN | WS_LOG_INFO | WS_LOG_ERROR;
+  //  Paths are looked up by their hashes
+  wsBuildCRC32HashTable();
+  for (i32 a = 1; a < argc; ++a) {
+    if (strcmp(argv[a], "-lz4") == 0) { compress = true; }
+    else if (destPath == WS_NULL) { destPath = argv[a]; }
+    else { gather(wsPath(argv[a]), &files); }
+  }
+  if (destPath == WS_NULL || files.empty()) {
+    printf("Usage: %s [-lz4] <pack> <file or directory>...\n", argv[0]);
+    return 1;
+  }
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  std::vector<const char*> paths;
+  for (u32 i = 0; i < files.size(); ++i) {
+    paths.push_back(files[i].c_str());
+  }
+  return wsWritePak(destPath, &paths[0], paths.size(), compress) ? 0 : 1;
+}
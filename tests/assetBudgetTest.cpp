@@ -0,0 +1,181 @@
+/*
+ * assetBudgetTest.cpp
+ *
+ *    Tests the asset registry's budgets against a stand-in for the renderer, which
+ *    counts each texture as a fixed amount of video memory. A working set of textures
+ *    larger than the budget is requested over and over; the registry must keep within
+ *    the budget, evict the least recently used texture first, never evict one still
+ *    referenced, and reload an evicted texture in place when it is requested again.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsAssetRegistry.h"
+#include "../whipstitch/wsAudio/wsSound.h"
+#include "../whipstitch/wsGraphics/wsRenderSystem.h"
+#include "../whipstitch/wsGraphics/wsShader.h"
+
+#define WS_TEST_TEXTURE_BYTES (4*wsMB + 4*wsMB/3)  //  1024x1024 with its mipmaps
+#define WS_TEST_BUDGET_TEXTURES 3
+#define WS_TEST_PASSES 3
+#define WS_TEST_NUM_TEXTURES 8
+
+//  Each with different contents, so none is shared with another
+const char* texturePaths[WS_TEST_NUM_TEXTURES] = {
+  "textures/blueBricks.png", "textures/blueStones.png", "textures/stoneSlabs.png", "textures/test.png",
+  "textures/test2.png", "textures/bladeWand_skin.png", "textures/chibiGriswaldSkin.png", "textures/textBox.png"
+};
+
+wsRenderSystem wsRenderer;
+u32 numTexturesLive = 0;
+
+/*  The stand-in renderer  */
+void wsRenderSystem::loadTexture(u32* index, const char* filename, bool autoSmooth, bool tiling, bool linear) {
+  static u32 nextTexture = 0;
+  *index = ++nextTexture;
+  ++numTexturesLive;
+}
+
+void wsRenderSystem::unloadTexture(const char* filename) {
+  --numTexturesLive;
+}
+
+u64 wsRenderSystem::getTextureBytes(u32 texture) {
+  return (texture) ? WS_TEST_TEXTURE_BYTES : 0;
+}
+
+/*  The registry links against every type of asset, though this test loads textures only  */
+wsSound::wsSound(const char* filePath) {}
+wsSound::~wsSound() {}
+void alGetBufferi(ALuint buffer, ALenum param, ALint* value) { *value = 0; }
+wsFont::wsFont(const char* filePath, f32 fontHeight) {}
+wsFont::~wsFont() {}
+wsShader::wsShader(const char* vertexShaderPath, const char* fragmentShaderPath, bool delayLinking) {}
+wsShader::~wsShader() {}
+
+//  Requests a texture and gives the reference straight back, as a frame drawing it would
+wsAssetRef touch(u32 t) {
+  wsAssetRef ref = wsRegistry.loadTexture(texturePaths[t]);
+  wsCheck(wsRegistry.isResident(ref));
+  wsRegistry.release(ref);
+  return ref;
+}
+
+//  True if the resident textures use what the renderer holds, and keep within the limit
+bool withinBudget() {
+  const wsAssetBudget& budget = wsRegistry.getBudget(WS_ASSET_TYPE_TEXTURE);
+  return (budget.gpuBytes == numTexturesLive*WS_TEST_TEXTURE_BYTES && budget.gpuBytes <= budget.maxGPUBytes);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  wsRegistry.startUp();
+  wsRegistry.setBudget(WS_ASSET_TYPE_TEXTURE, 0, WS_TEST_BUDGET_TEXTURES*WS_TEST_TEXTURE_BYTES);
+  const wsAssetBudget& budget = wsRegistry.getBudget(WS_ASSET_TYPE_TEXTURE);
+  wsAssetRef refs[WS_TEST_NUM_TEXTURES];
+
+  //  Cycling through more than fits misses every time, since the next texture wanted is
+  //  always the one used longest ago
+  u32 numOverBudget = 0;
+  for (u32 pass = 0; pass < WS_TEST_PASSES; ++pass) {
+    for (u32 t = 0; t < WS_TEST_NUM_TEXTURES; ++t) {
+      refs[t] = touch(t);
+      numOverBudget += !withinBudget();
+    }
+  }
+  printf("  %u textures cycled %u times through a budget of %u: %u hits, %u misses, %u evictions\n",
+          WS_TEST_NUM_TEXTURES, WS_TEST_PASSES, WS_TEST_BUDGET_TEXTURES, budget.hits, budget.misses, budget.evictions);
+  wsCheck(numOverBudget == 0);
+  wsCheck(budget.numResident == WS_TEST_BUDGET_TEXTURES);
+  wsCheck(budget.hits == 0);
+  wsCheck(budget.misses == WS_TEST_PASSES*WS_TEST_NUM_TEXTURES);
+  wsCheck(budget.evictions == budget.misses - WS_TEST_BUDGET_TEXTURES);
+  for (u32 t = 0; t < WS_TEST_NUM_TEXTURES; ++t) {
+    wsCheck(wsRegistry.isResident(refs[t]) == (t >= WS_TEST_NUM_TEXTURES - WS_TEST_BUDGET_TEXTURES));
+  }
+
+  //  Using the oldest resident texture spares it; the next oldest goes instead
+  u32 hits = budget.hits;
+  touch(5);
+  wsCheck(budget.hits == hits + 1);
+  touch(0);
+  wsCheck(wsRegistry.isResident(refs[5]));
+  wsCheck(!wsRegistry.isResident(refs[6]));
+  wsCheck(wsRegistry.isResident(refs[7]));
+  wsCheck(wsRegistry.isResident(refs[0]));
+
+  //  An evicted reference stays valid, and reloads its texture when next used
+  u32 misses = budget.misses;
+  wsCheck(wsRegistry.getRefCount(refs[6]) == 0);
+  wsCheck(wsRegistry.getTexture(refs[6]) != 0);
+  wsCheck(wsRegistry.isResident(refs[6]));
+  wsCheck(budget.misses == misses + 1);
+  wsCheck(withinBudget());
+
+  //  A texture in use is never evicted, however long ago it was requested
+  wsAssetRef held = wsRegistry.loadTexture(texturePaths[1]);
+  u32 numHeldEvicted = 0;
+  numOverBudget = 0;
+  for (u32 pass = 0; pass < WS_TEST_PASSES; ++pass) {
+    for (u32 t = 0; t < WS_TEST_NUM_TEXTURES; ++t) {
+      if (t == 1) { continue; }
+      touch(t);
+      numHeldEvicted += !wsRegistry.isResident(held);
+      numOverBudget += !withinBudget();
+    }
+  }
+  wsCheck(numHeldEvicted == 0);
+  wsCheck(numOverBudget == 0);
+
+  //  When every resident texture is in use the budget gives way, until one is released
+  wsAssetRef alsoHeld[WS_TEST_BUDGET_TEXTURES];
+  for (u32 t = 0; t < WS_TEST_BUDGET_TEXTURES; ++t) { alsoHeld[t] = wsRegistry.loadTexture(texturePaths[t + 2]); }
+  wsCheck(budget.numResident == WS_TEST_BUDGET_TEXTURES + 1);
+  wsCheck(wsRegistry.isResident(held));
+  wsCheck(!withinBudget());
+  wsRegistry.release(held);
+  wsCheck(!wsRegistry.isResident(held));
+  wsCheck(withinBudget());
+  for (u32 t = 0; t < WS_TEST_BUDGET_TEXTURES; ++t) {
+    wsCheck(wsRegistry.isResident(alsoHeld[t]));
+    wsRegistry.release(alsoHeld[t]);
+  }
+
+  //  Lowering the budget evicts at once
+  wsRegistry.setBudget(WS_ASSET_TYPE_TEXTURE, 0, WS_TEST_TEXTURE_BYTES);
+  wsCheck(budget.numResident == 1);
+  wsCheck(withinBudget());
+
+  wsRegistry.unloadUnused();
+  wsCheck(budget.numResident == 0);
+  wsCheck(numTexturesLive == 0);
+  wsRegistry.shutDown();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("assetBudgetTest");
+}
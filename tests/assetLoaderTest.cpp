@@ -0,0 +1,296 @@
+/*
+ * assetLoaderTest.cpp
+ *
+ *    Tests the asset loader against a stand-in for the renderer and OpenAL, so no
+ *    GL context or audio device is needed. The stand-ins take a fixed time to decode
+ *    an image or create a texture, and note which thread they run on: decoding must
+ *    happen on the workers, and texture and sound creation on the main thread. Checks
+ *    that requests return at once and complete by polling and by callback, that
+ *    missing and malformed files are reported as failures, that released handles go
+ *    stale, and that update() keeps within its budget. Then compares the worst frame of loading a set of textures
+ *    through the loader against loading them on the main thread.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsGameFlow/wsAssetLoader.h"
+#include <atomic>
+#include <cstdlib>
+
+#define WS_TEST_DECODE_TIME 0.004   //  Seconds the stand-in takes to decode an image
+#define WS_TEST_UPLOAD_TIME 0.001   //  Seconds it takes to create a texture
+#define WS_TEST_BUDGET 0.002
+#define WS_TEST_TEXTURES 24
+#define WS_TEST_WORKERS 2
+#define WS_TEST_TEXTURE_PATH "textures/blueBricks.png"
+#define WS_TEST_CORRUPT_MESH "/tmp/assetLoaderTest.wsMesh"
+#define WS_TEST_CORRUPT_ANIMATION "/tmp/assetLoaderTest.wsAnim"
+
+wsRenderSystem wsRenderer;
+pthread_t mainThread;
+std::atomic<u32> numDecodes(0);
+std::atomic<u32> numDecodesOnMain(0);
+std::atomic<u32> numCreates(0);
+std::atomic<u32> numCreatesOffMain(0);
+std::atomic<u32> numImagesLive(0);
+
+//  Spins rather than sleeping, as real decoding and uploading would keep the thread busy
+void spin(t64 seconds) {
+  t64 endTime = wsGetTime() + seconds;
+  while (wsGetTime() < endTime) {}
+}
+
+bool onMainThread() {
+  return pthread_equal(pthread_self(), mainThread);
+}
+
+/*  The stand-in renderer  */
+bool wsRenderSystem::decodeImage(wsImage* image, const char* filename, bool linear) {
+  ++numDecodes;
+  if (onMainThread()) { ++numDecodesOnMain; }
+  image->cooked = WS_NULL;
+  image->pixels = WS_NULL;
+  if (!wsVFS.exists(filename)) { return false; }
+  spin(WS_TEST_DECODE_TIME);
+  image->width = image->height = 4;
+  image->channels = 4;
+  image->numLevels = 1;
+  image->pixels = (u8*)malloc(4*4*4);
+  ++numImagesLive;
+  return true;
+}
+
+void wsRenderSystem::createTexture(u32* index, const char* filename, wsImage* image, bool autoSmooth, bool tiling) {
+  static u32 nextTexture = 0;
+  ++numCreates;
+  if (!onMainThread()) { ++numCreatesOffMain; }
+  spin(WS_TEST_UPLOAD_TIME);
+  *index = ++nextTexture;
+  freeImage(image);
+}
+
+void wsRenderSystem::freeImage(wsImage* image) {
+  if (image->pixels != WS_NULL) {
+    free(image->pixels);
+    image->pixels = WS_NULL;
+    --numImagesLive;
+  }
+}
+
+/*  The stand-in OpenAL  */
+std::atomic<u32> numSounds(0);
+std::atomic<u32> numSoundsOffMain(0);
+
+ALvoid* alutLoadMemoryFromFileImage(const ALvoid* data, ALsizei length, ALenum* format, ALsizei* size, ALfloat* frequency) {
+  *format = 0;
+  *size = length;
+  *frequency = 44100.0f;
+  return malloc(length);
+}
+ALenum alutGetError() { return 0; }
+const char* alutGetErrorString(ALenum error) { return "none"; }
+
+wsSound::wsSound(ALenum format, const ALvoid* data, ALsizei size, ALfloat frequency) {
+  ++numSounds;
+  if (!onMainThread()) { ++numSoundsOffMain; }
+}
+
+/*  Callbacks  */
+struct wsCallbackLog {
+  u32 numCalls;
+  u32 lastStatus;
+  wsAssetHandle lastHandle;
+};
+
+void logCallback(wsAssetHandle handle, u32 status, void* userData) {
+  wsCallbackLog* log = (wsCallbackLog*)userData;
+  ++log->numCalls;
+  log->lastStatus = status;
+  log->lastHandle = handle;
+}
+
+//  Writes the first half of a file to another, as an interrupted copy would leave it
+void writeTruncated(const char* destPath, const char* srcPath) {
+  wsMappedFile src;
+  FILE* dest = fopen(destPath, "wb");
+  if (src.open(srcPath) && dest != WS_NULL) { fwrite(src.getData(), 1, src.getSize()/2, dest); }
+  if (dest != WS_NULL) { fclose(dest); }
+}
+
+void testRequests() {
+  wsCallbackLog log = { 0, 0, WS_NULL };
+  //  Requests return before the work is done
+  t64 beginTime = wsGetTime();
+  wsAssetHandle texture = wsLoader.loadTexture(WS_TEST_TEXTURE_PATH, true, false, logCallback, &log);
+  wsCheck(wsGetTime() - beginTime < WS_TEST_DECODE_TIME);
+  wsCheck(texture != WS_NULL);
+  wsCheck(!wsLoader.isReady(texture));
+  wsCheck(wsLoader.getTexture(texture) == 0);
+  wsCheck(wsLoader.waitFor(texture) == WS_ASSET_STATUS_READY);
+  wsCheck(wsLoader.getTexture(texture) != 0);
+  wsCheck(log.numCalls == 1);
+  wsCheck(log.lastStatus == WS_ASSET_STATUS_READY);
+  wsCheck(log.lastHandle == texture);
+
+  //  A mesh's textures are decoded with it and created afterward, one per piece of work
+  wsAssetHandle mesh = wsLoader.loadMesh("models/Griswald.wsMesh");
+  wsAssetHandle animation = wsLoader.loadAnimation("models/Walk.wsAnim");
+  wsAssetHandle sound = wsLoader.loadSound("sounds/btnClick.wav");
+  wsCheck(wsLoader.waitFor(mesh) == WS_ASSET_STATUS_READY);
+  wsCheck(wsLoader.waitFor(animation) == WS_ASSET_STATUS_READY);
+  wsCheck(wsLoader.waitFor(sound) == WS_ASSET_STATUS_READY);
+  wsMesh* griswald = wsLoader.getMesh(mesh);
+  wsCheck(griswald != WS_NULL && griswald->getNumVerts() > 0);
+  u32 numMapped = 0;
+  bool allCreated = true;
+  for (u32 m = 0; griswald != WS_NULL && m < griswald->getNumMaterials(); ++m) {
+    const wsMaterial& mat = griswald->getMats()[m];
+    if (mat.colorMapPath != WS_NULL) {
+      ++numMapped;
+      allCreated = allCreated && (mat.colorMap != 0);
+    }
+  }
+  wsCheck(numMapped > 0);
+  wsCheck(allCreated);
+  wsCheck(wsLoader.getAnimation(animation) != WS_NULL && wsLoader.getAnimation(animation)->getNumKeyframes() > 0);
+  wsCheck(wsLoader.getSound(sound) != WS_NULL);
+  //  A handle of one type gives nothing as another
+  wsCheck(wsLoader.getMesh(animation) == WS_NULL);
+
+  //  A missing file fails, through the callback as well
+  log.numCalls = 0;
+  wsAssetHandle missing = wsLoader.loadMesh("models/missing.wsMesh", logCallback, &log);
+  wsCheck(wsLoader.waitFor(missing) == WS_ASSET_STATUS_FAILED);
+  wsCheck(wsLoader.getMesh(missing) == WS_NULL);
+  wsCheck(log.numCalls == 1);
+  wsCheck(log.lastStatus == WS_ASSET_STATUS_FAILED);
+
+  //  So does a malformed one, rather than giving an empty asset
+  writeTruncated(WS_TEST_CORRUPT_MESH, "models/Griswald.wsMesh");
+  writeTruncated(WS_TEST_CORRUPT_ANIMATION, "models/Walk.wsAnim");
+  log.numCalls = 0;
+  wsAssetHandle corruptMesh = wsLoader.loadMesh(WS_TEST_CORRUPT_MESH, logCallback, &log);
+  wsAssetHandle corruptAnimation = wsLoader.loadAnimation(WS_TEST_CORRUPT_ANIMATION, logCallback, &log);
+  wsCheck(wsLoader.waitFor(corruptMesh) == WS_ASSET_STATUS_FAILED);
+  wsCheck(wsLoader.waitFor(corruptAnimation) == WS_ASSET_STATUS_FAILED);
+  wsCheck(wsLoader.getMesh(corruptMesh) == WS_NULL);
+  wsCheck(wsLoader.getAnimation(corruptAnimation) == WS_NULL);
+  wsCheck(log.numCalls == 2);
+  wsCheck(log.lastStatus == WS_ASSET_STATUS_FAILED);
+  remove(WS_TEST_CORRUPT_MESH);
+  remove(WS_TEST_CORRUPT_ANIMATION);
+
+  //  Released handles go stale, even once their slot is reused
+  wsLoader.release(texture);
+  wsCheck(wsLoader.getStatus(texture) == WS_ASSET_STATUS_NONE);
+  wsCheck(wsLoader.getTexture(texture) == 0);
+  wsAssetHandle reused = wsLoader.loadTexture(WS_TEST_TEXTURE_PATH);
+  wsCheck(reused != texture);
+  wsCheck(wsLoader.waitFor(reused) == WS_ASSET_STATUS_READY);
+  wsCheck(wsLoader.getStatus(texture) == WS_ASSET_STATUS_NONE);
+  wsLoader.release(reused);
+  wsLoader.release(mesh);
+  wsLoader.release(animation);
+  wsLoader.release(sound);
+  wsLoader.release(missing);
+  wsLoader.release(corruptMesh);
+  wsLoader.release(corruptAnimation);
+
+  wsCheck(numDecodes.load() > 0);
+  wsCheck(numDecodesOnMain.load() == 0);
+  wsCheck(numCreatesOffMain.load() == 0);
+  wsCheck(numSounds.load() == 1);
+  wsCheck(numSoundsOffMain.load() == 0);
+  wsCheck(numImagesLive.load() == 0);
+}
+
+//  Loads the textures through the loader, calling update() once a frame; returns the
+//  longest frame
+t64 loadAsynchronously(u32* numFrames) {
+  wsAssetHandle handles[WS_TEST_TEXTURES];
+  for (u32 i = 0; i < WS_TEST_TEXTURES; ++i) {
+    handles[i] = wsLoader.loadTexture(WS_TEST_TEXTURE_PATH);
+  }
+  t64 worstFrame = 0.0;
+  u32 numReady = 0;
+  *numFrames = 0;
+  while (numReady < WS_TEST_TEXTURES) {
+    t64 beginTime = wsGetTime();
+    wsLoader.update();
+    t64 frameTime = wsGetTime() - beginTime;
+    if (frameTime > worstFrame) { worstFrame = frameTime; }
+    ++*numFrames;
+    numReady = 0;
+    for (u32 i = 0; i < WS_TEST_TEXTURES; ++i) { numReady += wsLoader.isReady(handles[i]); }
+    //  The rest of the frame
+    wsWait(0.001);
+  }
+  for (u32 i = 0; i < WS_TEST_TEXTURES; ++i) { wsLoader.release(handles[i]); }
+  return worstFrame;
+}
+
+//  Loads the same textures on the main thread, as the renderer does without the loader
+t64 loadSynchronously() {
+  t64 beginTime = wsGetTime();
+  for (u32 i = 0; i < WS_TEST_TEXTURES; ++i) {
+    wsImage image;
+    u32 texture;
+    wsRenderer.decodeImage(&image, WS_TEST_TEXTURE_PATH);
+    wsRenderer.createTexture(&texture, WS_TEST_TEXTURE_PATH, &image);
+  }
+  return wsGetTime() - beginTime;
+}
+
+void benchmarkHitches() {
+  u32 numFrames = 0;
+  t64 asyncWorst = loadAsynchronously(&numFrames);
+  t64 syncFrame = loadSynchronously();
+  printf("  Loading %u textures, each %.1f ms to decode and %.1f ms to create:\n", WS_TEST_TEXTURES,
+          WS_TEST_DECODE_TIME*1000.0, WS_TEST_UPLOAD_TIME*1000.0);
+  printf("    through the loader: worst frame %.2f ms over %u frames\n", asyncWorst*1000.0, numFrames);
+  printf("    on the main thread: one frame of %.2f ms\n", syncFrame*1000.0);
+  //  The loader overruns its budget by at most one piece of work, plus scheduling noise,
+  //  when its workers need not share the main thread's core
+  if (WS_NUM_CORES > WS_TEST_WORKERS) {
+    wsCheck(asyncWorst < WS_TEST_BUDGET + WS_TEST_UPLOAD_TIME + 0.004);
+  }
+  wsCheck(numFrames > 1);
+  wsCheck(asyncWorst*4.0 < syncFrame);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  mainThread = pthread_self();
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  wsLoader.startUp(WS_TEST_WORKERS, WS_DEFAULT_MAX_ASSET_REQUESTS, WS_TEST_BUDGET);
+  testRequests();
+  benchmarkHitches();
+  wsLoader.shutDown();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("assetLoaderTest");
+}
@@ -0,0 +1,253 @@
+/*
+ * assetRegistryTest.cpp
+ *
+ *    Tests that the asset registry loads each asset once, against a stand-in for the
+ *    renderer which counts the textures it holds. Every spelling of one path must give
+ *    the same reference, as must two files with the same contents, and each load,
+ *    acquire and release must be counted, so that nothing in use is unloaded and
+ *    nothing unused is kept.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsAssetRegistry.h"
+#include "../whipstitch/wsAudio/wsSound.h"
+#include "../whipstitch/wsGraphics/wsRenderSystem.h"
+#include "../whipstitch/wsGraphics/wsShader.h"
+
+#define WS_TEST_TEXTURE_BYTES (4*wsMB)
+#define WS_TEST_MESH_COPY "/tmp/assetRegistryTest.wsMesh"
+#define WS_TEST_CORRUPT_MESH "/tmp/assetRegistryTestCorrupt.wsMesh"
+
+//  Spellings of one file, all of which normalize to the first
+const char* sameTexture[] = {
+  "textures/test.png", "textures/./test.png", "textures//test.png", "models/../textures/test.png", "textures\\test.png",
+  "./textures/test.png"
+};
+#define WS_TEST_NUM_SPELLINGS (sizeof(sameTexture)/sizeof(sameTexture[0]))
+
+wsRenderSystem wsRenderer;
+u32 numTexturesLive = 0;
+u32 numTexturesCreated = 0;
+
+/*  The stand-in renderer  */
+void wsRenderSystem::loadTexture(u32* index, const char* filename, bool autoSmooth, bool tiling, bool linear) {
+  *index = ++numTexturesCreated;
+  ++numTexturesLive;
+}
+
+void wsRenderSystem::unloadTexture(const char* filename) {
+  --numTexturesLive;
+}
+
+u64 wsRenderSystem::getTextureBytes(u32 texture) {
+  return (texture) ? WS_TEST_TEXTURE_BYTES : 0;
+}
+
+/*  The registry links against every type of asset, though this test loads meshes and textures only  */
+wsSound::wsSound(const char* filePath) {}
+wsSound::~wsSound() {}
+void alGetBufferi(ALuint buffer, ALenum param, ALint* value) { *value = 0; }
+wsFont::wsFont(const char* filePath, f32 fontHeight) {}
+wsFont::~wsFont() {}
+wsShader::wsShader(const char* vertexShaderPath, const char* fragmentShaderPath, bool delayLinking) {}
+wsShader::~wsShader() {}
+
+u64 fileSize(const char* path) {
+  wsMappedFile file;
+  return file.open(path) ? file.getSize() : 0;
+}
+
+//  Writes the first numBytes of the source to dest, or all of it if numBytes is 0
+void copyFile(const char* dest, const char* source, u64 numBytes = 0) {
+  wsMappedFile file;
+  wsCheck(file.open(source));
+  FILE* out = fopen(dest, "wb");
+  wsCheck(out != WS_NULL);
+  if (out == WS_NULL) { return; }
+  fwrite(file.getData(), 1, (numBytes) ? numBytes : file.getSize(), out);
+  fclose(out);
+}
+
+void testPaths() {
+  //  Every spelling of a path is one request, answered by one texture
+  u64 bytesLoaded = wsRegistry.getBytesLoaded();
+  u64 bytesSaved = wsRegistry.getBytesSaved();
+  wsAssetRef refs[WS_TEST_NUM_SPELLINGS];
+  for (u32 i = 0; i < WS_TEST_NUM_SPELLINGS; ++i) {
+    refs[i] = wsRegistry.loadTexture(sameTexture[i]);
+    wsCheck(refs[i] == refs[0]);
+  }
+  wsCheck(refs[0] != WS_NULL);
+  wsCheck(numTexturesLive == 1);
+  wsCheck(wsRegistry.getRefCount(refs[0]) == WS_TEST_NUM_SPELLINGS);
+  wsCheck(wsRegistry.getBytesLoaded() == bytesLoaded + fileSize(sameTexture[0]));
+  wsCheck(wsRegistry.getBytesSaved() == bytesSaved + (WS_TEST_NUM_SPELLINGS - 1)*fileSize(sameTexture[0]));
+
+  //  The renderer keeps one texture per file, so other settings share it too
+  wsAssetRef linear = wsRegistry.loadTexture(sameTexture[0], false, true, true);
+  wsCheck(linear == refs[0]);
+  wsCheck(numTexturesLive == 1);
+
+  //  Other files are other textures
+  wsAssetRef other = wsRegistry.loadTexture("textures/test2.png");
+  wsCheck(other != WS_NULL && other != refs[0]);
+  wsCheck(wsRegistry.getTexture(other) != wsRegistry.getTexture(refs[0]));
+  wsCheck(numTexturesLive == 2);
+
+  //  So are missing files, which take no entry
+  wsCheck(wsRegistry.loadTexture("textures/missing.png") == WS_NULL);
+  wsCheck(wsRegistry.loadTexture("textures/../textures/missing.png") == WS_NULL);
+  wsCheck(numTexturesLive == 2);
+
+  for (u32 i = 0; i < WS_TEST_NUM_SPELLINGS; ++i) { wsRegistry.release(refs[i]); }
+  wsRegistry.release(linear);
+  wsRegistry.release(other);
+  wsCheck(wsRegistry.unloadUnused() == 2);
+  wsCheck(numTexturesLive == 0);
+}
+
+void testContents() {
+  //  Two names for the same bytes share one texture
+  u64 bytesLoaded = wsRegistry.getBytesLoaded();
+  wsAssetRef stones = wsRegistry.loadTexture("textures/blueStones_norm.png", true, false, true);
+  wsAssetRef slabs = wsRegistry.loadTexture("textures/stoneSlabs_norm.png", true, false, true);
+  wsCheck(stones != WS_NULL);
+  wsCheck(slabs == stones);
+  wsCheck(numTexturesLive == 1);
+  wsCheck(wsRegistry.getRefCount(stones) == 2);
+  wsCheck(wsRegistry.getBytesLoaded() == bytesLoaded + fileSize("textures/blueStones_norm.png"));
+  //  The second name is then known by its path, without reading the file again
+  wsAssetRef slabsAgain = wsRegistry.loadTexture("textures/./stoneSlabs_norm.png", true, false, true);
+  wsCheck(slabsAgain == stones);
+  wsCheck(wsRegistry.getRefCount(stones) == 3);
+
+  //  A texture whose name a mesh shares with nothing else is still its own
+  wsAssetRef bricks = wsRegistry.loadTexture("textures/blueBricks_norm.png", true, false, true);
+  wsCheck(bricks != WS_NULL && bricks != stones);
+
+  //  The same for meshes: a copy of one is the mesh already loaded
+  copyFile(WS_TEST_MESH_COPY, "models/blueBox.wsMesh");
+  u32 numLive = numTexturesLive;
+  wsAssetRef box = wsRegistry.loadMesh("models/blueBox.wsMesh");
+  wsAssetRef copy = wsRegistry.loadMesh(WS_TEST_MESH_COPY);
+  wsCheck(box != WS_NULL);
+  wsCheck(copy == box);
+  wsCheck(wsRegistry.getMesh(copy) == wsRegistry.getMesh(box));
+  wsCheck(wsRegistry.getRefCount(box) == 2);
+  //  Its color map is new; its normal map is the one requested above
+  wsCheck(numTexturesLive == numLive + 1);
+  wsCheck(wsRegistry.getRefCount(bricks) == 2);
+  remove(WS_TEST_MESH_COPY);
+
+  wsRegistry.release(stones);
+  wsRegistry.release(slabs);
+  wsRegistry.release(slabsAgain);
+  wsRegistry.release(bricks);
+  wsRegistry.release(box);
+  wsRegistry.release(copy);
+  wsCheck(wsRegistry.unloadUnused() == 4);
+  wsCheck(numTexturesLive == 0);
+}
+
+void testRefCounts() {
+  //  Each load and acquire counts a reference, and each release gives one back
+  wsAssetRef texture = wsRegistry.loadTexture("textures/blueBricks.png");
+  wsCheck(wsRegistry.getRefCount(texture) == 1);
+  wsCheck(wsRegistry.acquire(texture) == texture);
+  wsCheck(wsRegistry.getRefCount(texture) == 2);
+  wsCheck(wsRegistry.loadTexture("textures/blueBricks.png") == texture);
+  wsCheck(wsRegistry.release(texture) == 2);
+  wsCheck(wsRegistry.release(texture) == 1);
+  //  Nothing in use is unloaded
+  wsCheck(wsRegistry.unloadUnused() == 0);
+  wsCheck(wsRegistry.isResident(texture));
+  wsCheck(wsRegistry.release(texture) == 0);
+  //  An asset with no references stays cached until unloaded, and is found again
+  wsCheck(wsRegistry.isResident(texture));
+  wsCheck(wsRegistry.loadTexture("textures/blueBricks.png") == texture);
+  wsCheck(wsRegistry.release(texture) == 0);
+  wsCheck(wsRegistry.unloadUnused() == 1);
+  wsCheck(numTexturesLive == 0);
+
+  //  Then the reference is stale, even once its slot holds the same file again
+  wsCheck(!wsRegistry.isResident(texture));
+  wsCheck(wsRegistry.getRefCount(texture) == 0);
+  wsCheck(wsRegistry.getTexture(texture) == 0);
+  wsAssetRef reloaded = wsRegistry.loadTexture("textures/blueBricks.png");
+  wsCheck(reloaded != WS_NULL && reloaded != texture);
+  wsCheck(wsRegistry.getTexture(texture) == 0);
+  //  A reference of one type gives nothing as another
+  wsCheck(wsRegistry.getMesh(reloaded) == WS_NULL);
+  wsRegistry.release(reloaded);
+
+  //  A mesh holds a reference to its texture for each material which uses it
+  wsAssetRef wand = wsRegistry.loadMesh("models/bladeWand.wsMesh");
+  wsMesh* mesh = wsRegistry.getMesh(wand);
+  wsCheck(mesh != WS_NULL);
+  u32 numColorMaps = 0;
+  for (u32 m = 0; mesh != WS_NULL && m < mesh->getNumMaterials(); ++m) {
+    numColorMaps += (mesh->getMats()[m].colorMapPath != WS_NULL);
+  }
+  wsCheck(numColorMaps > 1);
+  wsAssetRef skin = wsRegistry.loadTexture("textures/bladeWand_skin.png");
+  wsCheck(wsRegistry.getRefCount(skin) == numColorMaps + 1);
+  for (u32 m = 0; mesh != WS_NULL && m < mesh->getNumMaterials(); ++m) {
+    if (mesh->getMats()[m].colorMapPath != WS_NULL) {
+      wsCheck(mesh->getMats()[m].colorMap == wsRegistry.getTexture(skin));
+    }
+  }
+  //  Unloading the mesh gives them back, but the texture is still held here
+  wsCheck(wsRegistry.release(wand) == 0);
+  wsCheck(wsRegistry.unloadUnused() == 2);  //  The mesh, and blueBricks.png from above
+  wsCheck(wsRegistry.getMesh(wand) == WS_NULL);
+  wsCheck(wsRegistry.getRefCount(skin) == 1);
+  wsCheck(wsRegistry.isResident(skin));
+  wsCheck(wsRegistry.release(skin) == 0);
+  wsCheck(wsRegistry.unloadUnused() == 1);
+
+  //  A malformed mesh fails, and gives back its entry
+  copyFile(WS_TEST_CORRUPT_MESH, "models/blueBox.wsMesh", fileSize("models/blueBox.wsMesh")/2);
+  wsCheck(wsRegistry.loadMesh(WS_TEST_CORRUPT_MESH) == WS_NULL);
+  wsCheck(wsRegistry.loadMesh(WS_TEST_CORRUPT_MESH) == WS_NULL);
+  remove(WS_TEST_CORRUPT_MESH);
+  wsCheck(wsRegistry.unloadUnused() == 0);
+  wsCheck(numTexturesLive == 0);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  wsRegistry.startUp();
+  testPaths();
+  testContents();
+  testRefCounts();
+  wsRegistry.shutDown();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("assetRegistryTest");
+}
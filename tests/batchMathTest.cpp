@@ -0,0 +1,273 @@
+/*
+ * batchMathTest.cpp
+ *
+ *    Tests the batch math kernels at every SIMD level the processor supports against
+ *    the one-at-a-time vec4, quat and wsTransform operations they replace. Each kernel
+ *    runs over counts around every vector width, so the scalar tails are exercised,
+ *    and must leave the element after the last untouched. Then times each kernel at
+ *    each level, and the vec4 * mat4 loop the point transform replaces.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <cmath>
+
+#define WS_TEST_ELEMENTS 16384
+#define WS_TEST_TOLERANCE 1.0e-4f
+#define WS_BENCH_ROUNDS 200
+//  Marks output the kernels must not have written
+#define WS_UNTOUCHED -999.0f
+
+wsVec3Stream newVec3Stream(f32 minVal, f32 maxVal) {
+  wsVec3Stream my = { wsNewArray(f32, WS_TEST_ELEMENTS), wsNewArray(f32, WS_TEST_ELEMENTS),
+                      wsNewArray(f32, WS_TEST_ELEMENTS) };
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    my.x[i] = wsRandomFloat(minVal, maxVal);
+    my.y[i] = wsRandomFloat(minVal, maxVal);
+    my.z[i] = wsRandomFloat(minVal, maxVal);
+  }
+  return my;
+}
+
+wsQuatStream newQuatStream(bool unit) {
+  wsQuatStream my = { wsNewArray(f32, WS_TEST_ELEMENTS), wsNewArray(f32, WS_TEST_ELEMENTS),
+                      wsNewArray(f32, WS_TEST_ELEMENTS), wsNewArray(f32, WS_TEST_ELEMENTS) };
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    quat q(wsRandomFloat(-1.0f, 1.0f), wsRandomFloat(-1.0f, 1.0f),
+            wsRandomFloat(-1.0f, 1.0f), wsRandomFloat(-1.0f, 1.0f));
+    if (unit) { q = q.normal(); }
+    my.x[i] = q.x;
+    my.y[i] = q.y;
+    my.z[i] = q.z;
+    my.w[i] = q.w;
+  }
+  return my;
+}
+
+quat getQuat(const wsQuatStream& stream, u32 index) {
+  return quat(stream.x[index], stream.y[index], stream.z[index], stream.w[index]);
+}
+
+void clear(const wsVec3Stream& stream) {
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) { stream.x[i] = stream.y[i] = stream.z[i] = WS_UNTOUCHED; }
+}
+
+void clear(const wsQuatStream& stream) {
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    stream.x[i] = stream.y[i] = stream.z[i] = stream.w[i] = WS_UNTOUCHED;
+  }
+}
+
+//  The largest error seen, relative to the expected value when it exceeds one
+f32 maxError = 0.0f;
+
+void compare(f32 actual, f32 expected) {
+  f32 error = fabsf(actual - expected)/(1.0f + fabsf(expected));
+  if (!(error <= maxError)) { maxError = (error == error) ? error : 1.0e30f; }
+}
+
+void compare(const wsVec3Stream& stream, u32 index, const vec4& expected) {
+  compare(stream.x[index], expected.x);
+  compare(stream.y[index], expected.y);
+  compare(stream.z[index], expected.z);
+}
+
+void compare(const wsQuatStream& stream, u32 index, const quat& expected) {
+  compare(stream.x[index], expected.x);
+  compare(stream.y[index], expected.y);
+  compare(stream.z[index], expected.z);
+  compare(stream.w[index], expected.w);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsMem.startUp(64*wsMB, wsMB);
+  wsInitRandomizer((u64)1);
+  wsDetectSIMD();
+
+  wsVec3Stream points = newVec3Stream(-10.0f, 10.0f);
+  wsVec3Stream others = newVec3Stream(-1.0f, 1.0f);
+  wsVec3Stream centers = newVec3Stream(-1.0f, 1.0f);
+  wsVec3Stream extents = newVec3Stream(0.1f, 1.0f);
+  wsVec3Stream out = newVec3Stream(0.0f, 0.0f);
+  wsVec3Stream outExtents = newVec3Stream(0.0f, 0.0f);
+  wsQuatStream quatsA = newQuatStream(false);
+  wsQuatStream quatsB = newQuatStream(false);
+  wsQuatStream rotations = newQuatStream(true);
+  wsQuatStream outQuats = newQuatStream(false);
+  f32* factors = wsNewArray(f32, WS_TEST_ELEMENTS);
+  f32* scales = wsNewArray(f32, WS_TEST_ELEMENTS);
+  f32* angles = wsNewArray(f32, WS_TEST_ELEMENTS);
+  f32* outSin = wsNewArray(f32, WS_TEST_ELEMENTS);
+  f32* outCos = wsNewArray(f32, WS_TEST_ELEMENTS);
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    factors[i] = wsRandomFloat(0.0f, 1.0f);
+    scales[i] = wsRandomFloat(-3.0f, 3.0f);
+    angles[i] = wsRandomFloat(-720.0f, 720.0f);
+  }
+  //  A zero-length quaternion must be copied through normalization unchanged
+  quatsA.x[5] = quatsA.y[5] = quatsA.z[5] = quatsA.w[5] = 0.0f;
+  wsTransformStream transforms = { rotations, others, scales };
+  mat4 mat(0.8f, 0.1f, -0.3f, 0.0f,
+           0.2f, 0.9f, 0.4f, 0.0f,
+          -0.5f, 0.3f, 1.1f, 0.0f,
+           3.0f, -2.0f, 5.0f, 1.0f);
+  const u32 counts[] = { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, WS_TEST_ELEMENTS };
+  const u32 numCounts = sizeof(counts)/sizeof(counts[0]);
+
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsCheck(wsSetSIMDLevel((wsSIMDLevel)level));
+    maxError = 0.0f;
+    u32 numOverruns = 0;
+    for (u32 c = 0; c < numCounts; ++c) {
+      u32 count = counts[c];
+      //  The first element past count, which must keep its marker
+      u32 after = (count < WS_TEST_ELEMENTS) ? count : 0;
+      bool checkAfter = (count < WS_TEST_ELEMENTS);
+
+      clear(out);
+      wsBatchTransformPoints(out, points, mat, count);
+      if (checkAfter && out.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) { compare(out, i, vec4(points.x[i], points.y[i], points.z[i], 1.0f)*mat); }
+
+      clear(out);
+      wsBatchTransformDirections(out, points, mat, count);
+      if (checkAfter && out.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) { compare(out, i, vec4(points.x[i], points.y[i], points.z[i], 0.0f)*mat); }
+
+      clear(outQuats);
+      wsBatchMultiplyQuats(outQuats, quatsA, quatsB, count);
+      if (checkAfter && outQuats.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) { compare(outQuats, i, getQuat(quatsA, i)*getQuat(quatsB, i)); }
+
+      clear(outQuats);
+      wsBatchNormalizeQuats(outQuats, quatsA, count);
+      if (checkAfter && outQuats.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) {
+        quat q = getQuat(quatsA, i);
+        compare(outQuats, i, (i == 5) ? q : q.normal());
+      }
+
+      clear(out);
+      wsBatchRotateVectors(out, points, rotations, count);
+      if (checkAfter && out.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) {
+        compare(out, i, vec4(points.x[i], points.y[i], points.z[i], 1.0f).getRotate(getQuat(rotations, i)));
+      }
+
+      clear(out);
+      wsBatchBlendVec3(out, points, others, factors, count);
+      if (checkAfter && out.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) {
+        compare(out.x[i], wsLerp(points.x[i], others.x[i], factors[i]));
+        compare(out.y[i], wsLerp(points.y[i], others.y[i], factors[i]));
+        compare(out.z[i], wsLerp(points.z[i], others.z[i], factors[i]));
+      }
+
+      clear(outQuats);
+      wsBatchBlendQuats(outQuats, quatsA, quatsB, factors, count);
+      if (checkAfter && outQuats.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) { compare(outQuats, i, getQuat(quatsA, i).blend(getQuat(quatsB, i), factors[i])); }
+
+      for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) { outSin[i] = outCos[i] = WS_UNTOUCHED; }
+      wsBatchSinCos(outSin, outCos, angles, count);
+      if (checkAfter && (outSin[after] != WS_UNTOUCHED || outCos[after] != WS_UNTOUCHED)) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) {
+        f32 expectedSin, expectedCos;
+        wsSinCos(angles[i], &expectedSin, &expectedCos);
+        compare(outSin[i], expectedSin);
+        compare(outCos[i], expectedCos);
+      }
+
+      clear(out);
+      wsBatchComputeAABBs(out, outExtents, centers, extents, transforms, count);
+      if (checkAfter && out.x[after] != WS_UNTOUCHED) { ++numOverruns; }
+      for (u32 i = 0; i < count; ++i) {
+        //  The box which encloses all eight corners, moved by the transform's matrix
+        mat4 transform = wsTransform(scales[i], getQuat(rotations, i),
+                                      others.x[i], others.y[i], others.z[i]).toMatrix();
+        vec4 lo(1.0e30f, 1.0e30f, 1.0e30f, 0.0f), hi(-1.0e30f, -1.0e30f, -1.0e30f, 0.0f);
+        for (u32 k = 0; k < 8; ++k) {
+          vec4 corner(centers.x[i] + ((k & 1) ? extents.x[i] : -extents.x[i]),
+                      centers.y[i] + ((k & 2) ? extents.y[i] : -extents.y[i]),
+                      centers.z[i] + ((k & 4) ? extents.z[i] : -extents.z[i]), 1.0f);
+          vec4 moved = corner*transform;
+          lo = vec4(fminf(lo.x, moved.x), fminf(lo.y, moved.y), fminf(lo.z, moved.z), 0.0f);
+          hi = vec4(fmaxf(hi.x, moved.x), fmaxf(hi.y, moved.y), fmaxf(hi.z, moved.z), 0.0f);
+        }
+        compare(out, i, (lo + hi)*0.5f);
+        compare(outExtents, i, (hi - lo)*0.5f);
+      }
+    }
+    //  In place, the destination the same stream as the source
+    wsVec3Stream inPlace = newVec3Stream(0.0f, 0.0f);
+    for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+      inPlace.x[i] = points.x[i];
+      inPlace.y[i] = points.y[i];
+      inPlace.z[i] = points.z[i];
+    }
+    wsBatchTransformPoints(inPlace, inPlace, mat, WS_TEST_ELEMENTS);
+    for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+      compare(inPlace, i, vec4(points.x[i], points.y[i], points.z[i], 1.0f)*mat);
+    }
+    printf("  %s: largest relative error %g\n", wsGetSIMDLevelName((wsSIMDLevel)level), maxError);
+    wsCheck(maxError < WS_TEST_TOLERANCE);
+    wsCheck(numOverruns == 0);
+  }
+
+  //  Throughput, per element
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    const u64 numOps = (u64)WS_BENCH_ROUNDS*WS_TEST_ELEMENTS;
+    char name[64];
+    #define WS_BENCH_KERNEL(kernelName, call) \
+      wsBenchmarkBegin(); \
+      for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { call; } \
+      snprintf(name, 64, "%s %s", wsGetSIMDLevelName((wsSIMDLevel)level), kernelName); \
+      wsReportTime(name, wsBenchmarkEnd(), numOps);
+    WS_BENCH_KERNEL("transformPoints", wsBatchTransformPoints(out, points, mat, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("transformDirections", wsBatchTransformDirections(out, points, mat, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("multiplyQuats", wsBatchMultiplyQuats(outQuats, quatsA, quatsB, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("normalizeQuats", wsBatchNormalizeQuats(outQuats, quatsA, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("rotateVectors", wsBatchRotateVectors(out, points, rotations, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("blendVec3", wsBatchBlendVec3(out, points, others, factors, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("blendQuats", wsBatchBlendQuats(outQuats, quatsA, quatsB, factors, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("sinCos", wsBatchSinCos(outSin, outCos, angles, WS_TEST_ELEMENTS));
+    WS_BENCH_KERNEL("computeAABBs", wsBatchComputeAABBs(out, outExtents, centers, extents, transforms, WS_TEST_ELEMENTS));
+    #undef WS_BENCH_KERNEL
+  }
+  //  The loop the point transform replaces
+  vec4* vectors = wsNewArray(vec4, WS_TEST_ELEMENTS);
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) { vectors[i] = vec4(points.x[i], points.y[i], points.z[i], 1.0f); }
+  wsBenchmarkBegin();
+  for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) {
+    for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) { vectors[i] = vectors[i]*mat; }
+  }
+  wsReportTime("vec4 * mat4, one at a time", wsBenchmarkEnd(), (u64)WS_BENCH_ROUNDS*WS_TEST_ELEMENTS);
+  //  Keeps the loop from being optimized away
+  wsCheck(vectors[7].w == vectors[7].w);
+  wsMem.shutDown();
+  return wsTestResult("batchMathTest");
+}
@@ -0,0 +1,208 @@
+/*
+ * containerTest.cpp
+ *
+ *    Tests that the engine's containers construct elements in place and hand them
+ *    back by reference: emplacing into a wsHashMap, wsOrderedHashMap, wsArray,
+ *    wsQueue or wsStack copies nothing, iterating copies nothing, and popping moves
+ *    the item out. Then times inserting a copy against emplacing, for an element
+ *    the size of a wsEvent.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+
+//  Counts its copies and moves; the size of a wsEvent
+struct wsTracked {
+  static u32 copies;
+  static u32 moves;
+  u64 payload[6];
+  u32 id;
+  wsTracked(u32 myId = 0) : id(myId) { for (u32 i = 0; i < 6; ++i) { payload[i] = myId + i; } }
+  wsTracked(const wsTracked& other) : id(other.id) { copyPayload(other); ++copies; }
+  wsTracked(wsTracked&& other) : id(other.id) { copyPayload(other); ++moves; }
+  wsTracked& operator=(const wsTracked& other) { id = other.id; copyPayload(other); ++copies; return *this; }
+  wsTracked& operator=(wsTracked&& other) { id = other.id; copyPayload(other); ++moves; return *this; }
+  void copyPayload(const wsTracked& other) { for (u32 i = 0; i < 6; ++i) { payload[i] = other.payload[i]; } }
+  static void reset() { copies = 0; moves = 0; }
+};
+u32 wsTracked::copies = 0;
+u32 wsTracked::moves = 0;
+
+#define WS_TEST_ITEMS 1000
+#define WS_BENCH_ITEMS 200000
+
+void testHashMap() {
+  wsHashMap<wsTracked> map(WS_TEST_ITEMS*2);
+  wsTracked::reset();
+  for (u32 i = 1; i <= WS_TEST_ITEMS; ++i) { map.emplace(i*13, i); }
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(wsTracked::moves == 0);
+  wsCheck(map.getLength() == WS_TEST_ITEMS);
+  u32 found = 0;
+  for (u32 i = 1; i <= WS_TEST_ITEMS; ++i) {
+    wsTracked* item = map.find(i*13);
+    if (item && item->id == i) { ++found; }
+  }
+  wsCheck(found == WS_TEST_ITEMS);
+  //  Half the keys removed; iteration visits the rest, by reference
+  for (u32 i = 1; i <= WS_TEST_ITEMS; i += 2) { map.remove(i*13); }
+  u32 visited = 0;
+  for (wsHashMap<wsTracked>::iterator it = map.begin(); it.isValid(); ++it) {
+    wsTracked& item = it.get();
+    if (item.id % 2 == 0 && it.getKey() == item.id*13) { ++visited; }
+    ++item.payload[0];
+  }
+  wsCheck(visited == WS_TEST_ITEMS/2);
+  wsCheck(map.find(26)->payload[0] == 3);
+  u32 backward = 0;
+  for (wsHashMap<wsTracked>::iterator it = map.end(); it.isValid(); --it) { ++backward; }
+  wsCheck(backward == WS_TEST_ITEMS/2);
+  wsCheck(wsTracked::copies == 0);
+  //  Growing the map moves its elements, never copies them
+  wsHashMap<wsTracked> small(3);
+  wsTracked::reset();
+  for (u32 i = 1; i <= 100; ++i) { small.emplace(i, i); }
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(small.getLength() == 100);
+  //  Inserting an rvalue moves it in
+  wsTracked::reset();
+  small.insert(1000, wsTracked(1000));
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(small.find(1000) && small.find(1000)->id == 1000);
+}
+
+void testOrderedHashMap() {
+  wsOrderedHashMap<wsTracked> map(3);
+  wsTracked::reset();
+  for (u32 i = 1; i <= 100; ++i) { map.emplace(i*7, 100-i, i); }
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(map.getLength() == 100);
+  //  Ordered by orderPos, so the last key emplaced comes first
+  wsCheck(map.begin()->id == 100);
+  wsCheck(map.end()->id == 1);
+  u32 visited = 0;
+  i32 lastId = 101;
+  bool ordered = true;
+  for (wsOrderedHashMap<wsTracked>::iterator it = map.begin(); it.isValid(); ++it) {
+    if ((i32)it->id >= lastId) { ordered = false; }
+    lastId = it->id;
+    ++visited;
+  }
+  wsCheck(ordered);
+  wsCheck(visited == 100);
+  wsCheck(wsTracked::copies == 0);
+}
+
+void testSequences() {
+  wsArray<wsTracked> array(2);
+  wsQueue<wsTracked> queue(2);
+  wsStack<wsTracked> stack(2);
+  wsSmallArray<wsTracked, 4> smallArray;
+  wsTracked::reset();
+  for (u32 i = 0; i < WS_TEST_ITEMS; ++i) {
+    array.emplace(i);
+    queue.emplaceBack(i);
+    stack.emplace(i);
+    smallArray.emplace(i);
+  }
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(array.getLength() == WS_TEST_ITEMS);
+  wsCheck(array[WS_TEST_ITEMS-1].id == WS_TEST_ITEMS-1);
+  wsCheck(smallArray[WS_TEST_ITEMS-1].id == WS_TEST_ITEMS-1);
+  wsTracked item;
+  u32 popped = 0;
+  bool inOrder = true;
+  while (queue.pop(item)) {
+    if (item.id != popped) { inOrder = false; }
+    ++popped;
+  }
+  wsCheck(inOrder);
+  wsCheck(popped == WS_TEST_ITEMS);
+  while (stack.pop(item)) {
+    if (item.id != 2*WS_TEST_ITEMS - 1 - popped) { inOrder = false; }
+    ++popped;
+  }
+  wsCheck(inOrder);
+  wsCheck(popped == 2*WS_TEST_ITEMS);
+  //  Popping moves the item out
+  wsCheck(wsTracked::copies == 0);
+  wsCheck(!queue.pop(item));
+  wsCheck(!stack.pop(item));
+}
+
+void benchmark() {
+  printf("  Inserting %u elements of %u bytes:\n", WS_BENCH_ITEMS, (u32)sizeof(wsTracked));
+  wsTracked source(7);
+  u64 total = 0;
+  {
+    wsHashMap<wsTracked> map(WS_BENCH_ITEMS*2);
+    wsTracked::reset();
+    wsBenchmarkBegin();
+    for (u32 i = 1; i <= WS_BENCH_ITEMS; ++i) {
+      source.id = i;
+      map.insert(i, source);
+    }
+    wsReportTime("wsHashMap insert (copy)", wsBenchmarkEnd(), WS_BENCH_ITEMS);
+    printf("    copies: %u, moves: %u\n", wsTracked::copies, wsTracked::moves);
+    wsCheck(wsTracked::copies == WS_BENCH_ITEMS);
+  }
+  {
+    wsHashMap<wsTracked> map(WS_BENCH_ITEMS*2);
+    wsTracked::reset();
+    wsBenchmarkBegin();
+    for (u32 i = 1; i <= WS_BENCH_ITEMS; ++i) { map.emplace(i, i); }
+    wsReportTime("wsHashMap emplace", wsBenchmarkEnd(), WS_BENCH_ITEMS);
+    printf("    copies: %u, moves: %u\n", wsTracked::copies, wsTracked::moves);
+    wsCheck(wsTracked::copies == 0);
+    wsBenchmarkBegin();
+    for (wsHashMap<wsTracked>::iterator it = map.begin(); it.isValid(); ++it) { total += it->payload[5]; }
+    wsReportTime("wsHashMap iterate by reference", wsBenchmarkEnd(), WS_BENCH_ITEMS);
+    wsCheck(wsTracked::copies == 0);
+  }
+  {
+    wsQueue<wsTracked> queue(WS_BENCH_ITEMS);
+    wsTracked item;
+    wsTracked::reset();
+    wsBenchmarkBegin();
+    for (u32 i = 0; i < WS_BENCH_ITEMS; ++i) { queue.emplaceBack(i); }
+    while (queue.pop(item)) { total += item.id; }
+    wsReportTime("wsQueue emplaceBack and pop", wsBenchmarkEnd(), WS_BENCH_ITEMS);
+    printf("    copies: %u, moves: %u\n", wsTracked::copies, wsTracked::moves);
+    wsCheck(wsTracked::copies == 0);
+  }
+  //  Keeps the loops from being optimized away
+  wsCheck(total > 0);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsMem.startUp(256*wsMB, wsMB);
+  testHashMap();
+  testOrderedHashMap();
+  testSequences();
+  benchmark();
+  wsMem.shutDown();
+  return wsTestResult("containerTest");
+}
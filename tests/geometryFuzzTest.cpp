@@ -0,0 +1,262 @@
+/*
+ * geometryFuzzTest.cpp
+ *
+ *    Fuzzes the batch geometric queries at every SIMD level the processor supports
+ *    against the reference queries, one primitive at a time. Each trial fires a random
+ *    ray, frustum and sphere at random boxes, spheres and triangles, among them axis-
+ *    parallel rays, rays starting inside primitives, and degenerate triangles and
+ *    spheres, and every hit, count and distance must match. Then times each kernel.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <cmath>
+
+#define WS_TEST_PRIMITIVES 10007
+#define WS_TEST_TRIALS 40
+#define WS_TEST_TOLERANCE 1.0e-3f
+#define WS_BENCH_ROUNDS 50
+
+enum wsTestQuery {
+  WS_TEST_RAY_AABB = 0,
+  WS_TEST_RAY_SPHERE,
+  WS_TEST_RAY_TRIANGLE,
+  WS_TEST_FRUSTUM_AABB,
+  WS_TEST_FRUSTUM_SPHERE,
+  WS_TEST_SPHERE_SPHERE,
+  WS_TEST_NUM_QUERIES
+};
+
+const char* queryNames[WS_TEST_NUM_QUERIES] = {
+  "ray / AABB", "ray / sphere", "ray / triangle", "frustum / AABB", "frustum / sphere", "sphere / sphere"
+};
+
+struct wsTestScene {
+  wsVec3Stream verts[3];  //  The first are also the centers of the boxes and spheres
+  wsVec3Stream extents;
+  f32* radii;
+  wsRay ray;
+  wsFrustum frustum;
+  wsSphere sphere;
+};
+
+wsVec3Stream newVec3Stream(wsRandom& random, f32 minVal, f32 maxVal) {
+  wsVec3Stream my = { wsNewArray(f32, WS_TEST_PRIMITIVES), wsNewArray(f32, WS_TEST_PRIMITIVES),
+                      wsNewArray(f32, WS_TEST_PRIMITIVES) };
+  random.fillFloats(my.x, WS_TEST_PRIMITIVES, minVal, maxVal);
+  random.fillFloats(my.y, WS_TEST_PRIMITIVES, minVal, maxVal);
+  random.fillFloats(my.z, WS_TEST_PRIMITIVES, minVal, maxVal);
+  return my;
+}
+
+vec4 getPoint(const wsVec3Stream& stream, u32 index, f32 w) {
+  return vec4(stream.x[index], stream.y[index], stream.z[index], w);
+}
+
+//  A frustum looking down +z from its apex, with the given half-angle in x and y
+wsFrustum makeFrustum(const vec4& apex, f32 slope, f32 nearDist, f32 farDist) {
+  wsFrustum my;
+  f32 apexZ = apex.z;
+  my.planes[WS_FRUSTUM_LEFT]   = vec4( 1.0f, 0.0f, slope, -apex.x - slope*apexZ);
+  my.planes[WS_FRUSTUM_RIGHT]  = vec4(-1.0f, 0.0f, slope,  apex.x - slope*apexZ);
+  my.planes[WS_FRUSTUM_BOTTOM] = vec4(0.0f,  1.0f, slope, -apex.y - slope*apexZ);
+  my.planes[WS_FRUSTUM_TOP]    = vec4(0.0f, -1.0f, slope,  apex.y - slope*apexZ);
+  my.planes[WS_FRUSTUM_NEAR]   = vec4(0.0f, 0.0f,  1.0f, -(apexZ + nearDist));
+  my.planes[WS_FRUSTUM_FAR]    = vec4(0.0f, 0.0f, -1.0f,  (apexZ + farDist));
+  my.normalize();
+  return my;
+}
+
+//  Runs the batch kernel of the query at the current level
+u32 runBatch(u32 query, const wsTestScene& scene, u32 count, u32* hitMasks, f32* distances) {
+  switch (query) {
+    case WS_TEST_RAY_AABB:
+      return wsBatchRayAABBs(scene.ray, scene.verts[0], scene.extents, count, hitMasks, distances);
+    case WS_TEST_RAY_SPHERE:
+      return wsBatchRaySpheres(scene.ray, scene.verts[0], scene.radii, count, hitMasks, distances);
+    case WS_TEST_RAY_TRIANGLE:
+      return wsBatchRayTriangles(scene.ray, scene.verts[0], scene.verts[1], scene.verts[2],
+                                  count, hitMasks, distances);
+    case WS_TEST_FRUSTUM_AABB:
+      return wsBatchFrustumAABBs(scene.frustum, scene.verts[0], scene.extents, count, hitMasks);
+    case WS_TEST_FRUSTUM_SPHERE:
+      return wsBatchFrustumSpheres(scene.frustum, scene.verts[0], scene.radii, count, hitMasks);
+    default:
+      return wsBatchSphereSpheres(scene.sphere, scene.verts[0], scene.radii, count, hitMasks);
+  }
+}
+
+//  Runs the reference query on one primitive
+bool runReference(u32 query, const wsTestScene& scene, u32 index, f32& distance) {
+  vec4 center = getPoint(scene.verts[0], index, 1.0f);
+  distance = WS_GEOMETRY_MISS;
+  switch (query) {
+    case WS_TEST_RAY_AABB:
+      return wsRayIntersectsAABB(scene.ray, wsAABB(center, getPoint(scene.extents, index, 0.0f)), distance);
+    case WS_TEST_RAY_SPHERE:
+      return wsRayIntersectsSphere(scene.ray, wsSphere(center, scene.radii[index]), distance);
+    case WS_TEST_RAY_TRIANGLE:
+      return wsRayIntersectsTriangle(scene.ray, center, getPoint(scene.verts[1], index, 1.0f),
+                                      getPoint(scene.verts[2], index, 1.0f), distance);
+    case WS_TEST_FRUSTUM_AABB:
+      return wsFrustumIntersectsAABB(scene.frustum, wsAABB(center, getPoint(scene.extents, index, 0.0f)));
+    case WS_TEST_FRUSTUM_SPHERE:
+      return wsFrustumIntersectsSphere(scene.frustum, wsSphere(center, scene.radii[index]));
+    default:
+      return wsSphereIntersectsSphere(scene.sphere, wsSphere(center, scene.radii[index]));
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsMem.startUp(64*wsMB, wsMB);
+  wsDetectSIMD();
+  wsRandom random(36);
+  wsTestScene scene;
+  for (u32 v = 0; v < 3; ++v) { scene.verts[v] = newVec3Stream(random, -10.0f, 10.0f); }
+  scene.extents = newVec3Stream(random, 0.0f, 3.0f);
+  scene.radii = wsNewArray(f32, WS_TEST_PRIMITIVES);
+  random.fillFloats(scene.radii, WS_TEST_PRIMITIVES, 0.0f, 3.0f);
+  //  Degenerate primitives: points, flat boxes, and triangles with repeated or collinear corners
+  for (u32 i = 0; i < WS_TEST_PRIMITIVES; i += 97) {
+    scene.radii[i] = 0.0f;
+    scene.extents.y[i] = 0.0f;
+    scene.verts[1].x[i] = scene.verts[0].x[i];
+    scene.verts[1].y[i] = scene.verts[0].y[i];
+    scene.verts[1].z[i] = scene.verts[0].z[i];
+  }
+  for (u32 i = 50; i < WS_TEST_PRIMITIVES; i += 97) {
+    scene.verts[2].x[i] = 2.0f*scene.verts[1].x[i] - scene.verts[0].x[i];
+    scene.verts[2].y[i] = 2.0f*scene.verts[1].y[i] - scene.verts[0].y[i];
+    scene.verts[2].z[i] = 2.0f*scene.verts[1].z[i] - scene.verts[0].z[i];
+  }
+  u32* expectedMasks = wsNewArray(u32, WS_HIT_MASK_WORDS(WS_TEST_PRIMITIVES));
+  u32* hitMasks = wsNewArray(u32, WS_HIT_MASK_WORDS(WS_TEST_PRIMITIVES));
+  f32* expectedDistances = wsNewArray(f32, WS_TEST_PRIMITIVES);
+  f32* distances = wsNewArray(f32, WS_TEST_PRIMITIVES);
+  const u32 counts[] = { 1, 3, 4, 7, 8, 9, 31, 32, 33, WS_TEST_PRIMITIVES };
+  const u32 numCounts = sizeof(counts)/sizeof(counts[0]);
+
+  u32 numHits[WS_TEST_NUM_QUERIES] = { 0 };
+  u32 numMaskErrors = 0;
+  u32 numCountErrors = 0;
+  u32 numDistanceErrors = 0;
+  for (u32 trial = 0; trial < WS_TEST_TRIALS; ++trial) {
+    vec4 origin(random.nextFloat(-12.0f, 12.0f), random.nextFloat(-12.0f, 12.0f),
+                random.nextFloat(-12.0f, 12.0f), 1.0f);
+    vec4 dir;
+    if (trial % 4 == 0) {
+      //  Parallel to an axis, so two components of the direction are zero
+      dir = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+      if (trial % 3 == 0) { dir.x = 1.0f; }
+      else if (trial % 3 == 1) { dir.y = -1.0f; }
+      else { dir.z = 2.0f; }
+    }
+    else if (trial % 4 == 1) {
+      //  Starting among the primitives, so many contain the origin
+      origin = vec4(random.nextFloat(-2.0f, 2.0f), random.nextFloat(-2.0f, 2.0f), random.nextFloat(-2.0f, 2.0f), 1.0f);
+      dir = vec4(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), 0.0f);
+    }
+    else {
+      //  Aimed near the middle of the scene
+      dir = vec4(random.nextFloat(-1.0f, 1.0f) - origin.x, random.nextFloat(-1.0f, 1.0f) - origin.y,
+                 random.nextFloat(-1.0f, 1.0f) - origin.z, 0.0f);
+    }
+    scene.ray = wsRay(origin, dir);
+    scene.frustum = makeFrustum(vec4(random.nextFloat(-5.0f, 5.0f), random.nextFloat(-5.0f, 5.0f), -20.0f, 1.0f),
+                                random.nextFloat(0.5f, 3.0f), random.nextFloat(1.0f, 10.0f), random.nextFloat(15.0f, 35.0f));
+    scene.sphere = wsSphere(vec4(random.nextFloat(-8.0f, 8.0f), random.nextFloat(-8.0f, 8.0f),
+                                 random.nextFloat(-8.0f, 8.0f), 1.0f), random.nextFloat(0.0f, 4.0f));
+    for (u32 query = 0; query < WS_TEST_NUM_QUERIES; ++query) {
+      bool measuresDistance = (query <= WS_TEST_RAY_TRIANGLE);
+      for (u32 i = 0; i < WS_HIT_MASK_WORDS(WS_TEST_PRIMITIVES); ++i) { expectedMasks[i] = 0; }
+      for (u32 i = 0; i < WS_TEST_PRIMITIVES; ++i) {
+        if (runReference(query, scene, i, expectedDistances[i])) {
+          expectedMasks[i >> 5] |= (1u << (i & 31));
+        }
+      }
+      for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+        wsSetSIMDLevel((wsSIMDLevel)level);
+        for (u32 c = 0; c < numCounts; ++c) {
+          u32 count = counts[c];
+          for (u32 i = 0; i < count; ++i) { distances[i] = WS_GEOMETRY_MISS; }
+          u32 hits = runBatch(query, scene, count, hitMasks, distances);
+          u32 expectedHits = 0;
+          for (u32 i = 0; i < count; ++i) {
+            bool expected = wsIsHit(expectedMasks, i);
+            expectedHits += expected;
+            if (wsIsHit(hitMasks, i) != expected) { ++numMaskErrors; }
+            else if (expected && measuresDistance &&
+                     !(fabsf(distances[i] - expectedDistances[i]) <=
+                       WS_TEST_TOLERANCE*(1.0f + fabsf(expectedDistances[i])))) {
+              ++numDistanceErrors;
+            }
+          }
+          if (hits != expectedHits) { ++numCountErrors; }
+          if (count == WS_TEST_PRIMITIVES && level == 0) { numHits[query] += hits; }
+        }
+      }
+    }
+  }
+  for (u32 query = 0; query < WS_TEST_NUM_QUERIES; ++query) {
+    printf("  %-20s %u hits in %u tests\n", queryNames[query], numHits[query], WS_TEST_TRIALS*WS_TEST_PRIMITIVES);
+    //  The fuzzing is only meaningful if the scenes both hit and miss
+    wsCheck(numHits[query] > 0 && numHits[query] < WS_TEST_TRIALS*WS_TEST_PRIMITIVES);
+  }
+  wsCheck(numMaskErrors == 0);
+  wsCheck(numCountErrors == 0);
+  wsCheck(numDistanceErrors == 0);
+
+  //  Fixed cases whose answers are known
+  f32 distance;
+  wsRay down(vec4(0.0f, 10.0f, 0.0f, 1.0f), vec4(0.0f, -2.0f, 0.0f, 0.0f));
+  wsCheck(wsRayIntersectsSphere(down, wsSphere(vec4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f), distance));
+  wsCheck(fabsf(distance - 4.5f) < 1.0e-5f);
+  wsCheck(wsRayIntersectsAABB(down, wsAABB(vec4(0.0f, 0.0f, 0.0f, 1.0f), vec4(1.0f, 1.0f, 1.0f, 0.0f)), distance));
+  wsCheck(fabsf(distance - 4.5f) < 1.0e-5f);
+  wsCheck(!wsRayIntersectsAABB(down, wsAABB(vec4(0.0f, 20.0f, 0.0f, 1.0f), vec4(1.0f, 1.0f, 1.0f, 0.0f)), distance));
+  wsCheck(wsRayIntersectsTriangle(down, vec4(-1.0f, 2.0f, -1.0f, 1.0f), vec4(1.0f, 2.0f, -1.0f, 1.0f),
+                                  vec4(0.0f, 2.0f, 1.0f, 1.0f), distance));
+  wsCheck(fabsf(distance - 4.0f) < 1.0e-5f);
+  wsFrustum unitCube((mat4()));
+  wsCheck(wsFrustumIntersectsSphere(unitCube, wsSphere(vec4(0.5f, 0.5f, 0.5f, 1.0f), 0.0f)));
+  wsCheck(!wsFrustumIntersectsSphere(unitCube, wsSphere(vec4(1.5f, 0.0f, 0.0f, 1.0f), 0.0f)));
+  wsCheck(wsFrustumIntersectsSphere(unitCube, wsSphere(vec4(1.5f, 0.0f, 0.0f, 1.0f), 0.6f)));
+
+  //  Throughput, per primitive
+  scene.ray = wsRay(vec4(0.0f, 0.0f, -20.0f, 1.0f), vec4(0.1f, 0.2f, 1.0f, 0.0f));
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    for (u32 query = 0; query < WS_TEST_NUM_QUERIES; ++query) {
+      char name[64];
+      snprintf(name, 64, "%s %s", wsGetSIMDLevelName((wsSIMDLevel)level), queryNames[query]);
+      wsBenchmarkBegin();
+      for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { runBatch(query, scene, WS_TEST_PRIMITIVES, hitMasks, distances); }
+      wsReportTime(name, wsBenchmarkEnd(), (u64)WS_BENCH_ROUNDS*WS_TEST_PRIMITIVES);
+    }
+  }
+  wsMem.shutDown();
+  return wsTestResult("geometryFuzzTest");
+}
@@ -0,0 +1,191 @@
+/*
+ * hashTest.cpp
+ *
+ *    Tests the CRC-32C string and buffer hashes. The SSE4.2 path, where the CPU has
+ *    it, must give the same hash as the lookup table for strings of every length and
+ *    alignment, and for buffers from empty to several megabytes, across the sizes
+ *    where the interleaved lanes start. Both must match the compile-time hash and the
+ *    published check value, and hashing in pieces must match hashing at once. Then
+ *    times both paths on short names and on a multi-megabyte buffer.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <cstring>
+
+#define WS_TEST_MAX_STRING 100
+#define WS_TEST_LARGE_BYTES (5*wsMB + 3)
+#define WS_BENCH_BYTES (16*wsMB)
+#define WS_BENCH_ROUNDS 8
+#define WS_BENCH_NAME_ROUNDS 200000
+
+//  Asset names of typical lengths
+const char* names[] = {
+  "blueBox", "Griswald", "bladeWand", "textures/blueBricks.png", "textures/blueBricks_norm.png",
+  "models/Griswald.wsMesh", "animations/Griswald_walk.wsAnim", "shaderFiles/wsInitial.fsh"
+};
+const u32 numNames = sizeof(names)/sizeof(names[0]);
+
+//  Hashes with the lookup table, whatever the CPU supports
+u32 tableHash(const char* myString, u32 prevHash = 0) {
+  const bool hardware = wsCRC32HardwareSupported;
+  wsCRC32HardwareSupported = false;
+  const u32 my = wsHash(myString, prevHash);
+  wsCRC32HardwareSupported = hardware;
+  return my;
+}
+
+u32 tableHashBuffer(const void* data, u64 numBytes, u32 prevHash = 0) {
+  const bool hardware = wsCRC32HardwareSupported;
+  wsCRC32HardwareSupported = false;
+  const u32 my = wsHashBuffer(data, numBytes, prevHash);
+  wsCRC32HardwareSupported = hardware;
+  return my;
+}
+
+void testKnownValues() {
+  //  The CRC-32C check value, with the usual initial and final inversion
+  wsCheck((wsHashBuffer("123456789", 9, 0xFFFFFFFF) ^ 0xFFFFFFFF) == 0xE3069283);
+  wsCheck((tableHashBuffer("123456789", 9, 0xFFFFFFFF) ^ 0xFFFFFFFF) == 0xE3069283);
+  wsCheck(wsHash("Griswald") == WS_HASH("Griswald"));
+  wsCheck(wsHash("") == 0 && wsHashBuffer(WS_NULL, 0, 1234) == 1234);
+}
+
+void testStrings(u8* buffer) {
+  wsRandom rng(29);
+  bool matches = true;
+  char* text = (char*)buffer;
+  //  Every length at every offset from a word boundary, with bytes outside ASCII too
+  for (u32 offset = 0; offset < 8; ++offset) {
+    for (u32 length = 0; length <= WS_TEST_MAX_STRING; ++length) {
+      char* start = text + offset;
+      for (u32 i = 0; i < length; ++i) { start[i] = (char)rng.nextInt(1, 255); }
+      start[length] = '\0';
+      //  Bytes after the terminator must not change the hash
+      start[length+1] = 'x';
+      const u32 table = tableHash(start);
+      matches &= (wsHash(start) == table);
+      matches &= (wsHash(start) == wsHashConst(start));
+      matches &= (wsHashBuffer(start, length) == table);
+      //  Continuing from a previous hash
+      const u32 split = length/3;
+      start[length+1] = '\0';
+      char tail[WS_TEST_MAX_STRING + 2];
+      strcpy(tail, start + split);
+      start[split] = '\0';
+      matches &= (wsHash(tail, wsHash(start)) == table);
+      matches &= (tableHash(tail, tableHash(start)) == table);
+    }
+  }
+  printf("  strings of 0 to %u bytes at 8 alignments: %s\n", WS_TEST_MAX_STRING,
+          matches ? "paths agree" : "paths DIFFER");
+  wsCheck(matches);
+}
+
+void testBuffers(u8* buffer) {
+  wsRandom rng(290);
+  rng.fill((u32*)buffer, WS_TEST_LARGE_BYTES/4 + 1);
+  bool matches = true;
+  //  Small sizes, and either side of the three 4 KB lanes
+  const u32 lanes = 3*4096;
+  for (u32 offset = 0; offset < 8; ++offset) {
+    for (u32 size = 0; size < 300; ++size) {
+      matches &= (wsHashBuffer(buffer + offset, size) == tableHashBuffer(buffer + offset, size));
+    }
+    for (u32 size = lanes - 20; size < lanes + 20; ++size) {
+      matches &= (wsHashBuffer(buffer + offset, size) == tableHashBuffer(buffer + offset, size));
+    }
+    for (u32 size = 2*lanes - 9; size < 2*lanes + 9; ++size) {
+      matches &= (wsHashBuffer(buffer + offset, size) == tableHashBuffer(buffer + offset, size));
+    }
+  }
+  const u32 large = wsHashBuffer(buffer + 1, WS_TEST_LARGE_BYTES);
+  matches &= (large == tableHashBuffer(buffer + 1, WS_TEST_LARGE_BYTES));
+  //  In pieces, cut across the lanes
+  u32 pieces = 0;
+  u64 done = 0;
+  while (done < WS_TEST_LARGE_BYTES) {
+    u64 piece = rng.nextBelow(5*lanes);
+    if (piece > WS_TEST_LARGE_BYTES - done) { piece = WS_TEST_LARGE_BYTES - done; }
+    pieces = wsHashBuffer(buffer + 1 + done, piece, pieces);
+    done += piece;
+  }
+  matches &= (pieces == large);
+  printf("  buffers of 0 to %u bytes, whole and in pieces: %s\n", WS_TEST_LARGE_BYTES,
+          matches ? "paths agree" : "paths DIFFER");
+  wsCheck(matches);
+}
+
+void benchmark(u8* buffer) {
+  u32 sum = 0;
+  u64 nameBytes = 0;
+  for (u32 n = 0; n < numNames; ++n) { nameBytes += strlen(names[n]); }
+  const u64 numNames64 = (u64)WS_BENCH_NAME_ROUNDS*numNames;
+  printf("  names average %.1f bytes\n", (f64)nameBytes/numNames);
+  for (u32 hardware = 0; hardware <= 1; ++hardware) {
+    if (hardware && !wsCRC32HardwareSupported) {
+      printf("  No SSE4.2 on this CPU; only the table was timed\n");
+      break;
+    }
+    const bool supported = wsCRC32HardwareSupported;
+    wsCRC32HardwareSupported = (hardware != 0);
+    char name[64];
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_NAME_ROUNDS; ++r) {
+      for (u32 n = 0; n < numNames; ++n) { sum += wsHash(names[n]); }
+    }
+    snprintf(name, 64, "%s wsHash, short names", hardware ? "SSE4.2" : "table");
+    wsReportTime(name, wsBenchmarkEnd(), numNames64);
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { sum += wsHashBuffer(buffer, WS_BENCH_BYTES); }
+    const t64 seconds = wsBenchmarkEnd();
+    snprintf(name, 64, "%s wsHashBuffer, %u MB", hardware ? "SSE4.2" : "table", WS_BENCH_BYTES/wsMB);
+    wsReportTime(name, seconds, WS_BENCH_ROUNDS);
+    printf("    %.2f GB/s\n", (f64)WS_BENCH_BYTES*WS_BENCH_ROUNDS/seconds*1.0e-9);
+    wsCRC32HardwareSupported = supported;
+  }
+  u64 sum64 = 0;
+  wsBenchmarkBegin();
+  for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { sum64 += wsHashBuffer64(buffer, WS_BENCH_BYTES); }
+  const t64 seconds = wsBenchmarkEnd();
+  wsReportTime("wsHashBuffer64, 16 MB", seconds, WS_BENCH_ROUNDS);
+  printf("    %.2f GB/s\n", (f64)WS_BENCH_BYTES*WS_BENCH_ROUNDS/seconds*1.0e-9);
+  //  Keeps the hashes from being optimized away
+  wsCheck((sum | sum64) != 0);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  printf("  Hardware CRC-32C: %s\n", wsCRC32HardwareSupported ? "yes" : "no");
+  u8* buffer = wsNewArray(u8, WS_BENCH_BYTES + 16);
+  testKnownValues();
+  testStrings(buffer);
+  testBuffers(buffer);
+  benchmark(buffer);
+  wsMem.shutDown();
+  return wsTestResult("hashTest");
+}
@@ -0,0 +1,176 @@
+/*
+ * lodSelectionTest.cpp
+ *
+ *    Checks the levels of detail built for a mesh and the choice among them. Each
+ *    level of the shipped models must have fewer triangles than the last, an error
+ *    which does not shrink, and only triangles its material already drew from. A camera
+ *    walking away from a model and back must always draw a level within the pixel
+ *    limit, and one hovering about a threshold must not flicker between two levels.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsMeshSimplifier.h"
+#include <cmath>
+#include <vector>
+
+#define WS_TEST_SCREEN_HEIGHT 1080.0f
+#define WS_TEST_FOV 60.0f
+#define WS_TEST_STEPS 2000
+
+//  The radius in pixels a sphere projects to, as wsCamera::getScreenRadius(...) gives it
+f32 screenRadius(f32 radius, f32 distance) {
+  if (distance <= radius) { return WS_TEST_SCREEN_HEIGHT; }
+  return radius/(sqrtf(distance*distance - radius*radius)*tanf(WS_TEST_FOV*0.5f*(f32)M_PI/180.0f))*
+          WS_TEST_SCREEN_HEIGHT*0.5f;
+}
+
+//  True if the level keeps within the limit, drawn at the given size
+bool withinLimit(const f32* errors, u32 level, f32 pixels) {
+  return (level == 0) || (errors[level-1]*pixels <= WS_LOD_PIXEL_ERROR);
+}
+
+void testLevels() {
+  const char* models[] = { "models/Griswald.wsMesh", "models/bladeWand.wsMesh" };
+  for (u32 f = 0; f < 2; ++f) {
+    //  Parsed rather than mapped, so the levels are built here as the mesh loads
+    wsMesh* mesh = wsNew(wsMesh, wsMesh(models[f], WS_MESH_FORMAT_WHIPSTITCH, false));
+    u32 numLODs = mesh->getNumLODs();
+    u32 numMaterials = mesh->getNumMaterials();
+    u32 prevTris = 0;
+    //  The vertices each material draws at full detail
+    std::vector<std::vector<bool> > usedBy(numMaterials, std::vector<bool>(mesh->getNumVerts(), false));
+    for (u32 m = 0; m < numMaterials; ++m) {
+      const wsMaterial& mat = mesh->getMats()[m];
+      prevTris += mat.numTriangles;
+      for (u32 t = 0; t < mat.numTriangles; ++t) {
+        for (u32 c = 0; c < 3; ++c) { usedBy[m][mat.tris[t].vertIndices[c]] = true; }
+      }
+    }
+    printf("  %s: %u triangles", models[f], prevTris);
+    wsCheck(numLODs > 0);
+    //  The errors are shares of the length of the half-extents, which must hold every vertex
+    const vec4& bounds = *mesh->getBounds();
+    const vec4& center = mesh->getDefaultPos();
+    const f32 radius = sqrtf(bounds.x*bounds.x + bounds.y*bounds.y + bounds.z*bounds.z);
+    f32 farthest = 0.0f;
+    for (u32 v = 0; v < mesh->getNumVerts(); ++v) {
+      const vec4& pos = mesh->getVerts()[v].pos;
+      const f32 dx = pos.x - center.x, dy = pos.y - center.y, dz = pos.z - center.z;
+      farthest = fmaxf(farthest, sqrtf(dx*dx + dy*dy + dz*dz));
+    }
+    printf(" within %.3f of a radius %.3f", farthest, radius);
+    wsCheck(farthest <= radius*1.001f);
+    f32 prevError = 0.0f;
+    for (u32 l = 0; l < numLODs; ++l) {
+      const wsMeshLOD& lod = mesh->getLODs()[l];
+      printf(", level %u %u (error %.4f)", l + 1, lod.totalTriangles, lod.error);
+      wsCheck(lod.totalTriangles < prevTris);
+      wsCheck(lod.error >= prevError);
+      u32 sum = 0;
+      bool sameMaterial = true;
+      for (u32 m = 0; m < numMaterials; ++m) {
+        sum += lod.numTriangles[m];
+        for (u32 t = 0; t < lod.numTriangles[m]; ++t) {
+          for (u32 c = 0; c < 3; ++c) {
+            u32 v = lod.tris[m][t].vertIndices[c];
+            if (v >= mesh->getNumVerts() || !usedBy[m][v]) { sameMaterial = false; }
+          }
+        }
+      }
+      wsCheck(sum == lod.totalTriangles);
+      wsCheck(sameMaterial);
+      prevTris = lod.totalTriangles;
+      prevError = lod.error;
+    }
+    printf("\n");
+  }
+}
+
+void testSelection() {
+  const f32 errors[3] = { 0.002f, 0.01f, 0.05f };
+  const f32 radius = 1.0f;
+  //  Nothing to choose from, or extremes of size
+  wsCheck(wsSelectLOD(errors, 0, 0, 0.0f) == 0);
+  wsCheck(wsSelectLOD(errors, 3, 0, 0.0f) == 3);
+  wsCheck(wsSelectLOD(errors, 3, 3, WS_TEST_SCREEN_HEIGHT) == 0);
+  wsCheck(wsSelectLOD(errors, 3, 2, WS_TEST_SCREEN_HEIGHT) == 0);
+
+  //  Walking away, then back; the level is always within the limit, only coarsens
+  //  going away, and only refines coming back
+  u32 level = 0;
+  u32 numOverLimit = 0;
+  u32 numWrongWay = 0;
+  u32 levelsSeen = 0;
+  for (u32 step = 0; step < 2*WS_TEST_STEPS; ++step) {
+    bool away = (step < WS_TEST_STEPS);
+    f32 distance = 2.0f + 0.5f*(away ? step : 2*WS_TEST_STEPS - step);
+    f32 pixels = screenRadius(radius, distance);
+    u32 next = wsSelectLOD(errors, 3, level, pixels);
+    if (!withinLimit(errors, next, pixels)) { ++numOverLimit; }
+    if ((away && next < level) || (!away && next > level)) { ++numWrongWay; }
+    levelsSeen |= (1 << next);
+    level = next;
+  }
+  wsCheck(numOverLimit == 0);
+  wsCheck(numWrongWay == 0);
+  wsCheck(levelsSeen == 0xF);
+
+  //  Hovering about the size at which level 2 reaches the limit
+  f32 threshold = WS_LOD_PIXEL_ERROR/errors[1];
+  u32 numSwitches = 0, numSwitchesWithout = 0;
+  u32 withHysteresis = wsSelectLOD(errors, 3, 0, threshold*1.05f);
+  u32 without = wsSelectLOD(errors, 3, 0, threshold*1.05f, WS_LOD_PIXEL_ERROR, 0.0f);
+  for (u32 step = 0; step < WS_TEST_STEPS; ++step) {
+    f32 pixels = threshold*((step & 1) ? 0.95f : 1.05f);
+    u32 next = wsSelectLOD(errors, 3, withHysteresis, pixels);
+    numSwitches += (next != withHysteresis);
+    withHysteresis = next;
+    next = wsSelectLOD(errors, 3, without, pixels, WS_LOD_PIXEL_ERROR, 0.0f);
+    numSwitchesWithout += (next != without);
+    without = next;
+  }
+  printf("  Hovering 5%% about a threshold for %u frames: %u switches, %u without hysteresis\n",
+          WS_TEST_STEPS, numSwitches, numSwitchesWithout);
+  wsCheck(numSwitches == 0);
+  //  Without it, every frame after the first switches
+  wsCheck(numSwitchesWithout == WS_TEST_STEPS - 1);
+  //  It coarsens once the smaller size clears the limit by the hysteresis share
+  f32 clear = threshold*(1.0f - WS_LOD_HYSTERESIS)*0.99f;
+  wsCheck(wsSelectLOD(errors, 3, 1, clear) == 2);
+  wsCheck(wsSelectLOD(errors, 3, 1, threshold*0.95f) == 1);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  testLevels();
+  testSelection();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("lodSelectionTest");
+}
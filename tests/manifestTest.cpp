@@ -0,0 +1,131 @@
+/*
+ * manifestTest.cpp
+ *
+ *    Tests that the asset manifest reads back what assetCooker writes, and that the
+ *    virtual file system serves the cooked file it lists only while the source on disk
+ *    has the size and write time recorded when it was cooked.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsUtils/wsAssetManifest.h"
+#include "../whipstitch/wsUtils/wsVirtualFS.h"
+
+#define WS_TEST_DIR "/tmp/manifestTest"
+#define WS_TEST_SOURCE WS_TEST_DIR "/box.wsMesh"
+#define WS_TEST_COOKED WS_TEST_DIR "/box.wsMeshBin"
+#define WS_TEST_MANIFEST WS_TEST_DIR "/assets.wsManifest"
+#define WS_TEST_USE WS_TEST_DIR "/box_n.png"
+#define WS_TEST_EXTENSION ".wsMeshBin"
+
+void writeFile(const char* path, const char* text) {
+  FILE* out = fopen(path, "wb");
+  wsCheck(out != WS_NULL);
+  if (out == WS_NULL) { return; }
+  fputs(text, out);
+  fclose(out);
+}
+
+//  Writes a manifest listing the source as it is on disk now, or with the given stamp
+void writeManifest(u64 sourceSize, i64 sourceTime) {
+  wsManifestUse use = { WS_TEST_USE, true };
+  wsManifestAsset asset = { 0x8d1f00c4a09b3e27ull, 0x0123456789abcdefull, sourceSize, sourceTime, WS_TEST_SOURCE,
+                            WS_TEST_COOKED, &use, 1, 0 };
+  wsCheck(wsWriteManifest(WS_TEST_MANIFEST, &asset, 1));
+  wsCheck(wsVFS.loadManifest(WS_TEST_MANIFEST));
+}
+
+void writeManifest() {
+  writeManifest((u64)wsFile::file_size(WS_TEST_SOURCE), (i64)wsFile::last_write_time(WS_TEST_SOURCE));
+}
+
+bool findsCooked() {
+  char dest[WS_MAX_ASSET_PATH];
+  return (wsVFS.findCurrentCooked(dest, WS_TEST_SOURCE, WS_TEST_EXTENSION, WS_MAX_ASSET_PATH) &&
+          strcmp(dest, WS_TEST_COOKED) == 0);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(16*wsMB, wsMB);
+  wsVFS.startUp();
+  wsFile::create_directories(WS_TEST_DIR);
+  writeFile(WS_TEST_SOURCE, "versionNumber 1\n");
+  writeFile(WS_TEST_COOKED, "cooked");
+  //  The cooked file is older than its source, so only the manifest can vouch for it
+  const i64 sourceTime = (i64)wsFile::last_write_time(WS_TEST_SOURCE);
+  wsFile::last_write_time(WS_TEST_COOKED, (std::time_t)(sourceTime - 60));
+
+  //  Every field is read back as written
+  writeManifest();
+  wsAssetManifest manifest;
+  wsCheck(manifest.open(WS_TEST_MANIFEST));
+  const wsManifestAsset* asset = manifest.find(WS_TEST_SOURCE);
+  wsCheck(asset != WS_NULL);
+  if (asset != WS_NULL) {
+    wsCheck(asset->key == 0x8d1f00c4a09b3e27ull);
+    wsCheck(asset->cookedHash == 0x0123456789abcdefull);
+    wsCheck(asset->sourceSize == (u64)wsFile::file_size(WS_TEST_SOURCE));
+    wsCheck(asset->sourceTime == sourceTime);
+    wsCheck(strcmp(asset->cooked, WS_TEST_COOKED) == 0);
+    wsCheck(asset->numUses == 1 && asset->uses[0].linear && strcmp(asset->uses[0].path, WS_TEST_USE) == 0);
+  }
+  manifest.close();
+
+  //  An unchanged source is served its cooked file
+  wsCheck(findsCooked());
+  //  One whose size or write time differs from the manifest's is loaded itself
+  writeManifest((u64)wsFile::file_size(WS_TEST_SOURCE) + 1, sourceTime);
+  wsCheck(!findsCooked());
+  writeManifest((u64)wsFile::file_size(WS_TEST_SOURCE), sourceTime + 1);
+  wsCheck(!findsCooked());
+  //  Editing the source after cooking does the same
+  writeManifest();
+  writeFile(WS_TEST_SOURCE, "versionNumber 1\nnumVertices 0\n");
+  wsCheck(!findsCooked());
+  wsFile::last_write_time(WS_TEST_SOURCE, (std::time_t)(sourceTime + 60));
+  writeFile(WS_TEST_SOURCE, "versionNumber 1\n");
+  wsFile::last_write_time(WS_TEST_SOURCE, (std::time_t)(sourceTime + 60));
+  wsCheck(!findsCooked());
+  //  Cooking it again brings the manifest up to date
+  writeManifest();
+  wsCheck(findsCooked());
+  //  A game shipped without its sources trusts the manifest
+  wsFile::remove(WS_TEST_SOURCE);
+  writeManifest(1, 1);
+  wsCheck(findsCooked());
+
+  //  A manifest of an older version is not read
+  writeFile(WS_TEST_MANIFEST, "versionNumber 1\nnumAssets 0\n");
+  wsActiveLogs = 0;
+  wsCheck(!wsVFS.loadManifest(WS_TEST_MANIFEST));
+  wsActiveLogs = WS_LOG_ERROR;
+
+  wsFile::remove_all(WS_TEST_DIR);
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("manifestTest");
+}
@@ -0,0 +1,212 @@
+/*
+ * meshParseTest.cpp
+ *
+ *    Loads the shipped .wsMesh and .wsAnim files through the tokenizer, in the order
+ *    they were exported, and checks a checksum of every parsed field against the one
+ *    the original fscanf loader gave for the same file. The loads run once inline and
+ *    once split into chunks for four workers. Then reports the time to load each file.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsAnimation.h"
+#include "../whipstitch/wsAssets/wsMesh.h"
+#include "../whipstitch/wsGameFlow/wsThreadPool.h"
+#include <cstring>
+
+#define WS_TEST_WORKERS 4
+#define WS_BENCH_ROUNDS 10
+
+struct wsShippedFile {
+  const char* path;
+  u64 checksum;   //  From the fscanf loader this tokenizer replaced
+};
+
+const wsShippedFile meshes[] = {
+  { "models/Griswald.wsMesh", 0x8D222B388FFBF244ULL },
+  { "models/bladeWand.wsMesh", 0x294A77064600FA73ULL },
+  { "models/blueBox.wsMesh", 0x2478D0F7A7983D35ULL }
+};
+const wsShippedFile animations[] = {
+  { "models/Idle.wsAnim", 0x0E6288A820E22F48ULL },
+  { "models/Jump.wsAnim", 0xBD023C575C878125ULL },
+  { "models/Walk.wsAnim", 0xEBDAC3AA73FAE4ECULL }
+};
+const u32 numMeshes = sizeof(meshes)/sizeof(meshes[0]);
+const u32 numAnimations = sizeof(animations)/sizeof(animations[0]);
+
+//  FNV-1a over each field in turn, so padding and the engine's own hashes play no part
+struct wsChecksum {
+  u64 value;
+  wsChecksum() : value(14695981039346656037ULL) {}
+  void add(const void* data, u64 numBytes) {
+    for (u64 i = 0; i < numBytes; ++i) { value = (value ^ ((const u8*)data)[i])*1099511628211ULL; }
+  }
+  void add(u32 my) { add(&my, sizeof(my)); }
+  void add(i32 my) { add(&my, sizeof(my)); }
+  void add(f32 my) { add(&my, sizeof(my)); }
+  void add(const vec4& my) { add(my.x); add(my.y); add(my.z); add(my.w); }
+  //  Joint positions, whose w is set rather than read from the file
+  void addPoint(const vec4& my) { add(my.x); add(my.y); add(my.z); }
+  void add(const quat& my) { add(my.x); add(my.y); add(my.z); add(my.w); }
+  void add(const char* my) { add(my, strlen(my)); }
+};
+
+u64 meshChecksum(const wsMesh& mesh) {
+  wsChecksum sum;
+  sum.add(*mesh.getBounds());
+  sum.add(mesh.getDefaultPos());
+  sum.add(mesh.getNumVerts());
+  for (u32 v = 0; v < mesh.getNumVerts(); ++v) {
+    const wsVert& vert = mesh.getVerts()[v];
+    sum.add(vert.pos);
+    sum.add(vert.norm);
+    sum.add(vert.tex[0]);
+    sum.add(vert.tex[1]);
+    sum.add(vert.numWeights);
+    for (u32 w = 0; w < WS_MAX_JOINT_INFLUENCES; ++w) {
+      sum.add(vert.jointIndex[w]);
+      sum.add(vert.influence[w]);
+    }
+  }
+  sum.add(mesh.getNumMaterials());
+  for (u32 m = 0; m < mesh.getNumMaterials(); ++m) {
+    const wsMaterial& mat = mesh.getMats()[m];
+    sum.add(mat.ambient);
+    sum.add(mat.diffuse);
+    sum.add(mat.specular);
+    sum.add(mat.emissive);
+    sum.add(mat.shininess);
+    sum.add(mat.numProperties);
+    sum.add(mat.numTriangles);
+    sum.add(mat.tris, sizeof(wsTriangle)*(u64)mat.numTriangles);
+  }
+  const u32 numJoints = mesh.getJoints() ? mesh.getNumJoints() : 0;
+  sum.add(numJoints);
+  for (u32 j = 0; j < numJoints; ++j) {
+    const wsJoint& joint = mesh.getJoints()[j];
+    sum.addPoint(joint.start);
+    sum.addPoint(joint.startRel);
+    sum.addPoint(joint.end);
+    sum.add(joint.rot);
+    sum.add(joint.parent);
+  }
+  return sum.value;
+}
+
+u64 animationChecksum(wsAnimation& animation) {
+  wsChecksum sum;
+  sum.add(animation.getName());
+  sum.add(animation.getBounds());
+  sum.add(animation.getFramesPerSecond());
+  sum.add((f32)animation.getAnimLength());
+  sum.add(animation.getNumJoints());
+  for (u32 j = 0; j < animation.getNumJoints(); ++j) {
+    const wsAnimJoint& joint = animation.getJoints()[j];
+    sum.add(joint.name);
+    sum.add(joint.parent);
+    sum.addPoint(joint.start);
+    sum.add(joint.rot);
+  }
+  sum.add(animation.getNumKeyframes());
+  for (u32 k = 0; k < animation.getNumKeyframes(); ++k) {
+    const wsKeyframe& keyframe = animation.getKeyframes()[k];
+    sum.add(keyframe.frameIndex);
+    sum.add(keyframe.numJointsModified);
+    for (u32 m = 0; m < keyframe.numJointsModified; ++m) {
+      sum.add(keyframe.mods[m].jointIndex);
+      sum.addPoint(keyframe.mods[m].location);
+      sum.add(keyframe.mods[m].rotation);
+    }
+  }
+  return sum.value;
+}
+
+void testChecksums(const char* how) {
+  wsMem.setTier(wsMemoryStack::PRIMARY_FRONT);
+  for (u32 i = 0; i < numMeshes; ++i) {
+    wsMesh mesh(meshes[i].path, WS_MESH_FORMAT_WHIPSTITCH, false, false);
+    const u64 checksum = meshChecksum(mesh);
+    printf("  %s, %s: 0x%016llX %s\n", meshes[i].path, how, (unsigned long long)checksum,
+            (checksum == meshes[i].checksum) ? "matches" : "DIFFERS");
+    wsCheck(mesh.isLoaded() && checksum == meshes[i].checksum);
+  }
+  for (u32 i = 0; i < numAnimations; ++i) {
+    wsAnimation animation(animations[i].path, false);
+    const u64 checksum = animationChecksum(animation);
+    printf("  %s, %s: 0x%016llX %s\n", animations[i].path, how, (unsigned long long)checksum,
+            (checksum == animations[i].checksum) ? "matches" : "DIFFERS");
+    wsCheck(animation.isLoaded() && checksum == animations[i].checksum);
+  }
+  wsMem.freePrimaryFront();
+}
+
+void benchmark() {
+  char name[64];
+  for (u32 i = 0; i < numMeshes; ++i) {
+    t64 best = 1.0e9;
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) {
+      wsMem.setTier(wsMemoryStack::PRIMARY_FRONT);
+      wsBenchmarkBegin();
+      { wsMesh mesh(meshes[i].path, WS_MESH_FORMAT_WHIPSTITCH, false, false); }
+      const t64 seconds = wsBenchmarkEnd();
+      if (seconds < best) { best = seconds; }
+      wsMem.freePrimaryFront();
+    }
+    snprintf(name, 64, "%s, best of %u", meshes[i].path, WS_BENCH_ROUNDS);
+    wsReportTime(name, best, 1);
+  }
+  for (u32 i = 0; i < numAnimations; ++i) {
+    t64 best = 1.0e9;
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) {
+      wsMem.setTier(wsMemoryStack::PRIMARY_FRONT);
+      wsBenchmarkBegin();
+      { wsAnimation animation(animations[i].path, false); }
+      const t64 seconds = wsBenchmarkEnd();
+      if (seconds < best) { best = seconds; }
+      wsMem.freePrimaryFront();
+    }
+    snprintf(name, 64, "%s, best of %u", animations[i].path, WS_BENCH_ROUNDS);
+    wsReportTime(name, best, 1);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  testChecksums("inline");
+  benchmark();
+  wsThreads.startUp();
+  //  With too few cores to split the loads, claim more workers than there are; the
+  //  extra chunks queue up and run here, cut at the same places as on a larger machine
+  const u32 numWorkers = wsThreads.getNumThreads();
+  if (numWorkers < WS_TEST_WORKERS) { wsThreads.setNumThreads(WS_TEST_WORKERS); }
+  testChecksums("in chunks");
+  wsThreads.setNumThreads(numWorkers);
+  wsThreads.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("meshParseTest");
+}
@@ -0,0 +1,162 @@
+/*
+ * mipmapTest.cpp
+ *
+ *    Tests wsBuildMipChain(...) on generated images. A black and white checker must
+ *    average to sRGB 188, the value of half the light, in every smaller level, and to
+ *    128 when the image is linear data; alpha always averages to 128. Every constant
+ *    grey must map to itself, the chain must be flipped to bottom row first, and odd
+ *    sizes must halve down to 1x1. Then times building chains on 1, 4 and as many
+ *    threads as there are cores, each thread building its own, as the loader threads do.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsGraphics/wsMipmaps.h"
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#define WS_TEST_SIZE 256
+#define WS_BENCH_SIZE 1024
+//  Chains built in each timing, shared between the threads
+#define WS_BENCH_CHAINS 16
+
+//  True if every byte of channel c of the level is within tolerance of value
+bool levelIs(const u8* chain, const wsTextureLevel& level, u32 channels, u32 c, u32 value, u32 tolerance) {
+  const u8* pixels = chain + level.offset;
+  for (u32 p = 0; p < level.width*level.height; ++p) {
+    const i32 difference = (i32)pixels[p*channels + c] - (i32)value;
+    if (difference > (i32)tolerance || difference < -(i32)tolerance) { return false; }
+  }
+  return true;
+}
+
+//  Pixels alternate between black and white, with alpha opaque over the white ones
+void makeChecker(u8* pixels, u32 width, u32 height, u32 channels) {
+  for (u32 y = 0; y < height; ++y) {
+    for (u32 x = 0; x < width; ++x) {
+      u8* pixel = pixels + ((u64)y*width + x)*channels;
+      const u8 value = ((x + y) & 1) ? 255 : 0;
+      for (u32 c = 0; c < channels; ++c) { pixel[c] = value; }
+    }
+  }
+}
+
+void testChecker(u8* pixels) {
+  wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS];
+  for (u32 channels = 3; channels <= 4; ++channels) {
+    makeChecker(pixels, WS_TEST_SIZE, WS_TEST_SIZE, channels);
+    for (u32 linear = 0; linear <= 1; ++linear) {
+      u8* chain = WS_NULL;
+      const u32 numLevels = wsBuildMipChain(&chain, levels, pixels, WS_TEST_SIZE, WS_TEST_SIZE, channels, linear);
+      wsCheck(chain != WS_NULL);
+      wsCheck(numLevels == 9);
+      const u32 expected = linear ? 128 : 188;
+      bool allLevels = true;
+      for (u32 l = 1; l < numLevels; ++l) {
+        for (u32 c = 0; c < 3; ++c) { allLevels &= levelIs(chain, levels[l], channels, c, expected, 0); }
+        if (channels == 4) { allLevels &= levelIs(chain, levels[l], channels, 3, 128, 0); }
+      }
+      const u8* smallest = chain + levels[numLevels-1].offset;
+      printf("  %s checker, %s: 1x1 level is (%u, %u, %u%s", (channels == 3) ? "RGB" : "RGBA",
+              linear ? "linear" : "sRGB", smallest[0], smallest[1], smallest[2], (channels == 3) ? ")\n" : "");
+      if (channels == 4) { printf(", %u)\n", smallest[3]); }
+      wsCheck(allLevels);
+      free(chain);
+    }
+  }
+}
+
+void testGreys(u8* pixels) {
+  wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS];
+  bool allGreys = true;
+  for (u32 grey = 0; grey < 256; ++grey) {
+    memset(pixels, grey, 16*16*4);
+    u8* chain = WS_NULL;
+    const u32 numLevels = wsBuildMipChain(&chain, levels, pixels, 16, 16, 4);
+    for (u32 c = 0; c < 4; ++c) { allGreys &= levelIs(chain, levels[numLevels-1], 4, c, grey, 0); }
+    free(chain);
+  }
+  wsCheck(allGreys);
+}
+
+void testLayout(u8* pixels) {
+  wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS];
+  //  Each row a different shade, so the flip shows
+  const u32 width = 37, height = 13;
+  for (u32 y = 0; y < height; ++y) { memset(pixels + y*width*3, y*16, width*3); }
+  u8* chain = WS_NULL;
+  const u32 numLevels = wsBuildMipChain(&chain, levels, pixels, width, height, 3);
+  wsCheck(numLevels == 6);
+  wsCheck(levels[1].width == 18 && levels[1].height == 6);
+  wsCheck(levels[numLevels-1].width == 1 && levels[numLevels-1].height == 1);
+  wsCheck(memcmp(chain, pixels + (height-1)*width*3, width*3) == 0);
+  wsCheck(memcmp(chain + (height-1)*width*3, pixels, width*3) == 0);
+  bool aligned = true;
+  for (u32 l = 0; l < numLevels; ++l) { aligned &= (levels[l].offset % WS_TEXTURE_ALIGNMENT == 0); }
+  wsCheck(aligned);
+  free(chain);
+}
+
+void benchmark(u8* pixels) {
+  wsRandom rng(45);
+  rng.fill((u32*)pixels, WS_BENCH_SIZE*WS_BENCH_SIZE);
+  u32 threadCounts[] = { 1, 4, (u32)WS_NUM_CORES };
+  for (u32 t = 0; t < 3; ++t) {
+    const u32 numThreads = threadCounts[t];
+    std::thread* threads = new std::thread[numThreads];
+    wsBenchmarkBegin();
+    for (u32 i = 0; i < numThreads; ++i) {
+      threads[i] = std::thread([=]() {
+        wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS];
+        for (u32 c = i; c < WS_BENCH_CHAINS; c += numThreads) {
+          u8* chain = WS_NULL;
+          wsBuildMipChain(&chain, levels, pixels, WS_BENCH_SIZE, WS_BENCH_SIZE, 4);
+          free(chain);
+        }
+      });
+    }
+    for (u32 i = 0; i < numThreads; ++i) { threads[i].join(); }
+    const t64 seconds = wsBenchmarkEnd();
+    delete[] threads;
+    char name[64];
+    snprintf(name, 64, "sRGB RGBA chain, %u thread%s", numThreads, (numThreads == 1) ? "" : "s");
+    wsReportTime(name, seconds, WS_BENCH_CHAINS);
+    printf("    %.1f source MP/s\n", (f64)WS_BENCH_SIZE*WS_BENCH_SIZE*WS_BENCH_CHAINS/seconds*1.0e-6);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  u8* pixels = wsNewArray(u8, WS_BENCH_SIZE*WS_BENCH_SIZE*4);
+  testChecker(pixels);
+  testGreys(pixels);
+  testLayout(pixels);
+  benchmark(pixels);
+  wsMem.shutDown();
+  return wsTestResult("mipmapTest");
+}
@@ -0,0 +1,244 @@
+/*
+ * packedVertexTest.cpp
+ *
+ *    Checks how closely the compact vertex layout decodes to the vertices it was packed
+ *    from, using the inverses the vertex shader mirrors. Octahedral normals must stay
+ *    within a small angle of the original, every half float must round to nearest and
+ *    survive a round trip, and packed weights must sum to exactly one and each stay
+ *    close to the renormalized original. Then packs the shipped models and reports the
+ *    bytes saved and the largest errors seen.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsMeshOptimizer.h"
+#include <cmath>
+
+#define WS_TEST_NORMALS 200000
+#define WS_TEST_WEIGHTS 100000
+//  Largest angle, in degrees, between a normal and its decoded form; two snorm16s
+//  land within 0.008 degrees, stretched the most where the octahedron folds
+#define WS_TEST_NORMAL_TOLERANCE 0.01
+//  Rounding each weight to a unorm8 is off by at most half a step; the heaviest also
+//  takes up what the rounding of the others left over
+#define WS_TEST_WEIGHT_TOLERANCE (2.0/255.0 + 1.0e-6)
+
+//  The angle, in degrees, between two directions. Taken from both the sine and cosine,
+//  as the arccosine of a dot product near one cannot resolve angles this small.
+f64 angleBetween(const vec4& a, const vec4& b) {
+  f64 crossX = (f64)a.y*b.z - (f64)a.z*b.y;
+  f64 crossY = (f64)a.z*b.x - (f64)a.x*b.z;
+  f64 crossZ = (f64)a.x*b.y - (f64)a.y*b.x;
+  f64 dot = (f64)a.x*b.x + (f64)a.y*b.y + (f64)a.z*b.z;
+  return atan2(sqrt(crossX*crossX + crossY*crossY + crossZ*crossZ), dot)*180.0/M_PI;
+}
+
+//  The angle, in degrees, between a normal and the decoded form of its packed code
+f64 normalError(const vec4& norm) {
+  i16 packed[2];
+  wsPackOctahedral(packed, norm);
+  return angleBetween(norm, wsUnpackOctahedral(packed));
+}
+
+void testNormals() {
+  wsRandom random(41);
+  f64 maxError = 0.0;
+  u32 numUnitLength = 0;
+  for (u32 n = 0; n < WS_TEST_NORMALS; ++n) {
+    vec4 norm(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), 0.0f);
+    //  Some on the axes and the creases of the octahedron, where the fold is
+    if (n % 7 == 0) { norm.x = 0.0f; }
+    if (n % 11 == 0) { norm.y = 0.0f; }
+    if (n % 13 == 0) { norm.z = 0.0f; }
+    if (norm.x == 0.0f && norm.y == 0.0f && norm.z == 0.0f) { norm.z = -1.0f; }
+    f64 error = normalError(norm);
+    if (error > maxError) { maxError = error; }
+    i16 packed[2];
+    wsPackOctahedral(packed, norm);
+    vec4 decoded = wsUnpackOctahedral(packed);
+    f32 length = sqrtf(decoded.x*decoded.x + decoded.y*decoded.y + decoded.z*decoded.z);
+    numUnitLength += (fabsf(length - 1.0f) < 1.0e-5f);
+  }
+  const vec4 axes[6] = { vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(-1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f),
+                          vec4(0.0f, -1.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 1.0f, 0.0f), vec4(0.0f, 0.0f, -1.0f, 0.0f) };
+  for (u32 a = 0; a < 6; ++a) {
+    f64 error = normalError(axes[a]);
+    if (error > maxError) { maxError = error; }
+  }
+  printf("  Octahedral normals: largest error %.5f degrees\n", maxError);
+  wsCheck(maxError < WS_TEST_NORMAL_TOLERANCE);
+  wsCheck(numUnitLength == WS_TEST_NORMALS);
+}
+
+void testHalfFloats() {
+  //  Every finite half survives a round trip through a float
+  u32 numMismatched = 0;
+  for (u32 h = 0; h < 0x10000; ++h) {
+    if ((h & 0x7C00) == 0x7C00) { continue; }
+    if (wsFloatToHalf(wsHalfToFloat((u16)h)) != h) { ++numMismatched; }
+  }
+  wsCheck(numMismatched == 0);
+  //  Floats round to the nearest half, and halfway between two to the even one
+  u32 numNotNearest = 0;
+  u32 numNotEven = 0;
+  for (u32 h = 0; h < 0x7BFF; ++h) {
+    f32 low = wsHalfToFloat((u16)h);
+    f32 high = wsHalfToFloat((u16)(h + 1));
+    f32 middle = low + (high - low)*0.5f;
+    if (wsFloatToHalf(middle) != ((h & 1) ? h + 1 : h)) { ++numNotEven; }
+    f32 nearLow = low + (high - low)*0.25f;
+    f32 nearHigh = low + (high - low)*0.75f;
+    if (wsFloatToHalf(nearLow) != h || wsFloatToHalf(nearHigh) != h + 1) { ++numNotNearest; }
+    if (wsFloatToHalf(-nearLow) != (h | 0x8000)) { ++numNotNearest; }
+  }
+  wsCheck(numNotNearest == 0);
+  wsCheck(numNotEven == 0);
+  //  UVs in the range textures tile over keep 11 significant bits
+  wsRandom random(41);
+  f64 maxRelative = 0.0;
+  for (u32 i = 0; i < WS_TEST_NORMALS; ++i) {
+    f32 uv = random.nextFloat(-8.0f, 8.0f);
+    if (fabsf(uv) < 1.0f/16384.0f) { continue; }
+    f64 relative = fabs((f64)wsHalfToFloat(wsFloatToHalf(uv)) - uv)/fabs(uv);
+    if (relative > maxRelative) { maxRelative = relative; }
+  }
+  printf("  Half float UVs: largest relative error %.3g\n", maxRelative);
+  wsCheck(maxRelative <= 1.0/2048.0);
+  wsCheck(wsHalfToFloat(wsFloatToHalf(1.0f)) == 1.0f);
+  wsCheck(wsHalfToFloat(wsFloatToHalf(0.5f)) == 0.5f);
+  wsCheck(wsFloatToHalf(70000.0f) == 0x7C00);
+  wsCheck(wsFloatToHalf(-70000.0f) == 0xFC00);
+}
+
+//  Returns the largest difference between a packed weight and the renormalized original;
+//  counts the vertices whose weights do not sum to 255 or whose joints change
+f64 checkWeights(const wsVert* verts, const wsPackedVert* packed, u32 numVerts, u32* numBad) {
+  f64 maxError = 0.0;
+  for (u32 v = 0; v < numVerts; ++v) {
+    const wsVert& src = verts[v];
+    const wsPackedVert& my = packed[v];
+    u32 numWeights = (src.numWeights > 0) ? (u32)src.numWeights : 0;
+    if (numWeights > WS_MAX_JOINT_INFLUENCES) { numWeights = WS_MAX_JOINT_INFLUENCES; }
+    f64 total = 0.0;
+    for (u32 w = 0; w < numWeights; ++w) { total += (src.influence[w] > 0.0f) ? src.influence[w] : 0.0f; }
+    if (total <= 0.0) {
+      *numBad += (my.numWeights != 0);
+      continue;
+    }
+    u32 sum = 0;
+    for (u32 w = 0; w < WS_MAX_JOINT_INFLUENCES; ++w) {
+      sum += my.influence[w];
+      if (w < numWeights) {
+        f64 expected = ((src.influence[w] > 0.0f) ? src.influence[w] : 0.0f)/total;
+        f64 error = fabs(my.influence[w]/255.0 - expected);
+        if (error > maxError) { maxError = error; }
+        *numBad += (my.jointIndex[w] != (u8)src.jointIndex[w]);
+      }
+      else {
+        *numBad += (my.influence[w] != 0);
+      }
+    }
+    *numBad += (sum != 255) || (my.numWeights != numWeights);
+  }
+  return maxError;
+}
+
+void testWeights() {
+  wsRandom random(41);
+  wsVert* verts = wsNewArray(wsVert, WS_TEST_WEIGHTS);
+  wsPackedVert* packed = wsNewArray(wsPackedVert, WS_TEST_WEIGHTS);
+  for (u32 v = 0; v < WS_TEST_WEIGHTS; ++v) {
+    wsVert& vert = verts[v];
+    vert.pos = vec4(random.nextFloat(-5.0f, 5.0f), random.nextFloat(-5.0f, 5.0f), random.nextFloat(-5.0f, 5.0f), 1.0f);
+    vert.norm = vec4(0.0f, 0.0f, 1.0f, 0.0f);
+    vert.tex[0] = vert.tex[1] = 0.0f;
+    vert.numWeights = random.nextInt(0, WS_MAX_JOINT_INFLUENCES);
+    for (u32 w = 0; w < WS_MAX_JOINT_INFLUENCES; ++w) {
+      vert.jointIndex[w] = random.nextInt(0, 255);
+      //  Weights which do not sum to one, as exporters leave them, and some tiny ones
+      vert.influence[w] = (v % 5 == 0) ? random.nextFloat(0.0f, 0.01f) : random.nextFloat(0.0f, 1.0f);
+    }
+  }
+  wsPackVertices(packed, verts, WS_TEST_WEIGHTS);
+  u32 numBad = 0;
+  f64 maxError = checkWeights(verts, packed, WS_TEST_WEIGHTS, &numBad);
+  u32 numPositionsChanged = 0;
+  for (u32 v = 0; v < WS_TEST_WEIGHTS; ++v) {
+    numPositionsChanged += (packed[v].pos[0] != verts[v].pos.x || packed[v].pos[1] != verts[v].pos.y ||
+                            packed[v].pos[2] != verts[v].pos.z);
+  }
+  printf("  Unorm8 weights: largest error %.5f\n", maxError);
+  wsCheck(maxError <= WS_TEST_WEIGHT_TOLERANCE);
+  wsCheck(numBad == 0);
+  wsCheck(numPositionsChanged == 0);
+}
+
+void testModels() {
+  const char* models[] = { "models/Griswald.wsMesh", "models/bladeWand.wsMesh", "models/blueBox.wsMesh" };
+  for (u32 f = 0; f < 3; ++f) {
+    wsMesh* mesh = wsNew(wsMesh, wsMesh(models[f], WS_MESH_FORMAT_WHIPSTITCH, false));
+    u32 numVerts = mesh->getNumVerts();
+    const wsVert* verts = mesh->getVerts();
+    wsPackedVert* packed = wsNewArray(wsPackedVert, numVerts);
+    wsPackVertices(packed, verts, numVerts);
+    f64 maxNormal = 0.0, maxUV = 0.0;
+    for (u32 v = 0; v < numVerts; ++v) {
+      const vec4& norm = verts[v].norm;
+      if (norm.x != 0.0f || norm.y != 0.0f || norm.z != 0.0f) {
+        f64 angle = angleBetween(norm, wsUnpackOctahedral(packed[v].norm));
+        if (angle > maxNormal) { maxNormal = angle; }
+      }
+      for (u32 t = 0; t < 2; ++t) {
+        f64 error = fabs((f64)wsHalfToFloat(packed[v].tex[t]) - verts[v].tex[t]);
+        if (error > maxUV) { maxUV = error; }
+      }
+    }
+    u32 numBad = 0;
+    f64 maxWeight = checkWeights(verts, packed, numVerts, &numBad);
+    printf("  %s: %u vertices, %u -> %u bytes; errors: normal %.4f degrees, UV %.2g, weight %.4f\n",
+            models[f], numVerts, numVerts*(u32)sizeof(wsVert), numVerts*(u32)sizeof(wsPackedVert),
+            maxNormal, maxUV, maxWeight);
+    wsCheck(maxNormal < WS_TEST_NORMAL_TOLERANCE);
+    //  The shipped UVs lie within [0, 1], where a half is within 2^-12
+    wsCheck(maxUV <= 1.0/4096.0);
+    wsCheck(maxWeight <= WS_TEST_WEIGHT_TOLERANCE);
+    wsCheck(numBad == 0);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  wsCheck(sizeof(wsPackedVert) == 32);
+  testNormals();
+  testHalfFloats();
+  testWeights();
+  testModels();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("packedVertexTest");
+}
@@ -0,0 +1,198 @@
+/*
+ * queueTest.cpp
+ *
+ *    Stress tests the lock-free queues. One producer and one consumer pass numbered
+ *    items through a wsSPSCQueue, mixing single and batch operations, and the
+ *    consumer checks each arrives once and in order. Several producers and consumers
+ *    share a wsMPMCQueue; every item must arrive exactly once, and each producer's
+ *    items in the order it pushed them. Then times both against a wsQueue guarded by
+ *    a mutex.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define WS_TEST_ITEMS 1000000
+#define WS_TEST_PRODUCERS 4
+#define WS_TEST_CONSUMERS 4
+#define WS_TEST_BATCH 16
+//  An MPMC item carries its producer in the high bits and its number in the low
+#define WS_TEST_PRODUCER_SHIFT 40
+#define WS_TEST_NUMBER_MASK ((1ull << WS_TEST_PRODUCER_SHIFT) - 1)
+
+void testSPSC() {
+  wsSPSCQueue<u64> queue(1000);
+  wsCheck(queue.getCapacity() == 1024);
+  wsCheck(queue.isEmpty());
+  wsBenchmarkBegin();
+  std::thread producer([&queue]() {
+    u64 batch[WS_TEST_BATCH];
+    u64 next = 0;
+    while (next < WS_TEST_ITEMS) {
+      if (next % 3 == 0) {
+        u32 numItems = (u32)(next % WS_TEST_BATCH) + 1;
+        if (next + numItems > WS_TEST_ITEMS) { numItems = (u32)(WS_TEST_ITEMS - next); }
+        for (u32 i = 0; i < numItems; ++i) { batch[i] = next + i; }
+        u32 numPushed = queue.pushBatch(batch, numItems);
+        next += numPushed;
+        if (numPushed == 0) { std::this_thread::yield(); }
+      }
+      else if (queue.push(next)) { ++next; }
+      else { std::this_thread::yield(); }
+    }
+  });
+  u64 batch[WS_TEST_BATCH];
+  u64 expected = 0;
+  u32 numWrong = 0;
+  while (expected < WS_TEST_ITEMS) {
+    u32 numPopped = 0;
+    if (expected % 2) {
+      numPopped = queue.popBatch(batch, WS_TEST_BATCH);
+    }
+    else if (queue.pop(batch[0])) {
+      numPopped = 1;
+    }
+    for (u32 i = 0; i < numPopped; ++i) {
+      if (batch[i] != expected++) { ++numWrong; }
+    }
+    if (numPopped == 0) { std::this_thread::yield(); }
+  }
+  producer.join();
+  wsReportTime("wsSPSCQueue, 1 producer, 1 consumer", wsBenchmarkEnd(), WS_TEST_ITEMS);
+  wsCheck(numWrong == 0);
+  wsCheck(queue.isEmpty());
+  wsCheck(!queue.pop(batch[0]));
+}
+
+void testMPMC() {
+  wsMPMCQueue<u64> queue(1024);
+  std::atomic<u64> numReceived(0);
+  std::atomic<u64> sum(0);
+  std::atomic<u32> numOutOfOrder(0);
+  std::vector<std::thread> threads;
+  wsBenchmarkBegin();
+  for (u64 p = 0; p < WS_TEST_PRODUCERS; ++p) {
+    threads.emplace_back([&queue, p]() {
+      u64 batch[WS_TEST_BATCH];
+      u64 next = 0;
+      while (next < WS_TEST_ITEMS) {
+        u32 numPushed = 0;
+        if (next % 5 == 0) {
+          u32 numItems = WS_TEST_BATCH;
+          if (next + numItems > WS_TEST_ITEMS) { numItems = (u32)(WS_TEST_ITEMS - next); }
+          for (u32 i = 0; i < numItems; ++i) { batch[i] = (p << WS_TEST_PRODUCER_SHIFT) | (next + i); }
+          numPushed = queue.pushBatch(batch, numItems);
+        }
+        else if (queue.push((p << WS_TEST_PRODUCER_SHIFT) | next)) {
+          numPushed = 1;
+        }
+        next += numPushed;
+        if (numPushed == 0) { std::this_thread::yield(); }
+      }
+    });
+  }
+  for (u32 c = 0; c < WS_TEST_CONSUMERS; ++c) {
+    threads.emplace_back([&, c]() {
+      //  The last number seen from each producer, plus one
+      u64 nextFrom[WS_TEST_PRODUCERS] = { 0 };
+      u64 batch[WS_TEST_BATCH];
+      while (numReceived.load() < (u64)WS_TEST_PRODUCERS*WS_TEST_ITEMS) {
+        u32 numPopped = 0;
+        if (c % 2) {
+          numPopped = queue.popBatch(batch, WS_TEST_BATCH);
+        }
+        else if (queue.pop(batch[0])) {
+          numPopped = 1;
+        }
+        for (u32 i = 0; i < numPopped; ++i) {
+          u64 producer = batch[i] >> WS_TEST_PRODUCER_SHIFT;
+          u64 number = batch[i] & WS_TEST_NUMBER_MASK;
+          if (producer >= WS_TEST_PRODUCERS || number < nextFrom[producer]) { ++numOutOfOrder; }
+          else { nextFrom[producer] = number + 1; }
+          sum += number;
+        }
+        numReceived += numPopped;
+        if (numPopped == 0) { std::this_thread::yield(); }
+      }
+    });
+  }
+  for (u32 t = 0; t < threads.size(); ++t) { threads[t].join(); }
+  wsReportTime("wsMPMCQueue, 4 producers, 4 consumers", wsBenchmarkEnd(),
+                (u64)WS_TEST_PRODUCERS*WS_TEST_ITEMS);
+  u64 expectedSum = (u64)WS_TEST_PRODUCERS*((u64)WS_TEST_ITEMS*(WS_TEST_ITEMS - 1)/2);
+  wsCheck(numReceived.load() == (u64)WS_TEST_PRODUCERS*WS_TEST_ITEMS);
+  wsCheck(sum.load() == expectedSum);
+  wsCheck(numOutOfOrder.load() == 0);
+  wsCheck(queue.isEmpty());
+}
+
+//  The baseline: the same single producer and consumer, through a locked wsQueue
+void benchmarkMutexQueue() {
+  wsQueue<u64> queue(1024);
+  std::mutex lock;
+  wsBenchmarkBegin();
+  std::thread producer([&]() {
+    u64 next = 0;
+    while (next < WS_TEST_ITEMS) {
+      bool pushed = false;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (queue.getLength() < 1024) {
+          queue.push(next++);
+          pushed = true;
+        }
+      }
+      if (!pushed) { std::this_thread::yield(); }
+    }
+  });
+  u64 expected = 0;
+  u32 numWrong = 0;
+  while (expected < WS_TEST_ITEMS) {
+    u64 item;
+    bool popped = false;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      popped = queue.pop(item);
+    }
+    if (!popped) { std::this_thread::yield(); }
+    else if (item != expected++) { ++numWrong; }
+  }
+  producer.join();
+  wsReportTime("wsQueue and std::mutex, 1 producer, 1 consumer", wsBenchmarkEnd(), WS_TEST_ITEMS);
+  wsCheck(numWrong == 0);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsMem.startUp(64*wsMB, wsMB);
+  testSPSC();
+  testMPMC();
+  benchmarkMutexQueue();
+  wsMem.shutDown();
+  return wsTestResult("queueTest");
+}
@@ -0,0 +1,241 @@
+/*
+ * randomTest.cpp
+ *
+ *    Tests wsRandom. Each lane must follow a reference xoshiro128**. Draws in a range
+ *    must be unbiased, including a range where the plain multiply would favor a third
+ *    of the values. A jumped stream and each thread's stream must share no numbers with
+ *    the stream they came from, and the bulk fills must give exactly the numbers single
+ *    draws would, at every SIMD level. Then times single and bulk draws.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#define WS_TEST_DRAWS 6000000
+#define WS_TEST_WINDOW 4096
+#define WS_TEST_THREADS 4
+#define WS_BENCH_COUNT (1 << 22)
+
+//  Exposes the lanes, to check them against the reference
+class wsRandomProbe : public wsRandom {
+  public:
+    wsRandomProbe(u64 seed) : wsRandom(seed) {}
+    void copyLane(u32* dest, u32 lane) const {
+      for (u32 word = 0; word < 4; ++word) { dest[word] = state[word][lane]; }
+    }
+};
+
+//  xoshiro128**, as published by Blackman and Vigna
+u32 referenceNext(u32* s) {
+  const u32 my = ((s[1]*5 << 7) | (s[1]*5 >> 25))*9;
+  const u32 t = s[1] << 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 11) | (s[3] >> 21);
+  return my;
+}
+
+void testReference() {
+  wsRandomProbe rng(35);
+  u32 lanes[WS_RANDOM_LANES][4];
+  for (u32 lane = 0; lane < WS_RANDOM_LANES; ++lane) { rng.copyLane(lanes[lane], lane); }
+  bool matches = true;
+  for (u32 i = 0; i < WS_TEST_WINDOW; ++i) {
+    matches &= (rng.next() == referenceNext(lanes[i % WS_RANDOM_LANES]));
+  }
+  wsCheck(matches);
+  //  Reseeding repeats the stream
+  wsRandom a(7), b(8);
+  b.seed(7);
+  bool repeats = true;
+  for (u32 i = 0; i < WS_TEST_WINDOW; ++i) { repeats &= (a.next() == b.next()); }
+  wsCheck(repeats);
+}
+
+//  Pearson's chi-squared statistic of counts that should all equal expected
+f64 chiSquared(const u32* counts, u32 numBins, f64 expected) {
+  f64 sum = 0.0;
+  for (u32 i = 0; i < numBins; ++i) { sum += (counts[i] - expected)*(counts[i] - expected)/expected; }
+  return sum;
+}
+
+void testBounded() {
+  wsRandom rng(350);
+  //  Die rolls; 20.5 is the 0.1% critical value for 5 degrees of freedom
+  u32 counts[6] = { 0 };
+  for (u32 i = 0; i < WS_TEST_DRAWS; ++i) { ++counts[rng.nextInt(1, 6) - 1]; }
+  const f64 dice = chiSquared(counts, 6, WS_TEST_DRAWS/6.0);
+  printf("  nextInt(1, 6): chi-squared %.2f over %u rolls\n", dice, WS_TEST_DRAWS);
+  wsCheck(dice < 20.5);
+  //  Below 3*2^30, multiplying without redraws maps two inputs onto every multiple of 3
+  //  and one onto the rest, so half the draws would be multiples of 3 rather than a third
+  u32 multiples = 0;
+  for (u32 i = 0; i < WS_TEST_DRAWS; ++i) { multiples += (rng.nextBelow(0xC0000000u) % 3 == 0); }
+  const f64 fraction = (f64)multiples/WS_TEST_DRAWS;
+  printf("  nextBelow(3*2^30): %.4f of draws are multiples of 3\n", fraction);
+  //  Within five standard deviations of a third
+  wsCheck(fabs(fraction - 1.0/3.0) < 5.0*sqrt(2.0/9.0/WS_TEST_DRAWS));
+  //  Every value of a range is reached, and nothing outside it
+  bool inRange = true;
+  u32 seen = 0;
+  for (u32 i = 0; i < 1000; ++i) {
+    const i32 value = rng.nextInt(-3, 3);
+    inRange &= (value >= -3 && value <= 3);
+    seen |= 1u << (value + 3);
+  }
+  wsCheck(inRange && seen == 0x7F);
+  wsCheck(rng.nextBelow(1) == 0 && rng.nextInt(5, 5) == 5);
+  f32 least = 1.0f, most = 0.0f;
+  for (u32 i = 0; i < WS_TEST_DRAWS; ++i) {
+    const f32 value = rng.nextFloat();
+    least = wsMin(least, value);
+    most = wsMax(most, value);
+  }
+  wsCheck(least >= 0.0f && most < 1.0f && least < 1.0e-5f && most > 1.0f - 1.0e-5f);
+}
+
+//  Number of values the two windows share
+u32 numShared(u32* a, u32* b, u32 count) {
+  std::sort(a, a + count);
+  std::sort(b, b + count);
+  u32 shared = 0;
+  for (u32 i = 0, j = 0; i < count && j < count;) {
+    if (a[i] == b[j]) { ++shared; ++i; ++j; }
+    else if (a[i] < b[j]) { ++i; }
+    else { ++j; }
+  }
+  return shared;
+}
+
+void testStreams() {
+  u32* original = wsNewArray(u32, WS_TEST_WINDOW);
+  u32* jumped = wsNewArray(u32, WS_TEST_WINDOW);
+  //  Random windows of 4096 numbers share one by chance about once in 256 tries
+  for (u32 longJump = 0; longJump <= 1; ++longJump) {
+    wsRandom a(3500), b(3500);
+    if (longJump) { b.longJump(); }
+    else { b.jump(); }
+    a.fill(original, WS_TEST_WINDOW);
+    b.fill(jumped, WS_TEST_WINDOW);
+    const u32 shared = numShared(original, jumped, WS_TEST_WINDOW);
+    printf("  after %s, the first %u numbers share %u with the original\n", longJump ? "longJump()" : "jump()",
+            WS_TEST_WINDOW, shared);
+    wsCheck(shared <= 1);
+  }
+  //  Each thread draws from its own stream
+  wsInitRandomizer((u64)35);
+  u32* windows[WS_TEST_THREADS];
+  std::thread threads[WS_TEST_THREADS];
+  for (u32 t = 0; t < WS_TEST_THREADS; ++t) {
+    windows[t] = wsNewArray(u32, WS_TEST_WINDOW);
+    threads[t] = std::thread([=]() { wsGetThreadRandom().fill(windows[t], WS_TEST_WINDOW); });
+  }
+  for (u32 t = 0; t < WS_TEST_THREADS; ++t) { threads[t].join(); }
+  u32 mostShared = 0;
+  for (u32 t = 1; t < WS_TEST_THREADS; ++t) {
+    memcpy(original, windows[0], sizeof(u32)*WS_TEST_WINDOW);
+    mostShared = wsMax(mostShared, numShared(original, windows[t], WS_TEST_WINDOW));
+  }
+  wsCheck(mostShared <= 1);
+}
+
+void testBulk() {
+  u32* bulk = wsNewArray(u32, WS_TEST_WINDOW);
+  f32* bulkFloats = wsNewArray(f32, WS_TEST_WINDOW);
+  i32* bulkInts = wsNewArray(i32, WS_TEST_WINDOW);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    bool matches = true;
+    //  Starting partway through the lanes, with a count that leaves a remainder
+    for (u32 skip = 0; skip < WS_RANDOM_LANES; skip += 3) {
+      const u32 count = WS_TEST_WINDOW - skip - 1;
+      wsRandom bulkStream(level*100 + skip), singleStream(level*100 + skip);
+      for (u32 i = 0; i < skip; ++i) { bulkStream.next(); singleStream.next(); }
+      bulkStream.fill(bulk, count);
+      bulkStream.fillFloats(bulkFloats, count, -2.0f, 3.0f);
+      bulkStream.fillInts(bulkInts, count, -10, 10);
+      for (u32 i = 0; i < count; ++i) { matches &= (bulk[i] == singleStream.next()); }
+      for (u32 i = 0; i < count; ++i) { matches &= (bulkFloats[i] == singleStream.nextFloat(-2.0f, 3.0f)); }
+      //  21 values leave so few to redraw that none come up in these draws
+      for (u32 i = 0; i < count; ++i) { matches &= (bulkInts[i] == singleStream.nextInt(-10, 10)); }
+      matches &= (bulkStream.next() == singleStream.next());
+    }
+    printf("  %s fills %s single draws\n", wsGetSIMDLevelName((wsSIMDLevel)level), matches ? "match" : "DIFFER from");
+    wsCheck(matches);
+  }
+}
+
+void benchmark() {
+  u32* dest = wsNewArray(u32, WS_BENCH_COUNT);
+  f32* floats = wsNewArray(f32, WS_BENCH_COUNT);
+  wsRandom rng(35000);
+  u32 sum = 0;
+  wsBenchmarkBegin();
+  for (u32 i = 0; i < WS_BENCH_COUNT; ++i) { sum += rng.next(); }
+  wsReportTime("next()", wsBenchmarkEnd(), WS_BENCH_COUNT);
+  wsBenchmarkBegin();
+  for (u32 i = 0; i < WS_BENCH_COUNT; ++i) { sum += rng.nextBelow(1000); }
+  wsReportTime("nextBelow(1000)", wsBenchmarkEnd(), WS_BENCH_COUNT);
+  wsBenchmarkBegin();
+  for (u32 i = 0; i < WS_BENCH_COUNT; ++i) { sum += wsRand(); }
+  wsReportTime("wsRand()", wsBenchmarkEnd(), WS_BENCH_COUNT);
+  //  Keeps the draws from being optimized away
+  wsCheck(sum != 0);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    char name[64];
+    wsBenchmarkBegin();
+    rng.fill(dest, WS_BENCH_COUNT);
+    snprintf(name, 64, "%s fill", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), WS_BENCH_COUNT);
+    wsBenchmarkBegin();
+    rng.fillFloats(floats, WS_BENCH_COUNT);
+    snprintf(name, 64, "%s fillFloats", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), WS_BENCH_COUNT);
+  }
+  wsBenchmarkBegin();
+  rng.jump();
+  wsReportTime("jump()", wsBenchmarkEnd(), 1);
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsDetectSIMD();
+  testReference();
+  testBounded();
+  testStreams();
+  testBulk();
+  benchmark();
+  wsMem.shutDown();
+  return wsTestResult("randomTest");
+}
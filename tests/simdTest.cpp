@@ -0,0 +1,296 @@
+/*
+ * simdTest.cpp
+ *
+ *    Checks the SIMD math against scalar references. vec4, mat4 and quat are compiled
+ *    for the build's instruction set, so their dot and cross products, normals, matrix
+ *    product and inverse, and quaternion product and rotation are each compared with
+ *    the same operation computed here in double precision. The kernels chosen at
+ *    runtime are run at every level wsSetSIMDLevel(...) supports, and compared with
+ *    the scalar level. Then times each operation, and each kernel at each level.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <cmath>
+
+#define WS_TEST_ELEMENTS 4096
+//  Largest error allowed, relative to the size of the operands
+#define WS_TEST_TOLERANCE 1.0e-5
+#define WS_BENCH_ROUNDS 200
+
+wsRandom rng(31);
+f64 maxError;
+
+void noteError(f64 got, f64 want, f64 scale) {
+  f64 error = fabs(got - want)/scale;
+  //  NaN counts as the largest error
+  if (!(error <= maxError)) { maxError = error; }
+}
+
+vec4 randomVec4() {
+  return vec4(rng.nextFloat(-10.0f, 10.0f), rng.nextFloat(-10.0f, 10.0f), rng.nextFloat(-10.0f, 10.0f),
+              rng.nextFloat(-10.0f, 10.0f));
+}
+
+quat randomQuat() {
+  return quat(rng.nextFloat(-1.0f, 1.0f), rng.nextFloat(-1.0f, 1.0f), rng.nextFloat(-1.0f, 1.0f),
+              rng.nextFloat(-1.0f, 1.0f)).normal();
+}
+
+//  Kept well away from singular, so its inverse is known to float precision
+mat4 randomMat4() {
+  mat4 my;
+  for (u32 i = 0; i < 16; ++i) { my.data[i] = rng.nextFloat(-1.0f, 1.0f) + ((i % 5 == 0) ? 4.0f : 0.0f); }
+  return my;
+}
+
+//  Inverts a row-major matrix by Gauss-Jordan elimination with partial pivoting
+void invertReference(f64* inv, const f32* src) {
+  f64 m[4][8];
+  for (u32 r = 0; r < 4; ++r) {
+    for (u32 c = 0; c < 4; ++c) {
+      m[r][c] = src[r*4+c];
+      m[r][c+4] = (r == c) ? 1.0 : 0.0;
+    }
+  }
+  for (u32 c = 0; c < 4; ++c) {
+    u32 pivot = c;
+    for (u32 r = c+1; r < 4; ++r) { if (fabs(m[r][c]) > fabs(m[pivot][c])) { pivot = r; } }
+    for (u32 k = 0; k < 8; ++k) { f64 t = m[c][k]; m[c][k] = m[pivot][k]; m[pivot][k] = t; }
+    f64 scale = 1.0/m[c][c];
+    for (u32 k = 0; k < 8; ++k) { m[c][k] *= scale; }
+    for (u32 r = 0; r < 4; ++r) {
+      if (r == c) { continue; }
+      f64 factor = m[r][c];
+      for (u32 k = 0; k < 8; ++k) { m[r][k] -= factor*m[c][k]; }
+    }
+  }
+  for (u32 r = 0; r < 4; ++r) {
+    for (u32 c = 0; c < 4; ++c) { inv[r*4+c] = m[r][c+4]; }
+  }
+}
+
+//  The Hamilton product, as quat::operator* orders it
+void multiplyReference(f64* dest, const quat& a, const quat& b) {
+  dest[0] = (f64)a.w*b.x + (f64)a.x*b.w + (f64)a.y*b.z - (f64)a.z*b.y;
+  dest[1] = (f64)a.w*b.y - (f64)a.x*b.z + (f64)a.y*b.w + (f64)a.z*b.x;
+  dest[2] = (f64)a.w*b.z + (f64)a.x*b.y - (f64)a.y*b.x + (f64)a.z*b.w;
+  dest[3] = (f64)a.w*b.w - (f64)a.x*b.x - (f64)a.y*b.y - (f64)a.z*b.z;
+}
+
+void testOperations(vec4* a, vec4* b, mat4* matsA, mat4* matsB, quat* quatsA, quat* quatsB, f32* angles) {
+  printf("  vec4, mat4 and quat compiled %s\n", (WS_SUPPORTS_SSE == WS_TRUE) ? "for SSE" : "as scalar code");
+  //  Dot and cross products, relative to the operands' magnitudes
+  maxError = 0.0;
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    f64 scale = sqrt((f64)a[i].x*a[i].x + (f64)a[i].y*a[i].y + (f64)a[i].z*a[i].z)*
+                sqrt((f64)b[i].x*b[i].x + (f64)b[i].y*b[i].y + (f64)b[i].z*b[i].z);
+    noteError(a[i].dotProduct(b[i]), (f64)a[i].x*b[i].x + (f64)a[i].y*b[i].y + (f64)a[i].z*b[i].z, scale);
+    vec4 cross = a[i].crossProduct(b[i]);
+    noteError(cross.x, (f64)a[i].y*b[i].z - (f64)a[i].z*b[i].y, scale);
+    noteError(cross.y, (f64)a[i].z*b[i].x - (f64)a[i].x*b[i].z, scale);
+    noteError(cross.z, (f64)a[i].x*b[i].y - (f64)a[i].y*b[i].x, scale);
+    noteError(cross.w, a[i].w, 1.0);
+  }
+  printf("    dot and cross products: largest relative error %g\n", maxError);
+  wsCheck(maxError < WS_TEST_TOLERANCE);
+  //  Normals, every component divided by the length of x, y and z
+  maxError = 0.0;
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    f64 length = sqrt((f64)a[i].x*a[i].x + (f64)a[i].y*a[i].y + (f64)a[i].z*a[i].z);
+    vec4 normal = a[i].normal();
+    vec4 normalized = a[i];
+    normalized.normalize();
+    for (u32 c = 0; c < 4; ++c) {
+      noteError(normal.array()[c], a[i].array()[c]/length, 1.0);
+      noteError(normalized.array()[c], a[i].array()[c]/length, 1.0);
+    }
+  }
+  printf("    normal and normalize: largest error %g\n", maxError);
+  wsCheck(maxError < WS_TEST_TOLERANCE);
+  //  Matrix products, and a row vector times a matrix
+  maxError = 0.0;
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    mat4 product = matsA[i]*matsB[i];
+    vec4 row = a[i]*matsB[i];
+    for (u32 r = 0; r < 4; ++r) {
+      for (u32 c = 0; c < 4; ++c) {
+        f64 want = 0.0, scale = 0.0;
+        for (u32 k = 0; k < 4; ++k) {
+          want += (f64)matsA[i].data[r*4+k]*matsB[i].data[k*4+c];
+          scale += fabs((f64)matsA[i].data[r*4+k]*matsB[i].data[k*4+c]);
+        }
+        noteError(product.data[r*4+c], want, scale);
+      }
+    }
+    for (u32 c = 0; c < 4; ++c) {
+      f64 want = 0.0, scale = 0.0;
+      for (u32 k = 0; k < 4; ++k) {
+        want += (f64)a[i].array()[k]*matsB[i].data[k*4+c];
+        scale += fabs((f64)a[i].array()[k]*matsB[i].data[k*4+c]);
+      }
+      noteError(row.array()[c], want, scale);
+    }
+  }
+  printf("    mat4 * mat4 and vec4 * mat4: largest relative error %g\n", maxError);
+  wsCheck(maxError < WS_TEST_TOLERANCE);
+  //  Inverses
+  maxError = 0.0;
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    mat4 inverse = matsA[i].inverse();
+    f64 want[16];
+    invertReference(want, matsA[i].data);
+    for (u32 e = 0; e < 16; ++e) { noteError(inverse.data[e], want[e], 1.0); }
+  }
+  printf("    mat4 inverse: largest error %g\n", maxError);
+  wsCheck(maxError < WS_TEST_TOLERANCE);
+  //  Quaternion products, and rotation by an axis and angle
+  maxError = 0.0;
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    quat product = quatsA[i]*quatsB[i];
+    f64 want[4];
+    multiplyReference(want, quatsA[i], quatsB[i]);
+    noteError(product.x, want[0], 1.0);
+    noteError(product.y, want[1], 1.0);
+    noteError(product.z, want[2], 1.0);
+    noteError(product.w, want[3], 1.0);
+    quat rotated = quatsA[i];
+    rotated.rotate(b[i], angles[i]);
+    //  About the unit axis through b, by an angle in degrees
+    f64 length = sqrt((f64)b[i].x*b[i].x + (f64)b[i].y*b[i].y + (f64)b[i].z*b[i].z);
+    f64 halfAngle = angles[i]*M_PI/360.0;
+    f64 s = sin(halfAngle)/length;
+    quat step((f32)(b[i].x*s), (f32)(b[i].y*s), (f32)(b[i].z*s), (f32)cos(halfAngle));
+    multiplyReference(want, quatsA[i], step);
+    noteError(rotated.x, want[0], 1.0);
+    noteError(rotated.y, want[1], 1.0);
+    noteError(rotated.z, want[2], 1.0);
+    noteError(rotated.w, want[3], 1.0);
+  }
+  printf("    quat product and rotate: largest error %g\n", maxError);
+  wsCheck(maxError < WS_TEST_TOLERANCE);
+}
+
+void testKernels(vec4* a, mat4* matsA, mat4* matsB) {
+  mat4* products = wsNewArray(mat4, WS_TEST_ELEMENTS);
+  mat4* scalarProducts = wsNewArray(mat4, WS_TEST_ELEMENTS);
+  vec4* transformed = wsNewArray(vec4, WS_TEST_ELEMENTS + 1);
+  vec4* scalarTransformed = wsNewArray(vec4, WS_TEST_ELEMENTS);
+  wsSetSIMDLevel(WS_SIMD_SCALAR);
+  wsMultiplyMat4Array(scalarProducts, matsA, matsB, WS_TEST_ELEMENTS);
+  wsTransformVec4Array(scalarTransformed, a, matsA[0], WS_TEST_ELEMENTS);
+  for (u32 level = 1; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    //  An odd count leaves a remainder for the wider kernels
+    const u32 count = WS_TEST_ELEMENTS - 3;
+    transformed[count] = vec4(-1.0f, -1.0f, -1.0f, -1.0f);
+    wsMultiplyMat4Array(products, matsA, matsB, count);
+    wsTransformVec4Array(transformed, a, matsA[0], count);
+    maxError = 0.0;
+    for (u32 i = 0; i < count; ++i) {
+      for (u32 e = 0; e < 16; ++e) { noteError(products[i].data[e], scalarProducts[i].data[e], 16.0); }
+      for (u32 c = 0; c < 4; ++c) { noteError(transformed[i].array()[c], scalarTransformed[i].array()[c], 16.0); }
+    }
+    printf("  %s kernels: largest relative error against scalar %g\n", wsGetSIMDLevelName((wsSIMDLevel)level),
+            maxError);
+    wsCheck(maxError < WS_TEST_TOLERANCE);
+    wsCheck(transformed[count].x == -1.0f && transformed[count].w == -1.0f);
+    //  In place, as the kernels allow
+    for (u32 i = 0; i < count; ++i) { products[i] = matsA[i]; }
+    wsMultiplyMat4Array(products, products, matsB, count);
+    bool inPlace = true;
+    for (u32 i = 0; i < count; ++i) {
+      for (u32 e = 0; e < 16; ++e) {
+        if (fabs(products[i].data[e] - scalarProducts[i].data[e]) > 16.0*WS_TEST_TOLERANCE) { inPlace = false; }
+      }
+    }
+    wsCheck(inPlace);
+  }
+}
+
+void benchmark(vec4* a, vec4* b, mat4* matsA, mat4* matsB, quat* quatsA, quat* quatsB, f32* angles) {
+  const u64 numOps = (u64)WS_BENCH_ROUNDS*WS_TEST_ELEMENTS;
+  vec4* vecs = wsNewArray(vec4, WS_TEST_ELEMENTS);
+  mat4* mats = wsNewArray(mat4, WS_TEST_ELEMENTS);
+  quat* quats = wsNewArray(quat, WS_TEST_ELEMENTS);
+  f32 sum = 0.0f;
+  #define WS_BENCH_OP(opName, op) \
+    wsBenchmarkBegin(); \
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { \
+      for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) { op; } \
+    } \
+    wsReportTime(opName, wsBenchmarkEnd(), numOps);
+  WS_BENCH_OP("dotProduct", sum += a[i].dotProduct(b[i]));
+  WS_BENCH_OP("crossProduct", vecs[i] = a[i].crossProduct(b[i]));
+  WS_BENCH_OP("normal", vecs[i] = a[i].normal());
+  WS_BENCH_OP("mat4 * mat4", mats[i] = matsA[i]*matsB[i]);
+  WS_BENCH_OP("vec4 * mat4", vecs[i] = a[i]*matsB[i]);
+  WS_BENCH_OP("mat4 inverse", mats[i] = matsA[i].inverse());
+  WS_BENCH_OP("quat * quat", quats[i] = quatsA[i]*quatsB[i]);
+  WS_BENCH_OP("quat rotate", quats[i] = quatsA[i]; quats[i].rotate(b[i], angles[i]));
+  #undef WS_BENCH_OP
+  //  Keeps the dot products from being optimized away
+  wsCheck(sum == sum);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    char name[64];
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { wsMultiplyMat4Array(mats, matsA, matsB, WS_TEST_ELEMENTS); }
+    snprintf(name, 64, "%s wsMultiplyMat4Array", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), numOps);
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { wsTransformVec4Array(vecs, a, matsA[0], WS_TEST_ELEMENTS); }
+    snprintf(name, 64, "%s wsTransformVec4Array", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), numOps);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsDetectSIMD();
+  vec4* a = wsNewArray(vec4, WS_TEST_ELEMENTS);
+  vec4* b = wsNewArray(vec4, WS_TEST_ELEMENTS);
+  mat4* matsA = wsNewArray(mat4, WS_TEST_ELEMENTS);
+  mat4* matsB = wsNewArray(mat4, WS_TEST_ELEMENTS);
+  quat* quatsA = wsNewArray(quat, WS_TEST_ELEMENTS);
+  quat* quatsB = wsNewArray(quat, WS_TEST_ELEMENTS);
+  f32* angles = wsNewArray(f32, WS_TEST_ELEMENTS);
+  for (u32 i = 0; i < WS_TEST_ELEMENTS; ++i) {
+    a[i] = randomVec4();
+    b[i] = randomVec4();
+    matsA[i] = randomMat4();
+    matsB[i] = randomMat4();
+    quatsA[i] = randomQuat();
+    quatsB[i] = randomQuat();
+    angles[i] = rng.nextFloat(-180.0f, 180.0f);
+  }
+  testOperations(a, b, matsA, matsB, quatsA, quatsB, angles);
+  testKernels(a, matsA, matsB);
+  benchmark(a, b, matsA, matsB, quatsA, quatsB, angles);
+  wsMem.shutDown();
+  return wsTestResult("simdTest");
+}
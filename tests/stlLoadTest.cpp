@@ -0,0 +1,177 @@
+/*
+ * stlLoadTest.cpp
+ *
+ *    Tests the STL loader on a torus written here as binary and as ASCII STL, with
+ *    each triangle's corners written on their own as exporters do. Welding must find
+ *    exactly the torus's grid of vertices, every triangle must survive, and the smooth
+ *    normals must match the surface's own. Then times loading a torus of a few
+ *    million triangles in each format, neither optimized nor simplified, so only the
+ *    reading, welding and normals are measured.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsMesh.h"
+#include "../whipstitch/wsGameFlow/wsThreadPool.h"
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+#define WS_TEST_BINARY_PATH "/tmp/stlLoadTest.stl"
+#define WS_TEST_ASCII_PATH "/tmp/stlLoadTestAscii.stl"
+#define WS_TEST_MAJOR_RADIUS 2.0f
+#define WS_TEST_MINOR_RADIUS 0.5f
+//  Smallest cosine allowed between a loaded normal and the surface's own
+#define WS_TEST_MIN_NORMAL_DOT 0.999f
+#define WS_BENCH_RINGS 1024
+#define WS_BENCH_SIDES 1024
+
+//  Corner (ring, side) of the torus, wrapped so the seam's corners are bitwise equal
+void torusPoint(f32* p, u32 ring, u32 side, u32 numRings, u32 numSides) {
+  f32 u = 2.0f*(f32)M_PI*(ring % numRings)/numRings;
+  f32 v = 2.0f*(f32)M_PI*(side % numSides)/numSides;
+  p[0] = (WS_TEST_MAJOR_RADIUS + WS_TEST_MINOR_RADIUS*cosf(v))*cosf(u);
+  p[1] = (WS_TEST_MAJOR_RADIUS + WS_TEST_MINOR_RADIUS*cosf(v))*sinf(u);
+  p[2] = WS_TEST_MINOR_RADIUS*sinf(v);
+}
+
+//  The three corners of each of a torus's triangles, wound to face outward
+void torusTriangle(f32* corners, u32 t, u32 numRings, u32 numSides) {
+  u32 quad = t/2, ring = quad/numSides, side = quad % numSides;
+  static const u32 offsets[2][3][2] = { { { 0, 0 }, { 1, 0 }, { 1, 1 } }, { { 0, 0 }, { 1, 1 }, { 0, 1 } } };
+  for (u32 c = 0; c < 3; ++c) {
+    torusPoint(&corners[c*3], ring + offsets[t & 1][c][0], side + offsets[t & 1][c][1], numRings, numSides);
+  }
+}
+
+bool writeTorus(const char* path, bool ascii, u32 numRings, u32 numSides) {
+  FILE* pFile = fopen(path, "wb");
+  if (pFile == WS_NULL) { return false; }
+  const u32 numTris = numRings*numSides*2;
+  f32 corners[9];
+  if (ascii) {
+    fprintf(pFile, "solid torus\n");
+    for (u32 t = 0; t < numTris; ++t) {
+      torusTriangle(corners, t, numRings, numSides);
+      //  Nine significant digits bring every float back exactly
+      fprintf(pFile, "facet normal 0 0 0\n outer loop\n");
+      for (u32 c = 0; c < 3; ++c) {
+        fprintf(pFile, "  vertex %.9g %.9g %.9g\n", corners[c*3], corners[c*3+1], corners[c*3+2]);
+      }
+      fprintf(pFile, " endloop\nendfacet\n");
+    }
+    fprintf(pFile, "endsolid torus\n");
+  }
+  else {
+    char header[80];
+    memset(header, 0, sizeof(header));
+    strcpy(header, "binary torus");
+    fwrite(header, sizeof(header), 1, pFile);
+    fwrite(&numTris, sizeof(u32), 1, pFile);
+    u8 record[50];
+    memset(record, 0, sizeof(record));
+    for (u32 t = 0; t < numTris; ++t) {
+      torusTriangle(corners, t, numRings, numSides);
+      memcpy(record + 12, corners, sizeof(corners));
+      fwrite(record, sizeof(record), 1, pFile);
+    }
+  }
+  return (fclose(pFile) == 0);
+}
+
+//  Checks a loaded torus's counts, and each normal against the surface's at its vertex
+void checkTorus(wsMesh* mesh, u32 numRings, u32 numSides) {
+  wsCheck(mesh->isLoaded());
+  wsCheck(mesh->getNumMaterials() == 1);
+  if (!mesh->isLoaded() || mesh->getNumMaterials() != 1) { return; }
+  wsCheck(mesh->getNumVerts() == numRings*numSides);
+  wsCheck(mesh->getMats()[0].numTriangles == numRings*numSides*2);
+  f32 minDot = 1.0f;
+  for (u32 v = 0; v < mesh->getNumVerts(); ++v) {
+    const wsVert& vert = mesh->getVerts()[v];
+    //  The nearest point on the circle through the middle of the tube
+    f32 ringLength = sqrtf(vert.pos.x*vert.pos.x + vert.pos.y*vert.pos.y);
+    vec4 center(vert.pos.x*WS_TEST_MAJOR_RADIUS/ringLength, vert.pos.y*WS_TEST_MAJOR_RADIUS/ringLength, 0.0f, 1.0f);
+    vec4 surface = (vert.pos - center)*(1.0f/WS_TEST_MINOR_RADIUS);
+    f32 dot = surface.x*vert.norm.x + surface.y*vert.norm.y + surface.z*vert.norm.z;
+    if (dot < minDot) { minDot = dot; }
+  }
+  wsCheck(minDot > WS_TEST_MIN_NORMAL_DOT);
+}
+
+void testSmallTorus() {
+  const u32 numRings = 48, numSides = 24;
+  for (u32 ascii = 0; ascii < 2; ++ascii) {
+    const char* path = ascii ? WS_TEST_ASCII_PATH : WS_TEST_BINARY_PATH;
+    wsCheck(writeTorus(path, ascii != 0, numRings, numSides));
+    wsMesh* mesh = wsNew(wsMesh, wsMesh(path, WS_MESH_FORMAT_STL, false, false));
+    checkTorus(mesh, numRings, numSides);
+    //  Optimizing keeps the same vertices and triangles
+    mesh->optimize();
+    checkTorus(mesh, numRings, numSides);
+    remove(path);
+  }
+  //  Neither a truncated binary file nor one of nothing loads
+  wsCheck(writeTorus(WS_TEST_BINARY_PATH, false, numRings, numSides));
+  wsCheck(truncate(WS_TEST_BINARY_PATH, 1000) == 0);
+  wsMesh* truncated = wsNew(wsMesh, wsMesh(WS_TEST_BINARY_PATH, WS_MESH_FORMAT_STL, false, false));
+  wsCheck(!truncated->isLoaded() && truncated->getNumVerts() == 0);
+  wsCheck(truncate(WS_TEST_BINARY_PATH, 0) == 0);
+  wsMesh* empty = wsNew(wsMesh, wsMesh(WS_TEST_BINARY_PATH, WS_MESH_FORMAT_STL, false, false));
+  wsCheck(!empty->isLoaded());
+  remove(WS_TEST_BINARY_PATH);
+}
+
+void benchmarkLoads() {
+  const u32 numTris = WS_BENCH_RINGS*WS_BENCH_SIDES*2;
+  for (u32 ascii = 0; ascii < 2; ++ascii) {
+    const char* path = ascii ? WS_TEST_ASCII_PATH : WS_TEST_BINARY_PATH;
+    wsCheck(writeTorus(path, ascii != 0, WS_BENCH_RINGS, WS_BENCH_SIDES));
+    //  Each load is freed with its tier, so the next has the same room
+    wsMem.setTier(wsMemoryStack::PRIMARY_FRONT);
+    wsBenchmarkBegin();
+    wsMesh* mesh = wsNew(wsMesh, wsMesh(path, WS_MESH_FORMAT_STL, false, false));
+    t64 seconds = wsBenchmarkEnd();
+    char name[64];
+    snprintf(name, 64, "%s STL, %u triangles, per triangle", ascii ? "ASCII" : "binary", numTris);
+    wsReportTime(name, seconds, numTris);
+    checkTorus(mesh, WS_BENCH_RINGS, WS_BENCH_SIDES);
+    wsMem.freePrimaryFront();
+    remove(path);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsThreads.startUp();
+  testSmallTorus();
+  printf("  Loading with the main thread and %u workers:\n", wsThreads.getNumThreads());
+  benchmarkLoads();
+  wsThreads.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("stlLoadTest");
+}
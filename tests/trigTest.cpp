@@ -0,0 +1,253 @@
+/*
+ * trigTest.cpp
+ *
+ *    Sweeps the input range of wsTrig's sine, cosine, tangent, arccosine, arcsine and
+ *    arctangent, in scalar, SSE and AVX2 lanes, and checks each largest error against
+ *    the bound documented in wsTrig.h. The exact values come from libm in double
+ *    precision. Then times each function against the libm float version.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include <cmath>
+
+#define WS_TEST_STEPS (1 << 21)
+#define WS_BENCH_ROUNDS 4
+#define WS_DEG_TO_RAD_64 (M_PI/180.0)
+
+f32* inputs;
+f32* inputsB;
+f32* outputs;
+f32* outputsB;
+
+//  The largest of |got - want| over count values
+f64 largestError(const f32* got, const f64* want, u32 count) {
+  f64 largest = 0.0;
+  for (u32 i = 0; i < count; ++i) {
+    f64 error = fabs((f64)got[i] - want[i]);
+    //  NaN counts as the largest error
+    if (!(error <= largest)) { largest = error; }
+  }
+  return largest;
+}
+
+/*  Lanes  */
+#if WS_SUPPORTS_SSE == WS_TRUE
+  void sseArcCos(f32* dest, const f32* src, u32 count) {
+    for (u32 i = 0; i < count; i += 4) { _mm_storeu_ps(dest + i, ws_sseArcCos(_mm_loadu_ps(src + i))); }
+  }
+  void sseArcTan(f32* dest, const f32* x, const f32* y, u32 count) {
+    for (u32 i = 0; i < count; i += 4) {
+      _mm_storeu_ps(dest + i, ws_sseArcTan(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+    }
+  }
+#endif
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+  WS_TARGET_AVX2
+  void avxArcCos(f32* dest, const f32* src, u32 count) {
+    for (u32 i = 0; i < count; i += 8) { _mm256_storeu_ps(dest + i, ws_avxArcCos(_mm256_loadu_ps(src + i))); }
+  }
+  WS_TARGET_AVX2
+  void avxArcTan(f32* dest, const f32* x, const f32* y, u32 count) {
+    for (u32 i = 0; i < count; i += 8) {
+      _mm256_storeu_ps(dest + i, ws_avxArcTan(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+  }
+#endif
+
+void scalarArcCos(f32* dest, const f32* src, u32 count) {
+  for (u32 i = 0; i < count; ++i) { dest[i] = wsArcCos(src[i]); }
+}
+
+void scalarArcTan(f32* dest, const f32* x, const f32* y, u32 count) {
+  for (u32 i = 0; i < count; ++i) { dest[i] = wsArcTan(x[i], y[i]); }
+}
+
+//  Runs the arccosine and arctangent of the given level over the inputs
+void arcCosAt(u32 level, f32* dest, const f32* src, u32 count) {
+  #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+    if (level == WS_SIMD_AVX2) { avxArcCos(dest, src, count); return; }
+  #endif
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    if (level == WS_SIMD_SSE2) { sseArcCos(dest, src, count); return; }
+  #endif
+  scalarArcCos(dest, src, count);
+}
+
+void arcTanAt(u32 level, f32* dest, const f32* x, const f32* y, u32 count) {
+  #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+    if (level == WS_SIMD_AVX2) { avxArcTan(dest, x, y, count); return; }
+  #endif
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    if (level == WS_SIMD_SSE2) { sseArcTan(dest, x, y, count); return; }
+  #endif
+  scalarArcTan(dest, x, y, count);
+}
+
+/*  Accuracy  */
+void testSinCos(f64* want, f64* wantB) {
+  //  Evenly over the documented range, so every quadrant is reduced many times
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    inputs[i] = -WS_SINCOS_RANGE + (2.0f*WS_SINCOS_RANGE)*((f32)i/(WS_TEST_STEPS-1));
+    want[i] = sin(inputs[i]*WS_DEG_TO_RAD_64);
+    wantB[i] = cos(inputs[i]*WS_DEG_TO_RAD_64);
+  }
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) { wsSinCos(inputs[i], outputs + i, outputsB + i); }
+  f64 sinError = largestError(outputs, want, WS_TEST_STEPS);
+  f64 cosError = largestError(outputsB, wantB, WS_TEST_STEPS);
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    outputs[i] = wsSin(inputs[i]);
+    outputsB[i] = wsCos(inputs[i]);
+  }
+  sinError = fmax(sinError, largestError(outputs, want, WS_TEST_STEPS));
+  cosError = fmax(cosError, largestError(outputsB, wantB, WS_TEST_STEPS));
+  printf("  scalar sine %.3g, cosine %.3g (bound %.3g)\n", sinError, cosError, WS_SINCOS_MAX_ERROR);
+  wsCheck(sinError <= WS_SINCOS_MAX_ERROR && cosError <= WS_SINCOS_MAX_ERROR);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    wsBatchSinCos(outputs, outputsB, inputs, WS_TEST_STEPS);
+    sinError = largestError(outputs, want, WS_TEST_STEPS);
+    cosError = largestError(outputsB, wantB, WS_TEST_STEPS);
+    printf("  %s wsBatchSinCos: sine %.3g, cosine %.3g\n", wsGetSIMDLevelName((wsSIMDLevel)level), sinError,
+            cosError);
+    wsCheck(sinError <= WS_SINCOS_MAX_ERROR && cosError <= WS_SINCOS_MAX_ERROR);
+  }
+  //  Tangent, relative to its size, which grows without bound near the poles
+  f64 tanError = 0.0;
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    f64 exact = tan(inputs[i]*WS_DEG_TO_RAD_64);
+    if (fabs(exact) > WS_TAN_RANGE) { continue; }
+    f64 error = fabs(wsTan(inputs[i]) - exact)/fmax(fabs(exact), 1.0);
+    if (!(error <= tanError)) { tanError = error; }
+  }
+  printf("  scalar tangent %.3g relative, where |tan| <= %g (bound %.3g)\n", tanError, WS_TAN_RANGE,
+          WS_TAN_MAX_ERROR);
+  wsCheck(tanError <= WS_TAN_MAX_ERROR);
+}
+
+void testArcCos(f64* want, f64* wantB) {
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    inputs[i] = -1.0f + 2.0f*((f32)i/(WS_TEST_STEPS-1));
+    want[i] = acos((f64)inputs[i])/WS_DEG_TO_RAD_64;
+    wantB[i] = asin((f64)inputs[i])/WS_DEG_TO_RAD_64;
+  }
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) { outputsB[i] = wsArcSin(inputs[i]); }
+  f64 sinError = largestError(outputsB, wantB, WS_TEST_STEPS);
+  printf("  scalar arcsine %.3g degrees (bound %.3g)\n", sinError, WS_ARCCOS_MAX_ERROR);
+  wsCheck(sinError <= WS_ARCCOS_MAX_ERROR);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    arcCosAt(level, outputs, inputs, WS_TEST_STEPS);
+    f64 error = largestError(outputs, want, WS_TEST_STEPS);
+    printf("  %s arccosine %.3g degrees (bound %.3g)\n", wsGetSIMDLevelName((wsSIMDLevel)level), error,
+            WS_ARCCOS_MAX_ERROR);
+    wsCheck(error <= WS_ARCCOS_MAX_ERROR);
+  }
+  //  Clamped outside [-1, 1]
+  wsCheck(wsArcCos(1.5f) == 0.0f && fabs(wsArcCos(-1.5f) - 180.0f) <= WS_ARCCOS_MAX_ERROR);
+}
+
+void testArcTan(f64* want) {
+  //  Points all the way around the circle, at lengths from tiny to huge
+  wsRandom rng(33);
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    f64 angle = -M_PI + 2.0*M_PI*((f64)i/(WS_TEST_STEPS-1));
+    f64 length = pow(10.0, rng.nextFloat(-10.0f, 10.0f));
+    inputs[i] = (f32)(sin(angle)*length);
+    inputsB[i] = (f32)(cos(angle)*length);
+    want[i] = atan2((f64)inputs[i], (f64)inputsB[i])/WS_DEG_TO_RAD_64;
+  }
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    arcTanAt(level, outputs, inputs, inputsB, WS_TEST_STEPS);
+    f64 error = largestError(outputs, want, WS_TEST_STEPS);
+    printf("  %s arctangent %.3g degrees (bound %.3g)\n", wsGetSIMDLevelName((wsSIMDLevel)level), error,
+            WS_ARCTAN_MAX_ERROR);
+    wsCheck(error <= WS_ARCTAN_MAX_ERROR);
+  }
+  //  Axes and signed zeros follow atan2
+  wsCheck(wsArcTan(0.0f, 1.0f) == 0.0f && wsArcTan(1.0f, 0.0f) == 90.0f);
+  wsCheck(signbit(wsArcTan(-0.0f, 1.0f)) && fabs(wsArcTan(0.0f, -1.0f) - 180.0f) <= WS_ARCTAN_MAX_ERROR);
+  wsCheck(fabs(wsArcTan(-0.0f, -1.0f) + 180.0f) <= WS_ARCTAN_MAX_ERROR);
+}
+
+/*  Throughput  */
+void benchmark() {
+  const u64 numOps = (u64)WS_BENCH_ROUNDS*WS_TEST_STEPS;
+  wsRandom rng(330);
+  for (u32 i = 0; i < WS_TEST_STEPS; ++i) {
+    inputs[i] = rng.nextFloat(-360.0f, 360.0f);
+    inputsB[i] = rng.nextFloat(-1.0f, 1.0f);
+  }
+  f32 sum = 0.0f;
+  #define WS_BENCH_OP(opName, op) \
+    wsBenchmarkBegin(); \
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { \
+      for (u32 i = 0; i < WS_TEST_STEPS; ++i) { op; } \
+    } \
+    wsReportTime(opName, wsBenchmarkEnd(), numOps);
+  WS_BENCH_OP("wsSin", sum += wsSin(inputs[i]));
+  WS_BENCH_OP("libm sinf", sum += sinf(inputs[i]*DEG_TO_RAD));
+  WS_BENCH_OP("wsSinCos", wsSinCos(inputs[i], outputs + i, outputsB + i));
+  WS_BENCH_OP("libm sinf and cosf", outputs[i] = sinf(inputs[i]*DEG_TO_RAD); outputsB[i] = cosf(inputs[i]*DEG_TO_RAD));
+  WS_BENCH_OP("wsTan", sum += wsTan(inputs[i]));
+  WS_BENCH_OP("libm tanf", sum += tanf(inputs[i]*DEG_TO_RAD));
+  WS_BENCH_OP("wsArcCos", sum += wsArcCos(inputsB[i]));
+  WS_BENCH_OP("libm acosf", sum += acosf(inputsB[i])*RAD_TO_DEG);
+  WS_BENCH_OP("wsArcTan", sum += wsArcTan(inputsB[i], inputs[i]));
+  WS_BENCH_OP("libm atan2f", sum += atan2f(inputsB[i], inputs[i])*RAD_TO_DEG);
+  #undef WS_BENCH_OP
+  //  Keeps the sums from being optimized away
+  wsCheck(sum == sum);
+  for (u32 level = 0; level <= (u32)wsGetMaxSIMDLevel(); ++level) {
+    wsSetSIMDLevel((wsSIMDLevel)level);
+    char name[64];
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { wsBatchSinCos(outputs, outputsB, inputs, WS_TEST_STEPS); }
+    snprintf(name, 64, "%s wsBatchSinCos", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), numOps);
+    wsBenchmarkBegin();
+    for (u32 r = 0; r < WS_BENCH_ROUNDS; ++r) { arcCosAt(level, outputs, inputsB, WS_TEST_STEPS); }
+    snprintf(name, 64, "%s arccosine lanes", wsGetSIMDLevelName((wsSIMDLevel)level));
+    wsReportTime(name, wsBenchmarkEnd(), numOps);
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsDetectSIMD();
+  inputs = wsNewArray(f32, WS_TEST_STEPS);
+  inputsB = wsNewArray(f32, WS_TEST_STEPS);
+  outputs = wsNewArray(f32, WS_TEST_STEPS);
+  outputsB = wsNewArray(f32, WS_TEST_STEPS);
+  f64* want = wsNewArray(f64, WS_TEST_STEPS);
+  f64* wantB = wsNewArray(f64, WS_TEST_STEPS);
+  testSinCos(want, wantB);
+  testArcCos(want, wantB);
+  testArcTan(want);
+  benchmark();
+  wsMem.shutDown();
+  return wsTestResult("trigTest");
+}
@@ -0,0 +1,221 @@
+/*
+ * vertexCacheTest.cpp
+ *
+ *    Checks the mesh optimizer against a vertex cache simulated here, independently of
+ *    wsComputeACMR(...). The simulated FIFO cache must agree with the ACMR the optimizer
+ *    reports, and the optimized order must keep every triangle and its winding while
+ *    missing the cache less, on a shuffled grid and on the shipped models as exported.
+ *    Also checks that welding merges only identical vertices, and that the fetch order
+ *    gives each vertex the next position as it is first used.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTest.h"
+#include "../whipstitch/wsAssets/wsMeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#define WS_TEST_GRID 64
+//  Largest ACMR an optimized model of at least WS_TEST_MIN_TRIANGLES may have
+#define WS_TEST_MAX_ACMR 0.8
+#define WS_TEST_MIN_TRIANGLES 1000
+
+//  Draws the indices through a FIFO cache of the given size and returns the average
+//  number of misses per triangle
+f64 simulateFIFO(const u32* indices, u32 numIndices, u32 cacheSize) {
+  std::vector<u32> cache;
+  u32 numMisses = 0;
+  for (u32 i = 0; i < numIndices; ++i) {
+    if (std::find(cache.begin(), cache.end(), indices[i]) == cache.end()) {
+      ++numMisses;
+      cache.push_back(indices[i]);
+      if (cache.size() > cacheSize) { cache.erase(cache.begin()); }
+    }
+  }
+  return (numIndices >= 3) ? (f64)numMisses/(numIndices/3) : 0.0;
+}
+
+//  Each triangle rotated to start at its smallest index, which keeps its winding, then
+//  the list sorted, so two orders of the same triangles compare equal
+std::vector<u32> canonicalTriangles(const u32* indices, u32 numIndices) {
+  std::vector<std::vector<u32> > tris;
+  for (u32 t = 0; t < numIndices/3; ++t) {
+    const u32* tri = &indices[t*3];
+    u32 first = (tri[1] < tri[0]) ? 1 : 0;
+    if (tri[2] < tri[first]) { first = 2; }
+    std::vector<u32> rotated(3);
+    for (u32 c = 0; c < 3; ++c) { rotated[c] = tri[(first + c) % 3]; }
+    tris.push_back(rotated);
+  }
+  std::sort(tris.begin(), tris.end());
+  std::vector<u32> flat;
+  for (u32 t = 0; t < tris.size(); ++t) { flat.insert(flat.end(), tris[t].begin(), tris[t].end()); }
+  return flat;
+}
+
+//  A grid of quads, two triangles each, in a random order
+std::vector<u32> makeShuffledGrid(wsRandom& random) {
+  std::vector<u32> indices;
+  for (u32 y = 0; y < WS_TEST_GRID; ++y) {
+    for (u32 x = 0; x < WS_TEST_GRID; ++x) {
+      u32 corner = y*(WS_TEST_GRID + 1) + x;
+      u32 quad[6] = { corner, corner + 1, corner + WS_TEST_GRID + 2,
+                      corner, corner + WS_TEST_GRID + 2, corner + WS_TEST_GRID + 1 };
+      indices.insert(indices.end(), quad, quad + 6);
+    }
+  }
+  u32 numTris = (u32)indices.size()/3;
+  for (u32 t = numTris - 1; t > 0; --t) {
+    u32 other = random.nextBelow(t + 1);
+    for (u32 c = 0; c < 3; ++c) { std::swap(indices[t*3 + c], indices[other*3 + c]); }
+  }
+  return indices;
+}
+
+void testGrid() {
+  wsRandom random(40);
+  std::vector<u32> shuffled = makeShuffledGrid(random);
+  u32 numIndices = (u32)shuffled.size();
+  u32 numVerts = (WS_TEST_GRID + 1)*(WS_TEST_GRID + 1);
+  std::vector<u32> optimized(numIndices);
+  wsOptimizeVertexCache(&optimized[0], &shuffled[0], numIndices, numVerts);
+  f64 before = simulateFIFO(&shuffled[0], numIndices, WS_ACMR_CACHE_SIZE);
+  f64 after = simulateFIFO(&optimized[0], numIndices, WS_ACMR_CACHE_SIZE);
+  printf("  %ux%u grid, shuffled: FIFO %u ACMR %.3f -> %.3f\n", WS_TEST_GRID, WS_TEST_GRID,
+          WS_ACMR_CACHE_SIZE, before, after);
+  //  The simulator here and the optimizer's own measure agree, for several cache sizes
+  const u32 cacheSizes[] = { 4, 16, 32 };
+  for (u32 s = 0; s < 3; ++s) {
+    wsCheck(fabs(wsComputeACMR(&shuffled[0], numIndices, numVerts, cacheSizes[s]) -
+                  simulateFIFO(&shuffled[0], numIndices, cacheSizes[s])) < 1.0e-4);
+    wsCheck(fabs(wsComputeACMR(&optimized[0], numIndices, numVerts, cacheSizes[s]) -
+                  simulateFIFO(&optimized[0], numIndices, cacheSizes[s])) < 1.0e-4);
+  }
+  wsCheck(canonicalTriangles(&optimized[0], numIndices) == canonicalTriangles(&shuffled[0], numIndices));
+  //  A shuffled grid transforms nearly every corner; an optimized one about one vertex per triangle
+  wsCheck(before > 2.0);
+  wsCheck(after < 0.9);
+
+  //  The fetch order numbers the vertices as they are first used
+  std::vector<u32> remap(numVerts, WS_NO_VERTEX);
+  u32 numAssigned = wsOptimizeVertexFetch(&remap[0], 0, &optimized[0], numIndices);
+  wsCheck(numAssigned == numVerts);
+  u32 nextNew = 0;
+  bool inOrder = true;
+  for (u32 i = 0; i < numIndices; ++i) {
+    u32 position = remap[optimized[i]];
+    if (position > nextNew) { inOrder = false; }
+    if (position == nextNew) { ++nextNew; }
+  }
+  wsCheck(inOrder);
+  wsCheck(nextNew == numVerts);
+}
+
+void testWeld() {
+  //  Four vertices, two of them identical, and one differing only in its UV
+  wsVert* verts = wsNewArray(wsVert, 4);
+  for (u32 v = 0; v < 4; ++v) { memset((void*)&verts[v], 0, sizeof(wsVert)); }
+  verts[0].pos = vec4(1.0f, 2.0f, 3.0f, 1.0f);
+  verts[1] = verts[0];
+  verts[2] = verts[0];
+  verts[2].tex[0] = 0.5f;
+  verts[3].pos = vec4(-1.0f, 0.0f, 0.0f, 1.0f);
+  u32 remap[4];
+  wsCheck(wsWeldVertices(verts, 4, remap) == 3);
+  wsCheck(remap[0] == remap[1]);
+  wsCheck(remap[0] != remap[2]);
+  wsCheck(remap[2] != remap[3] && remap[0] != remap[3]);
+  wsCheck(verts[remap[2]].tex[0] == 0.5f);
+  wsCheck(verts[remap[3]].pos.x == -1.0f);
+}
+
+void testModels() {
+  const char* models[] = { "models/Griswald.wsMesh", "models/bladeWand.wsMesh", "models/blueBox.wsMesh" };
+  for (u32 f = 0; f < 3; ++f) {
+    //  Read in the order it was exported, neither optimized nor simplified
+    wsMesh* mesh = wsNew(wsMesh, wsMesh(models[f], WS_MESH_FORMAT_WHIPSTITCH, false, false));
+    //  Each triangle's corners by value, to compare across the renumbering of the vertices
+    std::vector<std::vector<f32> > cornersBefore, cornersAfter;
+    f64 missesBefore = 0.0, missesAfter = 0.0;
+    u32 numTris = 0;
+    u32 numVertsBefore = mesh->getNumVerts();
+    for (u32 pass = 0; pass < 2; ++pass) {
+      if (pass == 1) { mesh->optimize(); }
+      std::vector<std::vector<f32> >& corners = pass ? cornersAfter : cornersBefore;
+      bool inRange = true;
+      for (u32 m = 0; m < mesh->getNumMaterials(); ++m) {
+        const wsMaterial& mat = mesh->getMats()[m];
+        const u32* indices = (const u32*)mat.tris;
+        f64 misses = simulateFIFO(indices, mat.numTriangles*3, WS_ACMR_CACHE_SIZE)*mat.numTriangles;
+        if (pass) { missesAfter += misses; } else { missesBefore += misses; numTris += mat.numTriangles; }
+        for (u32 t = 0; t < mat.numTriangles; ++t) {
+          std::vector<f32> tri;
+          for (u32 c = 0; c < 3; ++c) {
+            u32 v = mat.tris[t].vertIndices[c];
+            if (v >= mesh->getNumVerts()) { inRange = false; continue; }
+            const wsVert& vert = mesh->getVerts()[v];
+            f32 values[9] = { vert.pos.x, vert.pos.y, vert.pos.z, vert.norm.x, vert.norm.y, vert.norm.z,
+                              vert.tex[0], vert.tex[1], (f32)m };
+            tri.insert(tri.end(), values, values + 9);
+          }
+          //  Rotated to start at its smallest corner, keeping its winding
+          std::vector<f32> best = tri;
+          for (u32 r = 1; r < 3 && tri.size() == 27; ++r) {
+            std::vector<f32> rotated(tri.begin() + r*9, tri.end());
+            rotated.insert(rotated.end(), tri.begin(), tri.begin() + r*9);
+            if (rotated < best) { best = rotated; }
+          }
+          corners.push_back(best);
+        }
+      }
+      wsCheck(inRange);
+    }
+    std::sort(cornersBefore.begin(), cornersBefore.end());
+    std::sort(cornersAfter.begin(), cornersAfter.end());
+    printf("  %s: %u triangles, vertices %u -> %u, FIFO %u ACMR %.3f -> %.3f\n", models[f], numTris,
+            numVertsBefore, mesh->getNumVerts(), WS_ACMR_CACHE_SIZE, missesBefore/numTris, missesAfter/numTris);
+    wsCheck(cornersBefore == cornersAfter);
+    //  The exporter writes each corner as its own vertex, so welding must find shared ones
+    wsCheck(mesh->getNumVerts() < numVertsBefore);
+    wsCheck(missesAfter < missesBefore);
+    //  A box has too few triangles to share many vertices; it need only improve
+    if (numTris >= WS_TEST_MIN_TRIANGLES) { wsCheck(missesAfter/numTris < WS_TEST_MAX_ACMR); }
+  }
+}
+
+int main() {
+  wsActiveLogs = WS_LOG_ERROR;
+  wsBuildCRC32HashTable();
+  wsMem.startUp(256*wsMB, wsMB);
+  wsVFS.startUp();
+  testGrid();
+  testWeld();
+  testModels();
+  wsVFS.shutDown();
+  wsMem.shutDown();
+  return wsTestResult("vertexCacheTest");
+}
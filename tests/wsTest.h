@@ -0,0 +1,75 @@
+/*
+ * wsTest.h
+ *
+ *    This file declares the few helpers the engine's tests share. Each test is a
+ *    small program: it checks what it must with wsCheck(...), times what it measures
+ *    with wsBenchmarkBegin() and wsBenchmarkEnd(), and returns wsTestResult(...) from
+ *    main, which is nonzero if any check failed. Tests run in release mode, so
+ *    wsAssert(...) does nothing there; wsCheck(...) always runs.
+ *
+ *    Usage:
+ *      wsCheck(queue->pop(item));
+ *      wsReportTime("emplace", wsBenchmarkEnd(), numItems);
+ *      return wsTestResult("containerTest");
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_TEST_H_
+#define WS_TEST_H_
+
+#include "../whipstitch/wsUtils.h"
+#include <cstdio>
+
+//  Counts a check, and prints the expression and where it is if it fails
+#define wsCheck(expr) wsCheckAt((expr), #expr, __FILE__, __LINE__)
+
+static u32 wsNumChecks = 0;
+static u32 wsNumFailures = 0;
+
+inline bool wsCheckAt(bool passed, const char* expr, const char* file, u32 line) {
+  ++wsNumChecks;
+  if (!passed) {
+    ++wsNumFailures;
+    printf("  FAILED: %s (%s:%u)\n", expr, file, line);
+  }
+  return passed;
+}
+
+//  Prints the time taken per operation, for count operations in the given seconds
+inline void wsReportTime(const char* name, t64 seconds, u64 count) {
+  printf("  %-48s %10.2f ns/op  (%.3f ms)\n", name, seconds*1.0e9/(count ? count : 1), seconds*1000.0);
+}
+
+//  Prints the outcome of the test; returns the exit code for main
+inline int wsTestResult(const char* name) {
+  if (wsNumFailures) {
+    printf("%s: %u of %u checks FAILED\n", name, wsNumFailures, wsNumChecks);
+    return 1;
+  }
+  printf("%s: all %u checks passed\n", name, wsNumChecks);
+  return 0;
+}
+
+#endif /* WS_TEST_H_ */
@@ -0,0 +1,115 @@
+//  textureCooker.cpp
+//  D. Scott Nettleton
+/*
+ *  This is the offline texture cooker for the Whipstitch Game Engine. It writes a
+ *  .wsTex file beside each image it is given, holding the image's full mip chain,
+ *  flipped and ready for upload. Directories are cooked image by image, and images
+ *  whose cooked files are already up to date are skipped.
+ *
+ *    textureCooker [-rgb | -rgba | -bc1 | -bc3 | -bc5] [-fast | -high] [-linear] [-f] <image or directory>...
+ *
+ *  Without a format option each image keeps its own channels, uncompressed. -fast and
+ *  -high choose the block compressor's quality preset. -linear marks the images as
+ *  linear data, such as normal maps, whose levels skip gamma correction; BC5 always
+ *  does. -f cooks every image, up to date or not.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "whipstitch/wsGraphics/wsTextureFile.h"
+#include "whipstitch/wsGameFlow/wsThreadPool.h"
+#include "whipstitch/wsUtils/wsLog.h"
+#include "whipstitch/wsUtils/wsMemoryStack.h"
+#include <stdio.h>
+#include <string.h>
+
+//  Image types SOIL can decode
+bool isImage(const wsPath& path) {
+  const char* extensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".dds" };
+  std::string extension = path.extension().string();
+  for (u32 i = 0; i < sizeof(extensions)/sizeof(extensions[0]); ++i) {
+    if (strcasecmp(extension.c_str(), extensions[i]) == 0) { return true; }
+  }
+  return false;
+}
+
+//  Returns false if the image needed cooking and could not be cooked
+bool cook(const wsPath& path, u32 format, u32 quality, bool linear, bool force) {
+  char cookedPath[WS_MAX_ASSET_PATH];
+  if (!wsCookedTexturePath(cookedPath, path.string().c_str(), WS_MAX_ASSET_PATH)) {
+    wsEcho(WS_LOG_ERROR, "Image path \"%s\" is too long to cook.", path.string().c_str());
+    return false;
+  }
+  if (!force && wsFile::exists(cookedPath) && wsFile::last_write_time(cookedPath) >= wsFile::last_write_time(path)) {
+    return true;
+  }
+  if (!wsCookTexture(path.string().c_str(), cookedPath, format, quality, linear)) { return false; }
+  wsEcho(WS_LOG_MAIN, "Cooked \"%s\"", cookedPath);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  u32 format = WS_TEXTURE_FORMAT_SOURCE;
+  u32 quality = WS_COMPRESS_NORMAL;
+  bool linear = false;
+  bool force = false;
+  u32 numFailed = 0;
+  u32 numPaths = 0;
+  wsActiveLogs = WS_LOG_MAIN | WS_LOG_ERROR;
+  //  The thread pool compresses each level's rows of blocks in parallel
+  wsMem.startUp(16*wsMB, wsMB);
+  wsThreads.startUp();
+  for (i32 a = 1; a < argc; ++a) {
+    if (strcmp(argv[a], "-rgb") == 0) { format = WS_TEXTURE_FORMAT_RGB8; }
+    else if (strcmp(argv[a], "-rgba") == 0) { format = WS_TEXTURE_FORMAT_RGBA8; }
+    else if (strcmp(argv[a], "-bc1") == 0) { format = WS_TEXTURE_FORMAT_BC1; }
+    else if (strcmp(argv[a], "-bc3") == 0) { format = WS_TEXTURE_FORMAT_BC3; }
+    else if (strcmp(argv[a], "-bc5") == 0) { format = WS_TEXTURE_FORMAT_BC5; }
+    else if (strcmp(argv[a], "-fast") == 0) { quality = WS_COMPRESS_FAST; }
+    else if (strcmp(argv[a], "-high") == 0) { quality = WS_COMPRESS_HIGH; }
+    else if (strcmp(argv[a], "-linear") == 0) { linear = true; }
+    else if (strcmp(argv[a], "-f") == 0) { force = true; }
+    else {
+      wsPath path(argv[a]);
+      ++numPaths;
+      if (wsFile::is_directory(path)) {
+        for (wsFile::directory_iterator it(path), end; it != end; ++it) {
+          if (wsFile::is_regular_file(it->path()) && isImage(it->path())) {
+            numFailed += !cook(it->path(), format, quality, linear, force);
+          }
+        }
+      }
+      else {
+        numFailed += !cook(path, format, quality, linear, force);
+      }
+    }
+  }
+  wsThreads.shutDown();
+  wsMem.shutDown();
+  if (numPaths == 0) {
+    printf("Usage: %s [-rgb | -rgba | -bc1 | -bc3 | -bc5] [-fast | -high] [-linear] [-f] <image or directory>...\n", argv[0]);
+    return 1;
+  }
+  return (numFailed > 0) ? 1 : 0;
+}
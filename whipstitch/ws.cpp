@@ -106,22 +106,26 @@ void wsInit(const char* title, const i32 width, const i32 height, bool fullscree
   wsAssert((WS_BIT_ENVIRONMENT == 32 || WS_BIT_ENVIRONMENT == 64),
           "Only 32-bit and 64-bit systems are supported.");
   wsEcho((WS_LOG_MAIN | WS_LOG_PLATFORM), "Environment: %u bits\n", WS_BIT_ENVIRONMENT);
-  if (WS_SUPPORTS_SSE4) {
-    wsEcho(WS_LOG_PLATFORM, "Supports SSE4\n");
+  if (WS_SUPPORTS_SSE) {
+    wsEcho(WS_LOG_PLATFORM, "Math types built with SSE%s\n", (WS_SUPPORTS_SSE4) ? "4.1" : "2");
   }
   else {
-    wsEcho(WS_LOG_PLATFORM, "Does not support SSE4\n");
+    wsEcho(WS_LOG_PLATFORM, "Math types built without SIMD\n");
   }
+  wsDetectSIMD();
   wsEcho(WS_LOG_PLATFORM, "Number of Processor Cores: %u\n", WS_NUM_CORES);
-  wsEcho(WS_LOG_UTIL, "Generating Lookup Tables, Initializing Random Number Generator\n");
+  wsEcho(WS_LOG_UTIL, "Building Hash Tables, Initializing Random Number Generator\n");
   wsBenchmarkBegin();
-  genLookupTables();
   wsBuildCRC32HashTable();
   wsInitRandomizer( wsGetTime() );
   wsEcho(WS_LOG_UTIL, "Benchmarked at: %f\n", wsBenchmarkEnd());
 
   /*  Begin Starting Up Engine Subsystems  */
   wsMem.startUp(mainMem, frameStackMem);
+  wsNames.startUp();
+  wsVFS.startUp();
+  if (wsFile::exists(WS_DEFAULT_PAK)) { wsVFS.mount(WS_DEFAULT_PAK); }
+  if (wsVFS.exists(WS_DEFAULT_MANIFEST)) { wsVFS.loadManifest(WS_DEFAULT_MANIFEST); }
 #ifdef _PROFILE
   wsProfiles.startUp(53);
 #endif
@@ -131,6 +135,8 @@ void wsInit(const char* title, const i32 width, const i32 height, bool fullscree
   wsScreens.startUp(title, width, height, fullscreen);
   wsRenderer.startUp();
   wsSounds.startUp();
+  wsRegistry.startUp();
+  wsLoader.startUp();
   wsEvents.startUp();
   wsInputs.startUp();
   wsLoop.startUp();
@@ -149,6 +155,8 @@ void wsQuit() {
   wsLoop.shutDown();
   wsInputs.shutDown();
   wsEvents.shutDown();
+  wsLoader.shutDown();
+  wsRegistry.shutDown();
   wsSounds.shutDown();
   wsRenderer.shutDown();
   wsScreens.shutDown();
@@ -156,6 +164,8 @@ void wsQuit() {
 #ifdef _PROFILE
   wsProfiles.shutDown();
 #endif
+  wsVFS.shutDown();
+  wsNames.shutDown();
   wsMem.shutDown();
   wsEcho(WS_LOG_MAIN, "Whipstitch Engine Shut Down Successfully. G'Bye.");
 }
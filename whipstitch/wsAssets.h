@@ -36,9 +36,13 @@
 
 #include "wsAssets/wsAnimation.h"
 #include "wsAssets/wsAsset.h"
+#include "wsAssets/wsAssetRegistry.h"
 #include "wsAssets/wsButton.h"
+#include "wsAssets/wsCookedAsset.h"
 #include "wsAssets/wsFont.h"
 #include "wsAssets/wsMesh.h"
+#include "wsAssets/wsMeshOptimizer.h"
+#include "wsAssets/wsMeshSimplifier.h"
 #include "wsAssets/wsModel.h"
 #include "wsAssets/wsPanel.h"
 #include "wsAssets/wsPanelElement.h"
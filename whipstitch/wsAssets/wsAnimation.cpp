@@ -33,84 +33,241 @@
 */
  
 #include "wsAnimation.h"
-#include <stdio.h>
+#include "wsCookedAsset.h"
 #include "../wsGraphics.h"
+#include "../wsGameFlow/wsThreadPool.h"
+#include "../wsUtils/wsMappedFile.h"
+#include "../wsUtils/wsTokenizer.h"
+#include "../wsUtils/wsVirtualFS.h"
 
-wsAnimation::wsAnimation(const char* filepath) {
+//  Bytes taken by each block of a cooked animation
+static void wsCookedAnimSizes(u64* sizes, const wsCookedAnimHeader& header) {
+  sizes[WS_ANIM_BLOCK_JOINTS] = sizeof(wsAnimJoint)*(u64)header.numJoints;
+  sizes[WS_ANIM_BLOCK_KEYFRAMES] = sizeof(wsCookedKeyframe)*(u64)header.numKeyframes;
+  sizes[WS_ANIM_BLOCK_MODS] = sizeof(wsJointMod)*(u64)header.numMods;
+}
+
+//  Copies at most size-1 characters of a name, and its terminator, into a zeroed field
+static void wsCopyName(char* dest, const char* src, u32 size) {
+  const size_t length = strnlen(src, size-1);
+  memcpy(dest, src, length);
+  dest[length] = '\0';
+}
+
+wsAnimation::wsAnimation(const char* filepath, const bool useCooked) {
   assetType = WS_ASSET_TYPE_ANIM;
+  keyframes = WS_NULL;
+  loaded = true;
+  if (useCooked && loadCooked(filepath)) { return; }
+  if (!loadWhipstitch(filepath)) { clear(); }
+}// End wsAnimation constructor
+
+void wsAnimation::clear() {
+  name[0] = '\0';
+  bounds = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+  joints = WS_NULL;
+  keyframes = WS_NULL;
+  numJoints = 0;
+  numKeyframes = 0;
+  animLength = 0.0f;
+  loaded = false;
+}
+
+wsAnimation::~wsAnimation() {
+  //  A cooked file is unmapped along with the animation
+}
+
+bool wsAnimation::loadCooked(const char* filepath) {
+  //  Once unmapped, the animation is mapped again into the table it built the first time
+  const bool remapping = (keyframes != WS_NULL);
+  char cookedPath[WS_MAX_ASSET_PATH];
+  if (!wsVFS.findCurrentCooked(cookedPath, filepath, WS_ANIM_EXTENSION, WS_MAX_ASSET_PATH) || !cooked.open(cookedPath)) {
+    return false;
+  }
+  const char* data = cooked.getData();
+  const wsCookedAnimHeader* header = (const wsCookedAnimHeader*)data;
+  bool valid = (cooked.getSize() >= sizeof(wsCookedAnimHeader) && ((size_t)data & (WS_COOKED_ALIGNMENT-1)) == 0 &&
+                header->magic == WS_ANIM_MAGIC && header->version == WS_COOKED_VERSION &&
+                memchr(header->name, '\0', sizeof(header->name)) != WS_NULL);
+  if (valid) {
+    u64 sizes[WS_ANIM_NUM_BLOCKS];
+    wsCookedAnimSizes(sizes, *header);
+    valid = wsCookedBlocksFit(header->blocks, sizes, WS_ANIM_NUM_BLOCKS, cooked.getSize());
+  }
+  //  Every keyframe's modifiers must lie within the block
+  const wsCookedKeyframe* cookedFrames = valid ? (const wsCookedKeyframe*)(data + header->blocks[WS_ANIM_BLOCK_KEYFRAMES].offset) : WS_NULL;
+  for (u32 k = 0; valid && k < header->numKeyframes; ++k) {
+    valid = (cookedFrames[k].firstMod <= header->numMods &&
+              cookedFrames[k].numJointsModified <= header->numMods - cookedFrames[k].firstMod);
+  }
+  if (!valid) {
+    wsEcho(WS_LOG_ERROR, "Cooked animation \"%s\" is truncated, corrupt or of an unsupported version.", cookedPath);
+    cooked.close();
+    return false;
+  }
+  if (remapping && (header->numJoints != numJoints || header->numKeyframes != numKeyframes)) {
+    wsEcho(WS_LOG_GRAPHICS, "Cooked animation \"%s\" has changed since it was first mapped.", cookedPath);
+    cooked.close();
+    return false;
+  }
+  strcpy(name, header->name);
+  animType = header->animType;
+  numJoints = header->numJoints;
+  numKeyframes = header->numKeyframes;
+  framesPerSecond = header->framesPerSecond;
+  bounds = header->bounds;
+  //  The joints and modifiers are used where they lie; nothing may write through them
+  joints = (wsAnimJoint*)(data + header->blocks[WS_ANIM_BLOCK_JOINTS].offset);
+  wsJointMod* mods = (wsJointMod*)(data + header->blocks[WS_ANIM_BLOCK_MODS].offset);
+  if (!remapping) { keyframes = wsNewArray(wsKeyframe, numKeyframes); }
+  for (u32 k = 0; k < numKeyframes; ++k) {
+    keyframes[k].frameIndex = cookedFrames[k].frameIndex;
+    keyframes[k].numJointsModified = cookedFrames[k].numJointsModified;
+    keyframes[k].mods = &mods[cookedFrames[k].firstMod];
+  }
+  if (numKeyframes) { animLength = keyframes[numKeyframes-1].frameIndex / framesPerSecond; }
+  wsEcho(WS_LOG_GRAPHICS, "Mapped cooked animation \"%s\": %u joints, %u keyframes\n", cookedPath, numJoints, numKeyframes);
+  return true;
+}
+
+bool wsAnimation::remap(const char* filepath) {
+  wsAssert((keyframes != WS_NULL && joints == WS_NULL), "Only an unmapped animation can be mapped again.");
+  return loadCooked(filepath);
+}
+
+void wsAnimation::unmap() {
+  wsAssert(isCooked(), "Only a cooked animation can be unmapped.");
+  cooked.close();
+  //  Nothing may point into the old mapping
+  joints = WS_NULL;
+  for (u32 k = 0; k < numKeyframes; ++k) { keyframes[k].mods = WS_NULL; }
+}
+
+bool wsAnimation::loadWhipstitch(const char* filepath) {
   wsEcho(WS_LOG_GRAPHICS, "Loading Animation from file \"%s\"\n", filepath);
-  FILE* pFile;
-  pFile = fopen(filepath, "r");
-  wsAssert( pFile, "Error Loading file." );
+  wsMappedFile file;
+  if (!file.open(filepath)) {
+    wsEcho(WS_LOG_ERROR, "Error: could not open animation file \"%s\"", filepath);
+    return false;
+  }
+  wsTokenizer tok(file.getData(), file.getEnd());
   //  Scan past the header
-  errorCheck( fscanf( pFile,  "//  Whipstitch Animation File\n//  This Animation is for use with the Whipstitch Game Engine\n"
-                              "//  For more information, email dsnettleton@whipstitchgames.com\n\n") );
+  tok.expect( "//  Whipstitch Animation File\n//  This Animation is for use with the Whipstitch Game Engine\n"
+              "//  For more information, email dsnettleton@whipstitchgames.com\n\n");
   f32 versionNumber;
-  errorCheck( fscanf( pFile, "versionNumber %f\n", &versionNumber) );
-  errorCheck( fscanf( pFile, "animationType %u\n", &animType) );
+  tok.expect("versionNumber"); tok.readF32(versionNumber);
+  tok.expect("animationType"); tok.readU32(animType);
   char nameBuffer[256];
-  errorCheck( fscanf( pFile, "animationName %[^\t\n]\n", nameBuffer) );
-  errorCheck( fscanf( pFile, "framesPerSecond %f\n\n", &framesPerSecond) );
-  errorCheck( fscanf( pFile, "numJoints %u\n", &numJoints) );
-  errorCheck( fscanf( pFile, "numKeyFrames %u\n", &numKeyframes) );
-  errorCheck( fscanf( pFile, "bounds { %f %f %f }\n\n", &bounds.x, &bounds.y, &bounds.z) );
+  tok.expect("animationName "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+  tok.expect("framesPerSecond"); tok.readF32(framesPerSecond);
+  tok.expect("numJoints"); tok.readU32(numJoints);
+  tok.expect("numKeyFrames"); tok.readU32(numKeyframes);
+  tok.expect("bounds {"); tok.readF32s(&bounds.x, 3); tok.expect("}");
+  //  A truncated header leaves the counts unread
+  if (tok.hasFailed()) {
+    wsEcho(WS_LOG_ERROR, "Error: could not parse animation file \"%s\"", filepath);
+    return false;
+  }
   //  Generate object arrays and place them on the current stack
   joints = wsNewArray(wsAnimJoint, numJoints);
   keyframes = wsNewArray(wsKeyframe, numKeyframes);
   strcpy(name, nameBuffer);
-  errorCheck( fscanf( pFile, "joints {\n") );
+  tok.expect("joints {");
   u32 jointIndex = 0;
-  for (u32 j = 0; j < numJoints; ++j) {
-    errorCheck( fscanf( pFile, "  joint %u {\n", &jointIndex) );
+  for (u32 j = 0; j < numJoints && !tok.hasFailed(); ++j) {
+    tok.expect("joint"); tok.readU32(jointIndex); tok.expect("{");
     wsAssert( (jointIndex == j), "Current index does not relate to current joint.");
-    errorCheck( fscanf( pFile, "    jointName %[^\t\n]\n", joints[j].name) );
-    errorCheck( fscanf( pFile, "    parent %d\n", &joints[j].parent) );
-    errorCheck( fscanf( pFile, "    pos_start { %f %f %f }\n", &joints[j].start.x, &joints[j].start.y, &joints[j].start.z) );
-    errorCheck( fscanf( pFile, "    rotation { %f %f %f %f }\n", &joints[j].rot.x, &joints[j].rot.y, &joints[j].rot.z, &joints[j].rot.w) );
-    errorCheck( fscanf( pFile, "  }\n") );
+    tok.expect("jointName "); tok.readLine(joints[j].name, sizeof(joints[j].name));
+    tok.expect("parent"); tok.readI32(joints[j].parent);
+    tok.expect("pos_start {"); tok.readF32s(&joints[j].start.x, 3); tok.expect("}");
+    joints[j].start.w = 1.0f;
+    tok.expect("rotation {"); tok.readF32s(&joints[j].rot.x, 4); tok.expect("}");
+    tok.expect("}");
   }// End for each joint
-  errorCheck( fscanf( pFile, "}\n\n") );
-  errorCheck( fscanf( pFile, "keyframes {\n") );
+  tok.expect("}");
+  tok.expect("keyframes {");
+  //  Read each keyframe's header and allocate its joint modifiers here, since the
+  //  memory stack is not thread-safe, then parse the modifiers on the thread pool.
+  wsSmallArray<const char*, 32> modsBegin;
+  wsSmallArray<const char*, 32> modsEnd;
   u32 frameIndex = 0;
-  for (u32 k = 0; k < numKeyframes; ++k) {
-    errorCheck( fscanf( pFile, "  keyframe %u {\n", &frameIndex) );
+  for (u32 k = 0; k < numKeyframes && !tok.hasFailed(); ++k) {
+    tok.expect("keyframe"); tok.readU32(frameIndex); tok.expect("{");
     wsAssert( (frameIndex == k), "Current index does not relate to current keyframe.");
-    errorCheck( fscanf( pFile, "    frameNumber %f\n", &keyframes[k].frameIndex) );
-    // errorCheck( fscanf( pFile, "    bounds {\n") );
-    // errorCheck( fscanf( pFile, "      min { %f %f %f }\n", &keyframes[k].minX, &keyframes[k].minY, &keyframes[k].minZ) );
-    // errorCheck( fscanf( pFile, "      max { %f %f %f }\n", &keyframes[k].maxX, &keyframes[k].maxY, &keyframes[k].maxZ) );
-    // errorCheck( fscanf( pFile, "    }\n") );
-    errorCheck( fscanf( pFile, "    jointsModified %u\n", &keyframes[k].numJointsModified) );
+    tok.expect("frameNumber"); tok.readF32(keyframes[k].frameIndex);
+    tok.expect("jointsModified"); tok.readU32(keyframes[k].numJointsModified);
     keyframes[k].mods = wsNewArray(wsJointMod, keyframes[k].numJointsModified);
-    for (u32 j = 0; j < keyframes[k].numJointsModified; ++j) {
-      errorCheck( fscanf( pFile, "    joint %u {\n", &keyframes[k].mods[j].jointIndex) );
-      errorCheck( fscanf( pFile, "      jointTranslation { %f %f %f }\n",
-        &keyframes[k].mods[j].location.x,
-        &keyframes[k].mods[j].location.y,
-        &keyframes[k].mods[j].location.z) );
-      keyframes[k].mods[j].location.w = 1.0f;
-      errorCheck( fscanf( pFile, "      jointRotation { %f %f %f %f }\n",
-        &keyframes[k].mods[j].rotation.x,
-        &keyframes[k].mods[j].rotation.y,
-        &keyframes[k].mods[j].rotation.z,
-        &keyframes[k].mods[j].rotation.w) );
-      errorCheck( fscanf( pFile, "    }\n") );
-    }// End for each joint modifier
-    errorCheck( fscanf( pFile, "  }\n") );
+    modsBegin.push(tok.getPos());
+    tok.setPos(tok.findLine(tok.getPos(), "keyframe "));
+    modsEnd.push(tok.getPos());
   }
-  errorCheck( fscanf( pFile, "}\n") );
-  if (numKeyframes) { animLength = keyframes[numKeyframes-1].frameIndex / framesPerSecond; }
-  if (fclose(pFile) == EOF) {
-    wsEcho(WS_LOG_ERROR, "Failed to close animation file \"%s\"", filepath);
+  std::atomic<bool> modsFailed(tok.hasFailed());
+  wsRunParallelChunks(modsBegin.getLength(), 1, [&](u32 first, u32 last) {
+    for (u32 k = first; k < last; ++k) {
+      wsTokenizer chunk(modsBegin[k], modsEnd[k]);
+      wsJointMod* mods = keyframes[k].mods;
+      for (u32 j = 0; j < keyframes[k].numJointsModified && !chunk.hasFailed(); ++j) {
+        chunk.expect("joint"); chunk.readU32(mods[j].jointIndex); chunk.expect("{");
+        chunk.expect("jointTranslation {"); chunk.readF32s(&mods[j].location.x, 3); chunk.expect("}");
+        mods[j].location.w = 1.0f;
+        chunk.expect("jointRotation {"); chunk.readF32s(&mods[j].rotation.x, 4); chunk.expect("}");
+        chunk.expect("}");
+      }// End for each joint modifier
+      chunk.expect("}");
+      if (chunk.hasFailed()) { modsFailed = true; }
+    }
+  });
+  if (modsFailed || numKeyframes == 0) {
+    wsEcho(WS_LOG_ERROR, "Error: could not parse animation file \"%s\"", filepath);
+    return false;
   }
-}// End wsAnimation constructor
-
-wsAnimation::~wsAnimation() {
-    //  Nothing to do here.
+  animLength = keyframes[numKeyframes-1].frameIndex / framesPerSecond;
+  return true;
 }
 
-void wsAnimation::errorCheck(const i32 my) {
-  if (my == EOF) {
-    wsEcho(WS_LOG_ERROR, "Error: premature end of file.");
+bool wsAnimation::writeCooked(const char* destPath) const {
+  wsCookedAnimHeader header;
+  memset((void*)&header, 0, sizeof(header));
+  header.magic = WS_ANIM_MAGIC;
+  header.version = WS_COOKED_VERSION;
+  header.animType = animType;
+  header.numJoints = numJoints;
+  header.numKeyframes = numKeyframes;
+  header.framesPerSecond = framesPerSecond;
+  header.bounds = bounds;
+  wsCopyName(header.name, name, sizeof(header.name));
+  for (u32 k = 0; k < numKeyframes; ++k) { header.numMods += keyframes[k].numJointsModified; }
+  u64 sizes[WS_ANIM_NUM_BLOCKS];
+  wsCookedAnimSizes(sizes, header);
+  wsCookedLayout(header.blocks, sizes, WS_ANIM_NUM_BLOCKS, sizeof(header));
+  //  Copied field by field into zeroed blocks, so padding never carries stray bytes and
+  //  the same animation always cooks to the same file
+  void* blockData[WS_ANIM_NUM_BLOCKS];
+  for (u32 b = 0; b < WS_ANIM_NUM_BLOCKS; ++b) {
+    blockData[b] = calloc(sizes[b] ? sizes[b] : 1, 1);
+    wsAssert(blockData[b], "Could not allocate a block of the cooked animation.");
+  }
+  wsAnimJoint* outJoints = (wsAnimJoint*)blockData[WS_ANIM_BLOCK_JOINTS];
+  for (u32 j = 0; j < numJoints; ++j) {
+    wsCopyName(outJoints[j].name, joints[j].name, sizeof(outJoints[j].name));
+    outJoints[j].parent = joints[j].parent;
+    outJoints[j].start = joints[j].start;
+    outJoints[j].rot = joints[j].rot;
+  }
+  wsCookedKeyframe* outFrames = (wsCookedKeyframe*)blockData[WS_ANIM_BLOCK_KEYFRAMES];
+  wsJointMod* outMods = (wsJointMod*)blockData[WS_ANIM_BLOCK_MODS];
+  u32 numMods = 0;
+  for (u32 k = 0; k < numKeyframes; ++k) {
+    outFrames[k].frameIndex = keyframes[k].frameIndex;
+    outFrames[k].numJointsModified = keyframes[k].numJointsModified;
+    outFrames[k].firstMod = numMods;
+    for (u32 j = 0; j < keyframes[k].numJointsModified; ++j, ++numMods) {
+      outMods[numMods].jointIndex = keyframes[k].mods[j].jointIndex;
+      outMods[numMods].location = keyframes[k].mods[j].location;
+      outMods[numMods].rotation = keyframes[k].mods[j].rotation;
+    }
   }
+  bool written = wsWriteCooked(destPath, &header, sizeof(header), header.blocks, blockData, WS_ANIM_NUM_BLOCKS);
+  for (u32 b = 0; b < WS_ANIM_NUM_BLOCKS; ++b) { free(blockData[b]); }
+  return written;
 }
@@ -37,6 +37,7 @@
 
 #include "../wsConfig.h"
 #include "wsAsset.h"
+#include "../wsUtils/wsMappedFile.h"
 
 struct wsAnimJoint {
     char name[127];
@@ -57,8 +58,11 @@ struct wsKeyframe {
     wsJointMod* mods;
 };
 
+//  An animation loaded from a cooked .wsAnimBin points into the file's shared mapping
+//  for its joints and joint modifiers; only the keyframe table is built on the stack.
 class wsAnimation: public wsAsset {
     private:
+        wsMappedFile cooked;
         char name[256];
         vec4 bounds;
         wsAnimJoint* joints;
@@ -68,9 +72,18 @@ class wsAnimation: public wsAsset {
         u32 numKeyframes;
         f32 framesPerSecond;
         t32 animLength;
+        bool loaded;
+        //  Leaves the animation with no joints or keyframes, after a file which could not be loaded
+        void clear();
+        //  Maps the animation's cooked file, returning false if there is none up to date
+        bool loadCooked(const char* filepath);
+        //  Returns false, after logging why, if the file is missing or malformed
+        bool loadWhipstitch(const char* filepath);
     public:
         //  Constructor
-        wsAnimation(const char* filepath);
+        //  The cooked file is used in place of a .wsAnim when useCooked is set and one is
+        //  up to date.
+        wsAnimation(const char* filepath, const bool useCooked = WS_USE_COOKED_ASSETS);
         ~wsAnimation();
         //  Getters
         const t32 getAnimLength() { return animLength; }
@@ -79,11 +92,25 @@ class wsAnimation: public wsAsset {
         const wsAnimJoint* getJoints() { return joints; }
         const wsKeyframe* getKeyframes() { return keyframes; }
         const u32 getLength() const { return keyframes[numKeyframes-1].frameIndex; }
+        //  Memory unmap() gives back; an animation which lies in a mounted pack owns none of it
+        u64 getMappedBytes() const { return cooked.isView() ? 0 : cooked.getSize(); }
         const char* getName() const { return name; }
         const u32 getNumJoints() const { return numJoints; }
         const u32 getNumKeyframes() const { return numKeyframes; }
+        //  True if the animation's data lies in a cooked file's read-only mapping
+        bool isCooked() const { return cooked.isOpen(); }
+        //  False if its file was missing or malformed, leaving it empty
+        bool isLoaded() const { return loaded; }
         //  Operational Methods
-        void errorCheck(const i32 my);
+        //  Maps an unmapped animation's cooked file again, into the keyframe table built
+        //  when it was first loaded. Returns false, leaving it unmapped, if the file has
+        //  changed shape since.
+        bool remap(const char* filepath);
+        //  Gives back a cooked animation's mapping, keeping its keyframe table. Its joints
+        //  and joint modifiers are WS_NULL until remap(...).
+        void unmap();
+        //  Writes the animation to a cooked .wsAnimBin
+        bool writeCooked(const char* destPath) const;
 };
 
 #endif
@@ -40,6 +40,10 @@
 #define WS_ASSET_TYPE_ANIM  0x0002
 #define WS_ASSET_TYPE_MODEL 0x0003
 #define WS_ASSET_TYPE_FONT  0x0004
+#define WS_ASSET_TYPE_TEXTURE 0x0005
+#define WS_ASSET_TYPE_SOUND 0x0006
+#define WS_ASSET_TYPE_SHADER 0x0007
+#define WS_NUM_ASSET_TYPES  0x0008  //  One more than the largest type
 
 class wsAsset {
     private:
@@ -0,0 +1,572 @@
+/*
+ * wsAssetRegistry.cpp
+ *
+ *    This file implements the class wsAssetRegistry.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsAssetRegistry.h"
+#include "../wsAudio/wsSound.h"
+#include "../wsGraphics/wsRenderSystem.h"
+#include "../wsGraphics/wsShader.h"
+#include <string.h>
+
+wsAssetRegistry wsRegistry;
+
+//  References carry the slot in the low 16 bits and its generation above them
+inline wsAssetRef wsMakeAssetRef(u32 slot, u32 generation) {
+  return ((generation & 0xFFFF) << 16) | (slot + 1);
+}
+
+inline u32 wsAssetSlot(wsAssetRef ref) {
+  return (ref & 0xFFFF) - 1;
+}
+
+//  Writes the path in one canonical form: forward slashes, no repeated slashes, and
+//  no "." or "dir/.." components. Returns false if it does not fit in size bytes.
+static bool wsNormalizePath(char* dest, const char* path, u32 size) {
+  u32 length = 0;
+  bool absolute = (path[0] == '/' || path[0] == '\\');
+  if (absolute) { dest[length++] = '/'; }
+  const u32 base = length;  //  Nothing before this may be removed
+  const char* p = path;
+  while (*p) {
+    while (*p == '/' || *p == '\\') { ++p; }
+    const char* part = p;
+    while (*p && *p != '/' && *p != '\\') { ++p; }
+    u32 partLength = (u32)(p - part);
+    if (partLength == 0 || (partLength == 1 && part[0] == '.')) { continue; }
+    if (partLength == 2 && part[0] == '.' && part[1] == '.') {
+      if (length > base) {
+        u32 prev = length;
+        while (prev > base && dest[prev-1] != '/') { --prev; }
+        //  A leading ".." of a relative path cannot be undone
+        if (!(length - prev == 2 && dest[prev] == '.' && dest[prev+1] == '.')) {
+          length = (prev > base) ? prev - 1 : base;
+          continue;
+        }
+      }
+      else if (absolute) { continue; }  //  Nothing lies above the root
+    }
+    if (length + 1 + partLength >= size) { return false; }
+    if (length > base) { dest[length++] = '/'; }
+    memcpy(dest + length, part, partLength);
+    length += partLength;
+  }
+  dest[length] = '\0';
+  return true;
+}
+
+void wsAssetRegistry::startUp(u32 myMaxAssets) {
+  wsAssert((myMaxAssets > 0 && myMaxAssets < 0xFFFF), "The asset registry needs between 1 and 65534 entries.");
+  maxAssets = myMaxAssets;
+  entries = wsNewArray(wsRegistryEntry, maxAssets);
+  freeSlots = wsNew(wsStack<u32>, wsStack<u32>(maxAssets));
+  //  Pushed in reverse, so the first slots are used first
+  for (u32 i = maxAssets; i > 0; --i) {
+    entries[i-1].type = WS_NULL;
+    entries[i-1].generation = 0;
+    entries[i-1].resident = false;
+    freeSlots->push(i-1);
+  }
+  paths = wsNew(wsHashMap<wsAssetRef>, wsHashMap<wsAssetRef>(wsNextPrime(maxAssets)));
+  contents = wsNew(wsHashMap<wsAssetRef>, wsHashMap<wsAssetRef>(wsNextPrime(maxAssets)));
+  memset(budgets, 0, sizeof(budgets));
+  numUses = 0;
+  bytesLoaded = bytesSaved = 0;
+  numLoaded = numShared = numDeduplicated = 0;
+  _mInitialized = true;
+}
+
+void wsAssetRegistry::shutDown() {
+  printStats();
+  _mInitialized = false;
+}
+
+wsRegistryEntry* wsAssetRegistry::getEntry(wsAssetRef ref, u32 type) {
+  wsAssert(_mInitialized, "The asset registry must be initialized via the startUp() method before use.");
+  u32 slot = wsAssetSlot(ref);
+  if (ref == WS_NULL || slot >= maxAssets) { return WS_NULL; }
+  wsRegistryEntry* entry = &entries[slot];
+  if (entry->type == WS_NULL || (entry->generation & 0xFFFF) != (ref >> 16) || (type && entry->type != type)) {
+    return WS_NULL;
+  }
+  return entry;
+}
+
+void wsAssetRegistry::use(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  entry->lastUsed = ++numUses;
+  if (entry->resident) { ++budgets[entry->type].hits; }
+  else { restore(slot); }
+}
+
+wsRegistryEntry* wsAssetRegistry::useEntry(wsAssetRef ref, u32 type) {
+  wsRegistryEntry* entry = getEntry(ref, type);
+  if (entry != WS_NULL) { use(wsAssetSlot(ref)); }
+  return entry;
+}
+
+wsAnimation* wsAssetRegistry::getAnimation(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_ANIM);
+  return (entry == WS_NULL) ? WS_NULL : (wsAnimation*)entry->asset;
+}
+
+wsFont* wsAssetRegistry::getFont(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_FONT);
+  return (entry == WS_NULL) ? WS_NULL : (wsFont*)entry->asset;
+}
+
+wsMesh* wsAssetRegistry::getMesh(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_MESH);
+  return (entry == WS_NULL) ? WS_NULL : (wsMesh*)entry->asset;
+}
+
+wsShader* wsAssetRegistry::getShader(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_SHADER);
+  return (entry == WS_NULL) ? WS_NULL : (wsShader*)entry->asset;
+}
+
+wsSound* wsAssetRegistry::getSound(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_SOUND);
+  return (entry == WS_NULL) ? WS_NULL : (wsSound*)entry->asset;
+}
+
+u32 wsAssetRegistry::getTexture(wsAssetRef ref) {
+  wsRegistryEntry* entry = useEntry(ref, WS_ASSET_TYPE_TEXTURE);
+  return (entry == WS_NULL) ? 0 : entry->texture;
+}
+
+u32 wsAssetRegistry::getRefCount(wsAssetRef ref) {
+  wsRegistryEntry* entry = getEntry(ref, WS_NULL);
+  return (entry == WS_NULL) ? 0 : entry->refCount;
+}
+
+bool wsAssetRegistry::isResident(wsAssetRef ref) {
+  wsRegistryEntry* entry = getEntry(ref, WS_NULL);
+  return (entry != WS_NULL && entry->resident);
+}
+
+void wsAssetRegistry::setBudget(u32 type, u64 maxCPUBytes, u64 maxGPUBytes) {
+  wsAssert((type > 0 && type < WS_NUM_ASSET_TYPES), "Cannot budget an unknown type of asset.");
+  budgets[type].maxCPUBytes = maxCPUBytes;
+  budgets[type].maxGPUBytes = maxGPUBytes;
+  enforceBudget(type, maxAssets);
+}
+
+wsAssetRef wsAssetRegistry::acquire(wsAssetRef ref) {
+  wsRegistryEntry* entry = getEntry(ref, WS_NULL);
+  wsAssert(entry, "Cannot acquire an asset which is not loaded.");
+  ++entry->refCount;
+  return ref;
+}
+
+u32 wsAssetRegistry::release(wsAssetRef ref) {
+  wsRegistryEntry* entry = getEntry(ref, WS_NULL);
+  wsAssert((entry && entry->refCount > 0), "Cannot release an asset which holds no references.");
+  if (--entry->refCount > 0) { return entry->refCount; }
+  //  It may now be evicted, if its type went over budget while it was in use
+  enforceBudget(entry->type, maxAssets);
+  return 0;
+}
+
+wsAssetRef wsAssetRegistry::lookUp(u32 type, u32 params, const char* filepath, const char* secondPath, u32* newSlot) {
+  wsAssert(_mInitialized, "The asset registry must be initialized via the startUp() method before use.");
+  *newSlot = maxAssets;
+  char path[WS_MAX_ASSET_PATH], path2[WS_MAX_ASSET_PATH];
+  if (!wsNormalizePath(path, filepath, WS_MAX_ASSET_PATH) ||
+      (secondPath != WS_NULL && !wsNormalizePath(path2, secondPath, WS_MAX_ASSET_PATH))) {
+    wsEcho(WS_LOG_ERROR, "Asset file path \"%s\" is too long.", filepath);
+    return WS_NULL;
+  }
+  //  The renderer keeps one texture per file, whatever it was loaded with, so two
+  //  entries for one texture would delete it from under each other
+  const bool anyParams = (type == WS_ASSET_TYPE_TEXTURE);
+  const u32 kind = wsHashCombine(type, anyParams ? 0 : params);
+  u32 pathKey = wsHashCombine(wsHash(path), kind);
+  if (secondPath != WS_NULL) { pathKey = wsHashCombine(pathKey, wsHash(path2)); }
+  //  The same path again. The key is only a hash, so the path and settings are compared
+  //  as well. Neither a program's second file nor a path which shares another's asset is
+  //  kept, so those are confirmed by their contents below.
+  wsAssetRef* known = paths->find(pathKey);
+  wsRegistryEntry* entry = (known == WS_NULL) ? WS_NULL : getEntry(*known, type);
+  if (entry != WS_NULL && secondPath == WS_NULL && strcmp(entry->path, path) == 0 &&
+      (anyParams || entry->params == params)) {
+    if (entry->params != params) {
+      wsEcho(WS_LOG_UTIL, "Asset file \"%s\" is already loaded with other settings, which are kept\n", path);
+    }
+    ++entry->refCount;
+    ++numShared;
+    bytesSaved += entry->numBytes;
+    use(wsAssetSlot(*known));
+    return *known;
+  }
+  //  A new path; its contents decide whether it is a new asset
+  wsMappedFile file, file2;
+  if (!file.open(path) || (secondPath != WS_NULL && !file2.open(path2))) { return WS_NULL; }
+  u64 numBytes = file.getSize();
+  u32 contentKey = wsHashCombine(wsHashBuffer(file.getData(), file.getSize()), kind);
+  if (secondPath != WS_NULL) {
+    numBytes += file2.getSize();
+    contentKey = wsHashCombine(contentKey, wsHashBuffer(file2.getData(), file2.getSize()));
+  }
+  known = contents->find(contentKey);
+  wsRegistryEntry* original = (known == WS_NULL) ? WS_NULL : getEntry(*known, type);
+  //  The sizes and settings guard against a hash collision
+  if (original != WS_NULL && original->numBytes == numBytes && (anyParams || original->params == params)) {
+    wsEcho(WS_LOG_UTIL, "Asset file \"%s\" has the same contents as \"%s\"\n", path, original->path);
+    if (original->params != params) {
+      wsEcho(WS_LOG_UTIL, "Asset file \"%s\" is already loaded with other settings, which are kept\n", original->path);
+    }
+    ++original->refCount;
+    ++numDeduplicated;
+    bytesSaved += numBytes;
+    paths->replace(pathKey, *known);
+    use(wsAssetSlot(*known));
+    return *known;
+  }
+  u32 slot;
+  if (!freeSlots->pop(slot)) {
+    wsEcho(WS_LOG_ERROR, "The asset registry is full; cannot load \"%s\"", path);
+    return WS_NULL;
+  }
+  entry = &entries[slot];
+  strcpy(entry->path, path);
+  entry->asset = WS_NULL;
+  entry->textures = WS_NULL;
+  entry->numBytes = numBytes;
+  entry->cpuBytes = entry->gpuBytes = 0;
+  entry->lastUsed = 0;
+  entry->texture = 0;
+  entry->type = type;
+  entry->params = params;
+  entry->refCount = 1;
+  entry->numTextures = 0;
+  entry->resident = false;
+  wsAssetRef ref = wsMakeAssetRef(slot, entry->generation);
+  //  Keys left behind by unloaded assets are overwritten, never removed
+  paths->replace(pathKey, ref);
+  //  After a hash collision, the content key stays with the first asset
+  if (original == WS_NULL) { contents->replace(contentKey, ref); }
+  ++numLoaded;
+  bytesLoaded += numBytes;
+  *newSlot = slot;
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadAnimation(const char* filepath) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_ANIM, 0, filepath, WS_NULL, &slot);
+  if (slot < maxAssets) {
+    entries[slot].asset = wsNew(wsAnimation, wsAnimation(entries[slot].path));
+    if (!((wsAnimation*)entries[slot].asset)->isLoaded()) { return reject(slot); }
+    admit(slot);
+  }
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadFont(const char* filepath, f32 fontHeight) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_FONT, wsHash(fontHeight), filepath, WS_NULL, &slot);
+  if (slot < maxAssets) {
+    entries[slot].asset = wsNew(wsFont, wsFont(entries[slot].path, fontHeight));
+    admit(slot);
+  }
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadMesh(const char* filepath) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_MESH, 0, filepath, WS_NULL, &slot);
+  if (slot < maxAssets) {
+    entries[slot].asset = wsNew(wsMesh, wsMesh(entries[slot].path, wsMeshFormat(entries[slot].path)));
+    if (!((wsMesh*)entries[slot].asset)->isLoaded()) { return reject(slot); }
+    loadTextures(slot);
+    admit(slot);
+  }
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadShader(const char* vertexShaderPath, const char* fragmentShaderPath) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_SHADER, 0, vertexShaderPath, fragmentShaderPath, &slot);
+  if (slot < maxAssets) {
+    entries[slot].asset = wsNew(wsShader, wsShader(vertexShaderPath, fragmentShaderPath));
+    admit(slot);
+  }
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadSound(const char* filepath) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_SOUND, 0, filepath, WS_NULL, &slot);
+  if (slot < maxAssets) {
+    entries[slot].asset = wsNew(wsSound, wsSound(entries[slot].path));
+    admit(slot);
+  }
+  return ref;
+}
+
+wsAssetRef wsAssetRegistry::loadTexture(const char* filepath, bool autoSmooth, bool tiling, bool linear) {
+  u32 slot;
+  wsAssetRef ref = lookUp(WS_ASSET_TYPE_TEXTURE, (autoSmooth ? 1 : 0) | (tiling ? 2 : 0) | (linear ? 4 : 0), filepath,
+                          WS_NULL, &slot);
+  if (slot < maxAssets) {
+    wsRenderer.loadTexture(&entries[slot].texture, entries[slot].path, autoSmooth, tiling, linear);
+    admit(slot);
+  }
+  return ref;
+}
+
+void wsAssetRegistry::loadTextures(u32 slot) {
+  //  The mesh's textures come from the registry too, so they are shared and counted
+  wsMesh* mesh = (wsMesh*)entries[slot].asset;
+  wsMaterial* mats = mesh->getMats();
+  //  A mesh reloaded after eviction keeps its list, unless it has gained materials since
+  if (entries[slot].textures == WS_NULL || entries[slot].numTextures < mesh->getNumMaterials()*2) {
+    entries[slot].textures = wsNewArray(wsAssetRef, mesh->getNumMaterials()*2);
+  }
+  entries[slot].numTextures = mesh->getNumMaterials()*2;
+  wsAssetRef* textures = entries[slot].textures;
+  for (u32 m = 0; m < mesh->getNumMaterials(); ++m) {
+    textures[m*2] = textures[m*2+1] = WS_NULL;
+    if (mats[m].colorMapPath != WS_NULL) {
+      textures[m*2] = loadTexture(mats[m].colorMapPath);
+      mats[m].colorMap = getTexture(textures[m*2]);
+    }
+    if (mats[m].normalMapPath != WS_NULL) {
+      textures[m*2+1] = loadTexture(mats[m].normalMapPath, true, false, true);
+      mats[m].normalMap = getTexture(textures[m*2+1]);
+    }
+  }
+}
+
+void wsAssetRegistry::admit(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  entry->cpuBytes = entry->gpuBytes = 0;
+  switch (entry->type) {
+    case WS_ASSET_TYPE_MESH:
+      entry->cpuBytes = ((wsMesh*)entry->asset)->getMappedBytes();
+      break;
+    case WS_ASSET_TYPE_ANIM:
+      entry->cpuBytes = ((wsAnimation*)entry->asset)->getMappedBytes();
+      break;
+    case WS_ASSET_TYPE_SOUND: {
+      ALint size = 0;
+      alGetBufferi(((wsSound*)entry->asset)->soundBuffer, AL_SIZE, &size);
+      entry->cpuBytes = (u64)size;
+      break;
+    }
+    case WS_ASSET_TYPE_TEXTURE:
+      entry->gpuBytes = wsRenderer.getTextureBytes(entry->texture);
+      break;
+    default:
+      break;
+  }
+  entry->resident = true;
+  entry->lastUsed = ++numUses;
+  wsAssetBudget& budget = budgets[entry->type];
+  budget.cpuBytes += entry->cpuBytes;
+  budget.gpuBytes += entry->gpuBytes;
+  ++budget.numResident;
+  ++budget.misses;
+  enforceBudget(entry->type, slot);
+}
+
+void wsAssetRegistry::enforceBudget(u32 type, u32 keepSlot) {
+  wsAssetBudget& budget = budgets[type];
+  for (;;) {
+    const bool overCPU = (budget.maxCPUBytes && budget.cpuBytes > budget.maxCPUBytes);
+    const bool overGPU = (budget.maxGPUBytes && budget.gpuBytes > budget.maxGPUBytes);
+    if (!overCPU && !overGPU) { return; }
+    u32 victim = maxAssets;
+    for (u32 slot = 0; slot < maxAssets; ++slot) {
+      const wsRegistryEntry& entry = entries[slot];
+      if (entry.type == type && entry.resident && entry.refCount == 0 && slot != keepSlot &&
+          ((overCPU && entry.cpuBytes) || (overGPU && entry.gpuBytes)) &&
+          (victim == maxAssets || entry.lastUsed < entries[victim].lastUsed)) {
+        victim = slot;
+      }
+    }
+    if (victim == maxAssets) {
+      wsEcho(WS_LOG_UTIL, "Assets of type %u are over budget, but every one is in use\n", type);
+      return;
+    }
+    evict(victim);
+  }
+}
+
+void wsAssetRegistry::evict(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  switch (entry->type) {
+    case WS_ASSET_TYPE_MESH:
+      //  Its textures may then be evicted in turn
+      for (u32 i = 0; i < entry->numTextures; ++i) {
+        if (entry->textures[i] != WS_NULL) { release(entry->textures[i]); }
+        entry->textures[i] = WS_NULL;
+      }
+      ((wsMesh*)entry->asset)->unmap();
+      break;
+    case WS_ASSET_TYPE_ANIM:
+      ((wsAnimation*)entry->asset)->unmap();
+      break;
+    case WS_ASSET_TYPE_SOUND:
+      //  Rebuilt in the same place when it is reloaded
+      ((wsSound*)entry->asset)->~wsSound();
+      break;
+    case WS_ASSET_TYPE_TEXTURE:
+      wsRenderer.unloadTexture(entry->path);
+      entry->texture = 0;
+      break;
+    default:
+      break;
+  }
+  wsAssetBudget& budget = budgets[entry->type];
+  budget.cpuBytes -= entry->cpuBytes;
+  budget.gpuBytes -= entry->gpuBytes;
+  --budget.numResident;
+  ++budget.evictions;
+  entry->cpuBytes = entry->gpuBytes = 0;
+  entry->resident = false;
+  wsEcho(WS_LOG_UTIL, "Evicted asset file \"%s\"\n", entry->path);
+}
+
+void wsAssetRegistry::restore(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  wsEcho(WS_LOG_UTIL, "Reloading evicted asset file \"%s\"\n", entry->path);
+  switch (entry->type) {
+    case WS_ASSET_TYPE_MESH: {
+      //  Built anew, on the current tier, only if its cooked file has changed shape
+      wsMesh* mesh = (wsMesh*)entry->asset;
+      if (!mesh->remap(entry->path)) {
+        mesh->~wsMesh();
+        new(mesh) wsMesh(entry->path, wsMeshFormat(entry->path));
+      }
+      loadTextures(slot);
+      break;
+    }
+    case WS_ASSET_TYPE_ANIM: {
+      wsAnimation* anim = (wsAnimation*)entry->asset;
+      if (!anim->remap(entry->path)) {
+        anim->~wsAnimation();
+        new(anim) wsAnimation(entry->path);
+      }
+      break;
+    }
+    case WS_ASSET_TYPE_SOUND:
+      new(entry->asset) wsSound(entry->path);
+      break;
+    case WS_ASSET_TYPE_TEXTURE:
+      wsRenderer.loadTexture(&entry->texture, entry->path, (entry->params & 1) != 0, (entry->params & 2) != 0,
+                              (entry->params & 4) != 0);
+      break;
+    default:
+      break;
+  }
+  admit(slot);
+}
+
+wsAssetRef wsAssetRegistry::reject(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  wsEcho(WS_LOG_ERROR, "Asset file \"%s\" could not be loaded", entry->path);
+  --numLoaded;
+  bytesLoaded -= entry->numBytes;
+  entry->refCount = 0;
+  destroy(slot);
+  return WS_NULL;
+}
+
+void wsAssetRegistry::destroy(u32 slot) {
+  wsRegistryEntry* entry = &entries[slot];
+  if (entry->resident) {
+    wsAssetBudget& budget = budgets[entry->type];
+    budget.cpuBytes -= entry->cpuBytes;
+    budget.gpuBytes -= entry->gpuBytes;
+    --budget.numResident;
+  }
+  switch (entry->type) {
+    case WS_ASSET_TYPE_MESH:
+      //  An evicted mesh has released its textures already
+      for (u32 i = 0; i < entry->numTextures; ++i) {
+        if (entry->textures[i] != WS_NULL) { release(entry->textures[i]); }
+      }
+      ((wsMesh*)entry->asset)->~wsMesh();
+      break;
+    case WS_ASSET_TYPE_ANIM:
+      ((wsAnimation*)entry->asset)->~wsAnimation();
+      break;
+    case WS_ASSET_TYPE_FONT:
+      ((wsFont*)entry->asset)->~wsFont();
+      break;
+    case WS_ASSET_TYPE_SHADER:
+      ((wsShader*)entry->asset)->~wsShader();
+      break;
+    case WS_ASSET_TYPE_SOUND:
+      if (entry->resident) { ((wsSound*)entry->asset)->~wsSound(); }
+      break;
+    case WS_ASSET_TYPE_TEXTURE:
+      if (entry->resident) { wsRenderer.unloadTexture(entry->path); }
+      break;
+    default:
+      break;
+  }
+  entry->resident = false;
+  wsEcho(WS_LOG_UTIL, "Unloaded asset file \"%s\"\n", entry->path);
+  entry->type = WS_NULL;
+  ++entry->generation;
+  freeSlots->push(slot);
+}
+
+u32 wsAssetRegistry::unloadUnused() {
+  wsAssert(_mInitialized, "The asset registry must be initialized via the startUp() method before use.");
+  u32 numUnloaded = 0, unloadedThisPass;
+  //  Unloading a mesh releases its textures, which the next pass may then unload
+  do {
+    unloadedThisPass = 0;
+    for (u32 slot = 0; slot < maxAssets; ++slot) {
+      if (entries[slot].type != WS_NULL && entries[slot].refCount == 0) {
+        destroy(slot);
+        ++unloadedThisPass;
+      }
+    }
+    numUnloaded += unloadedThisPass;
+  } while (unloadedThisPass > 0);
+  return numUnloaded;
+}
+
+void wsAssetRegistry::printStats(u16 printLog) {
+  wsEcho(printLog, "Asset registry: %u assets loaded from %llu bytes; %u requests for a loaded path and %u "
+          "for duplicate contents saved %llu bytes\n", numLoaded, (unsigned long long)bytesLoaded, numShared,
+          numDeduplicated, (unsigned long long)bytesSaved);
+  static const char* typeNames[WS_NUM_ASSET_TYPES] = { "", "Meshes", "Animations", "Models", "Fonts", "Textures",
+                                                         "Sounds", "Shaders" };
+  for (u32 t = 1; t < WS_NUM_ASSET_TYPES; ++t) {
+    const wsAssetBudget& budget = budgets[t];
+    if (budget.hits + budget.misses == 0) { continue; }
+    wsEcho(printLog, "  %s: %u resident, holding %llu bytes and %llu of video memory; %u hits, %u misses, "
+            "%u evictions\n", typeNames[t], budget.numResident, (unsigned long long)budget.cpuBytes,
+            (unsigned long long)budget.gpuBytes, budget.hits, budget.misses, budget.evictions);
+  }
+}
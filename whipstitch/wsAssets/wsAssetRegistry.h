@@ -0,0 +1,203 @@
+/*
+ * wsAssetRegistry.h
+ *
+ *    This file declares the class wsAssetRegistry, the engine subsystem which
+ *    ensures each asset file is loaded only once. Meshes, animations, textures,
+ *    fonts, sounds and shader programs requested through the registry are keyed by
+ *    their normalized path, so "models/./a.wsMesh" and "models/a.wsMesh" are the
+ *    same request, and then by a hash of the file contents, so two copies of one
+ *    file under different names share a single asset.
+ *
+ *    Each load returns a wsAssetRef and counts a reference; the asset itself is
+ *    shared, and must be treated as immutable. release(...) gives the reference
+ *    back. Assets with no references stay cached until unloadUnused() destroys them
+ *    and frees their GL and AL objects. Memory taken from the primary stack is not
+ *    returned until its tier is freed, as with any other allocation.
+ *
+ *    Each type of asset may be given a budget with setBudget(...): a limit on the
+ *    memory its resident assets hold, and on their estimated video memory. Only what
+ *    evicting an asset gives back is counted: the mapping of a cooked mesh or
+ *    animation, the samples of a sound, and the video memory of a texture. When a
+ *    type is over its budget, the assets of that type which nothing references are
+ *    evicted, the least recently used first. An evicted asset keeps its entry, so its
+ *    references stay valid; the next request for it, or get...(...) of it, reloads it
+ *    in place. A cooked mesh or animation is only mapped again, into the tables it
+ *    built on the primary stack the first time. Assets parsed from text, fonts and
+ *    shaders give nothing back and are never evicted.
+ *
+ *    Textures are created through wsRenderer.loadTexture(...), and unloading one
+ *    deletes it from the renderer's cache as well. That cache keeps one texture per
+ *    file, so textures are keyed by path and contents alone; a file requested again
+ *    with other settings gets the texture made with the first. Meshes loaded here
+ *    take references to their own textures, which are released when the mesh is
+ *    unloaded.
+ *
+ *    The registry creates GL objects, so it may be used from the main thread only.
+ *
+ *    Usage:
+ *      wsAssetRef griswald = wsRegistry.loadMesh("models/Griswald.wsMesh");
+ *      wsModel* model = wsNew(wsModel, wsModel("Griswald", wsRegistry.getMesh(griswald)));
+ *      ...
+ *      wsRegistry.release(griswald);
+ *      wsRegistry.unloadUnused();
+ *
+ *      wsRegistry.setBudget(WS_ASSET_TYPE_TEXTURE, 0, 256*wsMB);
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_ASSET_REGISTRY_H_
+#define WS_ASSET_REGISTRY_H_
+
+#include "../wsConfig.h"
+#include "wsAsset.h"
+#include "wsAnimation.h"
+#include "wsFont.h"
+#include "wsMesh.h"
+
+class wsShader;
+class wsSound;
+
+//  Refers to one registry entry; WS_NULL when a load fails
+typedef u32 wsAssetRef;
+
+struct wsRegistryEntry {
+  char path[WS_MAX_ASSET_PATH];  //  Normalized path of the file first loaded
+  void* asset;          //  wsMesh*, wsAnimation*, wsFont*, wsSound* or wsShader*
+  wsAssetRef* textures; //  For a mesh, references to the color and normal map of each material
+  u64 numBytes;         //  Size of the file, or both files of a shader program
+  u64 cpuBytes;         //  Memory evicting the asset gives back
+  u64 gpuBytes;         //  Estimated video memory evicting the asset gives back
+  u64 lastUsed;         //  The registry's use count when the asset was last requested
+  u32 texture;
+  u32 type;             //  WS_ASSET_TYPE_*, or WS_NULL while the slot is free
+  u32 params;           //  What the asset was loaded with, to reload it the same way
+  u32 refCount;
+  u32 generation;       //  Bumped on unload, so stale references are recognized
+  u32 numTextures;
+  bool resident;        //  False once evicted
+};
+
+//  The limits on, and use of, one type of asset
+struct wsAssetBudget {
+  u64 maxCPUBytes;  //  0 for no limit
+  u64 maxGPUBytes;  //  0 for no limit
+  u64 cpuBytes;     //  Held by resident assets
+  u64 gpuBytes;
+  u32 numResident;
+  u32 hits;         //  Requests answered by a resident asset
+  u32 misses;       //  Requests which loaded the asset, or reloaded it after eviction
+  u32 evictions;
+};
+
+class wsAssetRegistry {
+  private:
+    wsRegistryEntry* entries;
+    wsStack<u32>* freeSlots;
+    wsHashMap<wsAssetRef>* paths;     //  Keyed by normalized path, type and, but for textures, parameters
+    wsHashMap<wsAssetRef>* contents;  //  Keyed by content hash, type and, but for textures, parameters
+    wsAssetBudget budgets[WS_NUM_ASSET_TYPES];
+    u64 numUses;      //  Requests of any asset so far; orders them for eviction
+    u32 maxAssets;
+    //  Statistics
+    u64 bytesLoaded;  //  File bytes read to create assets
+    u64 bytesSaved;   //  File bytes of requests answered by an asset already loaded
+    u32 numLoaded;
+    u32 numShared;    //  Requests for a path already loaded
+    u32 numDeduplicated;  //  Requests for a new path with the contents of one already loaded
+    //  True only when the startUp function has been called
+    bool _mInitialized;
+    //  Private Methods
+    //  Counts the memory of an asset just loaded into the slot, then evicts others of
+    //  its type if that puts the type over budget
+    void admit(u32 slot);
+    void destroy(u32 slot);
+    //  Evicts the least recently used assets of the type which nothing references,
+    //  never the one in keepSlot, until the type is within its budget
+    void enforceBudget(u32 type, u32 keepSlot);
+    void evict(u32 slot);
+    wsRegistryEntry* getEntry(wsAssetRef ref, u32 type);
+    void loadTextures(u32 slot);
+    //  Frees the entry of an asset whose file was missing or malformed; returns WS_NULL
+    wsAssetRef reject(u32 slot);
+    //  Reloads an evicted asset in place
+    void restore(u32 slot);
+    //  Marks a request for an asset, reloading it if it was evicted
+    void use(u32 slot);
+    //  getEntry(...) for a request which will use the asset
+    wsRegistryEntry* useEntry(wsAssetRef ref, u32 type);
+    //  Returns a reference to an asset already loaded from the same path or contents,
+    //  or claims a new entry for the caller to fill and sets newSlot. Returns WS_NULL
+    //  if the file cannot be read or the registry is full.
+    wsAssetRef lookUp(u32 type, u32 params, const char* filepath, const char* secondPath, u32* newSlot);
+  public:
+    /*  Default Constructor and Deconstructor */
+    //  As an engine subsystem, the asset registry takes no action until explicitly
+    //  initialized via the startUp(...) function.
+    //  uninitialized via the shutDown() function.
+    wsAssetRegistry() : _mInitialized(false) {}
+    ~wsAssetRegistry() {}
+    /*  Setters and Getters */
+    //  Each returns WS_NULL if the reference is stale or of another type
+    wsAnimation* getAnimation(wsAssetRef ref);
+    wsFont* getFont(wsAssetRef ref);
+    wsMesh* getMesh(wsAssetRef ref);
+    wsShader* getShader(wsAssetRef ref);
+    wsSound* getSound(wsAssetRef ref);
+    u32 getTexture(wsAssetRef ref);
+    const wsAssetBudget& getBudget(u32 type) const { return budgets[type]; }
+    u64 getBytesLoaded() { return bytesLoaded; }
+    u64 getBytesSaved() { return bytesSaved; }
+    u32 getRefCount(wsAssetRef ref);
+    bool isInitialized() { return _mInitialized; }
+    //  False if the asset has been evicted, or the reference is stale
+    bool isResident(wsAssetRef ref);
+    //  Limits the memory and estimated video memory the resident assets of a type
+    //  hold, evicting at once if they hold more; 0 is no limit
+    void setBudget(u32 type, u64 maxCPUBytes, u64 maxGPUBytes);
+    /*  Operational Methods */
+    //  Counts another reference to an asset already loaded, for a second owner
+    wsAssetRef acquire(wsAssetRef ref);
+    wsAssetRef loadAnimation(const char* filepath);
+    wsAssetRef loadFont(const char* filepath, f32 fontHeight = WS_DEFAULT_FONT_HEIGHT);
+    wsAssetRef loadMesh(const char* filepath);
+    wsAssetRef loadShader(const char* vertexShaderPath, const char* fragmentShaderPath);
+    wsAssetRef loadSound(const char* filepath);
+    wsAssetRef loadTexture(const char* filepath, bool autoSmooth = true, bool tiling = false, bool linear = false);
+    //  Prints the number of assets loaded, the bytes deduplication saved, and the
+    //  residency, hits, misses and evictions of each type of asset
+    void printStats(u16 printLog = WS_LOG_UTIL);
+    //  Gives back one reference; returns the number remaining
+    u32 release(wsAssetRef ref);
+    //  Destroys every asset with no references; returns the number destroyed
+    u32 unloadUnused();
+    //  Uninitializes the asset registry
+    void shutDown();
+    //  Initializes the asset registry
+    void startUp(u32 myMaxAssets = WS_DEFAULT_MAX_ASSETS);
+};
+
+extern wsAssetRegistry wsRegistry;
+
+#endif /* WS_ASSET_REGISTRY_H_ */
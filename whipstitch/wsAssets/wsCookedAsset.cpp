@@ -0,0 +1,114 @@
+/*
+ * wsCookedAsset.cpp
+ *
+ *    This file implements the cooked mesh and animation files of the Whipstitch Game
+ *    Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsCookedAsset.h"
+#include "wsAnimation.h"
+#include "wsMesh.h"
+#include "../wsUtils/wsLog.h"
+#include "../wsUtils/wsVirtualFS.h"
+#include <stdio.h>
+#include <string.h>
+
+u64 wsCookedLayout(wsCookedBlock* blocks, const u64* sizes, u32 numBlocks, u64 offset) {
+  for (u32 b = 0; b < numBlocks; ++b) {
+    offset = (offset + WS_COOKED_ALIGNMENT-1) & ~(u64)(WS_COOKED_ALIGNMENT-1);
+    blocks[b].offset = offset;
+    blocks[b].numBytes = sizes[b];
+    offset += sizes[b];
+  }
+  return offset;
+}
+
+bool wsCookedBlocksFit(const wsCookedBlock* blocks, const u64* sizes, u32 numBlocks, u64 fileSize) {
+  for (u32 b = 0; b < numBlocks; ++b) {
+    if (blocks[b].numBytes != sizes[b] || (blocks[b].offset & (WS_COOKED_ALIGNMENT-1)) ||
+        blocks[b].offset > fileSize || blocks[b].numBytes > fileSize - blocks[b].offset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool wsWriteCooked(const char* destPath, const void* header, u32 headerSize, const wsCookedBlock* blocks,
+                    const void* const* blockData, u32 numBlocks) {
+  char tmpPath[WS_MAX_ASSET_PATH + 8];
+  if (strlen(destPath) >= WS_MAX_ASSET_PATH) {
+    wsEcho(WS_LOG_ERROR, "Cooked asset path \"%s\" is too long.", destPath);
+    return false;
+  }
+  strcpy(tmpPath, destPath);
+  strcat(tmpPath, ".tmp");
+  FILE* pFile = fopen(tmpPath, "wb");
+  if (pFile == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Could not open \"%s\" for writing.", tmpPath);
+    return false;
+  }
+  bool written = (fwrite(header, headerSize, 1, pFile) == 1);
+  const u8 padding[WS_COOKED_ALIGNMENT] = { 0 };
+  u64 position = headerSize;
+  for (u32 b = 0; b < numBlocks && written; ++b) {
+    if (blocks[b].offset > position) {
+      written = (fwrite(padding, blocks[b].offset - position, 1, pFile) == 1);
+    }
+    if (blocks[b].numBytes) {
+      written = written && (fwrite(blockData[b], blocks[b].numBytes, 1, pFile) == 1);
+    }
+    position = blocks[b].offset + blocks[b].numBytes;
+  }
+  written = (fclose(pFile) == 0) && written;
+  //  rename(...) swaps the file whole; anyone mapping the old one keeps reading it
+  if (!written || rename(tmpPath, destPath) != 0) {
+    wsEcho(WS_LOG_ERROR, "Could not write cooked asset \"%s\".", destPath);
+    remove(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+bool wsCookMesh(const char* meshPath, const char* destPath) {
+  char cookedPath[WS_MAX_ASSET_PATH];
+  if (destPath == WS_NULL) {
+    if (!wsCookedPath(cookedPath, meshPath, WS_MESH_EXTENSION, WS_MAX_ASSET_PATH)) { return false; }
+    destPath = cookedPath;
+  }
+  //  Always from the source, never from the last cooked file
+  wsMesh mesh(meshPath, wsMeshFormat(meshPath), false);
+  return mesh.writeCooked(destPath);
+}
+
+bool wsCookAnimation(const char* animPath, const char* destPath) {
+  char cookedPath[WS_MAX_ASSET_PATH];
+  if (destPath == WS_NULL) {
+    if (!wsCookedPath(cookedPath, animPath, WS_ANIM_EXTENSION, WS_MAX_ASSET_PATH)) { return false; }
+    destPath = cookedPath;
+  }
+  wsAnimation anim(animPath, false);
+  return anim.writeCooked(destPath);
+}
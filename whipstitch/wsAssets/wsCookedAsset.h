@@ -0,0 +1,164 @@
+/*
+ * wsCookedAsset.h
+ *
+ *    This file declares the cooked mesh and animation files of the Whipstitch Game
+ *    Engine, the .wsMeshBin and .wsAnimBin files.
+ *
+ *    A cooked file holds an asset's immutable data exactly as wsMesh and wsAnimation
+ *    use it: vertices welded and reordered, levels of detail built, joints in their
+ *    rest pose, and every keyframe's modifiers. Loading one maps the file and points
+ *    the asset into it, so nothing is parsed and nothing is copied; since mappings are
+ *    shared, every engine process on a machine which loads the same asset reads one
+ *    physical copy of it. Only what each asset changes as it is used, such as its
+ *    materials' textures, is built on the memory stack.
+ *
+ *    Layout, in the byte order of the machine which cooked it:
+ *      wsCookedMeshHeader or wsCookedAnimHeader    counts, and where each block lies
+ *      blocks                                      each aligned to WS_COOKED_ALIGNMENT
+ *
+ *    wsCookMesh(...) and wsCookAnimation(...) write one from a source file;
+ *    assetCooker cooks whole directories.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_COOKED_ASSET_H_
+#define WS_COOKED_ASSET_H_
+
+#include "../wsConfig.h"
+#include "../wsUtils.h"
+
+#define WS_MESH_MAGIC         0x684D7377  //  "wsMh"
+#define WS_ANIM_MAGIC         0x6E417377  //  "wsAn"
+#define WS_COOKED_VERSION     2
+#define WS_COOKED_ALIGNMENT   16          //  Enough for vec4 and quat
+#define WS_MESH_EXTENSION     ".wsMeshBin"
+#define WS_ANIM_EXTENSION     ".wsAnimBin"
+//  A string offset for a texture map the material does not use
+#define WS_COOKED_NO_STRING   0xFFFFFFFF
+
+struct wsCookedBlock {
+  u64 offset;   //  From the start of the file
+  u64 numBytes;
+};
+
+enum wsCookedMeshBlocks {
+  WS_MESH_BLOCK_VERTS,            //  wsVert[numVerts]
+  WS_MESH_BLOCK_JOINTS,           //  wsJoint[numJoints], in the rest pose
+  WS_MESH_BLOCK_JOINT_LOCATIONS,  //  vec4[numJoints]
+  WS_MESH_BLOCK_JOINT_ROTATIONS,  //  quat[numJoints]
+  WS_MESH_BLOCK_JOINT_NAMES,      //  u32[numJoints], the hash of each joint's name
+  WS_MESH_BLOCK_MATERIALS,        //  wsCookedMaterial[numMaterials]
+  WS_MESH_BLOCK_PROPERTIES,       //  wsCookedProperty[numProperties], in material order
+  WS_MESH_BLOCK_LODS,             //  wsCookedLOD[numLODs]
+  WS_MESH_BLOCK_TRIANGLE_COUNTS,  //  u32[(numLODs+1)*numMaterials], level by level
+  WS_MESH_BLOCK_TRIANGLES,        //  wsTriangle[numTriangles], in the order counted
+  WS_MESH_BLOCK_STRINGS,          //  Texture paths, each terminated
+  WS_MESH_NUM_BLOCKS
+};
+
+struct wsCookedMeshHeader {
+  u32 magic;
+  u32 version;
+  u32 numVerts;
+  u32 numMaterials;
+  u32 numJoints;
+  u32 numLODs;
+  u32 numProperties;
+  u32 numTriangles;   //  Over every level of detail
+  vec4 defaultPos;
+  vec4 bounds;
+  wsCookedBlock blocks[WS_MESH_NUM_BLOCKS];
+};
+
+struct wsCookedMaterial {
+  vec4 ambient;
+  vec4 diffuse;
+  vec4 specular;
+  vec4 emissive;
+  u32 shininess;
+  u32 numProperties;
+  u32 colorMapPath;   //  Offsets into the strings, or WS_COOKED_NO_STRING
+  u32 normalMapPath;
+};
+
+struct wsCookedProperty {
+  u32 name;
+  f32 value;
+};
+
+struct wsCookedLOD {
+  u32 totalTriangles;
+  f32 error;
+};
+
+enum wsCookedAnimBlocks {
+  WS_ANIM_BLOCK_JOINTS,     //  wsAnimJoint[numJoints]
+  WS_ANIM_BLOCK_KEYFRAMES,  //  wsCookedKeyframe[numKeyframes]
+  WS_ANIM_BLOCK_MODS,       //  wsJointMod[numMods], keyframe by keyframe
+  WS_ANIM_NUM_BLOCKS
+};
+
+struct wsCookedAnimHeader {
+  u32 magic;
+  u32 version;
+  u32 animType;
+  u32 numJoints;
+  u32 numKeyframes;
+  u32 numMods;
+  f32 framesPerSecond;
+  u32 reserved;
+  vec4 bounds;
+  char name[256];
+  wsCookedBlock blocks[WS_ANIM_NUM_BLOCKS];
+};
+
+struct wsCookedKeyframe {
+  f32 frameIndex;
+  u32 numJointsModified;
+  u32 firstMod;
+  u32 reserved;
+};
+
+//  Places blocks of the given sizes one after another from offset, each aligned to
+//  WS_COOKED_ALIGNMENT, and returns where the last one ends
+u64 wsCookedLayout(wsCookedBlock* blocks, const u64* sizes, u32 numBlocks, u64 offset);
+
+//  True if every block has the given size and lies, aligned, within a file of fileSize bytes
+bool wsCookedBlocksFit(const wsCookedBlock* blocks, const u64* sizes, u32 numBlocks, u64 fileSize);
+
+//  Writes a header and the data of each of its blocks to destPath. The file is written
+//  beside it and renamed into place, so a process with the old file mapped keeps it whole.
+bool wsWriteCooked(const char* destPath, const void* header, u32 headerSize, const wsCookedBlock* blocks,
+                    const void* const* blockData, u32 numBlocks);
+
+//  Parses, optimizes and simplifies a .wsMesh or .stl and writes it to destPath, or beside it
+//  when destPath is WS_NULL. Allocates on the current tier of the primary stack.
+bool wsCookMesh(const char* meshPath, const char* destPath = WS_NULL);
+
+//  Parses a .wsAnim and writes it to destPath, or beside it when destPath is WS_NULL.
+//  Allocates on the current tier of the primary stack.
+bool wsCookAnimation(const char* animPath, const char* destPath = WS_NULL);
+
+#endif /* WS_COOKED_ASSET_H_ */
@@ -54,7 +54,10 @@ wsFont::wsFont(const char* filePath, f32 fontHeight) {
   error = FT_Init_FreeType(&fontLibrary); //  Intiialize the freetype library
   wsAssert(error == 0, "Problem initializing the Freetype Font library.");
 
-  error = FT_New_Face(fontLibrary, filePath, 0, &typeFace); //  The zero indicates that we are loading the first face index (not bold, italic, etc.)
+  //  Read from a mounted pack if one holds it; the face reads the file until FT_Done_Face(...)
+  wsMappedFile file;
+  error = !file.open(filePath) ||
+          FT_New_Memory_Face(fontLibrary, (const FT_Byte*)file.getData(), (FT_Long)file.getSize(), 0, &typeFace); //  The zero indicates that we are loading the first face index (not bold, italic, etc.)
   if (error) {
     wsEcho(WS_LOG_ERROR, "Problem loading file: %s\n", filePath);
   }
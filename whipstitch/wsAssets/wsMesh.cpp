@@ -33,79 +33,602 @@
 */
 
 #include "wsMesh.h"
-#include <stdio.h>
+#include "wsCookedAsset.h"
+#include "wsMeshOptimizer.h"
+#include "wsMeshSimplifier.h"
 #include "../wsGraphics.h"
+#include "../wsGameFlow/wsThreadPool.h"
+#include "../wsUtils/wsMappedFile.h"
+#include "../wsUtils/wsTokenizer.h"
+#include "../wsUtils/wsVirtualFS.h"
 
-wsMesh::wsMesh(const char* filepath, const u32 format) {
+//  Smallest share of a block of records worth handing to another thread, in bytes
+#define WS_MIN_PARSE_CHUNK 65536
+
+//  A binary STL is an 80-byte header, a u32 count of triangles, and a 50-byte record
+//  for each: its facet normal, three corners, and two bytes of attributes
+#define WS_STL_HEADER_BYTES 84
+#define WS_STL_RECORD_BYTES 50
+#define WS_STL_CORNERS_OFFSET 12
+//  Fewest binary STL triangles worth handing to another thread
+#define WS_MIN_STL_CHUNK 16384
+//  Most pieces an ASCII STL is split into to be counted and read in parallel
+#define WS_MAX_STL_PIECES 256
+//  Most triangles read from an STL, so that they fit in one stack allocation; every
+//  coordinate of every corner then has a u32 index as well
+#define WS_MAX_STL_TRIANGLES ((u32)(WS_MAX_STACK_ALLOCATION / sizeof(wsTriangle)))
+
+//  Copies "textures/<textureName>" onto the current stack
+static char* wsTexturePath(const char* textureName) {
+  char* path = wsNewArray(char, strlen("textures/") + strlen(textureName) + 1);
+  strcpy(path, "textures/");
+  strcat(path, textureName);
+  return path;
+}
+
+//  Bytes taken by each block of a cooked mesh
+static void wsCookedMeshSizes(u64* sizes, const wsCookedMeshHeader& header, u64 stringsSize) {
+  sizes[WS_MESH_BLOCK_VERTS] = sizeof(wsVert)*(u64)header.numVerts;
+  sizes[WS_MESH_BLOCK_JOINTS] = sizeof(wsJoint)*(u64)header.numJoints;
+  sizes[WS_MESH_BLOCK_JOINT_LOCATIONS] = sizeof(vec4)*(u64)header.numJoints;
+  sizes[WS_MESH_BLOCK_JOINT_ROTATIONS] = sizeof(quat)*(u64)header.numJoints;
+  sizes[WS_MESH_BLOCK_JOINT_NAMES] = sizeof(u32)*(u64)header.numJoints;
+  sizes[WS_MESH_BLOCK_MATERIALS] = sizeof(wsCookedMaterial)*(u64)header.numMaterials;
+  sizes[WS_MESH_BLOCK_PROPERTIES] = sizeof(wsCookedProperty)*(u64)header.numProperties;
+  sizes[WS_MESH_BLOCK_LODS] = sizeof(wsCookedLOD)*(u64)header.numLODs;
+  sizes[WS_MESH_BLOCK_TRIANGLE_COUNTS] = sizeof(u32)*(u64)(header.numLODs+1)*header.numMaterials;
+  sizes[WS_MESH_BLOCK_TRIANGLES] = sizeof(wsTriangle)*(u64)header.numTriangles;
+  sizes[WS_MESH_BLOCK_STRINGS] = stringsSize;
+}
+
+wsMesh::wsMesh(const char* filepath, const u32 format, const bool useCooked, const bool prepare) {
+  mats = WS_NULL;
+  lods = WS_NULL;
+  numLODs = 0;
+  loaded = true;
   switch (format) {
     default:
     case WS_MESH_FORMAT_WHIPSTITCH:
-      loadWhipstitch(filepath);
+      //  A cooked mesh was optimized and simplified as it was cooked
+      if (useCooked && loadCooked(filepath)) { return; }
+      if (!loadWhipstitch(filepath)) {
+        clear();
+        return;
+      }
       break;
     case WS_MESH_FORMAT_STL:
-      loadSTL(filepath);
+      if (useCooked && loadCooked(filepath)) { return; }
+      if (!loadSTL(filepath)) {
+        clear();
+        return;
+      }
       break;
   }
+  if (!prepare) { return; }
+  #if WS_OPTIMIZE_MESHES
+    optimize();
+  #endif
+  #if WS_GENERATE_LODS
+    generateLODs();
+  #endif
+}
+
+u32 wsMeshFormat(const char* filepath) {
+  const char* extension = strrchr(filepath, '.');
+  return (extension != WS_NULL && strcasecmp(extension, ".stl") == 0) ? WS_MESH_FORMAT_STL : WS_MESH_FORMAT_WHIPSTITCH;
+}
+
+void wsMesh::clear() {
+  verts = WS_NULL;
+  mats = WS_NULL;
+  joints = WS_NULL;
+  jointLocations = WS_NULL;
+  jointRotations = WS_NULL;
+  jointIndices = WS_NULL;
+  lods = WS_NULL;
+  defaultPos = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  bounds = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+  numVerts = 0;
+  numMaterials = 0;
+  numJoints = 0;
+  numLODs = 0;
+  loaded = false;
 }
 
 wsMesh::~wsMesh() {
-  //  Nothing to do here.
+  //  A cooked file is unmapped along with the mesh
+}
+
+void wsMesh::optimize() {
+  wsAssert(!isCooked(), "A cooked mesh is read-only; it was optimized as it was cooked.");
+  if (numVerts == 0) { return; }
+  u32 totalTris = 0;
+  f32 missesBefore = 0.0f, missesAfter = 0.0f;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    totalTris += mats[m].numTriangles;
+    //  Each material is its own draw call, so each starts with a cold cache
+    missesBefore += wsComputeACMR((u32*)mats[m].tris, mats[m].numTriangles*3, numVerts) * mats[m].numTriangles;
+  }
+  if (totalTris == 0) { return; }
+  u32* remap = (u32*)malloc(sizeof(u32)*numVerts);
+  wsAssert(remap, "Could not allocate the mesh optimizer's remap table.");
+  const u32 oldNumVerts = numVerts;
+  u32 numUnique = wsWeldVertices(verts, numVerts, remap);
+  for (u32 m = 0; m < numMaterials; ++m) {
+    u32* indices = (u32*)mats[m].tris;
+    for (u32 i = 0; i < mats[m].numTriangles*3; ++i) { indices[i] = remap[indices[i]]; }
+  }
+  //  Reorder each material's triangles, then number the vertices in the order drawn
+  u32* ordered = (u32*)malloc(sizeof(u32)*totalTris*3);
+  wsAssert(ordered, "Could not allocate the mesh optimizer's index buffer.");
+  memset(remap, 0xFF, sizeof(u32)*numUnique);
+  u32 numUsed = 0;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    u32* indices = (u32*)mats[m].tris;
+    u32 numIndices = mats[m].numTriangles*3;
+    wsOptimizeVertexCache(ordered, indices, numIndices, numUnique);
+    memcpy(indices, ordered, sizeof(u32)*numIndices);
+    numUsed = wsOptimizeVertexFetch(remap, numUsed, indices, numIndices);
+  }
+  free(ordered);
+  wsVert* reordered = (wsVert*)malloc(sizeof(wsVert)*numUsed);
+  wsAssert(reordered, "Could not allocate the mesh optimizer's vertex buffer.");
+  for (u32 v = 0; v < numUnique; ++v) {
+    if (remap[v] != WS_NO_VERTEX) { reordered[remap[v]] = verts[v]; }
+  }
+  for (u32 v = 0; v < numUsed; ++v) { verts[v] = reordered[v]; }
+  free(reordered);
+  numVerts = numUsed;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    u32* indices = (u32*)mats[m].tris;
+    for (u32 i = 0; i < mats[m].numTriangles*3; ++i) { indices[i] = remap[indices[i]]; }
+    missesAfter += wsComputeACMR(indices, mats[m].numTriangles*3, numVerts) * mats[m].numTriangles;
+  }
+  free(remap);
+  wsEcho(WS_LOG_GRAPHICS, "Optimized mesh: %u vertices welded to %u, %u used; ACMR %.3f -> %.3f\n",
+          oldNumVerts, numUnique, numUsed, missesBefore / totalTris, missesAfter / totalTris);
+}
+
+void wsMesh::generateLODs(const u32 maxLODs) {
+  wsAssert(!isCooked(), "A cooked mesh is read-only; its levels of detail were built as it was cooked.");
+  u32 totalTris = 0;
+  for (u32 m = 0; m < numMaterials; ++m) { totalTris += mats[m].numTriangles; }
+  if (totalTris == 0 || maxLODs == 0) { return; }
+  //  Every level is simplified from the full mesh, so its error is measured from it
+  //  rather than piling up from level to level
+  u32* source = (u32*)malloc(sizeof(u32)*totalTris*3);
+  u32* sourceGroups = (u32*)malloc(sizeof(u32)*totalTris);
+  u32* indices = (u32*)malloc(sizeof(u32)*totalTris*3);
+  u32* groups = (u32*)malloc(sizeof(u32)*totalTris);
+  wsAssert((source && sourceGroups && indices && groups), "Could not allocate the level of detail buffers.");
+  u32 numSource = 0;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    memcpy(&source[numSource*3], mats[m].tris, sizeof(wsTriangle)*mats[m].numTriangles);
+    for (u32 t = 0; t < mats[m].numTriangles; ++t) { sourceGroups[numSource++] = m; }
+  }
+  //  The bounds are half-extents, so their length is the radius of a sphere holding the mesh
+  f32 radius = sqrtf(bounds.x*bounds.x + bounds.y*bounds.y + bounds.z*bounds.z);
+  if (radius <= 0.0f) { radius = 1.0f; }
+  lods = wsNewArray(wsMeshLOD, maxLODs);
+  u32 prevTris = totalTris;
+  f64 share = 1.0;
+  for (u32 l = 0; l < maxLODs; ++l) {
+    share *= WS_LOD_REDUCTION;
+    memcpy(indices, source, sizeof(u32)*totalTris*3);
+    memcpy(groups, sourceGroups, sizeof(u32)*totalTris);
+    f32 error;
+    u32 numIndices = wsSimplify(indices, groups, totalTris*3, verts, numVerts, (u32)(totalTris*share)*3, &error);
+    //  A level which keeps most of the last one's triangles is not worth its memory
+    if (numIndices/3 > prevTris - prevTris/4) { break; }
+    prevTris = numIndices/3;
+    wsMeshLOD& lod = lods[numLODs++];
+    lod.tris = wsNewArray(wsTriangle*, numMaterials);
+    lod.numTriangles = wsNewArray(u32, numMaterials);
+    lod.totalTriangles = numIndices/3;
+    lod.error = error / radius;
+    for (u32 m = 0; m < numMaterials; ++m) {
+      lod.numTriangles[m] = 0;
+      for (u32 t = 0; t < numIndices/3; ++t) { lod.numTriangles[m] += (groups[t] == m); }
+      lod.tris[m] = (lod.numTriangles[m]) ? wsNewArray(wsTriangle, lod.numTriangles[m]) : WS_NULL;
+      u32 numWritten = 0;
+      for (u32 t = 0; t < numIndices/3; ++t) {
+        if (groups[t] == m) { memcpy(&lod.tris[m][numWritten++], &indices[t*3], sizeof(wsTriangle)); }
+      }
+    }
+    //  Reordered for the vertex cache like the full mesh, through the spent index buffer
+    for (u32 m = 0; m < numMaterials; ++m) {
+      if (lod.numTriangles[m] == 0) { continue; }
+      wsOptimizeVertexCache(indices, (u32*)lod.tris[m], lod.numTriangles[m]*3, numVerts);
+      memcpy(lod.tris[m], indices, sizeof(wsTriangle)*lod.numTriangles[m]);
+    }
+    wsEcho(WS_LOG_GRAPHICS, "Level of detail %u: %u of %u triangles, error %.4f of the bounding radius\n",
+            numLODs, lod.totalTriangles, totalTris, lod.error);
+  }
+  free(source);
+  free(sourceGroups);
+  free(indices);
+  free(groups);
+}
+
+bool wsMesh::loadCooked(const char* filepath) {
+  //  Once unmapped, the mesh is mapped again into the tables it built the first time
+  const bool remapping = (mats != WS_NULL);
+  char cookedPath[WS_MAX_ASSET_PATH];
+  if (!wsVFS.findCurrentCooked(cookedPath, filepath, WS_MESH_EXTENSION, WS_MAX_ASSET_PATH) || !cooked.open(cookedPath)) {
+    return false;
+  }
+  const char* data = cooked.getData();
+  const wsCookedMeshHeader* header = (const wsCookedMeshHeader*)data;
+  bool valid = (cooked.getSize() >= sizeof(wsCookedMeshHeader) && ((size_t)data & (WS_COOKED_ALIGNMENT-1)) == 0 &&
+                header->magic == WS_MESH_MAGIC && header->version == WS_COOKED_VERSION && header->numLODs <= WS_MAX_LODS);
+  const u64 stringsSize = valid ? header->blocks[WS_MESH_BLOCK_STRINGS].numBytes : 0;
+  if (valid) {
+    u64 sizes[WS_MESH_NUM_BLOCKS];
+    wsCookedMeshSizes(sizes, *header, stringsSize);
+    valid = wsCookedBlocksFit(header->blocks, sizes, WS_MESH_NUM_BLOCKS, cooked.getSize()) &&
+            (stringsSize == 0 || data[header->blocks[WS_MESH_BLOCK_STRINGS].offset + stringsSize - 1] == '\0');
+  }
+  //  The counts must cover the triangles, and the materials the properties and strings
+  if (valid) {
+    const u32* counts = (const u32*)(data + header->blocks[WS_MESH_BLOCK_TRIANGLE_COUNTS].offset);
+    const wsCookedMaterial* cookedMats = (const wsCookedMaterial*)(data + header->blocks[WS_MESH_BLOCK_MATERIALS].offset);
+    u64 totalTris = 0, totalProperties = 0;
+    for (u32 c = 0; c < (header->numLODs+1)*header->numMaterials; ++c) { totalTris += counts[c]; }
+    for (u32 m = 0; m < header->numMaterials; ++m) {
+      totalProperties += cookedMats[m].numProperties;
+      valid = valid && (cookedMats[m].colorMapPath == WS_COOKED_NO_STRING || cookedMats[m].colorMapPath < stringsSize) &&
+                        (cookedMats[m].normalMapPath == WS_COOKED_NO_STRING || cookedMats[m].normalMapPath < stringsSize);
+    }
+    valid = valid && (totalTris == header->numTriangles) && (totalProperties == header->numProperties);
+  }
+  //  Triangles index the vertices, and joints their parents, without further checks
+  if (valid) {
+    const u32* indices = (const u32*)(data + header->blocks[WS_MESH_BLOCK_TRIANGLES].offset);
+    u32 largest = 0;
+    for (u64 i = 0; i < 3*(u64)header->numTriangles; ++i) {
+      if (indices[i] > largest) { largest = indices[i]; }
+    }
+    valid = (header->numTriangles == 0 || largest < header->numVerts);
+    const wsJoint* cookedJoints = (const wsJoint*)(data + header->blocks[WS_MESH_BLOCK_JOINTS].offset);
+    for (u32 j = 0; valid && j < header->numJoints; ++j) {
+      valid = (cookedJoints[j].parent >= -1 && cookedJoints[j].parent < (i64)header->numJoints);
+    }
+  }
+  if (!valid) {
+    wsEcho(WS_LOG_ERROR, "Cooked mesh \"%s\" is truncated, corrupt or of an unsupported version.", cookedPath);
+    cooked.close();
+    return false;
+  }
+  if (remapping) {
+    const wsCookedMaterial* cookedMats = (const wsCookedMaterial*)(data + header->blocks[WS_MESH_BLOCK_MATERIALS].offset);
+    bool same = (header->numVerts == numVerts && header->numMaterials == numMaterials &&
+                  header->numJoints == numJoints && header->numLODs == numLODs);
+    for (u32 m = 0; same && m < numMaterials; ++m) { same = (cookedMats[m].numProperties == mats[m].numProperties); }
+    if (!same) {
+      wsEcho(WS_LOG_GRAPHICS, "Cooked mesh \"%s\" has changed since it was first mapped.", cookedPath);
+      cooked.close();
+      return false;
+    }
+  }
+  assetType = WS_ASSET_TYPE_MESH;
+  numVerts = header->numVerts;
+  numMaterials = header->numMaterials;
+  numJoints = header->numJoints;
+  numLODs = header->numLODs;
+  defaultPos = header->defaultPos;
+  bounds = header->bounds;
+  //  The immutable blocks are used where they lie; nothing may write through them
+  verts = (wsVert*)(data + header->blocks[WS_MESH_BLOCK_VERTS].offset);
+  if (numJoints > 0) {
+    joints = (wsJoint*)(data + header->blocks[WS_MESH_BLOCK_JOINTS].offset);
+    jointLocations = (vec4*)(data + header->blocks[WS_MESH_BLOCK_JOINT_LOCATIONS].offset);
+    jointRotations = (quat*)(data + header->blocks[WS_MESH_BLOCK_JOINT_ROTATIONS].offset);
+    if (!remapping) {
+      const u32* jointNames = (const u32*)(data + header->blocks[WS_MESH_BLOCK_JOINT_NAMES].offset);
+      jointIndices = wsNew(wsHashMap<u32>, wsHashMap<u32>(numJoints));
+      for (u32 j = 0; j < numJoints; ++j) { jointIndices->insert(jointNames[j], j); }
+    }
+  }
+  else {
+    joints = WS_NULL;
+    jointLocations = WS_NULL;
+    jointRotations = WS_NULL;
+    jointIndices = WS_NULL;
+  }
+  //  Materials hold the textures this process loads for them, so they are copied out
+  const wsCookedMaterial* cookedMats = (const wsCookedMaterial*)(data + header->blocks[WS_MESH_BLOCK_MATERIALS].offset);
+  const wsCookedProperty* props = (const wsCookedProperty*)(data + header->blocks[WS_MESH_BLOCK_PROPERTIES].offset);
+  const u32* counts = (const u32*)(data + header->blocks[WS_MESH_BLOCK_TRIANGLE_COUNTS].offset);
+  const wsTriangle* tris = (const wsTriangle*)(data + header->blocks[WS_MESH_BLOCK_TRIANGLES].offset);
+  const char* strings = data + header->blocks[WS_MESH_BLOCK_STRINGS].offset;
+  if (!remapping) { mats = wsNewArray(wsMaterial, numMaterials); }
+  for (u32 m = 0; m < numMaterials; ++m) {
+    const wsCookedMaterial& mat = cookedMats[m];
+    mats[m].ambient = mat.ambient;
+    mats[m].diffuse = mat.diffuse;
+    mats[m].specular = mat.specular;
+    mats[m].emissive = mat.emissive;
+    mats[m].shininess = mat.shininess;
+    mats[m].colorMap = 0;
+    mats[m].normalMap = 0;
+    mats[m].colorMapPath = (mat.colorMapPath != WS_COOKED_NO_STRING) ? strings + mat.colorMapPath : WS_NULL;
+    mats[m].normalMapPath = (mat.normalMapPath != WS_COOKED_NO_STRING) ? strings + mat.normalMapPath : WS_NULL;
+    mats[m].numTriangles = counts[m];
+    mats[m].tris = (wsTriangle*)tris;
+    tris += counts[m];
+    if (remapping) { continue; }
+    mats[m].numProperties = mat.numProperties;
+    mats[m].properties = WS_NULL;
+    if (mat.numProperties > 0) {
+      mats[m].properties = wsNew(wsHashMap<f32>, wsHashMap<f32>(wsNextPrime(mat.numProperties)));
+      for (u32 p = 0; p < mat.numProperties; ++p) { mats[m].properties->insert(props[p].name, props[p].value); }
+      props += mat.numProperties;
+    }
+  }
+  if (numLODs > 0) {
+    const wsCookedLOD* cookedLODs = (const wsCookedLOD*)(data + header->blocks[WS_MESH_BLOCK_LODS].offset);
+    if (!remapping) { lods = wsNewArray(wsMeshLOD, numLODs); }
+    for (u32 l = 0; l < numLODs; ++l) {
+      if (!remapping) { lods[l].tris = wsNewArray(wsTriangle*, numMaterials); }
+      lods[l].numTriangles = (u32*)&counts[(l+1)*numMaterials];
+      lods[l].totalTriangles = cookedLODs[l].totalTriangles;
+      lods[l].error = cookedLODs[l].error;
+      for (u32 m = 0; m < numMaterials; ++m) {
+        lods[l].tris[m] = (lods[l].numTriangles[m]) ? (wsTriangle*)tris : WS_NULL;
+        tris += lods[l].numTriangles[m];
+      }
+    }
+  }
+  wsEcho(WS_LOG_GRAPHICS, "Mapped cooked mesh \"%s\": %u vertices, %u materials, %u joints, %u levels of detail\n",
+          cookedPath, numVerts, numMaterials, numJoints, numLODs);
+  return true;
 }
 
-const void wsMesh::loadSTL(const char* filepath) {
-  wsEcho(WS_LOG_GRAPHICS, "STL loading is not yet supported.");
+bool wsMesh::remap(const char* filepath) {
+  wsAssert((mats != WS_NULL && verts == WS_NULL), "Only an unmapped mesh can be mapped again.");
+  return loadCooked(filepath);
+}
+
+void wsMesh::unmap() {
+  wsAssert(isCooked(), "Only a cooked mesh can be unmapped.");
+  cooked.close();
+  //  Nothing may point into the old mapping
+  verts = WS_NULL;
+  joints = WS_NULL;
+  jointLocations = WS_NULL;
+  jointRotations = WS_NULL;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    mats[m].tris = WS_NULL;
+    mats[m].colorMapPath = mats[m].normalMapPath = WS_NULL;
+    mats[m].colorMap = mats[m].normalMap = 0;
+  }
+  for (u32 l = 0; l < numLODs; ++l) {
+    lods[l].numTriangles = WS_NULL;
+    for (u32 m = 0; m < numMaterials; ++m) { lods[l].tris[m] = WS_NULL; }
+  }
 }
 
-const void wsMesh::loadWhipstitch(const char* filepath) {
+bool wsMesh::loadSTL(const char* filepath) {
+  assetType = WS_ASSET_TYPE_MESH;
+  wsEcho(WS_LOG_GRAPHICS, "Loading Mesh from STL file \"%s\"\n", filepath);
+  numVerts = 0;
+  numJoints = 0;
+  verts = WS_NULL;
+  joints = WS_NULL;
+  jointLocations = WS_NULL;
+  jointRotations = WS_NULL;
+  jointIndices = WS_NULL;
+  defaultPos = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  bounds = vec4(0.0f, 0.0f, 0.0f, 0.0f);
+  //  STL has no materials, so the whole mesh is one plain one
+  numMaterials = 1;
+  mats = wsNewArray(wsMaterial, 1);
+  mats[0].ambient = vec4(0.2f, 0.2f, 0.2f, 1.0f);
+  mats[0].diffuse = vec4(0.8f, 0.8f, 0.8f, 1.0f);
+  mats[0].specular = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  mats[0].emissive = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  mats[0].tris = WS_NULL;
+  mats[0].properties = WS_NULL;
+  mats[0].colorMapPath = mats[0].normalMapPath = WS_NULL;
+  mats[0].shininess = 0;
+  mats[0].colorMap = mats[0].normalMap = 0;
+  mats[0].numTriangles = 0;
+  mats[0].numProperties = 0;
+  wsMappedFile file;
+  if (!file.open(filepath)) { return false; }
+  const char* data = file.getData();
+  const u64 size = file.getSize();
+  //  Any file may begin with "solid", binary ones included, but only a binary file's
+  //  size agrees with its count of triangles
+  u32 numTris = 0;
+  if (size >= WS_STL_HEADER_BYTES) { memcpy(&numTris, data + 80, sizeof(u32)); }
+  const u64 binarySize = WS_STL_HEADER_BYTES + WS_STL_RECORD_BYTES*(u64)numTris;
+  wsTokenizer tok(data, file.getEnd());
+  const bool ascii = tok.lookingAt("solid") && binarySize != size;
+  if (!ascii && (size < WS_STL_HEADER_BYTES || binarySize > size)) {
+    wsEcho(WS_LOG_ERROR, "Error: \"%s\" is not an STL file", filepath);
+    return false;
+  }
+  if (!ascii && numTris > WS_MAX_STL_TRIANGLES) {
+    wsEcho(WS_LOG_ERROR, "Error: STL file \"%s\" has more than %u triangles", filepath, WS_MAX_STL_TRIANGLES);
+    return false;
+  }
+  //  Every triangle's three corners, x, y and z, before they are welded
+  f32* corners = WS_NULL;
+  if (!ascii) {
+    corners = (f32*)malloc(sizeof(f32)*9*(u64)wsMax(numTris, 1u));
+    wsAssert(corners, "Could not allocate the STL file's corners.");
+    //  STL is little-endian, as is every platform the engine runs on
+    const char* records = data + WS_STL_HEADER_BYTES;
+    wsRunParallelChunks(numTris, WS_MIN_STL_CHUNK, [&](u32 first, u32 last) {
+      for (u32 t = first; t < last; ++t) {
+        memcpy(&corners[9*(u64)t], records + WS_STL_RECORD_BYTES*(u64)t + WS_STL_CORNERS_OFFSET, sizeof(f32)*9);
+      }
+    });
+  }
+  else {
+    //  The facets are split into pieces at "facet" lines, which are counted, then read,
+    //  in parallel, each piece into its own place
+    char nameBuffer[255];
+    tok.expect("solid"); tok.readLine(nameBuffer, sizeof(nameBuffer));
+    const char* facetsBegin = tok.findLine(tok.getPos(), "facet");
+    const char* facetsEnd = file.getEnd();
+    const u64 maxPieces = (u64)(facetsEnd - facetsBegin)/WS_MIN_PARSE_CHUNK + 1;
+    const u32 numPieces = (maxPieces < WS_MAX_STL_PIECES) ? (u32)maxPieces : WS_MAX_STL_PIECES;
+    const char* pieces[WS_MAX_STL_PIECES + 1];
+    u32 pieceTris[WS_MAX_STL_PIECES];
+    u32 pieceFirst[WS_MAX_STL_PIECES];
+    pieces[0] = facetsBegin;
+    for (u32 i = 1; i < numPieces; ++i) {
+      pieces[i] = tok.findLine(facetsBegin + (u64)(facetsEnd - facetsBegin)*i/numPieces, "facet");
+    }
+    pieces[numPieces] = facetsEnd;
+    wsRunParallelChunks(numPieces, 1, [&](u32 first, u32 last) {
+      for (u32 i = first; i < last; ++i) {
+        u32 count = 0;
+        for (const char* p = tok.findLine(pieces[i], "facet"); p < pieces[i+1]; p = tok.findLine(p + 5, "facet")) {
+          ++count;
+        }
+        pieceTris[i] = count;
+      }
+    });
+    u64 totalTris = 0;
+    for (u32 i = 0; i < numPieces; ++i) {
+      pieceFirst[i] = (u32)totalTris;
+      totalTris += pieceTris[i];
+    }
+    if (totalTris > WS_MAX_STL_TRIANGLES) {
+      wsEcho(WS_LOG_ERROR, "Error: STL file \"%s\" has more than %u triangles", filepath, WS_MAX_STL_TRIANGLES);
+      return false;
+    }
+    numTris = (u32)totalTris;
+    corners = (f32*)malloc(sizeof(f32)*9*(u64)wsMax(numTris, 1u));
+    wsAssert(corners, "Could not allocate the STL file's corners.");
+    std::atomic<u32> numTrisRead(0);
+    wsRunParallelChunks(numPieces, 1, [&](u32 first, u32 last) {
+      for (u32 i = first; i < last; ++i) {
+        wsTokenizer chunk(pieces[i], pieces[i+1]);
+        f32* dest = &corners[9*(u64)pieceFirst[i]];
+        f32 normal[3];
+        u32 numRead = 0;
+        while (numRead < pieceTris[i] && chunk.lookingAt("facet")) {
+          //  The facet normal is left out; normals are smoothed across the welded mesh
+          chunk.expect("facet normal"); chunk.readF32s(normal, 3);
+          chunk.expect("outer loop");
+          chunk.expect("vertex"); chunk.readF32s(&dest[0], 3);
+          chunk.expect("vertex"); chunk.readF32s(&dest[3], 3);
+          chunk.expect("vertex"); chunk.readF32s(&dest[6], 3);
+          chunk.expect("endloop");
+          chunk.expect("endfacet");
+          if (chunk.hasFailed()) { break; }
+          dest += 9;
+          ++numRead;
+        }
+        numTrisRead += numRead;
+      }
+    });
+    //  The corners of a facet which could not be read are unknown, and would throw off
+    //  the bounds and the weld
+    if (numTrisRead != numTris) {
+      wsEcho(WS_LOG_ERROR, "Error: read %u of %u triangles from STL file \"%s\"", (u32)numTrisRead, numTris, filepath);
+      free(corners);
+      return false;
+    }
+  }
+  //  Corners weld within a share of the mesh's size, which covers the rounding of
+  //  exporters that write each triangle's corners on their own
+  f32 lower[3] = { 0.0f, 0.0f, 0.0f }, upper[3] = { 0.0f, 0.0f, 0.0f };
+  for (u32 a = 0; a < 3 && numTris > 0; ++a) { lower[a] = upper[a] = corners[a]; }
+  for (u64 c = 0; c < 3*(u64)numTris; ++c) {
+    for (u32 a = 0; a < 3; ++a) {
+      if (corners[c*3+a] < lower[a]) { lower[a] = corners[c*3+a]; }
+      if (corners[c*3+a] > upper[a]) { upper[a] = corners[c*3+a]; }
+    }
+  }
+  const f32 extent[3] = { upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2] };
+  const f32 epsilon = WS_STL_WELD_EPSILON*sqrtf(extent[0]*extent[0] + extent[1]*extent[1] + extent[2]*extent[2]);
+  defaultPos = vec4((lower[0] + upper[0])*0.5f, (lower[1] + upper[1])*0.5f, (lower[2] + upper[2])*0.5f, 1.0f);
+  bounds = vec4(extent[0]*0.5f, extent[1]*0.5f, extent[2]*0.5f, 0.0f);
+  //  The welded indices are written straight into the mesh's triangles
+  wsTriangle* tris = wsNewArray(wsTriangle, wsMax(numTris, 1u));
+  if (tris == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Error: no room on the stack for the %u triangles of STL file \"%s\"", numTris, filepath);
+    free(corners);
+    return false;
+  }
+  numVerts = wsWeldPositions(corners, numTris*3, (u32*)tris, epsilon);
+  //  Welding leaves up to three vertices for each triangle, which may not fit in one allocation
+  verts = (sizeof(wsVert)*(u64)numVerts <= WS_MAX_STACK_ALLOCATION) ? wsNewArray(wsVert, wsMax(numVerts, 1u)) : WS_NULL;
+  if (verts == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Error: no room on the stack for the %u vertices of STL file \"%s\"", numVerts, filepath);
+    free(corners);
+    return false;
+  }
+  //  Triangles which welding collapsed have no area left to draw
+  u32 numKept = 0;
+  for (u32 t = 0; t < numTris; ++t) {
+    const u32* v = tris[t].vertIndices;
+    if (v[0] != v[1] && v[1] != v[2] && v[2] != v[0]) { tris[numKept++] = tris[t]; }
+  }
+  mats[0].tris = tris;
+  mats[0].numTriangles = numKept;
+  wsRunParallelChunks(numVerts, WS_MIN_STL_CHUNK, [&](u32 first, u32 last) {
+    memset((void*)&verts[first], 0, sizeof(wsVert)*(last - first));
+    for (u32 v = first; v < last; ++v) {
+      verts[v].pos = vec4(corners[v*3], corners[v*3+1], corners[v*3+2], 1.0f);
+    }
+  });
+  free(corners);
+  wsComputeSmoothNormals(verts, numVerts, (u32*)tris, numKept*3);
+  wsEcho(WS_LOG_GRAPHICS, "numVertices = %u, numTriangles = %u, of %u in the file\n", numVerts, numKept, numTris);
+  return true;
+}
+
+bool wsMesh::loadWhipstitch(const char* filepath) {
   u32 hasSkeleton = 0;
   assetType = WS_ASSET_TYPE_MESH;
   wsEcho(WS_LOG_GRAPHICS, "Loading Mesh from file \"%s\"\n", filepath);
-  FILE* pFile;
-  pFile = fopen(filepath, "r");
-  wsAssert( pFile, "Error Loading file." );
+  wsMappedFile file;
+  if (!file.open(filepath)) { return false; }
+  wsTokenizer tok(file.getData(), file.getEnd());
   //  Scan past the header
-  errorCheck( fscanf( pFile,  "//  Whipstitch Mesh File\n//  This mesh is for use with the Whipstitch Game Engine\n"
-                "//  For more information, email dsnettleton@whipstitchgames.com\n\n") );
+  tok.expect( "//  Whipstitch Mesh File\n//  This mesh is for use with the Whipstitch Game Engine\n"
+              "//  For more information, email dsnettleton@whipstitchgames.com\n\n");
   f32 versionNumber;
-  errorCheck( fscanf( pFile, "versionNumber %f\n", &versionNumber) );
+  tok.expect("versionNumber"); tok.readF32(versionNumber);
   char nameBuffer[255];
-  errorCheck( fscanf( pFile, "meshName %[^\t\n]\n", nameBuffer) );
-  errorCheck( fscanf( pFile, "numVertices %u\n", &numVerts) );
-  errorCheck( fscanf( pFile, "numMaterials %u\n", &numMaterials) );
-  errorCheck( fscanf( pFile, "defaultPos { %f %f %f }\n", &defaultPos.x, &defaultPos.y, &defaultPos.z) );
-  errorCheck( fscanf( pFile, "hasSkeleton %u\n\n", &hasSkeleton) );
+  tok.expect("meshName "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+  tok.expect("numVertices"); tok.readU32(numVerts);
+  tok.expect("numMaterials"); tok.readU32(numMaterials);
+  tok.expect("defaultPos {"); tok.readF32s(&defaultPos.x, 3); tok.expect("}");
+  tok.expect("hasSkeleton"); tok.readU32(hasSkeleton);
   wsEcho(WS_LOG_GRAPHICS, "meshName = %s, numVertices = %u, numMaterials = %u, hasSkeleton = %u\n", nameBuffer, numVerts, numMaterials, hasSkeleton);
   //  Generate object arrays and place them on the current stack
   mats = wsNewArray(wsMaterial, numMaterials);
   verts = wsNewArray(wsVert, numVerts);
   if (hasSkeleton > 0) {
-    errorCheck( fscanf( pFile, "skeleton {\n" ) );
-    errorCheck( fscanf( pFile, "  numJoints %u\n", &numJoints) );
+    tok.expect("skeleton {");
+    tok.expect("numJoints"); tok.readU32(numJoints);
     //  Initialize joint array for this skeleton
     joints = wsNewArray(wsJoint, numJoints);
     jointLocations = wsNewArray(vec4, numJoints);
     jointRotations = wsNewArray(quat, numJoints);
     jointIndices = wsNew(wsHashMap<u32>, wsHashMap<u32>(numJoints));
-    u32 currentJ;
-    for (u32 j = 0; j < numJoints; ++j) {
-      errorCheck( fscanf( pFile, "  joint %u {\n", &currentJ) );
+    u32 currentJ = 0;
+    for (u32 j = 0; j < numJoints && !tok.hasFailed(); ++j) {
+      tok.expect("joint"); tok.readU32(currentJ); tok.expect("{");
       wsAssert( (currentJ == j), "Current index does not relate to current joint.");
-      errorCheck( fscanf( pFile, "    name %[^\t\n]\n", nameBuffer) );
-      errorCheck( fscanf( pFile, "    parent %d\n", &joints[j].parent) );
-      errorCheck( fscanf( pFile, "    pos_start { %f %f %f }\n",
-              &joints[j].start.x,
-              &joints[j].start.y,
-              &joints[j].start.z ) );
-      errorCheck( fscanf( pFile, "    pos_end { %f %f %f }\n",
-              &joints[j].end.x,
-              &joints[j].end.y,
-              &joints[j].end.z ) );
-      errorCheck( fscanf( pFile, "    rotation { %f %f %f %f }\n",
-              &joints[j].rot.x,
-              &joints[j].rot.y,
-              &joints[j].rot.z,
-              &joints[j].rot.w ) );
-      errorCheck( fscanf( pFile, "  }\n") );
+      tok.expect("name "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+      tok.expect("parent"); tok.readI32(joints[j].parent);
+      if (joints[j].parent >= (i32)numJoints) {
+        wsEcho(WS_LOG_ERROR, "Error: joint %u of mesh file \"%s\" has no parent %d", j, filepath, joints[j].parent);
+        return false;
+      }
+      tok.expect("pos_start {"); tok.readF32s(&joints[j].start.x, 3); tok.expect("}");
+      tok.expect("pos_end {"); tok.readF32s(&joints[j].end.x, 3); tok.expect("}");
+      joints[j].start.w = joints[j].end.w = 1.0f;
+      tok.expect("rotation {"); tok.readF32s(&joints[j].rot.x, 4); tok.expect("}");
+      tok.expect("}");
       wsEcho(WS_LOG_GRAPHICS, "jointName = %s\n", nameBuffer);
       jointIndices->insert(wsHash(nameBuffer), j);
       if (j >= 0) {
@@ -123,136 +646,286 @@ const void wsMesh::loadWhipstitch(const char* filepath) {
         joints[j].end.rotate(joints[j].rot.getInverse());
       }
     }
-    errorCheck( fscanf( pFile, "}\n\n") );
+    tok.expect("}");
   }// End if (hasSkeleton)
   else {
+    numJoints = 0;
     joints = WS_NULL;
     jointLocations = WS_NULL;
     jointRotations = WS_NULL;
     jointIndices = WS_NULL;
   }
-  errorCheck( fscanf( pFile, "vertices {\n") );
-  errorCheck( fscanf( pFile, "  bounds { %f %f %f }\n", &bounds.x, &bounds.y, &bounds.z) );
-  u32 currentIndex;
-  for (u32 v = 0; v < numVerts; ++v) {
-    errorCheck( fscanf( pFile, "  vert %u {\n", &currentIndex) );
-    wsAssert( (currentIndex == v), "Current index does not relate to current vertex.");
-    errorCheck( fscanf( pFile, "    pos { %f %f %f }\n", &verts[v].pos.x, &verts[v].pos.y, &verts[v].pos.z) );
-    errorCheck( fscanf( pFile, "    norm { %f %f %f }\n", &verts[v].norm.x, &verts[v].norm.y, &verts[v].norm.z) );
-    verts[v].pos.w = 1.0f;
-    verts[v].norm.w = 1.0f;
-    errorCheck( fscanf( pFile, "    tex { %f %f }\n", &verts[v].tex[0], &verts[v].tex[1]) );
-    errorCheck( fscanf( pFile, "    weights {\n") );
-    errorCheck( fscanf( pFile, "      numWeights %u\n", &verts[v].numWeights) );
-    for (i32 w = 0; w < verts[v].numWeights; ++w) {
-      if (w < WS_MAX_JOINT_INFLUENCES) {
-        errorCheck( fscanf( pFile, "      joint { %d %f }\n", &verts[v].jointIndex[w], &verts[v].influence[w]) );
+  tok.expect("vertices {");
+  tok.expect("bounds {"); tok.readF32s(&bounds.x, 3); tok.expect("}");
+  //  The vertex records are split between threads by bytes; each chunk starts at the
+  //  first "vert" line inside its share and stops where the next chunk starts.
+  const char* vertsBegin = tok.getPos();
+  const char* vertsEnd = tok.findLine(vertsBegin, "materials ");
+  std::atomic<u32> numVertsRead(0);
+  std::atomic<bool> vertsFailed(false);
+  wsRunParallelChunks((u32)(vertsEnd - vertsBegin), WS_MIN_PARSE_CHUNK, [&](u32 first, u32 last) {
+    const char* chunkEnd = vertsEnd;
+    if (vertsBegin + last < vertsEnd) {
+      chunkEnd = tok.findLine(vertsBegin + last, "vert ");
+      if (chunkEnd > vertsEnd) { chunkEnd = vertsEnd; }
+    }
+    const char* chunkBegin = tok.findLine(vertsBegin + first, "vert ");
+    if (chunkBegin > chunkEnd) { chunkBegin = chunkEnd; }
+    wsTokenizer chunk(chunkBegin, chunkEnd);
+    u32 numRead = 0;
+    u32 v = 0;
+    bool misplaced = false;
+    while (chunk.lookingAt("vert ")) {
+      u32 currentIndex = 0;
+      chunk.expect("vert"); chunk.readU32(currentIndex); chunk.expect("{");
+      if (numRead == 0) { v = currentIndex; }
+      //  The index comes from the file, so it must be checked before anything is written
+      if (chunk.hasFailed() || currentIndex != v || v >= numVerts) { misplaced = true; break; }
+      chunk.expect("pos {"); chunk.readF32s(&verts[v].pos.x, 3); chunk.expect("}");
+      chunk.expect("norm {"); chunk.readF32s(&verts[v].norm.x, 3); chunk.expect("}");
+      verts[v].pos.w = 1.0f;
+      verts[v].norm.w = 1.0f;
+      chunk.expect("tex {"); chunk.readF32s(verts[v].tex, 2); chunk.expect("}");
+      chunk.expect("weights {");
+      chunk.expect("numWeights"); chunk.readI32(verts[v].numWeights);
+      for (i32 w = 0; w < verts[v].numWeights && !chunk.hasFailed(); ++w) {
+        i32 slot = (w < WS_MAX_JOINT_INFLUENCES) ? w : WS_MAX_JOINT_INFLUENCES-1;
+        chunk.expect("joint {");
+        chunk.readI32(verts[v].jointIndex[slot]);
+        chunk.readF32(verts[v].influence[slot]);
+        chunk.expect("}");
       }
-      else {
-        errorCheck( fscanf( pFile, "      joint { %d %f }\n",
-          &verts[v].jointIndex[WS_MAX_JOINT_INFLUENCES-1],
-          &verts[v].influence[WS_MAX_JOINT_INFLUENCES-1]) );
+      if (verts[v].numWeights > WS_MAX_JOINT_INFLUENCES) { verts[v].numWeights = WS_MAX_JOINT_INFLUENCES; }
+      if (verts[v].numWeights < 0 || chunk.hasFailed()) { verts[v].numWeights = 0; }
+      for (i32 w = verts[v].numWeights; w < WS_MAX_JOINT_INFLUENCES; ++w) { //  Initialize the rest to null
+        verts[v].jointIndex[w] = 0;
+        verts[v].influence[w] = 0.0f;
       }
+      chunk.expect("}");
+      chunk.expect("}");
+      if (chunk.hasFailed()) { break; }
+      ++numRead;
+      ++v;
     }
-    if (verts[v].numWeights > WS_MAX_JOINT_INFLUENCES) { verts[v].numWeights = WS_MAX_JOINT_INFLUENCES; }
-    for (i32 w = verts[v].numWeights; w < WS_MAX_JOINT_INFLUENCES; ++w) { //  Initialize the rest to null
-      verts[v].jointIndex[w] = 0;
-      verts[v].influence[w] = 0.0f;
-    }
-    errorCheck( fscanf( pFile, "    }\n") );
-    errorCheck( fscanf( pFile, "  }\n") );
+    numVertsRead += numRead;
+    if (misplaced || chunk.hasFailed()) { vertsFailed = true; }
+  });
+  if (vertsFailed || numVertsRead != numVerts) {
+    wsEcho(WS_LOG_ERROR, "Error: read %u of %u vertices from mesh file \"%s\"", (u32)numVertsRead, numVerts, filepath);
+    return false;
   }
-  errorCheck( fscanf( pFile, "}\n\nmaterials {\n") );
-  for (u32 m = 0; m < numMaterials; ++m) {
+  tok.setPos(vertsEnd);
+  tok.expect("materials {");
+  u32 currentIndex = 0;
+  for (u32 m = 0; m < numMaterials && !tok.hasFailed(); ++m) {
     wsEcho("Loading Mat %u\n", m);
-    errorCheck( fscanf( pFile, "  mat %u {\n", &currentIndex) );
+    tok.expect("mat"); tok.readU32(currentIndex); tok.expect("{");
     wsAssert( (currentIndex == m), "Current index does not relate to current material.");
-    errorCheck( fscanf( pFile, "    name %s\n", nameBuffer) );
-    errorCheck( fscanf( pFile, "    shine %u\n", &mats[m].shininess) );
-    errorCheck( fscanf( pFile, "    ambient { %f %f %f %f }\n",
-            &mats[m].ambient.r,
-            &mats[m].ambient.g,
-            &mats[m].ambient.b,
-            &mats[m].ambient.a ) );
-    errorCheck( fscanf( pFile, "    diffuse { %f %f %f %f }\n",
-            &mats[m].diffuse.r,
-            &mats[m].diffuse.g,
-            &mats[m].diffuse.b,
-            &mats[m].diffuse.a ) );
-    errorCheck( fscanf( pFile, "    specular { %f %f %f %f }\n",
-            &mats[m].specular.r,
-            &mats[m].specular.g,
-            &mats[m].specular.b,
-            &mats[m].specular.a ) );
-    errorCheck( fscanf( pFile, "    emissive { %f %f %f %f }\n",
-            &mats[m].emissive.r,
-            &mats[m].emissive.g,
-            &mats[m].emissive.b,
-            &mats[m].emissive.a ) );
-    errorCheck( fscanf( pFile, "    maps {\n" ) );
-    u32 mapsBitflag;
-    errorCheck( fscanf( pFile, "      bitFlag %u\n", &mapsBitflag) );
+    tok.expect("name"); tok.readWord(nameBuffer, sizeof(nameBuffer));
+    tok.expect("shine"); tok.readU32(mats[m].shininess);
+    tok.expect("ambient {"); tok.readF32s(&mats[m].ambient.r, 4); tok.expect("}");
+    tok.expect("diffuse {"); tok.readF32s(&mats[m].diffuse.r, 4); tok.expect("}");
+    tok.expect("specular {"); tok.readF32s(&mats[m].specular.r, 4); tok.expect("}");
+    tok.expect("emissive {"); tok.readF32s(&mats[m].emissive.r, 4); tok.expect("}");
+    tok.expect("maps {");
+    u32 mapsBitflag = 0;
+    tok.expect("bitFlag"); tok.readU32(mapsBitflag);
+    //  Only the file names are kept here; loadTextures() turns them into textures
+    mats[m].colorMap = 0;
+    mats[m].normalMap = 0;
+    mats[m].colorMapPath = WS_NULL;
+    mats[m].normalMapPath = WS_NULL;
     if (mapsBitflag & WS_TEXTURE_MAP_COLOR) {
-      errorCheck( fscanf( pFile, "      colorMap %[^\t\n]\n", nameBuffer) );
-      char filepath[264] = { "textures/" };
-      strcat(filepath, nameBuffer);
-      wsRenderer.loadTexture(&mats[m].colorMap, filepath);
+      tok.expect("colorMap "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+      mats[m].colorMapPath = wsTexturePath(nameBuffer);
     }
     if (mapsBitflag & WS_TEXTURE_MAP_NORMAL) {
-      errorCheck( fscanf( pFile, "      normalMap %[^\t\n]\n", nameBuffer) );
-      char filepath[264] = { "textures/" };
-      strcat(filepath, nameBuffer);
-      wsRenderer.loadTexture(&mats[m].normalMap, filepath);
+      tok.expect("normalMap "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+      mats[m].normalMapPath = wsTexturePath(nameBuffer);
     }
-    errorCheck( fscanf( pFile, "    }\n") );
-    //  Triangles using this material
-    errorCheck( fscanf( pFile, "    numTriangles %u\n", &mats[m].numTriangles) );
+    tok.expect("}");
+    //  Triangles using this material, split between threads like the vertices
+    tok.expect("numTriangles"); tok.readU32(mats[m].numTriangles);
     mats[m].tris = wsNewArray( wsTriangle, mats[m].numTriangles );
-    errorCheck( fscanf( pFile, "    triangles {\n") );
-    for (u32 t = 0; t < mats[m].numTriangles; ++t) {
-      errorCheck( fscanf( pFile, "      tri %u {\n", &currentIndex) );
-      wsAssert( (currentIndex == t), "Current index does not relate to current triangle.");
-      errorCheck( fscanf( pFile,  "        verts {\n"
-                                  "          indices { %u %u %u }\n",
-                                  &mats[m].tris[t].vertIndices[0],
-                                  &mats[m].tris[t].vertIndices[1],
-                                  &mats[m].tris[t].vertIndices[2] ) );
-      errorCheck( fscanf( pFile, "        }\n") );
-      errorCheck( fscanf( pFile, "      }\n") );
+    tok.expect("triangles {");
+    const char* trisBegin = tok.getPos();
+    const char* trisEnd = tok.findLine(trisBegin, "properties ");
+    wsTriangle* tris = mats[m].tris;
+    u32 numTris = mats[m].numTriangles;
+    std::atomic<u32> numTrisRead(0);
+    std::atomic<bool> trisFailed(false);
+    wsRunParallelChunks((u32)(trisEnd - trisBegin), WS_MIN_PARSE_CHUNK, [&](u32 first, u32 last) {
+      const char* chunkEnd = trisEnd;
+      if (trisBegin + last < trisEnd) {
+        chunkEnd = tok.findLine(trisBegin + last, "tri ");
+        if (chunkEnd > trisEnd) { chunkEnd = trisEnd; }
+      }
+      const char* chunkBegin = tok.findLine(trisBegin + first, "tri ");
+      if (chunkBegin > chunkEnd) { chunkBegin = chunkEnd; }
+      wsTokenizer chunk(chunkBegin, chunkEnd);
+      u32 numRead = 0;
+      u32 t = 0;
+      bool misplaced = false;
+      while (chunk.lookingAt("tri ")) {
+        u32 triIndex = 0;
+        chunk.expect("tri"); chunk.readU32(triIndex); chunk.expect("{");
+        if (numRead == 0) { t = triIndex; }
+        if (chunk.hasFailed() || triIndex != t || t >= numTris) { misplaced = true; break; }
+        chunk.expect("verts {");
+        chunk.expect("indices {");
+        chunk.readU32(tris[t].vertIndices[0]);
+        chunk.readU32(tris[t].vertIndices[1]);
+        chunk.readU32(tris[t].vertIndices[2]);
+        chunk.expect("}");
+        chunk.expect("}");
+        chunk.expect("}");
+        if (chunk.hasFailed()) { break; }
+        //  The optimizer and simplifier index their own tables with these
+        const u32* indices = tris[t].vertIndices;
+        if (indices[0] >= numVerts || indices[1] >= numVerts || indices[2] >= numVerts) { misplaced = true; break; }
+        ++numRead;
+        ++t;
+      }
+      numTrisRead += numRead;
+      if (misplaced || chunk.hasFailed()) { trisFailed = true; }
+    });
+    if (trisFailed || numTrisRead != numTris) {
+      wsEcho(WS_LOG_ERROR, "Error: read %u of %u triangles of material %u from mesh file \"%s\"", (u32)numTrisRead, numTris,
+              m, filepath);
+      return false;
     }
-    errorCheck( fscanf( pFile, "    }\n" ) );
-    errorCheck( fscanf( pFile, "    properties {\n") );
-    errorCheck( fscanf( pFile, "      numProperties %u\n", &mats[m].numProperties) );
+    tok.setPos(trisEnd);
+    tok.expect("properties {");
+    tok.expect("numProperties"); tok.readU32(mats[m].numProperties);
     if (mats[m].numProperties > 0) {
       mats[m].properties = wsNew(wsHashMap<f32>, wsHashMap<f32>(wsNextPrime(mats[m].numProperties)));
       f32 value = 0.0f;
       u32 propNum = 0;
-      for (u32 p = 0; p < mats[m].numProperties; ++p) {
-        errorCheck( fscanf( pFile, "    property %u {\n", &propNum) );
+      for (u32 p = 0; p < mats[m].numProperties && !tok.hasFailed(); ++p) {
+        tok.expect("property"); tok.readU32(propNum); tok.expect("{");
         wsAssert( (propNum == p), "Current Index does not relate to current property.");
-        errorCheck( fscanf( pFile, "      name %[^\t\n]\n", nameBuffer) );
-        errorCheck( fscanf( pFile, "    value %f\n", &value) );
-        errorCheck( fscanf( pFile, "    }\n") );
+        tok.expect("name "); tok.readLine(nameBuffer, sizeof(nameBuffer));
+        tok.expect("value"); tok.readF32(value);
+        tok.expect("}");
         mats[m].properties->insert(wsHash(nameBuffer), value);
       }
     }
     else {
       mats[m].properties = NULL;
     }
-    errorCheck( fscanf( pFile, "    }\n") );
-    errorCheck( fscanf( pFile, "  }\n") );
+    tok.expect("}");
+    tok.expect("}");
     wsEcho(WS_LOG_GRAPHICS, "Mesh Loaded.");
   }
-  errorCheck( fscanf( pFile, "}\n") );
-  if (fclose(pFile) == EOF) {
-    wsEcho(WS_LOG_ERROR, "Failed to close mesh file");
+  tok.expect("}");
+  if (tok.hasFailed()) {
+    wsEcho(WS_LOG_ERROR, "Error: could not parse mesh file \"%s\" past byte %u", filepath, (u32)(tok.getPos() - file.getData()));
+    return false;
   }
+  return true;
 }
 
-void wsMesh::errorCheck(const i32 my) {
-  if (my == EOF) {
-    wsEcho(WS_LOG_ERROR, "Error: premature end of file.");
+bool wsMesh::writeCooked(const char* destPath) {
+  wsCookedMeshHeader header;
+  memset((void*)&header, 0, sizeof(header));
+  header.magic = WS_MESH_MAGIC;
+  header.version = WS_COOKED_VERSION;
+  header.numVerts = numVerts;
+  header.numMaterials = numMaterials;
+  header.numJoints = numJoints;
+  header.numLODs = numLODs;
+  header.defaultPos = defaultPos;
+  header.bounds = bounds;
+  u64 stringsSize = 0;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    header.numTriangles += mats[m].numTriangles;
+    if (mats[m].properties) { header.numProperties += mats[m].properties->getLength(); }
+    if (mats[m].colorMapPath) { stringsSize += strlen(mats[m].colorMapPath) + 1; }
+    if (mats[m].normalMapPath) { stringsSize += strlen(mats[m].normalMapPath) + 1; }
   }
+  for (u32 l = 0; l < numLODs; ++l) { header.numTriangles += lods[l].totalTriangles; }
+  u64 sizes[WS_MESH_NUM_BLOCKS];
+  wsCookedMeshSizes(sizes, header, stringsSize);
+  wsCookedLayout(header.blocks, sizes, WS_MESH_NUM_BLOCKS, sizeof(header));
+  //  Copied field by field into zeroed blocks, so padding never carries stray bytes and
+  //  the same mesh always cooks to the same file
+  void* blockData[WS_MESH_NUM_BLOCKS];
+  for (u32 b = 0; b < WS_MESH_NUM_BLOCKS; ++b) {
+    blockData[b] = calloc(sizes[b] ? sizes[b] : 1, 1);
+    wsAssert(blockData[b], "Could not allocate a block of the cooked mesh.");
+  }
+  wsVert* outVerts = (wsVert*)blockData[WS_MESH_BLOCK_VERTS];
+  for (u32 v = 0; v < numVerts; ++v) {
+    outVerts[v].pos = verts[v].pos;
+    outVerts[v].norm = verts[v].norm;
+    outVerts[v].tex[0] = verts[v].tex[0];
+    outVerts[v].tex[1] = verts[v].tex[1];
+    outVerts[v].numWeights = verts[v].numWeights;
+    for (u32 w = 0; w < WS_MAX_JOINT_INFLUENCES; ++w) {
+      outVerts[v].jointIndex[w] = verts[v].jointIndex[w];
+      outVerts[v].influence[w] = verts[v].influence[w];
+    }
+  }
+  wsJoint* outJoints = (wsJoint*)blockData[WS_MESH_BLOCK_JOINTS];
+  u32* outNames = (u32*)blockData[WS_MESH_BLOCK_JOINT_NAMES];
+  for (u32 j = 0; j < numJoints; ++j) {
+    outJoints[j].start = joints[j].start;
+    outJoints[j].startRel = joints[j].startRel;
+    outJoints[j].end = joints[j].end;
+    outJoints[j].rot = joints[j].rot;
+    outJoints[j].parent = joints[j].parent;
+  }
+  if (numJoints > 0) {
+    memcpy(blockData[WS_MESH_BLOCK_JOINT_LOCATIONS], jointLocations, sizes[WS_MESH_BLOCK_JOINT_LOCATIONS]);
+    memcpy(blockData[WS_MESH_BLOCK_JOINT_ROTATIONS], jointRotations, sizes[WS_MESH_BLOCK_JOINT_ROTATIONS]);
+    for (wsHashMap<u32>::iterator it = jointIndices->begin(); it.isValid(); ++it) { outNames[*it] = it.getKey(); }
+  }
+  wsCookedMaterial* outMats = (wsCookedMaterial*)blockData[WS_MESH_BLOCK_MATERIALS];
+  wsCookedProperty* outProps = (wsCookedProperty*)blockData[WS_MESH_BLOCK_PROPERTIES];
+  u32* outCounts = (u32*)blockData[WS_MESH_BLOCK_TRIANGLE_COUNTS];
+  u8* outTris = (u8*)blockData[WS_MESH_BLOCK_TRIANGLES];
+  char* outStrings = (char*)blockData[WS_MESH_BLOCK_STRINGS];
+  u32 stringsUsed = 0;
+  for (u32 m = 0; m < numMaterials; ++m) {
+    outMats[m].ambient = mats[m].ambient;
+    outMats[m].diffuse = mats[m].diffuse;
+    outMats[m].specular = mats[m].specular;
+    outMats[m].emissive = mats[m].emissive;
+    outMats[m].shininess = mats[m].shininess;
+    outMats[m].colorMapPath = outMats[m].normalMapPath = WS_COOKED_NO_STRING;
+    if (mats[m].colorMapPath) {
+      outMats[m].colorMapPath = stringsUsed;
+      strcpy(outStrings + stringsUsed, mats[m].colorMapPath);
+      stringsUsed += strlen(mats[m].colorMapPath) + 1;
+    }
+    if (mats[m].normalMapPath) {
+      outMats[m].normalMapPath = stringsUsed;
+      strcpy(outStrings + stringsUsed, mats[m].normalMapPath);
+      stringsUsed += strlen(mats[m].normalMapPath) + 1;
+    }
+    if (mats[m].properties) {
+      for (wsHashMap<f32>::iterator it = mats[m].properties->begin(); it.isValid(); ++it) {
+        outProps->name = it.getKey();
+        outProps->value = *it;
+        ++outProps;
+        ++outMats[m].numProperties;
+      }
+    }
+    outCounts[m] = mats[m].numTriangles;
+    memcpy(outTris, mats[m].tris, sizeof(wsTriangle)*mats[m].numTriangles);
+    outTris += sizeof(wsTriangle)*mats[m].numTriangles;
+  }
+  wsCookedLOD* outLODs = (wsCookedLOD*)blockData[WS_MESH_BLOCK_LODS];
+  for (u32 l = 0; l < numLODs; ++l) {
+    outLODs[l].totalTriangles = lods[l].totalTriangles;
+    outLODs[l].error = lods[l].error;
+    for (u32 m = 0; m < numMaterials; ++m) {
+      outCounts[(l+1)*numMaterials + m] = lods[l].numTriangles[m];
+      memcpy(outTris, lods[l].tris[m], sizeof(wsTriangle)*lods[l].numTriangles[m]);
+      outTris += sizeof(wsTriangle)*lods[l].numTriangles[m];
+    }
+  }
+  bool written = wsWriteCooked(destPath, &header, sizeof(header), header.blocks, blockData, WS_MESH_NUM_BLOCKS);
+  for (u32 b = 0; b < WS_MESH_NUM_BLOCKS; ++b) { free(blockData[b]); }
+  return written;
 }
-
-
@@ -37,6 +37,7 @@
 
 #include "../wsConfig.h"
 #include "wsAsset.h"
+#include "../wsUtils/wsMappedFile.h"
 
 struct wsVert {
   vec4 pos; //  (BUFFER OFFSET = 0)
@@ -44,8 +45,19 @@ struct wsVert {
   f32 tex[2]; //  UV texture coordinates   (BUFFER OFFSET = 32)
   //  Joint Indices and Weights for animation
   i32 numWeights; //    (BUFFER OFFSET = 40)
-  i32 jointIndex[WS_MAX_JOINT_INFLUENCES];  //    (BUFFER OFFSET = 44, 60)
-  f32 influence[WS_MAX_JOINT_INFLUENCES];   //    (BUFFER OFFSET = 76, 92)
+  i32 jointIndex[WS_MAX_JOINT_INFLUENCES];  //    (BUFFER OFFSET = 44)
+  f32 influence[WS_MAX_JOINT_INFLUENCES];   //    (BUFFER OFFSET = 60)
+};
+
+//  The compact form of wsVert uploaded when WS_PACK_VERTICES is set; see wsPackVertices(...)
+struct wsPackedVert {
+  f32 pos[3];   //  (BUFFER OFFSET = 0)
+  i16 norm[2];  //  Octahedral unit normal, snorm16  (BUFFER OFFSET = 12)
+  u16 tex[2];   //  UV texture coordinates as half floats  (BUFFER OFFSET = 16)
+  u8 jointIndex[4]; //  (BUFFER OFFSET = 20)
+  u8 influence[4];  //  unorm8, summing to exactly 255  (BUFFER OFFSET = 24)
+  u8 numWeights;    //  (BUFFER OFFSET = 28)
+  u8 padding[3];
 };
 
 struct wsTriangle {
@@ -59,6 +71,9 @@ struct wsMaterial {
   vec4 emissive;
   wsTriangle* tris;
   wsHashMap<f32> *properties;
+  //  Texture files, or WS_NULL for a map the material does not use
+  const char* colorMapPath;
+  const char* normalMapPath;
   u32 shininess;
   u32 colorMap;
   u32 normalMap;
@@ -66,6 +81,15 @@ struct wsMaterial {
   u32 numProperties;
 };
 
+//  A simplified version of the mesh, drawn in place of it from far away. Its
+//  triangles index the mesh's own vertices.
+struct wsMeshLOD {
+  wsTriangle** tris;  //  One list for each material
+  u32* numTriangles;  //  One count for each material
+  u32 totalTriangles;
+  f32 error;  //  Farthest the surface moved, as a share of the bounding radius
+};
+
 struct wsJoint {
   vec4 start;
   vec4 startRel;
@@ -75,40 +99,88 @@ struct wsJoint {
   i32 parent;
 };
 
+//  A mesh loaded from a cooked .wsMeshBin points into the file's shared mapping for its
+//  vertices, triangles and joints, which are then read-only. Only the materials, levels
+//  of detail and lookup tables are built on the memory stack.
 class wsMesh: public wsAsset {
   private:
+    wsMappedFile cooked;
     wsVert* verts;
     wsMaterial* mats;
     wsJoint* joints;
     vec4* jointLocations;
     quat* jointRotations;
     wsHashMap<u32>* jointIndices;
+    wsMeshLOD* lods;
     vec4 defaultPos;
     vec4 bounds;
     u32 numVerts;
     u32 numMaterials;
     u32 numJoints;
-    const void loadSTL(const char* filepath);
-    const void loadWhipstitch(const char* filepath);
+    u32 numLODs;
+    bool loaded;
+    //  Leaves the mesh with nothing to draw, after a file which could not be loaded
+    void clear();
+    //  Maps the mesh's cooked file, returning false if there is none up to date
+    bool loadCooked(const char* filepath);
+    //  Each returns false, after logging why, if the file is missing or malformed
+    bool loadSTL(const char* filepath);
+    bool loadWhipstitch(const char* filepath);
   public:
     //  Constructor
-    wsMesh(const char* filepath, const u32 format = WS_MESH_FORMAT_WHIPSTITCH);
+    //  Loading touches no graphics state, so the mesh may be loaded on any thread;
+    //  wsRenderer.loadTextures(...) loads its texture maps on the main thread. The cooked
+    //  file is used in place of a .wsMesh or .stl when useCooked is set and one is up to date.
+    //  Otherwise the mesh is optimized and given levels of detail as it loads, as
+    //  WS_OPTIMIZE_MESHES and WS_GENERATE_LODS say, unless prepare is clear; then it
+    //  keeps the order it was exported in.
+    wsMesh(const char* filepath, const u32 format = WS_MESH_FORMAT_WHIPSTITCH, const bool useCooked = WS_USE_COOKED_ASSETS,
+           const bool prepare = true);
     ~wsMesh();
     //  Getters
     const vec4* getBounds() const { return &bounds; }
     const vec4& getDefaultPos() const { return defaultPos; }
     const wsJoint* getJoint(const char* jointName) { return &joints[jointIndices->retrieve(wsHash(jointName))]; }
+    const wsJoint* getJoint(wsNameHandle jointName) { return &joints[jointIndices->retrieve(wsNames.getHash(jointName))]; }
     const wsJoint* getJoints() const { return joints; }
     const u32 getJointIndex(const char* jointName) { return jointIndices->retrieve(wsHash(jointName)); }
+    const u32 getJointIndex(wsNameHandle jointName) { return jointIndices->retrieve(wsNames.getHash(jointName)); }
     const vec4* getJointLocations() { return jointLocations; }
     const quat* getJointRotations() { return jointRotations; }
+    //  Level l of detail is getLODs()[l-1]; level 0 is the materials' own triangles
+    const wsMeshLOD* getLODs() const { return lods; }
+    //  Memory unmap() gives back; a mesh which lies in a mounted pack owns none of it
+    u64 getMappedBytes() const { return cooked.isView() ? 0 : cooked.getSize(); }
     const wsMaterial* getMats() const { return mats; }
+    wsMaterial* getMats() { return mats; }
     const wsVert* getVerts() const { return verts; }
     u32 getNumJoints() const { return numJoints; }
+    u32 getNumLODs() const { return numLODs; }
     u32 getNumMaterials() const { return numMaterials; }
     u32 getNumVerts() const { return numVerts; }
+    //  True if the mesh's data lies in a cooked file's read-only mapping
+    bool isCooked() const { return cooked.isOpen(); }
+    //  False if its file was missing or malformed, leaving it with nothing to draw
+    bool isLoaded() const { return loaded; }
     //  Operational Methods
-    void errorCheck(const i32 my);
+    //  Welds identical vertices, reorders each material's triangles for the vertex
+    //  cache and the vertices for fetch order, and drops unused vertices
+    void optimize();
+    //  Builds up to maxLODs simplified levels, each keeping WS_LOD_REDUCTION of the
+    //  triangles of the one before, stopping early once a level saves too little
+    void generateLODs(const u32 maxLODs = WS_MAX_LODS);
+    //  Maps an unmapped mesh's cooked file again, into the tables built when it was first
+    //  loaded. Returns false, leaving it unmapped, if the file has changed shape since.
+    bool remap(const char* filepath);
+    //  Gives back a cooked mesh's mapping, keeping its tables, counts and bounds. Its
+    //  vertices, triangles and joints are WS_NULL until remap(...).
+    void unmap();
+    //  Writes the mesh as it stands to a cooked .wsMeshBin
+    bool writeCooked(const char* destPath);
 };
 
+//  The format of a mesh file, judged by its extension: WS_MESH_FORMAT_STL for ".stl" in
+//  any case, otherwise WS_MESH_FORMAT_WHIPSTITCH
+u32 wsMeshFormat(const char* filepath);
+
 #endif /* WS_MESH_H_ */
@@ -0,0 +1,534 @@
+/*
+ * wsMeshOptimizer.cpp
+ *
+ *    This file implements the mesh optimization passes of the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsMeshOptimizer.h"
+#include "../wsGameFlow/wsThreadPool.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Vertices are compared up to the end of their last field, leaving out any padding
+#define WS_VERT_COMPARE_BYTES (offsetof(wsVert, influence) + sizeof(f32)*WS_MAX_JOINT_INFLUENCES)
+
+//  Scores with a valence above this are all the same as it
+#define WS_MAX_SCORED_VALENCE 32
+
+//  Welding grid cells are this many epsilons wide, so most points lie far enough inside
+//  their own cell that none of its neighbours need be searched
+#define WS_WELD_CELL_EPSILONS 16.0f
+//  Most cells along an axis, which keeps cell coordinates well inside an i32
+#define WS_WELD_MAX_CELLS 1.0e9f
+//  Points recently kept, looked up by their exact bits before the grid is searched;
+//  formats such as STL repeat each corner within a few triangles
+#define WS_WELD_RECENT_POINTS 1024
+
+//  Fewest vertices worth handing to another thread while computing normals
+#define WS_MIN_NORMAL_CHUNK 4096
+
+f32 wsComputeACMR(const u32* indices, u32 numIndices, u32 numVerts, u32 cacheSize) {
+  if (numIndices < 3) { return 0.0f; }
+  //  A vertex is still cached if fewer than cacheSize others have entered since it did
+  u32* entered = (u32*)calloc(numVerts, sizeof(u32));
+  wsAssert(entered, "Could not allocate the cache simulation.");
+  u32 time = cacheSize + 1;
+  u32 misses = 0;
+  for (u32 i = 0; i < numIndices; ++i) {
+    u32 v = indices[i];
+    if (time - entered[v] > cacheSize) {
+      entered[v] = time++;
+      ++misses;
+    }
+  }
+  free(entered);
+  return (f32)misses / (f32)(numIndices / 3);
+}
+
+void wsOptimizeVertexCache(u32* dest, const u32* indices, u32 numIndices, u32 numVerts) {
+  const u32 numTris = numIndices / 3;
+  if (numTris == 0) { return; }
+  //  The tables of Forsyth's scoring function
+  f32 cacheScores[WS_VERTEX_CACHE_SIZE];
+  f32 valenceScores[WS_MAX_SCORED_VALENCE + 1];
+  for (u32 i = 0; i < WS_VERTEX_CACHE_SIZE; ++i) {
+    //  The last triangle's vertices score the same, so its winding order does not matter
+    cacheScores[i] = (i < 3) ? 0.75f : powf(1.0f - (f32)(i - 3) / (WS_VERTEX_CACHE_SIZE - 3), 1.5f);
+  }
+  valenceScores[0] = 0.0f;
+  for (u32 i = 1; i <= WS_MAX_SCORED_VALENCE; ++i) {
+    //  Vertices with few triangles left are finished off first
+    valenceScores[i] = 2.0f / sqrtf((f32)i);
+  }
+  //  Each vertex lists the triangles not yet written which use it; the first
+  //  numActive entries of its range in triLists
+  u32* listStarts = (u32*)calloc(numVerts + 1, sizeof(u32));
+  u32* numActive = (u32*)calloc(numVerts, sizeof(u32));
+  i32* cachePos = (i32*)malloc(sizeof(i32)*numVerts);
+  f32* vertScores = (f32*)malloc(sizeof(f32)*numVerts);
+  u32* triLists = (u32*)malloc(sizeof(u32)*numTris*3);
+  f32* triScores = (f32*)malloc(sizeof(f32)*numTris);
+  bool* triWritten = (bool*)calloc(numTris, sizeof(bool));
+  wsAssert((listStarts && numActive && cachePos && vertScores && triLists && triScores && triWritten),
+            "Could not allocate the vertex cache optimizer.");
+  for (u32 i = 0; i < numTris*3; ++i) { ++numActive[indices[i]]; }
+  for (u32 v = 0; v < numVerts; ++v) { listStarts[v+1] = listStarts[v] + numActive[v]; }
+  memset(numActive, 0, sizeof(u32)*numVerts);
+  for (u32 t = 0; t < numTris; ++t) {
+    for (u32 c = 0; c < 3; ++c) {
+      u32 v = indices[t*3+c];
+      triLists[listStarts[v] + numActive[v]++] = t;
+    }
+  }
+  for (u32 v = 0; v < numVerts; ++v) {
+    cachePos[v] = -1;
+    vertScores[v] = valenceScores[wsMin(numActive[v], (u32)WS_MAX_SCORED_VALENCE)];
+  }
+  i32 bestTri = -1;
+  f32 bestScore = -1.0f;
+  for (u32 t = 0; t < numTris; ++t) {
+    triScores[t] = vertScores[indices[t*3]] + vertScores[indices[t*3+1]] + vertScores[indices[t*3+2]];
+    if (triScores[t] > bestScore) {
+      bestScore = triScores[t];
+      bestTri = t;
+    }
+  }
+  u32 cache[WS_VERTEX_CACHE_SIZE + 3];
+  u32 newCache[WS_VERTEX_CACHE_SIZE + 3];
+  u32 cacheLength = 0;
+  u32 nextUnwritten = 0;
+  for (u32 written = 0; written < numTris; ++written) {
+    if (bestTri < 0) {
+      //  Nothing in the cache has triangles left; carry on in the original order
+      while (triWritten[nextUnwritten]) { ++nextUnwritten; }
+      bestTri = nextUnwritten;
+    }
+    const u32* tri = &indices[bestTri*3];
+    dest[written*3] = tri[0];
+    dest[written*3+1] = tri[1];
+    dest[written*3+2] = tri[2];
+    triWritten[bestTri] = true;
+    //  Take the triangle off the lists of its vertices
+    for (u32 c = 0; c < 3; ++c) {
+      u32 v = tri[c];
+      u32* list = &triLists[listStarts[v]];
+      for (u32 i = 0; i < numActive[v]; ++i) {
+        if (list[i] == (u32)bestTri) {
+          list[i] = list[--numActive[v]];
+          break;
+        }
+      }
+    }
+    //  The triangle's vertices move to the front of the cache, pushing the rest back
+    u32 newLength = 0;
+    for (u32 c = 0; c < 3; ++c) {
+      //  A degenerate triangle names a vertex twice
+      if (c == 0 || (tri[c] != tri[0] && (c == 1 || tri[c] != tri[1]))) { newCache[newLength++] = tri[c]; }
+    }
+    for (u32 i = 0; i < cacheLength; ++i) {
+      u32 v = cache[i];
+      if (v != tri[0] && v != tri[1] && v != tri[2]) { newCache[newLength++] = v; }
+    }
+    //  Rescore every vertex that moved, including the ones pushed out
+    for (u32 i = 0; i < newLength; ++i) {
+      u32 v = newCache[i];
+      cachePos[v] = (i < WS_VERTEX_CACHE_SIZE) ? (i32)i : -1;
+      if (numActive[v] == 0) {
+        vertScores[v] = -1.0f;
+        continue;
+      }
+      vertScores[v] = valenceScores[wsMin(numActive[v], (u32)WS_MAX_SCORED_VALENCE)];
+      if (cachePos[v] >= 0) { vertScores[v] += cacheScores[cachePos[v]]; }
+    }
+    //  The next triangle is the best of those which use a cached vertex
+    bestTri = -1;
+    bestScore = -1.0f;
+    for (u32 i = 0; i < newLength; ++i) {
+      u32 v = newCache[i];
+      const u32* list = &triLists[listStarts[v]];
+      for (u32 j = 0; j < numActive[v]; ++j) {
+        u32 t = list[j];
+        triScores[t] = vertScores[indices[t*3]] + vertScores[indices[t*3+1]] + vertScores[indices[t*3+2]];
+        if (triScores[t] > bestScore) {
+          bestScore = triScores[t];
+          bestTri = t;
+        }
+      }
+    }
+    cacheLength = wsMin(newLength, (u32)WS_VERTEX_CACHE_SIZE);
+    memcpy(cache, newCache, sizeof(u32)*cacheLength);
+  }
+  free(listStarts);
+  free(numActive);
+  free(cachePos);
+  free(vertScores);
+  free(triLists);
+  free(triScores);
+  free(triWritten);
+}
+
+u32 wsOptimizeVertexFetch(u32* remap, u32 numAssigned, const u32* indices, u32 numIndices) {
+  for (u32 i = 0; i < numIndices; ++i) {
+    if (remap[indices[i]] == WS_NO_VERTEX) {
+      remap[indices[i]] = numAssigned++;
+    }
+  }
+  return numAssigned;
+}
+
+u32 wsWeldVertices(wsVert* verts, u32 numVerts, u32* remap) {
+  //  An open-addressed table of the vertices kept so far, at most half full
+  u32 tableSize = 1;
+  while (tableSize < numVerts*2) { tableSize <<= 1; }
+  u32* table = (u32*)malloc(sizeof(u32)*tableSize);
+  wsAssert(table, "Could not allocate the vertex welding table.");
+  memset(table, 0xFF, sizeof(u32)*tableSize);
+  u32 numUnique = 0;
+  for (u32 v = 0; v < numVerts; ++v) {
+    u32 slot = wsHashBuffer(&verts[v], WS_VERT_COMPARE_BYTES) & (tableSize - 1);
+    while (table[slot] != WS_NO_VERTEX && memcmp(&verts[table[slot]], &verts[v], WS_VERT_COMPARE_BYTES) != 0) {
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    if (table[slot] == WS_NO_VERTEX) {
+      //  Kept vertices are packed toward the front, never past the one being read
+      if (numUnique != v) { verts[numUnique] = verts[v]; }
+      table[slot] = numUnique++;
+    }
+    remap[v] = table[slot];
+  }
+  free(table);
+  return numUnique;
+}
+
+//  The welding grid: each cell holds a list of the points kept within it, chained
+//  through next, and the table holds the first point of each cell in use
+struct wsWeldRecent {
+  u32 bits[3];
+  u32 index;
+};
+
+struct wsWeldGrid {
+  const f32* points;
+  u32* table;
+  u32* next;
+  u32 tableSize;
+  u32 numCells;
+  f32 lower[3];
+  f32 invCellSize;
+  //  The cell a point lies in; anything outside the grid, or not a number, is clamped to it
+  void findCell(i32* cell, f32* offset, const f32* point) const {
+    for (u32 a = 0; a < 3; ++a) {
+      f32 f = (point[a] - lower[a]) * invCellSize;
+      f = (f > 0.0f) ? ((f < WS_WELD_MAX_CELLS) ? f : WS_WELD_MAX_CELLS) : 0.0f;
+      cell[a] = (i32)f;
+      offset[a] = f - (f32)cell[a];
+    }
+  }
+  static u32 hashCell(const i32* cell) {
+    u32 h = (u32)cell[0]*0x8DA6B343u ^ (u32)cell[1]*0xD8163841u ^ (u32)cell[2]*0xCB1AB31Fu;
+    return h ^ (h >> 16);
+  }
+  //  The slot holding the cell's list, or the empty slot where it belongs
+  u32 findSlot(const i32* cell) const {
+    u32 slot = hashCell(cell) & (tableSize - 1);
+    while (table[slot] != WS_NO_VERTEX) {
+      i32 other[3];
+      f32 offset[3];
+      findCell(other, offset, &points[table[slot]*3]);
+      if (other[0] == cell[0] && other[1] == cell[1] && other[2] == cell[2]) { break; }
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    return slot;
+  }
+  //  Doubles the table once it is half full
+  void grow() {
+    u32* oldTable = table;
+    u32 oldSize = tableSize;
+    tableSize *= 2;
+    table = (u32*)malloc(sizeof(u32)*tableSize);
+    wsAssert(table, "Could not grow the welding grid.");
+    memset(table, 0xFF, sizeof(u32)*tableSize);
+    for (u32 s = 0; s < oldSize; ++s) {
+      if (oldTable[s] == WS_NO_VERTEX) { continue; }
+      i32 cell[3];
+      f32 offset[3];
+      findCell(cell, offset, &points[oldTable[s]*3]);
+      u32 slot = hashCell(cell) & (tableSize - 1);
+      while (table[slot] != WS_NO_VERTEX) { slot = (slot + 1) & (tableSize - 1); }
+      table[slot] = oldTable[s];
+    }
+    free(oldTable);
+  }
+};
+
+u32 wsWeldPositions(f32* points, u32 numPoints, u32* remap, f32 epsilon) {
+  if (numPoints == 0) { return 0; }
+  wsWeldGrid grid;
+  f32 upper[3];
+  for (u32 a = 0; a < 3; ++a) { grid.lower[a] = upper[a] = points[a]; }
+  for (u32 p = 1; p < numPoints; ++p) {
+    for (u32 a = 0; a < 3; ++a) {
+      if (points[p*3+a] < grid.lower[a]) { grid.lower[a] = points[p*3+a]; }
+      if (points[p*3+a] > upper[a]) { upper[a] = points[p*3+a]; }
+    }
+  }
+  f32 cellSize = epsilon*WS_WELD_CELL_EPSILONS;
+  for (u32 a = 0; a < 3; ++a) { cellSize = wsMax(cellSize, (upper[a] - grid.lower[a]) / WS_WELD_MAX_CELLS); }
+  if (!(cellSize > 0.0f)) { cellSize = 1.0f; }
+  grid.invCellSize = 1.0f / cellSize;
+  //  How near the edge of its cell a point must be for the neighbour across it to be searched
+  const f32 margin = epsilon*grid.invCellSize;
+  grid.points = points;
+  grid.tableSize = 64;
+  while (grid.tableSize < numPoints/4) { grid.tableSize <<= 1; }
+  grid.table = (u32*)malloc(sizeof(u32)*grid.tableSize);
+  grid.next = (u32*)malloc(sizeof(u32)*numPoints);
+  wsAssert(grid.table && grid.next, "Could not allocate the welding grid.");
+  memset(grid.table, 0xFF, sizeof(u32)*grid.tableSize);
+  grid.numCells = 0;
+  //  Kept points are more than epsilon apart, so one identical to a kept point welds
+  //  to that point alone, just as the grid would find
+  wsWeldRecent recent[WS_WELD_RECENT_POINTS];
+  for (u32 r = 0; r < WS_WELD_RECENT_POINTS; ++r) { recent[r].index = WS_NO_VERTEX; }
+  u32 numUnique = 0;
+  for (u32 p = 0; p < numPoints; ++p) {
+    const f32 point[3] = { points[p*3], points[p*3+1], points[p*3+2] };
+    u32 bits[3];
+    memcpy(bits, point, sizeof(bits));
+    u32 r = bits[0]*0x8DA6B343u ^ bits[1]*0xD8163841u ^ bits[2]*0xCB1AB31Fu;
+    r = (r ^ (r >> 15)) & (WS_WELD_RECENT_POINTS - 1);
+    if (recent[r].index != WS_NO_VERTEX && memcmp(recent[r].bits, bits, sizeof(bits)) == 0) {
+      remap[p] = recent[r].index;
+      continue;
+    }
+    i32 cell[3];
+    f32 offset[3];
+    grid.findCell(cell, offset, point);
+    i32 side[3];
+    for (u32 a = 0; a < 3; ++a) {
+      side[a] = (offset[a] < margin) ? -1 : ((1.0f - offset[a] < margin) ? 1 : 0);
+    }
+    //  The point's own cell first, then any neighbours it lies within epsilon of
+    u32 match = WS_NO_VERTEX;
+    for (u32 n = 0; n < 8 && match == WS_NO_VERTEX; ++n) {
+      if (((n & 1) && !side[0]) || ((n & 2) && !side[1]) || ((n & 4) && !side[2])) { continue; }
+      const i32 neighbour[3] = { cell[0] + ((n & 1) ? side[0] : 0), cell[1] + ((n & 2) ? side[1] : 0),
+                                  cell[2] + ((n & 4) ? side[2] : 0) };
+      u32 slot = grid.findSlot(neighbour);
+      for (u32 u = grid.table[slot]; u != WS_NO_VERTEX; u = grid.next[u]) {
+        if (fabsf(points[u*3] - point[0]) <= epsilon && fabsf(points[u*3+1] - point[1]) <= epsilon &&
+            fabsf(points[u*3+2] - point[2]) <= epsilon) {
+          match = u;
+          break;
+        }
+      }
+    }
+    if (match == WS_NO_VERTEX) {
+      //  Kept points are packed toward the front, never past the one being read
+      match = numUnique++;
+      for (u32 a = 0; a < 3; ++a) { points[match*3+a] = point[a]; }
+      u32 slot = grid.findSlot(cell);
+      grid.next[match] = grid.table[slot];
+      grid.table[slot] = match;
+      if (grid.next[match] == WS_NO_VERTEX && ++grid.numCells*2 > grid.tableSize) { grid.grow(); }
+    }
+    remap[p] = match;
+    memcpy(recent[r].bits, bits, sizeof(bits));
+    recent[r].index = match;
+  }
+  free(grid.table);
+  free(grid.next);
+  return numUnique;
+}
+
+void wsComputeSmoothNormals(wsVert* verts, u32 numVerts, const u32* indices, u32 numIndices) {
+  //  The corners around each vertex, listed from first[v] to first[v+1]
+  u32* first = (u32*)calloc(numVerts + 1, sizeof(u32));
+  u32* corners = (u32*)malloc(sizeof(u32)*(numIndices ? numIndices : 1));
+  wsAssert(first && corners, "Could not allocate the vertices' lists of corners.");
+  for (u32 i = 0; i < numIndices; ++i) { ++first[indices[i]+1]; }
+  for (u32 v = 0; v < numVerts; ++v) { first[v+1] += first[v]; }
+  for (u32 i = 0; i < numIndices; ++i) { corners[first[indices[i]]++] = i; }
+  //  Filling each list moved its start to the start of the next
+  for (u32 v = numVerts; v > 0; --v) { first[v] = first[v-1]; }
+  first[0] = 0;
+  wsRunParallelChunks(numVerts, WS_MIN_NORMAL_CHUNK, [&](u32 begin, u32 end) {
+    for (u32 v = begin; v < end; ++v) {
+      f32 sum[3] = { 0.0f, 0.0f, 0.0f };
+      for (u32 c = first[v]; c < first[v+1]; ++c) {
+        const u32 tri = corners[c] - corners[c] % 3;
+        const u32 k = corners[c] % 3;
+        const vec4& p0 = verts[indices[tri + k]].pos;
+        const vec4& p1 = verts[indices[tri + (k+1)%3]].pos;
+        const vec4& p2 = verts[indices[tri + (k+2)%3]].pos;
+        const f32 e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+        const f32 e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+        const f32 n[3] = { e1[1]*e2[2] - e1[2]*e2[1], e1[2]*e2[0] - e1[0]*e2[2], e1[0]*e2[1] - e1[1]*e2[0] };
+        const f32 length = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (length > 0.0f) {
+          //  The angle at this corner, in degrees, over the length which normalizes the
+          //  face's normal
+          const f32 weight = wsArcTan(length, e1[0]*e2[0] + e1[1]*e2[1] + e1[2]*e2[2]) / length;
+          for (u32 a = 0; a < 3; ++a) { sum[a] += n[a]*weight; }
+        }
+      }
+      f32 length = sqrtf(sum[0]*sum[0] + sum[1]*sum[1] + sum[2]*sum[2]);
+      //  A vertex of no face with any area still needs a unit normal
+      if (length > 0.0f) {
+        verts[v].norm.x = sum[0] / length;
+        verts[v].norm.y = sum[1] / length;
+        verts[v].norm.z = sum[2] / length;
+      }
+      else {
+        verts[v].norm.x = verts[v].norm.y = 0.0f;
+        verts[v].norm.z = 1.0f;
+      }
+      verts[v].norm.w = 1.0f;
+    }
+  });
+  free(first);
+  free(corners);
+}
+
+//  Folds the lower half of the octahedron over the upper half
+static void wsFoldOctahedral(f32& u, f32& v) {
+  f32 foldedU = (1.0f - fabsf(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+  f32 foldedV = (1.0f - fabsf(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+  u = foldedU;
+  v = foldedV;
+}
+
+void wsPackOctahedral(i16* dest, const vec4& norm) {
+  f32 sum = fabsf(norm.x) + fabsf(norm.y) + fabsf(norm.z);
+  if (sum == 0.0f) {
+    dest[0] = dest[1] = 0;
+    return;
+  }
+  f32 u = norm.x / sum;
+  f32 v = norm.y / sum;
+  if (norm.z < 0.0f) { wsFoldOctahedral(u, v); }
+  //  Rounding each coordinate on its own is not always closest once decoded, so try
+  //  the four neighbouring codes and keep whichever points nearest the normal
+  f32 invLength = 1.0f / sqrtf(norm.x*norm.x + norm.y*norm.y + norm.z*norm.z);
+  f32 bestDot = -2.0f;
+  i16 base[2] = { (i16)floorf(u*32767.0f), (i16)floorf(v*32767.0f) };
+  for (u32 i = 0; i < 4; ++i) {
+    i16 candidate[2] = { (i16)wsMin(base[0] + (i32)(i & 1), 32767), (i16)wsMin(base[1] + (i32)(i >> 1), 32767) };
+    vec4 decoded = wsUnpackOctahedral(candidate);
+    f32 dot = (decoded.x*norm.x + decoded.y*norm.y + decoded.z*norm.z) * invLength;
+    if (dot > bestDot) {
+      bestDot = dot;
+      dest[0] = candidate[0];
+      dest[1] = candidate[1];
+    }
+  }
+}
+
+vec4 wsUnpackOctahedral(const i16* packed) {
+  f32 u = wsMax(packed[0] / 32767.0f, -1.0f);
+  f32 v = wsMax(packed[1] / 32767.0f, -1.0f);
+  f32 z = 1.0f - fabsf(u) - fabsf(v);
+  if (z < 0.0f) { wsFoldOctahedral(u, v); }
+  f32 invLength = 1.0f / sqrtf(u*u + v*v + z*z);
+  return vec4(u*invLength, v*invLength, z*invLength, 0.0f);
+}
+
+u16 wsFloatToHalf(f32 value) {
+  i_f_hybrid bits(value);
+  u32 sign = ((u32)bits.i >> 16) & 0x8000;
+  u32 magnitude = (u32)bits.i & 0x7FFFFFFF;
+  if (magnitude >= 0x7F800000) {
+    //  Infinity stays infinity; NaN stays a quiet NaN
+    return (u16)(sign | 0x7C00 | ((magnitude > 0x7F800000) ? 0x0200 : 0));
+  }
+  if (magnitude >= 0x477FF000) {
+    //  65520 and above round past the largest half, 65504
+    return (u16)(sign | 0x7C00);
+  }
+  if (magnitude < 0x38800000) {
+    //  Below 2^-14 the half is denormal, counting in steps of 2^-24
+    bits.i = (i32)magnitude;
+    return (u16)(sign | (u32)lrintf(bits.f * 16777216.0f));
+  }
+  //  Rebias the exponent from 127 to 15 and round the mantissa to nearest even;
+  //  a carry out of the mantissa correctly bumps the exponent
+  u32 half = (magnitude - 0x38000000) >> 13;
+  u32 rest = magnitude & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) { ++half; }
+  return (u16)(sign | half);
+}
+
+f32 wsHalfToFloat(u16 value) {
+  u32 sign = (u32)(value & 0x8000) << 16;
+  u32 exponent = (value >> 10) & 0x1F;
+  u32 mantissa = value & 0x03FF;
+  if (exponent == 0) {
+    f32 denormal = mantissa * (1.0f / 16777216.0f);
+    return sign ? -denormal : denormal;
+  }
+  i_f_hybrid bits((i32)(sign | ((exponent == 31) ? 0x7F800000 : ((exponent + 112) << 23)) | (mantissa << 13)));
+  return bits.f;
+}
+
+void wsPackVertices(wsPackedVert* dest, const wsVert* verts, u32 numVerts) {
+  for (u32 v = 0; v < numVerts; ++v) {
+    const wsVert& src = verts[v];
+    wsPackedVert& my = dest[v];
+    my.pos[0] = src.pos.x;
+    my.pos[1] = src.pos.y;
+    my.pos[2] = src.pos.z;
+    wsPackOctahedral(my.norm, src.norm);
+    my.tex[0] = wsFloatToHalf(src.tex[0]);
+    my.tex[1] = wsFloatToHalf(src.tex[1]);
+    my.padding[0] = my.padding[1] = my.padding[2] = 0;
+    //  Renormalize the weights, then round them so they still sum to one; whatever
+    //  rounding leaves over goes to the heaviest weight, where it matters least
+    u32 numWeights = wsMin((u32)wsMax(src.numWeights, 0), (u32)WS_MAX_JOINT_INFLUENCES);
+    f32 totalWeight = 0.0f;
+    for (u32 w = 0; w < numWeights; ++w) {
+      totalWeight += wsMax(src.influence[w], 0.0f);
+    }
+    i32 remaining = 255;
+    u32 heaviest = 0;
+    for (u32 w = 0; w < 4; ++w) {
+      if (w < numWeights && totalWeight > 0.0f) {
+        wsAssert(src.jointIndex[w] >= 0 && src.jointIndex[w] < 256, "Joint index does not fit the packed vertex format.");
+        my.jointIndex[w] = (u8)src.jointIndex[w];
+        my.influence[w] = (u8)lrintf(wsMax(src.influence[w], 0.0f) / totalWeight * 255.0f);
+      }
+      else {
+        my.jointIndex[w] = 0;
+        my.influence[w] = 0;
+      }
+      remaining -= my.influence[w];
+      if (my.influence[w] > my.influence[heaviest]) { heaviest = w; }
+    }
+    my.numWeights = (totalWeight > 0.0f) ? (u8)numWeights : 0;
+    if (my.numWeights) { my.influence[heaviest] = (u8)(my.influence[heaviest] + remaining); }
+  }
+}
@@ -0,0 +1,100 @@
+/*
+ * wsMeshOptimizer.h
+ *
+ *    This file declares the mesh optimization passes of the Whipstitch Game Engine,
+ *    which wsMesh::optimize() runs on every mesh as it loads:
+ *      wsWeldVertices(...)         merges vertices which are identical in every field
+ *      wsOptimizeVertexCache(...)  reorders triangles so recently transformed vertices
+ *                                  are reused, after Forsyth's "Linear-Speed Vertex
+ *                                  Cache Optimisation"
+ *      wsOptimizeVertexFetch(...)  renumbers vertices in the order they are first used,
+ *                                  so the vertex buffer is read front to back
+ *    wsComputeACMR(...) simulates a FIFO post-transform cache to measure the result.
+ *    Meshes read from formats which store bare triangles, such as STL, are first
+ *    given vertices by wsWeldPositions(...) and normals by wsComputeSmoothNormals(...).
+ *    wsPackVertices(...) then converts the finished vertices to the 32-byte
+ *    wsPackedVert which wsModel uploads when WS_PACK_VERTICES is set.
+ *
+ *    The passes work on plain index lists, so tools may run them on any mesh data.
+ *    Their scratch memory comes from malloc(...) rather than the frame stack, since
+ *    meshes may be loaded on the asset loader's threads.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MESH_OPTIMIZER_H_
+#define WS_MESH_OPTIMIZER_H_
+
+#include "wsMesh.h"
+
+//  Size of the least-recently-used cache the triangle ordering is scored against
+#define WS_VERTEX_CACHE_SIZE  32
+//  Size of the FIFO cache wsComputeACMR(...) simulates by default
+#define WS_ACMR_CACHE_SIZE    16
+//  Marks a vertex which no index refers to
+#define WS_NO_VERTEX          0xFFFFFFFF
+
+//  Returns the average number of vertices transformed per triangle (the average cache
+//  miss ratio) when the indices are drawn through a FIFO cache of the given size.
+//  Ranges from 3.0, with no reuse at all, down to about 0.5 for a regular grid.
+f32 wsComputeACMR(const u32* indices, u32 numIndices, u32 numVerts, u32 cacheSize = WS_ACMR_CACHE_SIZE);
+
+//  Writes the triangles of indices to dest in an order which reuses the vertex cache.
+//  dest may not overlap indices.
+void wsOptimizeVertexCache(u32* dest, const u32* indices, u32 numIndices, u32 numVerts);
+
+//  Gives each vertex first used by indices the next new position, starting from
+//  numAssigned, and returns the new count. remap must start out filled with
+//  WS_NO_VERTEX; called once for each submesh, it orders the vertices of all of them.
+u32 wsOptimizeVertexFetch(u32* remap, u32 numAssigned, const u32* indices, u32 numIndices);
+
+//  Packs the vertices which are identical in every field into one, setting remap[v]
+//  to the new position of each vertex, and returns the number which remain
+u32 wsWeldVertices(wsVert* verts, u32 numVerts, u32* remap);
+
+//  Packs the points, each three floats, which lie within epsilon of one another on
+//  every axis into one, setting remap[p] to the new position of each point, and returns
+//  the number which remain. Points are found through a hash grid, so the time taken
+//  grows linearly with their number.
+u32 wsWeldPositions(f32* points, u32 numPoints, u32* remap, f32 epsilon);
+
+//  Sets each vertex's normal to the average of the faces around it, each weighted by
+//  the angle it makes at the vertex, so the result does not depend on how the surface
+//  was split into triangles. Faces wind counterclockwise seen from the front. The
+//  vertices are split between the thread pool's threads.
+void wsComputeSmoothNormals(wsVert* verts, u32 numVerts, const u32* indices, u32 numIndices);
+
+//  Converts vertices to the compact layout: positions stay full floats, normals are
+//  octahedron-mapped into two snorm16s, UVs become half floats, and the weights are
+//  renormalized and rounded to unorm8s which sum to exactly 255
+void wsPackVertices(wsPackedVert* dest, const wsVert* verts, u32 numVerts);
+
+//  The conversions wsPackVertices(...) uses, and their inverses, which the vertex
+//  shader mirrors
+void wsPackOctahedral(i16* dest, const vec4& norm);
+vec4 wsUnpackOctahedral(const i16* packed);
+u16 wsFloatToHalf(f32 value);
+f32 wsHalfToFloat(u16 value);
+
+#endif /* WS_MESH_OPTIMIZER_H_ */
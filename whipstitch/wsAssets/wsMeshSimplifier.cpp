@@ -0,0 +1,380 @@
+/*
+ * wsMeshSimplifier.cpp
+ *
+ *    This file implements the level of detail tools of the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsMeshSimplifier.h"
+#include "wsMeshOptimizer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Each pass tries only the cheapest share of its collapses, keeping the order close
+//  to the global one while every pass still removes many triangles
+#define WS_SIMPLIFY_PASS_SHARE 0.5f
+//  A collapse is refused if it turns any remaining triangle further than this cosine
+#define WS_SIMPLIFY_MIN_FACING 0.2f
+//  Weight of the penalty for collapsing vertices whose skin weights differ; a full
+//  difference costs as much as moving the surface by the length of the edge
+#define WS_SIMPLIFY_SKIN_COST 1.0f
+
+//  The sum of squared distances to a set of planes, each weighted by its triangle's area
+struct wsQuadric {
+  f64 a00, a11, a22, a10, a20, a21;
+  f64 b0, b1, b2;
+  f64 c;
+  f64 weight;
+};
+
+struct wsCollapse {
+  f32 cost;
+  u32 from;
+  u32 to;
+};
+
+//  A vertex position tagged with its index, for finding seams by sorting
+struct wsSortedPos {
+  f32 x, y, z;
+  u32 index;
+};
+
+static void wsAddQuadric(wsQuadric& dest, const wsQuadric& my) {
+  dest.a00 += my.a00;  dest.a11 += my.a11;  dest.a22 += my.a22;
+  dest.a10 += my.a10;  dest.a20 += my.a20;  dest.a21 += my.a21;
+  dest.b0 += my.b0;  dest.b1 += my.b1;  dest.b2 += my.b2;
+  dest.c += my.c;
+  dest.weight += my.weight;
+}
+
+//  The mean squared distance from the quadric's planes to a point
+static f64 wsQuadricError(const wsQuadric& q, const vec4& p) {
+  f64 x = p.x, y = p.y, z = p.z;
+  f64 sum = q.a00*x*x + q.a11*y*y + q.a22*z*z + 2.0*(q.a10*x*y + q.a20*x*z + q.a21*y*z)
+          + 2.0*(q.b0*x + q.b1*y + q.b2*z) + q.c;
+  return (q.weight > 0.0) ? fabs(sum) / q.weight : 0.0;
+}
+
+//  The total difference between two vertices' weights, from 0 for the same joints and
+//  weights up to 2 for wholly different joints
+static f32 wsWeightDistance(const wsVert& a, const wsVert& b) {
+  if (a.numWeights <= 0 && b.numWeights <= 0) { return 0.0f; }
+  f32 totalA = 0.0f, totalB = 0.0f;
+  for (i32 i = 0; i < a.numWeights; ++i) { totalA += a.influence[i]; }
+  for (i32 i = 0; i < b.numWeights; ++i) { totalB += b.influence[i]; }
+  if (totalA <= 0.0f || totalB <= 0.0f) { return (totalA == totalB) ? 0.0f : 2.0f; }
+  f32 distance = 0.0f;
+  for (i32 i = 0; i < a.numWeights; ++i) {
+    f32 weightB = 0.0f;
+    for (i32 j = 0; j < b.numWeights; ++j) {
+      if (b.jointIndex[j] == a.jointIndex[i]) { weightB += b.influence[j] / totalB; }
+    }
+    distance += fabsf(a.influence[i] / totalA - weightB);
+  }
+  for (i32 j = 0; j < b.numWeights; ++j) {
+    bool shared = false;
+    for (i32 i = 0; i < a.numWeights; ++i) { shared |= (a.jointIndex[i] == b.jointIndex[j]); }
+    if (!shared) { distance += b.influence[j] / totalB; }
+  }
+  return distance;
+}
+
+//  The unnormalized normal of a triangle
+static vec4 wsTriangleNormal(const vec4& a, const vec4& b, const vec4& c) {
+  f32 e1x = b.x - a.x, e1y = b.y - a.y, e1z = b.z - a.z;
+  f32 e2x = c.x - a.x, e2y = c.y - a.y, e2z = c.z - a.z;
+  return vec4(e1y*e2z - e1z*e2y, e1z*e2x - e1x*e2z, e1x*e2y - e1y*e2x, 0.0f);
+}
+
+static i32 wsCompareCollapses(const void* a, const void* b) {
+  f32 costA = ((const wsCollapse*)a)->cost;
+  f32 costB = ((const wsCollapse*)b)->cost;
+  return (costA < costB) ? -1 : (costA > costB);
+}
+
+static i32 wsComparePositions(const void* a, const void* b) {
+  const wsSortedPos* posA = (const wsSortedPos*)a;
+  const wsSortedPos* posB = (const wsSortedPos*)b;
+  if (posA->x != posB->x) { return (posA->x < posB->x) ? -1 : 1; }
+  if (posA->y != posB->y) { return (posA->y < posB->y) ? -1 : 1; }
+  if (posA->z != posB->z) { return (posA->z < posB->z) ? -1 : 1; }
+  return 0;
+}
+
+static i32 wsCompareEdges(const void* a, const void* b) {
+  u64 edgeA = *(const u64*)a;
+  u64 edgeB = *(const u64*)b;
+  return (edgeA < edgeB) ? -1 : (edgeA > edgeB);
+}
+
+//  Gathers the vertices which share a position (the two sides of a UV or normal
+//  seam) into a ring through nextWedge, each naming the first of them in posOf
+static void wsFindWedges(u32* posOf, u32* nextWedge, const wsVert* verts, u32 numVerts) {
+  wsSortedPos* positions = (wsSortedPos*)malloc(sizeof(wsSortedPos)*numVerts);
+  wsAssert(positions, "Could not allocate the simplifier's position table.");
+  for (u32 v = 0; v < numVerts; ++v) {
+    positions[v].x = verts[v].pos.x;
+    positions[v].y = verts[v].pos.y;
+    positions[v].z = verts[v].pos.z;
+    positions[v].index = v;
+  }
+  qsort(positions, numVerts, sizeof(wsSortedPos), wsComparePositions);
+  for (u32 first = 0; first < numVerts; ) {
+    u32 last = first + 1;
+    while (last < numVerts && wsComparePositions(&positions[first], &positions[last]) == 0) { ++last; }
+    for (u32 i = first; i < last; ++i) {
+      posOf[positions[i].index] = positions[first].index;
+      nextWedge[positions[i].index] = positions[(i + 1 < last) ? i + 1 : first].index;
+    }
+    first = last;
+  }
+  free(positions);
+}
+
+//  Marks the positions which must not move: those used by more than one material, and
+//  those on an edge which does not join exactly two triangles. Seams are edges between
+//  positions, so they do not count as borders here.
+static void wsLockPositions(bool* locked, const u32* indices, const u32* groups, u32 numIndices,
+                            const u32* posOf, u32 numVerts) {
+  const u32 numTris = numIndices / 3;
+  u32* posGroups = (u32*)malloc(sizeof(u32)*numVerts);
+  u64* edges = (u64*)malloc(sizeof(u64)*numIndices);
+  wsAssert((posGroups && edges), "Could not allocate the simplifier's locks.");
+  memset(posGroups, 0xFF, sizeof(u32)*numVerts);
+  u32 numEdges = 0;
+  for (u32 t = 0; t < numTris; ++t) {
+    for (u32 c = 0; c < 3; ++c) {
+      u32 a = posOf[indices[t*3+c]];
+      u32 b = posOf[indices[t*3+(c+1)%3]];
+      if (posGroups[a] == WS_NO_VERTEX) { posGroups[a] = groups[t]; }
+      else if (posGroups[a] != groups[t]) { locked[a] = true; }
+      if (a != b) { edges[numEdges++] = (a < b) ? (((u64)a << 32) | b) : (((u64)b << 32) | a); }
+    }
+  }
+  qsort(edges, numEdges, sizeof(u64), wsCompareEdges);
+  for (u32 e = 0; e < numEdges; ) {
+    u32 count = 1;
+    while (e + count < numEdges && edges[e + count] == edges[e]) { ++count; }
+    if (count != 2) {
+      locked[(u32)(edges[e] >> 32)] = true;
+      locked[(u32)(edges[e] & 0xFFFFFFFF)] = true;
+    }
+    e += count;
+  }
+  free(posGroups);
+  free(edges);
+}
+
+//  Returns the vertex at position to which shares a triangle with vertex from, or
+//  WS_NO_VERTEX if there is none
+static u32 wsFindWedgeTarget(u32 from, u32 to, const u32* indices, const u32* listStarts,
+                              const u32* triLists, const u32* posOf) {
+  for (u32 i = listStarts[from]; i < listStarts[from+1]; ++i) {
+    const u32* tri = &indices[triLists[i]*3];
+    for (u32 c = 0; c < 3; ++c) {
+      if (posOf[tri[c]] == to) { return tri[c]; }
+    }
+  }
+  return WS_NO_VERTEX;
+}
+
+u32 wsSimplify(u32* indices, u32* groups, u32 numIndices, const wsVert* verts, u32 numVerts,
+                u32 targetIndices, f32* error) {
+  *error = 0.0f;
+  if (numIndices <= targetIndices || numVerts == 0) { return numIndices; }
+  //  Collapses work on positions, each carrying all of its wedges along
+  u32* posOf = (u32*)malloc(sizeof(u32)*numVerts);
+  u32* nextWedge = (u32*)malloc(sizeof(u32)*numVerts);
+  bool* locked = (bool*)calloc(numVerts, sizeof(bool));
+  wsQuadric* quadrics = (wsQuadric*)calloc(numVerts, sizeof(wsQuadric));
+  u32* remap = (u32*)malloc(sizeof(u32)*numVerts);
+  bool* touched = (bool*)malloc(sizeof(bool)*numVerts);
+  u32* listStarts = (u32*)malloc(sizeof(u32)*(numVerts + 1));
+  u32* triLists = (u32*)malloc(sizeof(u32)*numIndices);
+  wsCollapse* collapses = (wsCollapse*)malloc(sizeof(wsCollapse)*numVerts);
+  wsAssert((posOf && nextWedge && locked && quadrics && remap && touched && listStarts && triLists && collapses),
+            "Could not allocate the mesh simplifier.");
+  wsFindWedges(posOf, nextWedge, verts, numVerts);
+  wsLockPositions(locked, indices, groups, numIndices, posOf, numVerts);
+  //  Every position starts with the planes of the triangles around it
+  for (u32 t = 0; t < numIndices / 3; ++t) {
+    const vec4& a = verts[indices[t*3]].pos;
+    vec4 normal = wsTriangleNormal(a, verts[indices[t*3+1]].pos, verts[indices[t*3+2]].pos);
+    f64 length = sqrt((f64)normal.x*normal.x + (f64)normal.y*normal.y + (f64)normal.z*normal.z);
+    if (length <= 0.0) { continue; }
+    f64 nx = normal.x / length, ny = normal.y / length, nz = normal.z / length;
+    f64 d = -(nx*a.x + ny*a.y + nz*a.z);
+    f64 area = 0.5 * length;
+    wsQuadric plane = { area*nx*nx, area*ny*ny, area*nz*nz, area*ny*nx, area*nz*nx, area*nz*ny,
+                        area*nx*d, area*ny*d, area*nz*d, area*d*d, area };
+    for (u32 c = 0; c < 3; ++c) { wsAddQuadric(quadrics[posOf[indices[t*3+c]]], plane); }
+  }
+  f64 maxCost = 0.0;
+  for (;;) {
+    const u32 numTris = numIndices / 3;
+    //  Each vertex lists the triangles which use it
+    memset(listStarts, 0, sizeof(u32)*(numVerts + 1));
+    for (u32 i = 0; i < numIndices; ++i) { ++listStarts[indices[i] + 1]; }
+    for (u32 v = 0; v < numVerts; ++v) { listStarts[v+1] += listStarts[v]; }
+    for (u32 t = 0; t < numTris; ++t) {
+      for (u32 c = 0; c < 3; ++c) { triLists[listStarts[indices[t*3+c]]++] = t; }
+    }
+    for (u32 v = numVerts; v > 0; --v) { listStarts[v] = listStarts[v-1]; }
+    listStarts[0] = 0;
+    //  Each free position's cheapest collapse onto a neighbour. Every wedge must have
+    //  an edge to the neighbour to follow, so a seam only collapses along itself.
+    u32 numCollapses = 0;
+    for (u32 p = 0; p < numVerts; ++p) {
+      if (posOf[p] != p || locked[p]) { continue; }
+      wsCollapse best = { 0.0f, p, WS_NO_VERTEX };
+      u32 w = p;
+      do {
+        for (u32 i = listStarts[w]; i < listStarts[w+1]; ++i) {
+          const u32* tri = &indices[triLists[i]*3];
+          for (u32 c = 0; c < 3; ++c) {
+            u32 to = posOf[tri[c]];
+            if (to == p || to == best.to) { continue; }
+            wsQuadric merged = quadrics[p];
+            wsAddQuadric(merged, quadrics[to]);
+            f64 cost = wsQuadricError(merged, verts[to].pos);
+            f32 weightDistance = wsWeightDistance(verts[w], verts[tri[c]]);
+            if (weightDistance > 0.0f) {
+              f32 dx = verts[p].pos.x - verts[to].pos.x;
+              f32 dy = verts[p].pos.y - verts[to].pos.y;
+              f32 dz = verts[p].pos.z - verts[to].pos.z;
+              cost += WS_SIMPLIFY_SKIN_COST * weightDistance * (dx*dx + dy*dy + dz*dz);
+            }
+            if (best.to != WS_NO_VERTEX && cost >= best.cost) { continue; }
+            bool follows = true;
+            u32 wedge = p;
+            do {
+              follows = (listStarts[wedge] == listStarts[wedge+1] ||
+                          wsFindWedgeTarget(wedge, to, indices, listStarts, triLists, posOf) != WS_NO_VERTEX);
+              wedge = nextWedge[wedge];
+            } while (follows && wedge != p);
+            if (follows) {
+              best.cost = (f32)cost;
+              best.to = to;
+            }
+          }
+        }
+        w = nextWedge[w];
+      } while (w != p);
+      if (best.to != WS_NO_VERTEX) { collapses[numCollapses++] = best; }
+    }
+    qsort(collapses, numCollapses, sizeof(wsCollapse), wsCompareCollapses);
+    //  Collapse in order of cost; a position changed in this pass waits for the next,
+    //  since the lists and quadrics the choice was made from no longer describe it
+    for (u32 v = 0; v < numVerts; ++v) { remap[v] = v; }
+    memset(touched, 0, sizeof(bool)*numVerts);
+    u32 remainingTris = numTris;
+    u32 numCollapsed = 0;
+    const u32 passLimit = wsMax((u32)(numCollapses * WS_SIMPLIFY_PASS_SHARE), (u32)1);
+    for (u32 i = 0; i < numCollapses && i < passLimit && remainingTris*3 > targetIndices; ++i) {
+      const wsCollapse& my = collapses[i];
+      if (touched[my.from] || touched[my.to]) { continue; }
+      //  Refuse collapses which would fold a remaining triangle over
+      bool folds = false;
+      u32 numRemoved = 0;
+      u32 w = my.from;
+      do {
+        for (u32 j = listStarts[w]; j < listStarts[w+1] && !folds; ++j) {
+          const u32* tri = &indices[triLists[j]*3];
+          if (touched[posOf[tri[0]]] || touched[posOf[tri[1]]] || touched[posOf[tri[2]]]) {
+            //  A neighbour already moved in this pass
+            folds = true;
+            break;
+          }
+          if (posOf[tri[0]] == my.to || posOf[tri[1]] == my.to || posOf[tri[2]] == my.to) {
+            ++numRemoved;
+            continue;
+          }
+          vec4 before = wsTriangleNormal(verts[tri[0]].pos, verts[tri[1]].pos, verts[tri[2]].pos);
+          vec4 after = wsTriangleNormal(verts[(tri[0] == w) ? my.to : tri[0]].pos,
+                                        verts[(tri[1] == w) ? my.to : tri[1]].pos,
+                                        verts[(tri[2] == w) ? my.to : tri[2]].pos);
+          f32 dot = before.x*after.x + before.y*after.y + before.z*after.z;
+          f32 lengths = sqrtf((before.x*before.x + before.y*before.y + before.z*before.z) *
+                              (after.x*after.x + after.y*after.y + after.z*after.z));
+          folds = (lengths <= 0.0f || dot < WS_SIMPLIFY_MIN_FACING * lengths);
+        }
+        w = nextWedge[w];
+      } while (!folds && w != my.from);
+      if (folds) { continue; }
+      w = my.from;
+      do {
+        if (listStarts[w] != listStarts[w+1]) {
+          remap[w] = wsFindWedgeTarget(w, my.to, indices, listStarts, triLists, posOf);
+        }
+        for (u32 j = listStarts[w]; j < listStarts[w+1]; ++j) {
+          const u32* tri = &indices[triLists[j]*3];
+          touched[posOf[tri[0]]] = touched[posOf[tri[1]]] = touched[posOf[tri[2]]] = true;
+        }
+        w = nextWedge[w];
+      } while (w != my.from);
+      wsAddQuadric(quadrics[my.to], quadrics[my.from]);
+      remainingTris -= numRemoved;
+      if (my.cost > maxCost) { maxCost = my.cost; }
+      ++numCollapsed;
+    }
+    if (numCollapsed == 0) { break; }
+    //  Move the collapsed vertices and drop the triangles which lost their area
+    u32 numKept = 0;
+    for (u32 t = 0; t < numTris; ++t) {
+      u32 a = remap[indices[t*3]], b = remap[indices[t*3+1]], c = remap[indices[t*3+2]];
+      if (posOf[a] == posOf[b] || posOf[b] == posOf[c] || posOf[a] == posOf[c]) { continue; }
+      indices[numKept*3] = a;
+      indices[numKept*3+1] = b;
+      indices[numKept*3+2] = c;
+      groups[numKept++] = groups[t];
+    }
+    numIndices = numKept*3;
+    if (numIndices <= targetIndices) { break; }
+  }
+  free(posOf);
+  free(nextWedge);
+  free(locked);
+  free(quadrics);
+  free(remap);
+  free(touched);
+  free(listStarts);
+  free(triLists);
+  free(collapses);
+  *error = (f32)sqrt(maxCost);
+  return numIndices;
+}
+
+u32 wsSelectLOD(const f32* errors, u32 numLODs, u32 currentLOD, f32 screenRadius,
+                f32 maxPixelError, f32 hysteresis) {
+  //  The coarsest level whose error stays within the limit; errors only grow
+  u32 target = 0;
+  while (target < numLODs && errors[target] * screenRadius <= maxPixelError) { ++target; }
+  if (target <= currentLOD) { return target; }
+  //  Coarsening waits until the level clears the limit by the hysteresis share
+  u32 coarser = currentLOD;
+  while (coarser < target && errors[coarser] * screenRadius <= maxPixelError * (1.0f - hysteresis)) { ++coarser; }
+  return coarser;
+}
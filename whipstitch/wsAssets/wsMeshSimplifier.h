@@ -0,0 +1,61 @@
+/*
+ * wsMeshSimplifier.h
+ *
+ *    This file declares the level of detail tools of the Whipstitch Game Engine.
+ *
+ *    wsSimplify(...) reduces a triangle list by collapsing edges in the order of
+ *    their quadric error, after Garland and Heckbert's "Surface Simplification Using
+ *    Quadric Error Metrics". Each collapse moves one vertex onto a neighbour, so every
+ *    level of detail indexes the mesh's own vertex buffer and keeps its UVs and skin
+ *    weights exactly. Vertices on a border, a UV or normal seam, or the boundary
+ *    between two materials never move, and collapses across differently weighted
+ *    vertices cost extra, so limbs do not tear when the mesh is animated.
+ *
+ *    wsSelectLOD(...) picks the level a model is drawn at from the size its bounds
+ *    project to on screen.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MESH_SIMPLIFIER_H_
+#define WS_MESH_SIMPLIFIER_H_
+
+#include "wsMesh.h"
+
+//  Collapses edges of the triangles in indices until at most targetIndices remain or
+//  no collapse is left which keeps borders, seams, material boundaries and facing.
+//  groups holds each triangle's material and is compacted along with indices. Returns
+//  the new number of indices and sets error to the largest distance the surface moved.
+u32 wsSimplify(u32* indices, u32* groups, u32 numIndices, const wsVert* verts, u32 numVerts,
+                u32 targetIndices, f32* error);
+
+//  Returns the level to draw at, from 0 (the full mesh) to numLODs. errors[l-1] is the
+//  error of level l as a share of the bounding radius, and screenRadius the radius
+//  the bounds project to, in pixels. A level is left for a coarser one only once the
+//  coarser one's error is a hysteresis share below the limit, so a model at the edge
+//  of a threshold does not flicker between levels.
+u32 wsSelectLOD(const f32* errors, u32 numLODs, u32 currentLOD, f32 screenRadius,
+                f32 maxPixelError = WS_LOD_PIXEL_ERROR, f32 hysteresis = WS_LOD_HYSTERESIS);
+
+#endif /* WS_MESH_SIMPLIFIER_H_ */
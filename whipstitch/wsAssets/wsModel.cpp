@@ -33,6 +33,9 @@
 */
 
 #include "wsModel.h"
+#include "wsMeshOptimizer.h"
+#include "wsMeshSimplifier.h"
+#include "../wsGraphics/wsCamera.h"
 #include "../wsGraphics/wsRenderSystem.h"
 #include "../wsGameFlow/wsThreadPool.h"
 
@@ -63,35 +66,59 @@ wsModel::wsModel(const char* myName, wsMesh* myMesh, const u32 myMaxAnimations,
   attachmentLoc = WS_NULL;
   attachmentRot = WS_NULL;
   timeScale = 1.0f;
+  memset(lodLevels, 0, sizeof(lodLevels));
   mass = myMass;
   collisionShape = myCollisionShape;
   transform.setTranslation(myMesh->getDefaultPos());
   //  Initialize Drawing variables
   const wsMaterial* mats = myMesh->getMats();
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    //  Each level of detail has its own index array for every material
     numIndexArrays = myMesh->getNumMaterials();
-    indexArrays = wsNewArray(wsIndexArray, numIndexArrays);
+    indexArrays = wsNewArray(wsIndexArray, numIndexArrays*(myMesh->getNumLODs() + 1));
     glGenBuffers(1, &vertexArray);
     glBindBuffer(GL_ARRAY_BUFFER, vertexArray);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(wsVert)*myMesh->getNumVerts(), myMesh->getVerts(), GL_STATIC_DRAW);
+    #if WS_PACK_VERTICES
+      vertexSize = sizeof(wsPackedVert);
+      wsPackedVert* packedVerts = wsNewArrayTmp(wsPackedVert, myMesh->getNumVerts());
+      wsPackVertices(packedVerts, myMesh->getVerts(), myMesh->getNumVerts());
+      glBufferData(GL_ARRAY_BUFFER, sizeof(wsPackedVert)*myMesh->getNumVerts(), packedVerts, GL_STATIC_DRAW);
+    #else
+      vertexSize = sizeof(wsVert);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(wsVert)*myMesh->getNumVerts(), myMesh->getVerts(), GL_STATIC_DRAW);
+    #endif
     //  Unbind the buffer
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     //  Generate vertex buffer objects for this mesh
-    for (u32 i = 0; i < numIndexArrays; ++i) {
-      const wsTriangle* tris = mats[i].tris;
-      //  Create index arrays
-      indexArrays[i].numIndices = mats[i].numTriangles*3;
-      indexArrays[i].indices = wsNewArray(u32, indexArrays[i].numIndices);
-      for (u32 t = 0; t < mats[i].numTriangles; ++t) {
-        indexArrays[i].indices[t*3] = tris[t].vertIndices[0];
-        indexArrays[i].indices[t*3+1] = tris[t].vertIndices[1];
-        indexArrays[i].indices[t*3+2] = tris[t].vertIndices[2];
+    for (u32 i = 0; i < numIndexArrays*(myMesh->getNumLODs() + 1); ++i) {
+      u32 lod = i / numIndexArrays;
+      u32 m = i % numIndexArrays;
+      const wsTriangle* tris = (lod) ? myMesh->getLODs()[lod-1].tris[m] : mats[m].tris;
+      u32 numTriangles = (lod) ? myMesh->getLODs()[lod-1].numTriangles[m] : mats[m].numTriangles;
+      //  The mesh's triangles are already a packed index list, shared by every model using it
+      indexArrays[i].numIndices = numTriangles*3;
+      indexArrays[i].indices = (u32*)tris;
+      u32 maxIndex = 0;
+      for (u32 n = 0; n < indexArrays[i].numIndices; ++n) {
+        maxIndex = wsMax(maxIndex, indexArrays[i].indices[n]);
       }
-      //  Generate opengl index arrays
+      //  Generate opengl index arrays, halving their size when every index fits in 16 bits
       glGenBuffers(1, &indexArrays[i].handle);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexArrays[i].handle);
-      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32)*indexArrays[i].numIndices, indexArrays[i].indices,
-              (myMaxAnimations) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+      if (maxIndex <= 0xFFFF) {
+        indexArrays[i].indexSize = sizeof(u16);
+        u16* shortIndices = wsNewArrayTmp(u16, indexArrays[i].numIndices);
+        for (u32 n = 0; n < indexArrays[i].numIndices; ++n) {
+          shortIndices[n] = (u16)indexArrays[i].indices[n];
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u16)*indexArrays[i].numIndices, shortIndices,
+                (myMaxAnimations) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+      }
+      else {
+        indexArrays[i].indexSize = sizeof(u32);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32)*indexArrays[i].numIndices, indexArrays[i].indices,
+                (myMaxAnimations) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+      }
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
   #endif
@@ -134,7 +161,9 @@ void wsModel::applyAnimation() {
   }
   f32 blendFactor = wsBlendFactor(frames[prevKeyframe].frameIndex, frameNum, frames[nextKeyframe].frameIndex);
   wsEcho(WS_LOG_GRAPHICS, "animation keyframe = %f, blendFactor = %f\n", frameNum, blendFactor);
-  wsJoint* joints = (wsJoint*)mesh->getJoints();
+  //  The pose is this model's own; the mesh's joints, shared by every model using it and
+  //  perhaps mapped read-only from a cooked file, only give the rest offsets
+  const wsJoint* joints = mesh->getJoints();
   //  Place this on the frame stack (it will be cleared next frame)
   wsJointMod* mods = wsNewArrayTmp(wsJointMod, mesh->getNumJoints());
   for (u32 i = 0; i < mesh->getNumJoints(); ++i) {
@@ -145,32 +174,29 @@ void wsModel::applyAnimation() {
   }
   //  Applying animation
   for (u32 i = 0; i < mesh->getNumJoints(); ++i) {
-    joints[i].rot = mods[i].rotation;
-    joints[i].start = joints[i].startRel;
+    jointRotations[i] = mods[i].rotation;
+    jointLocations[i] = joints[i].startRel;
     if (joints[i].parent >= 0) {
-      joints[i].start.rotate(joints[joints[i].parent].rot);
-      joints[i].start += joints[joints[i].parent].start;
+      jointLocations[i].rotate(jointRotations[joints[i].parent]);
+      jointLocations[i] += jointLocations[joints[i].parent];
     }
-    joints[i].start += mods[i].location;
-    jointRotations[i] = joints[i].rot;
-    jointLocations[i] = joints[i].start;
+    jointLocations[i] += mods[i].location;
   }
 }
 
 void wsModel::applyStaticAnimation() {
   if (mesh->getNumJoints() == 0) { return; }  //  Error checking
   wsEcho(WS_LOG_GRAPHICS, "Applying Static Animation");
-  vec4* meshJointLocations = (vec4*)mesh->getJointLocations();
-  quat* meshJointRotations = (quat*)mesh->getJointRotations();
+  const vec4* meshJointLocations = mesh->getJointLocations();
+  const quat* meshJointRotations = mesh->getJointRotations();
   for (u32 i = 0; i < mesh->getNumJoints(); ++i) {
     jointLocations[i] = meshJointLocations[i];
     jointRotations[i] = meshJointRotations[i];
   }
 }
 
-void wsModel::attachModel(wsModel* myModel, const char* jointName) {
+void wsModel::attachModel(wsModel* myModel, u32 index) {
   wsAssert(myModel != NULL, "Cannot attach a null model");
-  u32 index = mesh->getJointIndex(jointName);
   myModel->attachmentModel = this;
   myModel->attachmentTransform = &transform;
   myModel->attachmentLoc = &jointLocations[index];
@@ -178,8 +204,8 @@ void wsModel::attachModel(wsModel* myModel, const char* jointName) {
   myModel->properties &= WS_MODEL_ATTACHED;
 }
 
-void wsModel::beginAnimation(const char* animName) {
-  currentAnimation = animations->retrieve(wsHash(animName));
+void wsModel::beginAnimation(u32 animHash) {
+  currentAnimation = animations->retrieve(animHash);
   animTime = 0.0;
   //  Update bounding box
   bounds = currentAnimation->getBounds();
@@ -205,6 +231,21 @@ void wsModel::pauseAnimation() {
   properties &= WS_MODEL_ANIM_PAUSED;
 }
 
+u32 wsModel::selectLOD(const wsCamera* camera, u32 cameraSlot) {
+  u32 numLODs = mesh->getNumLODs();
+  if (numLODs == 0) { return 0; }
+  //  Later cameras share the last slot
+  cameraSlot = wsMin(cameraSlot, (u32)WS_MAX_LOD_CAMERAS - 1);
+  f32 errors[WS_MAX_LODS];
+  numLODs = wsMin(numLODs, (u32)WS_MAX_LODS);
+  for (u32 l = 0; l < numLODs; ++l) { errors[l] = mesh->getLODs()[l].error; }
+  //  As the mesh measured its levels' errors against: the length of the half-extents
+  f32 radius = sqrtf(bounds.x*bounds.x + bounds.y*bounds.y + bounds.z*bounds.z)*transform.scale;
+  f32 screenRadius = camera->getScreenRadius(getPos(), radius);
+  lodLevels[cameraSlot] = (u8)wsSelectLOD(errors, numLODs, lodLevels[cameraSlot], screenRadius);
+  return lodLevels[cameraSlot];
+}
+
 void wsModel::setFrame(f32 newFrame) {
   wsAssert( (currentAnimation != NULL), "Cannot set frame for NULL animation.");
   while (newFrame > currentAnimation->getLength()) {
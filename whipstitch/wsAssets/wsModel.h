@@ -41,6 +41,8 @@
 #include "../wsUtils.h"
 #include "../wsPrimitives.h"
 
+class wsCamera;
+
 class wsModel: public wsAsset {
   private:
     wsMesh* mesh;
@@ -49,6 +51,7 @@ class wsModel: public wsAsset {
       wsIndexArray* indexArrays;
       u32 numIndexArrays;
       u32 vertexArray;
+      u32 vertexSize; //  Bytes per vertex in the GL buffer: sizeof(wsPackedVert) or sizeof(wsVert)
     #endif
     wsHashMap<wsAnimation*> *animations;
     wsAnimation* currentAnimation;
@@ -65,8 +68,12 @@ class wsModel: public wsAsset {
     t64 animTime;
     f32 mass;
     f32 timeScale;
+    u8 lodLevels[WS_MAX_LOD_CAMERAS];  //  Level of detail last drawn by each camera
     u16 defaultAnimation;
     u16 properties;
+    //  Shared by the name and handle versions of the public methods
+    void attachModel(wsModel* myModel, u32 jointIndex);
+    void beginAnimation(u32 animHash);
   public:
     /// Constructor and Destructor
     wsModel(const char* myName, wsMesh* myMesh, const u32 myMaxAnimations = WS_DEFAULT_MAX_ANIMATIONS, const f32 myMass = 0.0f,
@@ -80,7 +87,8 @@ class wsModel: public wsAsset {
     const vec4& getBounds() { return bounds; }
     const u64 getCollisionClass() { return collisionClass; }
     wsCollisionShape* getCollisionShape() { return collisionShape; }
-    wsIndexArray* getIndexArrays() { return indexArrays; }
+    //  One index array for each material, at the given level of detail
+    wsIndexArray* getIndexArrays(u32 lod = 0) { return &indexArrays[lod*numIndexArrays]; }
     vec4* getJointLocations() { return jointLocations; }
     quat* getJointRotations() { return jointRotations; }
     f32 getMass() { return mass; }
@@ -99,6 +107,7 @@ class wsModel: public wsAsset {
     const wsTransform& getTransform() { return transform; }
     wsTransform* getTransformp() { return &transform; }
     u32 getVertexArray() { return vertexArray; }
+    u32 getVertexSize() { return vertexSize; }
     void setFrame(f32 newFrame);
     void setMesh(wsMesh* my) { mesh = my; }
     void setTimeScale(f32 my) { timeScale = my; }
@@ -111,11 +120,17 @@ class wsModel: public wsAsset {
     void addAnimation(wsAnimation* anim);
     void applyAnimation();  //  Applies the current animation to the mesh vertices
     void applyStaticAnimation();  //  Sets joint positions to their default values
-    void attachModel(wsModel* myModel, const char* jointName);
-    void beginAnimation(const char* animName);
+    void attachModel(wsModel* myModel, const char* jointName) { attachModel(myModel, mesh->getJointIndex(jointName)); }
+    void attachModel(wsModel* myModel, wsNameHandle jointName) { attachModel(myModel, mesh->getJointIndex(jointName)); }
+    void beginAnimation(const char* animName) { beginAnimation(wsHash(animName)); }
+    void beginAnimation(wsNameHandle animName) { beginAnimation(wsNames.getHash(animName)); }
     void continueAnimation();// Continues a paused animation
     void draw();
     void incrementAnimationTime(t32 increment);
+    //  Chooses the level of detail to draw at through the given camera, from the size
+    //  of the model's bounds on screen. Each camera slot remembers its last choice for
+    //  the hysteresis of wsSelectLOD(...).
+    u32 selectLOD(const wsCamera* camera, u32 cameraSlot);
     void move(const vec4& dist) { transform += dist; }
     vec4 moveBackward(const f32 dist) {
       vec4 translation(0.0f, 0.0f, -dist);
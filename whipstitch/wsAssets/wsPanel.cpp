@@ -63,7 +63,7 @@ void wsPanel::checkMouse(f32 mouseX, f32 mouseY, bool buttonDown) {
     if (relX >= 0 && relY >= 0 && relX <= rectangle.rectW && relY <= rectangle.rectH) {
       // wsEcho("Checking Mouse: %f, %f, %u\n", relX, relY, (buttonDown)?1:0);
       //  Check buttons and other inputs
-      for (wsOrderedHashMap<wsPanelElement*>::iterator it = elements->begin(); it.get() != WS_NULL; ++it) {
+      for (wsOrderedHashMap<wsPanelElement*>::iterator it = elements->begin(); it.isValid(); ++it) {
         // wsEcho("Ping");
         if (it.get()->getType() == WS_ELEMENT_BUTTON) {
           wsButton* my = (wsButton*)it.get();
@@ -141,7 +141,7 @@ void wsPanel::draw() {
           glVertex2f(0.0f, rectangle.rectH);
         glEnd();
 
-        for (wsOrderedHashMap<wsPanelElement*>::iterator it = elements->begin(); it.get() != WS_NULL; ++it) {
+        for (wsOrderedHashMap<wsPanelElement*>::iterator it = elements->begin(); it.isValid(); ++it) {
           it.get()->draw();
         }
       glPopMatrix();
@@ -36,16 +36,14 @@ f32 wsSound::gain = 1.0f;
 
 wsSound::wsSound(const char* filePath) {
   #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
-    alGenSources(1, &soundSource);
-    pitch = 1.0f;
-    rolloff = 1.0f;
-    refDistance = 50.0f;
-    looping = false;
-    relative = true;
-    update();
+    createSource();
     alGenBuffers(1, &soundBuffer);
     i32 errorType;
-    soundBuffer = alutCreateBufferFromFile(filePath);
+    //  Read from a mounted pack if one holds it
+    wsMappedFile file;
+    if (file.open(filePath)) {
+      soundBuffer = alutCreateBufferFromFileImage(file.getData(), (ALsizei)file.getSize());
+    }
     errorType = alutGetError();
     if (errorType) {
       wsEcho(WS_LOG_SOUND | WS_LOG_ERROR, "Error Loading Sound file \"%s\": %s\n", filePath, alutGetErrorString(errorType));
@@ -54,6 +52,15 @@ wsSound::wsSound(const char* filePath) {
   #endif
 }
 
+wsSound::wsSound(ALenum format, const ALvoid* data, ALsizei size, ALfloat frequency) {
+  #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
+    createSource();
+    alGenBuffers(1, &soundBuffer);
+    alBufferData(soundBuffer, format, data, size, (ALsizei)frequency);
+    alSourcei(soundSource, AL_BUFFER, soundBuffer);
+  #endif
+}
+
 wsSound::~wsSound() {
   #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
     alDeleteSources(1, &soundSource);
@@ -65,6 +72,18 @@ wsSound::~wsSound() {
   #endif
 }
 
+void wsSound::createSource() {
+  #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
+    alGenSources(1, &soundSource);
+    pitch = 1.0f;
+    rolloff = 1.0f;
+    refDistance = 50.0f;
+    looping = false;
+    relative = true;
+    update();
+  #endif
+}
+
 void wsSound::play() {
   #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
     wsEcho(WS_LOG_SOUND, "Playing Sound.");
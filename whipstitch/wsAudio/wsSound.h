@@ -52,7 +52,11 @@ struct wsSound {
   bool looping;
   bool relative;
   wsSound(const char* filePath);
+  //  Creates the sound from samples already read into memory, e.g. by
+  //  alutLoadMemoryFromFile(...) on another thread
+  wsSound(ALenum format, const ALvoid* data, ALsizei size, ALfloat frequency);
   ~wsSound();
+  void createSource();
   void play();
   void update();
 };
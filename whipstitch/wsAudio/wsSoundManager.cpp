@@ -81,7 +81,7 @@ void wsSoundManager::playMusic(const char* name) {
 }
 
 void wsSoundManager::updateStreams() {
-  for (wsHashMap<wsMusic*>::iterator it = music->begin(); it.get() != WS_NULL; ++it) {
+  for (wsHashMap<wsMusic*>::iterator it = music->begin(); it.isValid(); ++it) {
     it.get()->updateStream();
   }
 }
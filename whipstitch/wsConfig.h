@@ -14,11 +14,36 @@
 #define WS_NUM_SHADERS 4
 #define WS_MAX_JOINTS 128
 #define WS_NUM_FRAMEBUFFERS 2
-#define WS_MAX_TEXTURES 32
 #define WS_MAX_FRAME_SKIPS 4
-#define WS_MAX_PRIMITIVES 256
-#define WS_MAX_MODELS 128
-#define WS_MAX_CAMERAS 16
+//  Initial capacities only; the containers grow past these as needed
+#define WS_DEFAULT_NUM_TEXTURES 32
+#define WS_DEFAULT_NUM_PRIMITIVES 256
+#define WS_DEFAULT_NUM_MODELS 128
+#define WS_DEFAULT_NUM_CAMERAS 16
+#define WS_MAX_ASSET_PATH 256
+#define WS_DEFAULT_MAX_ASSETS 512
+#define WS_OPTIMIZE_MESHES 1   //  Weld and reorder meshes for the vertex cache as they load
+#define WS_PACK_VERTICES 1     //  Upload model vertices as 32-byte wsPackedVerts rather than wsVerts
+#define WS_USE_COOKED_TEXTURES 1  //  Load an image's .wsTex file in its place when one is up to date
+#define WS_USE_COOKED_ASSETS 1    //  Map a mesh's .wsMeshBin or animation's .wsAnimBin in its place when one is up to date
+#define WS_STL_WELD_EPSILON 1.0e-6f  //  Farthest apart, as a share of an STL mesh's size, corners may be and still weld
+//  Levels of detail
+#define WS_GENERATE_LODS 1     //  Build simplified levels of detail for every mesh as it loads
+#define WS_MAX_LODS 3          //  Levels built beyond the full mesh
+#define WS_LOD_REDUCTION 0.5   //  Share of the triangles each level keeps from the one before
+#define WS_LOD_PIXEL_ERROR 1.0f  //  Most a level may move the surface on screen, in pixels
+#define WS_LOD_HYSTERESIS 0.25f  //  Share below the limit a coarser level must be before it is used
+#define WS_MAX_LOD_CAMERAS 8   //  Cameras which keep their own level for each model
+//  Background asset loading
+//  Each loader thread decodes and filters one image at a time; half the cores leaves the
+//  rest to the main thread and the thread pool
+#define WS_DEFAULT_LOADER_THREADS ((WS_NUM_CORES > 2) ? (u32)WS_NUM_CORES/2 : 1u)
+#define WS_DEFAULT_MAX_ASSET_REQUESTS 256
+#define WS_DEFAULT_UPLOAD_BUDGET 0.002  //  Seconds per frame spent creating loaded assets
+//  Mounted at startup if present; see pakBuilder
+#define WS_DEFAULT_PAK "assets.wsPak"
+//  Read at startup if present, from the pack or disk; see assetCooker
+#define WS_DEFAULT_MANIFEST "assets.wsManifest"
 
 //  Shapes
 enum {
@@ -34,6 +59,15 @@ enum {
   WS_MESH_FORMAT_STL
 };// End enum Mesh Formats
 
+//  Texture Formats, as stored in cooked .wsTex files
+enum {
+  WS_TEXTURE_FORMAT_RGB8,
+  WS_TEXTURE_FORMAT_RGBA8,
+  WS_TEXTURE_FORMAT_BC1,  //  4x4 blocks of 8 bytes; color with at most 1-bit alpha
+  WS_TEXTURE_FORMAT_BC3,  //  4x4 blocks of 16 bytes; color with smooth alpha
+  WS_TEXTURE_FORMAT_BC5   //  4x4 blocks of 16 bytes; two channels, such as a normal's x and y
+};// End enum Texture Formats
+
 enum {
   WS_SHADER_INITIAL,
   WS_SHADER_FINAL,
@@ -33,6 +33,7 @@
 #define WS_GAME_FLOW_H_
 
 #include "wsGameFlow/wsThreadPool.h"
+#include "wsGameFlow/wsAssetLoader.h"
 #include "wsGameFlow/wsGameLoop.h"
 #include "wsGameFlow/wsInputManager.h"
 #include "wsGameFlow/wsEventManager.h"
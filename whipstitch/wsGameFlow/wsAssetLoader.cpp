@@ -0,0 +1,357 @@
+/*
+ * wsAssetLoader.cpp
+ *
+ *    This file implements the class wsAssetLoader.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsAssetLoader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+wsAssetLoader wsLoader;
+
+#define WS_NO_UPLOAD 0xFFFFFFFF
+
+//  Handles carry the slot in the low 16 bits and its generation above them
+inline wsAssetHandle wsMakeAssetHandle(u32 slot, u32 generation) {
+  return ((generation & 0xFFFF) << 16) | (slot + 1);
+}
+
+#ifdef WS_OS_FAMILY_UNIX
+void* wsRunLoaderThread(void* threadID) {
+  u32 slot;
+  while (wsLoader.waitForWork(&slot)) {
+    wsLoader.process(slot);
+  }
+  return WS_NULL;
+}
+#endif
+
+void wsAssetLoader::startUp(u32 myNumThreads, u32 myMaxRequests, t64 myUploadBudget) {
+  wsAssert((myMaxRequests > 1 && myMaxRequests < 0xFFFF), "The asset loader needs between 2 and 65534 request slots.");
+  maxRequests = myMaxRequests;
+  uploadBudget = myUploadBudget;
+  currentUpload = WS_NO_UPLOAD;
+  requests = wsNewArray(wsLoadRequest, maxRequests);
+  freeSlots = wsNew(wsMPMCQueue<u32>, wsMPMCQueue<u32>(maxRequests));
+  loadQueue = wsNew(wsMPMCQueue<u32>, wsMPMCQueue<u32>(maxRequests));
+  uploadQueue = wsNew(wsMPMCQueue<u32>, wsMPMCQueue<u32>(maxRequests));
+  for (u32 i = 0; i < maxRequests; ++i) {
+    new (&requests[i]) wsLoadRequest();
+    requests[i].status.store(WS_ASSET_STATUS_NONE);
+    requests[i].generation = 0;
+    freeSlots->push(i);
+  }
+  killThreads = false;
+  _mInitialized = true;
+  numThreads = 0;
+  #ifdef WS_OS_FAMILY_UNIX
+    //  Without worker threads, requests are processed as they are made
+    numThreads = myNumThreads;
+    sem_init(&workAvailable, 0, 0);
+    threads = wsNewArray(pthread_t, numThreads);
+    for (u32 i = 0; i < numThreads; ++i) {
+      pthread_create(&threads[i], WS_NULL, wsRunLoaderThread, WS_NULL);
+    }
+  #endif
+  wsEcho(WS_LOG_THREADS, "Asset loader started with %u worker threads", numThreads);
+}
+
+void wsAssetLoader::shutDown() {
+  killThreads = true;
+  #ifdef WS_OS_FAMILY_UNIX
+    for (u32 i = 0; i < numThreads; ++i) {
+      sem_post(&workAvailable);
+    }
+    for (u32 i = 0; i < numThreads; ++i) {
+      pthread_join(threads[i], WS_NULL);
+    }
+    sem_destroy(&workAvailable);
+  #endif
+  _mInitialized = false;
+}
+
+wsAnimation* wsAssetLoader::getAnimation(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  if (req == WS_NULL || req->type != WS_LOAD_ANIMATION || req->status != WS_ASSET_STATUS_READY) { return WS_NULL; }
+  return (wsAnimation*)req->asset;
+}
+
+wsMesh* wsAssetLoader::getMesh(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  if (req == WS_NULL || req->type != WS_LOAD_MESH || req->status != WS_ASSET_STATUS_READY) { return WS_NULL; }
+  return (wsMesh*)req->asset;
+}
+
+wsSound* wsAssetLoader::getSound(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  if (req == WS_NULL || req->type != WS_LOAD_SOUND || req->status != WS_ASSET_STATUS_READY) { return WS_NULL; }
+  return (wsSound*)req->asset;
+}
+
+u32 wsAssetLoader::getTexture(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  if (req == WS_NULL || req->type != WS_LOAD_TEXTURE || req->status != WS_ASSET_STATUS_READY) { return WS_NULL; }
+  return req->texture;
+}
+
+u32 wsAssetLoader::getStatus(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  return (req == WS_NULL) ? WS_ASSET_STATUS_NONE : req->status.load(std::memory_order_acquire);
+}
+
+wsLoadRequest* wsAssetLoader::getRequest(wsAssetHandle handle) {
+  wsAssert(_mInitialized, "The asset loader must be initialized via the startUp() method before use.");
+  u32 slot = (handle & 0xFFFF) - 1;
+  if (handle == WS_NULL || slot >= maxRequests || ((requests[slot].generation & 0xFFFF) != (handle >> 16))) {
+    return WS_NULL;
+  }
+  return &requests[slot];
+}
+
+wsAssetHandle wsAssetLoader::loadAnimation(const char* filepath, wsAssetCallback callback, void* userData) {
+  return request(WS_LOAD_ANIMATION, filepath, callback, userData);
+}
+
+wsAssetHandle wsAssetLoader::loadMesh(const char* filepath, wsAssetCallback callback, void* userData) {
+  return request(WS_LOAD_MESH, filepath, callback, userData);
+}
+
+wsAssetHandle wsAssetLoader::loadSound(const char* filepath, wsAssetCallback callback, void* userData) {
+  return request(WS_LOAD_SOUND, filepath, callback, userData);
+}
+
+wsAssetHandle wsAssetLoader::loadTexture(const char* filepath, bool autoSmooth, bool tiling,
+                                          wsAssetCallback callback, void* userData) {
+  wsAssetHandle handle = request(WS_LOAD_TEXTURE, filepath, callback, userData);
+  //  Nothing reads these until the request reaches the main thread again
+  wsLoadRequest* req = getRequest(handle);
+  if (req != WS_NULL) {
+    req->autoSmooth = autoSmooth;
+    req->tiling = tiling;
+  }
+  return handle;
+}
+
+wsAssetHandle wsAssetLoader::request(u32 type, const char* filepath, wsAssetCallback callback, void* userData) {
+  wsAssert(_mInitialized, "The asset loader must be initialized via the startUp() method before use.");
+  wsAssert((strlen(filepath) < WS_MAX_ASSET_PATH), "Asset file path is too long.");
+  u32 slot;
+  if (!freeSlots->pop(slot)) {
+    wsEcho(WS_LOG_ERROR, "Too many asset requests outstanding to load \"%s\"", filepath);
+    return WS_NULL;
+  }
+  wsLoadRequest* req = &requests[slot];
+  strcpy(req->filepath, filepath);
+  req->type = type;
+  req->callback = callback;
+  req->userData = userData;
+  req->asset = WS_NULL;
+  req->texture = 0;
+  req->autoSmooth = true;
+  req->tiling = false;
+  req->failed = false;
+  req->images = WS_NULL;
+  req->numImages = 0;
+  req->nextUpload = 0;
+  req->samples = WS_NULL;
+  req->status.store(WS_ASSET_STATUS_QUEUED, std::memory_order_release);
+  wsAssetHandle handle = wsMakeAssetHandle(slot, req->generation);
+  if (numThreads == 0) {
+    process(slot);
+    return handle;
+  }
+  loadQueue->push(slot);
+  #ifdef WS_OS_FAMILY_UNIX
+    sem_post(&workAvailable);
+  #endif
+  return handle;
+}
+
+bool wsAssetLoader::waitForWork(u32* slot) {
+  #ifdef WS_OS_FAMILY_UNIX
+    while (true) {
+      sem_wait(&workAvailable);
+      if (killThreads) { return false; }
+      if (loadQueue->pop(*slot)) { return true; }
+    }
+  #endif
+  return false;
+}
+
+void wsAssetLoader::process(u32 slot) {
+  wsLoadRequest* req = &requests[slot];
+  req->status.store(WS_ASSET_STATUS_LOADING, std::memory_order_release);
+  bool loaded = wsVFS.exists(req->filepath);
+  if (!loaded) {
+    wsEcho(WS_LOG_ERROR, "Could not open asset file \"%s\"", req->filepath);
+  }
+  else {
+    switch (req->type) {
+      case WS_LOAD_MESH: {
+        //  Textures are decoded here, but created on the main thread
+        wsMesh* mesh = wsNew(wsMesh, wsMesh(req->filepath, wsMeshFormat(req->filepath)));
+        const wsMaterial* mats = mesh->getMats();
+        req->asset = mesh;
+        if (!mesh->isLoaded()) {
+          loaded = false;
+          break;
+        }
+        req->numImages = mesh->getNumMaterials()*2;
+        req->images = wsNewArray(wsImage, req->numImages);
+        for (u32 m = 0; m < mesh->getNumMaterials(); ++m) {
+          req->images[m*2].pixels = WS_NULL;
+          req->images[m*2+1].pixels = WS_NULL;
+          req->images[m*2].cooked = WS_NULL;
+          req->images[m*2+1].cooked = WS_NULL;
+          if (mats[m].colorMapPath != WS_NULL) { wsRenderer.decodeImage(&req->images[m*2], mats[m].colorMapPath); }
+          if (mats[m].normalMapPath != WS_NULL) { wsRenderer.decodeImage(&req->images[m*2+1], mats[m].normalMapPath, true); }
+        }
+        break;
+      }
+      case WS_LOAD_ANIMATION:
+        req->asset = wsNew(wsAnimation, wsAnimation(req->filepath));
+        loaded = ((wsAnimation*)req->asset)->isLoaded();
+        break;
+      case WS_LOAD_TEXTURE:
+        req->numImages = 1;
+        req->images = wsNewArray(wsImage, 1);
+        //  A failed decode is left to createTexture(...), which falls back to the default texture
+        wsRenderer.decodeImage(req->images, req->filepath);
+        break;
+      case WS_LOAD_SOUND:
+        #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
+          {
+            wsMappedFile file;
+            req->samples = file.open(req->filepath) ?
+              alutLoadMemoryFromFileImage(file.getData(), (ALsizei)file.getSize(), &req->sampleFormat,
+                                          &req->sampleSize, &req->sampleFrequency) : WS_NULL;
+          }
+          if (req->samples == WS_NULL) {
+            wsEcho(WS_LOG_SOUND | WS_LOG_ERROR, "Error Loading Sound file \"%s\": %s\n", req->filepath,
+                    alutGetErrorString(alutGetError()));
+            loaded = false;
+          }
+        #endif
+        break;
+      default:
+        wsEcho(WS_LOG_ERROR, "Unknown asset request type %u", req->type);
+        loaded = false;
+        break;
+    }
+  }
+  req->failed = !loaded;
+  req->status.store(WS_ASSET_STATUS_UPLOADING, std::memory_order_release);
+  //  Even failures go through the main thread, which runs the callbacks
+  uploadQueue->push(slot);
+}
+
+void wsAssetLoader::release(wsAssetHandle handle) {
+  wsLoadRequest* req = getRequest(handle);
+  if (req == WS_NULL) { return; }
+  u32 status = req->status.load(std::memory_order_acquire);
+  wsAssert((status == WS_ASSET_STATUS_READY || status == WS_ASSET_STATUS_FAILED),
+            "Cannot release an asset request which has not finished.");
+  ++req->generation;
+  req->status.store(WS_ASSET_STATUS_NONE, std::memory_order_release);
+  freeSlots->push((handle & 0xFFFF) - 1);
+}
+
+void wsAssetLoader::update() {
+  wsAssert(_mInitialized, "The asset loader must be initialized via the startUp() method before use.");
+  t64 beginTime = wsGetTime();
+  //  At least one piece of work is done each frame, however small the budget
+  do {
+    if (currentUpload == WS_NO_UPLOAD && !uploadQueue->pop(currentUpload)) { return; }
+    wsLoadRequest* req = &requests[currentUpload];
+    if (req->failed || upload(req)) {
+      u32 slot = currentUpload;
+      currentUpload = WS_NO_UPLOAD;
+      finish(slot);
+    }
+  } while (wsGetTime() - beginTime < uploadBudget);
+}
+
+bool wsAssetLoader::upload(wsLoadRequest* req) {
+  switch (req->type) {
+    case WS_LOAD_MESH: {
+      //  One texture at a time, as each may take a large part of the budget
+      wsMaterial* mats = ((wsMesh*)req->asset)->getMats();
+      while (req->nextUpload < req->numImages) {
+        u32 i = req->nextUpload++;
+        wsMaterial& mat = mats[i/2];
+        const char* path = (i & 1) ? mat.normalMapPath : mat.colorMapPath;
+        if (path != WS_NULL) {
+          wsRenderer.createTexture((i & 1) ? &mat.normalMap : &mat.colorMap, path, &req->images[i]);
+          break;
+        }
+      }
+      return (req->nextUpload >= req->numImages);
+    }
+    case WS_LOAD_TEXTURE:
+      wsRenderer.createTexture(&req->texture, req->filepath, req->images, req->autoSmooth, req->tiling);
+      return true;
+    case WS_LOAD_SOUND:
+      #if WS_SOUND_BACKEND == WS_BACKEND_OPENAL
+        req->asset = wsNew(wsSound, wsSound(req->sampleFormat, req->samples, req->sampleSize, req->sampleFrequency));
+        free(req->samples);
+        req->samples = WS_NULL;
+      #endif
+      return true;
+    default:
+      //  Animations need nothing from the main thread
+      return true;
+  }
+}
+
+void wsAssetLoader::finish(u32 slot) {
+  wsLoadRequest* req = &requests[slot];
+  u32 status = req->failed ? WS_ASSET_STATUS_FAILED : WS_ASSET_STATUS_READY;
+  if (req->failed) {
+    //  Free whatever was decoded before the failure
+    for (u32 i = 0; i < req->numImages; ++i) {
+      wsRenderer.freeImage(&req->images[i]);
+    }
+  }
+  req->status.store(status, std::memory_order_release);
+  //  The callback may release the handle, so nothing touches the request afterward
+  if (req->callback != WS_NULL) {
+    req->callback(wsMakeAssetHandle(slot, req->generation), status, req->userData);
+  }
+}
+
+u32 wsAssetLoader::waitFor(wsAssetHandle handle) {
+  u32 status = getStatus(handle);
+  while (status != WS_ASSET_STATUS_READY && status != WS_ASSET_STATUS_FAILED && status != WS_ASSET_STATUS_NONE) {
+    update();
+    status = getStatus(handle);
+    if (status != WS_ASSET_STATUS_READY && status != WS_ASSET_STATUS_FAILED && uploadQueue->isEmpty()) {
+      wsWait(0.0005);
+    }
+  }
+  return status;
+}
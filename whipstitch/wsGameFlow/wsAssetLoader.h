@@ -0,0 +1,182 @@
+/*
+ * wsAssetLoader.h
+ *
+ *    This file declares the class wsAssetLoader and its singleton instance, wsLoader,
+ *    an engine subsystem which loads assets without stalling the frame.
+ *
+ *    Each load request returns a handle at once. Worker threads read and parse the
+ *    file, decoding any images or sound samples it needs. Whatever must be created
+ *    through the graphics or audio context (textures, sound buffers) is then queued
+ *    for the main thread, where update() creates it a piece at a time, stopping for
+ *    the frame once the upload budget has been spent. The game loop calls update()
+ *    once per frame.
+ *
+ *    A request is finished when its status becomes WS_ASSET_STATUS_READY or
+ *    WS_ASSET_STATUS_FAILED. Either poll getStatus(...), or pass a callback, which
+ *    always runs on the main thread from within update(). Once the asset has been
+ *    taken, release(...) frees the handle for reuse; the asset itself is untouched.
+ *
+ *    Usage:
+ *      wsAssetHandle griswald = wsLoader.loadMesh("models/Griswald.wsMesh");
+ *      ...
+ *      if (wsLoader.isReady(griswald)) {
+ *        myModel = wsNew(wsModel, wsModel("Griswald", wsLoader.getMesh(griswald), 7));
+ *        wsLoader.release(griswald);
+ *      }
+ *
+ *    Loaded assets are allocated from the current tier of the Primary Stack, so tiers
+ *    must not be freed or changed while requests are outstanding.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_ASSET_LOADER_H_
+#define WS_ASSET_LOADER_H_
+
+#include "../wsConfig.h"
+#include "../wsUtils.h"
+#include "../wsAssets/wsAnimation.h"
+#include "../wsAssets/wsMesh.h"
+#include "../wsAudio/wsSound.h"
+#include "../wsGraphics/wsRenderSystem.h"
+#include <atomic>
+
+#ifdef WS_OS_FAMILY_UNIX
+  #include <pthread.h>
+  #include <semaphore.h>
+#endif
+
+/*  Request Status */
+#define WS_ASSET_STATUS_NONE      0x00  //  The handle is not in use
+#define WS_ASSET_STATUS_QUEUED    0x01  //  Waiting for a worker thread
+#define WS_ASSET_STATUS_LOADING   0x02  //  Being read on a worker thread
+#define WS_ASSET_STATUS_UPLOADING 0x03  //  Waiting for, or partway through, creation on the main thread
+#define WS_ASSET_STATUS_READY     0x04
+#define WS_ASSET_STATUS_FAILED    0x05
+
+/*  Request Types */
+#define WS_LOAD_MESH              0x01
+#define WS_LOAD_ANIMATION         0x02
+#define WS_LOAD_TEXTURE           0x03
+#define WS_LOAD_SOUND             0x04
+
+typedef u32 wsAssetHandle;
+//  Called on the main thread once a request is ready or has failed
+typedef void (*wsAssetCallback)(wsAssetHandle handle, u32 status, void* userData);
+
+struct wsLoadRequest {
+  char filepath[WS_MAX_ASSET_PATH];
+  std::atomic<u32> status;
+  u32 type;
+  u32 generation;     //  Bumped on release, so stale handles are recognized
+  wsAssetCallback callback;
+  void* userData;
+  void* asset;        //  wsMesh*, wsAnimation* or wsSound*
+  u32 texture;        //  The result of a texture request
+  bool autoSmooth;
+  bool tiling;
+  //  Set by the worker thread; the status shows it only once the main thread has
+  //  finished the request, so a failure is never released before its callback runs
+  bool failed;
+  //  Decoded images waiting for upload; for a mesh, the color and normal maps of each material
+  wsImage* images;
+  u32 numImages;
+  u32 nextUpload;
+  //  Decoded sound samples waiting for upload
+  ALvoid* samples;
+  ALenum sampleFormat;
+  ALsizei sampleSize;
+  ALfloat sampleFrequency;
+};
+
+class wsAssetLoader {
+  private:
+    wsLoadRequest* requests;
+    wsMPMCQueue<u32>* freeSlots;
+    wsMPMCQueue<u32>* loadQueue;      //  Requests waiting for a worker thread
+    wsMPMCQueue<u32>* uploadQueue;    //  Requests waiting for the main thread
+    u32 maxRequests;
+    u32 numThreads;
+    u32 currentUpload;                //  The request update() is partway through
+    t64 uploadBudget;
+    std::atomic<bool> killThreads;
+    #ifdef WS_OS_FAMILY_UNIX
+      pthread_t* threads;
+      sem_t workAvailable;            //  Counts the requests in loadQueue
+    #endif
+    //  True only when the startUp function has been called
+    bool _mInitialized;
+    //  Private Methods
+    void finish(u32 slot);
+    wsLoadRequest* getRequest(wsAssetHandle handle);
+    wsAssetHandle request(u32 type, const char* filepath, wsAssetCallback callback, void* userData);
+    //  Performs one piece of main-thread creation; returns true once the request is complete
+    bool upload(wsLoadRequest* req);
+  public:
+    /*  Default Constructor and Deconstructor */
+    //  As an engine subsystem, the asset loader takes no action until explicitly
+    //  initialized via the startUp(...) function.
+    //  uninitialized via the shutDown() function.
+    wsAssetLoader() : _mInitialized(false) {}
+    ~wsAssetLoader() {}
+    /*  Setters and Getters */
+    //  Each returns WS_NULL unless the request is ready
+    wsAnimation* getAnimation(wsAssetHandle handle);
+    wsMesh* getMesh(wsAssetHandle handle);
+    wsSound* getSound(wsAssetHandle handle);
+    u32 getTexture(wsAssetHandle handle);
+    u32 getStatus(wsAssetHandle handle);
+    bool isInitialized() { return _mInitialized; }
+    bool isReady(wsAssetHandle handle) { return (getStatus(handle) == WS_ASSET_STATUS_READY); }
+    void setUploadBudget(t64 seconds) { uploadBudget = seconds; }
+    /*  Operational Methods */
+    //  Each returns WS_NULL if too many requests are outstanding
+    wsAssetHandle loadAnimation(const char* filepath, wsAssetCallback callback = WS_NULL, void* userData = WS_NULL);
+    wsAssetHandle loadMesh(const char* filepath, wsAssetCallback callback = WS_NULL, void* userData = WS_NULL);
+    wsAssetHandle loadSound(const char* filepath, wsAssetCallback callback = WS_NULL, void* userData = WS_NULL);
+    wsAssetHandle loadTexture(const char* filepath, bool autoSmooth = true, bool tiling = false,
+                              wsAssetCallback callback = WS_NULL, void* userData = WS_NULL);
+    //  Reads, parses and decodes a request; run by the worker threads
+    void process(u32 slot);
+    //  Frees a finished request's handle for reuse
+    void release(wsAssetHandle handle);
+    //  Creates waiting assets on the main thread until the upload budget is spent, and
+    //  runs the callbacks of the requests which finish. Called once per frame.
+    void update();
+    //  Blocks until the request finishes, doing uploads meanwhile; returns its status.
+    //  Meant for loading screens.
+    u32 waitFor(wsAssetHandle handle);
+    //  Blocks a worker thread until there is a request to process; returns false when
+    //  the thread should exit
+    bool waitForWork(u32* slot);
+    //  Uninitializes the asset loader
+    void shutDown();
+    //  Initializes the asset loader
+    void startUp(u32 myNumThreads = WS_DEFAULT_LOADER_THREADS, u32 myMaxRequests = WS_DEFAULT_MAX_ASSET_REQUESTS,
+                  t64 myUploadBudget = WS_DEFAULT_UPLOAD_BUDGET);
+};
+
+extern wsAssetLoader wsLoader;
+
+#endif /* WS_ASSET_LOADER_H_ */
@@ -35,7 +35,7 @@ wsEventManager wsEvents;
 
 void wsEventManager::startUp() {
     _mInitialized = true;
-    events = wsNew(wsStack<wsEvent>, wsStack<wsEvent>(WS_EVENT_QUEUE_SIZE));
+    events = wsNew(wsQueue<wsEvent>, wsQueue<wsEvent>(WS_EVENT_QUEUE_SIZE));
 }
 
 void wsEventManager::shutDown() {
@@ -249,7 +249,8 @@ struct wsEvent {
 
 class wsEventManager {
     private:
-        wsStack<wsEvent>* events;
+        //  Events are handled in the order they were pushed
+        wsQueue<wsEvent>* events;
         //  True only when the startUp function has been called
         bool _mInitialized;
     public:
@@ -277,6 +278,11 @@ class wsEventManager {
             wsAssert(_mInitialized, "Initialize the Event Manager first.");
             return events->pop();
         }
+        //  Moves the oldest event into my; returns false if there are none left
+        bool pop(wsEvent& my) {
+            wsAssert(_mInitialized, "Initialize the Event Manager first.");
+            return events->pop(my);
+        }
 };
 
 extern wsEventManager wsEvents;
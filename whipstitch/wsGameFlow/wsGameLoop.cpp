@@ -39,6 +39,7 @@
 */
 
 #include "wsGameLoop.h"
+#include "wsAssetLoader.h"
 #include "wsInputManager.h"
 #include "../wsAudio/wsSoundManager.h"
 
@@ -77,8 +78,8 @@ void wsGameLoop::continueLoop() {
 }
 
 void wsGameLoop::handleEvents() {
-  while (wsEvents.isNotEmpty()) {
-    wsEvent my = wsEvents.pop();
+  wsEvent my;
+  while (wsEvents.pop(my)) {
     game->onEvent(my);
   }
 }
@@ -99,6 +100,8 @@ void wsGameLoop::iterateLoop() {
   u32 framesSkipped = 0;
   //  Update the gamestate and draw the game
   updateGameState();
+  //  Finish any assets which have loaded in the background, within their time budget
+  wsLoader.update();
   wsRenderer.drawScene(game->getCurrentScene());
   //  Get the ending time of our state update
   t32 timeDiff = wsGetTime() - beginTime;
@@ -33,14 +33,15 @@
 */
 #include "wsScene.h"
 
-wsScene::wsScene(vec4 myGravity) {
+wsScene::wsScene(vec4 myGravity, u32 numModels, u32 numPrimitives, u32 numCameras) {
   gravity = myGravity;
-  cameras = wsNew(wsHashMap<wsCamera*>, wsHashMap<wsCamera*>(WS_MAX_CAMERAS));
-  models = wsNew(wsHashMap<wsModel*>, wsHashMap<wsModel*>(WS_MAX_MODELS));
-  primitives = wsNewArray(wsPrimitive*, WS_MAX_PRIMITIVES);
+  cameras = wsNew(wsHashMap<wsCamera*>, wsHashMap<wsCamera*>(numCameras));
+  models = wsNew(wsHashMap<wsModel*>, wsHashMap<wsModel*>(numModels));
+  primitives = wsNew(wsArray<wsPrimitive*>, wsArray<wsPrimitive*>(numPrimitives));
   //  Instantiate physics engine
   #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    rigidBodies = wsNew(wsHashMap<btRigidBody*>, wsHashMap<btRigidBody*>(WS_MAX_MODELS));
+    rigidBodies = wsNew(wsHashMap<btRigidBody*>, wsHashMap<btRigidBody*>(numModels));
+    activeBodies = wsNew(wsHashMap<btRigidBody*>, wsHashMap<btRigidBody*>(numModels));
     broadphase = wsNew(btDbvtBroadphase,  btDbvtBroadphase());
     collisionConfig = wsNew(btDefaultCollisionConfiguration, btDefaultCollisionConfiguration());
     dispatcher = wsNew(btCollisionDispatcher, btCollisionDispatcher(collisionConfig));
@@ -48,17 +49,14 @@ wsScene::wsScene(vec4 myGravity) {
     physicsWorld = wsNew(btDiscreteDynamicsWorld, btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfig));
     physicsWorld->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
   #endif
-  numPrimitives = 0;
 }
 
-void wsScene::addAnimation(wsAnimation* myAnim, const char* modelName) {
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+void wsScene::addAnimation(wsAnimation* myAnim, u32 modelHash) {
+  wsModel* myModel = models->retrieve(modelHash);
   myModel->addAnimation(myAnim);
   #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    char animName[512];
-    strcpy(animName, modelName);
-    strcat(animName, myAnim->getName());
-    u32 boundsHash = wsHash(animName);
+    //  Each animation has its own bounds, keyed by the model and animation together
+    u32 boundsHash = wsHashCombine(modelHash, wsHash(myAnim->getName()));
     const vec4 dimensions = myAnim->getBounds();
     btCollisionShape* boundsShape;
     if (myModel->getCollisionShape() == WS_NULL) {
@@ -145,6 +143,7 @@ u32 wsScene::addModel(wsModel* myModel) {
       }
       modelRigidBody->setActivationState(DISABLE_DEACTIVATION);
       rigidBodies->insert(modelHash, modelRigidBody);
+      activeBodies->insert(modelHash, modelRigidBody);
       physicsWorld->addRigidBody(modelRigidBody, myModel->getCollisionClass(),
         collisionClasses[(u32)wsLog2(myModel->getCollisionClass())]);
     #endif
@@ -154,8 +153,8 @@ u32 wsScene::addModel(wsModel* myModel) {
 }// End addModel(wsModel*) method
 
 u32 wsScene::addPrimitive(wsPrimitive* myPrimitive) {
-  wsAssert(numPrimitives < WS_MAX_PRIMITIVES, "Cannot add another primitive to the scene. Maximum already reached.");
-  primitives[numPrimitives] = myPrimitive;
+  u32 primIndex = primitives->getLength();
+  primitives->push(myPrimitive);
   #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
     switch (myPrimitive->getType()) {
       case WS_PRIM_TYPE_PLANE:
@@ -188,169 +187,98 @@ u32 wsScene::addPrimitive(wsPrimitive* myPrimitive) {
         break;
     }
   #endif
-  return numPrimitives++;
+  return primIndex;
 }
 
 void wsScene::attachModel(const char* modelSource, const char* modelDest, const char* jointName) {
-  models->retrieve(wsHash(modelDest))->attachModel(models->retrieve(wsHash(modelSource)), jointName);
+  getModel(modelDest)->attachModel(getModel(modelSource), jointName);
+}
+
+void wsScene::attachModel(wsNameHandle modelSource, wsNameHandle modelDest, wsNameHandle jointName) {
+  getModel(modelDest)->attachModel(getModel(modelSource), jointName);
 }
 
 void wsScene::beginAnimation(const char* modelName, const char* animName) {
   wsEcho(WS_LOG_GRAPHICS, "Model %s - Beginning Animation: %s\n", modelName, animName);
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+  beginAnimation(wsHash(modelName), wsHash(animName))->beginAnimation(animName);
+}
+
+void wsScene::beginAnimation(wsNameHandle modelName, wsNameHandle animName) {
+  wsEcho(WS_LOG_GRAPHICS, "Model %s - Beginning Animation: %s\n",
+          wsNames.getName(modelName), wsNames.getName(animName));
+  beginAnimation(wsNames.getHash(modelName), wsNames.getHash(animName))->beginAnimation(animName);
+}
+
+//  Swaps the model's rigid body for the one bounding the new animation; the caller
+//  starts the animation on the returned model.
+wsModel* wsScene::beginAnimation(u32 modelHash, u32 animHash) {
+  wsModel* myModel = models->retrieve(modelHash);
   #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    char myAnim[512];
-    if (myModel->getCurrentAnimation() == NULL) {
-      physicsWorld->removeRigidBody(rigidBodies->retrieve(wsHash(modelName)));
-    }
-    else {
-      strcpy(myAnim, modelName);
-      strcat(myAnim, myModel->getCurrentAnimationName());
-      physicsWorld->removeRigidBody(rigidBodies->retrieve(wsHash(myAnim)));
-    }
-    strcpy(myAnim, modelName);
-    strcat(myAnim, animName);
-    btRigidBody* myRigidBody = rigidBodies->retrieve(wsHash(myAnim));
+    physicsWorld->removeRigidBody(activeBodies->retrieve(modelHash));
+    btRigidBody* myRigidBody = rigidBodies->retrieve(wsHashCombine(modelHash, animHash));
     myRigidBody->setMotionState(myModel->getTransformp());
     // myRigidBody->setCollisionFlags(myRigidBody->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
     myRigidBody->setActivationState(DISABLE_DEACTIVATION);
     physicsWorld->addRigidBody(myRigidBody, myModel->getCollisionClass(),
       collisionClasses[(u32)wsLog2(myModel->getCollisionClass())]);
+    activeBodies->replace(modelHash, myRigidBody);
   #endif
-  myModel->beginAnimation(animName);
-}
-
-void wsScene::continueAnimation(const char* modelName) {
-  models->retrieve(wsHash(modelName))->continueAnimation();
+  return myModel;
 }
 
 void wsScene::continueAnimations() {
-  wsHashMap<wsModel*>::iterator it = models->begin();
-  for (u32 i = 0; i < models->getLength(); ++i) {
-    models->getArrayItem(it.mCurrentElement)->continueAnimation();
-    ++it;
+  for (wsHashMap<wsModel*>::iterator it = models->begin(); it.isValid(); ++it) {
+    it.get()->continueAnimation();
   }
 }
 
-void wsScene::moveModel(const char* modelName, const vec4& dist) {
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+void wsScene::moveModel(u32 modelHash, const vec4& dist) {
+  wsModel* myModel = findModel(modelHash);
   if (myModel == WS_NULL) { return; }
   myModel->move(dist);
-  #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    btRigidBody* myRigidBody;
-    char myAnim[512];
-    if (myModel->getCurrentAnimation() == NULL) {
-      myRigidBody = rigidBodies->retrieve(wsHash(modelName));
-    }
-    else {
-      strcpy(myAnim, modelName);
-      strcat(myAnim, myModel->getCurrentAnimationName());
-      myRigidBody = rigidBodies->retrieve(wsHash(myAnim));
-    }
-    if (myRigidBody == WS_NULL) { return; }
-    myRigidBody->setMotionState(myModel->getTransformp());
-  #endif
+  syncRigidBody(modelHash, myModel);
 }
 
-vec4 wsScene::moveModelBackward(const char* modelName, const f32 dist) {
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+vec4 wsScene::moveModelBackward(u32 modelHash, const f32 dist) {
+  wsModel* myModel = findModel(modelHash);
   if (myModel == WS_NULL) { return vec4(); }
   vec4 myTranslation = myModel->moveBackward(dist);
-  #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    btRigidBody* myRigidBody;
-    char myAnim[512];
-    if (myModel->getCurrentAnimation() == NULL) {
-      myRigidBody = rigidBodies->retrieve(wsHash(modelName));
-    }
-    else {
-      strcpy(myAnim, modelName);
-      strcat(myAnim, myModel->getCurrentAnimationName());
-      myRigidBody = rigidBodies->retrieve(wsHash(myAnim));
-    }
-    if (myRigidBody == WS_NULL) { return vec4(); }
-    myRigidBody->setMotionState(myModel->getTransformp());
-  #endif
+  syncRigidBody(modelHash, myModel);
   return myTranslation;
 }
 
-vec4 wsScene::moveModelForward(const char* modelName, const f32 dist) {
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+vec4 wsScene::moveModelForward(u32 modelHash, const f32 dist) {
+  wsModel* myModel = findModel(modelHash);
   if (myModel == WS_NULL) { return vec4(); }
   vec4 myTranslation = myModel->moveForward(dist);
-  #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    btRigidBody* myRigidBody;
-    char myAnim[512];
-    if (myModel->getCurrentAnimation() == NULL) {
-      myRigidBody = rigidBodies->retrieve(wsHash(modelName));
-    }
-    else {
-      strcpy(myAnim, modelName);
-      strcat(myAnim, myModel->getCurrentAnimationName());
-      myRigidBody = rigidBodies->retrieve(wsHash(myAnim));
-    }
-    if (myRigidBody == WS_NULL) { return vec4(); }
-    myRigidBody->setMotionState(myModel->getTransformp());
-  #endif
+  syncRigidBody(modelHash, myModel);
   return myTranslation;
 }
 
-void wsScene::pauseAnimation(const char* modelName) {
-  models->retrieve(wsHash(modelName))->pauseAnimation();
-}
-
 void wsScene::pauseAnimations() {
-  wsHashMap<wsModel*>::iterator it = models->begin();
-  for (u32 i = 0; i < models->getLength(); ++i) {
-    models->getArrayItem(it.mCurrentElement)->pauseAnimation();
-    ++it;
+  for (wsHashMap<wsModel*>::iterator it = models->begin(); it.isValid(); ++it) {
+    it.get()->pauseAnimation();
   }
 }
 
-void wsScene::rotateModel(const char* modelName, const vec4& axis, const f32 angle) {
-  wsModel* myModel = models->retrieve(wsHash(modelName));
+void wsScene::rotateModel(u32 modelHash, const vec4& axis, const f32 angle) {
+  wsModel* myModel = findModel(modelHash);
   if (myModel == WS_NULL) { return; }
   myModel->rotate(axis, angle);
-  #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
-    btRigidBody* myRigidBody;
-    char myAnim[512];
-    if (myModel->getCurrentAnimation() == NULL) {
-      myRigidBody = rigidBodies->retrieve(wsHash(modelName));
-    }
-    else {
-      strcpy(myAnim, modelName);
-      strcat(myAnim, myModel->getCurrentAnimationName());
-      myRigidBody = rigidBodies->retrieve(wsHash(myAnim));
-    }
-    if (myRigidBody == WS_NULL) { return; }
-    myRigidBody->setMotionState(myModel->getTransformp());
-  #endif
-}
-
-void wsScene::setCameraMode(const char* cameraName, u32 cameraMode) {
-  cameras->retrieve(wsHash(cameraName))->setCameraMode(cameraMode);
+  syncRigidBody(modelHash, myModel);
 }
 
-void wsScene::setPos(const char* modelName, const vec4& pos) {
-  models->retrieve(wsHash(modelName))->setPos(pos);
-}
-
-void wsScene::setRotation(const char* modelName, const quat& rot) {
-  models->retrieve(wsHash(modelName))->setRotation(rot);
-}
-
-void wsScene::setScale(const char* modelName, const f32 scale) {
-  models->retrieve(wsHash(modelName))->setScale(scale);
-}
-
-void wsScene::updateAnimation(const char* modelName, t32 increment) {
-  models->retrieve(wsHash(modelName))->incrementAnimationTime(increment);
+void wsScene::syncRigidBody(u32 modelHash, wsModel* myModel) {
+  #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
+    btRigidBody** myRigidBody = activeBodies->find(modelHash);
+    if (myRigidBody == NULL) { return; }
+    (*myRigidBody)->setMotionState(myModel->getTransformp());
+  #endif
 }
 
 void wsScene::updateAnimations(t32 increment) {
-  wsHashMap<wsModel*>::iterator it = models->begin();
-  for (u32 i = 0; i < models->getLength(); ++i) {
-    models->getArrayItem(it.mCurrentElement)->incrementAnimationTime(increment);
-    ++it;
+  for (wsHashMap<wsModel*>::iterator it = models->begin(); it.isValid(); ++it) {
+    it.get()->incrementAnimationTime(increment);
   }
 }
 
@@ -362,7 +290,7 @@ void wsScene::updatePhysics(t32 increment) {
     btTransform transform;
     wsModel* myModel;
     btRigidBody* myBody;
-    for (wsHashMap<wsModel*>::iterator mod = models->begin(); mod.get() != WS_NULL; ++mod) {
+    for (wsHashMap<wsModel*>::iterator mod = models->begin(); mod.isValid(); ++mod) {
       myModel = models->getArrayItem(mod.mCurrentElement);
       myBody = rigidBodies->getArrayItem(mod.mCurrentElement);
       myBody->getMotionState()->getWorldTransform(transform);
@@ -51,49 +51,92 @@ class wsScene {
     vec4 gravity;
     wsHashMap<wsCamera*>* cameras;
     wsHashMap<wsModel*>* models;
-    wsPrimitive** primitives;
+    wsArray<wsPrimitive*>* primitives;
     #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
       wsHashMap<btRigidBody*>* rigidBodies;
+      //  The rigid body currently in the physics world for each model, by model hash
+      wsHashMap<btRigidBody*>* activeBodies;
       btBroadphaseInterface* broadphase;  //  Eliminates object pairs that should not collide
       btDefaultCollisionConfiguration* collisionConfig; //  fine-tunes collision algorithms
       btCollisionDispatcher* dispatcher;
       btSequentialImpulseConstraintSolver* solver;  //  solves physics interface
       btDiscreteDynamicsWorld* physicsWorld;
     #endif
-    u32 numPrimitives;
+    //  Private Methods
+    //  Shared by the name and handle versions of the public methods; each takes the hash
+    //  of the model's name.
+    void addAnimation(wsAnimation* myAnim, u32 modelHash);
+    wsModel* beginAnimation(u32 modelHash, u32 animHash);
+    wsModel* findModel(u32 modelHash) {
+      wsModel** myModel = models->find(modelHash);
+      return (myModel == NULL) ? NULL : *myModel;
+    }
+    void moveModel(u32 modelHash, const vec4& dist);
+    vec4 moveModelBackward(u32 modelHash, const f32 dist);
+    vec4 moveModelForward(u32 modelHash, const f32 dist);
+    void rotateModel(u32 modelHash, const vec4& axis, f32 angle);
+    //  Moves the model's active rigid body to match the model's transform
+    void syncRigidBody(u32 modelHash, wsModel* myModel);
   public:
     //  Constructors and Deconstructors
-    wsScene(vec4 myGravity = vec4(0.0f, 0.0f, 0.0f, 0.0f));
+    //  The element counts are initial capacities; the scene grows past them as needed
+    wsScene(vec4 myGravity = vec4(0.0f, 0.0f, 0.0f, 0.0f), u32 numModels = WS_DEFAULT_NUM_MODELS,
+            u32 numPrimitives = WS_DEFAULT_NUM_PRIMITIVES, u32 numCameras = WS_DEFAULT_NUM_CAMERAS);
     //  Setters and Getters
     wsCamera* getCamera(const char* cameraName) { return cameras->retrieve(wsHash(cameraName)); }
+    wsCamera* getCamera(wsNameHandle cameraName) { return cameras->retrieve(wsNames.getHash(cameraName)); }
     wsHashMap<wsCamera*>* getCameras() { return cameras; }
     wsModel* getModel(const char* modelName) { return models->retrieve(wsHash(modelName)); }
+    wsModel* getModel(wsNameHandle modelName) { return models->retrieve(wsNames.getHash(modelName)); }
     wsHashMap<wsModel*>* getModels() { return models; }
-    u32 getNumPrimitives() { return numPrimitives; }
-    wsPrimitive** getPrimitives() { return primitives; }
+    u32 getNumPrimitives() { return primitives->getLength(); }
+    wsPrimitive** getPrimitives() { return primitives->getArray(); }
     void setCollisionClass(const u64 classID, const u64 collidesWithBitflag) {
       collisionClasses[(u32)wsLog2(classID)] = collidesWithBitflag;
     }
     //  Operational Methods
-    void addAnimation(wsAnimation* myAnim, const char* modelName);
+    //  Methods which name a model, camera, or animation accept either the name itself or
+    //  its handle from wsNames. Handles skip all string hashing, so they are preferred
+    //  for calls made every frame.
+    void addAnimation(wsAnimation* myAnim, const char* modelName) { addAnimation(myAnim, wsHash(modelName)); }
+    void addAnimation(wsAnimation* myAnim, wsNameHandle modelName) { addAnimation(myAnim, wsNames.getHash(modelName)); }
     u32 addCamera(wsCamera* myCam);
     u32 addModel(wsModel* myModel);
     u32 addPrimitive(wsPrimitive* myPrimitive);
     void attachModel(const char* modelSource, const char* modelDest, const char* jointName);
+    void attachModel(wsNameHandle modelSource, wsNameHandle modelDest, wsNameHandle jointName);
     void beginAnimation(const char* modelName, const char* animName);
-    void continueAnimation(const char* modelName);
+    void beginAnimation(wsNameHandle modelName, wsNameHandle animName);
+    void continueAnimation(const char* modelName) { models->retrieve(wsHash(modelName))->continueAnimation(); }
+    void continueAnimation(wsNameHandle modelName) { models->retrieve(wsNames.getHash(modelName))->continueAnimation(); }
     void continueAnimations();
-    void moveModel(const char* modelName, const vec4& dist);
-    vec4 moveModelBackward(const char* modelName, const f32 dist);
-    vec4 moveModelForward(const char* modelName, const f32 dist);
-    void pauseAnimation(const char* modelName);
+    void moveModel(const char* modelName, const vec4& dist) { moveModel(wsHash(modelName), dist); }
+    void moveModel(wsNameHandle modelName, const vec4& dist) { moveModel(wsNames.getHash(modelName), dist); }
+    vec4 moveModelBackward(const char* modelName, const f32 dist) { return moveModelBackward(wsHash(modelName), dist); }
+    vec4 moveModelBackward(wsNameHandle modelName, const f32 dist) {
+      return moveModelBackward(wsNames.getHash(modelName), dist);
+    }
+    vec4 moveModelForward(const char* modelName, const f32 dist) { return moveModelForward(wsHash(modelName), dist); }
+    vec4 moveModelForward(wsNameHandle modelName, const f32 dist) {
+      return moveModelForward(wsNames.getHash(modelName), dist);
+    }
+    void pauseAnimation(const char* modelName) { models->retrieve(wsHash(modelName))->pauseAnimation(); }
+    void pauseAnimation(wsNameHandle modelName) { models->retrieve(wsNames.getHash(modelName))->pauseAnimation(); }
     void pauseAnimations();
-    void rotateModel(const char* modelName, const vec4& axis, f32 angle);
-    void setCameraMode(const char* cameraName, u32 cameraMode);
-    void setPos(const char* modelName, const vec4& pos);
-    void setRotation(const char* modelName, const quat& rot);
-    void setScale(const char* modelName, const f32 scale);
-    void updateAnimation(const char* modelName, t32 increment);
+    void rotateModel(const char* modelName, const vec4& axis, f32 angle) { rotateModel(wsHash(modelName), axis, angle); }
+    void rotateModel(wsNameHandle modelName, const vec4& axis, f32 angle) {
+      rotateModel(wsNames.getHash(modelName), axis, angle);
+    }
+    void setCameraMode(const char* cameraName, u32 cameraMode) { getCamera(cameraName)->setCameraMode(cameraMode); }
+    void setCameraMode(wsNameHandle cameraName, u32 cameraMode) { getCamera(cameraName)->setCameraMode(cameraMode); }
+    void setPos(const char* modelName, const vec4& pos) { getModel(modelName)->setPos(pos); }
+    void setPos(wsNameHandle modelName, const vec4& pos) { getModel(modelName)->setPos(pos); }
+    void setRotation(const char* modelName, const quat& rot) { getModel(modelName)->setRotation(rot); }
+    void setRotation(wsNameHandle modelName, const quat& rot) { getModel(modelName)->setRotation(rot); }
+    void setScale(const char* modelName, const f32 scale) { getModel(modelName)->setScale(scale); }
+    void setScale(wsNameHandle modelName, const f32 scale) { getModel(modelName)->setScale(scale); }
+    void updateAnimation(const char* modelName, t32 increment) { getModel(modelName)->incrementAnimationTime(increment); }
+    void updateAnimation(wsNameHandle modelName, t32 increment) { getModel(modelName)->incrementAnimationTime(increment); }
     void updateAnimations(t32 increment);
     void updatePhysics(const t32 increment);
 };
@@ -50,22 +50,10 @@ void wsThreadPool::unlockMutex(wsMutex* myMutex) {
 void* wsRunThread(void* threadID) {
     wsAssert(wsThreads.isInitialized(), "The object wsTasks must be initialized via the startUp() method before use.");
     //  Create a single thread and begin running...
-    wsQueue<wsTask*>* tasks = wsThreads.getTaskList();
     u32 threadNum = *(u32*)threadID;
-    wsTask* myTask = NULL;
-    wsMutex* listMutex = wsThreads.getListMutex();
     wsMutex* logMutex = wsThreads.getLogMutex();
     while (!wsThreads.killSignalReceived()) {
-        wsThreads.lockMutex(listMutex);
-        if (tasks->isNotEmpty()) {
-            wsEcho(WS_LOG_THREADS, "Removing task from front of queue; running on thread number %u", threadNum);
-            myTask = tasks->pop();
-        }
-        wsThreads.unlockMutex(listMutex);
-        if (myTask != NULL) {
-            myTask->run(threadNum);
-            myTask = NULL;
-        }
+        wsThreads.runPendingTask(threadNum);
     }
     wsThreads.lockMutex(logMutex);
     wsEcho(WS_LOG_THREADS, "Exiting thread number %u", threadNum);
@@ -96,7 +84,7 @@ void wsThreadPool::startUp() {
     logMutex = wsNew(wsMutex, wsMutex());
     wsInitMutex(listMutex);
     wsInitMutex(logMutex);
-    taskList = wsNew(wsQueue<wsTask*>, wsQueue<wsTask*>(WS_MAX_TASK_QUEUE_SIZE));
+    taskList = wsNew(wsQueue<wsTask*>, wsQueue<wsTask*>(WS_DEFAULT_TASK_QUEUE_SIZE));
     tasksRunning = 0;
     wsEcho(WS_LOG_THREADS, "Initializing %u Worker Threads", numThreads);
     for (u32 i = 0; i < numThreads; ++i) {
@@ -122,16 +110,30 @@ void wsThreadPool::pushTask(wsTask* task) {
     lockMutex(listMutex);
 
     if (numThreads <= 0) {
+        unlockMutex(listMutex);
         task->run(0);
         return;
     }
-    wsAssert(taskList->isNotFull(), "Cannot push task onto the queue.");
+    //  The task list grows as needed, so a burst of tasks is never dropped
     taskList->push(task);
 
     /*  Unlock the mutex    */
     unlockMutex(listMutex);
 }
 
+bool wsThreadPool::runPendingTask(const u32 threadNum) {
+    wsTask* myTask = NULL;
+    lockMutex(listMutex);
+    if (taskList->isNotEmpty()) {
+        wsEcho(WS_LOG_THREADS, "Removing task from front of queue; running on thread number %u", threadNum);
+        myTask = taskList->pop();
+    }
+    unlockMutex(listMutex);
+    if (myTask == NULL) { return false; }
+    myTask->run(threadNum);
+    return true;
+}
+
 void wsThreadPool::runThread(const u32 threadNum) {
     wsAssert(_mInitialized, "The object wsTasks must be initialized via the startUp() method before use.");
     wsAssert(threadNum < numThreads, "Cannot run thread beyond the number of processors.");
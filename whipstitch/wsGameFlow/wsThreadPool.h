@@ -39,9 +39,11 @@
 #ifndef WS_THREAD_POOL_H_
 #define WS_THREAD_POOL_H_
 
-#define WS_MAX_TASK_QUEUE_SIZE 64
+#define WS_DEFAULT_TASK_QUEUE_SIZE 64
 
 #include "wsTask.h"
+#include <atomic>
+#include <thread>   //  std::this_thread::yield()
 
 #ifdef WS_OS_FAMILY_UNIX
     #include <pthread.h>
@@ -100,12 +102,64 @@ class wsThreadPool {
         void lockMutex(wsMutex* myMutex);
         void unlockMutex(wsMutex* myMutex);
         void pushTask(wsTask* task);
+        //  Takes the task at the front of the queue and runs it here, if there is one
+        bool runPendingTask(const u32 threadNum);
         void runThread(const u32 threadNum);
         void waitForCompletion();
 };
 
 extern wsThreadPool wsThreads;
 
+/*  Parallel Chunks */
+#define WS_MAX_PARALLEL_CHUNKS 64
+
+//  One share of the work handed out by wsRunParallelChunks(...)
+template<typename BodyType>
+class wsChunkTask : public wsTask {
+    public:
+        const BodyType* body;
+        u32 first;
+        u32 last;
+        std::atomic<u32>* remaining;
+        void run(u32) {
+            (*body)(first, last);
+            remaining->fetch_sub(1, std::memory_order_release);
+        }
+};
+
+//  Splits the range [0, count) into chunks of at least minChunk and calls body(first, last)
+//  for each, one chunk per worker thread plus one on the calling thread, returning once all
+//  of them are done. When the thread pool has not been started, body(0, count) simply runs
+//  here. The body must be safe to run on several threads at once. While it waits the calling
+//  thread runs queued tasks itself, so a body may split its own work the same way.
+template<typename BodyType>
+void wsRunParallelChunks(u32 count, u32 minChunk, const BodyType& body) {
+    u32 numChunks = 1;
+    if (wsThreads.isInitialized() && !wsThreads.killSignalReceived()) {
+        numChunks = wsMin(wsThreads.getNumThreads() + 1, (u32)WS_MAX_PARALLEL_CHUNKS);
+        numChunks = wsMin(numChunks, count / wsMax(minChunk, 1u));
+    }
+    if (numChunks <= 1) {
+        body(0, count);
+        return;
+    }
+    wsChunkTask<BodyType> tasks[WS_MAX_PARALLEL_CHUNKS];
+    std::atomic<u32> remaining(numChunks - 1);
+    for (u32 c = 1; c < numChunks; ++c) {
+        tasks[c].body = &body;
+        tasks[c].first = (u32)((u64)count*c / numChunks);
+        tasks[c].last = (u32)((u64)count*(c+1) / numChunks);
+        tasks[c].remaining = &remaining;
+        wsThreads.pushTask(&tasks[c]);
+    }
+    body(0, count / numChunks);
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (!wsThreads.runPendingTask(wsThreads.getNumThreads())) {
+            std::this_thread::yield();
+        }
+    }
+}
+
 #ifdef WS_OS_FAMILY_UNIX
 void* wsRunThread(void* threadID);
 #elif defined(WS_OS_FAMILY_WINDOWS)
@@ -36,7 +36,10 @@
 
 #include "wsGraphics/wsCamera.h"
 #include "wsGraphics/wsColors.h"
+#include "wsGraphics/wsMipmaps.h"
 #include "wsGraphics/wsRenderSystem.h"
 #include "wsGraphics/wsScreenManager.h"
+#include "wsGraphics/wsTextureCompressor.h"
+#include "wsGraphics/wsTextureFile.h"
 
 #endif /* WS_GRAPHICS_H_ */
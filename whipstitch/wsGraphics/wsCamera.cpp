@@ -122,6 +122,73 @@ const vec4 wsCamera::getWorldCoords(const f32 myX, const f32 myY) const {
   return coords;
 }
 
+wsFrustum wsCamera::getFrustum() const {
+  wsFrustum frustum;
+  if (cameraMode == WS_CAMERA_MODE_ORTHO) {
+    //  Matches gluOrtho2D(...) in draw(), which spans the HUD and depths -1 to 1
+    frustum.planes[WS_FRUSTUM_LEFT] = vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    frustum.planes[WS_FRUSTUM_RIGHT] = vec4(-1.0f, 0.0f, 0.0f, WS_HUD_WIDTH);
+    frustum.planes[WS_FRUSTUM_BOTTOM] = vec4(0.0f, 1.0f, 0.0f, 0.0f);
+    frustum.planes[WS_FRUSTUM_TOP] = vec4(0.0f, -1.0f, 0.0f, WS_HUD_HEIGHT);
+    frustum.planes[WS_FRUSTUM_NEAR] = vec4(0.0f, 0.0f, -1.0f, 1.0f);
+    frustum.planes[WS_FRUSTUM_FAR] = vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    return frustum;
+  }
+  f32 halfHeight = wsTan(fov*0.5f);
+  f32 halfWidth = halfHeight*aspectRatio;
+  //  Each side plane passes through the camera and one edge of the view
+  vec4 edges[4] = { dir - rightDir*halfWidth, dir + rightDir*halfWidth,
+                    dir - upDir*halfHeight, dir + upDir*halfHeight };
+  vec4 axes[4] = { upDir, upDir, rightDir, rightDir };
+  for (u32 p = 0; p < 4; ++p) {
+    vec4 normal = axes[p].crossProduct(edges[p]).normal();
+    //  Face inward, toward the center of the view
+    if (normal.dotProduct(dir) < 0.0f) {
+      normal = -normal;
+    }
+    frustum.planes[p] = vec4(normal.x, normal.y, normal.z,
+                             -(normal.x*pos.x + normal.y*pos.y + normal.z*pos.z));
+  }
+  vec4 nearPoint = pos + dir*zNear;
+  vec4 farPoint = pos + dir*zFar;
+  frustum.planes[WS_FRUSTUM_NEAR] = vec4(dir.x, dir.y, dir.z,
+                                         -(dir.x*nearPoint.x + dir.y*nearPoint.y + dir.z*nearPoint.z));
+  frustum.planes[WS_FRUSTUM_FAR] = vec4(-dir.x, -dir.y, -dir.z,
+                                        dir.x*farPoint.x + dir.y*farPoint.y + dir.z*farPoint.z);
+  return frustum;
+}
+
+wsRay wsCamera::getPickRay(const f32 myX, const f32 myY) const {
+  if (cameraMode == WS_CAMERA_MODE_ORTHO) {
+    //  Straight into the HUD
+    return wsRay(vec4(myX - screenCoords.rectX, myY - screenCoords.rectY, 1.0f, 1.0f),
+                 vec4(0.0f, 0.0f, -1.0f, 0.0f));
+  }
+  //  Viewport coordinates, from -1 to 1 across the camera's screen
+  f32 viewX = (myX - screenCoords.rectX)/(screenCoords.rectW*0.5f) - 1.0f;
+  f32 viewY = (myY - screenCoords.rectY)/(screenCoords.rectH*0.5f) - 1.0f;
+  f32 halfHeight = wsTan(fov*0.5f);
+  f32 halfWidth = halfHeight*aspectRatio;
+  vec4 rayDir = dir + rightDir*(viewX*halfWidth) + upDir*(viewY*halfHeight);
+  rayDir.w = 0.0f;
+  return wsRay(pos, rayDir.normal());
+}
+
+f32 wsCamera::getScreenRadius(const vec4& center, const f32 radius) const {
+  if (cameraMode == WS_CAMERA_MODE_ORTHO) {
+    //  The HUD's height spans the viewport's
+    return radius*screenCoords.rectH/WS_HUD_HEIGHT;
+  }
+  f32 distanceSq = (center.x - pos.x)*(center.x - pos.x) + (center.y - pos.y)*(center.y - pos.y) +
+                   (center.z - pos.z)*(center.z - pos.z);
+  if (distanceSq <= radius*radius) {
+    //  The camera is inside the sphere, which fills the view
+    return screenCoords.rectH;
+  }
+  //  The sphere's silhouette subtends radius/sqrt(distance^2 - radius^2) of the view
+  return radius/(sqrtf(distanceSq - radius*radius)*wsTan(fov*0.5f))*screenCoords.rectH*0.5f;
+}
+
 bool wsCamera::isInFrame(f32 x, f32 y) const {
   return (x >= screenCoords.rectX && y >= screenCoords.rectY &&
       x <= screenCoords.rectX+screenCoords.rectW && y <= screenCoords.rectY+screenCoords.rectH);
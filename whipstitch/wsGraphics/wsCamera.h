@@ -107,6 +107,9 @@ class wsCamera {
     //  Operational Methods
     void draw();      //  Orient and draw the camera in OpenGL
     const vec4 getWorldCoords(const f32 myX, const f32 myY) const; //  Returns game-world positional coordinates translated from the given screen coordinates
+    wsFrustum getFrustum() const;   //  Returns the world-space volume which the camera can see
+    wsRay getPickRay(const f32 myX, const f32 myY) const; //  Returns the ray from the camera through the given viewport coordinates (origin at the bottom-left, as glViewport)
+    f32 getScreenRadius(const vec4& center, const f32 radius) const; //  Returns the radius in pixels which a sphere appears to have on the camera's viewport
     bool isInFrame(const f32 x, const f32 y) const;   //  Checks to see whether the given coordinates fall within the camera's viewport.
     void lookAt(const vec4& focal);  //  Direct the camera to a focal point (positional vector)
     void move(const vec4& vec);  //  Move the camera along the directional vector
@@ -0,0 +1,170 @@
+/*
+ * wsMipmaps.cpp
+ *
+ *    This file implements the mip chain builder of the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsMipmaps.h"
+#include "../wsUtils/wsOperations.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Steps of the table converting linear light back to sRGB; enough that no sRGB value
+//  is skipped, even in the darkest range where the curve is steepest
+#define WS_GAMMA_STEPS 4096
+
+struct wsGammaTables {
+  f32 toLinear[256];  //  sRGB to linear light in [0, 1]
+  f32 toValue[256];   //  Linear data as it is, so four of them sum exactly
+  u8 toSRGB[WS_GAMMA_STEPS];
+  wsGammaTables() {
+    for (u32 i = 0; i < 256; ++i) {
+      const f32 c = i / 255.0f;
+      toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+      toValue[i] = (f32)i;
+    }
+    for (u32 i = 0; i < WS_GAMMA_STEPS; ++i) {
+      const f32 l = i / (f32)(WS_GAMMA_STEPS-1);
+      const f32 c = (l <= 0.0031308f) ? l*12.92f : 1.055f*powf(l, 1.0f/2.4f) - 0.055f;
+      toSRGB[i] = (u8)(c*255.0f + 0.5f);
+    }
+  }
+};
+
+static const wsGammaTables& wsGetGammaTables() {
+  //  Built on first use, which is safe from any number of loader threads at once
+  static const wsGammaTables tables;
+  return tables;
+}
+
+//  Converts one row of an image to floats, leaving the padding after it untouched
+template<u32 channels>
+static void wsDecodeRow(f32* dest, const u8* src, u32 width, const f32* const* tables) {
+  for (u32 x = 0; x < width; ++x) {
+    for (u32 c = 0; c < channels; ++c) {
+      dest[c] = tables[c][src[c]];
+    }
+    dest += channels;
+    src += channels;
+  }
+}
+
+//  The work of wsDownsample(...), with the number of channels fixed so each pixel's loops
+//  unroll. rows holds two source rows of floats, each followed by a register of padding.
+template<u32 channels>
+static void wsDownsampleRows(u8* dest, const u8* src, u32 srcWidth, u32 srcHeight, bool linear, f32* rows) {
+  const wsGammaTables& gamma = wsGetGammaTables();
+  const u32 width = wsMax(srcWidth/2, 1u);
+  const u32 height = wsMax(srcHeight/2, 1u);
+  const u32 srcPitch = srcWidth*channels;
+  //  Alpha is coverage rather than light, so it averages as it is
+  bool isValue[channels];
+  const f32* tables[channels];
+  for (u32 c = 0; c < channels; ++c) {
+    isValue[c] = (linear || (channels == 2 && c == 1) || c == 3);
+    tables[c] = isValue[c] ? gamma.toValue : gamma.toLinear;
+  }
+  f32* row0 = rows;
+  f32* row1 = rows + srcPitch + 4;
+  for (u32 y = 0; y < height; ++y) {
+    wsDecodeRow<channels>(row0, src + (y*2)*srcPitch, srcWidth, tables);
+    const f32* below = row0;
+    if (y*2+1 < srcHeight) {
+      wsDecodeRow<channels>(row1, src + (y*2+1)*srcPitch, srcWidth, tables);
+      below = row1;
+    }
+    #if WS_SUPPORTS_SSE == WS_TRUE
+      const __m128 quarter = _mm_set1_ps(0.25f);
+      const __m128 half = _mm_set1_ps(0.5f);
+      const __m128 steps = _mm_set1_ps((f32)(WS_GAMMA_STEPS-1));
+      alignas(16) i32 values[4];
+      alignas(16) i32 indices[4];
+      for (u32 x = 0; x < width; ++x) {
+        //  Lanes past the pixel's channels hold the next pixel, and go unused
+        const u32 x0 = (x*2)*channels;
+        const u32 x1 = wsMin(x*2+1, srcWidth-1)*channels;
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1));
+        sum = _mm_add_ps(sum, _mm_add_ps(_mm_loadu_ps(below + x0), _mm_loadu_ps(below + x1)));
+        const __m128 average = _mm_mul_ps(sum, quarter);
+        _mm_store_si128((__m128i*)values, _mm_cvttps_epi32(_mm_add_ps(average, half)));
+        _mm_store_si128((__m128i*)indices, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(average, steps), half)));
+        for (u32 c = 0; c < channels; ++c) {
+          dest[c] = isValue[c] ? (u8)values[c] : gamma.toSRGB[indices[c]];
+        }
+        dest += channels;
+      }
+    #else
+      for (u32 x = 0; x < width; ++x) {
+        const u32 x0 = (x*2)*channels;
+        const u32 x1 = wsMin(x*2+1, srcWidth-1)*channels;
+        for (u32 c = 0; c < channels; ++c) {
+          const f32 average = (row0[x0+c] + row0[x1+c] + below[x0+c] + below[x1+c])*0.25f;
+          dest[c] = isValue[c] ? (u8)(average + 0.5f) : gamma.toSRGB[(u32)(average*(WS_GAMMA_STEPS-1) + 0.5f)];
+        }
+        dest += channels;
+      }
+    #endif
+  }
+}
+
+void wsDownsample(u8* dest, const u8* src, u32 srcWidth, u32 srcHeight, u32 channels, bool linear) {
+  wsAssert(channels >= 1 && channels <= 4, "Images have 1 to 4 channels.");
+  //  Each pixel is read as a whole register, so every row has a register of padding
+  //  after its last pixel
+  const u32 rowLength = srcWidth*channels + 4;
+  f32* rows = (f32*)malloc(sizeof(f32)*rowLength*2);
+  wsAssert(rows, "Could not allocate rows for downsampling.");
+  memset(rows + rowLength-4, 0, sizeof(f32)*4);
+  memset(rows + rowLength*2-4, 0, sizeof(f32)*4);
+  switch (channels) {
+    case 1:   wsDownsampleRows<1>(dest, src, srcWidth, srcHeight, linear, rows); break;
+    case 2:   wsDownsampleRows<2>(dest, src, srcWidth, srcHeight, linear, rows); break;
+    case 3:   wsDownsampleRows<3>(dest, src, srcWidth, srcHeight, linear, rows); break;
+    default:  wsDownsampleRows<4>(dest, src, srcWidth, srcHeight, linear, rows); break;
+  }
+  free(rows);
+}
+
+u32 wsBuildMipChain(u8** dest, wsTextureLevel* levels, const u8* pixels, u32 width, u32 height, u32 channels,
+                    bool linear) {
+  wsAssert(channels == 3 || channels == 4, "Mip chains are built for RGB8 and RGBA8 textures.");
+  const u32 format = (channels == 3) ? WS_TEXTURE_FORMAT_RGB8 : WS_TEXTURE_FORMAT_RGBA8;
+  const u32 numLevels = wsTextureLevels(levels, format, width, height, 0);
+  const wsTextureLevel& last = levels[numLevels-1];
+  u8* chain = (u8*)malloc(last.offset + last.numBytes);
+  *dest = chain;
+  if (chain == WS_NULL) { return 0; }
+  const u32 pitch = width*channels;
+  for (u32 y = 0; y < height; ++y) {
+    memcpy(chain + y*pitch, pixels + (height-1-y)*pitch, pitch);
+  }
+  for (u32 l = 1; l < numLevels; ++l) {
+    wsDownsample(chain + levels[l].offset, chain + levels[l-1].offset, levels[l-1].width, levels[l-1].height,
+                  channels, linear);
+  }
+  return numLevels;
+}
@@ -0,0 +1,53 @@
+/*
+ * wsMipmaps.h
+ *
+ *    This file declares the mip chain builder of the Whipstitch Game Engine, which
+ *    turns a decoded image into every level a texture needs, ready for upload.
+ *
+ *    Color is filtered in linear light: each 2x2 box is converted from sRGB, averaged,
+ *    and converted back, so the levels keep the brightness of the full image instead
+ *    of darkening as a plain average of sRGB values does. Alpha, and every channel of
+ *    an image flagged as linear data such as a normal map, is averaged as it is. SSE
+ *    averages one pixel's channels in a single register.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MIPMAPS_H_
+#define WS_MIPMAPS_H_
+
+#include "wsTextureFile.h"
+
+//  Halves an image of 1 to 4 channels in each dimension by averaging 2x2 boxes. An odd
+//  last row or column is averaged with itself.
+void wsDownsample(u8* dest, const u8* src, u32 srcWidth, u32 srcHeight, u32 channels, bool linear = false);
+
+//  Builds every level of an RGB8 or RGBA8 texture, laid out as wsTextureLevels(...) does,
+//  into a single block from malloc(...) which the caller frees. pixels are given top row
+//  first, as image files store them; the levels have their bottom row first, as OpenGL
+//  takes them. Returns the number of levels, whose offsets are from the start of *dest.
+u32 wsBuildMipChain(u8** dest, wsTextureLevel* levels, const u8* pixels, u32 width, u32 height, u32 channels,
+                    bool linear = false);
+
+#endif /* WS_MIPMAPS_H_ */
@@ -122,7 +122,7 @@ void wsRenderSystem::startUp() {
   hudCam = wsNew(wsCamera, wsCamera("Hud Camera", vec4(0.0f, 0.0f, 1.0f), vec4(0.0f, 0.0f, -1.0f), vec4(0.0f, 1.0f),
     vec4(0.0f, 0.0f, wsScreenWidth, wsScreenHeight), WS_CAMERA_MODE_ORTHO, WS_DEFAULT_FOV, wsScreenWidth/wsScreenHeight, WS_DEFAULT_Z_NEAR,
     WS_DEFAULT_Z_FAR));
-  imageIndices = wsNew(wsHashMap<u32>, wsHashMap<u32>(WS_MAX_TEXTURES));
+  imageIndices = wsNew(wsHashMap<u32>, wsHashMap<u32>(WS_DEFAULT_NUM_TEXTURES));
   meshes = wsNew(wsHashMap<wsMeshContainer*>, wsHashMap<wsMeshContainer*>(101));
   panels = wsNew(wsOrderedHashMap<wsPanel*>, wsOrderedHashMap<wsPanel*>(101));
   if (!(drawFeatures & WS_DRAW_CURSOR)) {
@@ -252,7 +252,8 @@ void wsRenderSystem::initializeShaders(u32 width, u32 height) {
 
 u32 wsRenderSystem::addMesh(const char* filepath) {
   wsAssert(_mInitialized, "Must initialize the rendering system before adding a mesh.");
-  wsMesh* myMesh = wsNew(wsMesh, wsMesh(filepath));
+  wsMesh* myMesh = wsNew(wsMesh, wsMesh(filepath, wsMeshFormat(filepath)));
+  loadTextures(myMesh);
   wsMeshContainer* container = wsNew(wsMeshContainer, wsMeshContainer(myMesh));
   u32 meshHash = wsHash(filepath);
   if (meshes->insert(meshHash, container) == WS_SUCCESS) {
@@ -263,12 +264,7 @@ u32 wsRenderSystem::addMesh(const char* filepath) {
         const wsTriangle* tris = mats[i].tris;
         //  Create index arrays
         container->indexArrays[i].numIndices = mats[i].numTriangles*3;
-        container->indexArrays[i].indices = wsNewArray(u32, container->indexArrays[i].numIndices);
-        for (u32 t = 0; t < mats[i].numTriangles; ++t) {
-          container->indexArrays[i].indices[t*3] = tris[t].vertIndices[0];
-          container->indexArrays[i].indices[t*3+1] = tris[t].vertIndices[1];
-          container->indexArrays[i].indices[t*3+2] = tris[t].vertIndices[2];
-        }
+        container->indexArrays[i].indices = (u32*)tris;
         //  Generate opengl index arrays
         glGenBuffers(1, &container->indexArrays[i].handle);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, container->indexArrays[i].handle);
@@ -324,6 +320,12 @@ void wsRenderSystem::checkExtensions() {
   else {
     wsEcho(WS_LOG_GRAPHICS, "Fragment shaders not supported. :(\n");
   }
+  if (GLEW_EXT_texture_compression_s3tc) {
+    wsEcho(WS_LOG_GRAPHICS, "S3TC Texture Compression Supported.\n");
+  }
+  else {
+    wsEcho(WS_LOG_GRAPHICS, "S3TC Texture Compression Not Supported.\n");
+  }
 }
 
 void wsRenderSystem::clearScreen() {
@@ -333,6 +335,119 @@ void wsRenderSystem::clearScreen() {
   #endif
 }
 
+void wsRenderSystem::createTexture(u32* index, const char* filename, wsImage* image, bool autoSmooth, bool tiling) {
+  wsAssert(_mInitialized, "Must initialize the rendering system first.");
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    u32 fileHash = wsHash(filename);
+    u32* cached = imageIndices->find(fileHash);
+    if (cached != WS_NULL && *cached != 0) {
+      //  The same file may have been decoded twice for requests made at the same time
+      wsEcho(WS_LOG_GRAPHICS, "Texture file \"%s\" has already been loaded.\n", filename);
+      *index = *cached;
+      freeImage(image);
+      return;
+    }
+    u32 texture = 0;
+    if (image->cooked != WS_NULL) {
+      const wsTextureFile* cooked = image->cooked;
+      texture = uploadTexture(cooked->getFormat(), cooked->getLevels(), cooked->getNumLevels(), cooked->getData());
+    }
+    else if (image->pixels != WS_NULL) {
+      texture = uploadTexture((image->channels == 3) ? WS_TEXTURE_FORMAT_RGB8 : WS_TEXTURE_FORMAT_RGBA8,
+                              image->levels, image->numLevels, image->pixels);
+    }
+    *index = texture;
+    freeImage(image);
+    if (!(*index)) {
+      wsEcho(WS_LOG_ERROR, "Could not locate texture file: \"%s\"\n  SOIL error: %s\n", filename, SOIL_last_result());
+      if (strcmp(filename, "textures/wsDefaultTexture.png")) {
+        loadTexture(index, "textures/wsDefaultTexture.png", autoSmooth);
+      }
+    }
+    else {
+      wsEcho(WS_LOG_GRAPHICS, "Loaded texture file: \"%s\"\n", filename);
+      imageIndices->replace(fileHash, *index);
+      if (autoSmooth) {
+        glBindTexture(GL_TEXTURE_2D, *index);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+          if (tiling) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+          }
+          else {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+          }
+        glBindTexture(GL_TEXTURE_2D, 0);
+      }
+      else {
+        glBindTexture(GL_TEXTURE_2D, *index);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+          glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+          if (tiling) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+          }
+          else {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+          }
+        glBindTexture(GL_TEXTURE_2D, 0);
+      }
+    }
+  #endif
+}
+
+bool wsRenderSystem::decodeImage(wsImage* image, const char* filename, bool linear) {
+  image->pixels = WS_NULL;
+  image->cooked = WS_NULL;
+  image->numLevels = 0;
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    #if WS_USE_COOKED_TEXTURES
+      char cookedPath[WS_MAX_ASSET_PATH];
+      if (wsVFS.findCurrentCooked(cookedPath, filename, WS_TEXTURE_EXTENSION, WS_MAX_ASSET_PATH)) {
+        //  Loader threads may not use the memory stacks
+        wsTextureFile* cooked = (wsTextureFile*)malloc(sizeof(wsTextureFile));
+        wsAssert(cooked, "Could not allocate a cooked texture file.");
+        new(cooked) wsTextureFile();
+        if (cooked->open(cookedPath)) {
+          image->cooked = cooked;
+          image->width = cooked->getWidth();
+          image->height = cooked->getHeight();
+          image->channels = (cooked->getFormat() == WS_TEXTURE_FORMAT_RGB8 || cooked->getFormat() == WS_TEXTURE_FORMAT_BC1) ? 3 : 4;
+          return true;
+        }
+        cooked->~wsTextureFile();
+        free(cooked);
+      }
+    #endif
+    //  Read from a mounted pack if one holds it
+    wsMappedFile file;
+    if (!file.open(filename)) { return false; }
+    const u8* encoded = (const u8*)file.getData();
+    const i32 encodedSize = (i32)file.getSize();
+    i32 channels;
+    u8* decoded = SOIL_load_image_from_memory(encoded, encodedSize, &image->width, &image->height, &channels, SOIL_LOAD_AUTO);
+    if (decoded != WS_NULL && channels < 3) {
+      //  Grey images gain color channels, as levels are built in RGB8 or RGBA8
+      SOIL_free_image_data(decoded);
+      decoded = SOIL_load_image_from_memory(encoded, encodedSize, &image->width, &image->height, &channels,
+                                            (channels == 1) ? SOIL_LOAD_RGB : SOIL_LOAD_RGBA);
+      channels += 2;
+    }
+    if (decoded != WS_NULL) {
+      //  The levels are filtered here, on the loader thread, leaving the main thread only
+      //  the upload
+      image->channels = channels;
+      image->numLevels = wsBuildMipChain(&image->pixels, image->levels, decoded, image->width, image->height,
+                                          channels, linear);
+      SOIL_free_image_data(decoded);
+    }
+  #endif
+  return (image->pixels != WS_NULL);
+}
+
 void wsRenderSystem::disable(u32 renderingFeatures) {
   wsAssert(_mInitialized, "Must initialize the rendering system first.");
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
@@ -359,7 +474,7 @@ void wsRenderSystem::disable(u32 renderingFeatures) {
   drawFeatures &= renderingFeatures;
 }
 
-void wsRenderSystem::drawModels(wsHashMap<wsModel*>* models) {
+void wsRenderSystem::drawModels(wsHashMap<wsModel*>* models, const wsCamera* camera, u32 cameraSlot) {
   wsAssert(_mInitialized, "Must initialize the rendering system first.");
   wsModel* my;
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
@@ -367,14 +482,25 @@ void wsRenderSystem::drawModels(wsHashMap<wsModel*>* models) {
     // glPointSize(3.0f);
     glEnableVertexAttribArray(WS_VERT_ATTRIB_NUM_WEIGHTS);
   #endif
-  mat4 transform;
-  vec4 defaultPos;
-  for (wsHashMap<wsModel*>::iterator mod = models->begin(); mod.get() != WS_NULL; ++mod) {
+  mat4 modelMatrix;
+  for (wsHashMap<wsModel*>::iterator mod = models->begin(); mod.isValid(); ++mod) {
     my = models->getArrayItem(mod.mCurrentElement);
     wsAssert(my != NULL, "Cannot draw mesh; empty reference.");
     const wsMaterial* mats = my->getMesh()->getMats();
     wsAssert(mats != NULL, "Cannot use material; empty reference.");
-    transform = my->getTransform().toMatrix();
+    //  Composed in the order the vertices see them: attachment point, parent model,
+    //  the offset from the default position, then this model
+    mat34 transform;
+    transform.setTranslation(-my->getMesh()->getDefaultPos());
+    transform *= my->getTransform().toAffine();
+    if (my->getAttachmentTransform() != WS_NULL) {   //  This is attached to another model
+      wsAssert(my->getAttachmentLoc() != WS_NULL, "Model has null attachment location");
+      wsAssert(my->getAttachmentRot() != WS_NULL, "Model has null attachment rotation");
+      mat34 parent = my->getAttachmentTransform()->toAffine();
+      parent.translate(-my->getAttachmentModel()->getMesh()->getDefaultPos());
+      transform = mat34(1.0f, *my->getAttachmentRot(), *my->getAttachmentLoc()) * parent * transform;
+    }
+    modelMatrix = transform.toMat4();
     #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
       wsAssert((my->getNumJoints() <= WS_MAX_JOINTS), "Cannot have more than the max number of joints in a skeleton.");
       shaders[WS_SHADER_INITIAL]->setUniformVec4Array("baseBoneLocs", my->getMesh()->getJointLocations(), my->getNumJoints());
@@ -383,54 +509,59 @@ void wsRenderSystem::drawModels(wsHashMap<wsModel*>* models) {
       shaders[WS_SHADER_INITIAL]->setUniformVec4Array("boneRots", (vec4*)my->getJointRotations(), my->getNumJoints());
 
       glPushMatrix();
-        glMultMatrixf((GLfloat*)&transform);
-        defaultPos = -my->getMesh()->getDefaultPos();
-        glTranslatef(defaultPos.x, defaultPos.y, defaultPos.z);
-        if (my->getAttachmentTransform() != WS_NULL) {   //  This is attached to another model
-          wsAssert(my->getAttachmentLoc() != WS_NULL, "Model has null attachment location");
-          wsAssert(my->getAttachmentRot() != WS_NULL, "Model has null attachment rotation");
-          // transform.loadIdentity();
-          transform = my->getAttachmentTransform()->toMatrix();
-          transform.translate(-my->getAttachmentModel()->getMesh()->getDefaultPos());
-          glMultMatrixf((GLfloat*)&transform);
-          transform.loadIdentity();
-          transform.setRotation(*my->getAttachmentRot());
-          transform.setTranslation(*my->getAttachmentLoc());
-          glMultMatrixf((GLfloat*)&transform);
-        }
+        glMultMatrixf((GLfloat*)&modelMatrix);
         glBindBuffer(GL_ARRAY_BUFFER, my->getVertexArray());
-        glVertexAttribPointer(WS_VERT_ATTRIB_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(0));
-        glVertexAttribPointer(WS_VERT_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(16));
-        glVertexAttribPointer(WS_VERT_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(32));
-        glVertexAttribPointer(WS_VERT_ATTRIB_NUM_WEIGHTS, 1, GL_INT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(40));
+        if (my->getVertexSize() == sizeof(wsPackedVert)) {
+          //  Normals arrive octahedron-mapped and are unfolded by the shader
+          shaders[WS_SHADER_INITIAL]->setUniformInt("octNormals", 1);
+          glVertexAttribPointer(WS_VERT_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(0));
+          glVertexAttribPointer(WS_VERT_ATTRIB_NORMAL, 2, GL_SHORT, GL_TRUE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(12));
+          glVertexAttribPointer(WS_VERT_ATTRIB_TEX_COORDS, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(16));
+          glVertexAttribIPointer(WS_VERT_ATTRIB_NUM_WEIGHTS, 1, GL_UNSIGNED_BYTE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(28));
+          if (my->getMesh()->getNumJoints()) {
+            glVertexAttribPointer(WS_VERT_ATTRIB_JOINT_INDEX, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(20));
+            glVertexAttribPointer(WS_VERT_ATTRIB_INFLUENCE, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(wsPackedVert), WS_BUFFER_OFFSET(24));
+          }
+        }
+        else {
+          shaders[WS_SHADER_INITIAL]->setUniformInt("octNormals", 0);
+          glVertexAttribPointer(WS_VERT_ATTRIB_POSITION, 4, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(0));
+          glVertexAttribPointer(WS_VERT_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(16));
+          glVertexAttribPointer(WS_VERT_ATTRIB_TEX_COORDS, 2, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(32));
+          glVertexAttribIPointer(WS_VERT_ATTRIB_NUM_WEIGHTS, 1, GL_INT, sizeof(wsVert), WS_BUFFER_OFFSET(40));
+          if (my->getMesh()->getNumJoints()) {
+            glVertexAttribPointer(WS_VERT_ATTRIB_JOINT_INDEX, 4, GL_INT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(44));
+            glVertexAttribPointer(WS_VERT_ATTRIB_INFLUENCE, 4, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(60));
+          }
+        }
+        //  WS_MAX_JOINT_INFLUENCES fits in the first set of joints and weights, so
+        //  jointIndex2 and influence2 are left disabled
         if (my->getMesh()->getNumJoints()) {
-          glVertexAttribPointer(WS_VERT_ATTRIB_JOINT_INDEX, 4, GL_INT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(44));
-          glVertexAttribPointer(WS_VERT_ATTRIB_JOINT_INDEX_2, 4, GL_INT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(60));
-          glVertexAttribPointer(WS_VERT_ATTRIB_INFLUENCE, 4, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(76));
-          glVertexAttribPointer(WS_VERT_ATTRIB_INFLUENCE_2, 4, GL_FLOAT, GL_FALSE, sizeof(wsVert), WS_BUFFER_OFFSET(92));
           glEnableVertexAttribArray(WS_VERT_ATTRIB_JOINT_INDEX);
           glEnableVertexAttribArray(WS_VERT_ATTRIB_INFLUENCE);
-          glEnableVertexAttribArray(WS_VERT_ATTRIB_JOINT_INDEX_2);
-          glEnableVertexAttribArray(WS_VERT_ATTRIB_INFLUENCE_2);
         }
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         glDepthFunc(GL_LESS);
         glCullFace(GL_BACK);
+        wsIndexArray* indexArrays = my->getIndexArrays(my->selectLOD(camera, cameraSlot));
         for (u32 m = 0; m < my->getMesh()->getNumMaterials(); ++m) {
+          if (indexArrays[m].numIndices == 0) { continue; }
           setMaterial(mats[m]);
-          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, my->getIndexArrays()[m].handle);
-          glDrawElements(GL_TRIANGLES, my->getIndexArrays()[m].numIndices, GL_UNSIGNED_INT, WS_BUFFER_OFFSET(0));
+          glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexArrays[m].handle);
+          glDrawElements(GL_TRIANGLES, indexArrays[m].numIndices,
+                          (indexArrays[m].indexSize == sizeof(u16)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+                          WS_BUFFER_OFFSET(0));
         }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         if (my->getMesh()->getNumJoints()) {
           glDisableVertexAttribArray(WS_VERT_ATTRIB_JOINT_INDEX);
           glDisableVertexAttribArray(WS_VERT_ATTRIB_INFLUENCE);
-          glDisableVertexAttribArray(WS_VERT_ATTRIB_JOINT_INDEX_2);
-          glDisableVertexAttribArray(WS_VERT_ATTRIB_INFLUENCE_2);
         }
         if ((drawFeatures & WS_DRAW_BONES) && my->getMesh()->getNumJoints()) {
           //*  Rewrite and draw bones on initial shader XD
           const wsJoint* joints = my->getMesh()->getJoints();
+          const vec4* jointLocations = my->getJointLocations();
+          const quat* jointRotations = my->getJointRotations();
           glEnable(GL_COLOR_MATERIAL);
           disable(WS_DRAW_TEXTURES | WS_DRAW_DEPTH | WS_DRAW_LIGHTING);
           vec4 endPos;
@@ -440,11 +571,11 @@ void wsRenderSystem::drawModels(wsHashMap<wsModel*>* models) {
           glBegin(GL_LINES);
           for (u32 j = 0; j < my->getMesh()->getNumJoints(); ++j) {
             endPos = joints[j].end;
-            endPos.rotate(joints[j].rot);
-            endPos += joints[j].start;
+            endPos.rotate(jointRotations[j]);
+            endPos += jointLocations[j];
 
             glColor4fv((GLfloat*)&YELLOW);
-            glVertex3fv((GLfloat*)&joints[j].start);
+            glVertex3fv((GLfloat*)&jointLocations[j]);
             glColor4fv((GLfloat*)&RED);
             glVertex3fv((GLfloat*)&endPos);
           }
@@ -504,7 +635,7 @@ void wsRenderSystem::drawPanels() {
   hudCam->draw();
   disable(WS_DRAW_DEPTH | WS_DRAW_LIGHTING);
   glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-  for (wsOrderedHashMap<wsPanel*>::iterator pan = panels->begin(); pan.get() != WS_NULL; ++pan) {
+  for (wsOrderedHashMap<wsPanel*>::iterator pan = panels->begin(); pan.isValid(); ++pan) {
     pan.get()->draw();
   }
   enable(WS_DRAW_DEPTH | WS_DRAW_LIGHTING | WS_DRAW_TEXTURES);
@@ -599,7 +730,8 @@ void wsRenderSystem::drawScene(wsScene* myScene) {
     u32 numPrims = myScene->getNumPrimitives();
     wsPrimitive** prims = myScene->getPrimitives();
     
-    for (wsHashMap<wsCamera*>::iterator cam = myScene->getCameras()->begin(); cam.get() != WS_NULL; ++cam) {
+    u32 cameraSlot = 0;
+    for (wsHashMap<wsCamera*>::iterator cam = myScene->getCameras()->begin(); cam.isValid(); ++cam, ++cameraSlot) {
       cam.get()->draw();
       shaders[WS_SHADER_INITIAL]->setUniformVec3("eyePos", cam.get()->getPos());
 
@@ -626,7 +758,7 @@ void wsRenderSystem::drawScene(wsScene* myScene) {
       }
 
       glEnableVertexAttribArray(WS_VERT_ATTRIB_NUM_WEIGHTS);
-      drawModels(myScene->getModels());
+      drawModels(myScene->getModels(), cam.get(), cameraSlot);
     }
 
     if (drawFeatures & WS_DRAW_AXES) {
@@ -704,6 +836,46 @@ void wsRenderSystem::enable(u32 renderingFeatures) {
   #endif
 }
 
+void wsRenderSystem::freeImage(wsImage* image) {
+  if (image->pixels != WS_NULL) {
+    free(image->pixels);
+    image->pixels = WS_NULL;
+  }
+  if (image->cooked != WS_NULL) {
+    image->cooked->~wsTextureFile();
+    free(image->cooked);
+    image->cooked = WS_NULL;
+  }
+}
+
+u64 wsRenderSystem::getTextureBytes(u32 texture) {
+  wsAssert(_mInitialized, "Must initialize the rendering system first.");
+  u64 numBytes = 0;
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    if (texture == 0) { return 0; }
+    glBindTexture(GL_TEXTURE_2D, texture);
+      //  A level the texture lacks reads as zero wide
+      for (GLint l = 0; l < 32; ++l) {
+        GLint width = 0, height = 0, compressed = GL_FALSE;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_WIDTH, &width);
+        if (width == 0) { break; }
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_HEIGHT, &height);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_COMPRESSED, &compressed);
+        if (compressed) {
+          GLint size = 0;
+          glGetTexLevelParameteriv(GL_TEXTURE_2D, l, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+          numBytes += (u64)size;
+        }
+        else {
+          //  Drivers keep RGB8 texels in four bytes, as they do RGBA8
+          numBytes += (u64)width*height*4;
+        }
+      }
+    glBindTexture(GL_TEXTURE_2D, 0);
+  #endif
+  return numBytes;
+}
+
 void wsRenderSystem::loadIdentity() {
   wsAssert(_mInitialized, "Must initialize the rendering system first.");
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
@@ -711,58 +883,33 @@ void wsRenderSystem::loadIdentity() {
   #endif
 }
 
-void wsRenderSystem::loadTexture(u32* index, const char* filename, bool autoSmooth, bool tiling) {
+void wsRenderSystem::loadTexture(u32* index, const char* filename, bool autoSmooth, bool tiling, bool linear) {
   wsAssert(_mInitialized, "Must initialize the rendering system first.");
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
-    u32 fileHash = wsHash(filename);
-    if (!imageIndices->contains(fileHash)) {
-      *index = SOIL_load_OGL_texture(filename, SOIL_LOAD_AUTO, *index, SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y);
-      if (!(*index)) {
-        wsEcho(WS_LOG_ERROR, "Could not locate texture file: \"%s\"\n  SOIL error: %s\n", filename, SOIL_last_result());
-        if (strcmp(filename, "textures/wsDefaultTexture.png")) {
-          loadTexture(index, "textures/wsDefaultTexture.png", autoSmooth);
-        }
-      }
-      else {
-        wsEcho(WS_LOG_GRAPHICS, "Loaded texture file: \"%s\"\n", filename);
-        imageIndices->insert(fileHash, *index);
-        if (autoSmooth) {
-          glBindTexture(GL_TEXTURE_2D, *index);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            if (tiling) {
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            }
-            else {
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            }
-          glBindTexture(GL_TEXTURE_2D, 0);
-        }
-        else {
-          glBindTexture(GL_TEXTURE_2D, *index);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            if (tiling) {
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            }
-            else {
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-              glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            }
-          glBindTexture(GL_TEXTURE_2D, 0);
-        }
-      }
-    }// End if this index is not in the hashmap
-    else {
+    u32* cached = imageIndices->find(wsHash(filename));
+    if (cached != WS_NULL && *cached != 0) {
       wsEcho(WS_LOG_GRAPHICS, "Texture file \"%s\" has already been loaded.\n", filename);
-      *index = imageIndices->retrieve(fileHash);
+      *index = *cached;
+      return;
     }
+    wsImage image;
+    decodeImage(&image, filename, linear);
+    createTexture(index, filename, &image, autoSmooth, tiling);
   #endif
 }
 
+void wsRenderSystem::loadTextures(wsMesh* mesh) {
+  wsMaterial* mats = mesh->getMats();
+  for (u32 m = 0; m < mesh->getNumMaterials(); ++m) {
+    if (mats[m].colorMapPath != WS_NULL) {
+      loadTexture(&mats[m].colorMap, mats[m].colorMapPath);
+    }
+    if (mats[m].normalMapPath != WS_NULL) {
+      loadTexture(&mats[m].normalMap, mats[m].normalMapPath, true, false, true);
+    }
+  }
+}
+
 void wsRenderSystem::modelviewMatrix() {
   wsAssert(_mInitialized, "Must initialize the rendering system first.");
   #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
@@ -794,7 +941,7 @@ void wsRenderSystem::scanHUD() {
   //  Convert to screen space coordinates (1600x900 grid)
   mouseX *= WS_HUD_WIDTH / wsScreenWidth;
   mouseY *= WS_HUD_HEIGHT / wsScreenHeight;
-  for (wsOrderedHashMap<wsPanel*>::iterator pan = panels->begin(); pan.get() != WS_NULL; ++pan) {
+  for (wsOrderedHashMap<wsPanel*>::iterator pan = panels->begin(); pan.isValid(); ++pan) {
     pan.get()->checkMouse(mouseX, mouseY, wsInputs.getMouseDown());
   }
 }
@@ -874,6 +1021,70 @@ void wsRenderSystem::swapPostBuffer() {
   }
 }
 
+void wsRenderSystem::unloadTexture(const char* filename) {
+  wsAssert(_mInitialized, "Must initialize the rendering system first.");
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    u32* cached = imageIndices->find(wsHash(filename));
+    if (cached == WS_NULL || *cached == 0) { return; }
+    glDeleteTextures(1, cached);
+    //  Removing the key would cut the probe chains of others, so zero marks it unloaded
+    *cached = 0;
+    wsEcho(WS_LOG_GRAPHICS, "Unloaded texture file: \"%s\"\n", filename);
+  #endif
+}
+
+u32 wsRenderSystem::uploadTexture(u32 format, const wsTextureLevel* levels, u32 numLevels, const u8* data) {
+  u32 texture = 0;
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    GLenum internalFormat;
+    switch (format) {
+      case WS_TEXTURE_FORMAT_RGB8:  internalFormat = GL_RGB8; break;
+      case WS_TEXTURE_FORMAT_RGBA8: internalFormat = GL_RGBA8; break;
+      case WS_TEXTURE_FORMAT_BC1:   internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+      case WS_TEXTURE_FORMAT_BC3:   internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+      default:                      internalFormat = GL_COMPRESSED_RG_RGTC2; break;
+    }
+    bool compressed = (format >= WS_TEXTURE_FORMAT_BC1);
+    //  RGTC is core in OpenGL 3.0, but S3TC remains an extension; without it the blocks
+    //  are expanded here
+    const bool expand = (compressed && format != WS_TEXTURE_FORMAT_BC5 && !GLEW_EXT_texture_compression_s3tc);
+    u8* expanded = WS_NULL;
+    if (expand) {
+      compressed = false;
+      internalFormat = GL_RGBA8;
+      expanded = (u8*)malloc((u64)levels[0].width*levels[0].height*4);
+      wsAssert(expanded, "Could not allocate a buffer to expand a compressed texture.");
+    }
+    const GLenum pixelFormat = (format == WS_TEXTURE_FORMAT_RGB8) ? GL_RGB : GL_RGBA;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+      //  Rows of RGB8 levels are packed without padding
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      for (u32 l = 0; l < numLevels; ++l) {
+        const wsTextureLevel& level = levels[l];
+        if (compressed) {
+          glCompressedTexImage2D(GL_TEXTURE_2D, l, internalFormat, level.width, level.height, 0,
+                                  (GLsizei)level.numBytes, data + level.offset);
+        }
+        else if (expand) {
+          wsDecompressTexture(expanded, data + level.offset, level.width, level.height, format);
+          glTexImage2D(GL_TEXTURE_2D, l, internalFormat, level.width, level.height, 0, GL_RGBA,
+                        GL_UNSIGNED_BYTE, expanded);
+        }
+        else {
+          glTexImage2D(GL_TEXTURE_2D, l, internalFormat, level.width, level.height, 0, pixelFormat,
+                        GL_UNSIGNED_BYTE, data + level.offset);
+        }
+      }
+      free(expanded);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels-1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  #endif
+  return texture;
+}
+
 void wsRenderSystem::shutDown() {
   //  Not much going on here...
 }
@@ -41,6 +41,7 @@
 
 #include "../wsConfig.h"
 #include "wsShader.h"
+#include "wsMipmaps.h"
 #include "../wsUtils.h"
 #include "../wsAssets.h"
 #include "../wsPrimitives.h"
@@ -62,6 +63,17 @@ struct wsMeshContainer {
   ~wsMeshContainer();
 };
 
+//  An image file decoded into memory, waiting to become a texture
+struct wsImage {
+  u8* pixels; //  Every level, bottom row first, from wsBuildMipChain(...); WS_NULL if the file could not be decoded
+  wsTextureFile* cooked;  //  The image's cooked file, used in place of pixels; WS_NULL if there is none
+  wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS]; //  The levels of pixels
+  u32 numLevels;
+  i32 width;
+  i32 height;
+  i32 channels;
+};
+
 class wsRenderSystem {
   private:
     i32 versionMajor;
@@ -86,6 +98,9 @@ class wsRenderSystem {
     bool _mInitialized;
     //  Private Methods
     void initializeShaders(u32 width, u32 height);
+    //  Creates a texture from every level of a mip chain, whose offsets count from data,
+    //  expanding block formats the driver cannot take
+    u32 uploadTexture(u32 format, const wsTextureLevel* levels, u32 numLevels, const u8* data);
   public:
     /*  Default Constructor and Deconstructor */
     //  As an engine subsystem, the renderer takes no action until explicitly
@@ -96,20 +111,35 @@ class wsRenderSystem {
     /*  Setters and Getters */
     bool isEnabled(u32 features) { return ((drawFeatures & features) == features); }
     u32 getRenderMode() { return renderMode; }
+    //  Estimates the video memory a texture takes, over all its levels
+    u64 getTextureBytes(u32 texture);
     void setRenderMode(const u32 my) { renderMode = my; }
     /*  Operational Methods */
     u32 addMesh(const char* filepath);  //  Adds a mesh and return the mesh's index
     u32 addPanel(const char* panelName, wsPanel* myPanel);
     void checkExtensions();
     void clearScreen();
+    //  Creates a texture from an image decoded by decodeImage(...), then frees the image.
+    //  Like loadTexture(...), reuses a texture already loaded from the same file.
+    void createTexture(u32* index, const char* filename, wsImage* image, bool autoSmooth = true, bool tiling = false);
+    //  Reads and decodes an image file and builds its mip chain without touching the
+    //  graphics state, so it may be called from any thread. Returns false if the file
+    //  could not be decoded. An up-to-date cooked .wsTex file beside the image is mapped
+    //  instead of decoding. Linear images, such as normal maps, skip gamma correction.
+    bool decodeImage(wsImage* image, const char* filename, bool linear = false);
     void disable(u32 renderingFeatures);
-    void drawModels(wsHashMap<wsModel*>* models);
+    //  cameraSlot numbers the camera within the scene, for its choice of levels of detail
+    void drawModels(wsHashMap<wsModel*>* models, const wsCamera* camera, u32 cameraSlot);
     void drawPanels();
     void drawPost();    //  Post-processing effects
     void drawScene(wsScene* myScene);
     void enable(u32 renderingFeatures);
+    void freeImage(wsImage* image);
     void loadIdentity();
-    void loadTexture(u32* index, const char* filename, bool autoSmooth = true, bool tiling = false);
+    void loadTexture(u32* index, const char* filename, bool autoSmooth = true, bool tiling = false,
+                      bool linear = false);
+    //  Loads the texture maps of every material of a mesh
+    void loadTextures(wsMesh* mesh);
     void modelviewMatrix();
     void nextRenderMode();
     void projectionMatrix();
@@ -121,6 +151,8 @@ class wsRenderSystem {
     void setPrimMaterial(const wsPrimMaterial& mat);
     void swapBuffers();
     void swapPostBuffer();
+    //  Deletes a texture loaded from the file; any other user of it is left dangling
+    void unloadTexture(const char* filename);
     //  Uninitializes the renderer
     void shutDown();
     //  Initializes the renderer
@@ -66,24 +66,15 @@
   }
 
   bool wsShader::addVertexShader(const char* filePath) {
-    /// Open File
-    FILE* pFile;
-    pFile = fopen(filePath, "r");
-    wsAssert( pFile, "Error Loading file." );
-    fseek(pFile, 0, SEEK_END);
-    u32 fileLength = ftell(pFile);
-    rewind(pFile);
-    const char* fileContents = wsNewArrayTmp(char, fileLength);
-    #ifndef NDEBUG
-      u32 resultingLength = fread((void*)fileContents, 1, fileLength, pFile);
-      wsAssert(resultingLength == fileLength, "Problem reading shader file.");
-    #else
-      fread((void*)fileContents, 1, fileLength, pFile);
-    #endif
+    /// Open File, from a mounted pack if one holds it
+    wsMappedFile file;
+    if (!file.open(filePath)) { return false; }
+    const char* fileContents = file.getData();
+    const i32 fileLength = (i32)file.getSize();
 
     i32 compiled;
     vertShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShader, 1, &fileContents, NULL);
+    glShaderSource(vertShader, 1, &fileContents, &fileLength);
     glCompileShader(vertShader);
     glGetObjectParameterivARB(vertShader, GL_COMPILE_STATUS, &compiled);
     if (!compiled) {
@@ -97,29 +88,18 @@
       return false;
     }
     glAttachShader(shaderProgram, vertShader);
-
-    fclose(pFile);
     return true;
   }
 
   bool wsShader::addFragmentShader(const char* filePath) {
-    /// Open File
-    FILE* pFile;
-    pFile = fopen(filePath, "r");
-    wsAssert( pFile, "Error Loading file." );
-    fseek(pFile, 0, SEEK_END);
-    u32 fileLength = ftell(pFile);
-    rewind(pFile);
-    const char* fileContents = wsNewArrayTmp(char, fileLength);
-    #ifndef NDEBUG
-      u32 resultingLength = fread((void*)fileContents, 1, fileLength, pFile);
-      wsAssert(resultingLength == fileLength, "Problem reading shader file.");
-    #else
-      fread((void*)fileContents, 1, fileLength, pFile);
-    #endif
+    /// Open File, from a mounted pack if one holds it
+    wsMappedFile file;
+    if (!file.open(filePath)) { return false; }
+    const char* fileContents = file.getData();
+    const i32 fileLength = (i32)file.getSize();
     i32 compiled;
     fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShader, 1, &fileContents, NULL);
+    glShaderSource(fragShader, 1, &fileContents, &fileLength);
     glCompileShader(fragShader);
     glGetObjectParameterivARB(fragShader, GL_COMPILE_STATUS, &compiled);
     if (!compiled) {
@@ -133,8 +113,6 @@
       return false;
     }
     glAttachShader(shaderProgram, fragShader);
-
-    fclose(pFile);
     return true;
   }
 
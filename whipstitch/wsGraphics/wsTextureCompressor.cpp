@@ -0,0 +1,687 @@
+/*
+ * wsTextureCompressor.cpp
+ *
+ *    This file implements the block compressor of the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTextureCompressor.h"
+#include "../wsGameFlow/wsThreadPool.h"
+#include "../wsUtils/wsOperations.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+//  Rows of blocks below which an image is not worth splitting between threads
+#define WS_MIN_COMPRESS_ROWS 4
+//  Refinement rounds of least squares at WS_COMPRESS_HIGH
+#define WS_MAX_REFINEMENTS 8
+
+//  The colors of one block, a channel to an array so four pixels fill a register
+struct wsColorBlock {
+  f32 r[16];
+  f32 g[16];
+  f32 b[16];
+};
+
+/*  Endpoints and Palettes  */
+static u16 wsPack565(const f32* color) {
+  i32 r = (i32)(color[0]*(31.0f/255.0f) + 0.5f);
+  i32 g = (i32)(color[1]*(63.0f/255.0f) + 0.5f);
+  i32 b = (i32)(color[2]*(31.0f/255.0f) + 0.5f);
+  r = wsMax(wsMin(r, 31), 0);
+  g = wsMax(wsMin(g, 63), 0);
+  b = wsMax(wsMin(b, 31), 0);
+  return (u16)((r << 11) | (g << 5) | b);
+}
+
+static void wsUnpack565(u16 packed, i32* color) {
+  const i32 r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+//  The colors a decoder builds from two endpoints: four, or three and transparent black
+static void wsColorPalette(u16 c0, u16 c1, bool fourColors, i32 palette[4][3]) {
+  wsUnpack565(c0, palette[0]);
+  wsUnpack565(c1, palette[1]);
+  for (u32 c = 0; c < 3; ++c) {
+    if (fourColors) {
+      palette[2][c] = (2*palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2*palette[1][c]) / 3;
+    }
+    else {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+}
+
+//  The values a decoder builds from two BC4 endpoints: eight, or six with 0 and 255
+static void wsAlphaPalette(u8 a0, u8 a1, i32 palette[8]) {
+  palette[0] = a0;
+  palette[1] = a1;
+  if (a0 > a1) {
+    for (i32 k = 2; k < 8; ++k) {
+      palette[k] = ((8-k)*a0 + (k-1)*a1 + 3) / 7;
+    }
+  }
+  else {
+    for (i32 k = 2; k < 6; ++k) {
+      palette[k] = ((6-k)*a0 + (k-1)*a1 + 2) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+/*  Per-Pixel Kernels  */
+#if WS_SUPPORTS_SSE == WS_TRUE
+  static inline f32 wsHorizontalMin(__m128 v) {
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+  }
+  static inline f32 wsHorizontalMax(__m128 v) {
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+  }
+  static inline f32 wsHorizontalSum(__m128 v) {
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+  }
+#endif
+
+//  Smallest and largest value of each channel
+static void wsColorBounds(const wsColorBlock& block, f32* lo, f32* hi) {
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    const f32* channels[3] = { block.r, block.g, block.b };
+    for (u32 c = 0; c < 3; ++c) {
+      __m128 v0 = _mm_loadu_ps(channels[c]), v1 = _mm_loadu_ps(channels[c] + 4);
+      __m128 v2 = _mm_loadu_ps(channels[c] + 8), v3 = _mm_loadu_ps(channels[c] + 12);
+      lo[c] = wsHorizontalMin(_mm_min_ps(_mm_min_ps(v0, v1), _mm_min_ps(v2, v3)));
+      hi[c] = wsHorizontalMax(_mm_max_ps(_mm_max_ps(v0, v1), _mm_max_ps(v2, v3)));
+    }
+  #else
+    lo[0] = hi[0] = block.r[0];
+    lo[1] = hi[1] = block.g[0];
+    lo[2] = hi[2] = block.b[0];
+    for (u32 i = 1; i < 16; ++i) {
+      lo[0] = wsMin(lo[0], block.r[i]);
+      lo[1] = wsMin(lo[1], block.g[i]);
+      lo[2] = wsMin(lo[2], block.b[i]);
+      hi[0] = wsMax(hi[0], block.r[i]);
+      hi[1] = wsMax(hi[1], block.g[i]);
+      hi[2] = wsMax(hi[2], block.b[i]);
+    }
+  #endif
+}
+
+//  Mean and covariance (rr, rg, rb, gg, gb, bb) of the block's colors
+static void wsColorCovariance(const wsColorBlock& block, f32* mean, f32* cov) {
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    __m128 sumR = _mm_setzero_ps(), sumG = _mm_setzero_ps(), sumB = _mm_setzero_ps();
+    for (u32 i = 0; i < 16; i += 4) {
+      sumR = _mm_add_ps(sumR, _mm_loadu_ps(block.r + i));
+      sumG = _mm_add_ps(sumG, _mm_loadu_ps(block.g + i));
+      sumB = _mm_add_ps(sumB, _mm_loadu_ps(block.b + i));
+    }
+    mean[0] = wsHorizontalSum(sumR) / 16.0f;
+    mean[1] = wsHorizontalSum(sumG) / 16.0f;
+    mean[2] = wsHorizontalSum(sumB) / 16.0f;
+    const __m128 meanR = _mm_set1_ps(mean[0]), meanG = _mm_set1_ps(mean[1]), meanB = _mm_set1_ps(mean[2]);
+    __m128 rr = _mm_setzero_ps(), rg = _mm_setzero_ps(), rb = _mm_setzero_ps();
+    __m128 gg = _mm_setzero_ps(), gb = _mm_setzero_ps(), bb = _mm_setzero_ps();
+    for (u32 i = 0; i < 16; i += 4) {
+      const __m128 r = _mm_sub_ps(_mm_loadu_ps(block.r + i), meanR);
+      const __m128 g = _mm_sub_ps(_mm_loadu_ps(block.g + i), meanG);
+      const __m128 b = _mm_sub_ps(_mm_loadu_ps(block.b + i), meanB);
+      rr = _mm_add_ps(rr, _mm_mul_ps(r, r));
+      rg = _mm_add_ps(rg, _mm_mul_ps(r, g));
+      rb = _mm_add_ps(rb, _mm_mul_ps(r, b));
+      gg = _mm_add_ps(gg, _mm_mul_ps(g, g));
+      gb = _mm_add_ps(gb, _mm_mul_ps(g, b));
+      bb = _mm_add_ps(bb, _mm_mul_ps(b, b));
+    }
+    cov[0] = wsHorizontalSum(rr);
+    cov[1] = wsHorizontalSum(rg);
+    cov[2] = wsHorizontalSum(rb);
+    cov[3] = wsHorizontalSum(gg);
+    cov[4] = wsHorizontalSum(gb);
+    cov[5] = wsHorizontalSum(bb);
+  #else
+    mean[0] = mean[1] = mean[2] = 0.0f;
+    for (u32 i = 0; i < 16; ++i) {
+      mean[0] += block.r[i];
+      mean[1] += block.g[i];
+      mean[2] += block.b[i];
+    }
+    mean[0] /= 16.0f;
+    mean[1] /= 16.0f;
+    mean[2] /= 16.0f;
+    for (u32 c = 0; c < 6; ++c) { cov[c] = 0.0f; }
+    for (u32 i = 0; i < 16; ++i) {
+      const f32 r = block.r[i] - mean[0], g = block.g[i] - mean[1], b = block.b[i] - mean[2];
+      cov[0] += r*r;
+      cov[1] += r*g;
+      cov[2] += r*b;
+      cov[3] += g*g;
+      cov[4] += g*b;
+      cov[5] += b*b;
+    }
+  #endif
+}
+
+//  Chooses the nearest of numColors palette entries for each pixel, returning the
+//  summed squared error
+static f32 wsPickColorIndices(const wsColorBlock& block, const i32 palette[4][3], u32 numColors, u8* indices) {
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    __m128 total = _mm_setzero_ps();
+    for (u32 i = 0; i < 16; i += 4) {
+      const __m128 r = _mm_loadu_ps(block.r + i);
+      const __m128 g = _mm_loadu_ps(block.g + i);
+      const __m128 b = _mm_loadu_ps(block.b + i);
+      __m128 best = _mm_set1_ps(FLT_MAX);
+      __m128i bestIndex = _mm_setzero_si128();
+      for (u32 k = 0; k < numColors; ++k) {
+        const __m128 dr = _mm_sub_ps(r, _mm_set1_ps((f32)palette[k][0]));
+        const __m128 dg = _mm_sub_ps(g, _mm_set1_ps((f32)palette[k][1]));
+        const __m128 db = _mm_sub_ps(b, _mm_set1_ps((f32)palette[k][2]));
+        const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+        const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(dist, best));
+        best = _mm_min_ps(dist, best);
+        bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(k)));
+      }
+      total = _mm_add_ps(total, best);
+      //  Gather the low byte of each 32-bit index
+      bestIndex = _mm_packs_epi32(bestIndex, bestIndex);
+      bestIndex = _mm_packus_epi16(bestIndex, bestIndex);
+      const u32 packed = (u32)_mm_cvtsi128_si32(bestIndex);
+      memcpy(indices + i, &packed, 4);
+    }
+    return wsHorizontalSum(total);
+  #else
+    f32 total = 0.0f;
+    for (u32 i = 0; i < 16; ++i) {
+      f32 best = FLT_MAX;
+      for (u32 k = 0; k < numColors; ++k) {
+        const f32 dr = block.r[i] - palette[k][0], dg = block.g[i] - palette[k][1], db = block.b[i] - palette[k][2];
+        const f32 dist = dr*dr + dg*dg + db*db;
+        if (dist < best) {
+          best = dist;
+          indices[i] = (u8)k;
+        }
+      }
+      total += best;
+    }
+    return total;
+  #endif
+}
+
+//  Chooses the nearest of the eight palette values for each pixel, returning the
+//  summed squared error
+static u32 wsPickAlphaIndices(const u8* values, const i32 palette[8], u8* indices) {
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)values);
+    const __m128i v[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+    u32 total = 0;
+    for (u32 h = 0; h < 2; ++h) {
+      __m128i best = _mm_set1_epi16(0x7FFF);
+      __m128i bestIndex = zero;
+      for (u32 k = 0; k < 8; ++k) {
+        const __m128i p = _mm_set1_epi16((i16)palette[k]);
+        //  Nearest by distance is nearest by squared distance, and fits 16 bits
+        const __m128i dist = _mm_max_epi16(_mm_sub_epi16(v[h], p), _mm_sub_epi16(p, v[h]));
+        const __m128i closer = _mm_cmplt_epi16(dist, best);
+        best = _mm_min_epi16(dist, best);
+        bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi16(k)));
+      }
+      _mm_storel_epi64((__m128i*)(indices + h*8), _mm_packus_epi16(bestIndex, bestIndex));
+      //  Sum of squares, eight at a time
+      const __m128i squares = _mm_madd_epi16(best, best);
+      i32 lanes[4];
+      _mm_storeu_si128((__m128i*)lanes, squares);
+      total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    return total;
+  #else
+    u32 total = 0;
+    for (u32 i = 0; i < 16; ++i) {
+      i32 best = 0x7FFF;
+      for (u32 k = 0; k < 8; ++k) {
+        const i32 dist = abs((i32)values[i] - palette[k]);
+        if (dist < best) {
+          best = dist;
+          indices[i] = (u8)k;
+        }
+      }
+      total += best*best;
+    }
+    return total;
+  #endif
+}
+
+/*  Color Blocks  */
+//  Squared error of the given endpoints, with their best indices
+static f32 wsTryColors(const wsColorBlock& block, u16 c0, u16 c1, bool threeColors, u8* indices) {
+  i32 palette[4][3];
+  wsColorPalette(c0, c1, !threeColors, palette);
+  return wsPickColorIndices(block, palette, threeColors ? 3 : 4, indices);
+}
+
+//  Solves for the endpoints which best fit the pixels with their current indices
+static bool wsLeastSquares(const wsColorBlock& block, const u8* indices, bool threeColors, f32* e0, f32* e1) {
+  //  Share of endpoint 0 in each palette entry
+  static const f32 weights4[4] = { 1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f };
+  static const f32 weights3[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+  const f32* weights = threeColors ? weights3 : weights4;
+  f32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  f32 ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+  for (u32 i = 0; i < 16; ++i) {
+    const f32 a = weights[indices[i]], b = 1.0f - a;
+    aa += a*a;
+    ab += a*b;
+    bb += b*b;
+    ax[0] += a*block.r[i];
+    ax[1] += a*block.g[i];
+    ax[2] += a*block.b[i];
+    bx[0] += b*block.r[i];
+    bx[1] += b*block.g[i];
+    bx[2] += b*block.b[i];
+  }
+  const f32 det = aa*bb - ab*ab;
+  if (fabsf(det) < 1e-6f) { return false; }
+  const f32 inv = 1.0f / det;
+  for (u32 c = 0; c < 3; ++c) {
+    e0[c] = wsMax(wsMin((ax[c]*bb - bx[c]*ab) * inv, 255.0f), 0.0f);
+    e1[c] = wsMax(wsMin((bx[c]*aa - ax[c]*ab) * inv, 255.0f), 0.0f);
+  }
+  return true;
+}
+
+//  Fits two 565 endpoints to a block, returning the squared error
+static f32 wsFitColors(const wsColorBlock& block, u32 quality, bool threeColors, u16* bestC0, u16* bestC1, u8* bestIndices) {
+  f32 lo[3], hi[3];
+  wsColorBounds(block, lo, hi);
+  f32 e0[3], e1[3];
+  if (quality == WS_COMPRESS_FAST || (lo[0] == hi[0] && lo[1] == hi[1] && lo[2] == hi[2])) {
+    for (u32 c = 0; c < 3; ++c) {
+      e0[c] = hi[c];
+      e1[c] = lo[c];
+    }
+    //  Take the box's diagonal along which the colors vary together
+    f32 mean[3], cov[6];
+    wsColorCovariance(block, mean, cov);
+    const u32 major = (cov[0] >= cov[3] && cov[0] >= cov[5]) ? 0 : ((cov[3] >= cov[5]) ? 1 : 2);
+    const f32 majorRow[3] = { cov[major == 0 ? 0 : (major == 1 ? 1 : 2)],
+                              cov[major == 0 ? 1 : (major == 1 ? 3 : 4)],
+                              cov[major == 0 ? 2 : (major == 1 ? 4 : 5)] };
+    for (u32 c = 0; c < 3; ++c) {
+      if (c != major && majorRow[c] < 0.0f) {
+        e0[c] = lo[c];
+        e1[c] = hi[c];
+      }
+    }
+  }
+  else {
+    //  The principal axis, by power iteration from the most varied channel
+    f32 mean[3], cov[6];
+    wsColorCovariance(block, mean, cov);
+    f32 axis[3] = { cov[0], cov[3], cov[5] };
+    for (u32 iter = 0; iter < 8; ++iter) {
+      const f32 x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2];
+      const f32 y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2];
+      const f32 z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+      const f32 scale = wsMax(wsMax(fabsf(x), fabsf(y)), fabsf(z));
+      if (scale == 0.0f) { break; }
+      axis[0] = x / scale;
+      axis[1] = y / scale;
+      axis[2] = z / scale;
+    }
+    f32 lengthSquared = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+    if (lengthSquared == 0.0f) {
+      axis[0] = axis[1] = axis[2] = 1.0f;
+      lengthSquared = 3.0f;
+    }
+    //  The pixels farthest along the axis in either direction
+    f32 tMin = FLT_MAX, tMax = -FLT_MAX;
+    for (u32 i = 0; i < 16; ++i) {
+      const f32 t = (block.r[i]-mean[0])*axis[0] + (block.g[i]-mean[1])*axis[1] + (block.b[i]-mean[2])*axis[2];
+      tMin = wsMin(tMin, t);
+      tMax = wsMax(tMax, t);
+    }
+    for (u32 c = 0; c < 3; ++c) {
+      e0[c] = wsMax(wsMin(mean[c] + axis[c]*tMax/lengthSquared, 255.0f), 0.0f);
+      e1[c] = wsMax(wsMin(mean[c] + axis[c]*tMin/lengthSquared, 255.0f), 0.0f);
+    }
+  }
+  //  Pull the endpoints in, so the extremes do not pull the whole palette outward
+  for (u32 c = 0; c < 3; ++c) {
+    const f32 inset = (e0[c] - e1[c]) / 16.0f;
+    e0[c] -= inset;
+    e1[c] += inset;
+  }
+  u8 indices[16];
+  *bestC0 = wsPack565(e0);
+  *bestC1 = wsPack565(e1);
+  f32 bestError = wsTryColors(block, *bestC0, *bestC1, threeColors, bestIndices);
+  if (quality == WS_COMPRESS_FAST) { return bestError; }
+  //  Least squares on the chosen indices, until it stops helping
+  const u32 rounds = (quality == WS_COMPRESS_HIGH) ? WS_MAX_REFINEMENTS : 1;
+  for (u32 round = 0; round < rounds && bestError > 0.0f; ++round) {
+    if (!wsLeastSquares(block, bestIndices, threeColors, e0, e1)) { break; }
+    const u16 c0 = wsPack565(e0), c1 = wsPack565(e1);
+    if (c0 == *bestC0 && c1 == *bestC1) { break; }
+    const f32 error = wsTryColors(block, c0, c1, threeColors, indices);
+    if (error >= bestError) { break; }
+    bestError = error;
+    *bestC0 = c0;
+    *bestC1 = c1;
+    memcpy(bestIndices, indices, 16);
+  }
+  if (quality != WS_COMPRESS_HIGH) { return bestError; }
+  //  Step each channel of each endpoint by one 565 unit while that helps
+  static const u16 steps[3] = { 1 << 11, 1 << 5, 1 };
+  static const u16 masks[3] = { 0xF800, 0x07E0, 0x001F };
+  bool improved = true;
+  for (u32 sweep = 0; sweep < 4 && improved && bestError > 0.0f; ++sweep) {
+    improved = false;
+    for (u32 e = 0; e < 2; ++e) {
+      for (u32 c = 0; c < 3; ++c) {
+        for (i32 dir = -1; dir <= 1; dir += 2) {
+          const u16 current = e ? *bestC1 : *bestC0;
+          const u16 field = current & masks[c];
+          if ((dir < 0 && field == 0) || (dir > 0 && field == masks[c])) { continue; }
+          const u16 moved = (u16)(dir > 0 ? current + steps[c] : current - steps[c]);
+          const u16 c0 = e ? *bestC0 : moved, c1 = e ? moved : *bestC1;
+          const f32 error = wsTryColors(block, c0, c1, threeColors, indices);
+          if (error < bestError) {
+            bestError = error;
+            *bestC0 = c0;
+            *bestC1 = c1;
+            memcpy(bestIndices, indices, 16);
+            improved = true;
+          }
+        }
+      }
+    }
+  }
+  return bestError;
+}
+
+static void wsWriteColorBlock(u8* dest, u16 c0, u16 c1, const u8* indices) {
+  u32 bits = 0;
+  for (u32 i = 0; i < 16; ++i) {
+    bits |= (u32)indices[i] << (i*2);
+  }
+  dest[0] = (u8)c0;
+  dest[1] = (u8)(c0 >> 8);
+  dest[2] = (u8)c1;
+  dest[3] = (u8)(c1 >> 8);
+  dest[4] = (u8)bits;
+  dest[5] = (u8)(bits >> 8);
+  dest[6] = (u8)(bits >> 16);
+  dest[7] = (u8)(bits >> 24);
+}
+
+//  BC1 color. Pixels with alpha below 128 become transparent when allowed; a BC3
+//  color block must use four colors.
+static void wsCompressColorBlock(u8* dest, const u8* pixels, u32 quality, bool allowTransparency) {
+  u32 transparent = 0;
+  i32 firstOpaque = -1;
+  for (u32 i = 0; i < 16; ++i) {
+    if (allowTransparency && pixels[i*4+3] < 128) { transparent |= (1 << i); }
+    else if (firstOpaque < 0) { firstOpaque = i; }
+  }
+  u8 indices[16];
+  if (firstOpaque < 0) {
+    memset(indices, 3, 16);
+    wsWriteColorBlock(dest, 0, 0, indices);
+    return;
+  }
+  //  Transparent pixels take an opaque one's color, so they do not sway the fit
+  wsColorBlock block;
+  for (u32 i = 0; i < 16; ++i) {
+    const u8* pixel = pixels + ((transparent & (1 << i)) ? firstOpaque : i)*4;
+    block.r[i] = pixel[0];
+    block.g[i] = pixel[1];
+    block.b[i] = pixel[2];
+  }
+  const bool threeColors = (transparent != 0);
+  u16 c0, c1;
+  wsFitColors(block, quality, threeColors, &c0, &c1, indices);
+  //  The order of the endpoints tells the decoder which mode the block is in
+  if (threeColors) {
+    if (c0 > c1) {
+      const u16 swap = c0;
+      c0 = c1;
+      c1 = swap;
+      for (u32 i = 0; i < 16; ++i) {
+        if (indices[i] < 2) { indices[i] ^= 1; }
+      }
+    }
+    for (u32 i = 0; i < 16; ++i) {
+      if (transparent & (1 << i)) { indices[i] = 3; }
+    }
+  }
+  else if (c0 < c1) {
+    const u16 swap = c0;
+    c0 = c1;
+    c1 = swap;
+    for (u32 i = 0; i < 16; ++i) {
+      indices[i] ^= 1;
+    }
+  }
+  else if (c0 == c1) {
+    memset(indices, 0, 16);
+  }
+  wsWriteColorBlock(dest, c0, c1, indices);
+}
+
+/*  BC4 Blocks  */
+//  Squared error of the given endpoints, with their best indices
+static u32 wsTryAlpha(const u8* values, u8 a0, u8 a1, u8* indices) {
+  i32 palette[8];
+  wsAlphaPalette(a0, a1, palette);
+  return wsPickAlphaIndices(values, palette, indices);
+}
+
+//  One channel of 16 values, as the alpha of BC3 and each channel of BC5
+static void wsCompressAlphaBlock(u8* dest, const u8* values, u32 quality) {
+  u8 lo = 255, hi = 0;
+  u8 innerLo = 255, innerHi = 0;  //  Ignoring 0 and 255, which the six-value mode holds exactly
+  for (u32 i = 0; i < 16; ++i) {
+    lo = wsMin(lo, values[i]);
+    hi = wsMax(hi, values[i]);
+    if (values[i] != 0 && values[i] != 255) {
+      innerLo = wsMin(innerLo, values[i]);
+      innerHi = wsMax(innerHi, values[i]);
+    }
+  }
+  u8 a0 = hi, a1 = lo;
+  u8 indices[16], bestIndices[16];
+  u32 bestError = wsTryAlpha(values, a0, a1, bestIndices);
+  if (quality != WS_COMPRESS_FAST && bestError > 0 && (lo == 0 || hi == 255)) {
+    //  Spend the six interpolated values on the rest, when the block reaches an extreme
+    const u8 b0 = (innerLo <= innerHi) ? innerLo : 0;
+    const u8 b1 = (innerLo <= innerHi) ? innerHi : 255;
+    const u32 error = wsTryAlpha(values, b0, b1, indices);
+    if (error < bestError) {
+      bestError = error;
+      a0 = b0;
+      a1 = b1;
+      memcpy(bestIndices, indices, 16);
+    }
+  }
+  if (quality == WS_COMPRESS_HIGH && bestError > 0 && hi > lo + 8) {
+    //  Insetting either end of the eight-value mode often fits the middle better
+    const u32 reach = wsMin((u32)(hi - lo) / 8, 4u);
+    for (u32 d0 = 0; d0 <= reach; ++d0) {
+      for (u32 d1 = 0; d1 <= reach; ++d1) {
+        if (d0 == 0 && d1 == 0) { continue; }
+        const u32 error = wsTryAlpha(values, (u8)(hi - d0), (u8)(lo + d1), indices);
+        if (error < bestError) {
+          bestError = error;
+          a0 = (u8)(hi - d0);
+          a1 = (u8)(lo + d1);
+          memcpy(bestIndices, indices, 16);
+        }
+      }
+    }
+  }
+  u64 bits = 0;
+  for (u32 i = 0; i < 16; ++i) {
+    bits |= (u64)bestIndices[i] << (i*3);
+  }
+  dest[0] = a0;
+  dest[1] = a1;
+  for (u32 b = 0; b < 6; ++b) {
+    dest[2+b] = (u8)(bits >> (b*8));
+  }
+}
+
+static void wsDecompressColorBlock(u8* pixels, const u8* src, bool alwaysFourColors) {
+  const u16 c0 = (u16)(src[0] | (src[1] << 8));
+  const u16 c1 = (u16)(src[2] | (src[3] << 8));
+  const u32 bits = (u32)src[4] | ((u32)src[5] << 8) | ((u32)src[6] << 16) | ((u32)src[7] << 24);
+  const bool fourColors = (alwaysFourColors || c0 > c1);
+  i32 palette[4][3];
+  wsColorPalette(c0, c1, fourColors, palette);
+  for (u32 i = 0; i < 16; ++i) {
+    const u32 index = (bits >> (i*2)) & 3;
+    pixels[i*4] = (u8)palette[index][0];
+    pixels[i*4+1] = (u8)palette[index][1];
+    pixels[i*4+2] = (u8)palette[index][2];
+    pixels[i*4+3] = (!fourColors && index == 3) ? 0 : 255;
+  }
+}
+
+//  Writes one channel of 16 pixels, stride bytes apart
+static void wsDecompressAlphaBlock(u8* values, u32 stride, const u8* src) {
+  i32 palette[8];
+  wsAlphaPalette(src[0], src[1], palette);
+  u64 bits = 0;
+  for (u32 b = 0; b < 6; ++b) {
+    bits |= (u64)src[2+b] << (b*8);
+  }
+  for (u32 i = 0; i < 16; ++i) {
+    values[i*stride] = (u8)palette[(bits >> (i*3)) & 7];
+  }
+}
+
+/*  Public Functions  */
+u32 wsBlockSize(u32 format) {
+  return (format == WS_TEXTURE_FORMAT_BC1) ? 8 : 16;
+}
+
+void wsCompressBlock(u8* dest, const u8* pixels, u32 format, u32 quality) {
+  u8 channel[16];
+  switch (format) {
+    case WS_TEXTURE_FORMAT_BC1:
+      wsCompressColorBlock(dest, pixels, quality, true);
+      break;
+    case WS_TEXTURE_FORMAT_BC3:
+      for (u32 i = 0; i < 16; ++i) { channel[i] = pixels[i*4+3]; }
+      wsCompressAlphaBlock(dest, channel, quality);
+      wsCompressColorBlock(dest + 8, pixels, quality, false);
+      break;
+    case WS_TEXTURE_FORMAT_BC5:
+      for (u32 i = 0; i < 16; ++i) { channel[i] = pixels[i*4]; }
+      wsCompressAlphaBlock(dest, channel, quality);
+      for (u32 i = 0; i < 16; ++i) { channel[i] = pixels[i*4+1]; }
+      wsCompressAlphaBlock(dest + 8, channel, quality);
+      break;
+    default:
+      wsAssert(false, "Not a block-compressed texture format.");
+      break;
+  }
+}
+
+void wsDecompressBlock(u8* pixels, const u8* src, u32 format) {
+  switch (format) {
+    case WS_TEXTURE_FORMAT_BC1:
+      wsDecompressColorBlock(pixels, src, false);
+      break;
+    case WS_TEXTURE_FORMAT_BC3:
+      wsDecompressColorBlock(pixels, src + 8, true);
+      wsDecompressAlphaBlock(pixels + 3, 4, src);
+      break;
+    case WS_TEXTURE_FORMAT_BC5:
+      wsDecompressAlphaBlock(pixels, 4, src);
+      wsDecompressAlphaBlock(pixels + 1, 4, src + 8);
+      for (u32 i = 0; i < 16; ++i) {
+        pixels[i*4+2] = 0;
+        pixels[i*4+3] = 255;
+      }
+      break;
+    default:
+      wsAssert(false, "Not a block-compressed texture format.");
+      break;
+  }
+}
+
+void wsCompressTexture(u8* dest, const u8* rgba, u32 width, u32 height, u32 format, u32 quality) {
+  const u32 blockSize = wsBlockSize(format);
+  const u32 blocksWide = (width+3) / 4;
+  const u32 blocksHigh = (height+3) / 4;
+  //  Each chunk takes whole rows of blocks
+  wsRunParallelChunks(blocksHigh, WS_MIN_COMPRESS_ROWS, [&](u32 first, u32 last) {
+    u8 pixels[64];
+    for (u32 by = first; by < last; ++by) {
+      u8* row = dest + (u64)by*blocksWide*blockSize;
+      for (u32 bx = 0; bx < blocksWide; ++bx) {
+        for (u32 y = 0; y < 4; ++y) {
+          const u32 sourceY = wsMin(by*4 + y, height-1);
+          for (u32 x = 0; x < 4; ++x) {
+            const u32 sourceX = wsMin(bx*4 + x, width-1);
+            memcpy(pixels + (y*4 + x)*4, rgba + ((u64)sourceY*width + sourceX)*4, 4);
+          }
+        }
+        wsCompressBlock(row + bx*blockSize, pixels, format, quality);
+      }
+    }
+  });
+}
+
+void wsDecompressTexture(u8* rgba, const u8* src, u32 width, u32 height, u32 format) {
+  const u32 blockSize = wsBlockSize(format);
+  const u32 blocksWide = (width+3) / 4;
+  const u32 blocksHigh = (height+3) / 4;
+  u8 pixels[64];
+  for (u32 by = 0; by < blocksHigh; ++by) {
+    for (u32 bx = 0; bx < blocksWide; ++bx) {
+      wsDecompressBlock(pixels, src + ((u64)by*blocksWide + bx)*blockSize, format);
+      const u32 rows = wsMin(height - by*4, 4u);
+      const u32 columns = wsMin(width - bx*4, 4u);
+      for (u32 y = 0; y < rows; ++y) {
+        memcpy(rgba + ((u64)(by*4 + y)*width + bx*4)*4, pixels + y*16, columns*4);
+      }
+    }
+  }
+}
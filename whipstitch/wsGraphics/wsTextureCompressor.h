@@ -0,0 +1,72 @@
+/*
+ * wsTextureCompressor.h
+ *
+ *    This file declares the block compressor of the Whipstitch Game Engine, which
+ *    encodes RGBA8 images into the block formats of cooked textures:
+ *      BC1   color, with pixels of alpha below 128 made transparent   8 bytes/block
+ *      BC3   color and smooth alpha                                  16 bytes/block
+ *      BC5   the red and green channels alone, such as a normal's x and y
+ *                                                                    16 bytes/block
+ *
+ *    Each 4x4 block is fit independently, so an image is split into rows of blocks
+ *    and compressed across the thread pool. Color endpoints are found along the
+ *    block's principal axis, or its bounding box at WS_COMPRESS_FAST, and refined by
+ *    least squares; SSE2 handles the per-pixel work of each fit.
+ *
+ *    The matching decoders expand blocks back to RGBA8, for measuring error and for
+ *    drivers which cannot take a format.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_TEXTURE_COMPRESSOR_H_
+#define WS_TEXTURE_COMPRESSOR_H_
+
+#include "../wsConfig.h"
+#include "../wsUtils/wsPlatform.h"
+
+//  Quality presets
+enum {
+  WS_COMPRESS_FAST,   //  Bounding box endpoints, no refinement
+  WS_COMPRESS_NORMAL, //  Principal axis endpoints, refined once
+  WS_COMPRESS_HIGH    //  Refined until no step helps, then searched around the best endpoints
+};
+
+//  Bytes of one 4x4 block of a compressed texture format
+u32 wsBlockSize(u32 format);
+
+//  Compresses a width x height RGBA8 image into rows of blocks of the given format.
+//  Partial blocks at the right and bottom edges repeat the last column and row.
+void wsCompressTexture(u8* dest, const u8* rgba, u32 width, u32 height, u32 format,
+                        u32 quality = WS_COMPRESS_NORMAL);
+
+//  Expands a compressed texture into width x height RGBA8 pixels. BC5 fills red and
+//  green, with blue 0 and alpha 255.
+void wsDecompressTexture(u8* rgba, const u8* src, u32 width, u32 height, u32 format);
+
+//  Single blocks; pixels are 16 RGBA8 values, row by row
+void wsCompressBlock(u8* dest, const u8* pixels, u32 format, u32 quality);
+void wsDecompressBlock(u8* pixels, const u8* src, u32 format);
+
+#endif /* WS_TEXTURE_COMPRESSOR_H_ */
@@ -0,0 +1,224 @@
+/*
+ * wsTextureFile.cpp
+ *
+ *    This file implements the class wsTextureFile and the texture cooking functions.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTextureFile.h"
+#include "wsMipmaps.h"
+#include "../wsUtils/wsLog.h"
+#include "../wsUtils/wsOperations.h"
+#include "../wsUtils/wsVirtualFS.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+  #include "SOIL/SOIL.h"
+#endif
+
+bool wsTextureFile::open(const char* filepath) {
+  close();
+  if (!file.open(filepath)) { return false; }
+  const u64 size = file.getSize();
+  const wsTextureHeader* myHeader = (const wsTextureHeader*)file.getData();
+  if (size < sizeof(wsTextureHeader) || myHeader->magic != WS_TEXTURE_MAGIC) {
+    wsEcho(WS_LOG_ERROR, "\"%s\" is not a cooked texture file.", filepath);
+    file.close();
+    return false;
+  }
+  if (myHeader->version != WS_TEXTURE_VERSION || myHeader->format > WS_TEXTURE_FORMAT_BC5 ||
+      myHeader->numLevels == 0 || myHeader->numLevels > WS_MAX_TEXTURE_LEVELS ||
+      size < sizeof(wsTextureHeader) + sizeof(wsTextureLevel)*myHeader->numLevels) {
+    wsEcho(WS_LOG_ERROR, "Cooked texture \"%s\" is of an unsupported version or format.", filepath);
+    file.close();
+    return false;
+  }
+  const wsTextureLevel* myLevels = (const wsTextureLevel*)(myHeader + 1);
+  for (u32 l = 0; l < myHeader->numLevels; ++l) {
+    const wsTextureLevel& level = myLevels[l];
+    if (level.numBytes != wsTextureLevelSize(myHeader->format, level.width, level.height) ||
+        level.offset > size || level.numBytes > size - level.offset) {
+      wsEcho(WS_LOG_ERROR, "Cooked texture \"%s\" is truncated or corrupt.", filepath);
+      file.close();
+      return false;
+    }
+  }
+  header = myHeader;
+  levels = myLevels;
+  return true;
+}
+
+void wsTextureFile::close() {
+  file.close();
+  header = WS_NULL;
+  levels = WS_NULL;
+}
+
+u64 wsTextureLevelSize(u32 format, u32 width, u32 height) {
+  const u64 blocks = (u64)((width+3)/4) * ((height+3)/4);
+  switch (format) {
+    case WS_TEXTURE_FORMAT_RGB8:  return (u64)width*height*3;
+    case WS_TEXTURE_FORMAT_RGBA8: return (u64)width*height*4;
+    case WS_TEXTURE_FORMAT_BC1:   return blocks*8;
+    case WS_TEXTURE_FORMAT_BC3:
+    case WS_TEXTURE_FORMAT_BC5:   return blocks*16;
+    default:                      return 0;
+  }
+}
+
+bool wsCookedTexturePath(char* dest, const char* imagePath, u32 size) {
+  return wsCookedPath(dest, imagePath, WS_TEXTURE_EXTENSION, size);
+}
+
+u32 wsTextureLevels(wsTextureLevel* levels, u32 format, u32 width, u32 height, u64 offset) {
+  u32 numLevels = 0;
+  for (;;) {
+    wsAssert(numLevels < WS_MAX_TEXTURE_LEVELS, "Texture is too large for a mip chain.");
+    offset = (offset + WS_TEXTURE_ALIGNMENT-1) & ~(u64)(WS_TEXTURE_ALIGNMENT-1);
+    levels[numLevels].offset = offset;
+    levels[numLevels].numBytes = wsTextureLevelSize(format, width, height);
+    levels[numLevels].width = width;
+    levels[numLevels].height = height;
+    offset += levels[numLevels].numBytes;
+    ++numLevels;
+    if (width == 1 && height == 1) { break; }
+    width = wsMax(width/2, 1u);
+    height = wsMax(height/2, 1u);
+  }
+  return numLevels;
+}
+
+bool wsWriteTexture(const char* destPath, const u8* pixels, u32 width, u32 height, u32 channels, u32 format,
+                    u32 quality, bool linear) {
+  wsAssert(width > 0 && height > 0, "Cannot cook an empty texture.");
+  const bool compressed = (format == WS_TEXTURE_FORMAT_BC1 || format == WS_TEXTURE_FORMAT_BC3 ||
+                            format == WS_TEXTURE_FORMAT_BC5);
+  if ((format == WS_TEXTURE_FORMAT_RGB8 && channels != 3) || (format != WS_TEXTURE_FORMAT_RGB8 && channels != 4)) {
+    wsEcho(WS_LOG_ERROR, "Cannot write \"%s\": %u channels do not match texture format %u.", destPath, channels, format);
+    return false;
+  }
+  //  Written beside the destination, then renamed over it; truncating the file in place
+  //  would fault any process reading it through a mapping
+  char tmpPath[WS_MAX_ASSET_PATH + 8];
+  if (strlen(destPath) >= WS_MAX_ASSET_PATH) {
+    wsEcho(WS_LOG_ERROR, "Cooked texture path \"%s\" is too long.", destPath);
+    return false;
+  }
+  strcpy(tmpPath, destPath);
+  strcat(tmpPath, ".tmp");
+  //  The uncompressed chain, each level flipped so its bottom row comes first
+  wsTextureLevel chainLevels[WS_MAX_TEXTURE_LEVELS];
+  u8* chain;
+  const u32 numLevels = wsBuildMipChain(&chain, chainLevels, pixels, width, height, channels, linear || format == WS_TEXTURE_FORMAT_BC5);
+  wsAssert(chain, "Could not allocate the texture's mip chain.");
+  wsTextureHeader header;
+  wsTextureLevel levels[WS_MAX_TEXTURE_LEVELS];
+  memset(&header, 0, sizeof(header));
+  memset(levels, 0, sizeof(levels));
+  header.magic = WS_TEXTURE_MAGIC;
+  header.version = WS_TEXTURE_VERSION;
+  header.format = format;
+  header.width = width;
+  header.height = height;
+  header.numLevels = numLevels;
+  const u64 tableEnd = sizeof(wsTextureHeader) + sizeof(wsTextureLevel)*numLevels;
+  wsTextureLevels(levels, format, width, height, tableEnd);
+  FILE* pFile = fopen(tmpPath, "wb");
+  if (pFile == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Could not open \"%s\" for writing.", tmpPath);
+    free(chain);
+    return false;
+  }
+  bool written = (fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+                  fwrite(levels, sizeof(wsTextureLevel), header.numLevels, pFile) == header.numLevels);
+  u8* blocks = compressed ? (u8*)malloc(levels[0].numBytes) : WS_NULL;
+  wsAssert(blocks || !compressed, "Could not allocate a buffer for the texture's blocks.");
+  const u8 padding[WS_TEXTURE_ALIGNMENT] = { 0 };
+  u64 position = tableEnd;
+  for (u32 l = 0; l < header.numLevels && written; ++l) {
+    const wsTextureLevel& level = levels[l];
+    const u8* data = chain + chainLevels[l].offset;
+    if (level.offset > position) {
+      written = (fwrite(padding, level.offset - position, 1, pFile) == 1);
+    }
+    if (compressed) {
+      wsCompressTexture(blocks, data, level.width, level.height, format, quality);
+      data = blocks;
+    }
+    written = written && (fwrite(data, level.numBytes, 1, pFile) == 1);
+    position = level.offset + level.numBytes;
+  }
+  free(chain);
+  free(blocks);
+  written = (fclose(pFile) == 0) && written;
+  if (!written || rename(tmpPath, destPath) != 0) {
+    wsEcho(WS_LOG_ERROR, "Could not write cooked texture \"%s\".", destPath);
+    remove(tmpPath);
+    return false;
+  }
+  return true;
+}
+
+bool wsCookTexture(const char* imagePath, const char* destPath, u32 format, u32 quality, bool linear) {
+  char cookedPath[512];
+  if (destPath == WS_NULL) {
+    if (!wsCookedTexturePath(cookedPath, imagePath, sizeof(cookedPath))) {
+      wsEcho(WS_LOG_ERROR, "Image path \"%s\" is too long to cook.", imagePath);
+      return false;
+    }
+    destPath = cookedPath;
+  }
+  #if WS_GRAPHICS_BACKEND == WS_BACKEND_OPENGL
+    i32 width, height, channels;
+    u8* pixels = SOIL_load_image(imagePath, &width, &height, &channels, SOIL_LOAD_AUTO);
+    if (pixels == WS_NULL) {
+      wsEcho(WS_LOG_ERROR, "Could not decode image \"%s\": %s", imagePath, SOIL_last_result());
+      return false;
+    }
+    if (format == WS_TEXTURE_FORMAT_SOURCE) {
+      //  Grey images gain color channels; grey with alpha keeps its alpha
+      format = (channels == 1 || channels == 3) ? WS_TEXTURE_FORMAT_RGB8 : WS_TEXTURE_FORMAT_RGBA8;
+    }
+    //  The block compressor reads RGBA, even for BC5's two channels
+    const u32 wanted = (format == WS_TEXTURE_FORMAT_RGB8) ? 3 : 4;
+    if ((u32)channels != wanted) {
+      SOIL_free_image_data(pixels);
+      pixels = SOIL_load_image(imagePath, &width, &height, &channels, (wanted == 3) ? SOIL_LOAD_RGB : SOIL_LOAD_RGBA);
+      if (pixels == WS_NULL) {
+        wsEcho(WS_LOG_ERROR, "Could not decode image \"%s\": %s", imagePath, SOIL_last_result());
+        return false;
+      }
+      channels = wanted;
+    }
+    bool cooked = wsWriteTexture(destPath, pixels, width, height, channels, format, quality, linear);
+    SOIL_free_image_data(pixels);
+    return cooked;
+  #else
+    wsEcho(WS_LOG_ERROR, "Cannot cook \"%s\" without an image decoder.", imagePath);
+    return false;
+  #endif
+}
@@ -0,0 +1,127 @@
+/*
+ * wsTextureFile.h
+ *
+ *    This file declares the cooked texture container of the Whipstitch Game Engine,
+ *    the .wsTex file, and the class wsTextureFile which reads it.
+ *
+ *    A .wsTex file holds a texture ready for upload: every mip level, already flipped
+ *    so the bottom row comes first as OpenGL expects, and optionally block-compressed.
+ *    Loading one maps the file and hands each level straight to the driver, with no
+ *    decoding, flipping or filtering left to do on the main thread.
+ *
+ *    Layout, in the byte order of the machine which cooked it:
+ *      wsTextureHeader                 magic, version, format, size, level count
+ *      wsTextureLevel[numLevels]       where each level lies, largest first
+ *      level data                      each level aligned to WS_TEXTURE_ALIGNMENT
+ *
+ *    wsCookTexture(...) writes one from an image file; the textureCooker target of
+ *    florinMake.make builds a tool which cooks whole directories.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_TEXTURE_FILE_H_
+#define WS_TEXTURE_FILE_H_
+
+#include "../wsConfig.h"
+#include "../wsUtils/wsMappedFile.h"
+#include "wsTextureCompressor.h"
+
+#define WS_TEXTURE_MAGIC      0x78547377  //  "wsTx"
+#define WS_TEXTURE_VERSION    1
+#define WS_TEXTURE_ALIGNMENT  16
+#define WS_MAX_TEXTURE_LEVELS 16          //  Enough for a 32768-pixel texture
+#define WS_TEXTURE_EXTENSION  ".wsTex"
+//  Cook uncompressed, as RGB8 or RGBA8 to match the source image
+#define WS_TEXTURE_FORMAT_SOURCE  0xFFFFFFFF
+
+struct wsTextureHeader {
+  u32 magic;
+  u32 version;
+  u32 format;
+  u32 width;
+  u32 height;
+  u32 numLevels;
+  u32 flags;  //  Reserved; always 0
+  u32 reserved;
+};
+
+struct wsTextureLevel {
+  u64 offset;   //  From the start of the file
+  u64 numBytes;
+  u32 width;
+  u32 height;
+};
+
+class wsTextureFile {
+  private:
+    wsMappedFile file;
+    const wsTextureHeader* header;
+    const wsTextureLevel* levels;
+    //  Not copyable; the mapping has a single owner
+    wsTextureFile(const wsTextureFile&);
+    wsTextureFile& operator=(const wsTextureFile&);
+  public:
+    wsTextureFile() : header(WS_NULL), levels(WS_NULL) {}
+    ~wsTextureFile() { close(); }
+    //  Returns false, leaving the file closed, if it cannot be opened or is not a
+    //  complete .wsTex file of this version
+    bool open(const char* filepath);
+    void close();
+    //  The whole file, from which every level's offset counts
+    const u8* getData() const { return (const u8*)file.getData(); }
+    u32 getFormat() const { return header->format; }
+    u32 getHeight() const { return header->height; }
+    const wsTextureLevel& getLevel(u32 level) const { return levels[level]; }
+    const u8* getLevelData(u32 level) const { return (const u8*)file.getData() + levels[level].offset; }
+    const wsTextureLevel* getLevels() const { return levels; }
+    u32 getNumLevels() const { return header->numLevels; }
+    u32 getWidth() const { return header->width; }
+    bool isOpen() const { return (header != WS_NULL); }
+};
+
+//  Bytes taken by one level of the given format and size
+u64 wsTextureLevelSize(u32 format, u32 width, u32 height);
+
+//  Fills levels with the full mip chain of a texture, each level starting on
+//  WS_TEXTURE_ALIGNMENT from the given offset, and returns the number of levels
+u32 wsTextureLevels(wsTextureLevel* levels, u32 format, u32 width, u32 height, u64 offset);
+
+//  Writes the path of the cooked file for an image to dest, replacing its extension
+//  with WS_TEXTURE_EXTENSION. Returns false if it would not fit in size bytes.
+bool wsCookedTexturePath(char* dest, const char* imagePath, u32 size);
+
+//  Writes pixels, given top row first as image files store them, to a .wsTex file with
+//  every level of its mip chain. channels is 3 or 4, and must match an uncompressed
+//  format; the block formats take 4 and are compressed at the given quality. Levels are
+//  filtered in linear light unless the image is linear data, as BC5 normal maps always are.
+bool wsWriteTexture(const char* destPath, const u8* pixels, u32 width, u32 height, u32 channels, u32 format,
+                    u32 quality = WS_COMPRESS_NORMAL, bool linear = false);
+
+//  Decodes an image file and writes it to destPath, or beside it when destPath is
+//  WS_NULL, in the given format
+bool wsCookTexture(const char* imagePath, const char* destPath = WS_NULL, u32 format = WS_TEXTURE_FORMAT_SOURCE,
+                    u32 quality = WS_COMPRESS_NORMAL, bool linear = false);
+
+#endif /* WS_TEXTURE_FILE_H_ */
@@ -54,7 +54,7 @@ wsCube::wsCube(const f32 width, const f32 height, const f32 length, const vec4&
     mat.colorMap = WS_NULL;
   }
   if (strcmp(myNormalMap, "")) {
-    wsRenderer.loadTexture(&mat.normalMap, myNormalMap, true, true);
+    wsRenderer.loadTexture(&mat.normalMap, myNormalMap, true, true, true);
   }
   else {
     mat.normalMap = WS_NULL;
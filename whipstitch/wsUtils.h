@@ -37,13 +37,29 @@
 #include "wsUtils/wsProfileManager.h"
 #include "wsUtils/wsOrderedHashMap.h"
 #include "wsUtils/wsHashMap.h"
+#include "wsUtils/wsArray.h"
+#include "wsUtils/wsSmallArray.h"
+#include "wsUtils/wsNameTable.h"
 #include "wsUtils/wsQueue.h"
+#include "wsUtils/wsSPSCQueue.h"
+#include "wsUtils/wsMPMCQueue.h"
 #include "wsUtils/wsStack.h"
 #include "wsUtils/wsOperations.h"
+#include "wsUtils/wsRandom.h"
 #include "wsUtils/vec4.h"
 #include "wsUtils/mat4.h"
+#include "wsUtils/mat34.h"
 #include "wsUtils/quat.h"
+#include "wsUtils/wsSIMD.h"
+#include "wsUtils/wsBatchMath.h"
+#include "wsUtils/wsGeometry.h"
 #include "wsUtils/wsTime.h"
 #include "wsUtils/wsTrig.h"
+#include "wsUtils/wsMappedFile.h"
+#include "wsUtils/wsLZ4.h"
+#include "wsUtils/wsAssetManifest.h"
+#include "wsUtils/wsPakFile.h"
+#include "wsUtils/wsVirtualFS.h"
+#include "wsUtils/wsTokenizer.h"
 
 #endif  //  WS_UTILS_H_
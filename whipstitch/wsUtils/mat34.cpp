@@ -0,0 +1,317 @@
+/*
+ * mat34.cpp
+ *
+ *      This file implements the struct mat34, an affine 3x4 transformation matrix.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "mat34.h"
+#include "mat4.h"
+#include "vec4.h"
+#include "quat.h"
+
+const mat34 MAT34_IDENTITY;
+
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  //  Selects only the w element of a register
+  #define WS_SSE_W_MASK _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0))
+
+  //  Row of (first * second), given the matching row of second
+  static inline __m128 ws_sseAffineRow(__m128 row, const mat34& first) {
+    __m128 my = _mm_mul_ps(ws_sseDistributeX(row), first.mReg0);
+    my = ws_sseMadd(ws_sseDistributeY(row), first.mReg1, my);
+    my = ws_sseMadd(ws_sseDistributeZ(row), first.mReg2, my);
+    return _mm_add_ps(my, _mm_and_ps(row, WS_SSE_W_MASK));
+  }
+
+  //  Dot products of each row with vector, as { row0 row1 row2 0 }
+  static inline __m128 ws_sseAffineTransform(const mat34& mat, __m128 vector) {
+    __m128 x = _mm_mul_ps(mat.mReg0, vector);
+    __m128 y = _mm_mul_ps(mat.mReg1, vector);
+    __m128 z = _mm_mul_ps(mat.mReg2, vector);
+    __m128 w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    return _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+  }
+
+  mat34::mat34( f32 val0_0, f32 val0_1, f32 val0_2, f32 val0_3,
+                f32 val1_0, f32 val1_1, f32 val1_2, f32 val1_3,
+                f32 val2_0, f32 val2_1, f32 val2_2, f32 val2_3) :
+      mReg0(_mm_set_ps(val0_3, val0_2, val0_1, val0_0)),
+      mReg1(_mm_set_ps(val1_3, val1_2, val1_1, val1_0)),
+      mReg2(_mm_set_ps(val2_3, val2_2, val2_1, val2_0)) {}
+
+  mat34::mat34(const mat4& mat) {
+    __m128 col0 = mat.mReg0, col1 = mat.mReg1, col2 = mat.mReg2, col3 = mat.mReg3;
+    _MM_TRANSPOSE4_PS(col0, col1, col2, col3);
+    mReg0 = col0;
+    mReg1 = col1;
+    mReg2 = col2;
+  }
+
+  mat34 mat34::inverse() const {
+    //  Each axis is a column here, so one divide gives every axis its inverse squared
+    //  length, which undoes the scale as the transpose undoes the rotation
+    __m128 wMask = WS_SSE_W_MASK;
+    __m128 lengthSquared = _mm_mul_ps(mReg0, mReg0);
+    lengthSquared = ws_sseMadd(mReg1, mReg1, lengthSquared);
+    lengthSquared = ws_sseMadd(mReg2, mReg2, lengthSquared);
+    __m128 invLengthSquared = _mm_andnot_ps(wMask, _mm_div_ps(_mm_set1_ps(1.0f), lengthSquared));
+    __m128 row0 = _mm_mul_ps(mReg0, invLengthSquared);
+    __m128 row1 = _mm_mul_ps(mReg1, invLengthSquared);
+    __m128 row2 = _mm_mul_ps(mReg2, invLengthSquared);
+    //  The new translation is the old one, negated and carried through the inverse
+    __m128 trans = _mm_mul_ps(ws_sseDistributeW(mReg0), row0);
+    trans = ws_sseMadd(ws_sseDistributeW(mReg1), row1, trans);
+    trans = ws_sseMadd(ws_sseDistributeW(mReg2), row2, trans);
+    trans = _mm_sub_ps(_mm_setzero_ps(), trans);
+    _MM_TRANSPOSE4_PS(row0, row1, row2, trans);
+    mat34 my(row0, row1, row2);
+
+    return my;
+  }
+
+  vec4 mat34::transformPoint(const vec4& point) const {
+    __m128 w = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    __m128 my = _mm_or_ps(_mm_andnot_ps(WS_SSE_W_MASK, point.mReg), w);
+    return vec4(_mm_or_ps(ws_sseAffineTransform(*this, my), w));
+  }
+
+  vec4 mat34::transformVector(const vec4& vector) const {
+    return vec4(ws_sseAffineTransform(*this, _mm_andnot_ps(WS_SSE_W_MASK, vector.mReg)));
+  }
+
+  mat4 mat34::toMat4() const {
+    __m128 row0 = mReg0, row1 = mReg1, row2 = mReg2, row3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    return mat4(row0, row1, row2, row3);
+  }
+
+  mat34& mat34::operator*=(const mat34& other) {
+    __m128 row0 = ws_sseAffineRow(other.mReg0, *this);
+    __m128 row1 = ws_sseAffineRow(other.mReg1, *this);
+    mReg2 = ws_sseAffineRow(other.mReg2, *this);
+    mReg0 = row0;
+    mReg1 = row1;
+
+    return *this;
+  }
+
+  mat34 mat34::operator*(const mat34& other) const {
+    mat34 my( ws_sseAffineRow(other.mReg0, *this),
+              ws_sseAffineRow(other.mReg1, *this),
+              ws_sseAffineRow(other.mReg2, *this));
+
+    return my;
+  }
+
+#else   //  If SSE is not supported...
+
+  mat34::mat34( f32 val0_0, f32 val0_1, f32 val0_2, f32 val0_3,
+                f32 val1_0, f32 val1_1, f32 val1_2, f32 val1_3,
+                f32 val2_0, f32 val2_1, f32 val2_2, f32 val2_3) {
+    data[0] = val0_0;
+    data[1] = val0_1;
+    data[2] = val0_2;
+    data[3] = val0_3;
+    data[4] = val1_0;
+    data[5] = val1_1;
+    data[6] = val1_2;
+    data[7] = val1_3;
+    data[8] = val2_0;
+    data[9] = val2_1;
+    data[10] = val2_2;
+    data[11] = val2_3;
+  }
+
+  mat34::mat34(const mat4& mat) {
+    for (u32 row = 0; row < 3; ++row) {
+      for (u32 col = 0; col < 4; ++col) {
+        data[row*4+col] = mat.data[col*4+row];
+      }
+    }
+  }
+
+  mat34 mat34::inverse() const {
+    mat34 my;
+    for (u32 row = 0; row < 3; ++row) {
+      f32 x = data[row], y = data[row+4], z = data[row+8];
+      f32 invLengthSquared = 1.0f / (x*x + y*y + z*z);
+      x *= invLengthSquared;
+      y *= invLengthSquared;
+      z *= invLengthSquared;
+      my.data[row*4] = x;
+      my.data[row*4+1] = y;
+      my.data[row*4+2] = z;
+      my.data[row*4+3] = -(data[3]*x + data[7]*y + data[11]*z);
+    }
+
+    return my;
+  }
+
+  vec4 mat34::transformPoint(const vec4& point) const {
+    vec4 my(data[0]*point.x + data[1]*point.y + data[2]*point.z + data[3],
+            data[4]*point.x + data[5]*point.y + data[6]*point.z + data[7],
+            data[8]*point.x + data[9]*point.y + data[10]*point.z + data[11],
+            1.0f);
+
+    return my;
+  }
+
+  vec4 mat34::transformVector(const vec4& vector) const {
+    vec4 my(data[0]*vector.x + data[1]*vector.y + data[2]*vector.z,
+            data[4]*vector.x + data[5]*vector.y + data[6]*vector.z,
+            data[8]*vector.x + data[9]*vector.y + data[10]*vector.z,
+            0.0f);
+
+    return my;
+  }
+
+  mat4 mat34::toMat4() const {
+    mat4 my(data[0], data[4], data[8], 0.0f,
+            data[1], data[5], data[9], 0.0f,
+            data[2], data[6], data[10], 0.0f,
+            data[3], data[7], data[11], 1.0f);
+
+    return my;
+  }
+
+  mat34& mat34::operator*=(const mat34& other) {
+    *this = *this * other;
+
+    return *this;
+  }
+
+  mat34 mat34::operator*(const mat34& other) const {
+    mat34 my(
+            other.data[0] * data[0] + other.data[1] * data[4] + other.data[2] * data[8],
+            other.data[0] * data[1] + other.data[1] * data[5] + other.data[2] * data[9],
+            other.data[0] * data[2] + other.data[1] * data[6] + other.data[2] * data[10],
+            other.data[0] * data[3] + other.data[1] * data[7] + other.data[2] * data[11] + other.data[3],
+            other.data[4] * data[0] + other.data[5] * data[4] + other.data[6] * data[8],
+            other.data[4] * data[1] + other.data[5] * data[5] + other.data[6] * data[9],
+            other.data[4] * data[2] + other.data[5] * data[6] + other.data[6] * data[10],
+            other.data[4] * data[3] + other.data[5] * data[7] + other.data[6] * data[11] + other.data[7],
+            other.data[8] * data[0] + other.data[9] * data[4] + other.data[10] * data[8],
+            other.data[8] * data[1] + other.data[9] * data[5] + other.data[10] * data[9],
+            other.data[8] * data[2] + other.data[9] * data[6] + other.data[10] * data[10],
+            other.data[8] * data[3] + other.data[9] * data[7] + other.data[10] * data[11] + other.data[11]);
+
+    return my;
+  }
+
+#endif  /*  WS_SUPPORTS_SSE */
+
+//  The same rotation mat4::setRotation(...) builds, transposed and scaled
+mat34::mat34(f32 scale, const quat& rotation, const vec4& translation) {
+  f32 xx = rotation.x * rotation.x;
+  f32 xy = rotation.x * rotation.y;
+  f32 xz = rotation.x * rotation.z;
+  f32 xw = rotation.x * rotation.w;
+  f32 yy = rotation.y * rotation.y;
+  f32 yz = rotation.y * rotation.z;
+  f32 yw = rotation.y * rotation.w;
+  f32 zz = rotation.z * rotation.z;
+  f32 zw = rotation.z * rotation.w;
+  f32 scale2 = scale * 2.0f;
+  *this = mat34(scale - scale2 * (yy + zz), scale2 * (xy - zw), scale2 * (xz + yw), translation.x,
+                scale2 * (xy + zw), scale - scale2 * (xx + zz), scale2 * (yz - xw), translation.y,
+                scale2 * (xz - yw), scale2 * (yz + xw), scale - scale2 * (xx + yy), translation.z);
+}
+
+f32 mat34::getScale() const {
+  return wsSqrt(data[0]*data[0] + data[4]*data[4] + data[8]*data[8]);
+}
+
+//  Largest-component extraction, so that no division is by a value near zero
+quat mat34::getRotation() const {
+  f32 invScale = 1.0f / getScale();
+  f32 m00 = data[0]*invScale, m01 = data[4]*invScale, m02 = data[8]*invScale;
+  f32 m10 = data[1]*invScale, m11 = data[5]*invScale, m12 = data[9]*invScale;
+  f32 m20 = data[2]*invScale, m21 = data[6]*invScale, m22 = data[10]*invScale;
+  f32 trace = m00 + m11 + m22;
+  f32 my;
+  if (trace > 0.0f) {
+    my = 2.0f * wsSqrt(1.0f + trace);
+    return quat((m12 - m21) / my, (m20 - m02) / my, (m01 - m10) / my, my / 4.0f);
+  }
+  if (m00 > m11 && m00 > m22) {
+    my = 2.0f * wsSqrt(1.0f + m00 - m11 - m22);
+    return quat(my / 4.0f, (m01 + m10) / my, (m02 + m20) / my, (m12 - m21) / my);
+  }
+  if (m11 > m22) {
+    my = 2.0f * wsSqrt(1.0f + m11 - m00 - m22);
+    return quat((m01 + m10) / my, my / 4.0f, (m12 + m21) / my, (m20 - m02) / my);
+  }
+  my = 2.0f * wsSqrt(1.0f + m22 - m00 - m11);
+  return quat((m02 + m20) / my, (m12 + m21) / my, my / 4.0f, (m01 - m10) / my);
+}
+
+vec4 mat34::getTranslation() const {
+  vec4 my(data[3], data[7], data[11]);
+
+  return my;
+}
+
+mat34& mat34::setTranslation(const vec4& trans) {
+  data[3] = trans.x;
+  data[7] = trans.y;
+  data[11] = trans.z;
+
+  return *this;
+}
+
+mat34& mat34::setTranslation(f32 transX, f32 transY, f32 transZ) {
+  data[3] = transX;
+  data[7] = transY;
+  data[11] = transZ;
+
+  return *this;
+}
+
+mat34& mat34::translate(const vec4& location) {
+  data[3] += location.x;
+  data[7] += location.y;
+  data[11] += location.z;
+
+  return *this;
+}
+
+mat34& mat34::invert() {
+  *this = inverse();
+
+  return *this;
+}
+
+void mat34::print(u16 printLog) const {
+  wsEcho( printLog,
+          "  [ %f %f %f %f ]\n"
+          "    [ %f %f %f %f ]\n"
+          "    [ %f %f %f %f ]\n",
+          data[0], data[1], data[2], data[3],
+          data[4], data[5], data[6], data[7],
+          data[8], data[9], data[10], data[11] );
+}
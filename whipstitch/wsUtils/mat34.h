@@ -0,0 +1,104 @@
+/*
+ * mat34.h
+ *
+ *      This file declares the struct mat34, an affine transformation matrix of 32-bit
+ *      floating point variables. Scale, rotation and translation never touch the last
+ *      column of a mat4, so a mat34 stores only the other three. Each of its three rows
+ *      is one column of the equivalent mat4:
+ *        [ m00 m10 m20 m30 ]
+ *        [ m01 m11 m21 m31 ]
+ *        [ m02 m12 m22 m32 ]
+ *      so that each component of a transformed point is a single dot product with
+ *      { x, y, z, 1 }. This is also the layout shaders expect for a 3x4 matrix.
+ *
+ *      Multiplication follows mat4: a*b transforms by a first, then by b. The inverse
+ *      transposes the rotation rather than solving a 4x4 system, which holds as long
+ *      as the matrix axes are perpendicular (any scale, rotation and translation, as
+ *      produced by wsTransform). Use mat4::inverse() for matrices with shear.
+ *
+ *      One implementation is provided using standard C operations, the other
+ *      utilizing SSE on platforms which support it, with one row per register.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MAT34_H_
+#define WS_MAT34_H_
+
+#include "wsOperations.h"
+
+struct vec4;
+struct quat;
+struct mat4;
+
+struct mat34 {
+#if WS_SUPPORTS_SSE == WS_TRUE
+    sseAlign(
+        union {
+            struct {
+                __m128  mReg0;
+                __m128  mReg1;
+                __m128  mReg2;
+            };
+            f32 data[12];
+        }
+    );
+    mat34(const __m128& reg0, const __m128& reg1, const __m128& reg2) :
+        mReg0(reg0), mReg1(reg1), mReg2(reg2) {}
+#else
+    f32 data[12];
+#endif  /*  WS_SUPPORTS_SSE    */
+    //  default identity matrix
+    mat34(  f32 val0_0 = 1.0f, f32 val0_1 = 0.0f, f32 val0_2 = 0.0f, f32 val0_3 = 0.0f,
+            f32 val1_0 = 0.0f, f32 val1_1 = 1.0f, f32 val1_2 = 0.0f, f32 val1_3 = 0.0f,
+            f32 val2_0 = 0.0f, f32 val2_1 = 0.0f, f32 val2_2 = 1.0f, f32 val2_3 = 0.0f  );
+    //  Builds the matrix which scales, then rotates, then translates
+    mat34(f32 scale, const quat& rotation, const vec4& translation);
+    //  Takes the first three columns of the 4x4 matrix
+    explicit mat34(const mat4& mat);
+    f32* getData() { return data; }
+    //  Uniform scale, as wsTransform stores it (the length of the first axis)
+    f32 getScale() const;
+    //  Rotation with the scale removed
+    quat getRotation() const;
+    vec4 getTranslation() const;
+    mat34& setTranslation(const vec4& trans);
+    mat34& setTranslation(f32 transX, f32 transY, f32 transZ);
+    //  Adds the offset after the rest of the transform
+    mat34& translate(const vec4& location);
+    mat34& invert();
+    mat34 inverse() const;
+    //  Returns { x, y, z, 1 } transformed by the whole matrix
+    vec4 transformPoint(const vec4& point) const;
+    //  Returns { x, y, z, 0 } transformed without the translation
+    vec4 transformVector(const vec4& vector) const;
+    mat4 toMat4() const;
+    mat34& operator*=(const mat34& other);
+    mat34 operator*(const mat34& other) const;
+    void print(u16 printLog = WS_LOG_MAIN) const;
+};
+
+extern const mat34 MAT34_IDENTITY;
+
+#endif /* WS_MAT34_H_ */
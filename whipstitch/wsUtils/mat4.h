@@ -13,12 +13,12 @@
  *      and inversion are included.
  *
  *      One implementation is provided using standard C operations, the other
- *      utilizing SSE4 on platforms which support it.
+ *      utilizing SSE on platforms which support it.
  *
- *      SSE4 is a version of the SSE (Streaming SIMD Extensions) set, which allows
- *      a single instruction to be performed on multiple data values simultaneously.
- *      The SSE register is 128 bits, allowing four 32-bit data values to be operated on.
- *      In this case, those data values are floating point decimal values.
+ *      SSE (Streaming SIMD Extensions) allows a single instruction to be performed on
+ *      multiple data values simultaneously. The SSE register is 128 bits, allowing four
+ *      32-bit data values to be operated on. In this case, each register holds one
+ *      row of the matrix.
  *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
@@ -53,7 +53,7 @@ struct vec4;
 struct quat;
 
 struct mat4 {
-#if WS_SUPPORTS_SSE4 == WS_TRUE
+#if WS_SUPPORTS_SSE == WS_TRUE
     sseAlign(
         union {
             struct {
@@ -91,7 +91,7 @@ struct mat4 {
     mat4(const mat4& other);  //  copy constructor
     f32* getData() { return data; }
     f32 getData(u32 row, u32 col) { return data[row*4+col]; }
-#endif  /*  WS_SUPPORTS_SSE4    */
+#endif  /*  WS_SUPPORTS_SSE    */
     vec4 getRow(u32 rowNum) const;
     vec4 getCol(u32 colNum) const;
     f32 determinant() const;
@@ -11,13 +11,14 @@
  *    be conveniently modified and interpolated with each other, and do not suffer
  *    from gimbal lock.
  *
- *    One version is provided using standard C operations, the other
- *    utilizing SSE4 on platforms which support it.
+ *    One version of the register-level operations is provided using standard C
+ *    operations, the other utilizing SSE on platforms which support it. Everything
+ *    built from those operations is shared by both versions, below them.
  *
- *    SSE4 is a version of the SSE (Streaming SIMD Extensions) set, which allows
- *    a single instruction to be performed on multiple data values simultaneously.
- *    The SSE register is 128 bits, allowing four 32-bit data values to be operated on.
- *    In this case, those data values are floating point decimal values.
+ *    SSE (Streaming SIMD Extensions) allows a single instruction to be performed on
+ *    multiple data values simultaneously. The SSE register is 128 bits, allowing four
+ *    32-bit data values to be operated on. In this case, those data values are
+ *    floating point decimal values.
  *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
@@ -46,33 +47,11 @@
 #include "quat.h"
 #include "vec4.h"
 
-#if WS_SUPPORTS_SSE4 == WS_TRUE
+#if WS_SUPPORTS_SSE == WS_TRUE
 
-  #define WS_FLIP_QUAT(q) \
-    q = _mm_xor_ps(q, _mm_setr_ps(0, 0, 0, 0x80000000))
-
-  //  Constructors
-
-  quat::quat(vec4 axis, f32 angle) {
-    WS_PROFILE();
-    axis.normalize();
-    mReg = _mm_mul_ps( _mm_set_ps(0.0f, axis.z, axis.y, axis.x),
-            _mm_set1_ps(wsSin(angle/2.0f)) );
-    w = wsCos(angle/2.0f);
-
-  }
-  quat::quat(const vec4& euler) {
-    WS_PROFILE();
-    quat rot_x(vec4(1.0f, 0.0f, 0.0f), euler.x);
-    quat rot_y(vec4(0.0f, 1.0f, 0.0f), euler.y);
-    quat rot_z(vec4(0.0f, 0.0f, 1.0f), euler.z);
-    rot_z *= rot_y;
-    rot_z *= rot_x;
-    *this = rot_z;
-
-  }
-
-  //  Operational Member Functions
+  //  Sign masks; xor-ing with -0.0f flips the sign of an element
+  #define WS_QUAT_SIGNS(x, y, z, w) \
+    _mm_set_ps((w) ? -0.0f : 0.0f, (z) ? -0.0f : 0.0f, (y) ? -0.0f : 0.0f, (x) ? -0.0f : 0.0f)
 
   quat& quat::set(f32 myX, f32 myY, f32 myZ, f32 myW) {
     WS_PROFILE();
@@ -81,142 +60,44 @@
     return *this;
   }
 
-  quat quat::getConjugate() const {
-    WS_PROFILE();
-    quat my(-x, -y, -z, w);
-
-    return my;
-  }
-
   quat& quat::conjugate() {
     WS_PROFILE();
-    mReg = _mm_mul_ps(mReg, _mm_set_ps(1.0f, -1.0f, -1.0f, -1.0f));
+    mReg = _mm_xor_ps(mReg, WS_QUAT_SIGNS(1, 1, 1, 0));
 
     return *this;
   }
 
-  //  For our purposes (using normalized quaternions), the inverse and
-  //  conjugate are the same.
-  quat quat::getInverse() const {
-    WS_PROFILE();
-    quat my(-x, -y, -z, w);
-
-    return my;
-  }
-
   quat& quat::invert() {
     WS_PROFILE();
-    mReg = _mm_mul_ps(mReg, _mm_set_ps(1.0f, -1.0f, -1.0f, -1.0f));
+    mReg = _mm_xor_ps(mReg, WS_QUAT_SIGNS(1, 1, 1, 0));
 
     return *this;
   }
 
-  //  Returns the angle between the two quaternions
-  f32 quat::getAngle(const quat& other) const {
-    WS_PROFILE();
-    f32 my = wsArcCos( x*other.x + y*other.y + z*other.z + w*other.w );
-
-    return my;
-  }
-
-  //  Uses Slerp, returns the blended quaternion
-  quat quat::blend(const quat& other, f32 blendFactor) const {
-    WS_PROFILE();
-    f32 theta = getAngle(other);
-    f32 blendoA = wsSin((1.0f-blendFactor)*theta) / wsSin(theta);
-    f32 blendoB = wsSin(blendFactor*theta) / wsSin(theta);
-    quat my(_mm_add_ps( _mm_mul_ps( _mm_set1_ps(blendoA), mReg ),
-              _mm_mul_ps( _mm_set1_ps(blendoB), other.mReg ) ) );
-
-    return my;
-  }
-
-  //Uses slerp, sets this to blended quaternion
-  quat& quat::toBlend(const quat& other, f32 blendFactor) {
-    WS_PROFILE();
-    f32 theta = getAngle(other);
-    f32 blendoA = wsSin((1.0f-blendFactor)*theta) / wsSin(theta);
-    f32 blendoB = wsSin(blendFactor*theta) / wsSin(theta);
-    mReg =  _mm_add_ps( _mm_mul_ps( _mm_set1_ps(blendoA), mReg ),
-              _mm_mul_ps( _mm_set1_ps(blendoB), other.mReg ) );
-
-    return *this;
-  }
-
-  quat& quat::setRotation(vec4 axis, f32 angle) {
-    WS_PROFILE();
-    axis.normalize();
-    mReg = _mm_mul_ps( _mm_set_ps(0.0f, axis.z, axis.y, axis.x),
-            _mm_set1_ps(wsSin(angle/2.0f)) );
-    w = wsCos(angle/2.0f);
-
-    return *this;
-  }
-
-  quat& quat::setRotation(f32 axisX, f32 axisY, f32 axisZ, f32 angle) {
-    WS_PROFILE();
-    setRotation(vec4(axisX, axisY, axisZ), angle);
-
-    return *this;
-  }
-
-  quat& quat::setRotationZXY(const vec4& euler) {
+  f32 quat::dotProduct(const quat& other) const {
     WS_PROFILE();
-    quat rot_x(vec4(1.0f, 0.0f, 0.0f), euler.x);
-    quat rot_y(vec4(0.0f, 1.0f, 0.0f), euler.y);
-    quat rot_z(vec4(0.0f, 0.0f, 1.0f), euler.z);
-    rot_z *= rot_y;
-    rot_z *= rot_x;
-    *this = rot_z;
-
-    return *this;
+    return _mm_cvtss_f32(ws_sseDot4(mReg, other.mReg));
   }
 
+  //  Each of this quaternion's elements scales a signed shuffle of the other
   quat quat::operator*(const quat& other) const {
     WS_PROFILE();
-    /*
-    __m128 opOne = _mm_mul_ps( mReg, ws_sseDistributeW(other.mReg));
-    __m128 opTwo = _mm_mul_ps( ws_sseShuffle(mReg, 2, 0, 1, 0),
-            ws_sseShuffle(other.mReg, 1, 2, 0, 0));
-    __m128 opThree = _mm_mul_ps(ws_sseShuffle(mReg, 3, 3, 3, 1),
-            ws_sseShuffle(other.mReg, 0, 1, 2, 1));
-    __m128 opFour = _mm_mul_ps( ws_sseShuffle(mReg, 1, 2, 0, 2),
-            ws_sseShuffle(other.mReg, 2, 0, 1, 2));
-    WS_FLIP_QUAT(opThree);
-    WS_FLIP_QUAT(opFour);
-    return quat(_mm_add_ps(_mm_sub_ps(opOne, opTwo), _mm_add_ps(opThree, opFour)));
-    /*/
-    quat my(w * other.x + x * other.w + y * other.z - z * other.y,
-        w * other.y + y * other.w + z * other.x - x * other.z,
-        w * other.z + z * other.w + x * other.y - y * other.x,
-        w * other.w - x * other.x - y * other.y - z * other.x);
+    __m128 result = _mm_mul_ps(ws_sseDistributeW(mReg), other.mReg);
+    result = _mm_add_ps(result, _mm_xor_ps(_mm_mul_ps(ws_sseDistributeX(mReg),
+              ws_sseShuffle(other.mReg, 3, 2, 1, 0)), WS_QUAT_SIGNS(0, 1, 0, 1)));
+    result = _mm_add_ps(result, _mm_xor_ps(_mm_mul_ps(ws_sseDistributeY(mReg),
+              ws_sseShuffle(other.mReg, 2, 3, 0, 1)), WS_QUAT_SIGNS(0, 0, 1, 1)));
+    result = _mm_add_ps(result, _mm_xor_ps(_mm_mul_ps(ws_sseDistributeZ(mReg),
+              ws_sseShuffle(other.mReg, 1, 0, 3, 2)), WS_QUAT_SIGNS(1, 0, 0, 1)));
 
-    return my;
-    //*/
+    return quat(result);
   }
 
   quat& quat::operator*=(const quat& other) {
     WS_PROFILE();
-    /*
-    __m128 opOne = _mm_mul_ps( mReg, ws_sseShuffle(other.mReg, 3, 3, 3, 3));
-    __m128 opTwo = _mm_mul_ps( ws_sseShuffle(mReg, 2, 0, 1, 0),
-            ws_sseShuffle(other.mReg, 1, 2, 0, 0));
-    __m128 opThree = _mm_mul_ps(ws_sseShuffle(mReg, 3, 3, 3, 1),
-            ws_sseShuffle(other.mReg, 0, 1, 2, 1));
-    __m128 opFour = _mm_mul_ps( ws_sseShuffle(mReg, 1, 2, 0, 2),
-            ws_sseShuffle(other.mReg, 2, 0, 1, 2));
-    WS_FLIP_QUAT(opThree);
-    WS_FLIP_QUAT(opFour);
-    mReg = _mm_add_ps(_mm_sub_ps(opOne, opTwo), _mm_add_ps(opThree, opFour));
-    return *this;
-    /*/
-    set(w * other.x + x * other.w + y * other.z - z * other.y,
-      w * other.y + y * other.w + z * other.x - x * other.z,
-      w * other.z + z * other.w + x * other.y - y * other.x,
-      w * other.w - x * other.x - y * other.y - z * other.x);
+    *this = *this * other;
 
     return *this;
-    //*/
   }
 
   quat& quat::operator=(const quat& other) {
@@ -226,13 +107,25 @@
     return *this;
   }
 
-  void quat::print(u16 printLog) const {
-    wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
+  quat quat::normal() const {
+    __m128 magSquared = ws_sseDot4(mReg, mReg);
+    if (_mm_cvtss_f32(magSquared) == 0.0f) {
+      return *this;
+    }
+
+    return quat(_mm_div_ps(mReg, _mm_sqrt_ps(magSquared)));
   }
 
-#else   //  If this does not support SSE4
+  quat& quat::normalize() {
+    __m128 magSquared = ws_sseDot4(mReg, mReg);
+    if (_mm_cvtss_f32(magSquared) != 0.0f) {
+      mReg = _mm_div_ps(mReg, _mm_sqrt_ps(magSquared));
+    }
+
+    return *this;
+  }
 
-  //  Constructors
+#else   //  If this does not support SSE
 
   quat& quat::set(f32 myX, f32 myY, f32 myZ, f32 myW) {
     WS_PROFILE();
@@ -244,28 +137,6 @@
     return *this;
   }
 
-  quat::quat(vec4 axis, f32 angle) {
-    WS_PROFILE();
-    axis.normalize();
-    f32 sineage = wsSin(angle/2.0f);
-    x = axis.x * sineage;
-    y = axis.y * sineage;
-    z = axis.z * sineage;
-    w = wsCos(angle/2.0f);
-
-  }
-
-  quat::quat(const vec4& euler) {
-    WS_PROFILE();
-    quat rot_x(vec4(1.0f, 0.0f, 0.0f, 1.0f), euler.x);
-    quat rot_y(vec4(0.0f, 1.0f, 0.0f, 1.0f), euler.y);
-    quat rot_z(vec4(0.0f, 0.0f, 1.0f, 1.0f), euler.z);
-    rot_z *= rot_y;
-    rot_z *= rot_x;
-    *this = rot_z;
-
-  }
-
   quat::quat(const quat& other) {
     WS_PROFILE();
     x = other.x;
@@ -275,14 +146,6 @@
 
   }
 
-  //  Operational Member Functions
-  quat quat::getConjugate() const {
-    WS_PROFILE();
-    quat my(-x, -y, -z, w);
-
-    return my;
-  }
-
   quat& quat::conjugate() {
     WS_PROFILE();
     x *= -1.0f;
@@ -292,13 +155,6 @@
     return *this;
   }
 
-  //  For our purposes (using normalized quaternions), the inverse and
-  //  conjugate are the same.
-  quat quat::getInverse() const {
-    WS_PROFILE();
-    return quat(-x, -y, -z, w);
-  }
-
   quat& quat::invert() {
     WS_PROFILE();
     x *= -1.0f;
@@ -307,102 +163,11 @@
     return *this;
   }
 
-  //  Returns the angle between the two quaternions
-  f32 quat::getAngle(const quat& other) const {
-    WS_PROFILE();
-    return wsArcCos( x*other.x + y*other.y + z*other.z + w*other.w );
-  }
-
   f32 quat::dotProduct(const quat& other) const {
     WS_PROFILE();
     return f32(x*other.x + y*other.y + z*other.z + w*other.w);
   }
 
-  //  Uses Slerp, returns the blended quaternion
-  quat quat::blend(const quat& other, f32 blendFactor) const {
-    WS_PROFILE();
-    /*  //  TOGGLE - SLERP
-    f32 theta = getAngle(other);
-    f32 blendoA = wsSin((1.0f-blendFactor)*theta);
-    f32 blendoB = wsSin(blendFactor*theta);
-    return quat(  (blendoA*x + blendoB*other.x) / wsSin(theta),
-            (blendoA*y + blendoB*other.y) / wsSin(theta),
-            (blendoA*z + blendoB*other.z) / wsSin(theta),
-            (blendoA*w + blendoB*other.w) / wsSin(theta) );
-    /*/ //  TOGGLE - LERP
-    return quat(wsLerp(x, other.x, blendFactor),
-          wsLerp(y, other.y, blendFactor),
-          wsLerp(z, other.z, blendFactor),
-          wsLerp(w, other.w, blendFactor) );
-    //*///! spherical linear interpolation
-    /*
-    f32 dot = dotProduct(other);
-    quat third(other);
-    if (dot < 0) {
-      dot *= -1;
-      third *= -1;
-    }
-    f32 theta = wsArcCos(dot);
-    return (*this * wsSin(angle*(1.0-blendFactor)) + third*wsSin(angle*blendFactor))/wsSin(angle);//*/
-  }
-
-  //Uses slerp, sets this to blended quaternion
-  quat& quat::toBlend(const quat& other, f32 blendFactor) {
-    WS_PROFILE();
-    /*  //  TOGGLE - SLERP
-    f32 theta = getAngle(other);
-    f32 blendoA = wsSin((1.0f-blendFactor)*theta) / wsSin(theta);
-    f32 blendoB = wsSin(blendFactor*theta) / wsSin(theta);
-    x =  blendoA*x + blendoB*other.x;
-    y =  blendoA*y + blendoB*other.y;
-    z =  blendoA*z + blendoB*other.z;
-    w =  blendoA*w + blendoB*other.w;
-    /*/ //  TOGGLE - LERP
-    x = wsLerp(x, other.x, blendFactor);
-    y = wsLerp(y, other.y, blendFactor);
-    z = wsLerp(z, other.z, blendFactor);
-    w = wsLerp(w, other.w, blendFactor);
-    //*/
-
-    return *this;
-  }
-
-  quat& quat::setRotation(vec4 axis, f32 angle) {
-    WS_PROFILE();
-    axis.normalize();
-    f32 sineage = wsSin(angle / 2.0f);
-    x = axis.x * sineage;
-    y = axis.y * sineage;
-    z = axis.z * sineage;
-    w = wsCos(angle / 2.0f);
-
-    return *this;
-  }
-
-  quat& quat::setRotation(f32 axisX, f32 axisY, f32 axisZ, f32 angle) {
-    WS_PROFILE();
-    setRotation(vec4(axisX, axisY, axisZ), angle);
-
-    return *this;
-  }
-
-  quat& quat::setRotationZXY(const vec4& euler) {
-    WS_PROFILE();
-    quat rot_x(vec4(1.0f, 0.0f, 0.0f, 1.0f), euler.x);
-    quat rot_y(vec4(0.0f, 1.0f, 0.0f, 1.0f), euler.y);
-    quat rot_z(vec4(0.0f, 0.0f, 1.0f, 1.0f), euler.z);
-    rot_z *= rot_y;
-    rot_z *= rot_x;
-    *this = rot_z;
-
-    return *this;
-  }
-
-  quat quat::operator-() const {
-    WS_PROFILE();
-    return quat(-x, -y, -z, w);
-  }
-
   quat quat::operator*(const quat& other) const {
     WS_PROFILE();
     return quat(w*other.x + x*other.w + y*other.z - z*other.y,
@@ -457,13 +222,127 @@
     return *this;
   }
 
-  void quat::print(u16 printLog) const {
-    wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
-  }
+#endif /*   WS_SUPPORTS_SSE  */
 
-  quat& quat::rotate(const vec4& axis, const f32 angle) {
-    *this *= quat(axis, angle);
-    return *this;
-  }
+//  Operations shared by both versions
+
+quat::quat(vec4 axis, f32 angle) {
+  WS_PROFILE();
+  setRotation(axis, angle);
+
+}
+
+quat::quat(const vec4& euler) {
+  WS_PROFILE();
+  setRotationZXY(euler);
+
+}
+
+quat quat::getConjugate() const {
+  WS_PROFILE();
+  return quat(-x, -y, -z, w);
+}
 
-#endif /*   WS_SUPPORTS_SSE4  */
+//  For our purposes (using normalized quaternions), the inverse and
+//  conjugate are the same.
+quat quat::getInverse() const {
+  WS_PROFILE();
+  return quat(-x, -y, -z, w);
+}
+
+//  Returns the angle between the two quaternions
+f32 quat::getAngle(const quat& other) const {
+  WS_PROFILE();
+  return wsArcCos( dotProduct(other) );
+}
+
+quat& quat::setRotation(vec4 axis, f32 angle) {
+  WS_PROFILE();
+  axis.normalize();
+  f32 sineage, cosineage;
+  wsSinCos(angle / 2.0f, &sineage, &cosineage);
+  set(axis.x * sineage, axis.y * sineage, axis.z * sineage, cosineage);
+
+  return *this;
+}
+
+//  Both blends take the shorter path, negating the other quaternion if needed
+quat quat::nlerp(const quat& other, f32 blendFactor) const {
+  WS_PROFILE();
+  f32 otherWeight = (dotProduct(other) < 0.0f) ? -blendFactor : blendFactor;
+  f32 myWeight = 1.0f - blendFactor;
+  quat my(myWeight*x + otherWeight*other.x, myWeight*y + otherWeight*other.y,
+          myWeight*z + otherWeight*other.z, myWeight*w + otherWeight*other.w);
+
+  return my.normalize();
+}
+
+quat quat::slerp(const quat& other, f32 blendFactor) const {
+  WS_PROFILE();
+  f32 cosAngle = dotProduct(other);
+  f32 sign = 1.0f;
+  if (cosAngle < 0.0f) {
+    cosAngle = -cosAngle;
+    sign = -1.0f;
+  }
+  //  Too close to divide by sin(angle); the two blends agree here anyway
+  if (cosAngle > 0.9999f) {
+    return nlerp(other, blendFactor);
+  }
+  f32 angle = wsArcCos(cosAngle);
+  f32 invSinAngle = 1.0f / wsSqrt(1.0f - cosAngle*cosAngle);
+  f32 myWeight = wsSin((1.0f - blendFactor)*angle) * invSinAngle;
+  f32 otherWeight = sign * wsSin(blendFactor*angle) * invSinAngle;
+  quat my(myWeight*x + otherWeight*other.x, myWeight*y + otherWeight*other.y,
+          myWeight*z + otherWeight*other.z, myWeight*w + otherWeight*other.w);
+
+  return my.normalize();
+}
+
+quat quat::blend(const quat& other, f32 blendFactor) const {
+  if (fabsf(dotProduct(other)) > WS_QUAT_NLERP_THRESHOLD) {
+    return nlerp(other, blendFactor);
+  }
+
+  return slerp(other, blendFactor);
+}
+
+quat& quat::toBlend(const quat& other, f32 blendFactor) {
+  *this = blend(other, blendFactor);
+
+  return *this;
+}
+
+quat& quat::setRotation(f32 axisX, f32 axisY, f32 axisZ, f32 angle) {
+  WS_PROFILE();
+  setRotation(vec4(axisX, axisY, axisZ), angle);
+
+  return *this;
+}
+
+quat& quat::setRotationZXY(const vec4& euler) {
+  WS_PROFILE();
+  quat rot_x(vec4(1.0f, 0.0f, 0.0f, 1.0f), euler.x);
+  quat rot_y(vec4(0.0f, 1.0f, 0.0f, 1.0f), euler.y);
+  quat rot_z(vec4(0.0f, 0.0f, 1.0f, 1.0f), euler.z);
+  rot_z *= rot_y;
+  rot_z *= rot_x;
+  *this = rot_z;
+
+  return *this;
+}
+
+//  Returns the conjugate, as the inverse rotation
+quat quat::operator-() const {
+  WS_PROFILE();
+  return quat(-x, -y, -z, w);
+}
+
+void quat::print(u16 printLog) const {
+  wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
+}
+
+quat& quat::rotate(const vec4& axis, const f32 angle) {
+  *this *= quat(axis, angle);
+  return *this;
+}
@@ -50,10 +50,14 @@
 #include "wsOperations.h"
 #include <stdio.h>
 
+//  quat::blend(...) uses nlerp when the dot product of the two quaternions is above
+//  this, where nlerp's rotation differs from slerp's by at most 0.08 degrees
+#define WS_QUAT_NLERP_THRESHOLD 0.95f
+
 struct vec4;
 
 struct quat {
-#if WS_SUPPORTS_SSE4 == WS_TRUE
+#if WS_SUPPORTS_SSE == WS_TRUE
     //  Data members
     sseAlign(
         union {
@@ -64,21 +68,21 @@ struct quat {
                 f32 z;
                 f32 w;
             };
-        };
-    )
+        }
+    );
     //  Default constructor
     quat(f32 myX = 0.0f, f32 myY = 0.0f, f32 myZ = 0.0f, f32 myW = 1.0f) :
         mReg(_mm_set_ps(myW, myZ, myY, myX)) {}
     quat(const quat& other) : mReg(other.mReg) {}
     quat(__m128 reg) : mReg(reg) {}
-#else   //  If SSE4 is not supported
+#else   //  If SSE is not supported
     //  Data members
     f32 x, y, z, w;
     //  Default constructor
     quat(f32 myX = 0.0f, f32 myY = 0.0f, f32 myZ = 0.0f, f32 myW = 1.0f) :
         x(myX), y(myY), z(myZ), w(myW) {}
     quat(const quat& other);
-#endif  /*  WS_SUPPORTS_SSE4    */
+#endif  /*  WS_SUPPORTS_SSE    */
     quat(vec4 axis, f32 angle);
     quat(const vec4& euler);
     //  Operational Member Functions
@@ -92,9 +96,13 @@ struct quat {
     //  Returns angle (in degrees) between the 2 quats
     f32 getAngle(const quat& other) const;
     f32 dotProduct(const quat& other) const;
-    //  Uses Slerp, returns blended quat
+    //  Normalized linear interpolation; cheap, but its speed varies across the blend
+    quat nlerp(const quat& other, f32 blendFactor) const;
+    //  Spherical linear interpolation; constant speed, at the cost of three trig calls
+    quat slerp(const quat& other, f32 blendFactor) const;
+    //  Uses nlerp where it is indistinguishable from slerp, and slerp elsewhere
     quat blend(const quat& other, f32 blendFactor) const;
-    //Uses slerp, sets this to the blended quat
+    //  Sets this to the blended quat
     quat& toBlend(const quat& other, f32 blendFactor);
     quat& setRotation(vec4 axis, f32 angle);
     quat& setRotation(f32 axisX, f32 axisY, f32 axisZ, f32 angle);
@@ -12,13 +12,15 @@
  *    Because of the mathematical nature of the operations, many or all functions
  *    have been recommended for inlining to the compiler.
  *
- *    One version is provided using standard C operations, the other
- *    utilizing SSE4 on platforms which support it.
+ *    One version of the register-level operations is provided using standard C
+ *    operations, the other utilizing SSE on platforms which support it. Everything
+ *    built from those operations is shared by both versions, below them.
  *
- *    SSE4 is a version of the SSE (Streaming SIMD Extensions) set, which allows
- *    a single instruction to be performed on multiple data values simultaneously.
- *    The SSE register is 128 bits, allowing four 32-bit data values to be operated on.
- *    In this case, those data values are floating point decimal values.
+ *    SSE (Streaming SIMD Extensions) allows a single instruction to be performed on
+ *    multiple data values simultaneously. The SSE register is 128 bits, allowing four
+ *    32-bit data values to be operated on. In this case, those data values are
+ *    floating point decimal values. Only SSE2 is required; SSE4.1 dot products are used
+ *    when the compiler enables them.
  *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
@@ -52,7 +54,13 @@ const vec4 WS_X_AXIS(1.0f, 0.0f, 0.0f, 1.0f);
 const vec4 WS_Y_AXIS(0.0f, 1.0f, 0.0f, 1.0f);
 const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
 
-#if WS_SUPPORTS_SSE4 == WS_TRUE
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  //  Selects x, y and z from a and w from b
+  inline __m128 ws_sseKeepW(__m128 a, __m128 b) {
+    const __m128 maskW = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    return _mm_or_ps(_mm_andnot_ps(maskW, a), _mm_and_ps(maskW, b));
+  }
 
   //  Set variables
   vec4& vec4::set(f32 myX, f32 myY, f32 myZ, f32 myW) {
@@ -68,7 +76,7 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
   }
 
   vec4& vec4::set4(const f32 data[]) {
-    mReg = _mm_set_ps(data[3], data[2], data[1], data[0]);
+    mReg = _mm_loadu_ps(data);
 
     return *this;
   }
@@ -80,62 +88,50 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
   }
 
   // Arithmetic Operators
-  vec4 vec4::operator+(const vec4& other) const {
-    vec4 my = _mm_add_ps(mReg, other.mReg);
+  vec4 vec4::operator-() const {
+    return vec4(_mm_xor_ps(mReg, _mm_set1_ps(-0.0f)));
+  }
 
-    return my;
+  vec4 vec4::operator+(const vec4& other) const {
+    return vec4(_mm_add_ps(mReg, other.mReg));
   }
 
   vec4 vec4::operator-(const vec4& other) const {
-    vec4 my = _mm_sub_ps(mReg, other.mReg);
-
-    return my;
+    return vec4(_mm_sub_ps(mReg, other.mReg));
   }
 
   vec4 vec4::operator*(const vec4& other) const {
-    vec4 my = _mm_mul_ps(mReg, other.mReg);
-
-    return my;
+    return vec4(_mm_mul_ps(mReg, other.mReg));
   }
 
   vec4 vec4::operator/(const vec4& other) const {
-    vec4 my = _mm_div_ps(mReg, other.mReg);
-
-    return my;
+    return vec4(_mm_div_ps(mReg, other.mReg));
   }
 
   vec4 vec4::operator+(f32 scalar) const {
-    vec4 my = _mm_add_ps(mReg, _mm_set1_ps(scalar));
-
-    return my;
+    return vec4(_mm_add_ps(mReg, _mm_set1_ps(scalar)));
   }
 
   vec4 vec4::operator-(f32 scalar) const {
-    vec4 my = _mm_sub_ps(mReg, _mm_set1_ps(scalar));
-
-    return my;
+    return vec4(_mm_sub_ps(mReg, _mm_set1_ps(scalar)));
   }
 
   vec4 vec4::operator*(f32 scalar) const {
-    vec4 my = _mm_mul_ps(mReg, _mm_set1_ps(scalar));
-
-    return my;
+    return vec4(_mm_mul_ps(mReg, _mm_set1_ps(scalar)));
   }
 
   vec4 vec4::operator/(f32 scalar) const {
-    vec4 my = _mm_div_ps(mReg, _mm_set1_ps(scalar));
-
-    return my;
+    return vec4(_mm_div_ps(mReg, _mm_set1_ps(scalar)));
   }
 
+  //  Treats this as a row vector: x*row0 + y*row1 + z*row2 + w*row3
   vec4 vec4::operator*(const mat4& mat) const {
-    sseAlign(__m128 result);
-    result = _mm_mul_ps(ws_sseDistributeX(mReg), mat.mReg0);
+    __m128 result = _mm_mul_ps(ws_sseDistributeX(mReg), mat.mReg0);
     result = ws_sseMadd(ws_sseDistributeY(mReg), mat.mReg1, result);
     result = ws_sseMadd(ws_sseDistributeZ(mReg), mat.mReg2, result);
     result = ws_sseMadd(ws_sseDistributeW(mReg), mat.mReg3, result);
 
-    return result;
+    return vec4(result);
   }
 
   vec4& vec4::operator+=(const vec4& other) {
@@ -187,133 +183,77 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
   }
 
   vec4& vec4::operator*=(const mat4& mat) {
-    sseAlign(__m128 result);
-    result = _mm_mul_ps(ws_sseDistributeX(mReg), mat.mReg0);
-    result = ws_sseMadd(ws_sseDistributeY(mReg), mat.mReg1, result);
-    result = ws_sseMadd(ws_sseDistributeZ(mReg), mat.mReg2, result);
-    result = ws_sseMadd(ws_sseDistributeW(mReg), mat.mReg3, result);
-    mReg = result;
+    *this = *this * mat;
 
     return *this;
   }
 
   vec4& vec4::operator=(const vec4& other) {
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
+    mReg = other.mReg;
 
     return *this;
   }
 
-  bool vec4::operator==(const vec4& other) const {
-    return (x == other.x && y == other.y && z == other.z && w == other.w);
-  }
-
-  bool vec4::operator!=(const vec4& other) const {
-    return (x != other.x || y != other.y || z != other.z || w != other.w);
-  }
-
+  //  The w value of this vector is kept
   vec4 vec4::crossProduct(const vec4& other) const {
-    vec4 my = _mm_sub_ps(
-          _mm_mul_ps(_mm_shuffle_ps(mReg, mReg, _MM_SHUFFLE(3, 0, 2, 1)),
-          _mm_shuffle_ps(other.mReg, other.mReg, _MM_SHUFFLE(3, 1, 0, 2))),
-          _mm_mul_ps(_mm_shuffle_ps(mReg, mReg, _MM_SHUFFLE(3, 1, 0, 2)),
-          _mm_shuffle_ps(other.mReg, other.mReg, _MM_SHUFFLE(3, 0, 2, 1)))
-            );
+    __m128 cross = _mm_sub_ps(
+                    _mm_mul_ps(ws_sseShuffle(mReg, 1, 2, 0, 3), ws_sseShuffle(other.mReg, 2, 0, 1, 3)),
+                    _mm_mul_ps(ws_sseShuffle(mReg, 2, 0, 1, 3), ws_sseShuffle(other.mReg, 1, 2, 0, 3)) );
 
-    return my;
+    return vec4(ws_sseKeepW(cross, mReg));
   }
 
   vec4& vec4::toCrossProduct(const vec4& other) {
-    mReg = _mm_sub_ps(
-            _mm_mul_ps(_mm_shuffle_ps(mReg, mReg, _MM_SHUFFLE(3, 0, 2, 1)),
-            _mm_shuffle_ps(other.mReg, other.mReg, _MM_SHUFFLE(3, 1, 0, 2))),
-            _mm_mul_ps(_mm_shuffle_ps(mReg, mReg, _MM_SHUFFLE(3, 1, 0, 2)),
-            _mm_shuffle_ps(other.mReg, other.mReg, _MM_SHUFFLE(3, 0, 2, 1)))
-              );
+    *this = crossProduct(other);
 
     return *this;
   }
 
   vec4 vec4::blend(const vec4& other, f32 blendFactor) {
-    vec4 my( _mm_add_ps(_mm_mul_ps( _mm_set1_ps(1.0f-blendFactor), mReg),
-              _mm_mul_ps( _mm_set1_ps(blendFactor), other.mReg) ) );
-
-    return my;
+    return vec4(_mm_add_ps( _mm_mul_ps(_mm_set1_ps(1.0f-blendFactor), mReg),
+                            _mm_mul_ps(_mm_set1_ps(blendFactor), other.mReg) ));
   }
 
   vec4& vec4::toBlend(const vec4& other, f32 blendFactor) {
-    mReg = _mm_add_ps(  _mm_mul_ps( _mm_set1_ps(1.0f-blendFactor), mReg),
-              _mm_mul_ps( _mm_set1_ps(blendFactor), other.mReg) );
+    mReg = _mm_add_ps( _mm_mul_ps(_mm_set1_ps(1.0f-blendFactor), mReg),
+                        _mm_mul_ps(_mm_set1_ps(blendFactor), other.mReg) );
 
     return *this;
   }
 
-  bool vec4::isZero() const {
-    //return _mm_cmpeq_ps(mReg, _mm_setzero_ps());
-    return (x == 0.0f && y == 0.0f && z == 0.0f); //  Exclude w value
-  }
-
   f32 vec4::dotProduct(const vec4& other) const {
-    f32 my = _mm_cvtss_f32(_mm_dp_ps(mReg, other.mReg, 0x71));
-
-    return my;
+    return _mm_cvtss_f32(ws_sseDot3(mReg, other.mReg));
   }
 
   f32 vec4::magnitude() const {
-    f32 my = _mm_cvtss_f32(_mm_sqrt_ss(_mm_dp_ps(mReg, mReg, 0x71)));
-
-    return my;
+    return _mm_cvtss_f32(_mm_sqrt_ss(ws_sseDot3(mReg, mReg)));
   }
 
   f32 vec4::magnitudeSquared() const {
-    f32 my = _mm_cvtss_f32(_mm_dp_ps(mReg, mReg, 0x71));
-
-    return my;
+    return _mm_cvtss_f32(ws_sseDot3(mReg, mReg));
   }
 
   // Returns the normalized unit vector
   vec4 vec4::normal() const {
-    return vec4(_mm_mul_ps(mReg, _mm_rsqrt_ps(_mm_dp_ps(mReg, mReg, 0x77))));
+    __m128 magSquared = ws_sseDot3(mReg, mReg);
+    if (_mm_cvtss_f32(magSquared) == 0.0f) {
+      return *this;
+    }
+
+    return vec4(_mm_div_ps(mReg, _mm_sqrt_ps(magSquared)));
   }
 
   // Scales the vector to normal length
   vec4& vec4::normalize() {
-    mReg = _mm_mul_ps(mReg, _mm_rsqrt_ps(_mm_dp_ps(mReg, mReg, 0x77)));
-
-    return *this;
-  }
-
-  bool vec4::perpendicular(const vec4& other) const {
-    return (dotProduct(other) == 0.0f);
-  }
-
-  vec4 vec4::getRotate(const quat& quaternion) const {
-    quat vecQuat(mReg);
-    return vec4(quaternion*vecQuat*quaternion.getInverse());
-  }
-
-  vec4& vec4::rotate(const quat& quaternion) {
-    quat vecQuat(x, y, z, w);
-    set(quaternion*vecQuat*quaternion.getInverse());
+    __m128 magSquared = ws_sseDot3(mReg, mReg);
+    if (_mm_cvtss_f32(magSquared) != 0.0f) {
+      mReg = _mm_div_ps(mReg, _mm_sqrt_ps(magSquared));
+    }
 
     return *this;
   }
 
-  bool vec4::isPositional() {
-    return (w == 1.0f);
-  }
-
-  bool vec4::isDirectional() {
-    return (w == 0.0f);
-  }
-
-  void vec4::print(u16 printLog) const {
-    wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
-  }
-
-#else   //  If SSE4 is not supported
+#else   //  If SSE is not supported
 
   //  Set variables
   vec4& vec4::set(f32 myX, f32 myY, f32 myZ, f32 myW) {
@@ -389,11 +329,12 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
     return vec4(x / scalar, y / scalar, z / scalar, w / scalar);
   }
 
+  //  Treats this as a row vector: x*row0 + y*row1 + z*row2 + w*row3
   vec4 vec4::operator*(const mat4& mat) const {
-    return vec4(  dotProduct(mat.getCol(0)),
-            dotProduct(mat.getCol(1)),
-            dotProduct(mat.getCol(2)),
-            dotProduct(mat.getCol(3))  );
+    return vec4(  x*mat.data[0] + y*mat.data[4] + z*mat.data[8] + w*mat.data[12],
+                  x*mat.data[1] + y*mat.data[5] + z*mat.data[9] + w*mat.data[13],
+                  x*mat.data[2] + y*mat.data[6] + z*mat.data[10] + w*mat.data[14],
+                  x*mat.data[3] + y*mat.data[7] + z*mat.data[11] + w*mat.data[15]  );
   }
 
   vec4& vec4::operator+=(const vec4& other) {
@@ -469,10 +410,7 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
   }
 
   vec4& vec4::operator*=(const mat4& mat) {
-    *this =  vec4(  dotProduct(mat.getCol(0)),
-            dotProduct(mat.getCol(1)),
-            dotProduct(mat.getCol(2)),
-            dotProduct(mat.getCol(3))  );
+    *this = *this * mat;
 
     return *this;
   }
@@ -486,14 +424,7 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
     return *this;
   }
 
-  bool vec4::operator==(const vec4& other) const {
-    return (x == other.x && y == other.y && z == other.z && w == other.w);
-  }
-
-  bool vec4::operator!=(const vec4& other) const {
-    return (x != other.x || y != other.y || z != other.z || w != other.w);
-  }
-
+  //  The w value of this vector is kept
   vec4 vec4::crossProduct(const vec4& other) const {
     return vec4(y * other.z - z * other.y, z * other.x - x * other.z,
         x * other.y - y * other.x, w);
@@ -528,14 +459,6 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
     return *this;
   }
 
-  bool vec4::isZero() const {
-    return (x == 0.0f && y == 0.0f && z == 0.0f); //  Exclude w value
-  }
-
-  f32 vec4::distance(const vec4& other) const {
-    return (*this - other).magnitude();
-  }
-
   f32 vec4::dotProduct(const vec4& other) const {
     f32 my(x * other.x + y * other.y + z * other.z);
 
@@ -574,55 +497,72 @@ const vec4 WS_Z_AXIS(0.0f, 0.0f, 1.0f, 1.0f);
     return *this;
   }
 
-  bool vec4::perpendicular(const vec4& other) const {
-    return (dotProduct(other) == 0.0f);
-  }
+#endif  /*  WS_SUPPORTS_SSE  */
 
-  vec4 vec4::getRotate(const quat& quaternion) const {
-    quat vecQuat(x, y, z, 0);
-    vec4 my(quaternion * vecQuat * quaternion.getInverse());
-    my.w = w;
+//  Operations shared by both versions
 
-    return my;
-  }
+bool vec4::operator==(const vec4& other) const {
+  return (x == other.x && y == other.y && z == other.z && w == other.w);
+}
 
-  vec4& vec4::rotate(const quat& quaternion) {
-    f32 tmpW = w;
-    //  Perform rotation
-    quat vecQuat(x, y, z, 0);
-    set(quaternion * vecQuat * quaternion.getInverse());
-    w = tmpW;
+bool vec4::operator!=(const vec4& other) const {
+  return (x != other.x || y != other.y || z != other.z || w != other.w);
+}
 
-    return *this;
-  }
+bool vec4::isZero() const {
+  return (x == 0.0f && y == 0.0f && z == 0.0f); //  Exclude w value
+}
 
-  vec4 vec4::getRotate(const vec4& axis, f32 degrees) const {
-    return getRotate(quat(axis, degrees));
-  }
+f32 vec4::distance(const vec4& other) const {
+  return (*this - other).magnitude();
+}
 
-  vec4& vec4::rotate(const vec4& axis, f32 degrees) {
-    return rotate(quat(axis, degrees));
-  }
+bool vec4::perpendicular(const vec4& other) const {
+  return (dotProduct(other) == 0.0f);
+}
 
-  vec4& vec4::rotatePlane(const vec4& dir, vec4 upDir) { //  Rotates X and Y coordinates to the specified 3d view
-    vec4 vec = dir.crossProduct(upDir) * x; //  adjusts the X value to the normal perpendicular to dir and updir
-    upDir *= y;  //  adjusts the Y value to the upDir normal vector
-    vec += upDir;
-    *this = vec;
-    return *this;   //  Combines the two vectors and returns them.
-  }
+vec4 vec4::getRotate(const quat& quaternion) const {
+  quat vecQuat(x, y, z, 0);
+  vec4 my(quaternion * vecQuat * quaternion.getInverse());
+  my.w = w;
 
-  bool vec4::isPositional() {
-    return (w == 1.0f);
-  }
+  return my;
+}
 
-  bool vec4::isDirectional() {
-    return (w == 0.0f);
-  }
+vec4& vec4::rotate(const quat& quaternion) {
+  f32 tmpW = w;
+  //  Perform rotation
+  quat vecQuat(x, y, z, 0);
+  set(quaternion * vecQuat * quaternion.getInverse());
+  w = tmpW;
 
-  void vec4::print(u16 printLog) const {
-    wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
-  }
+  return *this;
+}
+
+vec4 vec4::getRotate(const vec4& axis, f32 degrees) const {
+  return getRotate(quat(axis, degrees));
+}
+
+vec4& vec4::rotate(const vec4& axis, f32 degrees) {
+  return rotate(quat(axis, degrees));
+}
+
+vec4& vec4::rotatePlane(const vec4& dir, vec4 upDir) { //  Rotates X and Y coordinates to the specified 3d view
+  vec4 vec = dir.crossProduct(upDir) * x; //  adjusts the X value to the normal perpendicular to dir and updir
+  upDir *= y;  //  adjusts the Y value to the upDir normal vector
+  vec += upDir;
+  *this = vec;
+  return *this;   //  Combines the two vectors and returns them.
+}
+
+bool vec4::isPositional() {
+  return (w == 1.0f);
+}
 
-#endif  /*  WS_SUPPORTS_SSE4  */
+bool vec4::isDirectional() {
+  return (w == 0.0f);
+}
 
+void vec4::print(u16 printLog) const {
+  wsEcho(printLog, "{ %f, %f, %f, %f }\n", x, y, z, w);
+}
@@ -13,12 +13,12 @@
  *      have been recommended for inlining to the compiler.
  *
  *      One implementation is provided using standard C operations, the other
- *      utilizing SSE4 on platforms which support it.
+ *      utilizing SSE on platforms which support it.
  *
- *      SSE4 is a version of the SSE (Streaming SIMD Extensions) set, which allows
- *      a single instruction to be performed on multiple data values simultaneously.
- *      The SSE register is 128 bits, allowing four 32-bit data values to be operated on.
- *      In this case, those data values are floating point decimal values.
+ *      SSE (Streaming SIMD Extensions) allows a single instruction to be performed on
+ *      multiple data values simultaneously. The SSE register is 128 bits, allowing four
+ *      32-bit data values to be operated on. In this case, those data values are
+ *      floating point decimal values.
  *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
@@ -53,7 +53,7 @@
 #include <stdio.h>
 
 struct vec4 {
-#if WS_SUPPORTS_SSE4 == WS_TRUE
+#if WS_SUPPORTS_SSE == WS_TRUE
     sseAlign(
         union {
             __m128 mReg;
@@ -77,15 +77,15 @@ struct vec4 {
             };
         }
     );
-    //  Default constructor uses SSE to initialize all values to zero
-    vec4() : mReg(_mm_setzero_ps()) { w = 1.0f; }
+    //  Default constructor sets the origin point
+    vec4() : mReg(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f)) {}
     //  Secondary constructor allows explicit setting of values
     vec4(f32 myX, f32 myY = 0.0f, f32 myZ = 0.0f, f32 myW = 1.0f) :
                     mReg(_mm_set_ps(myW, myZ, myY, myX)) {}
     vec4(const vec4& other) : mReg(other.mReg) {}
     vec4(__m128 reg) : mReg(reg) {}
     vec4(const quat& quaternion) : mReg(quaternion.mReg) {}
-#else   //  if SSE4 is not supported
+#else   //  if SSE is not supported
     union {
         struct { f32 x, y, z, w; };
         struct { f32 r, g, b, a; };
@@ -97,7 +97,7 @@ struct vec4 {
     vec4(const vec4& other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
     vec4(const quat& quaternion) :
                     x(quaternion.x), y(quaternion.y), z(quaternion.z), w(quaternion.w) {}
-#endif  /*  WS_SUPPORTS_SSE4    */
+#endif  /*  WS_SUPPORTS_SSE    */
     //  Set variables
     vec4& set(f32 myX = 0.0f, f32 myY = 0.0f, f32 myZ = 0.0f, f32 myW = 1.0f);
     vec4& set3(const f32 data[], f32 myW = 1.0f);
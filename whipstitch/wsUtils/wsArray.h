@@ -0,0 +1,202 @@
+/*
+ *      wsArray.h
+ *
+ *      This file declares and implements the class wsArray, which is a generic
+ *      (templated) growable array for the Whipstitch Game Engine.
+ *
+ *      A wsArray lives entirely within a single tier of the Primary Stack, chosen
+ *      when the array is created (the current tier by default). When the array runs
+ *      out of room, its capacity is doubled. If the array's storage happens to be the
+ *      most recent allocation on its tier, it is extended in place; otherwise a new
+ *      block is taken from the same tier and the old block is left behind until the
+ *      tier is freed. Reserving a sensible capacity up front keeps that waste small.
+ *
+ *      Element access is a plain pointer offset; the only bounds check is a wsAssert,
+ *      which compiles away in release builds.
+ *
+ *      Usage:
+ *        wsArray<wsModel*>* myModels = wsNew(wsArray<wsModel*>, wsArray<wsModel*>(128));
+ *        myModels->push(myModel);
+ *        for (u32 i = 0; i < myModels->getLength(); ++i) {
+ *          (*myModels)[i]->continueAnimation();
+ *        }
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_ARRAY_H_
+#define WS_ARRAY_H_
+
+#include "wsMemoryStack.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
+template <class ClassType>
+class wsArray {
+  protected:
+    ClassType* array;
+    u32 length;
+    u32 maxElements;
+    wsMemoryStack::_ws_memstack_tier tier;
+    //  Reallocates the array so that it can hold at least minElements
+    void grow(u32 minElements);
+  public:
+    /*  Constructor */
+    wsArray(u32 maxElements = 16,
+            wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
+    /*  Accessors   */
+    ClassType* getArray() { return array; }
+    const ClassType* getArray() const { return array; }
+    u32 getLength() const { return length; }
+    u32 getMaxElements() const { return maxElements; }
+    wsMemoryStack::_ws_memstack_tier getTier() const { return tier; }
+    bool isEmpty() const { return (length == 0); }
+    bool isNotEmpty() const { return (length > 0); }
+    ClassType& operator[](u32 index) {
+      wsAssert((index < length), "wsArray index out of range.");
+      return array[index];
+    }
+    const ClassType& operator[](u32 index) const {
+      wsAssert((index < length), "wsArray index out of range.");
+      return array[index];
+    }
+    ClassType& back() {
+      wsAssert((length > 0), "Cannot retrieve an item from an empty wsArray.");
+      return array[length-1];
+    }
+    /*  Operational Methods */
+    //  Removes all items from the array, keeping its storage
+    void clear();
+    //  Adds the item to the end of the array and returns the new length
+    u32 push(const ClassType& object);
+    u32 push(ClassType&& object);
+    //  Constructs an item in place at the end of the array and returns a reference to it
+    template <class... Args>
+    ClassType& emplace(Args&&... args);
+    //  Removes the last item from the array
+    void pop();
+    //  Removes the item at the given index, preserving the order of the other items
+    void remove(u32 index);
+    //  Ensures the array can hold numElements without reallocating
+    void reserve(u32 numElements);
+};
+
+/*  Member Functions for wsArray  */
+//  Constructor
+template <class ClassType>
+wsArray<ClassType>::wsArray(u32 maxElements, wsMemoryStack::_ws_memstack_tier myTier) {
+  wsAssert((maxElements > 0), "wsArray must have room for more than 0 elements.");
+  this->maxElements = maxElements;
+  tier = myTier;
+  length = 0;
+  array = (ClassType*)wsMem.allocatePrimary(sizeof(ClassType)*maxElements, tier);
+  wsAssert((array != NULL), "Could not allocate wsArray storage.");
+}
+
+template <class ClassType>
+void wsArray<ClassType>::grow(u32 minElements) {
+  u32 newMaxElements = maxElements*2;
+  if (newMaxElements < minElements) { newMaxElements = minElements; }
+  wsEcho(WS_LOG_UTIL, "Growing wsArray from %u to %u elements\n", maxElements, newMaxElements);
+  if (!wsMem.extendPrimary(array, sizeof(ClassType)*maxElements,
+                            sizeof(ClassType)*newMaxElements, tier)) {
+    ClassType* newArray = (ClassType*)wsMem.allocatePrimary(sizeof(ClassType)*newMaxElements, tier);
+    wsAssert((newArray != NULL), "Could not grow wsArray storage.");
+    for (u32 i = 0; i < length; ++i) {
+      new (&newArray[i]) ClassType(std::move(array[i]));
+      array[i].~ClassType();
+    }
+    array = newArray;
+  }
+  maxElements = newMaxElements;
+}
+
+template <class ClassType>
+void wsArray<ClassType>::clear() {
+  for (u32 i = 0; i < length; ++i) {
+    array[i].~ClassType();
+  }
+  length = 0;
+}
+
+template <class ClassType>
+u32 wsArray<ClassType>::push(const ClassType& object) {
+  if (length == maxElements) {
+    //  The object may live inside this array, so copy it before reallocating
+    ClassType tmp(object);
+    grow(length+1);
+    new (&array[length]) ClassType(std::move(tmp));
+  }
+  else {
+    new (&array[length]) ClassType(object);
+  }
+  return ++length;
+}
+
+template <class ClassType>
+u32 wsArray<ClassType>::push(ClassType&& object) {
+  if (length == maxElements) {
+    ClassType tmp(std::move(object));
+    grow(length+1);
+    new (&array[length]) ClassType(std::move(tmp));
+  }
+  else {
+    new (&array[length]) ClassType(std::move(object));
+  }
+  return ++length;
+}
+
+template <class ClassType>
+template <class... Args>
+ClassType& wsArray<ClassType>::emplace(Args&&... args) {
+  if (length == maxElements) {
+    grow(length+1);
+  }
+  new (&array[length]) ClassType(std::forward<Args>(args)...);
+  return array[length++];
+}
+
+template <class ClassType>
+void wsArray<ClassType>::pop() {
+  if (length == 0) { return; }
+  array[--length].~ClassType();
+}
+
+template <class ClassType>
+void wsArray<ClassType>::remove(u32 index) {
+  wsAssert((index < length), "wsArray index out of range.");
+  for (u32 i = index; i+1 < length; ++i) {
+    array[i] = std::move(array[i+1]);
+  }
+  array[--length].~ClassType();
+}
+
+template <class ClassType>
+void wsArray<ClassType>::reserve(u32 numElements) {
+  if (numElements > maxElements) {
+    grow(numElements);
+  }
+}
+
+#endif  /*  WS_ARRAY_H_ */
@@ -0,0 +1,195 @@
+/*
+ * wsAssetManifest.cpp
+ *
+ *    This file implements the class wsAssetManifest and the manifest writer.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsAssetManifest.h"
+#include "wsLog.h"
+#include "wsMappedFile.h"
+#include "wsOperations.h"
+#include "wsPakFile.h"
+#include "wsTokenizer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Longest word the manifest holds: a hash in hexadecimal
+#define WS_MANIFEST_MAX_WORD 32
+
+static i32 wsCompareAssets(const void* a, const void* b) {
+  const wsManifestAsset* assetA = (const wsManifestAsset*)a;
+  const wsManifestAsset* assetB = (const wsManifestAsset*)b;
+  if (assetA->sourceHash != assetB->sourceHash) {
+    return (assetA->sourceHash < assetB->sourceHash) ? -1 : 1;
+  }
+  return strcmp(assetA->source, assetB->source);
+}
+
+static bool wsReadHash(wsTokenizer* tok, u64* dest) {
+  char word[WS_MANIFEST_MAX_WORD];
+  if (!tok->readWord(word, WS_MANIFEST_MAX_WORD)) { return false; }
+  char* end;
+  *dest = (u64)strtoull(word, &end, 16);
+  return (*end == '\0');
+}
+
+//  Reads the size and last write time of a source
+static bool wsReadStamp(wsTokenizer* tok, u64* size, i64* time) {
+  char word[WS_MANIFEST_MAX_WORD];
+  char* end;
+  *size = 0;
+  *time = 0;
+  if (!tok->readWord(word, WS_MANIFEST_MAX_WORD)) { return false; }
+  *size = (u64)strtoull(word, &end, 10);
+  if (*end != '\0' || !tok->readWord(word, WS_MANIFEST_MAX_WORD)) { return false; }
+  *time = (i64)strtoll(word, &end, 10);
+  return (*end == '\0');
+}
+
+//  Reads the rest of the line into the string block, returning its start
+static const char* wsReadPath(wsTokenizer* tok, char** strings, const char* stringsEnd) {
+  const u32 size = (u32)(stringsEnd - *strings);
+  char* path = *strings;
+  if (!tok->readLine(path, size)) { return WS_NULL; }
+  *strings += strlen(path) + 1;
+  return path;
+}
+
+bool wsAssetManifest::open(const char* filepath) {
+  close();
+  wsMappedFile file;
+  if (!file.open(filepath)) { return false; }
+  wsTokenizer tok(file.getData(), file.getEnd());
+  u32 versionNumber = 0;
+  tok.expect("versionNumber"); tok.readU32(versionNumber);
+  if (tok.hasFailed() || versionNumber != WS_MANIFEST_VERSION) {
+    wsEcho(WS_LOG_ERROR, "\"%s\" is not a manifest of version %u", filepath, WS_MANIFEST_VERSION);
+    return false;
+  }
+  u32 myNumAssets = 0;
+  tok.expect("numAssets"); tok.readU32(myNumAssets);
+  //  Every path is followed in the file by at least one byte, which becomes its terminator
+  strings = (char*)malloc(file.getSize() + 1);
+  assets = (wsManifestAsset*)malloc(sizeof(wsManifestAsset)*(myNumAssets ? myNumAssets : 1));
+  wsAssert(strings && assets, "Could not allocate the manifest.");
+  char* nextString = strings;
+  const char* stringsEnd = strings + file.getSize() + 1;
+  //  Uses are counted as they are read, and pointed to once all are in place
+  u32 numUses = 0, maxUses = 0;
+  u32* firstUses = (u32*)malloc(sizeof(u32)*(myNumAssets ? myNumAssets : 1));
+  wsAssert(firstUses, "Could not allocate the manifest.");
+  for (u32 a = 0; a < myNumAssets && !tok.hasFailed(); ++a) {
+    wsManifestAsset& asset = assets[a];
+    tok.expect("asset {");
+    tok.expect("source "); asset.source = wsReadPath(&tok, &nextString, stringsEnd);
+    tok.expect("stamp"); wsReadStamp(&tok, &asset.sourceSize, &asset.sourceTime);
+    tok.expect("key"); wsReadHash(&tok, &asset.key);
+    tok.expect("cooked"); wsReadHash(&tok, &asset.cookedHash);
+    tok.skipWhitespace(); asset.cooked = wsReadPath(&tok, &nextString, stringsEnd);
+    firstUses[a] = numUses;
+    asset.numUses = 0;
+    while (!tok.hasFailed() && (tok.lookingAt("uses ") || tok.lookingAt("usesLinear "))) {
+      const bool linear = tok.lookingAt("usesLinear ");
+      tok.expect(linear ? "usesLinear " : "uses ");
+      if (numUses == maxUses) {
+        maxUses = maxUses ? maxUses*2 : myNumAssets;
+        uses = (wsManifestUse*)realloc(uses, sizeof(wsManifestUse)*maxUses);
+        wsAssert(uses, "Could not allocate the manifest.");
+      }
+      uses[numUses].linear = linear;
+      uses[numUses].path = wsReadPath(&tok, &nextString, stringsEnd);
+      ++numUses;
+      ++asset.numUses;
+    }
+    tok.expect("}");
+    if (!tok.hasFailed()) { asset.sourceHash = wsHash(asset.source); }
+  }
+  if (tok.hasFailed()) {
+    wsEcho(WS_LOG_ERROR, "The manifest \"%s\" is corrupt", filepath);
+    free(firstUses);
+    close();
+    return false;
+  }
+  for (u32 a = 0; a < myNumAssets; ++a) {
+    assets[a].uses = (assets[a].numUses > 0) ? &uses[firstUses[a]] : WS_NULL;
+  }
+  free(firstUses);
+  numAssets = myNumAssets;
+  qsort(assets, numAssets, sizeof(wsManifestAsset), wsCompareAssets);
+  return true;
+}
+
+void wsAssetManifest::close() {
+  free(assets);
+  free(uses);
+  free(strings);
+  assets = WS_NULL;
+  uses = WS_NULL;
+  strings = WS_NULL;
+  numAssets = 0;
+}
+
+const wsManifestAsset* wsAssetManifest::find(const char* source) const {
+  //  Paths are kept as packs keep them
+  source = wsPakPath(source);
+  const u32 sourceHash = wsHash(source);
+  u32 low = 0, high = numAssets;
+  while (low < high) {
+    const u32 mid = low + (high - low)/2;
+    if (assets[mid].sourceHash < sourceHash) { low = mid + 1; }
+    else { high = mid; }
+  }
+  for (; low < numAssets && assets[low].sourceHash == sourceHash; ++low) {
+    if (strcmp(assets[low].source, source) == 0) { return &assets[low]; }
+  }
+  return WS_NULL;
+}
+
+bool wsWriteManifest(const char* destPath, const wsManifestAsset* assets, u32 numAssets) {
+  FILE* pFile = fopen(destPath, "wb");
+  if (pFile == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Could not open \"%s\" for writing", destPath);
+    return false;
+  }
+  fprintf(pFile, "versionNumber %u\nnumAssets %u\n", WS_MANIFEST_VERSION, numAssets);
+  for (u32 a = 0; a < numAssets; ++a) {
+    const wsManifestAsset& asset = assets[a];
+    fprintf(pFile, "asset {\n  source %s\n  stamp %" PRIu64 " %" PRId64 "\n  key %016" PRIx64 "\n  cooked %016" PRIx64
+            " %s\n", wsPakPath(asset.source), asset.sourceSize, asset.sourceTime, asset.key, asset.cookedHash,
+            wsPakPath(asset.cooked));
+    for (u32 u = 0; u < asset.numUses; ++u) {
+      fprintf(pFile, "  %s %s\n", asset.uses[u].linear ? "usesLinear" : "uses", wsPakPath(asset.uses[u].path));
+    }
+    fprintf(pFile, "}\n");
+  }
+  if (fclose(pFile) != 0) {
+    wsEcho(WS_LOG_ERROR, "Could not write the manifest \"%s\"", destPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,107 @@
+/*
+ * wsAssetManifest.h
+ *
+ *    This file declares the class wsAssetManifest, the record assetCooker keeps of
+ *    every source asset it has seen and the runtime file cooked from it. The engine
+ *    reads it to find cooked files without checking the disk; the cooker reads it back
+ *    to cook only the assets whose inputs have changed.
+ *
+ *    Each asset carries a key, the 64-bit hash of everything its cooked file was made
+ *    from: its contents and the options it was cooked with. It also records the hash
+ *    of the cooked file itself, and the files it uses, such as the texture maps of a
+ *    mesh; a map used as a normal map is marked linear.
+ *
+ *    The size and last write time of the source when it was cooked are kept too, so
+ *    the engine can tell a cooked file its loose source has since changed under.
+ *
+ *    The manifest is a text file, written in the style of the other engine formats:
+ *      versionNumber 2
+ *      numAssets 2
+ *      asset {
+ *        source models/box.wsMesh
+ *        stamp 48213 1381790112
+ *        key 8d1f00c4a09b3e27
+ *        cooked 8d1f00c4a09b3e27 models/box.wsMesh
+ *        uses textures/box.png
+ *        usesLinear textures/box_n.png
+ *      }
+ *      asset {
+ *        source textures/box.png
+ *        ...
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_ASSET_MANIFEST_H_
+#define WS_ASSET_MANIFEST_H_
+
+#include "wsPlatform.h"
+
+#define WS_MANIFEST_VERSION 2
+#define WS_MANIFEST_EXTENSION ".wsManifest"
+
+//  A file an asset uses
+struct wsManifestUse {
+  const char* path;
+  bool linear;  //  Used as linear data, such as a normal map
+};
+
+struct wsManifestAsset {
+  u64 key;          //  Hash of everything the cooked file was made from
+  u64 cookedHash;   //  wsHashBuffer64(...) of the cooked file
+  u64 sourceSize;   //  Size of the source when it was cooked
+  i64 sourceTime;   //  Its last write time then, in seconds since the epoch
+  const char* source;
+  const char* cooked; //  The same path as source for files used as they are
+  const wsManifestUse* uses;
+  u32 numUses;
+  u32 sourceHash;   //  wsHash(...) of the source path; assets are sorted by it
+};
+
+class wsAssetManifest {
+  private:
+    wsManifestAsset* assets;
+    wsManifestUse* uses;
+    char* strings;
+    u32 numAssets;
+    //  Not copyable; the manifest owns its strings
+    wsAssetManifest(const wsAssetManifest&);
+    wsAssetManifest& operator=(const wsAssetManifest&);
+  public:
+    wsAssetManifest() : assets(WS_NULL), uses(WS_NULL), strings(WS_NULL), numAssets(0) {}
+    ~wsAssetManifest() { close(); }
+    //  Returns false, leaving the manifest empty, if it cannot be read
+    bool open(const char* filepath);
+    void close();
+    //  Returns the record of a source asset, or WS_NULL if the manifest does not hold it
+    const wsManifestAsset* find(const char* source) const;
+    const wsManifestAsset& getAsset(u32 index) const { return assets[index]; }
+    u32 getNumAssets() const { return numAssets; }
+    bool isOpen() const { return (strings != WS_NULL); }
+};
+
+//  Writes a manifest of the given assets, in the order given
+bool wsWriteManifest(const char* destPath, const wsManifestAsset* assets, u32 numAssets);
+
+#endif /* WS_ASSET_MANIFEST_H_ */
@@ -0,0 +1,653 @@
+/*
+ * wsBatchMath.cpp
+ *
+ *    This file implements the batch math kernels for the Whipstitch Game Engine.
+ *
+ *    Each kernel has a scalar version, which also finishes whatever elements remain
+ *    after the wide versions have processed every full group of four or eight. The
+ *    scalar versions follow the formulas of the matching vec4, mat4 and quat
+ *    operations, so the results agree with them to within rounding.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsBatchMath.h"
+#include <math.h>
+
+/*  Scalar Kernels  */
+void wsBatchTransformPoints_scalar( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                    const mat4& mat, u32 count) {
+  const f32* m = mat.data;
+  for (u32 i = 0; i < count; ++i) {
+    f32 x = src.x[i], y = src.y[i], z = src.z[i];
+    dest.x[i] = x*m[0] + y*m[4] + z*m[8] + m[12];
+    dest.y[i] = x*m[1] + y*m[5] + z*m[9] + m[13];
+    dest.z[i] = x*m[2] + y*m[6] + z*m[10] + m[14];
+  }
+}
+
+void wsBatchTransformDirections_scalar( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                        const mat4& mat, u32 count) {
+  const f32* m = mat.data;
+  for (u32 i = 0; i < count; ++i) {
+    f32 x = src.x[i], y = src.y[i], z = src.z[i];
+    dest.x[i] = x*m[0] + y*m[4] + z*m[8];
+    dest.y[i] = x*m[1] + y*m[5] + z*m[9];
+    dest.z[i] = x*m[2] + y*m[6] + z*m[10];
+  }
+}
+
+void wsBatchMultiplyQuats_scalar( const wsQuatStream& dest, const wsQuatStream& a,
+                                  const wsQuatStream& b, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    f32 ax = a.x[i], ay = a.y[i], az = a.z[i], aw = a.w[i];
+    f32 bx = b.x[i], by = b.y[i], bz = b.z[i], bw = b.w[i];
+    dest.x[i] = aw*bx + ax*bw + ay*bz - az*by;
+    dest.y[i] = aw*by - ax*bz + ay*bw + az*bx;
+    dest.z[i] = aw*bz + ax*by - ay*bx + az*bw;
+    dest.w[i] = aw*bw - ax*bx - ay*by - az*bz;
+  }
+}
+
+void wsBatchNormalizeQuats_scalar(const wsQuatStream& dest, const wsQuatStream& src, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    f32 x = src.x[i], y = src.y[i], z = src.z[i], w = src.w[i];
+    f32 magSquared = x*x + y*y + z*z + w*w;
+    if (magSquared != 0.0f) {
+      f32 invMag = 1.0f / sqrtf(magSquared);
+      x *= invMag;
+      y *= invMag;
+      z *= invMag;
+      w *= invMag;
+    }
+    dest.x[i] = x;
+    dest.y[i] = y;
+    dest.z[i] = z;
+    dest.w[i] = w;
+  }
+}
+
+//  For a unit quaternion (u, w), q*v*q' = v + w*t + u x t, where t = 2(u x v)
+void wsBatchRotateVectors_scalar( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                  const wsQuatStream& rotations, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    f32 qx = rotations.x[i], qy = rotations.y[i], qz = rotations.z[i], qw = rotations.w[i];
+    f32 vx = src.x[i], vy = src.y[i], vz = src.z[i];
+    f32 tx = 2.0f*(qy*vz - qz*vy);
+    f32 ty = 2.0f*(qz*vx - qx*vz);
+    f32 tz = 2.0f*(qx*vy - qy*vx);
+    dest.x[i] = vx + qw*tx + (qy*tz - qz*ty);
+    dest.y[i] = vy + qw*ty + (qz*tx - qx*tz);
+    dest.z[i] = vz + qw*tz + (qx*ty - qy*tx);
+  }
+}
+
+void wsBatchBlendVec3_scalar( const wsVec3Stream& dest, const wsVec3Stream& a, const wsVec3Stream& b,
+                              const f32* blendFactors, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    f32 t = blendFactors[i];
+    dest.x[i] = (1.0f-t)*a.x[i] + t*b.x[i];
+    dest.y[i] = (1.0f-t)*a.y[i] + t*b.y[i];
+    dest.z[i] = (1.0f-t)*a.z[i] + t*b.z[i];
+  }
+}
+
+void wsBatchBlendQuats_scalar(const wsQuatStream& dest, const wsQuatStream& a, const wsQuatStream& b,
+                              const f32* blendFactors, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    quat my = quat(a.x[i], a.y[i], a.z[i], a.w[i]).blend(quat(b.x[i], b.y[i], b.z[i], b.w[i]), blendFactors[i]);
+    dest.x[i] = my.x;
+    dest.y[i] = my.y;
+    dest.z[i] = my.z;
+    dest.w[i] = my.w;
+  }
+}
+
+void wsBatchSinCos_scalar(f32* destSin, f32* destCos, const f32* degrees, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    wsSinCos(degrees[i], &destSin[i], &destCos[i]);
+  }
+}
+//  The rotation matrix is the one mat4::setRotation(...) builds. The new extents
+//  are the old ones projected onto each world axis through that matrix.
+void wsBatchComputeAABBs_scalar(const wsVec3Stream& destCenters, const wsVec3Stream& destExtents,
+                                const wsVec3Stream& centers, const wsVec3Stream& extents,
+                                const wsTransformStream& transforms, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    f32 qx = transforms.rotation.x[i], qy = transforms.rotation.y[i];
+    f32 qz = transforms.rotation.z[i], qw = transforms.rotation.w[i];
+    f32 scale = transforms.scale[i];
+    f32 r00 = 1.0f - 2.0f*(qy*qy + qz*qz);
+    f32 r01 = 2.0f*(qx*qy - qz*qw);
+    f32 r02 = 2.0f*(qx*qz + qy*qw);
+    f32 r10 = 2.0f*(qx*qy + qz*qw);
+    f32 r11 = 1.0f - 2.0f*(qx*qx + qz*qz);
+    f32 r12 = 2.0f*(qy*qz - qx*qw);
+    f32 r20 = 2.0f*(qx*qz - qy*qw);
+    f32 r21 = 2.0f*(qy*qz + qx*qw);
+    f32 r22 = 1.0f - 2.0f*(qx*qx + qy*qy);
+    f32 cx = centers.x[i], cy = centers.y[i], cz = centers.z[i];
+    f32 ex = extents.x[i], ey = extents.y[i], ez = extents.z[i];
+    f32 absScale = fabsf(scale);
+    destCenters.x[i] = scale*(r00*cx + r01*cy + r02*cz) + transforms.translation.x[i];
+    destCenters.y[i] = scale*(r10*cx + r11*cy + r12*cz) + transforms.translation.y[i];
+    destCenters.z[i] = scale*(r20*cx + r21*cy + r22*cz) + transforms.translation.z[i];
+    destExtents.x[i] = absScale*(fabsf(r00)*ex + fabsf(r01)*ey + fabsf(r02)*ez);
+    destExtents.y[i] = absScale*(fabsf(r10)*ex + fabsf(r11)*ey + fabsf(r12)*ez);
+    destExtents.z[i] = absScale*(fabsf(r20)*ex + fabsf(r21)*ey + fabsf(r22)*ez);
+  }
+}
+
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  /*  SSE2 Kernels; four elements at a time  */
+  #define ws_b4Abs(v) _mm_and_ps((v), _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))
+
+  void wsBatchTransformPoints_sse2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                    const mat4& mat, u32 count) {
+    const f32* m = mat.data;
+    __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+    __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    __m128 m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]), m14 = _mm_set1_ps(m[14]);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(src.x+i), y = _mm_loadu_ps(src.y+i), z = _mm_loadu_ps(src.z+i);
+      _mm_storeu_ps(dest.x+i, ws_sseMadd(x, m0, ws_sseMadd(y, m4, ws_sseMadd(z, m8, m12))));
+      _mm_storeu_ps(dest.y+i, ws_sseMadd(x, m1, ws_sseMadd(y, m5, ws_sseMadd(z, m9, m13))));
+      _mm_storeu_ps(dest.z+i, ws_sseMadd(x, m2, ws_sseMadd(y, m6, ws_sseMadd(z, m10, m14))));
+    }
+    wsBatchTransformPoints_scalar(dest.offset(i), src.offset(i), mat, count-i);
+  }
+
+  void wsBatchTransformDirections_sse2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                        const mat4& mat, u32 count) {
+    const f32* m = mat.data;
+    __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m2 = _mm_set1_ps(m[2]);
+    __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]), m6 = _mm_set1_ps(m[6]);
+    __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m10 = _mm_set1_ps(m[10]);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(src.x+i), y = _mm_loadu_ps(src.y+i), z = _mm_loadu_ps(src.z+i);
+      _mm_storeu_ps(dest.x+i, ws_sseMadd(x, m0, ws_sseMadd(y, m4, _mm_mul_ps(z, m8))));
+      _mm_storeu_ps(dest.y+i, ws_sseMadd(x, m1, ws_sseMadd(y, m5, _mm_mul_ps(z, m9))));
+      _mm_storeu_ps(dest.z+i, ws_sseMadd(x, m2, ws_sseMadd(y, m6, _mm_mul_ps(z, m10))));
+    }
+    wsBatchTransformDirections_scalar(dest.offset(i), src.offset(i), mat, count-i);
+  }
+
+  void wsBatchMultiplyQuats_sse2( const wsQuatStream& dest, const wsQuatStream& a,
+                                  const wsQuatStream& b, u32 count) {
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 ax = _mm_loadu_ps(a.x+i), ay = _mm_loadu_ps(a.y+i);
+      __m128 az = _mm_loadu_ps(a.z+i), aw = _mm_loadu_ps(a.w+i);
+      __m128 bx = _mm_loadu_ps(b.x+i), by = _mm_loadu_ps(b.y+i);
+      __m128 bz = _mm_loadu_ps(b.z+i), bw = _mm_loadu_ps(b.w+i);
+      __m128 x = _mm_sub_ps(ws_sseMadd(aw, bx, ws_sseMadd(ax, bw, _mm_mul_ps(ay, bz))), _mm_mul_ps(az, by));
+      __m128 y = _mm_sub_ps(ws_sseMadd(aw, by, ws_sseMadd(ay, bw, _mm_mul_ps(az, bx))), _mm_mul_ps(ax, bz));
+      __m128 z = _mm_sub_ps(ws_sseMadd(aw, bz, ws_sseMadd(ax, by, _mm_mul_ps(az, bw))), _mm_mul_ps(ay, bx));
+      __m128 w = _mm_sub_ps(_mm_mul_ps(aw, bw),
+                  ws_sseMadd(ax, bx, ws_sseMadd(ay, by, _mm_mul_ps(az, bz))));
+      _mm_storeu_ps(dest.x+i, x);
+      _mm_storeu_ps(dest.y+i, y);
+      _mm_storeu_ps(dest.z+i, z);
+      _mm_storeu_ps(dest.w+i, w);
+    }
+    wsBatchMultiplyQuats_scalar(dest.offset(i), a.offset(i), b.offset(i), count-i);
+  }
+
+  void wsBatchNormalizeQuats_sse2(const wsQuatStream& dest, const wsQuatStream& src, u32 count) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 x = _mm_loadu_ps(src.x+i), y = _mm_loadu_ps(src.y+i);
+      __m128 z = _mm_loadu_ps(src.z+i), w = _mm_loadu_ps(src.w+i);
+      __m128 magSquared = ws_sseMadd(x, x, ws_sseMadd(y, y, ws_sseMadd(z, z, _mm_mul_ps(w, w))));
+      //  Zero-length quaternions are scaled by one
+      __m128 nonZero = _mm_cmpneq_ps(magSquared, zero);
+      __m128 invMag = _mm_div_ps(one, _mm_sqrt_ps(magSquared));
+      invMag = _mm_or_ps(_mm_and_ps(nonZero, invMag), _mm_andnot_ps(nonZero, one));
+      _mm_storeu_ps(dest.x+i, _mm_mul_ps(x, invMag));
+      _mm_storeu_ps(dest.y+i, _mm_mul_ps(y, invMag));
+      _mm_storeu_ps(dest.z+i, _mm_mul_ps(z, invMag));
+      _mm_storeu_ps(dest.w+i, _mm_mul_ps(w, invMag));
+    }
+    wsBatchNormalizeQuats_scalar(dest.offset(i), src.offset(i), count-i);
+  }
+
+  void wsBatchRotateVectors_sse2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                  const wsQuatStream& rotations, u32 count) {
+    __m128 two = _mm_set1_ps(2.0f);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 qx = _mm_loadu_ps(rotations.x+i), qy = _mm_loadu_ps(rotations.y+i);
+      __m128 qz = _mm_loadu_ps(rotations.z+i), qw = _mm_loadu_ps(rotations.w+i);
+      __m128 vx = _mm_loadu_ps(src.x+i), vy = _mm_loadu_ps(src.y+i), vz = _mm_loadu_ps(src.z+i);
+      __m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qy, vz), _mm_mul_ps(qz, vy)));
+      __m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qz, vx), _mm_mul_ps(qx, vz)));
+      __m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(qx, vy), _mm_mul_ps(qy, vx)));
+      _mm_storeu_ps(dest.x+i, _mm_add_ps(ws_sseMadd(qw, tx, vx), _mm_sub_ps(_mm_mul_ps(qy, tz), _mm_mul_ps(qz, ty))));
+      _mm_storeu_ps(dest.y+i, _mm_add_ps(ws_sseMadd(qw, ty, vy), _mm_sub_ps(_mm_mul_ps(qz, tx), _mm_mul_ps(qx, tz))));
+      _mm_storeu_ps(dest.z+i, _mm_add_ps(ws_sseMadd(qw, tz, vz), _mm_sub_ps(_mm_mul_ps(qx, ty), _mm_mul_ps(qy, tx))));
+    }
+    wsBatchRotateVectors_scalar(dest.offset(i), src.offset(i), rotations.offset(i), count-i);
+  }
+
+  void wsBatchBlendVec3_sse2( const wsVec3Stream& dest, const wsVec3Stream& a, const wsVec3Stream& b,
+                              const f32* blendFactors, u32 count) {
+    __m128 one = _mm_set1_ps(1.0f);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 t = _mm_loadu_ps(blendFactors+i);
+      __m128 s = _mm_sub_ps(one, t);
+      _mm_storeu_ps(dest.x+i, ws_sseMadd(s, _mm_loadu_ps(a.x+i), _mm_mul_ps(t, _mm_loadu_ps(b.x+i))));
+      _mm_storeu_ps(dest.y+i, ws_sseMadd(s, _mm_loadu_ps(a.y+i), _mm_mul_ps(t, _mm_loadu_ps(b.y+i))));
+      _mm_storeu_ps(dest.z+i, ws_sseMadd(s, _mm_loadu_ps(a.z+i), _mm_mul_ps(t, _mm_loadu_ps(b.z+i))));
+    }
+    wsBatchBlendVec3_scalar(dest.offset(i), a.offset(i), b.offset(i), blendFactors+i, count-i);
+  }
+
+  //  Each lane makes the same choice between nlerp and slerp that quat::blend(...) does
+  void wsBatchBlendQuats_sse2(const wsQuatStream& dest, const wsQuatStream& a, const wsQuatStream& b,
+                              const f32* blendFactors, u32 count) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    __m128 threshold = _mm_set1_ps(WS_QUAT_NLERP_THRESHOLD);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 t = _mm_loadu_ps(blendFactors+i);
+      __m128 ax = _mm_loadu_ps(a.x+i), ay = _mm_loadu_ps(a.y+i);
+      __m128 az = _mm_loadu_ps(a.z+i), aw = _mm_loadu_ps(a.w+i);
+      __m128 bx = _mm_loadu_ps(b.x+i), by = _mm_loadu_ps(b.y+i);
+      __m128 bz = _mm_loadu_ps(b.z+i), bw = _mm_loadu_ps(b.w+i);
+      __m128 dot = ws_sseMadd(ax, bx, ws_sseMadd(ay, by, ws_sseMadd(az, bz, _mm_mul_ps(aw, bw))));
+      __m128 sign = _mm_and_ps(dot, signMask);
+      __m128 cosAngle = _mm_andnot_ps(signMask, dot);
+      __m128 myWeight = _mm_sub_ps(one, t);
+      __m128 otherWeight = t;
+      __m128 useSlerp = _mm_cmple_ps(cosAngle, threshold);
+      if (_mm_movemask_ps(useSlerp)) {
+        __m128 angle = ws_sseArcCos(cosAngle);
+        __m128 invSinAngle = _mm_div_ps(one, _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(cosAngle, cosAngle))));
+        __m128 mySin, otherSin, unused;
+        ws_sseSinCos(_mm_mul_ps(myWeight, angle), &mySin, &unused);
+        ws_sseSinCos(_mm_mul_ps(t, angle), &otherSin, &unused);
+        myWeight = _mm_or_ps(_mm_and_ps(useSlerp, _mm_mul_ps(mySin, invSinAngle)),
+                             _mm_andnot_ps(useSlerp, myWeight));
+        otherWeight = _mm_or_ps(_mm_and_ps(useSlerp, _mm_mul_ps(otherSin, invSinAngle)),
+                                _mm_andnot_ps(useSlerp, otherWeight));
+      }
+      //  Take the shorter path
+      otherWeight = _mm_xor_ps(otherWeight, sign);
+      __m128 x = ws_sseMadd(myWeight, ax, _mm_mul_ps(otherWeight, bx));
+      __m128 y = ws_sseMadd(myWeight, ay, _mm_mul_ps(otherWeight, by));
+      __m128 z = ws_sseMadd(myWeight, az, _mm_mul_ps(otherWeight, bz));
+      __m128 w = ws_sseMadd(myWeight, aw, _mm_mul_ps(otherWeight, bw));
+      __m128 magSquared = ws_sseMadd(x, x, ws_sseMadd(y, y, ws_sseMadd(z, z, _mm_mul_ps(w, w))));
+      __m128 nonZero = _mm_cmpneq_ps(magSquared, zero);
+      __m128 invMag = _mm_div_ps(one, _mm_sqrt_ps(magSquared));
+      invMag = _mm_or_ps(_mm_and_ps(nonZero, invMag), _mm_andnot_ps(nonZero, one));
+      _mm_storeu_ps(dest.x+i, _mm_mul_ps(x, invMag));
+      _mm_storeu_ps(dest.y+i, _mm_mul_ps(y, invMag));
+      _mm_storeu_ps(dest.z+i, _mm_mul_ps(z, invMag));
+      _mm_storeu_ps(dest.w+i, _mm_mul_ps(w, invMag));
+    }
+    wsBatchBlendQuats_scalar(dest.offset(i), a.offset(i), b.offset(i), blendFactors+i, count-i);
+  }
+
+  void wsBatchSinCos_sse2(f32* destSin, f32* destCos, const f32* degrees, u32 count) {
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 sine, cosine;
+      ws_sseSinCos(_mm_loadu_ps(degrees+i), &sine, &cosine);
+      _mm_storeu_ps(destSin+i, sine);
+      _mm_storeu_ps(destCos+i, cosine);
+    }
+    wsBatchSinCos_scalar(destSin+i, destCos+i, degrees+i, count-i);
+  }
+  void wsBatchComputeAABBs_sse2(const wsVec3Stream& destCenters, const wsVec3Stream& destExtents,
+                                const wsVec3Stream& centers, const wsVec3Stream& extents,
+                                const wsTransformStream& transforms, u32 count) {
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 two = _mm_set1_ps(2.0f);
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 qx = _mm_loadu_ps(transforms.rotation.x+i), qy = _mm_loadu_ps(transforms.rotation.y+i);
+      __m128 qz = _mm_loadu_ps(transforms.rotation.z+i), qw = _mm_loadu_ps(transforms.rotation.w+i);
+      __m128 scale = _mm_loadu_ps(transforms.scale+i);
+      __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+      __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+      __m128 xw = _mm_mul_ps(qx, qw), yw = _mm_mul_ps(qy, qw), zw = _mm_mul_ps(qz, qw);
+      __m128 r00 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+      __m128 r01 = _mm_mul_ps(two, _mm_sub_ps(xy, zw));
+      __m128 r02 = _mm_mul_ps(two, _mm_add_ps(xz, yw));
+      __m128 r10 = _mm_mul_ps(two, _mm_add_ps(xy, zw));
+      __m128 r11 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+      __m128 r12 = _mm_mul_ps(two, _mm_sub_ps(yz, xw));
+      __m128 r20 = _mm_mul_ps(two, _mm_sub_ps(xz, yw));
+      __m128 r21 = _mm_mul_ps(two, _mm_add_ps(yz, xw));
+      __m128 r22 = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+      __m128 cx = _mm_loadu_ps(centers.x+i), cy = _mm_loadu_ps(centers.y+i), cz = _mm_loadu_ps(centers.z+i);
+      __m128 ex = _mm_loadu_ps(extents.x+i), ey = _mm_loadu_ps(extents.y+i), ez = _mm_loadu_ps(extents.z+i);
+      __m128 absScale = ws_b4Abs(scale);
+      __m128 tx = _mm_loadu_ps(transforms.translation.x+i);
+      __m128 ty = _mm_loadu_ps(transforms.translation.y+i);
+      __m128 tz = _mm_loadu_ps(transforms.translation.z+i);
+      _mm_storeu_ps(destCenters.x+i, ws_sseMadd(scale, ws_sseMadd(r00, cx, ws_sseMadd(r01, cy, _mm_mul_ps(r02, cz))), tx));
+      _mm_storeu_ps(destCenters.y+i, ws_sseMadd(scale, ws_sseMadd(r10, cx, ws_sseMadd(r11, cy, _mm_mul_ps(r12, cz))), ty));
+      _mm_storeu_ps(destCenters.z+i, ws_sseMadd(scale, ws_sseMadd(r20, cx, ws_sseMadd(r21, cy, _mm_mul_ps(r22, cz))), tz));
+      _mm_storeu_ps(destExtents.x+i, _mm_mul_ps(absScale, ws_sseMadd(ws_b4Abs(r00), ex,
+                    ws_sseMadd(ws_b4Abs(r01), ey, _mm_mul_ps(ws_b4Abs(r02), ez)))));
+      _mm_storeu_ps(destExtents.y+i, _mm_mul_ps(absScale, ws_sseMadd(ws_b4Abs(r10), ex,
+                    ws_sseMadd(ws_b4Abs(r11), ey, _mm_mul_ps(ws_b4Abs(r12), ez)))));
+      _mm_storeu_ps(destExtents.z+i, _mm_mul_ps(absScale, ws_sseMadd(ws_b4Abs(r20), ex,
+                    ws_sseMadd(ws_b4Abs(r21), ey, _mm_mul_ps(ws_b4Abs(r22), ez)))));
+    }
+    wsBatchComputeAABBs_scalar( destCenters.offset(i), destExtents.offset(i), centers.offset(i),
+                                extents.offset(i), transforms.offset(i), count-i);
+  }
+
+#endif /* WS_SUPPORTS_SSE */
+
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+
+  /*  AVX2 Kernels; eight elements at a time  */
+  #define ws_b8Abs(v) _mm256_and_ps((v), _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)))
+
+  WS_TARGET_AVX2
+  void wsBatchTransformPoints_avx2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                    const mat4& mat, u32 count) {
+    const f32* m = mat.data;
+    __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+    __m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]);
+    __m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]);
+    __m256 m12 = _mm256_set1_ps(m[12]), m13 = _mm256_set1_ps(m[13]), m14 = _mm256_set1_ps(m[14]);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(src.x+i), y = _mm256_loadu_ps(src.y+i), z = _mm256_loadu_ps(src.z+i);
+      _mm256_storeu_ps(dest.x+i, _mm256_fmadd_ps(x, m0, _mm256_fmadd_ps(y, m4, _mm256_fmadd_ps(z, m8, m12))));
+      _mm256_storeu_ps(dest.y+i, _mm256_fmadd_ps(x, m1, _mm256_fmadd_ps(y, m5, _mm256_fmadd_ps(z, m9, m13))));
+      _mm256_storeu_ps(dest.z+i, _mm256_fmadd_ps(x, m2, _mm256_fmadd_ps(y, m6, _mm256_fmadd_ps(z, m10, m14))));
+    }
+    wsBatchTransformPoints_sse2(dest.offset(i), src.offset(i), mat, count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchTransformDirections_avx2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                        const mat4& mat, u32 count) {
+    const f32* m = mat.data;
+    __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+    __m256 m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]), m6 = _mm256_set1_ps(m[6]);
+    __m256 m8 = _mm256_set1_ps(m[8]), m9 = _mm256_set1_ps(m[9]), m10 = _mm256_set1_ps(m[10]);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(src.x+i), y = _mm256_loadu_ps(src.y+i), z = _mm256_loadu_ps(src.z+i);
+      _mm256_storeu_ps(dest.x+i, _mm256_fmadd_ps(x, m0, _mm256_fmadd_ps(y, m4, _mm256_mul_ps(z, m8))));
+      _mm256_storeu_ps(dest.y+i, _mm256_fmadd_ps(x, m1, _mm256_fmadd_ps(y, m5, _mm256_mul_ps(z, m9))));
+      _mm256_storeu_ps(dest.z+i, _mm256_fmadd_ps(x, m2, _mm256_fmadd_ps(y, m6, _mm256_mul_ps(z, m10))));
+    }
+    wsBatchTransformDirections_sse2(dest.offset(i), src.offset(i), mat, count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchMultiplyQuats_avx2( const wsQuatStream& dest, const wsQuatStream& a,
+                                  const wsQuatStream& b, u32 count) {
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 ax = _mm256_loadu_ps(a.x+i), ay = _mm256_loadu_ps(a.y+i);
+      __m256 az = _mm256_loadu_ps(a.z+i), aw = _mm256_loadu_ps(a.w+i);
+      __m256 bx = _mm256_loadu_ps(b.x+i), by = _mm256_loadu_ps(b.y+i);
+      __m256 bz = _mm256_loadu_ps(b.z+i), bw = _mm256_loadu_ps(b.w+i);
+      __m256 x = _mm256_fmsub_ps(aw, bx, _mm256_fmsub_ps(az, by, _mm256_fmadd_ps(ax, bw, _mm256_mul_ps(ay, bz))));
+      __m256 y = _mm256_fmsub_ps(aw, by, _mm256_fmsub_ps(ax, bz, _mm256_fmadd_ps(ay, bw, _mm256_mul_ps(az, bx))));
+      __m256 z = _mm256_fmsub_ps(aw, bz, _mm256_fmsub_ps(ay, bx, _mm256_fmadd_ps(ax, by, _mm256_mul_ps(az, bw))));
+      __m256 w = _mm256_fmsub_ps(aw, bw, _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(az, bz))));
+      _mm256_storeu_ps(dest.x+i, x);
+      _mm256_storeu_ps(dest.y+i, y);
+      _mm256_storeu_ps(dest.z+i, z);
+      _mm256_storeu_ps(dest.w+i, w);
+    }
+    wsBatchMultiplyQuats_sse2(dest.offset(i), a.offset(i), b.offset(i), count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchNormalizeQuats_avx2(const wsQuatStream& dest, const wsQuatStream& src, u32 count) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 x = _mm256_loadu_ps(src.x+i), y = _mm256_loadu_ps(src.y+i);
+      __m256 z = _mm256_loadu_ps(src.z+i), w = _mm256_loadu_ps(src.w+i);
+      __m256 magSquared = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_fmadd_ps(z, z, _mm256_mul_ps(w, w))));
+      __m256 nonZero = _mm256_cmp_ps(magSquared, zero, _CMP_NEQ_UQ);
+      __m256 invMag = _mm256_blendv_ps(one, _mm256_div_ps(one, _mm256_sqrt_ps(magSquared)), nonZero);
+      _mm256_storeu_ps(dest.x+i, _mm256_mul_ps(x, invMag));
+      _mm256_storeu_ps(dest.y+i, _mm256_mul_ps(y, invMag));
+      _mm256_storeu_ps(dest.z+i, _mm256_mul_ps(z, invMag));
+      _mm256_storeu_ps(dest.w+i, _mm256_mul_ps(w, invMag));
+    }
+    wsBatchNormalizeQuats_sse2(dest.offset(i), src.offset(i), count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchRotateVectors_avx2( const wsVec3Stream& dest, const wsVec3Stream& src,
+                                  const wsQuatStream& rotations, u32 count) {
+    __m256 two = _mm256_set1_ps(2.0f);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 qx = _mm256_loadu_ps(rotations.x+i), qy = _mm256_loadu_ps(rotations.y+i);
+      __m256 qz = _mm256_loadu_ps(rotations.z+i), qw = _mm256_loadu_ps(rotations.w+i);
+      __m256 vx = _mm256_loadu_ps(src.x+i), vy = _mm256_loadu_ps(src.y+i), vz = _mm256_loadu_ps(src.z+i);
+      __m256 tx = _mm256_mul_ps(two, _mm256_fmsub_ps(qy, vz, _mm256_mul_ps(qz, vy)));
+      __m256 ty = _mm256_mul_ps(two, _mm256_fmsub_ps(qz, vx, _mm256_mul_ps(qx, vz)));
+      __m256 tz = _mm256_mul_ps(two, _mm256_fmsub_ps(qx, vy, _mm256_mul_ps(qy, vx)));
+      _mm256_storeu_ps(dest.x+i, _mm256_add_ps(_mm256_fmadd_ps(qw, tx, vx), _mm256_fmsub_ps(qy, tz, _mm256_mul_ps(qz, ty))));
+      _mm256_storeu_ps(dest.y+i, _mm256_add_ps(_mm256_fmadd_ps(qw, ty, vy), _mm256_fmsub_ps(qz, tx, _mm256_mul_ps(qx, tz))));
+      _mm256_storeu_ps(dest.z+i, _mm256_add_ps(_mm256_fmadd_ps(qw, tz, vz), _mm256_fmsub_ps(qx, ty, _mm256_mul_ps(qy, tx))));
+    }
+    wsBatchRotateVectors_sse2(dest.offset(i), src.offset(i), rotations.offset(i), count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchBlendVec3_avx2( const wsVec3Stream& dest, const wsVec3Stream& a, const wsVec3Stream& b,
+                              const f32* blendFactors, u32 count) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 t = _mm256_loadu_ps(blendFactors+i);
+      __m256 s = _mm256_sub_ps(one, t);
+      _mm256_storeu_ps(dest.x+i, _mm256_fmadd_ps(s, _mm256_loadu_ps(a.x+i), _mm256_mul_ps(t, _mm256_loadu_ps(b.x+i))));
+      _mm256_storeu_ps(dest.y+i, _mm256_fmadd_ps(s, _mm256_loadu_ps(a.y+i), _mm256_mul_ps(t, _mm256_loadu_ps(b.y+i))));
+      _mm256_storeu_ps(dest.z+i, _mm256_fmadd_ps(s, _mm256_loadu_ps(a.z+i), _mm256_mul_ps(t, _mm256_loadu_ps(b.z+i))));
+    }
+    wsBatchBlendVec3_sse2(dest.offset(i), a.offset(i), b.offset(i), blendFactors+i, count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchBlendQuats_avx2(const wsQuatStream& dest, const wsQuatStream& a, const wsQuatStream& b,
+                              const f32* blendFactors, u32 count) {
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+    __m256 threshold = _mm256_set1_ps(WS_QUAT_NLERP_THRESHOLD);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 t = _mm256_loadu_ps(blendFactors+i);
+      __m256 ax = _mm256_loadu_ps(a.x+i), ay = _mm256_loadu_ps(a.y+i);
+      __m256 az = _mm256_loadu_ps(a.z+i), aw = _mm256_loadu_ps(a.w+i);
+      __m256 bx = _mm256_loadu_ps(b.x+i), by = _mm256_loadu_ps(b.y+i);
+      __m256 bz = _mm256_loadu_ps(b.z+i), bw = _mm256_loadu_ps(b.w+i);
+      __m256 dot = _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_fmadd_ps(az, bz, _mm256_mul_ps(aw, bw))));
+      __m256 sign = _mm256_and_ps(dot, signMask);
+      __m256 cosAngle = _mm256_andnot_ps(signMask, dot);
+      __m256 myWeight = _mm256_sub_ps(one, t);
+      __m256 otherWeight = t;
+      __m256 useSlerp = _mm256_cmp_ps(cosAngle, threshold, _CMP_LE_OQ);
+      if (_mm256_movemask_ps(useSlerp)) {
+        __m256 angle = ws_avxArcCos(cosAngle);
+        __m256 invSinAngle = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_fnmadd_ps(cosAngle, cosAngle, one)));
+        __m256 mySin, otherSin, unused;
+        ws_avxSinCos(_mm256_mul_ps(myWeight, angle), &mySin, &unused);
+        ws_avxSinCos(_mm256_mul_ps(t, angle), &otherSin, &unused);
+        myWeight = _mm256_blendv_ps(myWeight, _mm256_mul_ps(mySin, invSinAngle), useSlerp);
+        otherWeight = _mm256_blendv_ps(otherWeight, _mm256_mul_ps(otherSin, invSinAngle), useSlerp);
+      }
+      otherWeight = _mm256_xor_ps(otherWeight, sign);
+      __m256 x = _mm256_fmadd_ps(myWeight, ax, _mm256_mul_ps(otherWeight, bx));
+      __m256 y = _mm256_fmadd_ps(myWeight, ay, _mm256_mul_ps(otherWeight, by));
+      __m256 z = _mm256_fmadd_ps(myWeight, az, _mm256_mul_ps(otherWeight, bz));
+      __m256 w = _mm256_fmadd_ps(myWeight, aw, _mm256_mul_ps(otherWeight, bw));
+      __m256 magSquared = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_fmadd_ps(z, z, _mm256_mul_ps(w, w))));
+      __m256 nonZero = _mm256_cmp_ps(magSquared, zero, _CMP_NEQ_UQ);
+      __m256 invMag = _mm256_blendv_ps(one, _mm256_div_ps(one, _mm256_sqrt_ps(magSquared)), nonZero);
+      _mm256_storeu_ps(dest.x+i, _mm256_mul_ps(x, invMag));
+      _mm256_storeu_ps(dest.y+i, _mm256_mul_ps(y, invMag));
+      _mm256_storeu_ps(dest.z+i, _mm256_mul_ps(z, invMag));
+      _mm256_storeu_ps(dest.w+i, _mm256_mul_ps(w, invMag));
+    }
+    wsBatchBlendQuats_sse2(dest.offset(i), a.offset(i), b.offset(i), blendFactors+i, count-i);
+  }
+
+  WS_TARGET_AVX2
+  void wsBatchSinCos_avx2(f32* destSin, f32* destCos, const f32* degrees, u32 count) {
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 sine, cosine;
+      ws_avxSinCos(_mm256_loadu_ps(degrees+i), &sine, &cosine);
+      _mm256_storeu_ps(destSin+i, sine);
+      _mm256_storeu_ps(destCos+i, cosine);
+    }
+    wsBatchSinCos_sse2(destSin+i, destCos+i, degrees+i, count-i);
+  }
+  WS_TARGET_AVX2
+  void wsBatchComputeAABBs_avx2(const wsVec3Stream& destCenters, const wsVec3Stream& destExtents,
+                                const wsVec3Stream& centers, const wsVec3Stream& extents,
+                                const wsTransformStream& transforms, u32 count) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 two = _mm256_set1_ps(2.0f);
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 qx = _mm256_loadu_ps(transforms.rotation.x+i), qy = _mm256_loadu_ps(transforms.rotation.y+i);
+      __m256 qz = _mm256_loadu_ps(transforms.rotation.z+i), qw = _mm256_loadu_ps(transforms.rotation.w+i);
+      __m256 scale = _mm256_loadu_ps(transforms.scale+i);
+      __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+      __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+      __m256 xw = _mm256_mul_ps(qx, qw), yw = _mm256_mul_ps(qy, qw), zw = _mm256_mul_ps(qz, qw);
+      __m256 r00 = _mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one);
+      __m256 r01 = _mm256_mul_ps(two, _mm256_sub_ps(xy, zw));
+      __m256 r02 = _mm256_mul_ps(two, _mm256_add_ps(xz, yw));
+      __m256 r10 = _mm256_mul_ps(two, _mm256_add_ps(xy, zw));
+      __m256 r11 = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one);
+      __m256 r12 = _mm256_mul_ps(two, _mm256_sub_ps(yz, xw));
+      __m256 r20 = _mm256_mul_ps(two, _mm256_sub_ps(xz, yw));
+      __m256 r21 = _mm256_mul_ps(two, _mm256_add_ps(yz, xw));
+      __m256 r22 = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one);
+      __m256 cx = _mm256_loadu_ps(centers.x+i), cy = _mm256_loadu_ps(centers.y+i), cz = _mm256_loadu_ps(centers.z+i);
+      __m256 ex = _mm256_loadu_ps(extents.x+i), ey = _mm256_loadu_ps(extents.y+i), ez = _mm256_loadu_ps(extents.z+i);
+      __m256 absScale = ws_b8Abs(scale);
+      __m256 tx = _mm256_loadu_ps(transforms.translation.x+i);
+      __m256 ty = _mm256_loadu_ps(transforms.translation.y+i);
+      __m256 tz = _mm256_loadu_ps(transforms.translation.z+i);
+      _mm256_storeu_ps(destCenters.x+i, _mm256_fmadd_ps(scale,
+                        _mm256_fmadd_ps(r00, cx, _mm256_fmadd_ps(r01, cy, _mm256_mul_ps(r02, cz))), tx));
+      _mm256_storeu_ps(destCenters.y+i, _mm256_fmadd_ps(scale,
+                        _mm256_fmadd_ps(r10, cx, _mm256_fmadd_ps(r11, cy, _mm256_mul_ps(r12, cz))), ty));
+      _mm256_storeu_ps(destCenters.z+i, _mm256_fmadd_ps(scale,
+                        _mm256_fmadd_ps(r20, cx, _mm256_fmadd_ps(r21, cy, _mm256_mul_ps(r22, cz))), tz));
+      _mm256_storeu_ps(destExtents.x+i, _mm256_mul_ps(absScale, _mm256_fmadd_ps(ws_b8Abs(r00), ex,
+                        _mm256_fmadd_ps(ws_b8Abs(r01), ey, _mm256_mul_ps(ws_b8Abs(r02), ez)))));
+      _mm256_storeu_ps(destExtents.y+i, _mm256_mul_ps(absScale, _mm256_fmadd_ps(ws_b8Abs(r10), ex,
+                        _mm256_fmadd_ps(ws_b8Abs(r11), ey, _mm256_mul_ps(ws_b8Abs(r12), ez)))));
+      _mm256_storeu_ps(destExtents.z+i, _mm256_mul_ps(absScale, _mm256_fmadd_ps(ws_b8Abs(r20), ex,
+                        _mm256_fmadd_ps(ws_b8Abs(r21), ey, _mm256_mul_ps(ws_b8Abs(r22), ez)))));
+    }
+    wsBatchComputeAABBs_sse2( destCenters.offset(i), destExtents.offset(i), centers.offset(i),
+                              extents.offset(i), transforms.offset(i), count-i);
+  }
+
+#endif /* WS_SIMD_AVX2_KERNELS */
+
+void (*wsBatchTransformPoints)(const wsVec3Stream&, const wsVec3Stream&, const mat4&, u32) =
+    wsBatchTransformPoints_scalar;
+void (*wsBatchTransformDirections)(const wsVec3Stream&, const wsVec3Stream&, const mat4&, u32) =
+    wsBatchTransformDirections_scalar;
+void (*wsBatchMultiplyQuats)(const wsQuatStream&, const wsQuatStream&, const wsQuatStream&, u32) =
+    wsBatchMultiplyQuats_scalar;
+void (*wsBatchNormalizeQuats)(const wsQuatStream&, const wsQuatStream&, u32) =
+    wsBatchNormalizeQuats_scalar;
+void (*wsBatchRotateVectors)(const wsVec3Stream&, const wsVec3Stream&, const wsQuatStream&, u32) =
+    wsBatchRotateVectors_scalar;
+void (*wsBatchBlendVec3)(const wsVec3Stream&, const wsVec3Stream&, const wsVec3Stream&, const f32*, u32) =
+    wsBatchBlendVec3_scalar;
+void (*wsBatchBlendQuats)(const wsQuatStream&, const wsQuatStream&, const wsQuatStream&, const f32*, u32) =
+    wsBatchBlendQuats_scalar;
+void (*wsBatchSinCos)(f32*, f32*, const f32*, u32) = wsBatchSinCos_scalar;
+void (*wsBatchComputeAABBs)(const wsVec3Stream&, const wsVec3Stream&, const wsVec3Stream&,
+                            const wsVec3Stream&, const wsTransformStream&, u32) =
+    wsBatchComputeAABBs_scalar;
+
+void wsSetBatchMathLevel(wsSIMDLevel level) {
+  switch (level) {
+    #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+      case WS_SIMD_AVX2:
+        wsBatchTransformPoints = wsBatchTransformPoints_avx2;
+        wsBatchTransformDirections = wsBatchTransformDirections_avx2;
+        wsBatchMultiplyQuats = wsBatchMultiplyQuats_avx2;
+        wsBatchNormalizeQuats = wsBatchNormalizeQuats_avx2;
+        wsBatchRotateVectors = wsBatchRotateVectors_avx2;
+        wsBatchBlendVec3 = wsBatchBlendVec3_avx2;
+        wsBatchBlendQuats = wsBatchBlendQuats_avx2;
+        wsBatchSinCos = wsBatchSinCos_avx2;
+        wsBatchComputeAABBs = wsBatchComputeAABBs_avx2;
+        break;
+    #endif
+    #if WS_SUPPORTS_SSE == WS_TRUE
+      case WS_SIMD_SSE2:
+        wsBatchTransformPoints = wsBatchTransformPoints_sse2;
+        wsBatchTransformDirections = wsBatchTransformDirections_sse2;
+        wsBatchMultiplyQuats = wsBatchMultiplyQuats_sse2;
+        wsBatchNormalizeQuats = wsBatchNormalizeQuats_sse2;
+        wsBatchRotateVectors = wsBatchRotateVectors_sse2;
+        wsBatchBlendVec3 = wsBatchBlendVec3_sse2;
+        wsBatchBlendQuats = wsBatchBlendQuats_sse2;
+        wsBatchSinCos = wsBatchSinCos_sse2;
+        wsBatchComputeAABBs = wsBatchComputeAABBs_sse2;
+        break;
+    #endif
+    default:
+      wsBatchTransformPoints = wsBatchTransformPoints_scalar;
+      wsBatchTransformDirections = wsBatchTransformDirections_scalar;
+      wsBatchMultiplyQuats = wsBatchMultiplyQuats_scalar;
+      wsBatchNormalizeQuats = wsBatchNormalizeQuats_scalar;
+      wsBatchRotateVectors = wsBatchRotateVectors_scalar;
+      wsBatchBlendVec3 = wsBatchBlendVec3_scalar;
+      wsBatchBlendQuats = wsBatchBlendQuats_scalar;
+      wsBatchSinCos = wsBatchSinCos_scalar;
+      wsBatchComputeAABBs = wsBatchComputeAABBs_scalar;
+      break;
+  }
+}
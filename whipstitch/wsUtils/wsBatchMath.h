@@ -0,0 +1,125 @@
+/*
+ * wsBatchMath.h
+ *
+ *    This file declares the batch math kernels for the Whipstitch Game Engine.
+ *
+ *    vec4, mat4 and quat operate on one value at a time. The kernels here operate on
+ *    many values at once, stored as structure-of-arrays streams: one array for every
+ *    x, another for every y, and so on. Laid out this way, four (SSE2) or eight (AVX2)
+ *    elements are processed by each instruction, and any elements left over are
+ *    finished by the scalar version.
+ *
+ *    Like the array kernels in wsSIMD.h, each kernel is a function pointer which is
+ *    pointed at the best version for the processor by wsDetectSIMD(). The output
+ *    stream may be the same as an input stream.
+ *
+ *    Usage:
+ *      wsVec3Stream points = { posX, posY, posZ };
+ *      wsBatchTransformPoints(points, points, model->getTransform().toMatrix(), numPoints);
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_BATCH_MATH_H_
+#define WS_BATCH_MATH_H_
+
+#include "wsTransform.h"
+#include "wsSIMD.h"
+
+//  Three parallel arrays of floats, one per component
+struct wsVec3Stream {
+  f32* x;
+  f32* y;
+  f32* z;
+  //  Returns the stream beginning at the given element
+  wsVec3Stream offset(u32 index) const {
+    wsVec3Stream my = { x+index, y+index, z+index };
+    return my;
+  }
+};
+
+//  Four parallel arrays of floats, one per quaternion component
+struct wsQuatStream {
+  f32* x;
+  f32* y;
+  f32* z;
+  f32* w;
+  wsQuatStream offset(u32 index) const {
+    wsQuatStream my = { x+index, y+index, z+index, w+index };
+    return my;
+  }
+};
+
+//  The components of many SQT transforms (see wsTransform)
+struct wsTransformStream {
+  wsQuatStream rotation;
+  wsVec3Stream translation;
+  f32* scale;
+  wsTransformStream offset(u32 index) const {
+    wsTransformStream my = { rotation.offset(index), translation.offset(index), scale+index };
+    return my;
+  }
+};
+
+//  Selects the kernels for the given level; called by wsSetSIMDLevel(...)
+void wsSetBatchMathLevel(wsSIMDLevel level);
+
+/*  Batch Kernels */
+//  dest[i] = src[i] * mat, treating each point as a row vector with w = 1
+extern void (*wsBatchTransformPoints)(const wsVec3Stream& dest, const wsVec3Stream& src,
+                                      const mat4& mat, u32 count);
+//  dest[i] = src[i] * mat with w = 0, so translation is ignored. Normals should be
+//  given the inverse transpose of the matrix used for their points, unless it has
+//  only rotation and uniform scale.
+extern void (*wsBatchTransformDirections)(const wsVec3Stream& dest, const wsVec3Stream& src,
+                                          const mat4& mat, u32 count);
+//  dest[i] = a[i] * b[i]
+extern void (*wsBatchMultiplyQuats)(const wsQuatStream& dest, const wsQuatStream& a,
+                                    const wsQuatStream& b, u32 count);
+//  dest[i] = src[i].normal(); zero-length quaternions are copied unchanged
+extern void (*wsBatchNormalizeQuats)(const wsQuatStream& dest, const wsQuatStream& src, u32 count);
+//  dest[i] = src[i] rotated by the unit quaternion rotations[i], as vec4::rotate(...)
+extern void (*wsBatchRotateVectors)(const wsVec3Stream& dest, const wsVec3Stream& src,
+                                    const wsQuatStream& rotations, u32 count);
+//  dest[i] = wsLerp(a[i], b[i], blendFactors[i]) per component
+extern void (*wsBatchBlendVec3)(const wsVec3Stream& dest, const wsVec3Stream& a,
+                                const wsVec3Stream& b, const f32* blendFactors, u32 count);
+//  dest[i] = a[i].blend(b[i], blendFactors[i]): nlerp for close pairs, slerp otherwise
+extern void (*wsBatchBlendQuats)(const wsQuatStream& dest, const wsQuatStream& a,
+                                 const wsQuatStream& b, const f32* blendFactors, u32 count);
+//  wsSinCos(...) of each angle, in degrees
+extern void (*wsBatchSinCos)(f32* destSin, f32* destCos, const f32* degrees, u32 count);
+//  Moves each local box (center and half-extents) by its transform and returns the
+//  world-space box which encloses it
+extern void (*wsBatchComputeAABBs)( const wsVec3Stream& destCenters, const wsVec3Stream& destExtents,
+                                    const wsVec3Stream& centers, const wsVec3Stream& extents,
+                                    const wsTransformStream& transforms, u32 count);
+
+//  Transforms the points by a single SQT transform
+inline void wsBatchTransformPointsSQT(const wsVec3Stream& dest, const wsVec3Stream& src,
+                                      const wsTransform& transform, u32 count) {
+  wsBatchTransformPoints(dest, src, transform.toMatrix(), count);
+}
+
+#endif /* WS_BATCH_MATH_H_ */
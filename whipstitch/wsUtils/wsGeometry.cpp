@@ -0,0 +1,699 @@
+/*
+ * wsGeometry.cpp
+ *
+ *    This file implements the geometric queries for the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsGeometry.h"
+#include <string.h>
+
+/*  wsFrustum  */
+wsFrustum::wsFrustum(const mat4& viewProjection) {
+  //  A point p is inside when -w <= p*column <= w for the x, y and z columns
+  const f32* m = viewProjection.data;
+  for (u32 axis = 0; axis < 3; ++axis) {
+    planes[axis*2] = vec4(m[3]+m[axis], m[7]+m[4+axis], m[11]+m[8+axis], m[15]+m[12+axis]);
+    planes[axis*2+1] = vec4(m[3]-m[axis], m[7]-m[4+axis], m[11]-m[8+axis], m[15]-m[12+axis]);
+  }
+  normalize();
+}
+
+void wsFrustum::normalize() {
+  for (u32 p = 0; p < 6; ++p) {
+    vec4& plane = planes[p];
+    f32 length = sqrtf(plane.x*plane.x + plane.y*plane.y + plane.z*plane.z);
+    if (length > 0.0f) {
+      plane /= length;
+    }
+  }
+}
+
+/*  Reference Queries
+ *  The batch kernels below repeat these operations in the same order, so that they
+ *  give the same answers. The AVX2 kernels fuse multiplies and adds, which can change
+ *  the last bit of a result, and so the answer for a ray which only grazes a primitive.  */
+bool wsRayIntersectsAABB(const wsRay& ray, const wsAABB& box, f32& distance) {
+  const f32* origin = ray.origin.array();
+  const f32* dir = ray.dir.array();
+  const f32* center = box.center.array();
+  const f32* extents = box.extents.array();
+  f32 nearest = 0.0f;
+  f32 farthest = WS_GEOMETRY_MISS;
+  for (u32 axis = 0; axis < 3; ++axis) {
+    f32 invDir = 1.0f / dir[axis];
+    f32 slabNear = (center[axis] - extents[axis] - origin[axis]) * invDir;
+    f32 slabFar = (center[axis] + extents[axis] - origin[axis]) * invDir;
+    nearest = wsMax(nearest, wsMin(slabNear, slabFar));
+    farthest = wsMin(farthest, wsMax(slabNear, slabFar));
+  }
+  if (nearest <= farthest) {
+    distance = nearest;
+    return true;
+  }
+  distance = WS_GEOMETRY_MISS;
+  return false;
+}
+
+bool wsRayIntersectsSphere(const wsRay& ray, const wsSphere& sphere, f32& distance) {
+  const vec4& dir = ray.dir;
+  f32 toCenterX = sphere.center.x - ray.origin.x;
+  f32 toCenterY = sphere.center.y - ray.origin.y;
+  f32 toCenterZ = sphere.center.z - ray.origin.z;
+  f32 a = dir.x*dir.x + dir.y*dir.y + dir.z*dir.z;
+  f32 b = toCenterX*dir.x + toCenterY*dir.y + toCenterZ*dir.z;
+  f32 c = toCenterX*toCenterX + toCenterY*toCenterY + toCenterZ*toCenterZ - sphere.radius*sphere.radius;
+  f32 discriminant = b*b - a*c;
+  if (discriminant >= 0.0f) {
+    f32 root = sqrtf(discriminant);
+    //  Unless the far side is behind the origin
+    if (b + root >= 0.0f) {
+      distance = wsMax((b - root) / a, 0.0f);
+      return true;
+    }
+  }
+  distance = WS_GEOMETRY_MISS;
+  return false;
+}
+
+//  Moller-Trumbore: solves for the barycentric coordinates (u, v) and distance at once
+bool wsRayIntersectsTriangle( const wsRay& ray, const vec4& vert0, const vec4& vert1,
+                              const vec4& vert2, f32& distance) {
+  const vec4& dir = ray.dir;
+  f32 edge1X = vert1.x - vert0.x, edge1Y = vert1.y - vert0.y, edge1Z = vert1.z - vert0.z;
+  f32 edge2X = vert2.x - vert0.x, edge2Y = vert2.y - vert0.y, edge2Z = vert2.z - vert0.z;
+  f32 pX = dir.y*edge2Z - dir.z*edge2Y;
+  f32 pY = dir.z*edge2X - dir.x*edge2Z;
+  f32 pZ = dir.x*edge2Y - dir.y*edge2X;
+  f32 det = edge1X*pX + edge1Y*pY + edge1Z*pZ;
+  //  A ray parallel to the triangle never hits it
+  if (det != 0.0f) {
+    f32 invDet = 1.0f / det;
+    f32 sX = ray.origin.x - vert0.x, sY = ray.origin.y - vert0.y, sZ = ray.origin.z - vert0.z;
+    f32 u = (sX*pX + sY*pY + sZ*pZ) * invDet;
+    f32 qX = sY*edge1Z - sZ*edge1Y;
+    f32 qY = sZ*edge1X - sX*edge1Z;
+    f32 qZ = sX*edge1Y - sY*edge1X;
+    f32 v = (dir.x*qX + dir.y*qY + dir.z*qZ) * invDet;
+    f32 t = (edge2X*qX + edge2Y*qY + edge2Z*qZ) * invDet;
+    if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f) {
+      distance = t;
+      return true;
+    }
+  }
+  distance = WS_GEOMETRY_MISS;
+  return false;
+}
+
+bool wsFrustumIntersectsAABB(const wsFrustum& frustum, const wsAABB& box) {
+  const vec4& center = box.center;
+  const vec4& extents = box.extents;
+  for (u32 p = 0; p < 6; ++p) {
+    const vec4& plane = frustum.planes[p];
+    f32 dist = plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w;
+    //  How far the box reaches toward the plane's normal
+    f32 reach = fabsf(plane.x)*extents.x + fabsf(plane.y)*extents.y + fabsf(plane.z)*extents.z;
+    if (dist + reach < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool wsFrustumIntersectsSphere(const wsFrustum& frustum, const wsSphere& sphere) {
+  const vec4& center = sphere.center;
+  for (u32 p = 0; p < 6; ++p) {
+    const vec4& plane = frustum.planes[p];
+    f32 dist = plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w;
+    if (dist + sphere.radius < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool wsSphereIntersectsSphere(const wsSphere& a, const wsSphere& b) {
+  f32 diffX = b.center.x - a.center.x;
+  f32 diffY = b.center.y - a.center.y;
+  f32 diffZ = b.center.z - a.center.z;
+  f32 radii = a.radius + b.radius;
+  return (diffX*diffX + diffY*diffY + diffZ*diffZ <= radii*radii);
+}
+
+/*  Scalar Kernels
+ *  Each tests elements [first, count), adding to the hit masks; the kernels clear the
+ *  masks once, then use these for the elements left over by the SIMD versions.  */
+static inline void wsClearHitMasks(u32* hitMasks, u32 count) {
+  memset(hitMasks, 0, WS_HIT_MASK_WORDS(count)*sizeof(u32));
+}
+
+static inline void wsSetHit(u32* hitMasks, u32 index) {
+  hitMasks[index >> 5] |= 1u << (index & 31);
+}
+
+static u32 wsBatchRayAABBsFrom( const wsRay& ray, const wsVec3Stream& centers, const wsVec3Stream& extents,
+                                u32 first, u32 count, u32* hitMasks, f32* distances) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    wsAABB box(vec4(centers.x[i], centers.y[i], centers.z[i]), vec4(extents.x[i], extents.y[i], extents.z[i]));
+    if (wsRayIntersectsAABB(ray, box, distances[i])) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+static u32 wsBatchRaySpheresFrom( const wsRay& ray, const wsVec3Stream& centers, const f32* radii,
+                                  u32 first, u32 count, u32* hitMasks, f32* distances) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    wsSphere sphere(vec4(centers.x[i], centers.y[i], centers.z[i]), radii[i]);
+    if (wsRayIntersectsSphere(ray, sphere, distances[i])) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+static u32 wsBatchRayTrianglesFrom( const wsRay& ray, const wsVec3Stream& verts0, const wsVec3Stream& verts1,
+                                    const wsVec3Stream& verts2, u32 first, u32 count, u32* hitMasks,
+                                    f32* distances) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    if (wsRayIntersectsTriangle(ray, vec4(verts0.x[i], verts0.y[i], verts0.z[i]),
+                                vec4(verts1.x[i], verts1.y[i], verts1.z[i]),
+                                vec4(verts2.x[i], verts2.y[i], verts2.z[i]), distances[i])) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+static u32 wsBatchFrustumAABBsFrom( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                    const wsVec3Stream& extents, u32 first, u32 count, u32* hitMasks) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    wsAABB box(vec4(centers.x[i], centers.y[i], centers.z[i]), vec4(extents.x[i], extents.y[i], extents.z[i]));
+    if (wsFrustumIntersectsAABB(frustum, box)) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+static u32 wsBatchFrustumSpheresFrom( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                      const f32* radii, u32 first, u32 count, u32* hitMasks) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    if (wsFrustumIntersectsSphere(frustum, wsSphere(vec4(centers.x[i], centers.y[i], centers.z[i]), radii[i]))) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+static u32 wsBatchSphereSpheresFrom(const wsSphere& sphere, const wsVec3Stream& centers,
+                                    const f32* radii, u32 first, u32 count, u32* hitMasks) {
+  u32 numHits = 0;
+  for (u32 i = first; i < count; ++i) {
+    if (wsSphereIntersectsSphere(sphere, wsSphere(vec4(centers.x[i], centers.y[i], centers.z[i]), radii[i]))) {
+      wsSetHit(hitMasks, i);
+      ++numHits;
+    }
+  }
+  return numHits;
+}
+
+u32 wsBatchRayAABBs_scalar( const wsRay& ray, const wsVec3Stream& centers, const wsVec3Stream& extents,
+                            u32 count, u32* hitMasks, f32* distances) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchRayAABBsFrom(ray, centers, extents, 0, count, hitMasks, distances);
+}
+
+u32 wsBatchRaySpheres_scalar( const wsRay& ray, const wsVec3Stream& centers, const f32* radii,
+                              u32 count, u32* hitMasks, f32* distances) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchRaySpheresFrom(ray, centers, radii, 0, count, hitMasks, distances);
+}
+
+u32 wsBatchRayTriangles_scalar( const wsRay& ray, const wsVec3Stream& verts0, const wsVec3Stream& verts1,
+                                const wsVec3Stream& verts2, u32 count, u32* hitMasks, f32* distances) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchRayTrianglesFrom(ray, verts0, verts1, verts2, 0, count, hitMasks, distances);
+}
+
+u32 wsBatchFrustumAABBs_scalar( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                const wsVec3Stream& extents, u32 count, u32* hitMasks) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchFrustumAABBsFrom(frustum, centers, extents, 0, count, hitMasks);
+}
+
+u32 wsBatchFrustumSpheres_scalar( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                  const f32* radii, u32 count, u32* hitMasks) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchFrustumSpheresFrom(frustum, centers, radii, 0, count, hitMasks);
+}
+
+u32 wsBatchSphereSpheres_scalar(const wsSphere& sphere, const wsVec3Stream& centers,
+                                const f32* radii, u32 count, u32* hitMasks) {
+  wsClearHitMasks(hitMasks, count);
+  return wsBatchSphereSpheresFrom(sphere, centers, radii, 0, count, hitMasks);
+}
+
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  /*  SSE2 Kernels; four elements at a time  */
+  #define ws_g4Abs(v) _mm_and_ps((v), _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)))
+  //  mask ? a : b
+  #define ws_g4Select(mask, a, b) _mm_or_ps(_mm_and_ps((mask), (a)), _mm_andnot_ps((mask), (b)))
+
+  //  Records the hits of the four elements beginning at index (a multiple of four)
+  static inline u32 ws_g4StoreHits(u32* hitMasks, u32 index, __m128 hit) {
+    u32 bits = (u32)_mm_movemask_ps(hit);
+    hitMasks[index >> 5] |= bits << (index & 31);
+    return __builtin_popcount(bits);
+  }
+
+  u32 wsBatchRayAABBs_sse2( const wsRay& ray, const wsVec3Stream& centers, const wsVec3Stream& extents,
+                            u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    __m128 invX = _mm_set1_ps(1.0f / ray.dir.x);
+    __m128 invY = _mm_set1_ps(1.0f / ray.dir.y);
+    __m128 invZ = _mm_set1_ps(1.0f / ray.dir.z);
+    __m128 miss = _mm_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 cx = _mm_loadu_ps(centers.x+i), cy = _mm_loadu_ps(centers.y+i), cz = _mm_loadu_ps(centers.z+i);
+      __m128 ex = _mm_loadu_ps(extents.x+i), ey = _mm_loadu_ps(extents.y+i), ez = _mm_loadu_ps(extents.z+i);
+      __m128 nearX = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cx, ex), ox), invX);
+      __m128 farX = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cx, ex), ox), invX);
+      __m128 nearY = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cy, ey), oy), invY);
+      __m128 farY = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cy, ey), oy), invY);
+      __m128 nearZ = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cz, ez), oz), invZ);
+      __m128 farZ = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cz, ez), oz), invZ);
+      __m128 nearest = _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(nearX, farX));
+      __m128 farthest = _mm_min_ps(miss, _mm_max_ps(nearX, farX));
+      nearest = _mm_max_ps(nearest, _mm_min_ps(nearY, farY));
+      farthest = _mm_min_ps(farthest, _mm_max_ps(nearY, farY));
+      nearest = _mm_max_ps(nearest, _mm_min_ps(nearZ, farZ));
+      farthest = _mm_min_ps(farthest, _mm_max_ps(nearZ, farZ));
+      __m128 hit = _mm_cmple_ps(nearest, farthest);
+      _mm_storeu_ps(distances+i, ws_g4Select(hit, nearest, miss));
+      numHits += ws_g4StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRayAABBsFrom(ray, centers, extents, i, count, hitMasks, distances);
+  }
+
+  u32 wsBatchRaySpheres_sse2( const wsRay& ray, const wsVec3Stream& centers, const f32* radii,
+                              u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    const vec4& dir = ray.dir;
+    __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+    __m128 a = _mm_set1_ps(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    __m128 zero = _mm_setzero_ps();
+    __m128 miss = _mm_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 toX = _mm_sub_ps(_mm_loadu_ps(centers.x+i), ox);
+      __m128 toY = _mm_sub_ps(_mm_loadu_ps(centers.y+i), oy);
+      __m128 toZ = _mm_sub_ps(_mm_loadu_ps(centers.z+i), oz);
+      __m128 radius = _mm_loadu_ps(radii+i);
+      __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, dx), _mm_mul_ps(toY, dy)), _mm_mul_ps(toZ, dz));
+      __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, toX), _mm_mul_ps(toY, toY)), _mm_mul_ps(toZ, toZ)),
+                            _mm_mul_ps(radius, radius));
+      __m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+      __m128 root = _mm_sqrt_ps(_mm_max_ps(discriminant, zero));
+      __m128 hit = _mm_and_ps(_mm_cmpge_ps(discriminant, zero), _mm_cmpge_ps(_mm_add_ps(b, root), zero));
+      __m128 dist = _mm_max_ps(_mm_div_ps(_mm_sub_ps(b, root), a), zero);
+      _mm_storeu_ps(distances+i, ws_g4Select(hit, dist, miss));
+      numHits += ws_g4StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRaySpheresFrom(ray, centers, radii, i, count, hitMasks, distances);
+  }
+
+  u32 wsBatchRayTriangles_sse2( const wsRay& ray, const wsVec3Stream& verts0, const wsVec3Stream& verts1,
+                                const wsVec3Stream& verts2, u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    __m128 ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z);
+    __m128 dx = _mm_set1_ps(ray.dir.x), dy = _mm_set1_ps(ray.dir.y), dz = _mm_set1_ps(ray.dir.z);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 miss = _mm_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 v0x = _mm_loadu_ps(verts0.x+i), v0y = _mm_loadu_ps(verts0.y+i), v0z = _mm_loadu_ps(verts0.z+i);
+      __m128 e1x = _mm_sub_ps(_mm_loadu_ps(verts1.x+i), v0x);
+      __m128 e1y = _mm_sub_ps(_mm_loadu_ps(verts1.y+i), v0y);
+      __m128 e1z = _mm_sub_ps(_mm_loadu_ps(verts1.z+i), v0z);
+      __m128 e2x = _mm_sub_ps(_mm_loadu_ps(verts2.x+i), v0x);
+      __m128 e2y = _mm_sub_ps(_mm_loadu_ps(verts2.y+i), v0y);
+      __m128 e2z = _mm_sub_ps(_mm_loadu_ps(verts2.z+i), v0z);
+      __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+      __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+      __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+      __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+      __m128 invDet = _mm_div_ps(one, det);
+      __m128 sx = _mm_sub_ps(ox, v0x), sy = _mm_sub_ps(oy, v0y), sz = _mm_sub_ps(oz, v0z);
+      __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+      __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+      __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+      __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+      __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+      __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+      __m128 hit = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_cmpge_ps(u, zero));
+      hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+      hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+      hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+      _mm_storeu_ps(distances+i, ws_g4Select(hit, t, miss));
+      numHits += ws_g4StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRayTrianglesFrom(ray, verts0, verts1, verts2, i, count, hitMasks, distances);
+  }
+
+  u32 wsBatchFrustumAABBs_sse2( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                const wsVec3Stream& extents, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m128 zero = _mm_setzero_ps();
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 cx = _mm_loadu_ps(centers.x+i), cy = _mm_loadu_ps(centers.y+i), cz = _mm_loadu_ps(centers.z+i);
+      __m128 ex = _mm_loadu_ps(extents.x+i), ey = _mm_loadu_ps(extents.y+i), ez = _mm_loadu_ps(extents.z+i);
+      __m128 outside = zero;
+      for (u32 p = 0; p < 6; ++p) {
+        const vec4& plane = frustum.planes[p];
+        __m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z);
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                 _mm_mul_ps(nz, cz)), _mm_set1_ps(plane.w));
+        __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ws_g4Abs(nx), ex), _mm_mul_ps(ws_g4Abs(ny), ey)),
+                                  _mm_mul_ps(ws_g4Abs(nz), ez));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, reach), zero));
+      }
+      numHits += ws_g4StoreHits(hitMasks, i, _mm_cmpeq_ps(outside, zero));
+    }
+    return numHits + wsBatchFrustumAABBsFrom(frustum, centers, extents, i, count, hitMasks);
+  }
+
+  u32 wsBatchFrustumSpheres_sse2( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                  const f32* radii, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m128 zero = _mm_setzero_ps();
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 cx = _mm_loadu_ps(centers.x+i), cy = _mm_loadu_ps(centers.y+i), cz = _mm_loadu_ps(centers.z+i);
+      __m128 radius = _mm_loadu_ps(radii+i);
+      __m128 outside = zero;
+      for (u32 p = 0; p < 6; ++p) {
+        const vec4& plane = frustum.planes[p];
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx),
+                                 _mm_mul_ps(_mm_set1_ps(plane.y), cy)), _mm_mul_ps(_mm_set1_ps(plane.z), cz)),
+                                 _mm_set1_ps(plane.w));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+      }
+      numHits += ws_g4StoreHits(hitMasks, i, _mm_cmpeq_ps(outside, zero));
+    }
+    return numHits + wsBatchFrustumSpheresFrom(frustum, centers, radii, i, count, hitMasks);
+  }
+
+  u32 wsBatchSphereSpheres_sse2(const wsSphere& sphere, const wsVec3Stream& centers,
+                                const f32* radii, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m128 sx = _mm_set1_ps(sphere.center.x), sy = _mm_set1_ps(sphere.center.y), sz = _mm_set1_ps(sphere.center.z);
+    __m128 sr = _mm_set1_ps(sphere.radius);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+4 <= count; i += 4) {
+      __m128 diffX = _mm_sub_ps(_mm_loadu_ps(centers.x+i), sx);
+      __m128 diffY = _mm_sub_ps(_mm_loadu_ps(centers.y+i), sy);
+      __m128 diffZ = _mm_sub_ps(_mm_loadu_ps(centers.z+i), sz);
+      __m128 reach = _mm_add_ps(sr, _mm_loadu_ps(radii+i));
+      __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(diffX, diffX), _mm_mul_ps(diffY, diffY)), _mm_mul_ps(diffZ, diffZ));
+      numHits += ws_g4StoreHits(hitMasks, i, _mm_cmple_ps(dist2, _mm_mul_ps(reach, reach)));
+    }
+    return numHits + wsBatchSphereSpheresFrom(sphere, centers, radii, i, count, hitMasks);
+  }
+
+#endif /* WS_SUPPORTS_SSE */
+
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+
+  /*  AVX2 Kernels; eight elements at a time  */
+  #define ws_g8Abs(v) _mm256_and_ps((v), _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)))
+  #define ws_g8Select(mask, a, b) _mm256_blendv_ps((b), (a), (mask))
+
+  WS_TARGET_AVX2
+  static inline u32 ws_g8StoreHits(u32* hitMasks, u32 index, __m256 hit) {
+    u32 bits = (u32)_mm256_movemask_ps(hit);
+    hitMasks[index >> 5] |= bits << (index & 31);
+    return __builtin_popcount(bits);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchRayAABBs_avx2( const wsRay& ray, const wsVec3Stream& centers, const wsVec3Stream& extents,
+                            u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    __m256 invX = _mm256_set1_ps(1.0f / ray.dir.x);
+    __m256 invY = _mm256_set1_ps(1.0f / ray.dir.y);
+    __m256 invZ = _mm256_set1_ps(1.0f / ray.dir.z);
+    __m256 miss = _mm256_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 cx = _mm256_loadu_ps(centers.x+i), cy = _mm256_loadu_ps(centers.y+i), cz = _mm256_loadu_ps(centers.z+i);
+      __m256 ex = _mm256_loadu_ps(extents.x+i), ey = _mm256_loadu_ps(extents.y+i), ez = _mm256_loadu_ps(extents.z+i);
+      __m256 nearX = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(cx, ex), ox), invX);
+      __m256 farX = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(cx, ex), ox), invX);
+      __m256 nearY = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(cy, ey), oy), invY);
+      __m256 farY = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(cy, ey), oy), invY);
+      __m256 nearZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(cz, ez), oz), invZ);
+      __m256 farZ = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(cz, ez), oz), invZ);
+      __m256 nearest = _mm256_max_ps(_mm256_setzero_ps(), _mm256_min_ps(nearX, farX));
+      __m256 farthest = _mm256_min_ps(miss, _mm256_max_ps(nearX, farX));
+      nearest = _mm256_max_ps(nearest, _mm256_min_ps(nearY, farY));
+      farthest = _mm256_min_ps(farthest, _mm256_max_ps(nearY, farY));
+      nearest = _mm256_max_ps(nearest, _mm256_min_ps(nearZ, farZ));
+      farthest = _mm256_min_ps(farthest, _mm256_max_ps(nearZ, farZ));
+      __m256 hit = _mm256_cmp_ps(nearest, farthest, _CMP_LE_OQ);
+      _mm256_storeu_ps(distances+i, ws_g8Select(hit, nearest, miss));
+      numHits += ws_g8StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRayAABBsFrom(ray, centers, extents, i, count, hitMasks, distances);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchRaySpheres_avx2( const wsRay& ray, const wsVec3Stream& centers, const f32* radii,
+                              u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    const vec4& dir = ray.dir;
+    __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+    __m256 a = _mm256_set1_ps(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 miss = _mm256_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 toX = _mm256_sub_ps(_mm256_loadu_ps(centers.x+i), ox);
+      __m256 toY = _mm256_sub_ps(_mm256_loadu_ps(centers.y+i), oy);
+      __m256 toZ = _mm256_sub_ps(_mm256_loadu_ps(centers.z+i), oz);
+      __m256 radius = _mm256_loadu_ps(radii+i);
+      __m256 b = _mm256_fmadd_ps(toZ, dz, _mm256_fmadd_ps(toY, dy, _mm256_mul_ps(toX, dx)));
+      __m256 c = _mm256_sub_ps(_mm256_fmadd_ps(toZ, toZ, _mm256_fmadd_ps(toY, toY, _mm256_mul_ps(toX, toX))),
+                        _mm256_mul_ps(radius, radius));
+      __m256 discriminant = _mm256_fmsub_ps(b, b, _mm256_mul_ps(a, c));
+      __m256 root = _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero));
+      __m256 hit = _mm256_and_ps(_mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ),
+                                 _mm256_cmp_ps(_mm256_add_ps(b, root), zero, _CMP_GE_OQ));
+      __m256 dist = _mm256_max_ps(_mm256_div_ps(_mm256_sub_ps(b, root), a), zero);
+      _mm256_storeu_ps(distances+i, ws_g8Select(hit, dist, miss));
+      numHits += ws_g8StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRaySpheresFrom(ray, centers, radii, i, count, hitMasks, distances);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchRayTriangles_avx2( const wsRay& ray, const wsVec3Stream& verts0, const wsVec3Stream& verts1,
+                                const wsVec3Stream& verts2, u32 count, u32* hitMasks, f32* distances) {
+    wsClearHitMasks(hitMasks, count);
+    __m256 ox = _mm256_set1_ps(ray.origin.x), oy = _mm256_set1_ps(ray.origin.y), oz = _mm256_set1_ps(ray.origin.z);
+    __m256 dx = _mm256_set1_ps(ray.dir.x), dy = _mm256_set1_ps(ray.dir.y), dz = _mm256_set1_ps(ray.dir.z);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 miss = _mm256_set1_ps(WS_GEOMETRY_MISS);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 v0x = _mm256_loadu_ps(verts0.x+i), v0y = _mm256_loadu_ps(verts0.y+i), v0z = _mm256_loadu_ps(verts0.z+i);
+      __m256 e1x = _mm256_sub_ps(_mm256_loadu_ps(verts1.x+i), v0x);
+      __m256 e1y = _mm256_sub_ps(_mm256_loadu_ps(verts1.y+i), v0y);
+      __m256 e1z = _mm256_sub_ps(_mm256_loadu_ps(verts1.z+i), v0z);
+      __m256 e2x = _mm256_sub_ps(_mm256_loadu_ps(verts2.x+i), v0x);
+      __m256 e2y = _mm256_sub_ps(_mm256_loadu_ps(verts2.y+i), v0y);
+      __m256 e2z = _mm256_sub_ps(_mm256_loadu_ps(verts2.z+i), v0z);
+      __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+      __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+      __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+      __m256 det = _mm256_fmadd_ps(e1z, pz, _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1x, px)));
+      __m256 invDet = _mm256_div_ps(one, det);
+      __m256 sx = _mm256_sub_ps(ox, v0x), sy = _mm256_sub_ps(oy, v0y), sz = _mm256_sub_ps(oz, v0z);
+      __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sz, pz, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sx, px))), invDet);
+      __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+      __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+      __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+      __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dz, qz, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dx, qx))), invDet);
+      __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2z, qz, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2x, qx))), invDet);
+      __m256 hit = _mm256_and_ps(_mm256_cmp_ps(det, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+      hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+      hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+      hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+      _mm256_storeu_ps(distances+i, ws_g8Select(hit, t, miss));
+      numHits += ws_g8StoreHits(hitMasks, i, hit);
+    }
+    return numHits + wsBatchRayTrianglesFrom(ray, verts0, verts1, verts2, i, count, hitMasks, distances);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchFrustumAABBs_avx2( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                const wsVec3Stream& extents, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m256 zero = _mm256_setzero_ps();
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 cx = _mm256_loadu_ps(centers.x+i), cy = _mm256_loadu_ps(centers.y+i), cz = _mm256_loadu_ps(centers.z+i);
+      __m256 ex = _mm256_loadu_ps(extents.x+i), ey = _mm256_loadu_ps(extents.y+i), ez = _mm256_loadu_ps(extents.z+i);
+      __m256 outside = zero;
+      for (u32 p = 0; p < 6; ++p) {
+        const vec4& plane = frustum.planes[p];
+        __m256 nx = _mm256_set1_ps(plane.x), ny = _mm256_set1_ps(plane.y), nz = _mm256_set1_ps(plane.z);
+        __m256 dist = _mm256_fmadd_ps(nz, cz, _mm256_fmadd_ps(ny, cy, _mm256_fmadd_ps(nx, cx, _mm256_set1_ps(plane.w))));
+        __m256 reach = _mm256_fmadd_ps(ws_g8Abs(nz), ez, _mm256_fmadd_ps(ws_g8Abs(ny), ey, _mm256_mul_ps(ws_g8Abs(nx), ex)));
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, reach), zero, _CMP_LT_OQ));
+      }
+      numHits += ws_g8StoreHits(hitMasks, i, _mm256_cmp_ps(outside, zero, _CMP_EQ_OQ));
+    }
+    return numHits + wsBatchFrustumAABBsFrom(frustum, centers, extents, i, count, hitMasks);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchFrustumSpheres_avx2( const wsFrustum& frustum, const wsVec3Stream& centers,
+                                  const f32* radii, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m256 zero = _mm256_setzero_ps();
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 cx = _mm256_loadu_ps(centers.x+i), cy = _mm256_loadu_ps(centers.y+i), cz = _mm256_loadu_ps(centers.z+i);
+      __m256 radius = _mm256_loadu_ps(radii+i);
+      __m256 outside = zero;
+      for (u32 p = 0; p < 6; ++p) {
+        const vec4& plane = frustum.planes[p];
+        __m256 dist = _mm256_fmadd_ps(_mm256_set1_ps(plane.z), cz, _mm256_fmadd_ps(_mm256_set1_ps(plane.y), cy,
+                                      _mm256_fmadd_ps(_mm256_set1_ps(plane.x), cx, _mm256_set1_ps(plane.w))));
+        outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero, _CMP_LT_OQ));
+      }
+      numHits += ws_g8StoreHits(hitMasks, i, _mm256_cmp_ps(outside, zero, _CMP_EQ_OQ));
+    }
+    return numHits + wsBatchFrustumSpheresFrom(frustum, centers, radii, i, count, hitMasks);
+  }
+
+  WS_TARGET_AVX2
+  u32 wsBatchSphereSpheres_avx2(const wsSphere& sphere, const wsVec3Stream& centers,
+                                const f32* radii, u32 count, u32* hitMasks) {
+    wsClearHitMasks(hitMasks, count);
+    __m256 sx = _mm256_set1_ps(sphere.center.x), sy = _mm256_set1_ps(sphere.center.y);
+    __m256 sz = _mm256_set1_ps(sphere.center.z), sr = _mm256_set1_ps(sphere.radius);
+    u32 numHits = 0;
+    u32 i = 0;
+    for (; i+8 <= count; i += 8) {
+      __m256 diffX = _mm256_sub_ps(_mm256_loadu_ps(centers.x+i), sx);
+      __m256 diffY = _mm256_sub_ps(_mm256_loadu_ps(centers.y+i), sy);
+      __m256 diffZ = _mm256_sub_ps(_mm256_loadu_ps(centers.z+i), sz);
+      __m256 reach = _mm256_add_ps(sr, _mm256_loadu_ps(radii+i));
+      __m256 dist2 = _mm256_fmadd_ps(diffZ, diffZ, _mm256_fmadd_ps(diffY, diffY, _mm256_mul_ps(diffX, diffX)));
+      numHits += ws_g8StoreHits(hitMasks, i, _mm256_cmp_ps(dist2, _mm256_mul_ps(reach, reach), _CMP_LE_OQ));
+    }
+    return numHits + wsBatchSphereSpheresFrom(sphere, centers, radii, i, count, hitMasks);
+  }
+
+#endif /* WS_SIMD_AVX2_KERNELS */
+
+u32 (*wsBatchRayAABBs)(const wsRay&, const wsVec3Stream&, const wsVec3Stream&, u32, u32*, f32*) =
+    wsBatchRayAABBs_scalar;
+u32 (*wsBatchRaySpheres)(const wsRay&, const wsVec3Stream&, const f32*, u32, u32*, f32*) =
+    wsBatchRaySpheres_scalar;
+u32 (*wsBatchRayTriangles)( const wsRay&, const wsVec3Stream&, const wsVec3Stream&, const wsVec3Stream&,
+                            u32, u32*, f32*) = wsBatchRayTriangles_scalar;
+u32 (*wsBatchFrustumAABBs)(const wsFrustum&, const wsVec3Stream&, const wsVec3Stream&, u32, u32*) =
+    wsBatchFrustumAABBs_scalar;
+u32 (*wsBatchFrustumSpheres)(const wsFrustum&, const wsVec3Stream&, const f32*, u32, u32*) =
+    wsBatchFrustumSpheres_scalar;
+u32 (*wsBatchSphereSpheres)(const wsSphere&, const wsVec3Stream&, const f32*, u32, u32*) =
+    wsBatchSphereSpheres_scalar;
+
+void wsSetGeometryLevel(wsSIMDLevel level) {
+  switch (level) {
+    #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+      case WS_SIMD_AVX2:
+        wsBatchRayAABBs = wsBatchRayAABBs_avx2;
+        wsBatchRaySpheres = wsBatchRaySpheres_avx2;
+        wsBatchRayTriangles = wsBatchRayTriangles_avx2;
+        wsBatchFrustumAABBs = wsBatchFrustumAABBs_avx2;
+        wsBatchFrustumSpheres = wsBatchFrustumSpheres_avx2;
+        wsBatchSphereSpheres = wsBatchSphereSpheres_avx2;
+        break;
+    #endif
+    #if WS_SUPPORTS_SSE == WS_TRUE
+      case WS_SIMD_SSE2:
+        wsBatchRayAABBs = wsBatchRayAABBs_sse2;
+        wsBatchRaySpheres = wsBatchRaySpheres_sse2;
+        wsBatchRayTriangles = wsBatchRayTriangles_sse2;
+        wsBatchFrustumAABBs = wsBatchFrustumAABBs_sse2;
+        wsBatchFrustumSpheres = wsBatchFrustumSpheres_sse2;
+        wsBatchSphereSpheres = wsBatchSphereSpheres_sse2;
+        break;
+    #endif
+    default:
+      wsBatchRayAABBs = wsBatchRayAABBs_scalar;
+      wsBatchRaySpheres = wsBatchRaySpheres_scalar;
+      wsBatchRayTriangles = wsBatchRayTriangles_scalar;
+      wsBatchFrustumAABBs = wsBatchFrustumAABBs_scalar;
+      wsBatchFrustumSpheres = wsBatchFrustumSpheres_scalar;
+      wsBatchSphereSpheres = wsBatchSphereSpheres_scalar;
+      break;
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * wsGeometry.h
+ *
+ *    This file declares the geometric queries for the Whipstitch Game Engine: rays
+ *    against boxes, spheres and triangles, frusta against boxes and spheres, and
+ *    spheres against spheres.
+ *
+ *    Each query has a single-primitive version, built on vec4, which serves as the
+ *    reference for the batch kernels. The batch kernels test one ray, frustum or sphere
+ *    against many primitives stored as structure-of-arrays streams (see wsBatchMath.h),
+ *    four (SSE2) or eight (AVX2) at a time. Like the other kernels, each is a function
+ *    pointer aimed at the best version for the processor by wsDetectSIMD().
+ *
+ *    A batch kernel sets bit (i % 32) of hitMasks[i / 32] for every primitive i which
+ *    is hit, and returns the number of hits. Ray kernels also write the distance to each
+ *    primitive, in multiples of the ray's direction, or WS_GEOMETRY_MISS for those which
+ *    are missed. A ray which starts inside a box or sphere hits it at distance 0.
+ *
+ *    Usage:
+ *      u32 hits[WS_HIT_MASK_WORDS(WS_MAX_ENTITIES)];
+ *      u32 numVisible = wsBatchFrustumSpheres(camera->getFrustum(), centers, radii,
+ *                                             numEntities, hits);
+ *      if (wsIsHit(hits, entityIndex)) { ... }
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_GEOMETRY_H_
+#define WS_GEOMETRY_H_
+
+#include "wsBatchMath.h"
+#include "vec4.h"
+#include "mat4.h"
+#include <math.h>
+
+//  The distance reported for a primitive which the ray misses
+#define WS_GEOMETRY_MISS HUGE_VALF
+
+//  The number of words needed to hold hit masks for the given number of primitives
+#define WS_HIT_MASK_WORDS(count) (((count) + 31) / 32)
+
+#define WS_FRUSTUM_LEFT   0
+#define WS_FRUSTUM_RIGHT  1
+#define WS_FRUSTUM_BOTTOM 2
+#define WS_FRUSTUM_TOP    3
+#define WS_FRUSTUM_NEAR   4
+#define WS_FRUSTUM_FAR    5
+
+struct wsRay {
+  vec4 origin;
+  //  Need not be unit length; distances along the ray are measured in multiples of it
+  vec4 dir;
+  wsRay() : origin(0.0f, 0.0f, 0.0f, 1.0f), dir(0.0f, 0.0f, 1.0f, 0.0f) {}
+  wsRay(const vec4& myOrigin, const vec4& myDir) : origin(myOrigin), dir(myDir) {}
+  vec4 getPoint(f32 distance) const { return origin + dir*distance; }
+};
+
+struct wsSphere {
+  vec4 center;
+  f32 radius;
+  wsSphere() : center(0.0f, 0.0f, 0.0f, 1.0f), radius(0.0f) {}
+  wsSphere(const vec4& myCenter, f32 myRadius) : center(myCenter), radius(myRadius) {}
+};
+
+//  An axis-aligned box, stored as a center and half-extents like wsBatchComputeAABBs
+struct wsAABB {
+  vec4 center;
+  vec4 extents;
+  wsAABB() : center(0.0f, 0.0f, 0.0f, 1.0f), extents(0.0f, 0.0f, 0.0f, 0.0f) {}
+  wsAABB(const vec4& myCenter, const vec4& myExtents) : center(myCenter), extents(myExtents) {}
+};
+
+//  Six planes facing inward; each is a unit normal (x, y, z) and an offset (w), so that
+//  a point p is inside the plane when p.x*x + p.y*y + p.z*z + w >= 0.
+struct wsFrustum {
+  vec4 planes[6];
+  wsFrustum() {}
+  //  Extracts the planes of a combined view and projection matrix (row vectors, as vec4*mat4)
+  explicit wsFrustum(const mat4& viewProjection);
+  //  Scales each plane to a unit normal; needed by the sphere tests
+  void normalize();
+};
+
+/*  Reference Queries  */
+//  On a hit, distance is set to the nearest point in front of the ray's origin
+bool wsRayIntersectsAABB(const wsRay& ray, const wsAABB& box, f32& distance);
+bool wsRayIntersectsSphere(const wsRay& ray, const wsSphere& sphere, f32& distance);
+//  Triangles are double-sided
+bool wsRayIntersectsTriangle( const wsRay& ray, const vec4& vert0, const vec4& vert1,
+                              const vec4& vert2, f32& distance);
+//  True when any part of the primitive may lie inside the frustum
+bool wsFrustumIntersectsAABB(const wsFrustum& frustum, const wsAABB& box);
+bool wsFrustumIntersectsSphere(const wsFrustum& frustum, const wsSphere& sphere);
+bool wsSphereIntersectsSphere(const wsSphere& a, const wsSphere& b);
+
+inline bool wsIsHit(const u32* hitMasks, u32 index) {
+  return (hitMasks[index >> 5] >> (index & 31)) & 1;
+}
+
+//  Selects the kernels for the given level; called by wsSetSIMDLevel(...)
+void wsSetGeometryLevel(wsSIMDLevel level);
+
+/*  Batch Kernels */
+extern u32 (*wsBatchRayAABBs)(const wsRay& ray, const wsVec3Stream& centers, const wsVec3Stream& extents,
+                              u32 count, u32* hitMasks, f32* distances);
+extern u32 (*wsBatchRaySpheres)(const wsRay& ray, const wsVec3Stream& centers, const f32* radii,
+                                u32 count, u32* hitMasks, f32* distances);
+extern u32 (*wsBatchRayTriangles)(const wsRay& ray, const wsVec3Stream& verts0, const wsVec3Stream& verts1,
+                                  const wsVec3Stream& verts2, u32 count, u32* hitMasks, f32* distances);
+extern u32 (*wsBatchFrustumAABBs)(const wsFrustum& frustum, const wsVec3Stream& centers,
+                                  const wsVec3Stream& extents, u32 count, u32* hitMasks);
+extern u32 (*wsBatchFrustumSpheres)(const wsFrustum& frustum, const wsVec3Stream& centers,
+                                    const f32* radii, u32 count, u32* hitMasks);
+extern u32 (*wsBatchSphereSpheres)( const wsSphere& sphere, const wsVec3Stream& centers,
+                                    const f32* radii, u32 count, u32* hitMasks);
+
+#endif /* WS_GEOMETRY_H_ */
@@ -9,8 +9,15 @@
  *
  *    Hashes are produced using the wsHash function declared in wsOperations.h.
  *    The hashed u32 integer is then modulated to accommodate the table size
- *    declared with the map. This table size represents the maximum number of elements
- *    allowed in the hash map.
+ *    declared with the map. This table size is only the initial capacity; when an
+ *    element cannot be placed, the table is rehashed into a larger prime-sized array
+ *    taken from the same Primary Stack tier. Like every other stack allocation, the
+ *    old array is not reclaimed until its tier is freed.
+ *
+ *    Elements are constructed in place inside the table, either by copying or moving
+ *    them in with insert(...) or by passing constructor arguments to emplace(...).
+ *    Iterators and find(...) hand back references to the stored element, so any
+ *    element type may be used, not only pointers.
  *
  *    Quatratic probing is used to handle collisions and preferred hash table sizes
  *    are therefore prime numbers.
@@ -22,6 +29,10 @@
  *        myMap->insert(wsHash(myString), myObjectType);
  *      Retrieve the objects for use using the method retrieve(u32)
  *        myObjectType newObj = myMap->retrieve(wsHash(myString));
+ *      Visit every object in index order using an iterator
+ *        for (wsHashMap<myObjectType>::iterator it = myMap->begin(); it.isValid(); ++it) {
+ *          it->doSomething();
+ *        }
  *
  *
  *  This software is provided under the terms of the MIT license
@@ -53,6 +64,8 @@
 
 #include "wsMemoryStack.h"
 #include "wsOperations.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
 
 template <class ClassType>
 class wsHashMap {
@@ -63,6 +76,7 @@ class wsHashMap {
       //  A value less than zero indicates no item exists
       i32 next;
       i32 prev;
+      //  Only constructed while hashKey is not WS_NULL
       ClassType object;
     };
     ws_HashKeyPair* array;
@@ -72,6 +86,16 @@ class wsHashMap {
     //  A value less than zero indicates no item exists
     i32 first;
     i32 last;
+    wsMemoryStack::_ws_memstack_tier tier;
+    //  Reserves an index for the key, growing the table as needed; the element is left
+    //  unconstructed. Returns a negative value if the key is already present.
+    i32 claimIndex(u32 hashIndex);
+    //  Returns the array index holding the key, or a negative value if there is none
+    i32 findIndex(u32 hashIndex) const;
+    //  Rehashes every element into a table roughly twice the size
+    void grow();
+    //  Places an occupied index into the index-ordered linked list
+    void linkIndex(u32 index);
   public:
     struct iterator {
       /*  Member Variable */
@@ -79,25 +103,30 @@ class wsHashMap {
       wsHashMap<ClassType>* parent;
       /*  Member Functions  */
       iterator(wsHashMap<ClassType>* myParent); //  Constructor
+      //  True while the iterator refers to an element of the hashmap
+      bool isValid() const { return (mCurrentElement >= 0); }
+      bool hasNext() const { return (parent->array[mCurrentElement].next >= 0); }
+      bool hasPrev() const { return (parent->array[mCurrentElement].prev >= 0); }
       //  Retrieve the item from the hashmap
-      ClassType get();
-      //  Return the next item in the hashmap
-      ClassType getNext();
-      //  Return the previous item in the hashmap
-      ClassType getPrev();
+      ClassType& get() const { return parent->array[mCurrentElement].object; }
+      ClassType& operator*() const { return get(); }
+      ClassType* operator->() const { return &get(); }
+      //  Retrieve the hash key of the current item
+      u32 getKey() const { return parent->array[mCurrentElement].hashKey; }
       //  Go to the next item in the hashmap
-      ClassType operator++();  //  preincrement operator
+      iterator& operator++();  //  preincrement operator
       //  Go to the previous item in the hashmap
-      ClassType operator--();  //  predecrement operator
+      iterator& operator--();  //  predecrement operator
     };
     /*  Constructor and Deconstructor   */
-    wsHashMap(u32 maxElements = 53);
+    wsHashMap(u32 maxElements = 53,
+              wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
     ~wsHashMap();
     /*  Accessors   */
-    bool contains(u32 hashIndex);
+    bool contains(u32 hashIndex) const { return (findIndex(hashIndex) >= 0); }
     u32 getMaxElements() { return maxElements; }
     u32 getLength() { return length; }
-    const ClassType getArrayItem(u32 arrayIndex) { return array[arrayIndex].object; }
+    ClassType& getArrayItem(u32 arrayIndex) { return array[arrayIndex].object; }
     bool isEmpty() { return (length == 0); }
     bool isFull() { return (length == maxElements); }
     /*  Operational Member Functions  */
@@ -105,8 +134,14 @@ class wsHashMap {
     wsHashMap::iterator begin();
     //  Returns an iterator containing the last object in the table
     wsHashMap::iterator end();
+    //  Constructs the element in place at the given index
+    template <class... Args>
+    u32 emplace(u32 hashIndex, Args&&... args);
+    //  Returns the address of the element at the given index, or NULL if there is none
+    ClassType* find(u32 hashIndex);
     //  Inserts the element into the hashmap at the given index
     u32 insert(u32 hashIndex, const ClassType& element);
+    u32 insert(u32 hashIndex, ClassType&& element);
     //  Prints the components of the hashMap using wsLog
     void print(u16 printLog = WS_LOG_MAIN);
     //  Removes the element from the hashmap at the given index
@@ -128,47 +163,29 @@ wsHashMap<ClassType>::iterator::iterator(wsHashMap<ClassType>* myParent) {
 }
 
 template <class ClassType>
-inline ClassType wsHashMap<ClassType>::iterator::get() {
-  if (mCurrentElement < 0 || (u32)mCurrentElement >= parent->maxElements) {
-    return WS_NULL;
-  }
-  return parent->array[mCurrentElement].object;
-}
-
-template <class ClassType>
-inline ClassType wsHashMap<ClassType>::iterator::getNext() {
-  if (parent->array[mCurrentElement].next < 0) { return WS_NULL; }   //  There is no next element
-  return parent->array[ parent->array[mCurrentElement].next ].object;
-}
-
-template <class ClassType>
-inline ClassType wsHashMap<ClassType>::iterator::getPrev() {
-  if (parent->array[mCurrentElement].prev < 0) { return WS_NULL; }
-  return parent->array[ parent->array[mCurrentElement].prev ].object;
-}
-
-template <class ClassType>
-inline ClassType wsHashMap<ClassType>::iterator::operator++() {
+inline typename wsHashMap<ClassType>::iterator& wsHashMap<ClassType>::iterator::operator++() {
   mCurrentElement = parent->array[mCurrentElement].next;
-  return parent->array[ mCurrentElement ].object;
+  return *this;
 }
 
 template <class ClassType>
-inline ClassType wsHashMap<ClassType>::iterator::operator--() {
-  mCurrentElement = parent->array[mCurrentElement].next;
-  return parent->array[ mCurrentElement ].object;
+inline typename wsHashMap<ClassType>::iterator& wsHashMap<ClassType>::iterator::operator--() {
+  mCurrentElement = parent->array[mCurrentElement].prev;
+  return *this;
 }
 
 /*  Member Functions for wsHashMap  */
 //  Constructor
 template <class ClassType>
-wsHashMap<ClassType>::wsHashMap(u32 maxElements) {
+wsHashMap<ClassType>::wsHashMap(u32 maxElements, wsMemoryStack::_ws_memstack_tier myTier) {
   maxElements = wsNextPrime(maxElements);
   wsEcho(WS_LOG_UTIL, "Creating %u element hashmap\n", maxElements);
   wsAssert((maxElements > 0), "wsHashMap must have more than 0 elements.");
   length = 0;
   this->maxElements = maxElements;
-  array = wsNewArray(ws_HashKeyPair, maxElements);
+  tier = myTier;
+  array = (ws_HashKeyPair*)wsMem.allocatePrimary(sizeof(ws_HashKeyPair)*maxElements, tier);
+  wsAssert((array != NULL), "Could not allocate hashmap storage.");
   for (u32 i = 0; i < maxElements; ++i) {
     array[i].hashKey = WS_NULL;
   }
@@ -181,25 +198,42 @@ wsHashMap<ClassType>::~wsHashMap() {
   //delete [] array;
 }
 
-//  Operational Member Functions
+//  Protected Member Functions
 
 template <class ClassType>
-typename wsHashMap<ClassType>::iterator wsHashMap<ClassType>::begin() {
-  //  Start at beginning and find the first item in the hashmap
-  wsHashMap<ClassType>::iterator it(this);
-  return it;
-}
-
-template <class ClassType>
-typename wsHashMap<ClassType>::iterator wsHashMap<ClassType>::end() {
-  //  Start at end and find the last item in the hashmap
-  wsHashMap<ClassType>::iterator it(this);
-  it.mCurrentElement = this->last;
-  return it;
+i32 wsHashMap<ClassType>::claimIndex(u32 hashIndex) {
+  //wsEcho(WS_LOG_UTIL, "Inserting item\n");
+  if (length == maxElements) {  //  The hashMap is full already
+    grow();
+  }
+  u32 moddedHash = hashIndex % maxElements;
+  u32 probeCount = 0, offset = 1;
+  //  Loop for quadratic probing
+  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
+      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
+      probeCount < maxElements/2) {   //  probe half of the elements
+    ++probeCount;
+    moddedHash += offset;
+    moddedHash %= maxElements;
+    offset += 2;
+  }
+  if (array[moddedHash].hashKey == WS_NULL) { //  The index is free
+    array[moddedHash].hashKey = hashIndex;
+    ++length;
+    linkIndex(moddedHash);
+    return moddedHash;
+  }
+  if (array[moddedHash].hashKey == hashIndex) {
+    wsEcho(WS_LOG_UTIL, "Cannot enter duplicate key into hash map.\n");
+    return -1;
+  }
+  //  Quadratic probing found no free index; make room and try again
+  grow();
+  return claimIndex(hashIndex);
 }
 
 template <class ClassType>
-bool wsHashMap<ClassType>::contains(u32 hashIndex) {
+i32 wsHashMap<ClassType>::findIndex(u32 hashIndex) const {
   u32 moddedHash = hashIndex % maxElements;
   //  Loop for quadratic probing
   u32 probeCount = 0, offset = 1;
@@ -212,117 +246,120 @@ bool wsHashMap<ClassType>::contains(u32 hashIndex) {
     offset += 2;
   }
   if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    return true;
+    return moddedHash;
   }
-  return false;
+  return -1;
 }
 
 template <class ClassType>
-u32 wsHashMap<ClassType>::insert(u32 hashIndex, const ClassType& element) {
-  //wsEcho(WS_LOG_UTIL, "Inserting item\n");
-  u32 moddedHash = hashIndex % maxElements;
-  if (length != maxElements) {  //  If the hashMap is not full already
-    u32 probeCount = 0, offset = 1;
-    //  Loop for quadratic probing
-    while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-        array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-        probeCount < maxElements/2) {   //  probe half of the elements
-      ++probeCount;
-      moddedHash += offset;
-      moddedHash %= maxElements;
-      offset += 2;
-    }
-    if (array[moddedHash].hashKey == WS_NULL) { //  The index is free
-      array[moddedHash].hashKey = hashIndex;
-      array[moddedHash].object = element;
-      ++length;
-      //  Update linked list
-      if (first < 0) {  //  The list is empty
-        first = last = moddedHash;
-        array[moddedHash].next = array[moddedHash].prev = -1;
-      }
-      else if (moddedHash == 0) { //  If there can be no other elements preceding this one
-        array[moddedHash].prev = -1;
-        array[moddedHash].next = first;
-        first = array[first].prev = moddedHash;
-      }
-      else if (moddedHash == maxElements-1) {//   If no other elements can follow this one
-        array[moddedHash].next = -1;
-        array[moddedHash].prev = last;
-        last = array[last].next = moddedHash;
-      }
-      else {
-        if (moddedHash < maxElements/2) {   //  Front half of the hashmap; search backwards for nearest element
-          //  Check before this index
-          if (moddedHash < (u32)first) {  //  This is now the first element
-            array[moddedHash].next = first;
-            first = array[first].prev = moddedHash;
-            array[moddedHash].prev = -1;
-          }
-          else {
-            //  Iterate to the beginning of the hashmap and find the previous element
-            for (u32 i = moddedHash-1; i >= 0; --i) {
-              if (array[i].hashKey != WS_NULL) {  //  The index is taken; this will be our prev
-                array[moddedHash].prev = i;
-                array[moddedHash].next = array[i].next;
-                if (array[i].next < 0) {  //  If there was not previously another element in front of this
-                  array[i].next = last = moddedHash;
-                }
-                else {
-                  array[i].next = array[ array[i].next ].prev = moddedHash;
-                }
-                break;
-              }
-            }
-          }
-        }
-        else {  //  Back half of the hashmap; search forwards for the nearest element
-          //  Check in front of this index
-          if (moddedHash > (u32)last) {  //  This is now the last element
-            array[moddedHash].prev = last;
-            last = array[last].next = moddedHash;
-            array[moddedHash].next = -1;
-          }
-          else {
-            //  Iterate to the end and find the next element
-            for (u32 i = moddedHash+1; i < maxElements; ++i) {
-              if (array[i].hashKey != WS_NULL) {  //  The index is taken; this will be our next
-                array[moddedHash].next = i;
-                array[moddedHash].prev = array[i].prev;
-                if (array[i].prev < 0) {  //  If there was not previously another element before this
-                  array[i].prev = first = moddedHash;
-                }
-                else {
-                  array[i].prev = array[ array[i].prev ].next = moddedHash;
-                }
-              }
-            }
-          }
-        }
-      }
-    }
-    else {
-      if (array[moddedHash].hashKey == hashIndex) {
-        wsEcho(WS_LOG_UTIL, "Cannot enter duplicate key into hash map.\n");
-        return WS_FAIL;
-      }
-      else {
-        wsEcho(WS_LOG_UTIL, "Could not insert element into hash map.\n"
-                "  key = %u\n"
-                "  moddedHash = %u\n"
-                "  array[moddedHash].hashKey = %u\n",
-                hashIndex, moddedHash, array[moddedHash].hashKey);
-        return WS_FAIL;
-      }
-    }
+void wsHashMap<ClassType>::grow() {
+  ws_HashKeyPair* oldArray = array;
+  i32 current = first;
+  u32 oldMaxElements = maxElements;
+  maxElements = wsNextPrime(oldMaxElements*2 + 1);
+  wsEcho(WS_LOG_UTIL, "Growing hashmap from %u to %u elements\n", oldMaxElements, maxElements);
+  array = (ws_HashKeyPair*)wsMem.allocatePrimary(sizeof(ws_HashKeyPair)*maxElements, tier);
+  wsAssert((array != NULL), "Could not grow hashmap storage.");
+  for (u32 i = 0; i < maxElements; ++i) {
+    array[i].hashKey = WS_NULL;
   }
-  else {
-    wsEcho(WS_LOG_UTIL, "Hashmap is full.\n");
-    return WS_FAIL;
+  length = 0;
+  first = last = -1;
+  while (current >= 0) {
+    ClassType& object = oldArray[current].object;
+    new (&array[claimIndex(oldArray[current].hashKey)].object) ClassType(std::move(object));
+    object.~ClassType();
+    current = oldArray[current].next;
   }
+}
+
+template <class ClassType>
+void wsHashMap<ClassType>::linkIndex(u32 index) {
+  if (first < 0) {  //  The list is empty
+    first = last = index;
+    array[index].next = array[index].prev = -1;
+  }
+  else if (index < (u32)first) {  //  This is now the first element
+    array[index].prev = -1;
+    array[index].next = first;
+    first = array[first].prev = index;
+  }
+  else if (index > (u32)last) {  //  This is now the last element
+    array[index].next = -1;
+    array[index].prev = last;
+    last = array[last].next = index;
+  }
+  else if (index < maxElements/2) {   //  Front half of the hashmap; search backwards for nearest element
+    i32 i = index - 1;
+    while (array[i].hashKey == WS_NULL) { --i; }
+    //  Index i is taken; this will be our prev
+    array[index].prev = i;
+    array[index].next = array[i].next;
+    array[i].next = array[ array[i].next ].prev = index;
+  }
+  else {  //  Back half of the hashmap; search forwards for the nearest element
+    u32 i = index + 1;
+    while (array[i].hashKey == WS_NULL) { ++i; }
+    //  Index i is taken; this will be our next
+    array[index].next = i;
+    array[index].prev = array[i].prev;
+    array[i].prev = array[ array[i].prev ].next = index;
+  }
+}
+
+//  Operational Member Functions
+
+template <class ClassType>
+typename wsHashMap<ClassType>::iterator wsHashMap<ClassType>::begin() {
+  //  Start at beginning and find the first item in the hashmap
+  wsHashMap<ClassType>::iterator it(this);
+  return it;
+}
+
+template <class ClassType>
+typename wsHashMap<ClassType>::iterator wsHashMap<ClassType>::end() {
+  //  Start at end and find the last item in the hashmap
+  wsHashMap<ClassType>::iterator it(this);
+  it.mCurrentElement = this->last;
+  return it;
+}
+
+template <class ClassType>
+template <class... Args>
+u32 wsHashMap<ClassType>::emplace(u32 hashIndex, Args&&... args) {
+  i32 index = claimIndex(hashIndex);
+  if (index < 0) { return WS_FAIL; }
+  new (&array[index].object) ClassType(std::forward<Args>(args)...);
   return WS_SUCCESS;
 }
 
+template <class ClassType>
+ClassType* wsHashMap<ClassType>::find(u32 hashIndex) {
+  i32 index = findIndex(hashIndex);
+  if (index < 0) { return NULL; }
+  return &array[index].object;
+}
+
+//  An element which already lives in this table would move if the table grew, so it
+//  is copied aside first
+template <class ClassType>
+u32 wsHashMap<ClassType>::insert(u32 hashIndex, const ClassType& element) {
+  if ((const void*)&element >= (const void*)array && (const void*)&element < (const void*)(array + maxElements)) {
+    ClassType tmp(element);
+    return emplace(hashIndex, std::move(tmp));
+  }
+  return emplace(hashIndex, element);
+}
+
+template <class ClassType>
+u32 wsHashMap<ClassType>::insert(u32 hashIndex, ClassType&& element) {
+  if ((const void*)&element >= (const void*)array && (const void*)&element < (const void*)(array + maxElements)) {
+    ClassType tmp(std::move(element));
+    return emplace(hashIndex, std::move(tmp));
+  }
+  return emplace(hashIndex, std::move(element));
+}
+
 template <class ClassType>
 void wsHashMap<ClassType>::print(u16 printLog) {
   wsEcho(printLog, "Hashmap Contents\n");
@@ -335,25 +372,22 @@ void wsHashMap<ClassType>::print(u16 printLog) {
 
 template <class ClassType>
 void wsHashMap<ClassType>::remove(u32 hashIndex) {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    if (array[moddedHash].prev >= 0) {
-      array[ array[moddedHash].prev ].next = array[moddedHash].next;
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    if (array[index].prev >= 0) {
+      array[ array[index].prev ].next = array[index].next;
+    }
+    else {
+      first = array[index].next;
     }
-    if (array[moddedHash].next >= 0) {
-      array[ array[moddedHash].next ].prev = array[moddedHash].prev;
+    if (array[index].next >= 0) {
+      array[ array[index].next ].prev = array[index].prev;
     }
-    array[moddedHash].hashKey = WS_NULL;
+    else {
+      last = array[index].prev;
+    }
+    array[index].object.~ClassType();
+    array[index].hashKey = WS_NULL;
     --length;
   }
   else {
@@ -363,19 +397,9 @@ void wsHashMap<ClassType>::remove(u32 hashIndex) {
 
 template <class ClassType>
 void wsHashMap<ClassType>::replace(u32 hashIndex, const ClassType& element) {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    array[moddedHash].object = element;
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    array[index].object = element;
   }
   else {
     //wsEcho(WS_LOG_UTIL, "No suitable match found for hash key: %u\n", hashIndex);
@@ -385,41 +409,19 @@ void wsHashMap<ClassType>::replace(u32 hashIndex, const ClassType& element) {
 
 template <class ClassType>
 const ClassType& wsHashMap<ClassType>::retrieve(u32 hashIndex) const {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    return array[moddedHash].object;
-  }
-  else {
+  i32 index = findIndex(hashIndex);
+  if (index < 0) {
     wsEcho(WS_LOG_UTIL, "No suitable match found for hash key: %u\n", hashIndex);
+    return array[hashIndex % maxElements].object;
   }
-  return array[moddedHash].object;
+  return array[index].object;
 }
 
 template <class ClassType>
 bool wsHashMap<ClassType>::retrieve(u32 hashIndex, ClassType& element) const {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    element = array[moddedHash].object;
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    element = array[index].object;
     return true;
   }
   else {
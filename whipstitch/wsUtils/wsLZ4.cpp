@@ -0,0 +1,172 @@
+/*
+ * wsLZ4.cpp
+ *
+ *    This file implements the LZ4 block codec of the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsLZ4.h"
+#include "wsLog.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WS_LZ4_MIN_MATCH    4
+#define WS_LZ4_MAX_OFFSET   65535
+//  The format ends every block with literals: the last match starts at least 12 bytes
+//  before the end, and ends at least 5 bytes before it
+#define WS_LZ4_MATCH_LIMIT  12
+#define WS_LZ4_LAST_LITERALS 5
+#define WS_LZ4_HASH_BITS    16
+//  After this many misses in a row, the search steps forward faster through data which
+//  does not compress
+#define WS_LZ4_SKIP_TRIGGER 6
+
+static inline u32 wsLZ4Read32(const u8* p) {
+  u32 my;
+  memcpy(&my, p, 4);
+  return my;
+}
+
+static inline u32 wsLZ4Hash(const u8* p) {
+  return (wsLZ4Read32(p) * 2654435761u) >> (32 - WS_LZ4_HASH_BITS);
+}
+
+//  Writes a length beyond what fits in the token as a run of bytes
+static inline u8* wsLZ4WriteLength(u8* op, u64 length) {
+  for (; length >= 255; length -= 255) { *op++ = 255; }
+  *op++ = (u8)length;
+  return op;
+}
+
+static u8* wsLZ4WriteSequence(u8* op, const u8* literals, u64 numLiterals, u32 offset, u64 matchLength) {
+  u8* token = op++;
+  if (numLiterals >= 15) {
+    *token = 15 << 4;
+    op = wsLZ4WriteLength(op, numLiterals - 15);
+  }
+  else {
+    *token = (u8)(numLiterals << 4);
+  }
+  memcpy(op, literals, numLiterals);
+  op += numLiterals;
+  if (matchLength == 0) { return op; }  //  The last sequence has no match
+  *op++ = (u8)offset;
+  *op++ = (u8)(offset >> 8);
+  matchLength -= WS_LZ4_MIN_MATCH;
+  if (matchLength >= 15) {
+    *token |= 15;
+    op = wsLZ4WriteLength(op, matchLength - 15);
+  }
+  else {
+    *token |= (u8)matchLength;
+  }
+  return op;
+}
+
+u64 wsLZ4Compress(u8* dest, const u8* src, u64 srcSize) {
+  wsAssert(srcSize <= WS_LZ4_MAX_INPUT, "Block is too large for LZ4.");
+  u8* op = dest;
+  const u8* anchor = src;
+  if (srcSize > WS_LZ4_MATCH_LIMIT) {
+    //  Positions of the last sequence seen with each hash, from src
+    u32* table = (u32*)calloc(1 << WS_LZ4_HASH_BITS, sizeof(u32));
+    wsAssert(table, "Could not allocate the LZ4 hash table.");
+    const u8* matchStart = src + srcSize - WS_LZ4_MATCH_LIMIT;
+    const u8* matchEnd = src + srcSize - WS_LZ4_LAST_LITERALS;
+    const u8* ip = src + 1;
+    u32 misses = 0;
+    while (ip <= matchStart) {
+      const u32 h = wsLZ4Hash(ip);
+      const u8* ref = src + table[h];
+      table[h] = (u32)(ip - src);
+      if (ref >= ip || ip - ref > WS_LZ4_MAX_OFFSET || wsLZ4Read32(ref) != wsLZ4Read32(ip)) {
+        ip += 1 + (misses++ >> WS_LZ4_SKIP_TRIGGER);
+        continue;
+      }
+      misses = 0;
+      //  Grow the match back over literals, then forward as far as it goes
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) { --ip; --ref; }
+      u64 length = WS_LZ4_MIN_MATCH;
+      while (ip + length < matchEnd && ip[length] == ref[length]) { ++length; }
+      op = wsLZ4WriteSequence(op, anchor, ip - anchor, (u32)(ip - ref), length);
+      ip += length;
+      anchor = ip;
+      //  Remember a position inside the match, which helps runs of repeated data
+      if (ip <= matchStart) { table[wsLZ4Hash(ip - 2)] = (u32)(ip - 2 - src); }
+    }
+    free(table);
+  }
+  return (wsLZ4WriteSequence(op, anchor, src + srcSize - anchor, 0, 0) - dest);
+}
+
+bool wsLZ4Decompress(u8* dest, u64 destSize, const u8* src, u64 srcSize) {
+  const u8* ip = src;
+  const u8* srcEnd = src + srcSize;
+  u8* op = dest;
+  u8* destEnd = dest + destSize;
+  for (;;) {
+    if (ip >= srcEnd) { return false; }
+    const u8 token = *ip++;
+    u64 numLiterals = token >> 4;
+    if (numLiterals == 15) {
+      u8 b;
+      do {
+        if (ip >= srcEnd) { return false; }
+        b = *ip++;
+        numLiterals += b;
+      } while (b == 255);
+    }
+    if (numLiterals > (u64)(srcEnd - ip) || numLiterals > (u64)(destEnd - op)) { return false; }
+    memcpy(op, ip, numLiterals);
+    op += numLiterals;
+    ip += numLiterals;
+    if (ip == srcEnd) { break; }
+    if (srcEnd - ip < 2) { return false; }
+    const u32 offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (u64)(op - dest)) { return false; }
+    u64 length = token & 15;
+    if (length == 15) {
+      u8 b;
+      do {
+        if (ip >= srcEnd) { return false; }
+        b = *ip++;
+        length += b;
+      } while (b == 255);
+    }
+    length += WS_LZ4_MIN_MATCH;
+    if (length > (u64)(destEnd - op)) { return false; }
+    const u8* match = op - offset;
+    if (offset >= length) {
+      memcpy(op, match, length);
+      op += length;
+    }
+    else {
+      //  The match overlaps what it writes, repeating the last offset bytes
+      for (u64 i = 0; i < length; ++i) { *op++ = match[i]; }
+    }
+  }
+  return (op == destEnd);
+}
@@ -0,0 +1,56 @@
+/*
+ * wsLZ4.h
+ *
+ *    This file declares the LZ4 block codec of the Whipstitch Game Engine, used to
+ *    compress entries of .wsPak files. Blocks follow the LZ4 block format, so the
+ *    reference tools can read and write them, but frames are not supported.
+ *
+ *    Decompression runs at memory speed and checks every length and offset against
+ *    the buffers, so a corrupt block fails rather than reading or writing out of
+ *    bounds. Compression is a single greedy pass over a hash table of 4-byte
+ *    sequences, which trades some ratio for speed at build time.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_LZ4_H_
+#define WS_LZ4_H_
+
+#include "wsPlatform.h"
+
+//  The largest block the format allows
+#define WS_LZ4_MAX_INPUT 0x7E000000
+
+//  Size of a buffer which always holds the compressed form of numBytes
+inline u64 wsLZ4Bound(u64 numBytes) { return numBytes + numBytes/255 + 16; }
+
+//  Compresses src into dest, which holds at least wsLZ4Bound(srcSize) bytes, and
+//  returns the compressed size
+u64 wsLZ4Compress(u8* dest, const u8* src, u64 srcSize);
+
+//  Decompresses a block into exactly destSize bytes. Returns false if the block is
+//  corrupt or does not fill dest exactly.
+bool wsLZ4Decompress(u8* dest, u64 destSize, const u8* src, u64 srcSize);
+
+#endif /* WS_LZ4_H_ */
@@ -0,0 +1,243 @@
+/*
+ *      wsMPMCQueue.h
+ *
+ *      This file declares and implements the class wsMPMCQueue, a bounded lock-free
+ *      queue which any number of threads may push to and pop from at once, such as
+ *      a task list shared by worker threads.
+ *
+ *      Each slot carries a sequence number saying which lap of the ring it is ready
+ *      for. A producer claims a slot by advancing the write index with a
+ *      compare-and-swap once the slot's sequence shows it is empty, constructs the
+ *      item, then publishes it by bumping the sequence; consumers mirror this with
+ *      the read index. The two indices live on separate cache lines. Batch
+ *      operations claim a run of consecutive slots with a single compare-and-swap.
+ *
+ *      The capacity is rounded up to a power of two and fixed at creation; push
+ *      returns false rather than growing when the queue is full. When there is only
+ *      one producer and one consumer, wsSPSCQueue is cheaper.
+ *
+ *      Usage:
+ *        wsMPMCQueue<wsTask*>* myTasks = wsNew(wsMPMCQueue<wsTask*>, wsMPMCQueue<wsTask*>(1024));
+ *        myTasks->push(myTask);                //  Any thread
+ *        if (myTasks->pop(myTask)) { ... }     //  Any thread
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MPMC_QUEUE_H_
+#define WS_MPMC_QUEUE_H_
+
+#include "wsMemoryStack.h"
+#include <atomic>
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
+template <class ClassType>
+class wsMPMCQueue {
+  protected:
+    struct _ws_mpmc_cell {
+      std::atomic<u32> sequence;
+      alignas(ClassType) u8 storage[sizeof(ClassType)];
+      ClassType* get() { return (ClassType*)storage; }
+    };
+    struct _ws_mpmc_indices {
+      alignas(WS_CACHE_LINE_SIZE) std::atomic<u32> writeIndex;
+      alignas(WS_CACHE_LINE_SIZE) std::atomic<u32> readIndex;
+    };
+    _ws_mpmc_indices* indices;
+    _ws_mpmc_cell* cells;
+    u32 mask;
+    //  Claims up to numWanted consecutive slots for writing; returns the first index in *first
+    u32 claimWritable(u32 numWanted, u32* first);
+    //  Claims up to numWanted consecutive items for reading; returns the first index in *first
+    u32 claimReadable(u32 numWanted, u32* first);
+  public:
+    /*  Constructor */
+    wsMPMCQueue(u32 minElements = 64,
+                wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
+    /*  Accessors   */
+    u32 getCapacity() const { return mask + 1; }
+    //  Exact only when no thread is using the queue; otherwise a snapshot
+    u32 getLength() const {
+      i32 length = (i32)(indices->writeIndex.load(std::memory_order_acquire) -
+                          indices->readIndex.load(std::memory_order_acquire));
+      return (length > 0) ? (u32)length : 0;
+    }
+    bool isEmpty() const { return (getLength() == 0); }
+    /*  Operational Methods */
+    //  Each returns false, leaving the queue untouched, if there is no room
+    bool push(const ClassType& object);
+    bool push(ClassType&& object);
+    template <class... Args>
+    bool emplace(Args&&... args);
+    //  Copies up to numItems items and returns the number pushed. The pushed items are
+    //  consecutive in the queue, but may be interleaved with other batches.
+    u32 pushBatch(const ClassType* items, u32 numItems);
+    //  Moves the front item into myItem; returns false if the queue is empty
+    bool pop(ClassType& myItem);
+    //  Moves up to maxItems consecutive items into items and returns the number popped
+    u32 popBatch(ClassType* items, u32 maxItems);
+};
+
+/*  Member Functions for wsMPMCQueue  */
+//  Constructor
+template <class ClassType>
+wsMPMCQueue<ClassType>::wsMPMCQueue(u32 minElements, wsMemoryStack::_ws_memstack_tier myTier) {
+  wsAssert((minElements > 1), "wsMPMCQueue must have room for more than 1 element.");
+  u32 capacity = 2;
+  while (capacity < minElements) { capacity <<= 1; }
+  mask = capacity - 1;
+  u32 cellsOffset = (sizeof(_ws_mpmc_indices) + WS_CACHE_LINE_SIZE - 1) & ~(WS_CACHE_LINE_SIZE - 1);
+  u8* block = (u8*)wsMem.allocatePrimaryAligned(cellsOffset + sizeof(_ws_mpmc_cell)*capacity,
+                                                WS_CACHE_LINE_SIZE, myTier);
+  wsAssert((block != NULL), "Could not allocate wsMPMCQueue storage.");
+  indices = new (block) _ws_mpmc_indices();
+  indices->writeIndex.store(0, std::memory_order_relaxed);
+  indices->readIndex.store(0, std::memory_order_relaxed);
+  cells = (_ws_mpmc_cell*)(block + cellsOffset);
+  //  A slot is ready for the producer of index i when its sequence equals i
+  for (u32 i = 0; i < capacity; ++i) {
+    new (&cells[i].sequence) std::atomic<u32>(i);
+  }
+}
+
+template <class ClassType>
+u32 wsMPMCQueue<ClassType>::claimWritable(u32 numWanted, u32* first) {
+  u32 write = indices->writeIndex.load(std::memory_order_relaxed);
+  while (true) {
+    //  Count the empty slots in a row starting at the write index
+    u32 numFree = 0;
+    i32 diff = 0;
+    while (numFree < numWanted) {
+      u32 seq = cells[(write + numFree) & mask].sequence.load(std::memory_order_acquire);
+      diff = (i32)(seq - (write + numFree));
+      if (diff != 0) { break; }
+      ++numFree;
+    }
+    if (numFree == 0 && diff < 0) {
+      return 0; //  The slot still holds an item from the previous lap: the queue is full
+    }
+    if (numFree > 0 &&
+        indices->writeIndex.compare_exchange_weak(write, write + numFree,
+                                                  std::memory_order_relaxed)) {
+      *first = write;
+      return numFree;
+    }
+    //  Another producer moved the index; compare_exchange reloaded it, but a
+    //  slot that was merely ahead of us needs a fresh read
+    if (numFree == 0) {
+      write = indices->writeIndex.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <class ClassType>
+u32 wsMPMCQueue<ClassType>::claimReadable(u32 numWanted, u32* first) {
+  u32 read = indices->readIndex.load(std::memory_order_relaxed);
+  while (true) {
+    //  Count the published items in a row starting at the read index
+    u32 numReady = 0;
+    i32 diff = 0;
+    while (numReady < numWanted) {
+      u32 seq = cells[(read + numReady) & mask].sequence.load(std::memory_order_acquire);
+      diff = (i32)(seq - (read + numReady + 1));
+      if (diff != 0) { break; }
+      ++numReady;
+    }
+    if (numReady == 0 && diff < 0) {
+      return 0; //  The slot has not been written this lap: the queue is empty
+    }
+    if (numReady > 0 &&
+        indices->readIndex.compare_exchange_weak(read, read + numReady,
+                                                 std::memory_order_relaxed)) {
+      *first = read;
+      return numReady;
+    }
+    if (numReady == 0) {
+      read = indices->readIndex.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <class ClassType>
+bool wsMPMCQueue<ClassType>::push(const ClassType& object) {
+  return emplace(object);
+}
+
+template <class ClassType>
+bool wsMPMCQueue<ClassType>::push(ClassType&& object) {
+  return emplace(std::move(object));
+}
+
+template <class ClassType>
+template <class... Args>
+bool wsMPMCQueue<ClassType>::emplace(Args&&... args) {
+  u32 write;
+  if (claimWritable(1, &write) == 0) { return false; }
+  _ws_mpmc_cell* cell = &cells[write & mask];
+  new (cell->storage) ClassType(std::forward<Args>(args)...);
+  cell->sequence.store(write + 1, std::memory_order_release);
+  return true;
+}
+
+template <class ClassType>
+u32 wsMPMCQueue<ClassType>::pushBatch(const ClassType* items, u32 numItems) {
+  if (numItems == 0) { return 0; }
+  u32 write;
+  u32 numPushed = claimWritable(numItems, &write);
+  for (u32 i = 0; i < numPushed; ++i) {
+    _ws_mpmc_cell* cell = &cells[(write + i) & mask];
+    new (cell->storage) ClassType(items[i]);
+    cell->sequence.store(write + i + 1, std::memory_order_release);
+  }
+  return numPushed;
+}
+
+template <class ClassType>
+bool wsMPMCQueue<ClassType>::pop(ClassType& myItem) {
+  u32 read;
+  if (claimReadable(1, &read) == 0) { return false; }
+  _ws_mpmc_cell* cell = &cells[read & mask];
+  myItem = std::move(*cell->get());
+  cell->get()->~ClassType();
+  //  Ready the slot for the producer one lap ahead
+  cell->sequence.store(read + mask + 1, std::memory_order_release);
+  return true;
+}
+
+template <class ClassType>
+u32 wsMPMCQueue<ClassType>::popBatch(ClassType* items, u32 maxItems) {
+  if (maxItems == 0) { return 0; }
+  u32 read;
+  u32 numPopped = claimReadable(maxItems, &read);
+  for (u32 i = 0; i < numPopped; ++i) {
+    _ws_mpmc_cell* cell = &cells[(read + i) & mask];
+    items[i] = std::move(*cell->get());
+    cell->get()->~ClassType();
+    cell->sequence.store(read + i + mask + 1, std::memory_order_release);
+  }
+  return numPopped;
+}
+
+#endif  /*  WS_MPMC_QUEUE_H_ */
@@ -0,0 +1,132 @@
+/*
+ * wsMappedFile.cpp
+ *
+ *    This file implements the class wsMappedFile.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsMappedFile.h"
+#include "wsLog.h"
+#include "wsVirtualFS.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WS_OS_FAMILY_UNIX
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+bool wsMappedFile::open(const char* filepath) {
+  if (wsVFS.isInitialized() && wsVFS.open(this, filepath)) { return true; }
+  return openLoose(filepath);
+}
+
+bool wsMappedFile::openLoose(const char* filepath, bool randomAccess) {
+  close();
+  #ifdef WS_OS_FAMILY_UNIX
+    i32 fd = ::open(filepath, O_RDONLY);
+    if (fd < 0) {
+      wsEcho(WS_LOG_ERROR, "Could not open file \"%s\"", filepath);
+      return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      ::close(fd);
+      wsEcho(WS_LOG_ERROR, "Could not read the size of file \"%s\"", filepath);
+      return false;
+    }
+    size = (u64)info.st_size;
+    if (size == 0) {
+      //  mmap(...) refuses empty files; an empty string serves just as well
+      ::close(fd);
+      data = "";
+      storage = WS_FILE_VIEW;
+      return true;
+    }
+    //  No page of a shared mapping ever becomes a private copy, so every process mapping
+    //  the same file reads the one copy of it in the page cache
+    void* view = mmap(WS_NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    //  The mapping holds its own reference to the file
+    ::close(fd);
+    if (view != MAP_FAILED) {
+      //  Most files are about to be read whole, from front to back
+      madvise(view, size, randomAccess ? MADV_RANDOM : MADV_SEQUENTIAL);
+      data = (const char*)view;
+      storage = WS_FILE_MAPPED;
+      return true;
+    }
+  #endif
+  FILE* pFile = fopen(filepath, "rb");
+  if (pFile == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Could not open file \"%s\"", filepath);
+    return false;
+  }
+  fseek(pFile, 0, SEEK_END);
+  size = (u64)ftell(pFile);
+  fseek(pFile, 0, SEEK_SET);
+  char* buffer = (char*)malloc(size + 1);
+  wsAssert(buffer, "Could not allocate a buffer for the file.");
+  size = fread(buffer, 1, size, pFile);
+  buffer[size] = '\0';
+  fclose(pFile);
+  data = buffer;
+  storage = WS_FILE_BUFFER;
+  return true;
+}
+
+void wsMappedFile::openBuffer(const char* myData, u64 mySize, bool owned) {
+  close();
+  data = myData;
+  size = mySize;
+  storage = owned ? WS_FILE_BUFFER : WS_FILE_VIEW;
+}
+
+void wsMappedFile::close() {
+  if (data == WS_NULL) { return; }
+  if (storage == WS_FILE_MAPPED) {
+    #ifdef WS_OS_FAMILY_UNIX
+      munmap((void*)data, size);
+    #endif
+  }
+  else if (storage == WS_FILE_BUFFER) {
+    free((void*)data);
+  }
+  data = WS_NULL;
+  size = 0;
+  storage = WS_FILE_VIEW;
+}
+
+void wsMappedFile::prefetch(u64 offset, u64 numBytes) const {
+  #ifdef WS_OS_FAMILY_UNIX
+    if (storage != WS_FILE_MAPPED || offset >= size) { return; }
+    //  madvise(...) takes whole pages
+    const u64 pageSize = (u64)sysconf(_SC_PAGESIZE);
+    const u64 first = offset & ~(pageSize-1);
+    numBytes = ((numBytes < size - offset) ? numBytes : size - offset) + (offset - first);
+    madvise((void*)(data + first), numBytes, MADV_WILLNEED);
+  #endif
+}
@@ -0,0 +1,89 @@
+/*
+ * wsMappedFile.h
+ *
+ *    This file declares the class wsMappedFile, a read-only view of a whole file.
+ *
+ *    On Unix-like systems the file is mapped into memory rather than read, so opening
+ *    it costs no copying and pages are loaded only as they are touched. Elsewhere the
+ *    file is read into a buffer of its own. Either way the contents stay valid until
+ *    the wsMappedFile is closed or destroyed. Mappings are shared, so any number of
+ *    engine processes reading one file hold a single physical copy of it; a file which
+ *    may be mapped must be replaced by renaming a new one over it, never rewritten.
+ *
+ *    Files in a pack mounted on wsVFS are served from the pack before the loose file
+ *    is tried: stored entries as a view of the pack's own mapping, and compressed ones
+ *    through a buffer they are expanded into.
+ *
+ *    Usage:
+ *      wsMappedFile file;
+ *      if (file.open("models/Griswald.wsMesh")) {
+ *        parse(file.getData(), file.getSize());
+ *      }
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_MAPPED_FILE_H_
+#define WS_MAPPED_FILE_H_
+
+#include "wsPlatform.h"
+
+//  How a wsMappedFile holds its data, and so how it lets go of it
+enum {
+  WS_FILE_VIEW,   //  Memory owned elsewhere, such as a mounted pack
+  WS_FILE_BUFFER, //  A buffer from malloc(...)
+  WS_FILE_MAPPED  //  A mapping of the file
+};
+
+class wsMappedFile {
+  private:
+    const char* data;
+    u64 size;
+    u32 storage;
+    //  Not copyable; the mapping has a single owner
+    wsMappedFile(const wsMappedFile&);
+    wsMappedFile& operator=(const wsMappedFile&);
+  public:
+    wsMappedFile() : data(WS_NULL), size(0), storage(WS_FILE_VIEW) {}
+    ~wsMappedFile() { close(); }
+    //  Returns false, leaving the file closed, if it cannot be opened
+    bool open(const char* filepath);
+    //  Opens the file on disk, passing over mounted packs. A file read at random, such
+    //  as a pack, is not read ahead.
+    bool openLoose(const char* filepath, bool randomAccess = false);
+    //  Serves a block of memory as the file's contents. An owned block came from
+    //  malloc(...) and is freed when the file is closed.
+    void openBuffer(const char* myData, u64 mySize, bool owned);
+    void close();
+    //  Hints that a range is about to be read, so its pages load ahead of time
+    void prefetch(u64 offset, u64 numBytes) const;
+    const char* getData() const { return data; }
+    const char* getEnd() const { return data + size; }
+    u64 getSize() const { return size; }
+    bool isOpen() const { return (data != WS_NULL); }
+    //  True if the file lies in memory it does not own, such as a stored entry of a pack
+    bool isView() const { return (storage == WS_FILE_VIEW); }
+};
+
+#endif /* WS_MAPPED_FILE_H_ */
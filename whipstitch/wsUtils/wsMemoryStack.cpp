@@ -83,14 +83,27 @@
 
 wsMemoryStack wsMem;
 
+//  Holds a spin lock for as long as it is in scope. Primary allocations are rare and
+//  take only a few instructions, so spinning is cheaper than sleeping.
+class wsSpinLockGuard {
+    private:
+        std::atomic_flag& flag;
+    public:
+        wsSpinLockGuard(std::atomic_flag& myFlag) : flag(myFlag) {
+            while (flag.test_and_set(std::memory_order_acquire)) {}
+        }
+        ~wsSpinLockGuard() { flag.clear(std::memory_order_release); }
+};
+
 /*  Define the startUp(...) function for this Engine Subsystem  */
 void wsMemoryStack::startUp(const u64 numBytes_primaryStack,
                             const u32 numBytes_frameStack) {
     //  Sets our custom function as the new handler
     std::set_new_handler( wsNewHandler );
     //  Store the number of bytes requested for the Primary and Frame Stacks
-    mPrimaryStackSize = numBytes_primaryStack;
-    mFrameStackSize = numBytes_frameStack;
+    //  Sizes are rounded down so that the Rear tier and the Frame Stack begin aligned
+    mPrimaryStackSize = numBytes_primaryStack & ~(u64)(WS_MEMORY_ALIGNMENT - 1);
+    mFrameStackSize = numBytes_frameStack & ~(u32)(WS_MEMORY_ALIGNMENT - 1);
     //  Log the data
     wsEcho(WS_LOG_MEMORY,    "Initializing Memory Stack\n    Primary Stack Size = %u\n"
                             "    Frame Stack Size = %u\n",
@@ -148,12 +161,28 @@ void wsMemoryStack::shutDown() {
 
 //  Allocate memory from the current tier of the Primary Stack; return its memory address.
 void* wsMemoryStack::allocatePrimary(const u32 numBytes) {
+    return allocatePrimary(numBytes, mCurrentPrimaryTier);
+}
+
+//  Allocate memory from the given tier of the Primary Stack; return its memory address.
+void* wsMemoryStack::allocatePrimary(const u32 numBytes, const _ws_memstack_tier tier) {
+    //  Rounding every block up keeps every address on the stack aligned
+    const u32 alignedBytes = wsAlignSize(numBytes);
     wsEcho(WS_LOG_MEMORY, "Allocating %u bytes\n", numBytes);
     wsAssert(mPrimaryStackSize, "Has the Primary Stack been initialized?");
+    wsSpinLockGuard lock(mPrimaryLock);
     void* memAddress;
-    switch (mCurrentPrimaryTier) {
+    switch (tier) {
         case PRIMARY_GLOBAL:
-            if (mGlobalMarker + numBytes > mRearMarker) {
+            //  Global allocations are placed directly behind the Front tier, so they
+            //  would overwrite any Front tier allocations still in use.
+            if (mFrontMarker != mGlobalMarker) {
+                wsEcho(  (WS_LOG_MEMORY | WS_LOG_ERROR),
+                        "Cannot allocate %u bytes to Primary Global Stack\n"
+                        "  The Front tier is in use.\n", numBytes);
+                return (void*)NULL;
+            }
+            if (mGlobalMarker + alignedBytes > mRearMarker) {
                 wsEcho(  (WS_LOG_MEMORY | WS_LOG_ERROR),
                         "Cannot allocate %u bytes to Primary Global Stack\n"
                         "  GlobalMarker = %u, RearMarker = %u\n",
@@ -162,27 +191,27 @@ void* wsMemoryStack::allocatePrimary(const u32 numBytes) {
             }
             wsAssert((mGlobalMarker < mPrimaryStackSize),"Invalid Primary Stack marker.\n");
             memAddress = &mPrimaryStackBytes[mGlobalMarker];
-            mFrontMarker = mGlobalMarker += numBytes;
+            mFrontMarker = mGlobalMarker += alignedBytes;
             break;
         case PRIMARY_REAR:
-            if (mRearMarker - numBytes < mFrontMarker) {
+            if (mRearMarker - alignedBytes < mFrontMarker) {
                 wsEcho(  (WS_LOG_MEMORY | WS_LOG_ERROR),
                         "Cannot allocate %u bytes to Primary Rear Stack\n", numBytes);
                 return (void*)NULL;
             }
-            mRearMarker -= numBytes;
+            mRearMarker -= alignedBytes;
             wsAssert((mRearMarker < mPrimaryStackSize), "Invalid Primary Stack marker.\n");
             memAddress = &mPrimaryStackBytes[mRearMarker];
             break;
         case PRIMARY_FRONT:
-            if (mFrontMarker + numBytes > mRearMarker) {
+            if (mFrontMarker + alignedBytes > mRearMarker) {
                 wsEcho(  (WS_LOG_MEMORY | WS_LOG_ERROR),
                         "Cannot allocate %u bytes to Primary Front Stack\n", numBytes);
                 return (void*)NULL;
             }
             wsAssert((mFrontMarker < mPrimaryStackSize), "Invalid Primary Stack marker.\n");
             memAddress = &mPrimaryStackBytes[mFrontMarker];
-            mFrontMarker += numBytes;
+            mFrontMarker += alignedBytes;
             break;
         default:
             wsEcho((WS_LOG_MEMORY | WS_LOG_ERROR), "Unsupported value for Primary tier.\n");
@@ -193,6 +222,53 @@ void* wsMemoryStack::allocatePrimary(const u32 numBytes) {
     return memAddress;
 }
 
+//  Allocate memory from the given tier of the Primary Stack, aligned to a power of two.
+//  Over-allocates by alignment-1 bytes and returns the first aligned address in the block.
+void* wsMemoryStack::allocatePrimaryAligned(const u32 numBytes, const u32 alignment,
+                                            const _ws_memstack_tier tier) {
+    wsAssert((alignment != 0 && (alignment & (alignment-1)) == 0),
+            "Alignment must be a power of two.");
+    u8* memAddress = (u8*)allocatePrimary(numBytes + alignment - 1, tier);
+    if (memAddress == NULL) {
+        return (void*)NULL;
+    }
+    return (void*)(((uintptr_t)memAddress + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+//  Grow the most recent allocation of the Global or Front tier without moving it.
+//  The Rear tier grows downward, so its allocations can never be extended in place.
+bool wsMemoryStack::extendPrimary(void* memAddress, const u32 numBytes, const u32 newNumBytes,
+                                    const _ws_memstack_tier tier) {
+    wsAssert(mPrimaryStackSize, "Has the Primary Stack been initialized?");
+    if (memAddress == NULL || newNumBytes < numBytes) {
+        return false;
+    }
+    u8* blockEnd = (u8*)memAddress + wsAlignSize(numBytes);
+    u32 extraBytes = wsAlignSize(newNumBytes) - wsAlignSize(numBytes);
+    wsSpinLockGuard lock(mPrimaryLock);
+    switch (tier) {
+        case PRIMARY_GLOBAL:
+            if (mFrontMarker != mGlobalMarker ||
+                blockEnd != &mPrimaryStackBytes[mGlobalMarker] ||
+                mGlobalMarker + extraBytes > mRearMarker) {
+                return false;
+            }
+            mFrontMarker = mGlobalMarker += extraBytes;
+            break;
+        case PRIMARY_FRONT:
+            if (blockEnd != &mPrimaryStackBytes[mFrontMarker] ||
+                mFrontMarker + extraBytes > mRearMarker) {
+                return false;
+            }
+            mFrontMarker += extraBytes;
+            break;
+        default:
+            return false;
+    }
+    wsEcho(WS_LOG_MEMORY, "Extended allocation by %u bytes\n", extraBytes);
+    return true;
+}
+
 //  Completely clear the Primary Memory Stack
 void wsMemoryStack::clearPrimaryStack() {
     wsEcho(WS_LOG_MEMORY, "Clearing Primary Stack.\n");
@@ -237,27 +313,28 @@ void wsMemoryStack::setTier(_ws_memstack_tier myTier) {
 
 //  Allocate Memory from the Current tier of the Frame Stack; return its address
 void* wsMemoryStack::allocateFrame_current(u32 numBytes) {
+    const u32 alignedBytes = wsAlignSize(numBytes);
     wsEcho(WS_LOG_MEMORY, "Allocating %u bytes for the current frame\n");
     wsAssert(mFrameStackSize, "Has the Frame Stack been initialized?");
     void* memAddress;
     switch (mCurrentFrameTier) {
         case FRAME_FRONT:
-            if (mFrontMarker_f + numBytes > mRearMarker_f) {
+            if (mFrontMarker_f + alignedBytes > mRearMarker_f) {
                 wsEcho((WS_LOG_MEMORY | WS_LOG_ERROR),
                                 "Cannot allocate %u bytes to Frame Stack.\n", numBytes);
                 return NULL;
             }
             wsAssert((mFrontMarker_f < mFrameStackSize), "Invalid Frame Stack Marker\n");
             memAddress = &mFrameStackBytes[mFrontMarker_f];
-            mFrontMarker_f += numBytes;
+            mFrontMarker_f += alignedBytes;
             break;
         case FRAME_REAR:
-            if (mRearMarker_f - numBytes < mFrontMarker_f) {
+            if (mRearMarker_f - alignedBytes < mFrontMarker_f) {
                 wsEcho((WS_LOG_MEMORY | WS_LOG_ERROR),
                                 "Cannot allocate %u bytes to Frame Stack.\n", numBytes);
                 return NULL;
             }
-            mRearMarker_f -= numBytes;
+            mRearMarker_f -= alignedBytes;
             wsAssert((mRearMarker_f < mFrameStackSize), "Invalid Frame Stack Marker\n");
             memAddress = &mFrameStackBytes[mRearMarker_f];
             break;
@@ -271,6 +348,7 @@ void* wsMemoryStack::allocateFrame_current(u32 numBytes) {
 //  Allocate memory from the tier of the Frame stack opposite to the current tier.
 //  Return its address.
 void* wsMemoryStack::allocateFrame_next(u32 numBytes) {
+    const u32 alignedBytes = wsAlignSize(numBytes);
     wsEcho(WS_LOG_MEMORY, "Allocating %u bytes for the current frame\n");
     wsAssert(mFrameStackSize, "Has the Frame Stack been initialized?");
     void* memAddress;
@@ -278,24 +356,24 @@ void* wsMemoryStack::allocateFrame_next(u32 numBytes) {
         case FRAME_REAR:
             //  If the current tier is the back end of the frame stack, we'll operate
             //  on the front end.
-            if (mFrontMarker_f + numBytes > mRearMarker_f) {
+            if (mFrontMarker_f + alignedBytes > mRearMarker_f) {
                 wsEcho((WS_LOG_MEMORY | WS_LOG_ERROR),
                                 "Cannot allocate %u bytes to Frame Stack.\n", numBytes);
                 return NULL;
             }
             wsAssert((mFrontMarker_f < mFrameStackSize), "Invalid Frame Stack Marker\n");
             memAddress = &mFrameStackBytes[mFrontMarker_f];
-            mFrontMarker_f += numBytes;
+            mFrontMarker_f += alignedBytes;
             break;
         case FRAME_FRONT:
             //  If the current tier is the front end of the frame stack, we'll operate
             //  on the back end.
-            if (mRearMarker_f - numBytes < mFrontMarker_f) {
+            if (mRearMarker_f - alignedBytes < mFrontMarker_f) {
                 wsEcho((WS_LOG_MEMORY | WS_LOG_ERROR),
                                 "Cannot allocate %u bytes to Frame Stack.\n", numBytes);
                 return NULL;
             }
-            mRearMarker_f -= numBytes;
+            mRearMarker_f -= alignedBytes;
             wsAssert((mRearMarker_f < mFrameStackSize), "Invalid Frame Stack Marker\n");
             memAddress = &mFrameStackBytes[mRearMarker_f];
             break;
@@ -52,6 +52,10 @@
  *                            ^                     ^
  *                      mFrontMarker_f        mRearMarker_f
  *
+ *      Allocations from the Primary Stack may be made from any thread, so assets can be
+ *          parsed away from the main thread. The Frame Stack, and freeing or changing
+ *          the tiers of the Primary Stack, remain the business of the main thread alone.
+ *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
  *
@@ -81,6 +85,17 @@
 
 #include "wsPlatform.h"
 #include "wsLog.h"
+#include <atomic>
+
+//  Every stack allocation begins on a multiple of this many bytes, which lets SIMD
+//  types such as vec4 and mat4 live in stack-allocated objects
+#define WS_MEMORY_ALIGNMENT 16
+inline u32 wsAlignSize(u32 numBytes) {
+    return (numBytes + WS_MEMORY_ALIGNMENT - 1) & ~(u32)(WS_MEMORY_ALIGNMENT - 1);
+}
+//  The most bytes one stack allocation can ask for; sizes are counted in u32, and
+//  aligned up without wrapping
+#define WS_MAX_STACK_ALLOCATION (0xFFFFFFFFu & ~(u32)(WS_MEMORY_ALIGNMENT - 1))
 
 /// Shortcuts for Primary Stack Allocations
 //  Used to pass custom constructors into the macro
@@ -114,7 +129,7 @@ class wsMemoryStack {
         //  As an engine subsystem, the memory stack takes no action until explicitly
         //  initialized via the startUp(...) function.
         //  uninitialized via the shutDown() function.
-        wsMemoryStack() {}
+        wsMemoryStack() { mPrimaryLock.clear(); }
         ~wsMemoryStack() {}
         /*  Accessors  */
         _ws_memstack_tier getCurrentTier() const { return mCurrentPrimaryTier; }
@@ -133,10 +148,21 @@ class wsMemoryStack {
         void* allocateFrame_next(const u32 numBytes);
         //  Allocate space in the Primary Stack and return a pointer to the memory
         void* allocatePrimary(const u32 numBytes);
+        //  Allocate space in the given tier of the Primary Stack and return a pointer to
+        //  the memory, regardless of the current tier
+        void* allocatePrimary(const u32 numBytes, const _ws_memstack_tier tier);
+        //  Allocate space in the given tier of the Primary Stack, starting on a multiple of
+        //  alignment bytes (a power of two)
+        void* allocatePrimaryAligned(const u32 numBytes, const u32 alignment,
+                                      const _ws_memstack_tier tier);
         //  Clear both ends of the Frame Stack
         void clearFrameStack();
         //  Clear both ends of the Primary Stack
         void clearPrimaryStack();
+        //  Grows an allocation in place if it is the most recent allocation on its tier.
+        //  Returns false if the block could not be grown, in which case it is untouched.
+        bool extendPrimary(void* memAddress, const u32 numBytes, const u32 newNumBytes,
+                            const _ws_memstack_tier tier);
         //  Free the Front end of the Primary Stack back to the Global Tier
         void freePrimaryFront();
         //  Free the Rear end of the Primary Stack
@@ -172,6 +198,8 @@ class wsMemoryStack {
         //  Current tiers used by their respective stacks
         _ws_memstack_tier mCurrentPrimaryTier;
         _ws_memstack_frame_tier mCurrentFrameTier;
+        //  Held while the Primary Stack markers change
+        std::atomic_flag mPrimaryLock;
 };
 
 extern wsMemoryStack wsMem;
@@ -0,0 +1,95 @@
+/*
+ * wsNameTable.cpp
+ *
+ *    This file implements the class wsNameTable and a singleton instance of the class,
+ *    wsNames, for the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsNameTable.h"
+#include <string.h> //  For strlen(), strcmp()
+
+wsNameTable wsNames;
+
+void wsNameTable::startUp(u32 numNames) {
+  wsEcho(WS_LOG_UTIL, "Starting up Name Table\n");
+  handles = wsNew(wsHashMap<u32>, wsHashMap<u32>(numNames));
+  hashes = wsNew(wsArray<u32>, wsArray<u32>(numNames + 1));
+  hashes->push(WS_NULL);  //  Handle zero is reserved
+  #ifndef NDEBUG
+    names = wsNew(wsArray<const char*>, wsArray<const char*>(numNames + 1));
+    names->push("");
+  #endif
+  _mInitialized = true;
+}
+
+void wsNameTable::shutDown() {
+  wsEcho(WS_LOG_UTIL, "Shutting down Name Table\n");
+  _mInitialized = false;
+}
+
+const char* wsNameTable::getName(wsNameHandle handle) const {
+  wsAssert(_mInitialized, "Initialize the Name Table first.");
+  #ifndef NDEBUG
+    wsAssert((handle.index < names->getLength()), "Invalid name handle.");
+    return (*names)[handle.index];
+  #else
+    return "(name unavailable)";
+  #endif
+}
+
+wsNameHandle wsNameTable::intern(const char* name) {
+  wsAssert(_mInitialized, "Initialize the Name Table first.");
+  u32 hash = wsHash(name);
+  u32* index = handles->find(hash);
+  if (index != NULL) {
+    #ifndef NDEBUG
+      if (strcmp((*names)[*index], name)) {
+        wsEcho((WS_LOG_UTIL | WS_LOG_ERROR), "Names \"%s\" and \"%s\" have the same hash (%u)\n",
+                (*names)[*index], name, hash);
+      }
+    #endif
+    return wsNameHandle(*index);
+  }
+  u32 newIndex = hashes->getLength();
+  hashes->push(hash);
+  handles->insert(hash, newIndex);
+  #ifndef NDEBUG
+    u32 length = strlen(name);
+    char* copy = (char*)wsMem.allocatePrimary(length + 1, hashes->getTier());
+    memcpy(copy, name, length + 1);
+    names->push(copy);
+  #endif
+  return wsNameHandle(newIndex);
+}
+
+wsNameHandle wsNameTable::find(const char* name) const {
+  wsAssert(_mInitialized, "Initialize the Name Table first.");
+  u32 index;
+  if (handles->retrieve(wsHash(name), index)) {
+    return wsNameHandle(index);
+  }
+  return wsNameHandle();
+}
@@ -0,0 +1,101 @@
+/*
+ * wsNameTable.h
+ *
+ *    This file declares the class wsNameTable and a singleton instance of the class,
+ *    wsNames, for the Whipstitch Game Engine.
+ *
+ *    The name table interns strings such as model, animation, and joint names. Each
+ *    distinct name is given a wsNameHandle, a small integer which never changes for
+ *    the life of the program. Looking a handle up is a single array access, so calls
+ *    made every frame can identify an object by handle without any string work.
+ *
+ *    In debug builds the table also keeps a copy of each string, so that a handle can
+ *    be turned back into a readable name for logging.
+ *
+ *    Usage:
+ *      wsNameHandle hero = wsNames.intern("Hero");
+ *      myScene->moveModel(hero, vec4(0.0f, 0.0f, 1.0f));
+ *      wsEcho(WS_LOG_MAIN, "Moved %s\n", wsNames.getName(hero));
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_NAME_TABLE_H_
+#define WS_NAME_TABLE_H_
+
+#include "wsHashMap.h"
+#include "wsArray.h"
+
+#define WS_DEFAULT_NUM_NAMES 256
+
+//  Index into the name table; index zero (WS_NULL) names nothing
+struct wsNameHandle {
+  u32 index;
+  wsNameHandle() : index(WS_NULL) {}
+  explicit wsNameHandle(u32 myIndex) : index(myIndex) {}
+  bool isValid() const { return (index != WS_NULL); }
+  bool operator==(const wsNameHandle& other) const { return (index == other.index); }
+  bool operator!=(const wsNameHandle& other) const { return (index != other.index); }
+};
+
+class wsNameTable {
+  private:
+    //  Maps the hash of each name to its handle
+    wsHashMap<u32>* handles;
+    //  Hash of each name, indexed by handle
+    wsArray<u32>* hashes;
+    #ifndef NDEBUG
+      //  Copy of each name, indexed by handle
+      wsArray<const char*>* names;
+    #endif
+    //  True only when the startUp function has been called
+    bool _mInitialized;
+  public:
+    /*  Empty Constructor and Destructor   */
+    //  As an engine subsystem, the name table takes no action until explicitly
+    //  initialized via the startUp(...) function.
+    wsNameTable() : _mInitialized(false) {}
+    ~wsNameTable() {}
+    /*  Startup and shutdown functions  */
+    void startUp(u32 numNames = WS_DEFAULT_NUM_NAMES);
+    void shutDown();
+    /*  Accessors   */
+    //  Returns the hash of the named string, the same value wsHash(...) gives
+    u32 getHash(wsNameHandle handle) const {
+      wsAssert((handle.index < hashes->getLength()), "Invalid name handle.");
+      return (*hashes)[handle.index];
+    }
+    //  Returns the interned string in debug builds, or a placeholder in release builds
+    const char* getName(wsNameHandle handle) const;
+    u32 getNumNames() const { return hashes->getLength() - 1; }
+    /*  Operational Methods */
+    //  Returns the handle for the name, adding it to the table if it is new
+    wsNameHandle intern(const char* name);
+    //  Returns the handle for the name, or an invalid handle if it has not been interned
+    wsNameHandle find(const char* name) const;
+};
+
+extern wsNameTable wsNames;
+
+#endif /* WS_NAME_TABLE_H_ */
@@ -31,13 +31,22 @@
 #include "wsOperations.h"
 #include "wsTrig.h"
 #include <stdlib.h>
-#include <string.h> //  For strlen()
+#include <string.h>  //  For memcpy()
+#if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+  #include <nmmintrin.h>  //  SSE4.2 CRC32 instructions
+#endif
 
 f32 wsScreenWidth = 1280;
 f32 wsScreenHeight = 720;
 
 u32 wsCRC32HashFuncTable[256];
 bool wsCRC32HashTableGenerated = false;
+bool wsCRC32HardwareSupported = false;
+//  Buffers are hashed as three interleaved lanes of this many bytes, which are then
+//  joined by shifting the earlier lanes' CRCs forward with these multipliers
+#define WS_CRC32_LANE_BYTES 4096
+u32 wsCRC32ShiftOneLane;
+u32 wsCRC32ShiftTwoLanes;
 
 bool isPositive(f32 myFloat) { //  integer sign tests often run more quickly
     WS_PROFILE();
@@ -126,108 +135,211 @@ void wsBuildCRC32HashTable() {
         }
         wsCRC32HashFuncTable[i] = tableVal;
     }
+    //  Running the CRC over zero bytes from x^0 yields the multiplier for that distance
+    u32 shift = 0x80000000;
+    for (u32 i = 0; i < WS_CRC32_LANE_BYTES; ++i) {
+        shift = (shift >> 8) ^ wsCRC32HashFuncTable[shift & 0xFF];
+    }
+    wsCRC32ShiftOneLane = shift;
+    for (u32 i = 0; i < WS_CRC32_LANE_BYTES; ++i) {
+        shift = (shift >> 8) ^ wsCRC32HashFuncTable[shift & 0xFF];
+    }
+    wsCRC32ShiftTwoLanes = shift;
+    #if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+        __builtin_cpu_init();
+        wsCRC32HardwareSupported = (__builtin_cpu_supports("sse4.2") != 0);
+    #endif
+    wsEcho(WS_LOG_UTIL, "CRC-32C hashing: %s\n",
+            wsCRC32HardwareSupported ? "SSE4.2 hardware" : "lookup table");
     wsCRC32HashTableGenerated = true;
 
 }
 
-u32 wsHash(const char* myString) {
-    wsAssert(wsCRC32HashTableGenerated, "Did you forget wsInit() at startup?");
-    WS_PROFILE();
-    u32 my = 0;
-    u32 length = strlen(myString);
-    for (u32 c = 0; c < length; ++c) {
-        my = (my >> 8) ^ wsCRC32HashFuncTable[ (my & 0xFF) ^ myString[c] ];
+//  Multiplies two polynomials modulo the CRC polynomial (bit-reflected, so x^0 is the high bit)
+static u32 wsCRC32MultiplyMod(u32 a, u32 b) {
+    u32 product = 0;
+    for (u32 m = 0x80000000; m != 0; m >>= 1) {
+        if (a & m) {
+            product ^= b;
+        }
+        b = (b & 1) ? (WS_CRC32_POLYNOMIAL ^ (b >> 1)) : (b >> 1);
     }
+    return product;
+}
 
+static u32 wsHashBytes_table(const u8* data, u64 numBytes, u32 my) {
+    for (u64 i = 0; i < numBytes; ++i) {
+        my = (my >> 8) ^ wsCRC32HashFuncTable[ (my & 0xFF) ^ data[i] ];
+    }
     return my;
 }
 
-//  Random number generation:
-//  Mersenne Twister algorithm
-//  The mersenne twister algorithm uses bitwise operations rather than multiplication,
-//  which many other generators rely upon. This gives it quite a bit more speed. It also
-//  happens to have a reasonable spread and a long period.
-#define WS_MERSENNE_TWISTER_SIZE 624
-u32 ws_mt_array[WS_MERSENNE_TWISTER_SIZE];
-u32 ws_mt_index = 0;
-//  Saving the initial seed will allow us to replicate results later on.
-//  It is therefore not recommended to reinitialize the randomizer unless there
-//  is a specific reason for doing so (e.g., restarting the game)
-u32 wsInitialRandomSeed = 0;
-//  This initializes the randomizer with a special seed.
-void wsInitRandomizer(u32 seed) {
-    WS_PROFILE();
-    wsEcho(WS_LOG_UTIL, "Initial Random Seed: %u\n", seed);
-    wsInitialRandomSeed = seed;
-    ws_mt_array[0] = seed;
-    for (i32 i = 1; i < WS_MERSENNE_TWISTER_SIZE; ++i) {
-        ws_mt_array[i] = 0x6C078965 * ((ws_mt_array[i-1] ^ (ws_mt_array[i-1] >> 30)) + i);
+#if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+  #define WS_TARGET_SSE42 __attribute__((target("sse4.2")))
+  //  The widest word the crc32 instruction accepts on this architecture
+  #if WS_CURRENT_ARCHITECTURE == WS_ARCH_AMD64
+    typedef u64 __attribute__((may_alias)) ws_crc32_word;
+    #define ws_crc32Word(crc, word) ((u32)_mm_crc32_u64((crc), (word)))
+    #define WS_CRC32_WORD_ONES 0x0101010101010101ULL
+  #else
+    typedef u32 __attribute__((may_alias)) ws_crc32_word;
+    #define ws_crc32Word(crc, word) _mm_crc32_u32((crc), (word))
+    #define WS_CRC32_WORD_ONES 0x01010101UL
+  #endif
+
+  WS_TARGET_SSE42
+  static u32 wsHashBytes_sse42(const u8* data, u64 numBytes, u32 my) {
+    ws_crc32_word word[3];
+    //  Each crc32 instruction depends on the last, so three independent lanes keep the
+    //  unit busy across its latency
+    while (numBytes >= 3*WS_CRC32_LANE_BYTES) {
+        u32 crcA = my, crcB = 0, crcC = 0;
+        for (u32 i = 0; i < WS_CRC32_LANE_BYTES; i += sizeof(ws_crc32_word)) {
+            memcpy(&word[0], data + i, sizeof(ws_crc32_word));
+            memcpy(&word[1], data + WS_CRC32_LANE_BYTES + i, sizeof(ws_crc32_word));
+            memcpy(&word[2], data + 2*WS_CRC32_LANE_BYTES + i, sizeof(ws_crc32_word));
+            crcA = ws_crc32Word(crcA, word[0]);
+            crcB = ws_crc32Word(crcB, word[1]);
+            crcC = ws_crc32Word(crcC, word[2]);
+        }
+        my = wsCRC32MultiplyMod(wsCRC32ShiftTwoLanes, crcA) ^
+             wsCRC32MultiplyMod(wsCRC32ShiftOneLane, crcB) ^ crcC;
+        data += 3*WS_CRC32_LANE_BYTES;
+        numBytes -= 3*WS_CRC32_LANE_BYTES;
+    }
+    for (; numBytes >= sizeof(ws_crc32_word); numBytes -= sizeof(ws_crc32_word)) {
+        memcpy(&word[0], data, sizeof(ws_crc32_word));
+        my = ws_crc32Word(my, word[0]);
+        data += sizeof(ws_crc32_word);
     }
+    for (; numBytes > 0; --numBytes) {
+        my = _mm_crc32_u8(my, *data++);
+    }
+    return my;
+  }
+
+  WS_TARGET_SSE42
+  static u32 wsHashString_sse42(const u8* c, u32 my) {
+    //  Step single bytes up to a word boundary. An aligned word never straddles a page,
+    //  so reading the whole word holding the terminator cannot fault.
+    for (; ((uintptr_t)c & (sizeof(ws_crc32_word)-1)) != 0; ++c) {
+        if (*c == '\0') { return my; }
+        my = _mm_crc32_u8(my, *c);
+    }
+    for (;;) {
+        ws_crc32_word word = *(const ws_crc32_word*)c;
+        //  Stop at the first word containing a zero byte
+        if ((word - WS_CRC32_WORD_ONES) & ~word & (WS_CRC32_WORD_ONES * 0x80)) { break; }
+        my = ws_crc32Word(my, word);
+        c += sizeof(ws_crc32_word);
+    }
+    for (; *c != '\0'; ++c) {
+        my = _mm_crc32_u8(my, *c);
+    }
+    return my;
+  }
+#endif
 
+u32 wsHash(const char* myString) {
+    return wsHash(myString, 0);
 }
-//  This produces a bitwise conversion from float to unsigned integer, speeding up
-//  and further randomizing any potential floating-point seeds. These are very likely,
-//  incidentally, as many implementations (including ours) use time, in seconds, to
-//  seed the randomizer.
-void wsInitRandomizer(f32 seed) {
-    WS_PROFILE();
-    u_f_hybrid mybrid(seed);
-    wsInitRandomizer(mybrid.u);
 
-}
-//  Generates an array of numbers for use by the mersenne twister algorithm
-void wsGenRandoms() {
+u32 wsHash(const char* myString, u32 prevHash) {
+    wsAssert(wsCRC32HashTableGenerated, "Did you forget wsInit() at startup?");
     WS_PROFILE();
-    for (u32 i = 0; i < WS_MERSENNE_TWISTER_SIZE; ++i) {
-        i32 iPlusOne = (i+1) % WS_MERSENNE_TWISTER_SIZE;
-        i32 x = (((ws_mt_array[i] & 0x80000000) |
-                (ws_mt_array[iPlusOne] & 0x7FFFFFFF)) >> 1) ^
-                ((ws_mt_array[iPlusOne] & 1) ? 0x9908B0DF : 0x00000000);
-        if (x%2 != 0) { //  if x is odd
-            ws_mt_array[i] = ws_mt_array[i] ^ 0x9908B0DF;
+    #if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+        if (wsCRC32HardwareSupported) {
+            return wsHashString_sse42((const u8*)myString, prevHash);
         }
+    #endif
+    u32 my = prevHash;
+    //  Bytes are read unsigned so that names outside of ASCII index the table correctly
+    for (const u8* c = (const u8*)myString; *c != '\0'; ++c) {
+        my = (my >> 8) ^ wsCRC32HashFuncTable[ (my & 0xFF) ^ *c ];
     }
 
+    return my;
 }
-u32 wsRand() {
+
+u32 wsHashBuffer(const void* data, u64 numBytes, u32 prevHash) {
+    wsAssert(wsCRC32HashTableGenerated, "Did you forget wsInit() at startup?");
     WS_PROFILE();
-    if (ws_mt_index == 0) {
-        wsGenRandoms();
-    }
-    i32 my = ws_mt_array[ws_mt_index];
-    my = my ^ (my >> 11);
-    my = my ^ ((my << 7) & 0x9D2C5680);
-    my = my ^ ((my << 15) & 0xEFC60000);
-    my = my ^ (my >> 18);
-    ws_mt_index = (ws_mt_index+1) % WS_MERSENNE_TWISTER_SIZE;
+    #if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+        if (wsCRC32HardwareSupported) {
+            return wsHashBytes_sse42((const u8*)data, numBytes, prevHash);
+        }
+    #endif
+    return wsHashBytes_table((const u8*)data, numBytes, prevHash);
+}
 
-    return my;
+#define WS_XXH64_PRIME1 11400714785074694791ULL
+#define WS_XXH64_PRIME2 14029467366897019727ULL
+#define WS_XXH64_PRIME3 1609587929392839161ULL
+#define WS_XXH64_PRIME4 9650029242287828579ULL
+#define WS_XXH64_PRIME5 2870177450012600261ULL
+
+static inline u64 wsRotateLeft64(u64 x, u32 bits) {
+    return (x << bits) | (x >> (64 - bits));
 }
-i32 wsRandomInt(i32 min, i32 max) {
-    WS_PROFILE();
-    if (min > max) {
-        i32 tmp = min;
-        min = max;
-        max = tmp;
-    }
-    else if (min == max) {
-        return max;
-    }
-    return (wsRand() % (max-min+1) + min);
+
+static inline u64 wsXXH64Round(u64 acc, u64 input) {
+    acc += input * WS_XXH64_PRIME2;
+    return wsRotateLeft64(acc, 31) * WS_XXH64_PRIME1;
+}
+
+static inline u64 wsXXH64Merge(u64 acc, u64 lane) {
+    acc ^= wsXXH64Round(0, lane);
+    return acc * WS_XXH64_PRIME1 + WS_XXH64_PRIME4;
 }
 
-f32 wsRandomFloat(f32 min, f32 max, f32 precision) {
+u64 wsHashBuffer64(const void* data, u64 numBytes, u64 seed) {
     WS_PROFILE();
-    if (min > max) {
-        f32 tmp = min;
-        min = max;
-        max = tmp;
+    const u8* p = (const u8*)data;
+    const u8* end = p + numBytes;
+    u64 word;
+    u32 half;
+    u64 my;
+    if (numBytes >= 32) {
+        //  Four independent lanes of 8 bytes each
+        u64 lanes[4] = {  seed + WS_XXH64_PRIME1 + WS_XXH64_PRIME2, seed + WS_XXH64_PRIME2,
+                          seed, seed - WS_XXH64_PRIME1 };
+        for (; p + 32 <= end; p += 32) {
+            for (u32 l = 0; l < 4; ++l) {
+                memcpy(&word, p + l*8, 8);
+                lanes[l] = wsXXH64Round(lanes[l], word);
+            }
+        }
+        my = wsRotateLeft64(lanes[0], 1) + wsRotateLeft64(lanes[1], 7) +
+             wsRotateLeft64(lanes[2], 12) + wsRotateLeft64(lanes[3], 18);
+        for (u32 l = 0; l < 4; ++l) {
+            my = wsXXH64Merge(my, lanes[l]);
+        }
+    }
+    else {
+        my = seed + WS_XXH64_PRIME5;
+    }
+    my += numBytes;
+    for (; p + 8 <= end; p += 8) {
+        memcpy(&word, p, 8);
+        my ^= wsXXH64Round(0, word);
+        my = wsRotateLeft64(my, 27) * WS_XXH64_PRIME1 + WS_XXH64_PRIME4;
     }
-    else if (min == max) {
-        return max;
+    if (p + 4 <= end) {
+        memcpy(&half, p, 4);
+        my ^= (u64)half * WS_XXH64_PRIME1;
+        my = wsRotateLeft64(my, 23) * WS_XXH64_PRIME2 + WS_XXH64_PRIME3;
+        p += 4;
     }
-    i32 steps = (max - min) / precision;
-    return min + (f32)(wsRand() % (steps+1)) * precision;
+    for (; p < end; ++p) {
+        my ^= (*p) * WS_XXH64_PRIME5;
+        my = wsRotateLeft64(my, 11) * WS_XXH64_PRIME1;
+    }
+    my ^= my >> 33;
+    my *= WS_XXH64_PRIME2;
+    my ^= my >> 29;
+    my *= WS_XXH64_PRIME3;
+    my ^= my >> 32;
+    return my;
 }
 
 f32 wsBlendFactor(f32 start, f32 mid, f32 end) {
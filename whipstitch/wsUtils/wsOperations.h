@@ -6,17 +6,15 @@
  *
  *      This file declares various common numerical operations, optimizing
  *      wherever able. Trigonometric functions are confined to their own
- *      files, but random numbers and square root / absolute value operations
- *      are dealt with here. Wherever possible, SSE2 operations are used for
- *      speed.
+ *      files, and random numbers are generated in wsRandom.h, but square root /
+ *      absolute value operations are dealt with here. Wherever possible, SSE2
+ *      operations are used for speed.
  *
  *      Temporary variables are also declared to be used for any functions
  *      which desire them, avoiding the allocation overhead otherwise
  *      required for mathematical operations. These should be used sparingly
  *      where multi-threading might be performed.
  *
- *      Random number generation is performed using the Mersenne Twister algorithm
- *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
  *
@@ -48,8 +46,12 @@
 #include "wsProfiling.h"
 #include <math.h>
 
-#if WS_SUPPORTS_SSE4 == WS_TRUE
-  #include <smmintrin.h>
+#if WS_SUPPORTS_SSE == WS_TRUE
+  #if WS_SUPPORTS_SSE4 == WS_TRUE
+    #include <smmintrin.h>
+  #else
+    #include <emmintrin.h>
+  #endif
 
   //  Macros for shuffling SSE register values
   //  Shuffles x,y,z,w values across the register
@@ -73,6 +75,26 @@
   //  Multiply-and-Add instruction (multiply a and b, then add to c)
   #define ws_sseMadd(a, b, c) \
       _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+  //  Sum of the x, y and z products of a and b, copied into every element
+  inline __m128 ws_sseDot3(__m128 a, __m128 b) {
+    #if WS_SUPPORTS_SSE4 == WS_TRUE
+      return _mm_dp_ps(a, b, 0x7F);
+    #else
+      __m128 prod = _mm_mul_ps(a, b);
+      __m128 sum = _mm_add_ps(ws_sseDistributeX(prod), ws_sseDistributeY(prod));
+      return _mm_add_ps(sum, ws_sseDistributeZ(prod));
+    #endif
+  }
+  //  Sum of all four products of a and b, copied into every element
+  inline __m128 ws_sseDot4(__m128 a, __m128 b) {
+    #if WS_SUPPORTS_SSE4 == WS_TRUE
+      return _mm_dp_ps(a, b, 0xFF);
+    #else
+      __m128 prod = _mm_mul_ps(a, b);
+      __m128 sum = _mm_add_ps(prod, ws_sseShuffle(prod, 1, 0, 3, 2));
+      return _mm_add_ps(sum, ws_sseShuffle(sum, 2, 3, 0, 1));
+    #endif
+  }
 
   //  Macro to align data types for SIMD Registers
   #ifdef _MSC_VER //  For Visual Studio
@@ -80,13 +102,24 @@
   #else //  For everything else
     #define sseAlign(X) X __attribute__((aligned(16)))
   #endif
-#endif  /* WS_SUPPORTS_SSE4 */
+#endif  /* WS_SUPPORTS_SSE */
+
+//  AVX2 kernels are built with a target attribute wherever the compiler can dispatch
+//  on the processor at runtime, so the rest of the build needs no AVX2 flags
+#if WS_SUPPORTS_SSE == WS_TRUE && WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+  #include <immintrin.h>
+  #define WS_SIMD_AVX2_KERNELS  WS_TRUE
+  #define WS_TARGET_AVX2  __attribute__((target("avx2,fma")))
+#else
+  #define WS_SIMD_AVX2_KERNELS  WS_FALSE
+#endif
 
 extern f32 wsScreenWidth;
 extern f32 wsScreenHeight;
 
 extern u32 wsCRC32HashFuncTable[256];
 extern bool wsCRC32HashTableGenerated;
+extern bool wsCRC32HardwareSupported;  //  Set by wsBuildCRC32HashTable() if SSE4.2 is present
 #define WS_CRC32_POLYNOMIAL 0x82F63B78  //  CRC-32C Reversed order representation
 #define WS_PRIME_TABLE_SIZE 128
 extern u32 wsPrimeTable[WS_PRIME_TABLE_SIZE];   //  Stores the first 128 prime numbers, beginning with 2.
@@ -107,12 +140,33 @@ u32 wsMin(u32 a, u32 b);
 void wsBuildCRC32HashTable();
 u32 wsHash(f32 myFloat);
 u32 wsHash(const char* myString);
-//  Random Numbers
-void wsInitRandomizer(f32 seed);
-void wsGenRandoms();
-u32 wsRand();
-i32 wsRandomInt(i32 min, i32 max);
-f32 wsRandomFloat(f32 min, f32 max, f32 precision = 0.000001f);
+//  Continues a string hash; wsHash(b, wsHash(a)) equals the hash of a and b concatenated
+u32 wsHash(const char* myString, u32 prevHash);
+//  Hashes an arbitrary block of memory, such as the contents of an asset file. The
+//  result matches wsHash() over the same bytes, so buffers may be hashed in pieces.
+u32 wsHashBuffer(const void* data, u64 numBytes, u32 prevHash = 0);
+//  64-bit hash of a block of memory, for content keys across many files, where 32 bits
+//  would collide too often. Computes XXH64, so results match other tools.
+u64 wsHashBuffer64(const void* data, u64 numBytes, u64 seed = 0);
+//  Mixes two hashes into a single key; unlike string concatenation, order matters
+inline u32 wsHashCombine(u32 a, u32 b) {
+    return a ^ (b + 0x9E3779B9 + (a << 6) + (a >> 2));
+}
+//  CRC-32 string hash which may be evaluated at compile time. The result matches
+//  wsHash(const char*) for the same string.
+constexpr u32 wsHashConst(const char* myString, u32 prevHash = 0) {
+    for (; *myString != '\0'; ++myString) {
+        prevHash ^= (u8)*myString;
+        for (u32 j = 0; j < 8; ++j) {
+            prevHash = (prevHash & 1) ? (WS_CRC32_POLYNOMIAL ^ (prevHash >> 1)) : (prevHash >> 1);
+        }
+    }
+    return prevHash;
+}
+//  Forces the hash of a string literal to be computed by the compiler
+template <u32 hashVal>
+struct wsHashConstant { static const u32 value = hashVal; };
+#define WS_HASH(literal) (wsHashConstant<wsHashConst(literal)>::value)
 //  Interpolations Algorithms
 f32 wsBlendFactor(f32 start, f32 mid, f32 end); //  Determines a blend factor based on the three points given.
 f32 wsLerp(f32 a, f32 b, f32 blendFactor);  //  Linear Interpolation
@@ -155,12 +209,20 @@ inline f64 wsEndianSwap(f64 val) {
 
 //  Prime numbers are important for efficient hashmaps
 inline u32 wsNextPrime(u32 val) {
-    for (int i = 0; i <= WS_PRIME_TABLE_SIZE; ++i) {
+    for (int i = 0; i < WS_PRIME_TABLE_SIZE; ++i) {
         if (val <= wsPrimeTable[i]) {
             return wsPrimeTable[i];
         }
     }
-    return 27644437;    //  Sufficiently high, I hope...
+    //  Beyond the table, search odd numbers by trial division
+    val |= 1;
+    for (;; val += 2) {
+        bool isPrime = true;
+        for (u32 d = 3; d*d <= val; d += 2) {
+            if (val % d == 0) { isPrime = false; break; }
+        }
+        if (isPrime) { return val; }
+    }
 }
 
 #endif /* WS_OPERATIONS_H_ */
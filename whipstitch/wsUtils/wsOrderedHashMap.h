@@ -11,8 +11,12 @@
  *
  *      Hashes are produced using the wsHash function declared in wsOperations.h.
  *      The hashed u32 integer is then modulated to accommodate the table size
- *      declared with the map. This table size represents the maximum number of elements
- *      allowed in the hash map.
+ *      declared with the map. This table size is only the initial capacity; when an
+ *      element cannot be placed, the table is rehashed into a larger prime-sized array
+ *      taken from the same Primary Stack tier.
+ *
+ *      As with wsHashMap, elements are constructed in place and iterators hand back
+ *      references, so any element type may be used.
  *
  *      Quatratic probing is used to handle collisions and preferred hash table sizes
  *      are therefore prime numbers.
@@ -24,6 +28,10 @@
  *              myMap->insert(wsHash(myString), myObjectType, 10);
  *          Retrieve the objects for use using the method retrieve(u32)
  *              myObjectType newObj = myMap->retrieve(wsHash(myString));
+ *          Visit every object in order using an iterator
+ *              for (wsOrderedHashMap<myObjectType>::iterator it = myMap->begin(); it.isValid(); ++it) {
+ *                  it->doSomething();
+ *              }
  *
  *
  *  This software is provided under the terms of the MIT license
@@ -55,6 +63,8 @@
 
 #include "wsMemoryStack.h"
 #include "wsOperations.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
 
 template <class ClassType>
 class wsOrderedHashMap {
@@ -66,6 +76,7 @@ class wsOrderedHashMap {
       i32 next;
       i32 prev;
       i32 order;  //  Order in which the hashkey pair should be iterated through
+      //  Only constructed while hashKey is not WS_NULL
       ClassType object;
     };
     ws_OrderedHashKeyPair* array;
@@ -75,6 +86,18 @@ class wsOrderedHashMap {
     //  A value less than zero indicates no item exists
     i32 first;
     i32 last;
+    wsMemoryStack::_ws_memstack_tier tier;
+    //  Reserves an index for the key, growing the table as needed; the element is left
+    //  unconstructed. Returns a negative value if the key is already present.
+    i32 claimIndex(u32 hashIndex, u32 orderPos);
+    //  Returns the array index holding the key, or a negative value if there is none
+    i32 findIndex(u32 hashIndex) const;
+    //  Rehashes every element into a table roughly twice the size
+    void grow();
+    //  Places an occupied index into the linked list according to its order
+    void linkIndex(u32 index);
+    //  Takes an occupied index out of the linked list
+    void unlinkIndex(u32 index);
   public:
     struct iterator {
       /*  Member Variable */
@@ -82,23 +105,29 @@ class wsOrderedHashMap {
       wsOrderedHashMap<ClassType>* parent;
       /*  Member Functions  */
       iterator(wsOrderedHashMap<ClassType>* myParent); //  Constructor
+      //  True while the iterator refers to an element of the hashmap
+      bool isValid() const { return (mCurrentElement >= 0); }
+      bool hasNext() const { return (parent->array[mCurrentElement].next >= 0); }
+      bool hasPrev() const { return (parent->array[mCurrentElement].prev >= 0); }
       //  Retrieve the item from the hashmap
-      ClassType get();
-      //  Return the next item in the hashmap
-      ClassType getNext();
-      //  Return the previous item in the hashmap
-      ClassType getPrev();
+      ClassType& get() const { return parent->array[mCurrentElement].object; }
+      ClassType& operator*() const { return get(); }
+      ClassType* operator->() const { return &get(); }
+      //  Retrieve the hash key of the current item
+      u32 getKey() const { return parent->array[mCurrentElement].hashKey; }
       //  Go to the next item in the hashmap
-      ClassType operator++();  //  preincrement operator
+      iterator& operator++();  //  preincrement operator
       //  Go to the previous item in the hashmap
-      ClassType operator--();  //  predecrement operator
+      iterator& operator--();  //  predecrement operator
     };
     /*  Constructor and Destructor */
-    wsOrderedHashMap(u32 maxElements = 53);
+    wsOrderedHashMap(u32 maxElements = 53,
+                     wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
     /*  Accessors   */
+    bool contains(u32 hashIndex) const { return (findIndex(hashIndex) >= 0); }
     u32 getMaxElements() { return maxElements; }
     u32 getLength() { return length; }
-    const ClassType getArrayItem(u32 arrayIndex) { return array[arrayIndex].object; }
+    ClassType& getArrayItem(u32 arrayIndex) { return array[arrayIndex].object; }
     bool isEmpty() { return (length == 0); }
     bool isFull() { return (length == maxElements); }
     /*  Operational Methods */
@@ -106,8 +135,14 @@ class wsOrderedHashMap {
     wsOrderedHashMap::iterator begin();
     //  Returns an iterator containing the last object in the table
     wsOrderedHashMap::iterator end();
+    //  Constructs the element in place at the given index
+    template <class... Args>
+    u32 emplace(u32 hashIndex, u32 orderPos, Args&&... args);
+    //  Returns the address of the element at the given index, or NULL if there is none
+    ClassType* find(u32 hashIndex);
     //  Inserts the element into the hashmap at the given index
     u32 insert(u32 hashIndex, const ClassType& element, u32 orderPos = 0);
+    u32 insert(u32 hashIndex, ClassType&& element, u32 orderPos = 0);
     //  Prints the components of the hashMap using wsLog
     void print(u16 printLog = WS_LOG_MAIN);
     //  Removes the element from the hashmap at the given index
@@ -129,51 +164,155 @@ class wsOrderedHashMap {
   }
 
   template <class ClassType>
-  inline ClassType wsOrderedHashMap<ClassType>::iterator::get() {
-    if (mCurrentElement < 0 || (u32)mCurrentElement >= parent->maxElements) {
-      return WS_NULL;
-    }
-    return parent->array[mCurrentElement].object;
-  }
-
-  template <class ClassType>
-  inline ClassType wsOrderedHashMap<ClassType>::iterator::getNext() {
-    if (parent->array[mCurrentElement].next < 0) { return WS_NULL; }   //  There is no next element
-    return parent->array[ parent->array[mCurrentElement].next ].object;
-  }
-
-  template <class ClassType>
-  inline ClassType wsOrderedHashMap<ClassType>::iterator::getPrev() {
-    if (parent->array[mCurrentElement].prev < 0) { return WS_NULL; }
-    return parent->array[ parent->array[mCurrentElement].prev ].object;
-  }
-
-  template <class ClassType>
-  inline ClassType wsOrderedHashMap<ClassType>::iterator::operator++() {
+  inline typename wsOrderedHashMap<ClassType>::iterator& wsOrderedHashMap<ClassType>::iterator::operator++() {
     mCurrentElement = parent->array[mCurrentElement].next;
-    return parent->array[ mCurrentElement ].object;
+    return *this;
   }
 
   template <class ClassType>
-  inline ClassType wsOrderedHashMap<ClassType>::iterator::operator--() {
-    mCurrentElement = parent->array[mCurrentElement].next;
-    return parent->array[ mCurrentElement ].object;
+  inline typename wsOrderedHashMap<ClassType>::iterator& wsOrderedHashMap<ClassType>::iterator::operator--() {
+    mCurrentElement = parent->array[mCurrentElement].prev;
+    return *this;
   }
 
 /*  Member Functions for wsOrderedHashMap  */
 //  Constructor
 template <class ClassType>
-wsOrderedHashMap<ClassType>::wsOrderedHashMap(u32 maxElements) {
+wsOrderedHashMap<ClassType>::wsOrderedHashMap(u32 maxElements, wsMemoryStack::_ws_memstack_tier myTier) {
   maxElements = wsNextPrime(maxElements);
   wsEcho(WS_LOG_UTIL, "Creating %u element ordered hashmap\n", maxElements);
   wsAssert((maxElements > 0), "wsOrderedHashMap must have more than 0 elements.");
   length = 0;
   this->maxElements = maxElements;
-  array = wsNewArray(ws_OrderedHashKeyPair, maxElements);
+  tier = myTier;
+  array = (ws_OrderedHashKeyPair*)wsMem.allocatePrimary(sizeof(ws_OrderedHashKeyPair)*maxElements, tier);
+  wsAssert((array != NULL), "Could not allocate ordered hashmap storage.");
+  for (u32 i = 0; i < maxElements; ++i) {
+    array[i].hashKey = WS_NULL;
+  }
+  first = last = -1;
+}
+
+//  Protected Methods
+
+template <class ClassType>
+i32 wsOrderedHashMap<ClassType>::claimIndex(u32 hashIndex, u32 orderPos) {
+  if (length == maxElements) {  //  The hashMap is full already
+    grow();
+  }
+  u32 moddedHash = hashIndex % maxElements;
+  u32 probeCount = 0, offset = 1;
+  //  Loop for quadratic probing
+  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
+      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
+      probeCount < maxElements/2) {   //  probe half of the elements
+    ++probeCount;
+    moddedHash += offset;
+    moddedHash %= maxElements;
+    offset += 2;
+  }
+  if (array[moddedHash].hashKey == WS_NULL) { //  The index is free
+    array[moddedHash].hashKey = hashIndex;
+    array[moddedHash].order = orderPos;
+    ++length;
+    linkIndex(moddedHash);
+    return moddedHash;
+  }
+  if (array[moddedHash].hashKey == hashIndex) {
+    wsEcho(WS_LOG_UTIL, "Cannot enter duplicate key into ordered hash map.\n");
+    return -1;
+  }
+  //  Quadratic probing found no free index; make room and try again
+  grow();
+  return claimIndex(hashIndex, orderPos);
+}
+
+template <class ClassType>
+i32 wsOrderedHashMap<ClassType>::findIndex(u32 hashIndex) const {
+  u32 moddedHash = hashIndex % maxElements;
+  //  Loop for quadratic probing
+  u32 probeCount = 0, offset = 1;
+  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
+      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
+      probeCount < maxElements/2) {   //  probe half of the elements
+    ++probeCount;
+    moddedHash += offset;
+    moddedHash %= maxElements;
+    offset += 2;
+  }
+  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
+    return moddedHash;
+  }
+  return -1;
+}
+
+template <class ClassType>
+void wsOrderedHashMap<ClassType>::grow() {
+  ws_OrderedHashKeyPair* oldArray = array;
+  i32 current = first;
+  u32 oldMaxElements = maxElements;
+  maxElements = wsNextPrime(oldMaxElements*2 + 1);
+  wsEcho(WS_LOG_UTIL, "Growing ordered hashmap from %u to %u elements\n", oldMaxElements, maxElements);
+  array = (ws_OrderedHashKeyPair*)wsMem.allocatePrimary(sizeof(ws_OrderedHashKeyPair)*maxElements, tier);
+  wsAssert((array != NULL), "Could not grow ordered hashmap storage.");
   for (u32 i = 0; i < maxElements; ++i) {
     array[i].hashKey = WS_NULL;
   }
+  length = 0;
   first = last = -1;
+  //  Walking the old list in order keeps elements of equal order in the same sequence
+  while (current >= 0) {
+    ClassType& object = oldArray[current].object;
+    i32 index = claimIndex(oldArray[current].hashKey, oldArray[current].order);
+    new (&array[index].object) ClassType(std::move(object));
+    object.~ClassType();
+    current = oldArray[current].next;
+  }
+}
+
+template <class ClassType>
+void wsOrderedHashMap<ClassType>::linkIndex(u32 index) {
+  if (first < 0) {  //  The list is empty
+    first = last = index;
+    array[index].next = array[index].prev = -1;
+  }
+  else if (array[index].order < array[first].order) { //  This is now the first element
+    array[index].next = first;
+    array[index].prev = -1;
+    first = array[first].prev = index;
+  }
+  else if (array[index].order >= array[last].order) {  //  This is now the last element
+    array[index].prev = last;
+    last = array[last].next = index;
+    array[index].next = -1;
+  }
+  else {
+    //  Elements of equal order are kept in the sequence they were linked
+    i32 current = first;
+    while (array[index].order >= array[current].order) {
+      current = array[current].next;
+    }
+    wsAssert(current >= 0, "Ordered Hash - invalid value!");
+    array[index].prev = array[current].prev;
+    array[index].next = current;
+    array[ array[index].prev ].next = array[current].prev = index;
+  }
+}
+
+template <class ClassType>
+void wsOrderedHashMap<ClassType>::unlinkIndex(u32 index) {
+  if (array[index].prev >= 0) {
+    array[ array[index].prev ].next = array[index].next;
+  }
+  else {
+    first = array[index].next;
+  }
+  if (array[index].next >= 0) {
+    array[ array[index].next ].prev = array[index].prev;
+  }
+  else {
+    last = array[index].prev;
+  }
 }
 
 //  Operational Methods
@@ -193,74 +332,40 @@ typename wsOrderedHashMap<ClassType>::iterator wsOrderedHashMap<ClassType>::end(
   return it;
 }
 
+template <class ClassType>
+template <class... Args>
+u32 wsOrderedHashMap<ClassType>::emplace(u32 hashIndex, u32 orderPos, Args&&... args) {
+  i32 index = claimIndex(hashIndex, orderPos);
+  if (index < 0) { return WS_FAIL; }
+  new (&array[index].object) ClassType(std::forward<Args>(args)...);
+  return WS_SUCCESS;
+}
+
+template <class ClassType>
+ClassType* wsOrderedHashMap<ClassType>::find(u32 hashIndex) {
+  i32 index = findIndex(hashIndex);
+  if (index < 0) { return NULL; }
+  return &array[index].object;
+}
+
+//  An element which already lives in this table would move if the table grew, so it
+//  is copied aside first
 template <class ClassType>
 u32 wsOrderedHashMap<ClassType>::insert(u32 hashIndex, const ClassType& element, u32 orderPos) {
-  wsEcho(WS_LOG_UTIL, "Inserting item\n");
-  u32 moddedHash = hashIndex % maxElements;
-  if (length != maxElements) {  //  If the hashMap is not full already
-    u32 probeCount = 0, offset = 1;
-    //  Loop for quadratic probing
-    while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-        array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-        probeCount < maxElements/2) {   //  probe half of the elements
-      ++probeCount;
-      moddedHash += offset;
-      moddedHash %= maxElements;
-      offset += 2;
-    }
-    if (array[moddedHash].hashKey == WS_NULL) { //  The index is free
-      array[moddedHash].hashKey = hashIndex;
-      array[moddedHash].object = element;
-      array[moddedHash].order = orderPos;
-      ++length;
-      //  Update linked list
-      if (first < 0) {  //  The list is empty
-        first = last = moddedHash;
-        array[moddedHash].next = array[moddedHash].prev = -1;
-      }
-      else {
-        if (array[moddedHash].order <= array[first].order) { //  This is now the first element
-          array[moddedHash].next = first;
-          array[moddedHash].prev = -1;
-          first = array[first].prev = moddedHash;
-        }
-        else if (array[moddedHash].order >= array[last].order) {  //  This is now the last element
-          array[moddedHash].prev = last;
-          last = array[last].next = moddedHash;
-          array[moddedHash].next = -1;
-        }
-        else {
-          i32 current = first;
-          while (array[moddedHash].order > array[current].order) {
-            current = array[current].next;
-          }
-          wsAssert(current >= 0, "Ordered Hash - invalid value!");
-          array[moddedHash].prev = array[current].prev;
-          array[moddedHash].next = current;
-          array[ array[moddedHash].prev ].next = array[current].prev = moddedHash;
-        }
-      }
-    }
-    else {
-      if (array[moddedHash].hashKey == hashIndex) {
-        wsEcho(WS_LOG_UTIL, "Cannot enter duplicate key into ordered hash map.\n");
-        return WS_FAIL;
-      }
-      else {
-        wsEcho(WS_LOG_UTIL, "Could not insert element into ordered hash map.\n"
-                "  key = %u\n"
-                "  moddedHash = %u\n"
-                "  array[moddedHash].hashKey = %u\n",
-                hashIndex, moddedHash, array[moddedHash].hashKey);
-        return WS_FAIL;
-      }
-    }
+  if ((const void*)&element >= (const void*)array && (const void*)&element < (const void*)(array + maxElements)) {
+    ClassType tmp(element);
+    return emplace(hashIndex, orderPos, std::move(tmp));
   }
-  else {
-    wsEcho(WS_LOG_UTIL, "Ordered Hashmap is full.\n");
-    return WS_FAIL;
+  return emplace(hashIndex, orderPos, element);
+}
+
+template <class ClassType>
+u32 wsOrderedHashMap<ClassType>::insert(u32 hashIndex, ClassType&& element, u32 orderPos) {
+  if ((const void*)&element >= (const void*)array && (const void*)&element < (const void*)(array + maxElements)) {
+    ClassType tmp(std::move(element));
+    return emplace(hashIndex, orderPos, std::move(tmp));
   }
-  return WS_SUCCESS;
+  return emplace(hashIndex, orderPos, std::move(element));
 }
 
 template <class ClassType>
@@ -275,25 +380,11 @@ void wsOrderedHashMap<ClassType>::print(u16 printLog) {
 
 template <class ClassType>
 void wsOrderedHashMap<ClassType>::remove(u32 hashIndex) {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    if (array[moddedHash].prev >= 0) {
-      array[ array[moddedHash].prev ].next = array[moddedHash].next;
-    }
-    if (array[moddedHash].next >= 0) {
-      array[ array[moddedHash].next ].prev = array[moddedHash].prev;
-    }
-    array[moddedHash].hashKey = WS_NULL;
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    unlinkIndex(index);
+    array[index].object.~ClassType();
+    array[index].hashKey = WS_NULL;
     --length;
   }
   else {
@@ -303,100 +394,36 @@ void wsOrderedHashMap<ClassType>::remove(u32 hashIndex) {
 
 template <class ClassType>
 void wsOrderedHashMap<ClassType>::replace(u32 hashIndex, const ClassType& element, u32 orderPos) {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    array[moddedHash].object = element;
-    if (orderPos != array[moddedHash].order) {
-      array[moddedHash].order = orderPos;
-      //  Remove from linked list
-      if (array[moddedHash].prev >= 0) {
-        array[ array[moddedHash].prev ].next = array[moddedHash].next;
-      }
-      if (array[moddedHash].next >= 0) {
-        array[ array[moddedHash].next ].prev = array[moddedHash].prev;
-      }
-      //  Update linked list
-      if (first < 0) {  //  The list is empty
-        first = last = moddedHash;
-        array[moddedHash].next = array[moddedHash].prev = -1;
-      }
-      else {
-        if (array[moddedHash].order < array[first].order) { //  This is now the first element
-          array[moddedHash].next = first;
-          first = array[first].prev = moddedHash;
-          array[moddedHash].prev = -1;
-        }
-        else if (array[moddedHash].order > array[last].order) {  //  This is now the last element
-          array[moddedHash].prev = last;
-          last = array[last].next = moddedHash;
-          array[moddedHash].next = -1;
-        }
-        else {
-          i32 current = first;
-          while (array[moddedHash].order > array[current].order) {
-            current = array[current].next;
-          }
-          wsAssert(current >= 0, "Ordered Hash - invalid value!");
-          array[moddedHash].prev = array[current].prev;
-          array[moddedHash].next = current;
-          array[array[moddedHash].prev].next = array[current].prev = moddedHash;
-        }
-      }
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    array[index].object = element;
+    if ((i32)orderPos != array[index].order) {
+      unlinkIndex(index);
+      array[index].order = orderPos;
+      linkIndex(index);
     }
   }
   else {
     //wsEcho(WS_LOG_UTIL, "No suitable match found for hash key: %u\n", hashIndex);
-    insert(hashIndex, element);
+    insert(hashIndex, element, orderPos);
   }
 }
 
 template <class ClassType>
 const ClassType& wsOrderedHashMap<ClassType>::retrieve(u32 hashIndex) const {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    return array[moddedHash].object;
-  }
-  else {
+  i32 index = findIndex(hashIndex);
+  if (index < 0) {
     wsEcho(WS_LOG_UTIL, "No suitable match found for hash key: %u\n", hashIndex);
+    return array[hashIndex % maxElements].object;
   }
-  return array[moddedHash].object;
+  return array[index].object;
 }
 
 template <class ClassType>
 bool wsOrderedHashMap<ClassType>::retrieve(u32 hashIndex, ClassType& element) const {
-  u32 moddedHash = hashIndex % maxElements;
-  //  Loop for quadratic probing
-  u32 probeCount = 0, offset = 1;
-  while ( array[moddedHash].hashKey != WS_NULL &&  //  The Array index is taken
-      array[moddedHash].hashKey != hashIndex &&  //  The elements are not the same
-      probeCount < maxElements/2) {   //  probe half of the elements
-    ++probeCount;
-    moddedHash += offset;
-    moddedHash %= maxElements;
-    offset += 2;
-  }
-  if (array[moddedHash].hashKey == hashIndex) {   //  We have a match!
-    element = array[moddedHash].object;
+  i32 index = findIndex(hashIndex);
+  if (index >= 0) {   //  We have a match!
+    element = array[index].object;
     return true;
   }
   else {
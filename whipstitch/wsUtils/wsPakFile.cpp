@@ -0,0 +1,249 @@
+/*
+ * wsPakFile.cpp
+ *
+ *    This file implements the class wsPakFile and the pack writer.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsPakFile.h"
+#include "wsLog.h"
+#include "wsLZ4.h"
+#include "wsOperations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//  Compressed entries must save at least this share of their size, or they are stored
+#define WS_PAK_MIN_SAVINGS 8  //  One eighth
+
+static u64 wsPakAlign(u64 offset) {
+  return (offset + WS_PAK_ALIGNMENT-1) & ~(u64)(WS_PAK_ALIGNMENT-1);
+}
+
+const char* wsPakPath(const char* filepath) {
+  while (filepath[0] == '.' && filepath[1] == '/') {
+    filepath += 2;
+    while (*filepath == '/') { ++filepath; }
+  }
+  return filepath;
+}
+
+bool wsPakFile::open(const char* filepath) {
+  close();
+  if (!file.openLoose(filepath, true)) { return false; }
+  const char* data = file.getData();
+  const u64 size = file.getSize();
+  const wsPakHeader* myHeader = (const wsPakHeader*)data;
+  if (size < sizeof(wsPakHeader) || myHeader->magic != WS_PAK_MAGIC || myHeader->version != WS_PAK_VERSION) {
+    wsEcho(WS_LOG_ERROR, "\"%s\" is not a %s file of version %u", filepath, WS_PAK_EXTENSION, WS_PAK_VERSION);
+    file.close();
+    return false;
+  }
+  const u64 namesOffset = sizeof(wsPakHeader) + (u64)myHeader->numEntries*sizeof(wsPakEntry);
+  const u64 namesEnd = namesOffset + myHeader->namesSize;
+  const wsPakEntry* myEntries = (const wsPakEntry*)(data + sizeof(wsPakHeader));
+  const char* myNames = data + namesOffset;
+  bool valid = (namesEnd <= size && (myHeader->namesSize == 0 || myNames[myHeader->namesSize-1] == '\0'));
+  for (u32 i = 0; valid && i < myHeader->numEntries; ++i) {
+    const wsPakEntry& entry = myEntries[i];
+    valid = ( entry.offset <= size && entry.packedSize <= size - entry.offset &&
+              entry.pathOffset < myHeader->namesSize &&
+              ((entry.flags & WS_PAK_ENTRY_LZ4) || entry.packedSize == entry.size) &&
+              (i == 0 || myEntries[i-1].pathHash <= entry.pathHash));
+  }
+  if (!valid) {
+    wsEcho(WS_LOG_ERROR, "The table of contents of \"%s\" is corrupt", filepath);
+    file.close();
+    return false;
+  }
+  header = myHeader;
+  entries = myEntries;
+  names = myNames;
+  return true;
+}
+
+void wsPakFile::close() {
+  file.close();
+  header = WS_NULL;
+  entries = WS_NULL;
+  names = WS_NULL;
+}
+
+const wsPakEntry* wsPakFile::find(const char* filepath) const {
+  if (header == WS_NULL) { return WS_NULL; }
+  filepath = wsPakPath(filepath);
+  const u32 pathHash = wsHash(filepath);
+  //  Find the first entry with the hash, then check each path sharing it
+  u32 low = 0, high = header->numEntries;
+  while (low < high) {
+    const u32 mid = low + (high - low)/2;
+    if (entries[mid].pathHash < pathHash) { low = mid + 1; }
+    else { high = mid; }
+  }
+  for (; low < header->numEntries && entries[low].pathHash == pathHash; ++low) {
+    if (strcmp(names + entries[low].pathOffset, filepath) == 0) { return &entries[low]; }
+  }
+  return WS_NULL;
+}
+
+bool wsPakFile::read(wsMappedFile* dest, const wsPakEntry* entry) const {
+  const char* packed = file.getData() + entry->offset;
+  if (!(entry->flags & WS_PAK_ENTRY_LZ4)) {
+    //  Served straight from the mapping, and read ahead since it is wanted whole
+    file.prefetch(entry->offset, entry->size);
+    dest->openBuffer(packed, entry->size, false);
+    return true;
+  }
+  char* buffer = (char*)malloc(entry->size + 1);
+  wsAssert(buffer, "Could not allocate a buffer for the file.");
+  if (!wsLZ4Decompress((u8*)buffer, entry->size, (const u8*)packed, entry->packedSize) ||
+      wsHashBuffer64(buffer, entry->size) != entry->contentHash) {
+    wsEcho(WS_LOG_ERROR, "The packed file \"%s\" is corrupt", getPath(*entry));
+    free(buffer);
+    return false;
+  }
+  //  Terminated, as a file read into a buffer would be
+  buffer[entry->size] = '\0';
+  dest->openBuffer(buffer, entry->size, true);
+  return true;
+}
+
+/*  Pack Writer */
+
+struct wsPakRecord {
+  wsPakEntry entry;
+  const char* path;
+};
+
+static i32 wsCompareRecords(const void* a, const void* b) {
+  const wsPakRecord* recA = (const wsPakRecord*)a;
+  const wsPakRecord* recB = (const wsPakRecord*)b;
+  if (recA->entry.pathHash != recB->entry.pathHash) {
+    return (recA->entry.pathHash < recB->entry.pathHash) ? -1 : 1;
+  }
+  return strcmp(recA->path, recB->path);
+}
+
+static bool wsWritePadding(FILE* pFile, u64 numBytes) {
+  static const char zeros[WS_PAK_ALIGNMENT] = {};
+  return (fwrite(zeros, 1, numBytes, pFile) == numBytes);
+}
+
+bool wsWritePak(const char* destPath, const char* const* filepaths, u32 numFiles, bool compress, const bool* mapped) {
+  wsPakRecord* records = (wsPakRecord*)calloc(numFiles ? numFiles : 1, sizeof(wsPakRecord));
+  wsAssert(records, "Could not allocate the table of contents.");
+  wsPakHeader header;
+  header.magic = WS_PAK_MAGIC;
+  header.version = WS_PAK_VERSION;
+  header.numEntries = numFiles;
+  header.namesSize = 0;
+  for (u32 i = 0; i < numFiles; ++i) {
+    records[i].path = wsPakPath(filepaths[i]);
+    records[i].entry.pathHash = wsHash(records[i].path);
+    records[i].entry.pathOffset = header.namesSize;
+    header.namesSize += strlen(records[i].path) + 1;
+  }
+  //  Written beside the pack and renamed over it, as a running engine may have it mapped
+  char* tmpPath = (char*)malloc(strlen(destPath) + 5);
+  wsAssert(tmpPath, "Could not allocate the pack's temporary path.");
+  strcpy(tmpPath, destPath);
+  strcat(tmpPath, ".tmp");
+  FILE* pFile = fopen(tmpPath, "wb");
+  if (pFile == WS_NULL) {
+    wsEcho(WS_LOG_ERROR, "Could not open \"%s\" for writing", tmpPath);
+    free(records);
+    free(tmpPath);
+    return false;
+  }
+  //  The file contents come first, in the order given, so related files stay together
+  const u64 tableSize = sizeof(wsPakHeader) + (u64)numFiles*sizeof(wsPakEntry) + header.namesSize;
+  u64 offset = wsPakAlign(tableSize);
+  bool success = (fseek(pFile, (long)offset, SEEK_SET) == 0);
+  u64 totalSize = 0, totalPacked = 0;
+  for (u32 i = 0; success && i < numFiles; ++i) {
+    wsMappedFile source;
+    if (!source.openLoose(filepaths[i])) { success = false; break; }
+    wsPakEntry& entry = records[i].entry;
+    entry.offset = offset;
+    entry.size = source.getSize();
+    entry.packedSize = entry.size;
+    entry.contentHash = wsHashBuffer64(source.getData(), entry.size);
+    entry.flags = 0;
+    entry.reserved = 0;
+    const char* packed = source.getData();
+    u8* buffer = WS_NULL;
+    //  A file mapped in place must be stored, or each process would expand its own copy
+    if (compress && !(mapped && mapped[i]) && entry.size >= WS_PAK_MIN_SAVINGS && entry.size <= WS_LZ4_MAX_INPUT) {
+      buffer = (u8*)malloc(wsLZ4Bound(entry.size));
+      wsAssert(buffer, "Could not allocate a compression buffer.");
+      const u64 packedSize = wsLZ4Compress(buffer, (const u8*)source.getData(), entry.size);
+      if (packedSize <= entry.size - entry.size/WS_PAK_MIN_SAVINGS) {
+        entry.packedSize = packedSize;
+        entry.flags |= WS_PAK_ENTRY_LZ4;
+        packed = (const char*)buffer;
+      }
+    }
+    const u64 alignedSize = wsPakAlign(entry.packedSize);
+    success = ( fwrite(packed, 1, entry.packedSize, pFile) == entry.packedSize &&
+                wsWritePadding(pFile, alignedSize - entry.packedSize));
+    free(buffer);
+    offset += alignedSize;
+    totalSize += entry.size;
+    totalPacked += entry.packedSize;
+  }
+  //  The table of contents, sorted for lookup, and the paths it points to
+  qsort(records, numFiles, sizeof(wsPakRecord), wsCompareRecords);
+  for (u32 i = 1; success && i < numFiles; ++i) {
+    if (wsCompareRecords(&records[i-1], &records[i]) == 0) {
+      wsEcho(WS_LOG_ERROR, "\"%s\" was given to the pack twice", records[i].path);
+      success = false;
+    }
+  }
+  if (success) {
+    success = (fseek(pFile, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(wsPakHeader), 1, pFile) == 1);
+  }
+  for (u32 i = 0; success && i < numFiles; ++i) {
+    success = (fwrite(&records[i].entry, sizeof(wsPakEntry), 1, pFile) == 1);
+  }
+  //  Paths are written in the order their offsets were given
+  for (u32 i = 0; success && i < numFiles; ++i) {
+    const char* path = wsPakPath(filepaths[i]);
+    success = (fwrite(path, 1, strlen(path) + 1, pFile) == strlen(path) + 1);
+  }
+  //  An empty pack still ends on the boundary its table was padded to
+  if (success && numFiles == 0) { success = wsWritePadding(pFile, offset - tableSize); }
+  success = (fclose(pFile) == 0 && success);
+  success = success && (rename(tmpPath, destPath) == 0);
+  free(records);
+  if (!success) {
+    wsEcho(WS_LOG_ERROR, "Could not write the pack \"%s\"", destPath);
+    remove(tmpPath);
+    free(tmpPath);
+    return false;
+  }
+  free(tmpPath);
+  wsEcho(WS_LOG_INFO, "Packed %u files, %lu bytes into %lu, in \"%s\"", numFiles, totalSize, totalPacked, destPath);
+  return true;
+}
@@ -0,0 +1,104 @@
+/*
+ * wsPakFile.h
+ *
+ *    This file declares the .wsPak asset pack of the Whipstitch Game Engine, which
+ *    holds many asset files in one, to be mapped once and served through wsVFS.
+ *
+ *    A pack begins with a wsPakHeader, followed by its table of contents: one
+ *    wsPakEntry per file, sorted by the hash of its path, then the paths themselves.
+ *    Each file is stored on its own 4096-byte boundary, so its pages belong to it
+ *    alone and can be read ahead without touching its neighbours. A file may be
+ *    LZ4-compressed, and each carries the 64-bit hash of its contents.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_PAK_FILE_H_
+#define WS_PAK_FILE_H_
+
+#include "wsMappedFile.h"
+
+#define WS_PAK_MAGIC      0x6B507377  //  "wsPk"
+#define WS_PAK_VERSION    1
+#define WS_PAK_ALIGNMENT  4096
+#define WS_PAK_EXTENSION  ".wsPak"
+//  Entry flags
+#define WS_PAK_ENTRY_LZ4  0x01
+
+struct wsPakHeader {
+  u32 magic;
+  u32 version;
+  u32 numEntries;
+  u32 namesSize;  //  Bytes of terminated paths following the table
+};
+
+struct wsPakEntry {
+  u64 offset;       //  From the start of the pack
+  u64 packedSize;   //  Bytes stored in the pack
+  u64 size;         //  Bytes of the file itself
+  u64 contentHash;  //  wsHashBuffer64(...) of the file itself
+  u32 pathHash;     //  wsHash(...) of the path; the table is sorted by it
+  u32 pathOffset;   //  From the start of the paths
+  u32 flags;
+  u32 reserved;
+};
+
+class wsPakFile {
+  private:
+    wsMappedFile file;
+    const wsPakHeader* header;
+    const wsPakEntry* entries;
+    const char* names;
+    //  Not copyable; the mapping has a single owner
+    wsPakFile(const wsPakFile&);
+    wsPakFile& operator=(const wsPakFile&);
+  public:
+    wsPakFile() : header(WS_NULL), entries(WS_NULL), names(WS_NULL) {}
+    ~wsPakFile() { close(); }
+    //  Returns false, leaving the pack closed, if it cannot be opened or is not a
+    //  complete .wsPak file of this version
+    bool open(const char* filepath);
+    void close();
+    //  Returns the entry for a path, or WS_NULL if the pack does not hold it
+    const wsPakEntry* find(const char* filepath) const;
+    const wsPakEntry& getEntry(u32 index) const { return entries[index]; }
+    u32 getNumEntries() const { return header->numEntries; }
+    const char* getPath(const wsPakEntry& entry) const { return names + entry.pathOffset; }
+    bool isOpen() const { return (header != WS_NULL); }
+    //  Serves an entry's contents through dest, expanding it if compressed. Returns false
+    //  if a compressed entry is corrupt.
+    bool read(wsMappedFile* dest, const wsPakEntry* entry) const;
+};
+
+//  Packs are keyed by paths as the engine asks for them, relative to the working
+//  directory and without a leading "./"
+const char* wsPakPath(const char* filepath);
+
+//  Writes the given files to a pack, compressing each with LZ4 if asked and if that
+//  saves enough to be worth expanding it at load time. Files marked in mapped, which the
+//  engine uses in place, such as cooked meshes, are always stored.
+bool wsWritePak(const char* destPath, const char* const* filepaths, u32 numFiles, bool compress = false,
+                const bool* mapped = WS_NULL);
+
+#endif /* WS_PAK_FILE_H_ */
@@ -45,15 +45,25 @@
 
 #define WS_BUFFER_OFFSET(bytes) ((char*)NULL + (bytes))
 
-#ifdef __SSE4_1__
-    //  Be sure to use the compiler build option -msse4
-    //#define WS_SUPPORTS_SSE4    WS_TRUE
-    #define WS_SUPPORTS_SSE4    WS_FALSE
+//  vec4, mat4 and quat use SSE registers wherever SSE2 is available, which includes
+//  every x86-64 processor. SSE4.1 instructions are used only when the compiler has been
+//  told it may (-msse4.1). Define WS_DISABLE_SIMD to build the scalar reference path.
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+    !defined(WS_DISABLE_SIMD)
+    #define WS_SUPPORTS_SSE     WS_TRUE
+    #ifdef __SSE4_1__
+        #define WS_SUPPORTS_SSE4    WS_TRUE
+    #else
+        #define WS_SUPPORTS_SSE4    WS_FALSE
+    #endif
 #else
+    #define WS_SUPPORTS_SSE     WS_FALSE
     #define WS_SUPPORTS_SSE4    WS_FALSE
 #endif
 
 #define WS_NUM_CORES omp_get_num_procs()
+//  Data written by different threads is kept this far apart to avoid false sharing
+#define WS_CACHE_LINE_SIZE 64
 const u32 WS_BIT_ENVIRONMENT = sizeof(void*) * 8;
 
 #define WS_OS_UNKNOWN   0x00
@@ -113,6 +123,15 @@ const u32 WS_BIT_ENVIRONMENT = sizeof(void*) * 8;
     #endif
 #endif
 
+//  GCC and Clang can compile individual functions for instruction sets beyond the build
+//  flags, so x86 code paths may be chosen at runtime after checking the processor
+#if (WS_CURRENT_ARCHITECTURE == WS_ARCH_I32 || WS_CURRENT_ARCHITECTURE == WS_ARCH_AMD64) && \
+    defined(__GNUC__)
+    #define WS_SUPPORTS_CPU_DISPATCH    WS_TRUE
+#else
+    #define WS_SUPPORTS_CPU_DISPATCH    WS_FALSE
+#endif
+
 #if WS_CURRENT_ARCHITECTURE == WS_ARCH_I32 || WS_CURRENT_ARCHITECTURE == WS_ARCH_AMD64
     #if WS_CURRENT_OS == WS_OS_WINDOWS
         #define WS_DEBUG_BREAK()        __asm { int 3 }
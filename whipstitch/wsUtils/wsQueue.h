@@ -6,6 +6,17 @@
  *      This file declares and implements the class wsQueue, which is a generic
  *      (templated) double-ended queue object for the Whipstitch Game Engine.
  *
+ *      The queue is a ring buffer which grows geometrically when it runs out of room.
+ *      frontIndex is the position of the front item and rearIndex is the position
+ *      just past the rear item. Permanent queues take their memory from the Primary
+ *      Stack tier which was current when they were created; temporary queues take
+ *      theirs from the current frame.
+ *
+ *      Items are constructed in place by emplaceBack/emplaceFront, or moved in by
+ *      push; popping moves the item out. Popping an empty queue is an error, so
+ *      callers which cannot know ahead of time should use pop(ClassType&), which
+ *      returns false instead.
+ *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
  *
@@ -33,6 +44,10 @@
 #ifndef WS_QUEUE_H_
 #define WS_QUEUE_H_
 
+#include "wsMemoryStack.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
 template <class ClassType>
 class wsQueue {
     protected:
@@ -41,6 +56,13 @@ class wsQueue {
         u32 maxElements;
         u32 frontIndex;
         u32 rearIndex;
+        wsMemoryStack::_ws_memstack_tier tier;
+        bool temporary;
+        //  Doubles the size of the queue, unrolling its contents to the front
+        void grow();
+        //  Returns the address for a new rear or front item, growing as needed
+        ClassType* claimBack();
+        ClassType* claimFront();
     public:
         /*  Constructor */
         wsQueue(const u32 maxQueueSize = 32, const bool temporary = false);
@@ -53,21 +75,41 @@ class wsQueue {
         bool isNotFull() { return (length != maxElements); }
         /*  Operational Methods */
         void clear();   //  Removes all items from the queue
-        u32 push(ClassType object); //  The same as pushBack(ClassType)
-        u32 pushBack(ClassType object); //  Adds the item to the rear of the queue and returns the new length
-        u32 pushFront(ClassType object); //  Adds the item to the front of the queue and returns the new length
-        ClassType pop();  //  The same as popFront(ClassType)
+        u32 push(const ClassType& object) { return pushBack(object); }
+        u32 push(ClassType&& object) { return pushBack(std::move(object)); }
+        //  Adds the item to the rear of the queue and returns the new length
+        u32 pushBack(const ClassType& object);
+        u32 pushBack(ClassType&& object);
+        //  Adds the item to the front of the queue and returns the new length
+        u32 pushFront(const ClassType& object);
+        u32 pushFront(ClassType&& object);
+        //  Constructs an item in place at the rear or front and returns a reference to it
+        template <class... Args>
+        ClassType& emplaceBack(Args&&... args) {
+            return *(new (claimBack()) ClassType(std::forward<Args>(args)...));
+        }
+        template <class... Args>
+        ClassType& emplaceFront(Args&&... args) {
+            return *(new (claimFront()) ClassType(std::forward<Args>(args)...));
+        }
+        ClassType pop();  //  The same as popFront()
+        bool pop(ClassType& object) { return popFront(object); }
         ClassType popBack();    //  Removes and returns the rear item of the queue
-        ClassType back();   //  Returns the rear item of the queue without removing it
+        bool popBack(ClassType& object);    //  Moves the rear item into object; false if empty
         ClassType popFront();   //  Removes and returns the front item of the queue
-        ClassType front();   //  Returns the front item of the queue without removing it
+        bool popFront(ClassType& object);   //  Moves the front item into object; false if empty
+        ClassType& back();   //  Returns the rear item of the queue without removing it
+        ClassType& front();   //  Returns the front item of the queue without removing it
 };
 
 /*  Member Functions for wsQueue  */
 //  Constructor
 template <class ClassType>
 wsQueue<ClassType>::wsQueue(const u32 maxQueueSize, const bool temporary) {
+    wsAssert((maxQueueSize > 0), "wsQueue must have room for more than 0 elements.");
     maxElements = maxQueueSize;
+    tier = wsMem.getCurrentTier();
+    this->temporary = temporary;
     if (temporary) {
         queue = wsNewArrayTmp(ClassType, maxElements);
     }
@@ -78,68 +120,159 @@ wsQueue<ClassType>::wsQueue(const u32 maxQueueSize, const bool temporary) {
 }
 
 template <class ClassType>
-u32 wsQueue<ClassType>::push(ClassType object) {
-    if (length == maxElements) { return length; }
-    queue[rearIndex] = object;
-    rearIndex = (rearIndex + 1) % maxElements;
-    return ++length;
+void wsQueue<ClassType>::grow() {
+    u32 newMaxElements = maxElements*2;
+    wsEcho(WS_LOG_UTIL, "Growing wsQueue from %u to %u elements\n", maxElements, newMaxElements);
+    ClassType* newQueue;
+    if (temporary) {
+        newQueue = wsNewArrayTmp(ClassType, newMaxElements);
+    }
+    else {
+        newQueue = (ClassType*)wsMem.allocatePrimary(sizeof(ClassType)*newMaxElements, tier);
+    }
+    wsAssert((newQueue != NULL), "Could not grow wsQueue storage.");
+    for (u32 i = 0; i < length; ++i) {
+        ClassType& item = queue[(frontIndex + i) % maxElements];
+        new (&newQueue[i]) ClassType(std::move(item));
+        item.~ClassType();
+    }
+    queue = newQueue;
+    maxElements = newMaxElements;
+    frontIndex = 0;
+    rearIndex = length;
 }
 
 template <class ClassType>
-u32 wsQueue<ClassType>::pushBack(ClassType object) {
-    if (length == maxElements) { return length; }
-    queue[rearIndex] = object;
+ClassType* wsQueue<ClassType>::claimBack() {
+    if (length == maxElements) { grow(); }
+    ClassType* slot = &queue[rearIndex];
     rearIndex = (rearIndex + 1) % maxElements;
-    return ++length;
+    ++length;
+    return slot;
+}
+
+template <class ClassType>
+ClassType* wsQueue<ClassType>::claimFront() {
+    if (length == maxElements) { grow(); }
+    frontIndex = (frontIndex + maxElements - 1) % maxElements;
+    ++length;
+    return &queue[frontIndex];
+}
+
+//  The pushed object may live inside this queue, so it is copied aside before growing
+template <class ClassType>
+u32 wsQueue<ClassType>::pushBack(const ClassType& object) {
+    if (length == maxElements) {
+        ClassType tmp(object);
+        new (claimBack()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimBack()) ClassType(object);
+    }
+    return length;
+}
+
+template <class ClassType>
+u32 wsQueue<ClassType>::pushBack(ClassType&& object) {
+    if (length == maxElements) {
+        ClassType tmp(std::move(object));
+        new (claimBack()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimBack()) ClassType(std::move(object));
+    }
+    return length;
 }
 
 template <class ClassType>
-u32 wsQueue<ClassType>::pushFront(ClassType object) {
-    if (length == maxElements) { return length; }
-    queue[frontIndex] = object;
-    frontIndex = (frontIndex - 1) % maxElements;
-    return ++length;
+u32 wsQueue<ClassType>::pushFront(const ClassType& object) {
+    if (length == maxElements) {
+        ClassType tmp(object);
+        new (claimFront()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimFront()) ClassType(object);
+    }
+    return length;
+}
+
+template <class ClassType>
+u32 wsQueue<ClassType>::pushFront(ClassType&& object) {
+    if (length == maxElements) {
+        ClassType tmp(std::move(object));
+        new (claimFront()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimFront()) ClassType(std::move(object));
+    }
+    return length;
 }
 
 template <class ClassType>
 void wsQueue<ClassType>::clear() {
+    for (u32 i = 0; i < length; ++i) {
+        queue[(frontIndex + i) % maxElements].~ClassType();
+    }
     frontIndex = rearIndex = length = 0;
 }
 
 template <class ClassType>
 ClassType wsQueue<ClassType>::pop() {
-    if (length == 0) { return ClassType(); }
-    --length;
-    frontIndex = (frontIndex + 1) % maxElements;
-    return queue[frontIndex];
+    return popFront();
 }
 
 template <class ClassType>
 ClassType wsQueue<ClassType>::popBack() {
-    if (length == 0) { return ClassType(); }
+    wsAssert((length > 0), "Cannot pop an item from an empty wsQueue.");
+    --length;
+    rearIndex = (rearIndex + maxElements - 1) % maxElements;
+    ClassType object(std::move(queue[rearIndex]));
+    queue[rearIndex].~ClassType();
+    return object;
+}
+
+template <class ClassType>
+bool wsQueue<ClassType>::popBack(ClassType& object) {
+    if (length == 0) { return false; }
     --length;
-    rearIndex = (rearIndex - 1) % maxElements;
-    return queue[rearIndex];
+    rearIndex = (rearIndex + maxElements - 1) % maxElements;
+    object = std::move(queue[rearIndex]);
+    queue[rearIndex].~ClassType();
+    return true;
 }
 
 template <class ClassType>
 ClassType wsQueue<ClassType>::popFront() {
-    if (length == 0) { return ClassType(); }
+    wsAssert((length > 0), "Cannot pop an item from an empty wsQueue.");
     --length;
+    u32 current = frontIndex;
     frontIndex = (frontIndex + 1) % maxElements;
-    return queue[frontIndex];
+    ClassType object(std::move(queue[current]));
+    queue[current].~ClassType();
+    return object;
 }
 
 template <class ClassType>
-ClassType wsQueue<ClassType>::back() {
-    if (length == 0) { return ClassType(); }
-    return queue[(rearIndex - 1) % maxElements];
+bool wsQueue<ClassType>::popFront(ClassType& object) {
+    if (length == 0) { return false; }
+    --length;
+    u32 current = frontIndex;
+    frontIndex = (frontIndex + 1) % maxElements;
+    object = std::move(queue[current]);
+    queue[current].~ClassType();
+    return true;
+}
+
+template <class ClassType>
+ClassType& wsQueue<ClassType>::back() {
+    wsAssert((length > 0), "Cannot retrieve an item from an empty wsQueue.");
+    return queue[(rearIndex + maxElements - 1) % maxElements];
 }
 
 template <class ClassType>
-ClassType wsQueue<ClassType>::front() {
-    if (length == 0) { return ClassType(); }
-    return queue[(frontIndex - 1) % maxElements];
+ClassType& wsQueue<ClassType>::front() {
+    wsAssert((length > 0), "Cannot retrieve an item from an empty wsQueue.");
+    return queue[frontIndex];
 }
 
 #endif  /*  WS_QUEUE_H_ */
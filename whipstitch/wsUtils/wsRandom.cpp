@@ -0,0 +1,439 @@
+/*
+ * wsRandom.cpp
+ *
+ *    This file implements the random number generator for the Whipstitch Game Engine.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsRandom.h"
+#include "wsLog.h"
+#include <atomic>
+#include <string.h>  //  For memcpy()
+
+//  Scales the top 24 bits of a random number into [0, 1)
+#define WS_RANDOM_FLOAT_SCALE (1.0f / 16777216.0f)
+
+//  Jump polynomials for xoshiro128**, skipping 2^64 and 2^96 numbers
+static const u32 wsRandomJump[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+static const u32 wsRandomLongJump[4] = { 0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662 };
+
+static inline u32 wsRotateLeft(u32 value, u32 bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+//  One xoshiro128** step of a single lane
+static inline u32 wsRandomStep(u32 (*state)[WS_RANDOM_LANES], u32 lane) {
+  u32 s0 = state[0][lane], s1 = state[1][lane], s2 = state[2][lane], s3 = state[3][lane];
+  u32 my = wsRotateLeft(s1 * 5, 7) * 9;
+  u32 t = s1 << 9;
+  s2 ^= s0;
+  s3 ^= s1;
+  s1 ^= s2;
+  s0 ^= s3;
+  s2 ^= t;
+  s3 = wsRotateLeft(s3, 11);
+  state[0][lane] = s0;
+  state[1][lane] = s1;
+  state[2][lane] = s2;
+  state[3][lane] = s3;
+  return my;
+}
+
+//  Expands a seed into well-mixed words (SplitMix64)
+static inline u64 wsSplitMix(u64& seed) {
+  u64 my = (seed += 0x9E3779B97F4A7C15ULL);
+  my = (my ^ (my >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  my = (my ^ (my >> 27)) * 0x94D049BB133111EBULL;
+  return my ^ (my >> 31);
+}
+
+/*  Fill Kernels
+ *  Each batch is one number from every lane, in lane order */
+void wsRandomFill_scalar(u32 (*state)[WS_RANDOM_LANES], u32* dest, u32 numBatches) {
+  for (u32 b = 0; b < numBatches; ++b) {
+    for (u32 lane = 0; lane < WS_RANDOM_LANES; ++lane) {
+      dest[b*WS_RANDOM_LANES + lane] = wsRandomStep(state, lane);
+    }
+  }
+}
+
+void wsRandomFillFloats_scalar(u32 (*state)[WS_RANDOM_LANES], f32* dest, u32 numBatches, f32 min, f32 scale) {
+  for (u32 b = 0; b < numBatches; ++b) {
+    for (u32 lane = 0; lane < WS_RANDOM_LANES; ++lane) {
+      dest[b*WS_RANDOM_LANES + lane] = min + (f32)(i32)(wsRandomStep(state, lane) >> 8) * scale;
+    }
+  }
+}
+
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  #define ws_sseRotateLeft(v, bits) \
+      _mm_or_si128(_mm_slli_epi32((v), (bits)), _mm_srli_epi32((v), 32-(bits)))
+
+  //  One xoshiro128** step of four lanes; returns their numbers
+  static inline __m128i ws_sseRandomStep(__m128i& s0, __m128i& s1, __m128i& s2, __m128i& s3) {
+    //  Multiplies by 5 and 9 as shifts and adds, since SSE2 has no 32-bit multiply
+    __m128i my = _mm_add_epi32(_mm_slli_epi32(s1, 2), s1);
+    my = ws_sseRotateLeft(my, 7);
+    my = _mm_add_epi32(_mm_slli_epi32(my, 3), my);
+    __m128i t = _mm_slli_epi32(s1, 9);
+    s2 = _mm_xor_si128(s2, s0);
+    s3 = _mm_xor_si128(s3, s1);
+    s1 = _mm_xor_si128(s1, s2);
+    s0 = _mm_xor_si128(s0, s3);
+    s2 = _mm_xor_si128(s2, t);
+    s3 = ws_sseRotateLeft(s3, 11);
+    return my;
+  }
+
+  //  The eight lanes are handled as two interleaved groups of four
+  #define WS_SSE_RANDOM_LOAD(half) \
+      __m128i s0##half = _mm_load_si128((__m128i*)&state[0][half*4]); \
+      __m128i s1##half = _mm_load_si128((__m128i*)&state[1][half*4]); \
+      __m128i s2##half = _mm_load_si128((__m128i*)&state[2][half*4]); \
+      __m128i s3##half = _mm_load_si128((__m128i*)&state[3][half*4]);
+  #define WS_SSE_RANDOM_STORE(half) \
+      _mm_store_si128((__m128i*)&state[0][half*4], s0##half); \
+      _mm_store_si128((__m128i*)&state[1][half*4], s1##half); \
+      _mm_store_si128((__m128i*)&state[2][half*4], s2##half); \
+      _mm_store_si128((__m128i*)&state[3][half*4], s3##half);
+
+  void wsRandomFill_sse2(u32 (*state)[WS_RANDOM_LANES], u32* dest, u32 numBatches) {
+    WS_SSE_RANDOM_LOAD(0)
+    WS_SSE_RANDOM_LOAD(1)
+    for (u32 b = 0; b < numBatches; ++b) {
+      _mm_storeu_si128((__m128i*)(dest + b*WS_RANDOM_LANES), ws_sseRandomStep(s00, s10, s20, s30));
+      _mm_storeu_si128((__m128i*)(dest + b*WS_RANDOM_LANES + 4), ws_sseRandomStep(s01, s11, s21, s31));
+    }
+    WS_SSE_RANDOM_STORE(0)
+    WS_SSE_RANDOM_STORE(1)
+  }
+
+  void wsRandomFillFloats_sse2(u32 (*state)[WS_RANDOM_LANES], f32* dest, u32 numBatches, f32 min, f32 scale) {
+    __m128 vMin = _mm_set1_ps(min);
+    __m128 vScale = _mm_set1_ps(scale);
+    WS_SSE_RANDOM_LOAD(0)
+    WS_SSE_RANDOM_LOAD(1)
+    for (u32 b = 0; b < numBatches; ++b) {
+      __m128i low = _mm_srli_epi32(ws_sseRandomStep(s00, s10, s20, s30), 8);
+      __m128i high = _mm_srli_epi32(ws_sseRandomStep(s01, s11, s21, s31), 8);
+      _mm_storeu_ps(dest + b*WS_RANDOM_LANES, _mm_add_ps(vMin, _mm_mul_ps(_mm_cvtepi32_ps(low), vScale)));
+      _mm_storeu_ps(dest + b*WS_RANDOM_LANES + 4, _mm_add_ps(vMin, _mm_mul_ps(_mm_cvtepi32_ps(high), vScale)));
+    }
+    WS_SSE_RANDOM_STORE(0)
+    WS_SSE_RANDOM_STORE(1)
+  }
+
+#endif /* WS_SUPPORTS_SSE */
+
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+
+  #define ws_avxRotateLeft(v, bits) \
+      _mm256_or_si256(_mm256_slli_epi32((v), (bits)), _mm256_srli_epi32((v), 32-(bits)))
+
+  //  Without FMA, so that the compiler cannot fuse the float kernel's multiply and add
+  #define WS_TARGET_AVX2_NO_FMA  __attribute__((target("avx2")))
+
+  WS_TARGET_AVX2_NO_FMA
+  static inline __m256i ws_avxRandomStep(__m256i& s0, __m256i& s1, __m256i& s2, __m256i& s3) {
+    __m256i my = _mm256_add_epi32(_mm256_slli_epi32(s1, 2), s1);
+    my = ws_avxRotateLeft(my, 7);
+    my = _mm256_add_epi32(_mm256_slli_epi32(my, 3), my);
+    __m256i t = _mm256_slli_epi32(s1, 9);
+    s2 = _mm256_xor_si256(s2, s0);
+    s3 = _mm256_xor_si256(s3, s1);
+    s1 = _mm256_xor_si256(s1, s2);
+    s0 = _mm256_xor_si256(s0, s3);
+    s2 = _mm256_xor_si256(s2, t);
+    s3 = ws_avxRotateLeft(s3, 11);
+    return my;
+  }
+
+  WS_TARGET_AVX2
+  void wsRandomFill_avx2(u32 (*state)[WS_RANDOM_LANES], u32* dest, u32 numBatches) {
+    __m256i s0 = _mm256_load_si256((__m256i*)state[0]);
+    __m256i s1 = _mm256_load_si256((__m256i*)state[1]);
+    __m256i s2 = _mm256_load_si256((__m256i*)state[2]);
+    __m256i s3 = _mm256_load_si256((__m256i*)state[3]);
+    for (u32 b = 0; b < numBatches; ++b) {
+      _mm256_storeu_si256((__m256i*)(dest + b*WS_RANDOM_LANES), ws_avxRandomStep(s0, s1, s2, s3));
+    }
+    _mm256_store_si256((__m256i*)state[0], s0);
+    _mm256_store_si256((__m256i*)state[1], s1);
+    _mm256_store_si256((__m256i*)state[2], s2);
+    _mm256_store_si256((__m256i*)state[3], s3);
+  }
+
+  //  A multiply and an add rather than an FMA, so the results match the other kernels
+  WS_TARGET_AVX2_NO_FMA
+  void wsRandomFillFloats_avx2(u32 (*state)[WS_RANDOM_LANES], f32* dest, u32 numBatches, f32 min, f32 scale) {
+    __m256 vMin = _mm256_set1_ps(min);
+    __m256 vScale = _mm256_set1_ps(scale);
+    __m256i s0 = _mm256_load_si256((__m256i*)state[0]);
+    __m256i s1 = _mm256_load_si256((__m256i*)state[1]);
+    __m256i s2 = _mm256_load_si256((__m256i*)state[2]);
+    __m256i s3 = _mm256_load_si256((__m256i*)state[3]);
+    for (u32 b = 0; b < numBatches; ++b) {
+      __m256i bits = _mm256_srli_epi32(ws_avxRandomStep(s0, s1, s2, s3), 8);
+      _mm256_storeu_ps(dest + b*WS_RANDOM_LANES, _mm256_add_ps(vMin, _mm256_mul_ps(_mm256_cvtepi32_ps(bits), vScale)));
+    }
+    _mm256_store_si256((__m256i*)state[0], s0);
+    _mm256_store_si256((__m256i*)state[1], s1);
+    _mm256_store_si256((__m256i*)state[2], s2);
+    _mm256_store_si256((__m256i*)state[3], s3);
+  }
+
+#endif /* WS_SIMD_AVX2_KERNELS */
+
+void (*wsRandomFill)(u32 (*state)[WS_RANDOM_LANES], u32*, u32) = wsRandomFill_scalar;
+void (*wsRandomFillFloats)(u32 (*state)[WS_RANDOM_LANES], f32*, u32, f32, f32) = wsRandomFillFloats_scalar;
+
+void wsSetRandomLevel(wsSIMDLevel level) {
+  switch (level) {
+    #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+      case WS_SIMD_AVX2:
+        wsRandomFill = wsRandomFill_avx2;
+        wsRandomFillFloats = wsRandomFillFloats_avx2;
+        break;
+    #endif
+    #if WS_SUPPORTS_SSE == WS_TRUE
+      case WS_SIMD_SSE2:
+        wsRandomFill = wsRandomFill_sse2;
+        wsRandomFillFloats = wsRandomFillFloats_sse2;
+        break;
+    #endif
+    default:
+      wsRandomFill = wsRandomFill_scalar;
+      wsRandomFillFloats = wsRandomFillFloats_scalar;
+      break;
+  }
+}
+
+/*  Member Functions for wsRandom  */
+wsRandom::wsRandom(u64 seed) {
+  this->seed(seed);
+}
+
+void wsRandom::seed(u64 seed) {
+  u64 first = wsSplitMix(seed);
+  u64 second = wsSplitMix(seed);
+  state[0][0] = (u32)first;
+  state[1][0] = (u32)(first >> 32);
+  state[2][0] = (u32)second;
+  state[3][0] = (u32)(second >> 32);
+  //  An all-zero state would only ever produce zeros
+  if ((first | second) == 0) { state[0][0] = 1; }
+  for (u32 lane = 1; lane < WS_RANDOM_LANES; ++lane) {
+    for (u32 word = 0; word < 4; ++word) {
+      state[word][lane] = state[word][lane-1];
+    }
+    jumpLane(lane, wsRandomJump);
+  }
+  currentLane = 0;
+}
+
+void wsRandom::jumpLane(u32 lane, const u32* polynomial) {
+  u32 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  for (u32 i = 0; i < 4; ++i) {
+    for (u32 b = 0; b < 32; ++b) {
+      if (polynomial[i] & (1u << b)) {
+        s0 ^= state[0][lane];
+        s1 ^= state[1][lane];
+        s2 ^= state[2][lane];
+        s3 ^= state[3][lane];
+      }
+      wsRandomStep(state, lane);
+    }
+  }
+  state[0][lane] = s0;
+  state[1][lane] = s1;
+  state[2][lane] = s2;
+  state[3][lane] = s3;
+}
+
+void wsRandom::jump() {
+  //  Lane n starts 2^64 numbers after lane n-1, so a single jump would only move each
+  //  lane onto the next one's numbers
+  for (u32 lane = 0; lane < WS_RANDOM_LANES; ++lane) {
+    for (u32 i = 0; i < WS_RANDOM_LANES; ++i) {
+      jumpLane(lane, wsRandomJump);
+    }
+  }
+}
+
+void wsRandom::longJump() {
+  for (u32 lane = 0; lane < WS_RANDOM_LANES; ++lane) {
+    jumpLane(lane, wsRandomLongJump);
+  }
+}
+
+u32 wsRandom::next() {
+  u32 my = wsRandomStep(state, currentLane);
+  currentLane = (currentLane + 1) % WS_RANDOM_LANES;
+  return my;
+}
+
+//  Lemire's multiply-and-shift; only values in the short remainder are redrawn
+u32 wsRandom::nextBelow(u32 bound) {
+  wsAssert((bound > 0), "Cannot draw a random number below zero.");
+  u64 product = (u64)next() * bound;
+  if ((u32)product < bound) {
+    u32 threshold = (0u - bound) % bound;
+    while ((u32)product < threshold) {
+      product = (u64)next() * bound;
+    }
+  }
+  return (u32)(product >> 32);
+}
+
+i32 wsRandom::nextInt(i32 min, i32 max) {
+  wsAssert((min <= max), "Random range must have min <= max.");
+  u32 bound = (u32)max - (u32)min + 1;
+  if (bound == 0) { return (i32)next(); }  //  The full 32-bit range
+  return (i32)((u32)min + nextBelow(bound));
+}
+
+f32 wsRandom::nextFloat() {
+  return (f32)(i32)(next() >> 8) * WS_RANDOM_FLOAT_SCALE;
+}
+
+f32 wsRandom::nextFloat(f32 min, f32 max) {
+  return min + (f32)(i32)(next() >> 8) * ((max - min) * WS_RANDOM_FLOAT_SCALE);
+}
+
+void wsRandom::fill(u32* dest, u32 count) {
+  u32 i = 0;
+  //  Draw singly until the next number comes from the first lane
+  for (; i < count && currentLane != 0; ++i) {
+    dest[i] = next();
+  }
+  u32 numBatches = (count - i) / WS_RANDOM_LANES;
+  wsRandomFill(state, dest + i, numBatches);
+  i += numBatches * WS_RANDOM_LANES;
+  for (; i < count; ++i) {
+    dest[i] = next();
+  }
+}
+
+void wsRandom::fillFloats(f32* dest, u32 count, f32 min, f32 max) {
+  f32 scale = (max - min) * WS_RANDOM_FLOAT_SCALE;
+  u32 i = 0;
+  for (; i < count && currentLane != 0; ++i) {
+    dest[i] = nextFloat(min, max);
+  }
+  u32 numBatches = (count - i) / WS_RANDOM_LANES;
+  wsRandomFillFloats(state, dest + i, numBatches, min, scale);
+  i += numBatches * WS_RANDOM_LANES;
+  for (; i < count; ++i) {
+    dest[i] = nextFloat(min, max);
+  }
+}
+
+//  The bits are drawn in bulk, then mapped onto the range in order. Any redraws come
+//  from the stream after the bulk numbers, so the sequence matches nextInt() only
+//  when nothing is redrawn.
+void wsRandom::fillInts(i32* dest, u32 count, i32 min, i32 max) {
+  wsAssert((min <= max), "Random range must have min <= max.");
+  fill((u32*)dest, count);
+  u32 bound = (u32)max - (u32)min + 1;
+  if (bound == 0) { return; }
+  u32 threshold = (0u - bound) % bound;
+  for (u32 i = 0; i < count; ++i) {
+    u64 product = (u64)(u32)dest[i] * bound;
+    while ((u32)product < threshold) {
+      product = (u64)next() * bound;
+    }
+    dest[i] = (i32)((u32)min + (u32)(product >> 32));
+  }
+}
+
+/*  Global Streams  */
+//  Saving the initial seed will allow us to replicate results later on.
+//  It is therefore not recommended to reinitialize the randomizer unless there
+//  is a specific reason for doing so (e.g., restarting the game)
+std::atomic<u64> wsInitialRandomSeed(0);
+//  Raised by every reseed, so that each thread knows to restart its stream
+std::atomic<u32> wsRandomGeneration(0);
+std::atomic<u32> wsRandomNumThreads(0);
+
+struct wsThreadRandomStream {
+  wsRandom stream;
+  u32 generation;
+  u32 threadIndex;
+  wsThreadRandomStream() : generation(0), threadIndex(wsRandomNumThreads.fetch_add(1)) {
+    restart();
+  }
+  void restart() {
+    generation = wsRandomGeneration.load(std::memory_order_acquire);
+    stream.seed(wsInitialRandomSeed.load(std::memory_order_relaxed));
+    for (u32 i = 0; i < threadIndex; ++i) {
+      stream.longJump();
+    }
+  }
+};
+
+thread_local wsThreadRandomStream wsThreadRandom;
+
+//  This initializes the randomizer with a special seed.
+void wsInitRandomizer(u64 seed) {
+  wsEcho(WS_LOG_UTIL, "Initial Random Seed: %llu\n", (unsigned long long)seed);
+  wsInitialRandomSeed.store(seed, std::memory_order_relaxed);
+  wsRandomGeneration.fetch_add(1, std::memory_order_release);
+}
+
+//  This produces a bitwise conversion from float to unsigned integer, speeding up
+//  and further randomizing any potential floating-point seeds. These are very likely,
+//  incidentally, as many implementations (including ours) use time, in seconds, to
+//  seed the randomizer.
+void wsInitRandomizer(f64 seed) {
+  u64 bits;
+  memcpy(&bits, &seed, sizeof(bits));
+  wsInitRandomizer(bits);
+}
+
+wsRandom& wsGetThreadRandom() {
+  wsThreadRandomStream& my = wsThreadRandom;
+  if (my.generation != wsRandomGeneration.load(std::memory_order_acquire)) {
+    my.restart();
+  }
+  return my.stream;
+}
+
+u32 wsRand() {
+  return wsGetThreadRandom().next();
+}
+
+i32 wsRandomInt(i32 min, i32 max) {
+  if (min > max) {
+    i32 tmp = min;
+    min = max;
+    max = tmp;
+  }
+  return wsGetThreadRandom().nextInt(min, max);
+}
+
+f32 wsRandomFloat(f32 min, f32 max) {
+  return wsGetThreadRandom().nextFloat(min, max);
+}
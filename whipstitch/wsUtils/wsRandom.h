@@ -0,0 +1,106 @@
+/*
+ * wsRandom.h
+ *
+ *    This file declares the random number generator for the Whipstitch Game Engine.
+ *
+ *    A wsRandom is one stream of random numbers, built from eight interleaved
+ *    xoshiro128** generators (lanes). Successive numbers are taken from successive
+ *    lanes, so four (SSE2) or eight (AVX2) of them are produced by each instruction
+ *    when a whole array is filled at once. The sequence is the same whether numbers
+ *    are drawn one at a time or in bulk, and whichever kernels are selected.
+ *
+ *    Each lane is the one before it jumped 2^64 numbers ahead, and each thread's stream
+ *    is jumped 2^96 ahead of the one before it, so no two ever overlap. A stream keeps
+ *    no locks; it must only be used by one thread at a time. wsGetThreadRandom()
+ *    returns the calling thread's own stream, which the global functions below use.
+ *
+ *    Numbers in a range are drawn without bias: a multiply maps 32 random bits onto
+ *    the range, and the rare values which would favor part of it are redrawn.
+ *
+ *    Usage:
+ *      wsRandom& rng = wsGetThreadRandom();
+ *      rng.fillFloats(particleLifetimes, numParticles, 1.0f, 3.0f);
+ *      i32 roll = rng.nextInt(1, 6);
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_RANDOM_H_
+#define WS_RANDOM_H_
+
+#include "wsSIMD.h"
+
+#define WS_RANDOM_LANES 8
+
+class wsRandom {
+  protected:
+    //  xoshiro128** state; each row holds one word of every lane
+    alignas(32) u32 state[4][WS_RANDOM_LANES];
+    //  The lane which produces the next number
+    u32 currentLane;
+    //  Advances one lane by the distance encoded in the polynomial
+    void jumpLane(u32 lane, const u32* polynomial);
+  public:
+    /*  Constructor */
+    wsRandom(u64 seed = 0);
+    /*  Operational Methods */
+    //  Restarts the stream from the given seed
+    void seed(u64 seed);
+    //  Skips WS_RANDOM_LANES*2^64 numbers in every lane, past where each other lane
+    //  starts, so the new stream shares no numbers with the old
+    void jump();
+    //  Skips 2^96 numbers in every lane; used to give each thread its own stream
+    void longJump();
+    //  32 random bits
+    u32 next();
+    //  Uniform in [0, bound); bound must be greater than 0
+    u32 nextBelow(u32 bound);
+    //  Uniform in [min, max], inclusive
+    i32 nextInt(i32 min, i32 max);
+    //  Uniform in [0, 1), with 24 bits of precision
+    f32 nextFloat();
+    //  min + nextFloat()*(max-min)
+    f32 nextFloat(f32 min, f32 max);
+    //  The bulk versions of next(), nextFloat(min, max) and nextInt(min, max)
+    void fill(u32* dest, u32 count);
+    void fillFloats(f32* dest, u32 count, f32 min = 0.0f, f32 max = 1.0f);
+    void fillInts(i32* dest, u32 count, i32 min, i32 max);
+};
+
+//  Seeds the streams of every thread. Each thread's stream restarts from the new seed
+//  the next time that thread draws a number.
+void wsInitRandomizer(u64 seed);
+//  Seeds from the bits of a floating point value, such as the current time
+void wsInitRandomizer(f64 seed);
+//  Returns the calling thread's stream
+wsRandom& wsGetThreadRandom();
+//  Draw from the calling thread's stream
+u32 wsRand();
+i32 wsRandomInt(i32 min, i32 max);
+f32 wsRandomFloat(f32 min, f32 max);
+
+//  Selects the fill kernels for the given level; called by wsSetSIMDLevel(...)
+void wsSetRandomLevel(wsSIMDLevel level);
+
+#endif /* WS_RANDOM_H_ */
@@ -0,0 +1,222 @@
+/*
+ * wsSIMD.cpp
+ *
+ *    This file implements the runtime SIMD dispatch for the Whipstitch Game Engine.
+ *
+ *    Every kernel has a scalar version. The SSE2 versions are built whenever the math
+ *    types use SSE, and the AVX2 versions are compiled for that instruction set with
+ *    a target attribute, so they are only ever called once the processor has been
+ *    seen to support them.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsSIMD.h"
+#include "wsBatchMath.h"
+#include "wsGeometry.h"
+#include "wsRandom.h"
+#include "wsLog.h"
+
+wsCPUFeatures wsCPU = { false, false, false, false, false, false };
+wsSIMDLevel wsCurrentSIMDLevel = WS_SIMD_SCALAR;
+
+/*  Scalar Kernels  */
+void wsMultiplyMat4Array_scalar(mat4* dest, const mat4* a, const mat4* b, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    const f32* left = a[i].data;
+    const f32* right = b[i].data;
+    f32 result[16];
+    for (u32 row = 0; row < 4; ++row) {
+      for (u32 col = 0; col < 4; ++col) {
+        result[row*4+col] = left[row*4]*right[col] + left[row*4+1]*right[4+col] +
+                            left[row*4+2]*right[8+col] + left[row*4+3]*right[12+col];
+      }
+    }
+    for (u32 j = 0; j < 16; ++j) {
+      dest[i].data[j] = result[j];
+    }
+  }
+}
+
+void wsTransformVec4Array_scalar(vec4* dest, const vec4* src, const mat4& mat, u32 count) {
+  const f32* m = mat.data;
+  for (u32 i = 0; i < count; ++i) {
+    f32 x = src[i].x, y = src[i].y, z = src[i].z, w = src[i].w;
+    dest[i].x = x*m[0] + y*m[4] + z*m[8] + w*m[12];
+    dest[i].y = x*m[1] + y*m[5] + z*m[9] + w*m[13];
+    dest[i].z = x*m[2] + y*m[6] + z*m[10] + w*m[14];
+    dest[i].w = x*m[3] + y*m[7] + z*m[11] + w*m[15];
+  }
+}
+
+#if WS_SUPPORTS_SSE == WS_TRUE
+
+  /*  SSE2 Kernels  */
+  void wsMultiplyMat4Array_sse2(mat4* dest, const mat4* a, const mat4* b, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+      dest[i] = a[i] * b[i];
+    }
+  }
+
+  void wsTransformVec4Array_sse2(vec4* dest, const vec4* src, const mat4& mat, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+      __m128 v = src[i].mReg;
+      __m128 result = _mm_mul_ps(ws_sseDistributeX(v), mat.mReg0);
+      result = ws_sseMadd(ws_sseDistributeY(v), mat.mReg1, result);
+      result = ws_sseMadd(ws_sseDistributeZ(v), mat.mReg2, result);
+      dest[i].mReg = ws_sseMadd(ws_sseDistributeW(v), mat.mReg3, result);
+    }
+  }
+
+#endif /* WS_SUPPORTS_SSE */
+
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+
+  /*  AVX2 Kernels  */
+  //  Each 256-bit register holds two rows (or two vectors); the other matrix's rows
+  //  are copied into both halves, so both products are formed at once.
+  WS_TARGET_AVX2
+  void wsMultiplyMat4Array_avx2(mat4* dest, const mat4* a, const mat4* b, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+      __m256 row0 = _mm256_broadcast_ps(&b[i].mReg0);
+      __m256 row1 = _mm256_broadcast_ps(&b[i].mReg1);
+      __m256 row2 = _mm256_broadcast_ps(&b[i].mReg2);
+      __m256 row3 = _mm256_broadcast_ps(&b[i].mReg3);
+      __m256 left01 = _mm256_loadu_ps(&a[i].data[0]);
+      __m256 left23 = _mm256_loadu_ps(&a[i].data[8]);
+      __m256 result01 = _mm256_mul_ps(_mm256_shuffle_ps(left01, left01, 0x00), row0);
+      __m256 result23 = _mm256_mul_ps(_mm256_shuffle_ps(left23, left23, 0x00), row0);
+      result01 = _mm256_fmadd_ps(_mm256_shuffle_ps(left01, left01, 0x55), row1, result01);
+      result23 = _mm256_fmadd_ps(_mm256_shuffle_ps(left23, left23, 0x55), row1, result23);
+      result01 = _mm256_fmadd_ps(_mm256_shuffle_ps(left01, left01, 0xAA), row2, result01);
+      result23 = _mm256_fmadd_ps(_mm256_shuffle_ps(left23, left23, 0xAA), row2, result23);
+      result01 = _mm256_fmadd_ps(_mm256_shuffle_ps(left01, left01, 0xFF), row3, result01);
+      result23 = _mm256_fmadd_ps(_mm256_shuffle_ps(left23, left23, 0xFF), row3, result23);
+      _mm256_storeu_ps(&dest[i].data[0], result01);
+      _mm256_storeu_ps(&dest[i].data[8], result23);
+    }
+  }
+
+  WS_TARGET_AVX2
+  void wsTransformVec4Array_avx2(vec4* dest, const vec4* src, const mat4& mat, u32 count) {
+    __m256 row0 = _mm256_broadcast_ps(&mat.mReg0);
+    __m256 row1 = _mm256_broadcast_ps(&mat.mReg1);
+    __m256 row2 = _mm256_broadcast_ps(&mat.mReg2);
+    __m256 row3 = _mm256_broadcast_ps(&mat.mReg3);
+    u32 i = 0;
+    for (; i+1 < count; i += 2) {
+      __m256 v = _mm256_loadu_ps((const f32*)&src[i]);
+      __m256 result = _mm256_mul_ps(_mm256_shuffle_ps(v, v, 0x00), row0);
+      result = _mm256_fmadd_ps(_mm256_shuffle_ps(v, v, 0x55), row1, result);
+      result = _mm256_fmadd_ps(_mm256_shuffle_ps(v, v, 0xAA), row2, result);
+      result = _mm256_fmadd_ps(_mm256_shuffle_ps(v, v, 0xFF), row3, result);
+      _mm256_storeu_ps((f32*)&dest[i], result);
+    }
+    if (i < count) {
+      wsTransformVec4Array_sse2(&dest[i], &src[i], mat, 1);
+    }
+  }
+
+#endif /* WS_SIMD_AVX2_KERNELS */
+
+void (*wsMultiplyMat4Array)(mat4* dest, const mat4* a, const mat4* b, u32 count) =
+    wsMultiplyMat4Array_scalar;
+void (*wsTransformVec4Array)(vec4* dest, const vec4* src, const mat4& mat, u32 count) =
+    wsTransformVec4Array_scalar;
+
+void wsDetectSIMD() {
+  #if WS_SUPPORTS_CPU_DISPATCH == WS_TRUE
+    __builtin_cpu_init();
+    wsCPU.sse2 = (__builtin_cpu_supports("sse2") != 0);
+    wsCPU.sse41 = (__builtin_cpu_supports("sse4.1") != 0);
+    wsCPU.sse42 = (__builtin_cpu_supports("sse4.2") != 0);
+    wsCPU.avx = (__builtin_cpu_supports("avx") != 0);
+    wsCPU.avx2 = (__builtin_cpu_supports("avx2") != 0);
+    wsCPU.fma = (__builtin_cpu_supports("fma") != 0);
+  #endif
+  wsSetSIMDLevel(wsGetMaxSIMDLevel());
+  wsEcho(WS_LOG_PLATFORM, "CPU features:%s%s%s%s%s%s\n",
+          wsCPU.sse2 ? " SSE2" : "", wsCPU.sse41 ? " SSE4.1" : "", wsCPU.sse42 ? " SSE4.2" : "",
+          wsCPU.avx ? " AVX" : "", wsCPU.avx2 ? " AVX2" : "", wsCPU.fma ? " FMA" : "");
+  wsEcho(WS_LOG_PLATFORM, "Using %s array kernels\n", wsGetSIMDLevelName(wsCurrentSIMDLevel));
+}
+
+wsSIMDLevel wsGetSIMDLevel() {
+  return wsCurrentSIMDLevel;
+}
+
+wsSIMDLevel wsGetMaxSIMDLevel() {
+  #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+    if (wsCPU.avx2 && wsCPU.fma) {
+      return WS_SIMD_AVX2;
+    }
+  #endif
+  #if WS_SUPPORTS_SSE == WS_TRUE
+    return WS_SIMD_SSE2;
+  #else
+    return WS_SIMD_SCALAR;
+  #endif
+}
+
+const char* wsGetSIMDLevelName(wsSIMDLevel level) {
+  switch (level) {
+    case WS_SIMD_SCALAR:
+      return "scalar";
+    case WS_SIMD_SSE2:
+      return "SSE2";
+    case WS_SIMD_AVX2:
+      return "AVX2";
+    default:
+      return "unknown";
+  }
+}
+
+bool wsSetSIMDLevel(wsSIMDLevel level) {
+  if (level >= WS_SIMD_MAX || level > wsGetMaxSIMDLevel()) {
+    return false;
+  }
+  switch (level) {
+    #if WS_SIMD_AVX2_KERNELS == WS_TRUE
+      case WS_SIMD_AVX2:
+        wsMultiplyMat4Array = wsMultiplyMat4Array_avx2;
+        wsTransformVec4Array = wsTransformVec4Array_avx2;
+        break;
+    #endif
+    #if WS_SUPPORTS_SSE == WS_TRUE
+      case WS_SIMD_SSE2:
+        wsMultiplyMat4Array = wsMultiplyMat4Array_sse2;
+        wsTransformVec4Array = wsTransformVec4Array_sse2;
+        break;
+    #endif
+    default:
+      wsMultiplyMat4Array = wsMultiplyMat4Array_scalar;
+      wsTransformVec4Array = wsTransformVec4Array_scalar;
+      break;
+  }
+  wsSetBatchMathLevel(level);
+  wsSetGeometryLevel(level);
+  wsSetRandomLevel(level);
+  wsCurrentSIMDLevel = level;
+  return true;
+}
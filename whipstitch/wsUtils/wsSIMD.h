@@ -0,0 +1,80 @@
+/*
+ * wsSIMD.h
+ *
+ *    This file declares the runtime SIMD dispatch for the Whipstitch Game Engine.
+ *
+ *    vec4, mat4 and quat are compiled for the instruction set the build targets (SSE2
+ *    on any x86-64 machine). Work over whole arrays of matrices or vectors goes
+ *    through the kernels declared here instead, which are chosen once at startup
+ *    from what the processor actually supports, so a single binary can use AVX2 and
+ *    FMA where they exist without requiring them everywhere.
+ *
+ *    The kernels are function pointers. They point at the scalar versions until
+ *    wsDetectSIMD() is called during wsInit(), and may be switched by hand with
+ *    wsSetSIMDLevel(...) to compare the versions against one another.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_SIMD_H_
+#define WS_SIMD_H_
+
+#include "mat4.h"
+#include "vec4.h"
+
+enum wsSIMDLevel {
+  WS_SIMD_SCALAR = 0,
+  WS_SIMD_SSE2,
+  WS_SIMD_AVX2,
+  WS_SIMD_MAX
+};
+
+//  Instruction sets reported by the processor
+struct wsCPUFeatures {
+  bool sse2;
+  bool sse41;
+  bool sse42;
+  bool avx;
+  bool avx2;
+  bool fma;
+};
+
+extern wsCPUFeatures wsCPU;
+
+//  Queries the processor and selects the best kernels it supports
+void wsDetectSIMD();
+wsSIMDLevel wsGetSIMDLevel();
+//  Returns the best level both the build and the processor support
+wsSIMDLevel wsGetMaxSIMDLevel();
+const char* wsGetSIMDLevelName(wsSIMDLevel level);
+//  Selects the kernels for the given level; returns false if it is not supported
+bool wsSetSIMDLevel(wsSIMDLevel level);
+
+/*  Array Kernels */
+//  dest[i] = a[i] * b[i]; dest may be the same array as a or b
+extern void (*wsMultiplyMat4Array)(mat4* dest, const mat4* a, const mat4* b, u32 count);
+//  dest[i] = src[i] * mat, treating each vec4 as a row vector, as vec4::operator*(mat4) does
+extern void (*wsTransformVec4Array)(vec4* dest, const vec4* src, const mat4& mat, u32 count);
+
+#endif /* WS_SIMD_H_ */
@@ -0,0 +1,197 @@
+/*
+ *      wsSPSCQueue.h
+ *
+ *      This file declares and implements the class wsSPSCQueue, a bounded lock-free
+ *      ring buffer for passing items from exactly one producer thread to exactly one
+ *      consumer thread (audio streaming, asset loading, log output, and the like).
+ *
+ *      The capacity is rounded up to a power of two and fixed at creation; push
+ *      returns false rather than growing when the queue is full. The read and write
+ *      indices sit on separate cache lines, each next to a private copy of the other
+ *      side's index, so the two threads only touch each other's line when their
+ *      cached view says the queue is empty or full.
+ *
+ *      Only the producer may call push, emplace and pushBatch; only the consumer may
+ *      call pop and popBatch. For any number of producers or consumers, use
+ *      wsMPMCQueue instead.
+ *
+ *      Usage:
+ *        wsSPSCQueue<wsEvent>* myEvents = wsNew(wsSPSCQueue<wsEvent>, wsSPSCQueue<wsEvent>(256));
+ *        myEvents->push(myEvent);          //  Producer thread
+ *        while (myEvents->pop(myEvent)) {} //  Consumer thread
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_SPSC_QUEUE_H_
+#define WS_SPSC_QUEUE_H_
+
+#include "wsMemoryStack.h"
+#include <atomic>
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
+template <class ClassType>
+class wsSPSCQueue {
+  protected:
+    //  Indices run freely and wrap at 2^32; an item's slot is its index & mask
+    struct _ws_spsc_indices {
+      alignas(WS_CACHE_LINE_SIZE) std::atomic<u32> readIndex;
+      u32 cachedWriteIndex; //  Consumer's last view of writeIndex
+      alignas(WS_CACHE_LINE_SIZE) std::atomic<u32> writeIndex;
+      u32 cachedReadIndex;  //  Producer's last view of readIndex
+    };
+    _ws_spsc_indices* indices;
+    ClassType* slots;
+    u32 mask;
+    //  Returns the number of free slots the producer may fill, at most numWanted
+    u32 claimWritable(u32 write, u32 numWanted);
+    //  Returns the number of items the consumer may take, at most numWanted
+    u32 claimReadable(u32 read, u32 numWanted);
+  public:
+    /*  Constructor */
+    wsSPSCQueue(u32 minElements = 64,
+                wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
+    /*  Accessors   */
+    u32 getCapacity() const { return mask + 1; }
+    //  Exact only when neither thread is running; otherwise a snapshot
+    u32 getLength() const {
+      return indices->writeIndex.load(std::memory_order_acquire) -
+              indices->readIndex.load(std::memory_order_acquire);
+    }
+    bool isEmpty() const { return (getLength() == 0); }
+    /*  Producer Methods    */
+    //  Each returns false, leaving the queue untouched, if there is no room
+    bool push(const ClassType& object);
+    bool push(ClassType&& object);
+    template <class... Args>
+    bool emplace(Args&&... args);
+    //  Copies up to numItems items in order and returns the number pushed
+    u32 pushBatch(const ClassType* items, u32 numItems);
+    /*  Consumer Methods    */
+    //  Moves the front item into myItem; returns false if the queue is empty
+    bool pop(ClassType& myItem);
+    //  Moves up to maxItems items into items, in order, and returns the number popped
+    u32 popBatch(ClassType* items, u32 maxItems);
+};
+
+/*  Member Functions for wsSPSCQueue  */
+//  Constructor
+template <class ClassType>
+wsSPSCQueue<ClassType>::wsSPSCQueue(u32 minElements, wsMemoryStack::_ws_memstack_tier myTier) {
+  wsAssert((minElements > 0), "wsSPSCQueue must have room for more than 0 elements.");
+  u32 capacity = 1;
+  while (capacity < minElements) { capacity <<= 1; }
+  mask = capacity - 1;
+  //  The indices and the slots share one aligned block, the slots starting on their own line
+  u32 slotsOffset = (sizeof(_ws_spsc_indices) + WS_CACHE_LINE_SIZE - 1) & ~(WS_CACHE_LINE_SIZE - 1);
+  u8* block = (u8*)wsMem.allocatePrimaryAligned(slotsOffset + sizeof(ClassType)*capacity,
+                                                WS_CACHE_LINE_SIZE, myTier);
+  wsAssert((block != NULL), "Could not allocate wsSPSCQueue storage.");
+  indices = new (block) _ws_spsc_indices();
+  indices->readIndex.store(0, std::memory_order_relaxed);
+  indices->writeIndex.store(0, std::memory_order_relaxed);
+  indices->cachedWriteIndex = 0;
+  indices->cachedReadIndex = 0;
+  slots = (ClassType*)(block + slotsOffset);
+}
+
+template <class ClassType>
+u32 wsSPSCQueue<ClassType>::claimWritable(u32 write, u32 numWanted) {
+  u32 numFree = getCapacity() - (write - indices->cachedReadIndex);
+  if (numFree < numWanted) {
+    //  Only look at the consumer's line when the cached view has run out
+    indices->cachedReadIndex = indices->readIndex.load(std::memory_order_acquire);
+    numFree = getCapacity() - (write - indices->cachedReadIndex);
+  }
+  return (numFree < numWanted) ? numFree : numWanted;
+}
+
+template <class ClassType>
+u32 wsSPSCQueue<ClassType>::claimReadable(u32 read, u32 numWanted) {
+  u32 numReady = indices->cachedWriteIndex - read;
+  if (numReady < numWanted) {
+    indices->cachedWriteIndex = indices->writeIndex.load(std::memory_order_acquire);
+    numReady = indices->cachedWriteIndex - read;
+  }
+  return (numReady < numWanted) ? numReady : numWanted;
+}
+
+template <class ClassType>
+bool wsSPSCQueue<ClassType>::push(const ClassType& object) {
+  return emplace(object);
+}
+
+template <class ClassType>
+bool wsSPSCQueue<ClassType>::push(ClassType&& object) {
+  return emplace(std::move(object));
+}
+
+template <class ClassType>
+template <class... Args>
+bool wsSPSCQueue<ClassType>::emplace(Args&&... args) {
+  u32 write = indices->writeIndex.load(std::memory_order_relaxed);
+  if (claimWritable(write, 1) == 0) { return false; }
+  new (&slots[write & mask]) ClassType(std::forward<Args>(args)...);
+  indices->writeIndex.store(write + 1, std::memory_order_release);
+  return true;
+}
+
+template <class ClassType>
+u32 wsSPSCQueue<ClassType>::pushBatch(const ClassType* items, u32 numItems) {
+  u32 write = indices->writeIndex.load(std::memory_order_relaxed);
+  u32 numPushed = claimWritable(write, numItems);
+  for (u32 i = 0; i < numPushed; ++i) {
+    new (&slots[(write + i) & mask]) ClassType(items[i]);
+  }
+  //  A single release publishes the whole batch
+  indices->writeIndex.store(write + numPushed, std::memory_order_release);
+  return numPushed;
+}
+
+template <class ClassType>
+bool wsSPSCQueue<ClassType>::pop(ClassType& myItem) {
+  u32 read = indices->readIndex.load(std::memory_order_relaxed);
+  if (claimReadable(read, 1) == 0) { return false; }
+  ClassType* slot = &slots[read & mask];
+  myItem = std::move(*slot);
+  slot->~ClassType();
+  indices->readIndex.store(read + 1, std::memory_order_release);
+  return true;
+}
+
+template <class ClassType>
+u32 wsSPSCQueue<ClassType>::popBatch(ClassType* items, u32 maxItems) {
+  u32 read = indices->readIndex.load(std::memory_order_relaxed);
+  u32 numPopped = claimReadable(read, maxItems);
+  for (u32 i = 0; i < numPopped; ++i) {
+    ClassType* slot = &slots[(read + i) & mask];
+    items[i] = std::move(*slot);
+    slot->~ClassType();
+  }
+  indices->readIndex.store(read + numPopped, std::memory_order_release);
+  return numPopped;
+}
+
+#endif  /*  WS_SPSC_QUEUE_H_ */
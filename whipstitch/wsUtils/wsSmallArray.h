@@ -0,0 +1,224 @@
+/*
+ *      wsSmallArray.h
+ *
+ *      This file declares and implements the class wsSmallArray, a growable array
+ *      which keeps its first few elements inside the object itself, so short lists
+ *      never touch the memory stack at all. Once the inline storage is exhausted the
+ *      array moves to a block in its chosen Primary Stack tier and grows
+ *      geometrically from there, exactly as wsArray does.
+ *
+ *      Unlike the other containers, a wsSmallArray is meant to be stored by value.
+ *      Copying one copies its elements.
+ *
+ *      Usage:
+ *        wsSmallArray<wsCamera*, 4> myCams;
+ *        myCams.push(myCam);
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_SMALL_ARRAY_H_
+#define WS_SMALL_ARRAY_H_
+
+#include "wsMemoryStack.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
+template <class ClassType, u32 numInline>
+class wsSmallArray {
+  protected:
+    //  Raw storage for the inline elements; constructed only as they are pushed
+    alignas(ClassType) u8 inlineBytes[sizeof(ClassType)*numInline];
+    ClassType* array;
+    u32 length;
+    u32 maxElements;
+    wsMemoryStack::_ws_memstack_tier tier;
+    //  Moves the array to a stack block which can hold at least minElements
+    void grow(u32 minElements);
+  public:
+    /*  Constructors and Destructor */
+    wsSmallArray(wsMemoryStack::_ws_memstack_tier myTier = wsMem.getCurrentTier());
+    wsSmallArray(const wsSmallArray& other);
+    ~wsSmallArray() { clear(); }
+    wsSmallArray& operator=(const wsSmallArray& other);
+    /*  Accessors   */
+    ClassType* getArray() { return array; }
+    const ClassType* getArray() const { return array; }
+    u32 getLength() const { return length; }
+    u32 getMaxElements() const { return maxElements; }
+    bool isEmpty() const { return (length == 0); }
+    bool isNotEmpty() const { return (length > 0); }
+    //  True while the elements are still stored inside the object
+    bool isInline() const { return (array == (ClassType*)inlineBytes); }
+    ClassType& operator[](u32 index) {
+      wsAssert((index < length), "wsSmallArray index out of range.");
+      return array[index];
+    }
+    const ClassType& operator[](u32 index) const {
+      wsAssert((index < length), "wsSmallArray index out of range.");
+      return array[index];
+    }
+    ClassType& back() {
+      wsAssert((length > 0), "Cannot retrieve an item from an empty wsSmallArray.");
+      return array[length-1];
+    }
+    /*  Operational Methods */
+    //  Removes all items from the array, keeping its storage
+    void clear();
+    //  Adds the item to the end of the array and returns the new length
+    u32 push(const ClassType& object);
+    u32 push(ClassType&& object);
+    //  Constructs an item in place at the end of the array and returns a reference to it
+    template <class... Args>
+    ClassType& emplace(Args&&... args);
+    //  Removes the last item from the array
+    void pop();
+    //  Removes the item at the given index, preserving the order of the other items
+    void remove(u32 index);
+    //  Ensures the array can hold numElements without reallocating
+    void reserve(u32 numElements);
+};
+
+/*  Member Functions for wsSmallArray  */
+//  Constructors
+template <class ClassType, u32 numInline>
+wsSmallArray<ClassType, numInline>::wsSmallArray(wsMemoryStack::_ws_memstack_tier myTier) {
+  array = (ClassType*)inlineBytes;
+  length = 0;
+  maxElements = numInline;
+  tier = myTier;
+}
+
+template <class ClassType, u32 numInline>
+wsSmallArray<ClassType, numInline>::wsSmallArray(const wsSmallArray& other) {
+  array = (ClassType*)inlineBytes;
+  length = 0;
+  maxElements = numInline;
+  tier = other.tier;
+  reserve(other.length);
+  for (u32 i = 0; i < other.length; ++i) {
+    new (&array[i]) ClassType(other.array[i]);
+  }
+  length = other.length;
+}
+
+template <class ClassType, u32 numInline>
+wsSmallArray<ClassType, numInline>& wsSmallArray<ClassType, numInline>::operator=(const wsSmallArray& other) {
+  if (this == &other) { return *this; }
+  clear();
+  reserve(other.length);
+  for (u32 i = 0; i < other.length; ++i) {
+    new (&array[i]) ClassType(other.array[i]);
+  }
+  length = other.length;
+  return *this;
+}
+
+template <class ClassType, u32 numInline>
+void wsSmallArray<ClassType, numInline>::grow(u32 minElements) {
+  u32 newMaxElements = maxElements*2;
+  if (newMaxElements < minElements) { newMaxElements = minElements; }
+  if (!isInline() && wsMem.extendPrimary(array, sizeof(ClassType)*maxElements,
+                                          sizeof(ClassType)*newMaxElements, tier)) {
+    maxElements = newMaxElements;
+    return;
+  }
+  ClassType* newArray = (ClassType*)wsMem.allocatePrimary(sizeof(ClassType)*newMaxElements, tier);
+  wsAssert((newArray != NULL), "Could not grow wsSmallArray storage.");
+  for (u32 i = 0; i < length; ++i) {
+    new (&newArray[i]) ClassType(std::move(array[i]));
+    array[i].~ClassType();
+  }
+  array = newArray;
+  maxElements = newMaxElements;
+}
+
+template <class ClassType, u32 numInline>
+void wsSmallArray<ClassType, numInline>::clear() {
+  for (u32 i = 0; i < length; ++i) {
+    array[i].~ClassType();
+  }
+  length = 0;
+}
+
+template <class ClassType, u32 numInline>
+u32 wsSmallArray<ClassType, numInline>::push(const ClassType& object) {
+  if (length == maxElements) {
+    //  The object may live inside this array, so copy it before reallocating
+    ClassType tmp(object);
+    grow(length+1);
+    new (&array[length]) ClassType(std::move(tmp));
+  }
+  else {
+    new (&array[length]) ClassType(object);
+  }
+  return ++length;
+}
+
+template <class ClassType, u32 numInline>
+u32 wsSmallArray<ClassType, numInline>::push(ClassType&& object) {
+  if (length == maxElements) {
+    ClassType tmp(std::move(object));
+    grow(length+1);
+    new (&array[length]) ClassType(std::move(tmp));
+  }
+  else {
+    new (&array[length]) ClassType(std::move(object));
+  }
+  return ++length;
+}
+
+template <class ClassType, u32 numInline>
+template <class... Args>
+ClassType& wsSmallArray<ClassType, numInline>::emplace(Args&&... args) {
+  if (length == maxElements) {
+    grow(length+1);
+  }
+  new (&array[length]) ClassType(std::forward<Args>(args)...);
+  return array[length++];
+}
+
+template <class ClassType, u32 numInline>
+void wsSmallArray<ClassType, numInline>::pop() {
+  if (length == 0) { return; }
+  array[--length].~ClassType();
+}
+
+template <class ClassType, u32 numInline>
+void wsSmallArray<ClassType, numInline>::remove(u32 index) {
+  wsAssert((index < length), "wsSmallArray index out of range.");
+  for (u32 i = index; i+1 < length; ++i) {
+    array[i] = std::move(array[i+1]);
+  }
+  array[--length].~ClassType();
+}
+
+template <class ClassType, u32 numInline>
+void wsSmallArray<ClassType, numInline>::reserve(u32 numElements) {
+  if (numElements > maxElements) {
+    grow(numElements);
+  }
+}
+
+#endif  /*  WS_SMALL_ARRAY_H_ */
@@ -6,6 +6,14 @@
  *      This file declares and implements the class wsStack, which is a generic
  *      (templated) stack object for the Whipstitch Game Engine.
  *
+ *      The stack grows geometrically when it runs out of room. Permanent stacks take
+ *      their memory from the Primary Stack tier which was current when they were
+ *      created; temporary stacks take theirs from the current frame.
+ *
+ *      Items are constructed in place by emplace, or moved in by push; popping moves
+ *      the item out. Popping an empty stack is an error, so callers which cannot know
+ *      ahead of time should use pop(ClassType&), which returns false instead.
+ *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
  *
@@ -33,12 +41,25 @@
 #ifndef WS_STACK_H_
 #define WS_STACK_H_
 
+#include "wsMemoryStack.h"
+#include <new>      //  Placement new
+#include <utility>  //  std::move, std::forward
+
 template <class ClassType>
 class wsStack {
     protected:
         ClassType* stack;
         u32 length;
         u32 maxElements;
+        wsMemoryStack::_ws_memstack_tier tier;
+        bool temporary;
+        //  Doubles the size of the stack, keeping its contents
+        void grow();
+        //  Returns the address for a new top item, growing as needed
+        ClassType* claimTop() {
+            if (length == maxElements) { grow(); }
+            return &stack[length++];
+        }
     public:
         /*  Constructor */
         wsStack(const u32 maxStackSize = 32, const bool temporary = false);
@@ -51,16 +72,27 @@ class wsStack {
         bool isNotFull() { return (length != maxElements); }
         /*  Operational Methods */
         void clear();   //  Removes all items from the stack
-        u32 push(ClassType object); //  Adds the item and returns the new length
+        //  Adds the item and returns the new length
+        u32 push(const ClassType& object);
+        u32 push(ClassType&& object);
+        //  Constructs an item in place on top of the stack and returns a reference to it
+        template <class... Args>
+        ClassType& emplace(Args&&... args) {
+            return *(new (claimTop()) ClassType(std::forward<Args>(args)...));
+        }
         ClassType pop();   //  Removes and returns the top item of the stack
-        ClassType top();   //  Returns the top item of the stack without removing it
+        bool pop(ClassType& object);   //  Moves the top item into object; false if empty
+        ClassType& top();   //  Returns the top item of the stack without removing it
 };
 
 /*  Member Functions for wsStack  */
 //  Constructor
 template <class ClassType>
 wsStack<ClassType>::wsStack(const u32 maxStackSize, const bool temporary) {
+    wsAssert((maxStackSize > 0), "wsStack must have room for more than 0 elements.");
     maxElements = maxStackSize;
+    tier = wsMem.getCurrentTier();
+    this->temporary = temporary;
     if (temporary) {
         stack = wsNewArrayTmp(ClassType, maxElements);
     }
@@ -71,28 +103,85 @@ wsStack<ClassType>::wsStack(const u32 maxStackSize, const bool temporary) {
 }
 
 template <class ClassType>
-u32 wsStack<ClassType>::push(ClassType object) {
-    if (length == maxElements) { return length; }
-    stack[length] = object;
-    return ++length;
+void wsStack<ClassType>::grow() {
+    u32 newMaxElements = maxElements*2;
+    wsEcho(WS_LOG_UTIL, "Growing wsStack from %u to %u elements\n", maxElements, newMaxElements);
+    if (!temporary && wsMem.extendPrimary(stack, sizeof(ClassType)*maxElements,
+                                            sizeof(ClassType)*newMaxElements, tier)) {
+        maxElements = newMaxElements;
+        return;
+    }
+    ClassType* newStack;
+    if (temporary) {
+        newStack = wsNewArrayTmp(ClassType, newMaxElements);
+    }
+    else {
+        newStack = (ClassType*)wsMem.allocatePrimary(sizeof(ClassType)*newMaxElements, tier);
+    }
+    wsAssert((newStack != NULL), "Could not grow wsStack storage.");
+    for (u32 i = 0; i < length; ++i) {
+        new (&newStack[i]) ClassType(std::move(stack[i]));
+        stack[i].~ClassType();
+    }
+    stack = newStack;
+    maxElements = newMaxElements;
+}
+
+//  The pushed object may live inside this stack, so it is copied aside before growing
+template <class ClassType>
+u32 wsStack<ClassType>::push(const ClassType& object) {
+    if (length == maxElements) {
+        ClassType tmp(object);
+        new (claimTop()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimTop()) ClassType(object);
+    }
+    return length;
+}
+
+template <class ClassType>
+u32 wsStack<ClassType>::push(ClassType&& object) {
+    if (length == maxElements) {
+        ClassType tmp(std::move(object));
+        new (claimTop()) ClassType(std::move(tmp));
+    }
+    else {
+        new (claimTop()) ClassType(std::move(object));
+    }
+    return length;
 }
 
 template <class ClassType>
 void wsStack<ClassType>::clear() {
+    for (u32 i = 0; i < length; ++i) {
+        stack[i].~ClassType();
+    }
     length = 0;
 }
 
 template <class ClassType>
 ClassType wsStack<ClassType>::pop() {
-    if (length == 0) { return ClassType(); }
-    return stack[--length];
+    wsAssert((length > 0), "Cannot pop an item from an empty wsStack.");
+    --length;
+    ClassType object(std::move(stack[length]));
+    stack[length].~ClassType();
+    return object;
 }
 
 template <class ClassType>
-ClassType wsStack<ClassType>::top() {
-    if (length == 0) { return ClassType(); }
-    return stack[length-1];
+bool wsStack<ClassType>::pop(ClassType& object) {
+    if (length == 0) { return false; }
+    --length;
+    object = std::move(stack[length]);
+    stack[length].~ClassType();
+    return true;
 }
 
+template <class ClassType>
+ClassType& wsStack<ClassType>::top() {
+    wsAssert((length > 0), "Cannot retrieve an item from an empty wsStack.");
+    return stack[length-1];
+}
 
 #endif /*   WS_STACK_H_ */
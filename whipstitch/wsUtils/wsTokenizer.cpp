@@ -0,0 +1,126 @@
+/*
+ * wsTokenizer.cpp
+ *
+ *    This file implements the class wsTokenizer.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsTokenizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+//  Longer than any number written by the exporters
+#define WS_MAX_NUMBER_LENGTH 64
+
+f32 wsTokenizer::readF32Slow() {
+  //  strtof(...) needs a terminated string, which a mapped file cannot promise
+  char buffer[WS_MAX_NUMBER_LENGTH];
+  u32 length = 0;
+  while (pos + length < end && length < WS_MAX_NUMBER_LENGTH-1 && !isSpace(pos[length])) {
+    buffer[length] = pos[length];
+    ++length;
+  }
+  buffer[length] = '\0';
+  char* numberEnd;
+  f32 my = strtof(buffer, &numberEnd);
+  if (numberEnd == buffer) {
+    failed = true;
+    return 0.0f;
+  }
+  pos += (numberEnd - buffer);
+  return my;
+}
+
+bool wsTokenizer::lookingAt(const char* word) {
+  skipWhitespace();
+  u32 length = strlen(word);
+  return ((u64)(end - pos) >= length && memcmp(pos, word, length) == 0);
+}
+
+bool wsTokenizer::expect(const char* text) {
+  if (failed) { return false; }
+  skipWhitespace();
+  while (*text) {
+    if (isSpace(*text)) {
+      skipWhitespace();
+      while (isSpace(*text)) { ++text; }
+      continue;
+    }
+    if (pos >= end || *pos != *text) {
+      failed = true;
+      return false;
+    }
+    ++pos;
+    ++text;
+  }
+  return true;
+}
+
+const char* wsTokenizer::findLine(const char* from, const char* word) const {
+  u32 length = strlen(word);
+  const char* p = from;
+  while (p < end) {
+    const char* match = (const char*)memmem(p, end - p, word, length);
+    if (match == WS_NULL) { break; }
+    //  Only blanks may come between the start of the line and the word
+    const char* lineStart = match;
+    while (lineStart > begin && (lineStart[-1] == ' ' || lineStart[-1] == '\t')) { --lineStart; }
+    if (lineStart >= from && (lineStart == begin || lineStart[-1] == '\n')) {
+      return lineStart;
+    }
+    p = match + 1;
+  }
+  return end;
+}
+
+const char* wsTokenizer::find(const char* text) const {
+  const char* match = (const char*)memmem(pos, end - pos, text, strlen(text));
+  return (match == WS_NULL) ? end : match;
+}
+
+bool wsTokenizer::readWord(char* dest, u32 size) {
+  if (failed) { return false; }
+  skipWhitespace();
+  u32 length = 0;
+  while (pos < end && !isSpace(*pos)) {
+    if (length < size-1) { dest[length++] = *pos; }
+    ++pos;
+  }
+  dest[length] = '\0';
+  if (length == 0) { failed = true; }
+  return !failed;
+}
+
+bool wsTokenizer::readLine(char* dest, u32 size) {
+  if (failed) { return false; }
+  u32 length = 0;
+  while (pos < end && *pos != '\t' && *pos != '\n') {
+    if (length < size-1) { dest[length++] = *pos; }
+    ++pos;
+  }
+  dest[length] = '\0';
+  if (length == 0) { failed = true; }
+  return !failed;
+}
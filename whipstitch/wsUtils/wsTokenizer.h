@@ -0,0 +1,188 @@
+/*
+ * wsTokenizer.h
+ *
+ *    This file declares the class wsTokenizer, a single-pass reader for the engine's
+ *    text formats (.wsMesh, .wsAnim and the like) working directly on a buffer in
+ *    memory, such as a wsMappedFile.
+ *
+ *    Each read follows the rules of the scanf conversion it replaces, and numbers
+ *    convert to exactly the same values, so files read the same as they did through
+ *    fscanf(...). Unlike fscanf there is no format string to interpret on every call:
+ *      expect("joint {")       matches literal text after any whitespace; whitespace
+ *                              in the text matches any amount, as in a format
+ *      readF32(...)            %f
+ *      readU32(...) readI32()  %u %d
+ *      readWord(...)           %s
+ *      readLine(...)           %[^\t\n]
+ *
+ *    A tokenizer covers the range [pos, end), so several may work through different
+ *    parts of one file at once. The first read which fails marks the tokenizer as
+ *    failed; later reads then do nothing, and the caller checks hasFailed() once.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_TOKENIZER_H_
+#define WS_TOKENIZER_H_
+
+#include "wsPlatform.h"
+
+class wsTokenizer {
+  private:
+    const char* begin;
+    const char* pos;
+    const char* end;
+    bool failed;
+    //  Converts a number which the fast path of readF32(...) cannot convert exactly
+    f32 readF32Slow();
+    static bool isSpace(char c) { return (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f'); }
+    static bool isDigit(char c) { return ((u8)(c - '0') < 10); }
+  public:
+    wsTokenizer(const char* myBegin, const char* myEnd) : begin(myBegin), pos(myBegin), end(myEnd), failed(false) {}
+    /*  Accessors   */
+    const char* getPos() const { return pos; }
+    const char* getEnd() const { return end; }
+    bool hasFailed() const { return failed; }
+    void setPos(const char* myPos) { pos = myPos; }
+    void setEnd(const char* myEnd) { end = myEnd; }
+    /*  Operational Methods */
+    //  True once only whitespace remains
+    bool atEnd() { skipWhitespace(); return (pos >= end); }
+    //  True if the next token begins with the given word, which is not consumed
+    bool lookingAt(const char* word);
+    //  Skips whitespace, then matches literal text as a scanf format would
+    bool expect(const char* text);
+    //  Returns the start of the first line at or after from whose first token is the
+    //  given word, or end if there is none. Used to split a block of records between
+    //  threads.
+    const char* findLine(const char* from, const char* word) const;
+    //  Returns the start of the first occurrence of the text at or after the current
+    //  position, or end if there is none. Does not move.
+    const char* find(const char* text) const;
+    bool readF32(f32& my);
+    //  Reads count numbers into consecutive floats, as "%f %f ..." would
+    bool readF32s(f32* dest, u32 count);
+    bool readI32(i32& my);
+    bool readU32(u32& my);
+    //  Reads one whitespace-delimited word of at most size-1 characters
+    bool readWord(char* dest, u32 size);
+    //  Reads the rest of the line, up to a tab or newline, of at most size-1 characters
+    bool readLine(char* dest, u32 size);
+    void skipWhitespace() {
+      while (pos < end && isSpace(*pos)) { ++pos; }
+    }
+};
+
+/*  Inline Member Functions  */
+inline bool wsTokenizer::readU32(u32& my) {
+  if (failed) { return false; }
+  skipWhitespace();
+  const char* p = pos;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) { negative = (*p == '-'); ++p; }
+  if (p >= end || !isDigit(*p)) { failed = true; return false; }
+  u32 value = 0;
+  while (p < end && isDigit(*p)) {
+    value = value*10 + (u32)(*p - '0');
+    ++p;
+  }
+  //  scanf negates %u values too
+  my = negative ? (0u - value) : value;
+  pos = p;
+  return true;
+}
+
+inline bool wsTokenizer::readI32(i32& my) {
+  u32 value;
+  if (!readU32(value)) { return false; }
+  my = (i32)value;
+  return true;
+}
+
+inline bool wsTokenizer::readF32(f32& my) {
+  //  Powers of ten which a float holds exactly
+  static const f32 powersOfTen[11] = {  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                        1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+  if (failed) { return false; }
+  skipWhitespace();
+  const char* p = pos;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) { negative = (*p == '-'); ++p; }
+  u64 mantissa = 0;
+  u32 numDigits = 0;  //  Significant digits, not counting leading zeros
+  i32 exponent = 0;
+  bool anyDigits = false;
+  while (p < end && isDigit(*p)) {
+    mantissa = mantissa*10 + (u64)(*p - '0');
+    numDigits += (mantissa != 0);
+    anyDigits = true;
+    ++p;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    while (p < end && isDigit(*p)) {
+      mantissa = mantissa*10 + (u64)(*p - '0');
+      numDigits += (mantissa != 0);
+      --exponent;
+      anyDigits = true;
+      ++p;
+    }
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* expStart = p + 1;
+    bool expNegative = false;
+    if (expStart < end && (*expStart == '-' || *expStart == '+')) {
+      expNegative = (*expStart == '-');
+      ++expStart;
+    }
+    if (expStart < end && isDigit(*expStart)) {
+      i32 expValue = 0;
+      for (p = expStart; p < end && isDigit(*p) && expValue < 10000; ++p) {
+        expValue = expValue*10 + (*p - '0');
+      }
+      exponent += expNegative ? -expValue : expValue;
+    }
+  }
+  //  With the mantissa and power of ten both exact, one multiply or divide rounds
+  //  correctly, giving the same value as strtof(...). Anything else takes the slow path.
+  if (!anyDigits || numDigits > 19 || mantissa > (1u << 24) || exponent < -10 || exponent > 10 ||
+      (p < end && !isSpace(*p) && *p != '}')) {
+    my = readF32Slow();
+    return !failed;
+  }
+  f32 value = (f32)mantissa;
+  value = (exponent < 0) ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+  my = negative ? -value : value;
+  pos = p;
+  return true;
+}
+
+inline bool wsTokenizer::readF32s(f32* dest, u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    readF32(dest[i]);
+  }
+  return !failed;
+}
+
+#endif /* WS_TOKENIZER_H_ */
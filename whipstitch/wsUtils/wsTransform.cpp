@@ -61,6 +61,15 @@ wsTransform::wsTransform(   f32 myScale, const quat& myRotation,
   translationZ = myTranslationZ;
 }
 
+wsTransform::wsTransform(const mat34& affine) {
+  WS_PROFILE();
+  rotation = affine.getRotation();
+  scale = affine.getScale();
+  translationX = affine.data[3];
+  translationY = affine.data[7];
+  translationZ = affine.data[11];
+}
+
 //  Operational member functions
 
 vec4 wsTransform::getTranslation() const {
@@ -147,14 +156,11 @@ wsTransform& wsTransform::toBlend(const wsTransform& other, f32 blendFactor) {
 
 mat4 wsTransform::toMatrix() const {
   WS_PROFILE();
-  mat4 my;
-  my.data[0] = scale;
-  my.data[5] = scale;
-  my.data[10] = scale;
-  my.setRotation(rotation);
-  my.setTranslation(translationX, translationY, translationZ);
+  return toAffine().toMat4();
+}
 
-  return my;
+mat34 wsTransform::toAffine() const {
+  return mat34(scale, rotation, vec4(translationX, translationY, translationZ));
 }
 
 void wsTransform::print(u16 printLog) const {
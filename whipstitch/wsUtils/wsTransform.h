@@ -43,6 +43,7 @@
 #include "wsOperations.h"
 #include "quat.h"
 #include "mat4.h"
+#include "mat34.h"
 
 #if WS_PHYSICS_BACKEND == WS_BACKEND_BULLET
   #include "btBulletDynamicsCommon.h"
@@ -77,6 +78,8 @@
     wsTransform() : translationX(0.0f), translationY(0.0f), translationZ(0.0f), scale(1.0f) {}
     wsTransform(f32 myScale, const quat& myRotation, const vec4& translation);
     wsTransform(f32 myScale, const quat& myRotation, f32 myTranslationX, f32 myTranslationY, f32 myTranslationZ);
+    //  Recovers the scale, rotation and translation of an affine matrix without shear
+    explicit wsTransform(const mat34& affine);
     //  Setters and Getters
     vec4 getTranslation() const;
     wsTransform& setRotation(const quat& myRot) {
@@ -106,6 +109,8 @@
     wsTransform& toBlend(const wsTransform& other, f32 blendFactor);
     //  Returns a 4x4 Matrix with the transform's properties
     mat4 toMatrix() const;
+    //  Returns the 3x4 affine matrix with the transform's properties
+    mat34 toAffine() const;
     void print(u16 printLog = WS_LOG_MAIN) const;
 };
 
@@ -5,9 +5,9 @@
  *      Author: dsnettleton
  *
  *      This file implements some useful trigonometric operations,
- *      which are optimized for speed on this engine. The operations
- *      utilize a set of lookup tables, sacrificing some accuracy
- *      for a lot more speed.
+ *      which are optimized for speed on this engine. Each operation
+ *      reduces its argument to a small range and evaluates a
+ *      polynomial there, exactly as the SIMD versions in wsTrig.h do.
  *
  *  This software is provided under the terms of the MIT license
  *  Copyright (c) D. Scott Nettleton, 2013
@@ -36,72 +36,106 @@
 #include "wsTrig.h"
 #include "wsOperations.h"
 
-//  Implement Trig Tables
-f32 sine_table[512];
-f32 cosine_table[512];
-f32 tangent_table[512];
-
-//  This function builds the lookup tables used by the trig engine
-void genLookupTables() {
+void wsSinCos(f32 degrees, f32* outSin, f32* outCos) {
     WS_PROFILE();
-    for (i32 i = 0; i < 512; ++i) {
-        f64 radians = (f64) i * TWO_PI / 512.0;
-        sine_table[i] = (f32) sin(radians);
-        cosine_table[i] = (f32) cos(radians);
-        if (radians != HALF_PI) {
-            tangent_table[i] = (f32) tan(radians);
-        }
-        else {
-            tangent_table[i] = 999999999999.0f; //  A really big number
-        }
+    //  Reduce to [-45, 45] degrees; the quadrant decides which polynomial is the sine
+    f32 quarters = degrees * (1.0f/90.0f);
+    i32 quadrant = (i32)(quarters + ((quarters >= 0.0f) ? 0.5f : -0.5f));
+    f32 rads = (degrees - (f32)quadrant*90.0f) * DEG_TO_RAD;
+    f32 rads2 = rads*rads;
+    f32 sine = ((WS_SIN_P0*rads2 + WS_SIN_P1)*rads2 + WS_SIN_P2)*rads2*rads + rads;
+    f32 cosine = ((WS_COS_P0*rads2 + WS_COS_P1)*rads2 + WS_COS_P2)*rads2*rads2 - 0.5f*rads2 + 1.0f;
+    switch (quadrant & 3) {
+        case 0:
+            *outSin = sine;
+            *outCos = cosine;
+            break;
+        case 1:
+            *outSin = cosine;
+            *outCos = -sine;
+            break;
+        case 2:
+            *outSin = -sine;
+            *outCos = -cosine;
+            break;
+        default:
+            *outSin = -cosine;
+            *outCos = sine;
+            break;
     }
-
 }
 
-//  These trig functions require the operation DEG_TO_RAD*(512.0f / TWO_PI)
-//  This can be simplified to the constant:
-#define TRIG_OPTIMIZER 1.422222222222f
-
 f32 wsSin(f32 degrees) {
-    WS_PROFILE();
-    i_f_hybrid mybrid(degrees * TRIG_OPTIMIZER + BIAS_NEG.f);
-    f32 my = sine_table[(mybrid.i & 511)];
+    f32 sine, cosine;
+    wsSinCos(degrees, &sine, &cosine);
 
-    return my;
+    return sine;
 }
+
 f32 wsCos(f32 degrees) {
-    WS_PROFILE();
-    i_f_hybrid mybrid(degrees * TRIG_OPTIMIZER + BIAS_NEG.f);
-    f32 my = cosine_table[(mybrid.i & 511)];
+    f32 sine, cosine;
+    wsSinCos(degrees, &sine, &cosine);
 
-    return my;
+    return cosine;
 }
 
 f32 wsTan(f32 degrees) {
-    WS_PROFILE();
-    i_f_hybrid mybrid(degrees * TRIG_OPTIMIZER + BIAS_NEG.f);
-    f32 my = tangent_table[(mybrid.i & 511)];
+    f32 sine, cosine;
+    wsSinCos(degrees, &sine, &cosine);
+
+    return sine / cosine;
+}
 
-    return my;
+//  Arcsine of val in radians, for |val| <= 0.5
+inline f32 wsArcSinSmall(f32 val) {
+    f32 z = val*val;
+    f32 poly = (((WS_ASIN_P0*z + WS_ASIN_P1)*z + WS_ASIN_P2)*z + WS_ASIN_P3)*z + WS_ASIN_P4;
+    return val*z*poly + val;
 }
 
 f32 wsArcSin(f32 val) {
     WS_PROFILE();
-    f32 my = asinf(val)*RAD_TO_DEG;
-
-    return my;
+    return 90.0f - wsArcCos(val);
 }
 
 f32 wsArcCos(f32 val) {
     WS_PROFILE();
-    f32 my = acosf(val)*RAD_TO_DEG;
+    val = (val > 1.0f) ? 1.0f : ((val < -1.0f) ? -1.0f : val);
+    if (val > 0.5f) {
+        //  Beyond 0.5, asin(x) is taken from asin(sqrt((1-x)/2)) for accuracy
+        return 2.0f*wsArcSinSmall(sqrtf(0.5f*(1.0f - val))) * RAD_TO_DEG;
+    }
+    if (val < -0.5f) {
+        return (PI - 2.0f*wsArcSinSmall(sqrtf(0.5f*(1.0f + val)))) * RAD_TO_DEG;
+    }
 
-    return my;
+    return (HALF_PI - wsArcSinSmall(val)) * RAD_TO_DEG;
 }
 
 f32 wsArcTan(f32 valX, f32 valY) {
     WS_PROFILE();
-    f32 my = atan2f(valX, valY)*RAD_TO_DEG;
+    f32 absX = fabsf(valX);
+    f32 absY = fabsf(valY);
+    f32 larger = (absX > absY) ? absX : absY;
+    f32 ratio = ((absX > absY) ? absY : absX) / ((larger > 1.0e-30f) ? larger : 1.0e-30f);
+    f32 my = 0.0f;
+    //  Reduce the ratio to within tan(PI/8) of zero
+    if (ratio > WS_TAN_PI_8) {
+        ratio = (ratio - 1.0f) / (ratio + 1.0f);
+        my = 0.25f*PI;
+    }
+    f32 z = ratio*ratio;
+    my += (((WS_ATAN_P0*z + WS_ATAN_P1)*z + WS_ATAN_P2)*z + WS_ATAN_P3)*z*ratio + ratio;
+    //  Unfold the octant: swap the axes, then mirror by the signs of X and Y
+    if (absX > absY) {
+        my = HALF_PI - my;
+    }
+    if (signbit(valY)) {
+        my = PI - my;
+    }
+    if (signbit(valX)) {
+        my = -my;
+    }
 
-    return my;
+    return my * RAD_TO_DEG;
 }
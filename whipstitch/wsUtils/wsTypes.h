@@ -63,6 +63,7 @@ struct wsIndexArray {
   u32* indices;
   u32 numIndices;
   u32 handle;
+  u32 indexSize;  //  Bytes per index in the GL buffer, 2 when every index fits
 };
 
 //  The following is a hybrid 32-bit int/float format, useful
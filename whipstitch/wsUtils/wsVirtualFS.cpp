@@ -0,0 +1,132 @@
+/*
+ * wsVirtualFS.cpp
+ *
+ *    This file implements the class wsVirtualFS.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "wsVirtualFS.h"
+#include "wsMemoryStack.h"
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+wsVirtualFS wsVFS;
+
+void wsVirtualFS::startUp(u32 myMaxPaks) {
+  wsEcho(WS_LOG_UTIL, "Starting up Virtual File System\n");
+  maxPaks = myMaxPaks;
+  numPaks = 0;
+  paks = wsNewArray(wsPakFile, maxPaks);
+  for (u32 i = 0; i < maxPaks; ++i) {
+    new (&paks[i]) wsPakFile();
+  }
+  _mInitialized = true;
+}
+
+void wsVirtualFS::shutDown() {
+  wsEcho(WS_LOG_UTIL, "Shutting down Virtual File System\n");
+  _mInitialized = false;
+  manifest.close();
+  for (u32 i = 0; i < numPaks; ++i) {
+    paks[i].close();
+  }
+  numPaks = 0;
+}
+
+bool wsVirtualFS::contains(const char* filepath) const {
+  wsAssert(_mInitialized, "Initialize the Virtual File System first.");
+  for (u32 i = 0; i < numPaks; ++i) {
+    if (paks[i].find(filepath)) { return true; }
+  }
+  return false;
+}
+
+bool wsVirtualFS::exists(const char* filepath) const {
+  if (_mInitialized && contains(filepath)) { return true; }
+  FILE* pFile = fopen(filepath, "rb");
+  if (pFile != WS_NULL) {
+    fclose(pFile);
+    return true;
+  }
+  //  A shipped game may hold only the cooked file
+  const char* cooked = findCooked(filepath);
+  return (cooked != WS_NULL && strcmp(cooked, wsPakPath(filepath)) != 0 && exists(cooked));
+}
+
+const char* wsVirtualFS::findCooked(const char* filepath) const {
+  const wsManifestAsset* asset = manifest.find(filepath);
+  return (asset != WS_NULL) ? asset->cooked : WS_NULL;
+}
+
+bool wsVirtualFS::findCurrentCooked(char* dest, const char* filepath, const char* extension, u32 size) const {
+  const wsManifestAsset* asset = manifest.find(filepath);
+  if (asset != WS_NULL && strcmp(asset->cooked, wsPakPath(filepath)) != 0 && strlen(asset->cooked) < size) {
+    //  A loose source edited since it was cooked is loaded in place of its cooked file
+    boost::system::error_code error;
+    const u64 sourceSize = (u64)wsFile::file_size(filepath, error);
+    if (!error && (sourceSize != asset->sourceSize || (i64)wsFile::last_write_time(filepath, error) != asset->sourceTime)) {
+      wsEcho(WS_LOG_UTIL, "\"%s\" has changed since it was cooked; loading it in place of \"%s\"\n", filepath,
+              asset->cooked);
+      return false;
+    }
+    strcpy(dest, asset->cooked);
+    return true;
+  }
+  return (wsCookedPath(dest, filepath, extension, size) && (contains(dest) || (wsFile::exists(dest) &&
+          (!wsFile::exists(filepath) || wsFile::last_write_time(dest) >= wsFile::last_write_time(filepath)))));
+}
+
+bool wsVirtualFS::mount(const char* filepath) {
+  wsAssert(_mInitialized, "Initialize the Virtual File System first.");
+  if (numPaks >= maxPaks) {
+    wsEcho(WS_LOG_ERROR, "Cannot mount \"%s\"; %u packs are already mounted", filepath, maxPaks);
+    return false;
+  }
+  if (!paks[numPaks].open(filepath)) { return false; }
+  wsEcho(WS_LOG_UTIL, "Mounted \"%s\", holding %u files\n", filepath, paks[numPaks].getNumEntries());
+  ++numPaks;
+  return true;
+}
+
+bool wsVirtualFS::open(wsMappedFile* dest, const char* filepath) const {
+  wsAssert(_mInitialized, "Initialize the Virtual File System first.");
+  //  Newest first
+  for (u32 i = numPaks; i-- > 0;) {
+    const wsPakEntry* entry = paks[i].find(filepath);
+    if (entry) { return paks[i].read(dest, entry); }
+  }
+  return false;
+}
+
+bool wsCookedPath(char* dest, const char* sourcePath, const char* extension, u32 size) {
+  const char* dot = strrchr(sourcePath, '.');
+  const char* slash = strrchr(sourcePath, '/');
+  u32 stemLength = (dot != WS_NULL && (slash == WS_NULL || dot > slash)) ? (u32)(dot - sourcePath) : strlen(sourcePath);
+  if (stemLength + strlen(extension) + 1 > size) { return false; }
+  memcpy(dest, sourcePath, stemLength);
+  strcpy(dest + stemLength, extension);
+  return true;
+}
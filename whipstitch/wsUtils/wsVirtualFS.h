@@ -0,0 +1,99 @@
+/*
+ * wsVirtualFS.h
+ *
+ *    This file declares the class wsVirtualFS, which serves asset files from the
+ *    .wsPak packs mounted in it, falling back to loose files on disk for any path the
+ *    packs do not hold. wsMappedFile::open(...) asks it first, so every loader which
+ *    reads through a wsMappedFile is served from packs without knowing of them.
+ *
+ *    It also holds the manifest written by assetCooker, through which the engine finds
+ *    the cooked form of a source asset. Only a source on disk is checked, to see it has
+ *    not changed since it was cooked.
+ *
+ *    Packs and the manifest are loaded while the engine starts, before any loading
+ *    begins; lookups change nothing, so any number of loader threads may open files at
+ *    once.
+ *
+ *  This software is provided under the terms of the MIT license
+ *  Copyright (c) D. Scott Nettleton, 2013
+ *
+ *  Permission is hereby granted, free of charge, to any person
+ *  obtaining a copy of this software and associated documentation
+ *  files (the "Software"), to deal in the Software without
+ *  restriction, including without limitation the rights to use, copy,
+ *  modify, merge, publish, distribute, sublicense, and/or sell copies
+ *  of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *  OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *  HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *  OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WS_VIRTUAL_FS_H_
+#define WS_VIRTUAL_FS_H_
+
+#include "wsAssetManifest.h"
+#include "wsPakFile.h"
+
+#define WS_DEFAULT_MAX_PAKS 8
+
+class wsVirtualFS {
+  private:
+    wsAssetManifest manifest;
+    wsPakFile* paks;
+    u32 numPaks;
+    u32 maxPaks;
+    //  True only when the startUp function has been called
+    bool _mInitialized;
+  public:
+    /*  Empty Constructor and Destructor   */
+    //  As an engine subsystem, the file system takes no action until explicitly
+    //  initialized via the startUp(...) function.
+    wsVirtualFS() : paks(WS_NULL), numPaks(0), maxPaks(0), _mInitialized(false) {}
+    ~wsVirtualFS() {}
+    /*  Startup and shutdown functions  */
+    void startUp(u32 myMaxPaks = WS_DEFAULT_MAX_PAKS);
+    void shutDown();
+    /*  Accessors   */
+    u32 getNumPaks() const { return numPaks; }
+    bool isInitialized() const { return _mInitialized; }
+    /*  Operational Methods */
+    //  True if a mounted pack holds the path
+    bool contains(const char* filepath) const;
+    //  True if a mounted pack holds the path or it can be read from disk, or if the path
+    //  is a source asset whose cooked file can
+    bool exists(const char* filepath) const;
+    //  Returns the path of the source asset's cooked file, or WS_NULL if the manifest does
+    //  not list it
+    const char* findCooked(const char* filepath) const;
+    //  Writes to dest the cooked file to load in place of a source asset: the one the
+    //  manifest names, unless the source is on disk with another size or write time than
+    //  the manifest records, or else the one beside the source with the given extension,
+    //  if it is packed, shipped without its source, or no older than it. Returns false if
+    //  there is none, or the source has changed since it was cooked.
+    bool findCurrentCooked(char* dest, const char* filepath, const char* extension, u32 size) const;
+    //  Reads the manifest, from a mounted pack if one holds it
+    bool loadManifest(const char* filepath) { return manifest.open(filepath); }
+    //  Mounts a pack, whose files take precedence over those of packs mounted before it
+    bool mount(const char* filepath);
+    //  Serves the path from the newest pack holding it. Returns false if no pack holds
+    //  it, or the packed copy is corrupt, so the caller may read it from disk instead.
+    bool open(wsMappedFile* dest, const char* filepath) const;
+};
+
+extern wsVirtualFS wsVFS;
+
+//  Writes the path of a source asset's cooked file to dest, replacing its extension with
+//  the given one. Returns false if it would not fit in size bytes.
+bool wsCookedPath(char* dest, const char* sourcePath, const char* extension, u32 size);
+
+#endif /* WS_VIRTUAL_FS_H_ */
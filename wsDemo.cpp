@@ -60,10 +60,14 @@ void wsDemo::onStart() {
   scene->setCollisionClass(CLASS_BOX, CLASS_SCENERY | CLASS_GRISWALD);
 
   wsRenderer.setClearColor(0.4f, 0.6f, 0.4f, 1.0f);
-  wsMesh* griswald = wsNew(wsMesh, wsMesh("models/Griswald.wsMesh"));
-  wsMesh* bladeWand = wsNew(wsMesh, wsMesh("models/bladeWand.wsMesh"));
-  wsMesh* blueBox = wsNew(wsMesh, wsMesh("models/blueBox.wsMesh"));
+  wsMesh* griswald = wsRegistry.getMesh(wsRegistry.loadMesh("models/Griswald.wsMesh"));
+  wsMesh* bladeWand = wsRegistry.getMesh(wsRegistry.loadMesh("models/bladeWand.wsMesh"));
+  wsMesh* blueBox = wsRegistry.getMesh(wsRegistry.loadMesh("models/blueBox.wsMesh"));
   wsCollisionCapsule* collision_Griswald = wsNew(wsCollisionCapsule, wsCollisionCapsule(2.5f, 10.0f));
+  nameGriswald = wsNames.intern("Griswald");
+  nameIdle = wsNames.intern("Idle");
+  nameJump = wsNames.intern("Jump");
+  nameWalk = wsNames.intern("Walk");
   Griswald = wsNew(wsModel, wsModel("Griswald", griswald, 7, 75.0f, CLASS_GRISWALD, WS_MODEL_LOCK_HORIZ_ROTATIONS, collision_Griswald));
   // wsModel* Griswald2 = wsNew(wsModel, wsModel("Griswald2", griswald, 3));
   wsModel* BladeWand = wsNew(wsModel, wsModel("BladeWand", bladeWand, 0, 0.0f, CLASS_WEAPON));
@@ -75,7 +79,7 @@ void wsDemo::onStart() {
   // BladeWand->setPos(vec4(0.0f, 10.0f, 4.0f));
   // Griswald2->setPos(vec4(-5.0f, 0.0f, 0.0f));
   BlueBox->setPos(vec4(10.0f, 5.0f, -3.0f));
-  wsSound* Click = wsNew(wsSound, wsSound("sounds/btnClick.wav"));
+  wsSound* Click = wsRegistry.getSound(wsRegistry.loadSound("sounds/btnClick.wav"));
   wsMusic* Resistors = wsNew(wsMusic, wsMusic("sounds/music/07. We're the Resistors.ogg"));
   wsSounds.addSound("Click", Click);
   wsSounds.addMusic("Resistors", Resistors);
@@ -85,16 +89,16 @@ void wsDemo::onStart() {
   scene->addModel(BlueBox);
 
   //*
-  wsAnimation* anim_walk = wsNew(wsAnimation, wsAnimation("models/Walk.wsAnim"));
-  wsAnimation* anim_idle = wsNew(wsAnimation, wsAnimation("models/Idle.wsAnim"));
-  wsAnimation* anim_jump = wsNew(wsAnimation, wsAnimation("models/Jump.wsAnim"));
+  wsAnimation* anim_walk = wsRegistry.getAnimation(wsRegistry.loadAnimation("models/Walk.wsAnim"));
+  wsAnimation* anim_idle = wsRegistry.getAnimation(wsRegistry.loadAnimation("models/Idle.wsAnim"));
+  wsAnimation* anim_jump = wsRegistry.getAnimation(wsRegistry.loadAnimation("models/Jump.wsAnim"));
   scene->addAnimation(anim_walk, "Griswald");
   scene->addAnimation(anim_idle, "Griswald");
   scene->addAnimation(anim_jump, "Griswald");
   wsEcho("Animation Name = \"%s\"", anim_idle->getName());
   scene->beginAnimation("Griswald", "Idle");
   //*/
-  wsFont* fntUbuntu = wsNew(wsFont, wsFont("/home/dsnettleton/Documents/Programming/Eclipse/workspace/Florin/fonts/Ubuntu-B.ttf", 30));
+  wsFont* fntUbuntu = wsRegistry.getFont(wsRegistry.loadFont("/home/dsnettleton/Documents/Programming/Eclipse/workspace/Florin/fonts/Ubuntu-B.ttf", 30));
   wsText* txtHello = wsNew(wsText, wsText(vec4(16, 240, 1024, 256), "Hello World!", fntUbuntu, 0, WS_HUD_VISIBLE));
   wsText* txtLine2 = wsNew(wsText, wsText(vec4(16, 204, 1024, 256), "ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789", fntUbuntu, 1, WS_HUD_VISIBLE));
   wsText* txtLine3 = wsNew(wsText, wsText(vec4(16, 168, 1024, 256), "abcdefghijklmnopqrstuvwxyz", fntUbuntu, 2, WS_HUD_VISIBLE));
@@ -142,20 +146,20 @@ void wsDemo::onLoop() {
   }
   if (keyUp) {
     // Griswald->moveForward(0.1f);
-    scene->moveModelForward("Griswald", 0.1f);
+    scene->moveModelForward(nameGriswald, 0.1f);
   }
   if (keyDown) {
-    scene->moveModelBackward("Griswald", 0.1f);
+    scene->moveModelBackward(nameGriswald, 0.1f);
   }
   if (keyLeft) {
     f32 angle = 1.0f;
     // Griswald->rotate(WS_Y_AXIS, angle);
-    scene->rotateModel("Griswald", WS_Y_AXIS, angle);
+    scene->rotateModel(nameGriswald, WS_Y_AXIS, angle);
     cam->orbit(Griswald->getPos()+vec4(0.0f, 4.0f), WS_Y_AXIS, angle);
   }
   if (keyRight) {
     f32 angle = -1.0f;
-    scene->rotateModel("Griswald", WS_Y_AXIS, angle);
+    scene->rotateModel(nameGriswald, WS_Y_AXIS, angle);
     cam->orbit(Griswald->getPos()+vec4(0.0f, 4.0f), WS_Y_AXIS, angle);
   }
   cam->setPos(Griswald->getPos()+vec4(0.0f, 12.0f, -20.0f).rotate(Griswald->getRot()));
@@ -217,7 +221,7 @@ void wsDemo::onExit() {
 /*  Operational Methods */
 
 void wsDemo::handleButtonEvents(u32 btnHash, u32 action) {
-  if (btnHash == wsHash("Test Button") && action == WS_RELEASE) {
+  if (btnHash == WS_HASH("Test Button") && action == WS_RELEASE) {
     wsSounds.playSound("Click");
     wsRenderer.nextRenderMode();
   }
@@ -244,15 +248,15 @@ void wsDemo::handleControllerEvents(u64 controllerNum, u64 btnIndex, u32 action,
       case WS_BUTTON_LEFT:
         if (action == WS_PRESS) {
           //*
-          const char* anim = scene->getModel("Griswald")->getCurrentAnimationName();
+          const char* anim = scene->getModel(nameGriswald)->getCurrentAnimationName();
           if (strcmp(anim, "Walk") == 0) {
-            scene->beginAnimation("Griswald", "Idle");
+            scene->beginAnimation(nameGriswald, nameIdle);
           }
           else if (strcmp(anim, "Idle") == 0) {
-            scene->beginAnimation("Griswald", "Jump");
+            scene->beginAnimation(nameGriswald, nameJump);
           }
           else if (strcmp(anim, "Jump") == 0) {
-            scene->beginAnimation("Griswald", "Walk");
+            scene->beginAnimation(nameGriswald, nameWalk);
           }
           //*/
         }
@@ -305,15 +309,15 @@ void wsDemo::handleKeyboardEvents(u64 keyType, u64 btnIndex, u32 action) {
       switch (btnIndex) {
         case WS_KEY_A:
           if (action == WS_PRESS) {
-            const char* anim = scene->getModel("Griswald")->getCurrentAnimationName();
+            const char* anim = scene->getModel(nameGriswald)->getCurrentAnimationName();
             if (strcmp(anim, "Walk") == 0) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             else if (strcmp(anim, "Idle") == 0) {
-              scene->beginAnimation("Griswald", "Jump");
+              scene->beginAnimation(nameGriswald, nameJump);
             }
             else if (strcmp(anim, "Jump") == 0) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
           }
           break;
@@ -402,80 +406,80 @@ void wsDemo::handleKeyboardEvents(u64 keyType, u64 btnIndex, u32 action) {
         case WS_KEY_LEFT:
           if (action == WS_PRESS) {
             if (!keyDown && !keyRight && !keyUp) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
             else if (keyRight) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             keyLeft = true;
           }
           else if (action == WS_RELEASE) {
             keyLeft = false;
             if (!keyDown && !keyRight && !keyUp) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             else if (keyRight) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
           }
           break;
         case WS_KEY_RIGHT:
           if (action == WS_PRESS) {
             if (!keyDown && !keyUp && !keyLeft) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
             else if (keyLeft) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             keyRight = true;
           }
           else if (action == WS_RELEASE) {
             keyRight = false;
             if (!keyDown && !keyUp && !keyLeft) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             else if (keyLeft) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
           }
           break;
         case WS_KEY_DOWN:
           if (action == WS_PRESS) {
             if (!keyRight && !keyUp && !keyLeft) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
             else if (keyUp) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             keyDown = true;
           }
           else if (action == WS_RELEASE) {
             keyDown = false;
             if (!keyRight && !keyUp && !keyLeft) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             else if (keyUp) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
           }
           break;
         case WS_KEY_UP:
           if (action == WS_PRESS) {
             if (!keyDown && !keyRight && !keyLeft) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
             else if (keyDown) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             keyUp = true;
           }
           else if (action == WS_RELEASE) {
             keyUp = false;
             if (!keyDown && !keyRight && !keyLeft) {
-              scene->beginAnimation("Griswald", "Idle");
+              scene->beginAnimation(nameGriswald, nameIdle);
             }
             else if (keyDown) {
-              scene->beginAnimation("Griswald", "Walk");
+              scene->beginAnimation(nameGriswald, nameWalk);
             }
           }
           break;
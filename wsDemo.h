@@ -43,6 +43,11 @@ class wsDemo : public wsGame {
     wsScene* scene;
     wsCamera* cam;
     wsModel* Griswald;
+    //  Interned once in onStart() so per-frame calls never hash strings
+    wsNameHandle nameGriswald;
+    wsNameHandle nameIdle;
+    wsNameHandle nameJump;
+    wsNameHandle nameWalk;
     bool quit;
     bool animationsPaused;
   public: